@@ -77,6 +77,29 @@
 // define ping timeout (in milliseconds) used when getting connections
 #define DPI_DEFAULT_PING_TIMEOUT                5000
 
+// define interval (in seconds) between evaluations of elastic pool sizing
+#define DPI_DEFAULT_POOL_SAMPLE_INTERVAL        10
+
+// define acquire wait time (in milliseconds) that causes a pool to grow
+#define DPI_DEFAULT_POOL_WAIT_THRESHOLD         50
+
+// define number of admission classes supported by each pool
+#define DPI_MAX_POOL_CLASSES                    8
+
+// define percentage of its limit retained by an admission class when the
+// latency target is exceeded
+#define DPI_DEFAULT_POOL_CLASS_BACKOFF          90
+
+// define defaults used when retrying executions which fail with recoverable
+// errors; delays and the deadline are in milliseconds
+#define DPI_DEFAULT_RETRY_MAX_ATTEMPTS          3
+#define DPI_DEFAULT_RETRY_INITIAL_DELAY         25
+#define DPI_DEFAULT_RETRY_MAX_DELAY             1000
+#define DPI_DEFAULT_RETRY_DEADLINE              10000
+
+// define version of the interposer interface supported by the library
+#define DPI_INTERPOSE_VERSION                   1
+
 // define constants for dequeue wait (AQ)
 #define DPI_DEQ_WAIT_NO_WAIT                    0
 #define DPI_DEQ_WAIT_FOREVER                    ((uint32_t) -1)
@@ -106,6 +129,15 @@
 // Enumerations
 //-----------------------------------------------------------------------------
 
+// aggregate types
+typedef enum {
+    DPI_AGGREGATE_COUNT = 1,
+    DPI_AGGREGATE_SUM,
+    DPI_AGGREGATE_MIN,
+    DPI_AGGREGATE_MAX,
+    DPI_AGGREGATE_DISTINCT_ESTIMATE
+} dpiAggregateType;
+
 // connection/pool authorization modes
 typedef enum {
     DPI_MODE_AUTH_DEFAULT = 0x00000000,         // OCI_DEFAULT
@@ -115,6 +147,14 @@ typedef enum {
     DPI_MODE_AUTH_SYSASM = 0x00008000           // OCI_SYSASM
 } dpiAuthMode;
 
+// buffer allocation modes
+typedef enum {
+    DPI_MODE_BUFFER_DEFAULT = 0x0000,
+    DPI_MODE_BUFFER_HUGE_PAGES = 0x0001,
+    DPI_MODE_BUFFER_PREFAULT = 0x0002,
+    DPI_MODE_BUFFER_NUMA_LOCAL = 0x0004
+} dpiBufferMode;
+
 // connection close modes
 typedef enum {
     DPI_MODE_CONN_CLOSE_DEFAULT = 0x0000,       // OCI_DEFAULT
@@ -176,6 +216,21 @@ typedef enum {
     DPI_MODE_FETCH_RELATIVE = 0x00000040        // OCI_FETCH_RELATIVE
 } dpiFetchMode;
 
+// classes of OCI calls on which an interposer can be installed
+typedef enum {
+    DPI_INTERPOSE_CALL_ROUND_TRIP = 0x0001,
+    DPI_INTERPOSE_CALL_FETCH = 0x0002,
+    DPI_INTERPOSE_CALL_LOB = 0x0004,
+    DPI_INTERPOSE_CALL_AQ = 0x0008
+} dpiInterposeCallClass;
+
+// LOB file transfer modes
+typedef enum {
+    DPI_MODE_LOB_TRANSFER_DEFAULT = 0x0000,
+    DPI_MODE_LOB_TRANSFER_DIRECT = 0x0001,
+    DPI_MODE_LOB_TRANSFER_NO_CACHE = 0x0002
+} dpiLobTransferMode;
+
 // message delivery modes in advanced queuing
 typedef enum {
     DPI_MODE_MSG_PERSISTENT = 1,                // OCI_MSG_PERSISTENT
@@ -265,6 +320,12 @@ typedef enum {
     DPI_MODE_POOL_GET_FORCEGET = 2              // OCI_SPOOL_ATTRVAL_FORCEGET
 } dpiPoolGetMode;
 
+// statement prepare modes
+typedef enum {
+    DPI_MODE_PREPARE_DEFAULT = 0x0000,
+    DPI_MODE_PREPARE_AUTO_BIND = 0x0001
+} dpiPrepareMode;
+
 // purity values when acquiring a connection from a pool
 typedef enum {
     DPI_PURITY_DEFAULT = 0,                     // OCI_ATTR_PURITY_DEFAULT
@@ -300,7 +361,8 @@ typedef enum {
     DPI_STMT_TYPE_ALTER = 7,                    // OCI_STMT_ALTER
     DPI_STMT_TYPE_BEGIN = 8,                    // OCI_STMT_BEGIN
     DPI_STMT_TYPE_DECLARE = 9,                  // OCI_STMT_DECLARE
-    DPI_STMT_TYPE_CALL = 10                     // OCI_STMT_CALL
+    DPI_STMT_TYPE_CALL = 10,                    // OCI_STMT_CALL
+    DPI_STMT_TYPE_MERGE = 16                    // OCI_STMT_MERGE
 } dpiStatementType;
 
 // subscription namespaces
@@ -348,6 +410,9 @@ typedef struct dpiSubscr dpiSubscr;
 typedef struct dpiDeqOptions dpiDeqOptions;
 typedef struct dpiEnqOptions dpiEnqOptions;
 typedef struct dpiMsgProps dpiMsgProps;
+typedef struct dpiSharedResult dpiSharedResult;
+typedef struct dpiAggregateResult dpiAggregateResult;
+typedef struct dpiBatch dpiBatch;
 
 
 //-----------------------------------------------------------------------------
@@ -395,6 +460,7 @@ typedef struct {
 //-----------------------------------------------------------------------------
 
 // forward declarations
+typedef struct dpiAggregateSpec dpiAggregateSpec;
 typedef struct dpiAppContext dpiAppContext;
 typedef struct dpiCommonCreateParams dpiCommonCreateParams;
 typedef struct dpiConnCreateParams dpiConnCreateParams;
@@ -403,10 +469,22 @@ typedef struct dpiData dpiData;
 typedef struct dpiDataTypeInfo dpiDataTypeInfo;
 typedef struct dpiEncodingInfo dpiEncodingInfo;
 typedef struct dpiErrorInfo dpiErrorInfo;
+typedef struct dpiFingerprint dpiFingerprint;
+typedef struct dpiInterposeCallInfo dpiInterposeCallInfo;
+typedef struct dpiInterposeParams dpiInterposeParams;
+typedef struct dpiJsonBuffer dpiJsonBuffer;
 typedef struct dpiObjectAttrInfo dpiObjectAttrInfo;
 typedef struct dpiObjectTypeInfo dpiObjectTypeInfo;
+typedef struct dpiPoolClassInfo dpiPoolClassInfo;
+typedef struct dpiPoolClassParams dpiPoolClassParams;
 typedef struct dpiPoolCreateParams dpiPoolCreateParams;
+typedef struct dpiPoolSizingParams dpiPoolSizingParams;
 typedef struct dpiQueryInfo dpiQueryInfo;
+typedef struct dpiRetryInfo dpiRetryInfo;
+typedef struct dpiRetryParams dpiRetryParams;
+typedef struct dpiRing dpiRing;
+typedef struct dpiRingBatch dpiRingBatch;
+typedef struct dpiRingColumn dpiRingColumn;
 typedef struct dpiStmtInfo dpiStmtInfo;
 typedef struct dpiSubscrCreateParams dpiSubscrCreateParams;
 typedef struct dpiSubscrMessage dpiSubscrMessage;
@@ -415,6 +493,12 @@ typedef struct dpiSubscrMessageRow dpiSubscrMessageRow;
 typedef struct dpiSubscrMessageTable dpiSubscrMessageTable;
 typedef struct dpiVersionInfo dpiVersionInfo;
 
+// structure used for specifying an aggregate computed by ODPI-C
+struct dpiAggregateSpec {
+    dpiAggregateType aggregateType;
+    uint32_t pos;
+};
+
 // structure used for application context
 struct dpiAppContext {
     const char *namespaceName;
@@ -435,6 +519,8 @@ struct dpiCommonCreateParams {
     uint32_t editionLength;
     const char *driverName;
     uint32_t driverNameLength;
+    dpiBufferMode bufferMode;
+    dpiPrepareMode prepareMode;
 };
 
 // structure used for creating connections
@@ -456,6 +542,7 @@ struct dpiConnCreateParams {
     const char *outTag;
     uint32_t outTagLength;
     int outTagFound;
+    uint32_t poolClass;
 };
 
 // structure used for transferring data to/from ODPI-C
@@ -513,6 +600,49 @@ struct dpiErrorInfo {
     int isRecoverable;
 };
 
+// structure used for returning fingerprints of query results from ODPI-C
+struct dpiFingerprint {
+    uint64_t numRows;
+    uint64_t orderedDigest;
+    uint64_t unorderedDigest;
+    uint32_t numColumns;
+    uint64_t *columnDigests;
+};
+
+// structure used for transferring information about OCI calls to interposers
+struct dpiInterposeCallInfo {
+    uint32_t callClasses;
+    const char *fnName;
+    uint64_t elapsedTime;
+    int failed;
+};
+
+// callbacks for interposing on OCI calls
+typedef int32_t (*dpiInterposeBeforeCallback)(void *context,
+        const dpiInterposeCallInfo *info);
+typedef void (*dpiInterposeAfterCallback)(void *context,
+        const dpiInterposeCallInfo *info);
+
+// structure used for installing an interposer on OCI calls
+struct dpiInterposeParams {
+    uint32_t version;
+    uint32_t callClasses;
+    dpiInterposeBeforeCallback beforeCall;
+    dpiInterposeAfterCallback afterCall;
+    void *callbackContext;
+};
+
+// structure used for returning JSON from ODPI-C
+struct dpiJsonBuffer {
+    char *ptr;
+    uint32_t length;
+    uint32_t allocatedLength;
+};
+
+// callback for writing JSON
+typedef int (*dpiJsonWriteCallback)(void *context, const char *data,
+        uint32_t dataLength);
+
 // structure used for transferring object attribute information from ODPI-C
 struct dpiObjectAttrInfo {
     const char *name;
@@ -545,6 +675,36 @@ struct dpiPoolCreateParams {
     uint32_t outPoolNameLength;
 };
 
+// structure used for limiting the sessions used by an admission class
+struct dpiPoolClassParams {
+    uint32_t minSessions;
+    uint32_t maxSessions;
+    uint32_t maxQueued;
+    uint32_t queueTimeout;
+    uint32_t latencyTarget;
+    uint32_t backoffPercent;
+};
+
+// structure used for transferring the state of an admission class
+struct dpiPoolClassInfo {
+    uint32_t limit;
+    uint32_t busyCount;
+    uint32_t queuedCount;
+    uint64_t numAdmitted;
+    uint64_t numRejected;
+    uint64_t numTimedOut;
+};
+
+// structure used for elastic sizing of pools
+struct dpiPoolSizingParams {
+    uint32_t minSessions;
+    uint32_t maxSessions;
+    uint32_t sessionIncrement;
+    uint32_t spareSessions;
+    uint32_t sampleInterval;
+    uint32_t waitThreshold;
+};
+
 // structure used for transferring query metadata from ODPI-C
 struct dpiQueryInfo {
     const char *name;
@@ -553,6 +713,45 @@ struct dpiQueryInfo {
     int nullOk;
 };
 
+// structure used for transferring retry statistics from ODPI-C
+struct dpiRetryInfo {
+    uint64_t numRetries;
+    uint64_t numSessionsReplaced;
+    uint64_t numSucceeded;
+    uint64_t numFailed;
+};
+
+// structure used for retrying executions which fail with recoverable errors
+struct dpiRetryParams {
+    uint32_t maxAttempts;
+    uint32_t initialDelay;
+    uint32_t maxDelay;
+    uint32_t deadline;
+};
+
+// structure used for the header of a ring buffer of fetched rows
+struct dpiRing {
+    uint64_t size;
+    volatile uint64_t writePos;
+    volatile uint64_t readPos;
+};
+
+// structure used for a batch of rows in a ring buffer
+struct dpiRingBatch {
+    uint64_t length;
+    uint32_t numRows;
+    uint32_t numColumns;
+};
+
+// structure used for a column of a batch of rows in a ring buffer
+struct dpiRingColumn {
+    dpiNativeTypeNum nativeTypeNum;
+    uint32_t valueSize;
+    uint64_t nullsOffset;
+    uint64_t valuesOffset;
+    uint64_t offsetsOffset;
+};
+
 // structure used for transferring statement information from ODPI-C
 struct dpiStmtInfo {
     int isQuery;
@@ -658,14 +857,89 @@ int dpiContext_initCommonCreateParams(const dpiContext *context,
 int dpiContext_initConnCreateParams(const dpiContext *context,
         dpiConnCreateParams *params);
 
+// initialize interposer parameters to default values
+int dpiContext_initInterposeParams(const dpiContext *context,
+        dpiInterposeParams *params);
+
+// initialize pool admission class parameters to default values
+int dpiContext_initPoolClassParams(const dpiContext *context,
+        dpiPoolClassParams *params);
+
 // initialize pool create parameters to default values
 int dpiContext_initPoolCreateParams(const dpiContext *context,
         dpiPoolCreateParams *params);
 
+// initialize pool sizing parameters to default values
+int dpiContext_initPoolSizingParams(const dpiContext *context,
+        dpiPoolSizingParams *params);
+
+// initialize retry parameters to default values
+int dpiContext_initRetryParams(const dpiContext *context,
+        dpiRetryParams *params);
+
 // initialize subscription create parameters to default values
 int dpiContext_initSubscrCreateParams(const dpiContext *context,
         dpiSubscrCreateParams *params);
 
+// install or remove the interposer on OCI calls
+int dpiContext_setInterposer(const dpiContext *context,
+        const dpiInterposeParams *params);
+
+
+//-----------------------------------------------------------------------------
+// Aggregate Result Methods (dpiAggregateResult)
+//-----------------------------------------------------------------------------
+
+// add a reference to the aggregate result
+int dpiAggregateResult_addRef(dpiAggregateResult *result);
+
+// return the value of the group by column for the given group
+int dpiAggregateResult_getGroupKey(dpiAggregateResult *result,
+        uint32_t groupIndex, dpiNativeTypeNum *nativeTypeNum, dpiData **data);
+
+// return the number of groups in the aggregate result
+int dpiAggregateResult_getNumGroups(dpiAggregateResult *result,
+        uint32_t *numGroups);
+
+// return the value of the aggregate at the given index for the given group
+int dpiAggregateResult_getValue(dpiAggregateResult *result,
+        uint32_t groupIndex, uint32_t specIndex,
+        dpiNativeTypeNum *nativeTypeNum, dpiData **data);
+
+// release a reference to the aggregate result
+int dpiAggregateResult_release(dpiAggregateResult *result);
+
+
+//-----------------------------------------------------------------------------
+// Batch Methods (dpiBatch)
+//-----------------------------------------------------------------------------
+
+// add a reference to the batch
+int dpiBatch_addRef(dpiBatch *batch);
+
+// add a statement to the batch
+int dpiBatch_addStmt(dpiBatch *batch, dpiStmt *stmt);
+
+// remove all statements from the batch
+int dpiBatch_clear(dpiBatch *batch);
+
+// execute all of the statements in the batch in a single round trip
+int dpiBatch_execute(dpiBatch *batch, dpiExecMode mode);
+
+// return the number of errors that took place during the last execution
+int dpiBatch_getErrorCount(dpiBatch *batch, uint32_t *count);
+
+// return the errors that took place during the last execution
+int dpiBatch_getErrors(dpiBatch *batch, uint32_t numErrors,
+        dpiErrorInfo *errors);
+
+// return the number of rows affected by each statement in the last execution
+int dpiBatch_getRowCounts(dpiBatch *batch, uint32_t *numRowCounts,
+        uint64_t **rowCounts);
+
+// release a reference to the batch
+int dpiBatch_release(dpiBatch *batch);
+
 
 //-----------------------------------------------------------------------------
 // Connection Methods (dpiConn)
@@ -741,6 +1015,12 @@ int dpiConn_getLTXID(dpiConn *conn, const char **value, uint32_t *valueLength);
 int dpiConn_getObjectType(dpiConn *conn, const char *name, uint32_t nameLength,
         dpiObjectType **objType);
 
+// return statistics about executions retried on the connection
+int dpiConn_getRetryInfo(dpiConn *conn, dpiRetryInfo *info);
+
+// return the number of round trips made to the database by the connection
+int dpiConn_getRoundTrips(dpiConn *conn, uint64_t *roundTrips);
+
 // return information about the server version in use
 int dpiConn_getServerVersion(dpiConn *conn, const char **releaseString,
         uint32_t *releaseStringLength, dpiVersionInfo *versionInfo);
@@ -748,6 +1028,9 @@ int dpiConn_getServerVersion(dpiConn *conn, const char **releaseString,
 // return the statement cache size
 int dpiConn_getStmtCacheSize(dpiConn *conn, uint32_t *cacheSize);
 
+// create a new batch of statements and return it
+int dpiConn_newBatch(dpiConn *conn, dpiBatch **batch);
+
 // create a new dequeue options object and return it
 int dpiConn_newDeqOptions(dpiConn *conn, dpiDeqOptions **options);
 
@@ -825,6 +1108,10 @@ int dpiConn_shutdownDatabase(dpiConn *conn, dpiShutdownMode mode);
 // startup the database
 int dpiConn_startupDatabase(dpiConn *conn, dpiStartupMode mode);
 
+// release cached memory that is no longer needed
+int dpiConn_trimMemory(dpiConn *conn, uint64_t lowWaterMark,
+        uint64_t *bytesReclaimed);
+
 
 //-----------------------------------------------------------------------------
 // Data Methods (dpiData)
@@ -1063,6 +1350,16 @@ int dpiLob_openResource(dpiLob *lob);
 int dpiLob_readBytes(dpiLob *lob, uint64_t offset, uint64_t amount,
         char *value, uint64_t *valueLength);
 
+// read bytes from the LOB, interrupting the read if it exceeds the timeout
+// (in milliseconds); zero implies no timeout
+int dpiLob_readBytesWithTimeout(dpiLob *lob, uint64_t offset, uint64_t amount,
+        char *value, uint64_t *valueLength, uint32_t timeout);
+
+// read bytes from the LOB starting at the specified offset and write them to
+// the file descriptor
+int dpiLob_readToFd(dpiLob *lob, uint64_t offset, int fd,
+        dpiLobTransferMode mode, uint64_t *numBytes);
+
 // release a reference to the LOB
 int dpiLob_release(dpiLob *lob);
 
@@ -1081,6 +1378,11 @@ int dpiLob_trim(dpiLob *lob, uint64_t newSize);
 int dpiLob_writeBytes(dpiLob *lob, uint64_t offset, const char *value,
         uint64_t valueLength);
 
+// read bytes from the file descriptor until end of file and write them to the
+// LOB starting at the specified offset
+int dpiLob_writeFromFd(dpiLob *lob, uint64_t offset, int fd,
+        dpiLobTransferMode mode, uint64_t *numBytes);
+
 
 //-----------------------------------------------------------------------------
 // Message Properties Methods (dpiMsgProps)
@@ -1205,9 +1507,16 @@ int dpiObject_setAttributeValue(dpiObject *obj, dpiObjectAttr *attr,
 int dpiObject_setElementValueByIndex(dpiObject *obj, int32_t index,
         dpiNativeTypeNum nativeTypeNum, dpiData *value);
 
+// serialize the object as JSON, appending it to the buffer
+int dpiObject_toJson(dpiObject *obj, dpiJsonBuffer *buffer);
+
 // trim a number of elements from the end of a collection
 int dpiObject_trim(dpiObject *obj, uint32_t numToTrim);
 
+// serialize the object as JSON, passing it to the callback in pieces
+int dpiObject_writeJson(dpiObject *obj, dpiJsonWriteCallback callback,
+        void *context);
+
 
 //-----------------------------------------------------------------------------
 // Object Type Attribute Methods (dpiObjectAttr)
@@ -1269,6 +1578,10 @@ int dpiPool_create(const dpiContext *context, const char *userName,
 // get the pool's busy count
 int dpiPool_getBusyCount(dpiPool *pool, uint32_t *value);
 
+// return the current limit and statistics of a pool admission class
+int dpiPool_getClassInfo(dpiPool *pool, uint32_t poolClass,
+        dpiPoolClassInfo *info);
+
 // return the encoding information used by the session pool
 int dpiPool_getEncodingInfo(dpiPool *pool, dpiEncodingInfo *info);
 
@@ -1281,21 +1594,40 @@ int dpiPool_getMaxLifetimeSession(dpiPool *pool, uint32_t *value);
 // get the pool's open count
 int dpiPool_getOpenCount(dpiPool *pool, uint32_t *value);
 
+// return statistics about executions retried on connections from the pool
+int dpiPool_getRetryInfo(dpiPool *pool, dpiRetryInfo *info);
+
 // return the statement cache size
 int dpiPool_getStmtCacheSize(dpiPool *pool, uint32_t *cacheSize);
 
 // get the pool's timeout value
 int dpiPool_getTimeout(dpiPool *pool, uint32_t *value);
 
+// execute a query once for all callers with the same SQL and bind values
+int dpiPool_queryShared(dpiPool *pool, const char *sql, uint32_t sqlLength,
+        uint32_t numBinds, dpiNativeTypeNum *bindNativeTypeNums,
+        dpiData *bindValues, dpiSharedResult **result);
+
+// change the minimum, maximum and increment of the pool
+int dpiPool_reconfigure(dpiPool *pool, uint32_t minSessions,
+        uint32_t maxSessions, uint32_t sessionIncrement);
+
 // release a reference to the pool
 int dpiPool_release(dpiPool *pool);
 
+// set the limits of a pool admission class, or remove them if NULL
+int dpiPool_setClassParams(dpiPool *pool, uint32_t poolClass,
+        dpiPoolClassParams *params);
+
 // set the pool's "get" mode
 int dpiPool_setGetMode(dpiPool *pool, dpiPoolGetMode value);
 
 // set the pool's maximum lifetime session
 int dpiPool_setMaxLifetimeSession(dpiPool *pool, uint32_t value);
 
+// enable (or disable) elastic sizing of the pool
+int dpiPool_setSizingParams(dpiPool *pool, dpiPoolSizingParams *params);
+
 // set the statement cache size
 int dpiPool_setStmtCacheSize(dpiPool *pool, uint32_t cacheSize);
 
@@ -1347,10 +1679,31 @@ int dpiStmt_execute(dpiStmt *stmt, dpiExecMode mode,
 // execute the statement multiple times (queries not supported)
 int dpiStmt_executeMany(dpiStmt *stmt, dpiExecMode mode, uint32_t numIters);
 
+// execute the statement, interrupting the call if it exceeds the timeout (in
+// milliseconds); zero implies no timeout
+int dpiStmt_executeWithTimeout(dpiStmt *stmt, dpiExecMode mode,
+        uint32_t timeout, uint32_t *numQueryColumns);
+
+// execute the statement, replaying it (on a new session from the pool, if
+// needed) when it fails with a recoverable error; the statement must be
+// idempotent
+int dpiStmt_executeWithRetry(dpiStmt *stmt, dpiExecMode mode,
+        dpiRetryParams *params, uint32_t *numQueryColumns);
+
 // fetch a single row and return the index into the defined variables
 // this will internally perform any execute and array fetch as needed
 int dpiStmt_fetch(dpiStmt *stmt, int *found, uint32_t *bufferRowIndex);
 
+// fetch all remaining rows and compute the specified aggregates over them
+// without converting them to C data values
+int dpiStmt_fetchAggregates(dpiStmt *stmt, uint32_t numSpecs,
+        dpiAggregateSpec *specs, uint32_t groupByPos,
+        dpiAggregateResult **result);
+
+// fetch all remaining rows and add them to the fingerprint without converting
+// them to C data values
+int dpiStmt_fetchFingerprint(dpiStmt *stmt, dpiFingerprint *fingerprint);
+
 // return the number of rows that are available in the defined variables
 // up to the maximum specified; this will internally perform execute/array
 // fetch only if no rows are available in the defined variables and there are
@@ -1358,6 +1711,16 @@ int dpiStmt_fetch(dpiStmt *stmt, int *found, uint32_t *bufferRowIndex);
 int dpiStmt_fetchRows(dpiStmt *stmt, uint32_t maxRows,
         uint32_t *bufferRowIndex, uint32_t *numRowsFetched, int *moreRows);
 
+// return the number of rows available, as with dpiStmt_fetchRows(), but
+// interrupt any fetch that exceeds the timeout (in milliseconds)
+int dpiStmt_fetchRowsWithTimeout(dpiStmt *stmt, uint32_t maxRows,
+        uint32_t timeout, uint32_t *bufferRowIndex, uint32_t *numRowsFetched,
+        int *moreRows);
+
+// fetch rows and export them to a ring buffer, up to the maximum specified
+int dpiStmt_fetchToRing(dpiStmt *stmt, dpiRing *ring, uint32_t maxRows,
+        uint32_t *numRowsExported, int *moreRows);
+
 // get the number of batch errors that took place in the previous execution
 int dpiStmt_getBatchErrorCount(dpiStmt *stmt, uint32_t *count);
 
@@ -1375,6 +1738,9 @@ int dpiStmt_getBindNames(dpiStmt *stmt, uint32_t *numBindNames,
 // get the number of rows to (internally) fetch at one time
 int dpiStmt_getFetchArraySize(dpiStmt *stmt, uint32_t *arraySize);
 
+// get the maximum number of rows to fetch from the database
+int dpiStmt_getFetchLimit(dpiStmt *stmt, uint64_t *maxRows);
+
 // get next implicit result from previous execution; NULL if no more exist
 int dpiStmt_getImplicitResult(dpiStmt *stmt, dpiStmt **implicitResult);
 
@@ -1401,6 +1767,10 @@ int dpiStmt_getRowCount(dpiStmt *stmt, uint64_t *count);
 int dpiStmt_getRowCounts(dpiStmt *stmt, uint32_t *numRowCounts,
         uint64_t **rowCounts);
 
+// get the SQL that was prepared, after any literals were replaced by bind
+// variables
+int dpiStmt_getSql(dpiStmt *stmt, const char **sql, uint32_t *sqlLength);
+
 // get subscription query id for continuous query notification
 int dpiStmt_getSubscrQueryId(dpiStmt *stmt, uint64_t *queryId);
 
@@ -1415,6 +1785,17 @@ int dpiStmt_scroll(dpiStmt *stmt, dpiFetchMode mode, int32_t offset,
 // set the number of rows to (internally) fetch at one time
 int dpiStmt_setFetchArraySize(dpiStmt *stmt, uint32_t arraySize);
 
+// set the maximum number of rows to fetch from the database
+int dpiStmt_setFetchLimit(dpiStmt *stmt, uint64_t maxRows);
+
+// sort the rows of the bound variables by the values of the key variables
+int dpiStmt_sortBinds(dpiStmt *stmt, uint32_t numIters, uint32_t numKeyVars,
+        dpiVar **keyVars, uint32_t *permutation);
+
+// release cached memory that is no longer needed
+int dpiStmt_trimMemory(dpiStmt *stmt, uint64_t lowWaterMark,
+        uint64_t *bytesReclaimed);
+
 
 //-----------------------------------------------------------------------------
 // Rowid Methods (dpiRowid)
@@ -1431,6 +1812,46 @@ int dpiRowid_getStringValue(dpiRowid *rowid, const char **value,
 int dpiRowid_release(dpiRowid *subscr);
 
 
+//-----------------------------------------------------------------------------
+// Ring Buffer Methods (dpiRing)
+//-----------------------------------------------------------------------------
+
+// return the next batch of rows available in the ring buffer
+dpiRingBatch *dpiRing_getBatch(dpiRing *ring);
+
+// initialize the ring buffer in memory supplied by the caller
+int dpiRing_init(dpiRing *ring, uint64_t size);
+
+// release the batch of rows so that its space can be reused
+void dpiRing_releaseBatch(dpiRing *ring, dpiRingBatch *batch);
+
+
+//-----------------------------------------------------------------------------
+// Shared Result Methods (dpiSharedResult)
+//-----------------------------------------------------------------------------
+
+// add a reference to the shared result
+int dpiSharedResult_addRef(dpiSharedResult *result);
+
+// return the number of columns in the shared result
+int dpiSharedResult_getNumColumns(dpiSharedResult *result,
+        uint32_t *numColumns);
+
+// return the number of rows in the shared result
+int dpiSharedResult_getNumRows(dpiSharedResult *result, uint32_t *numRows);
+
+// return information about the column at the specified position
+int dpiSharedResult_getQueryInfo(dpiSharedResult *result, uint32_t pos,
+        dpiQueryInfo *info);
+
+// return the value of the column at the specified position in the given row
+int dpiSharedResult_getValue(dpiSharedResult *result, uint32_t rowIndex,
+        uint32_t pos, dpiNativeTypeNum *nativeTypeNum, dpiData **data);
+
+// release a reference to the shared result
+int dpiSharedResult_release(dpiSharedResult *result);
+
+
 //-----------------------------------------------------------------------------
 // Subscription Methods (dpiSubscr)
 //-----------------------------------------------------------------------------
@@ -1460,6 +1881,13 @@ int dpiVar_addRef(dpiVar *var);
 int dpiVar_copyData(dpiVar *var, uint32_t pos, dpiVar *sourceVar,
         uint32_t sourcePos);
 
+// copy the data from a range of elements in one variable to another variable
+int dpiVar_copyRange(dpiVar *var, uint32_t pos, dpiVar *sourceVar,
+        uint32_t sourcePos, uint32_t numElements);
+
+// return the NUMA node on which the buffer of the variable resides
+int dpiVar_getBufferNode(dpiVar *var, int32_t *node);
+
 // return pointer to array of dpiData structures for transferring data
 // this is needed for DML returning where the number of elements is modified
 int dpiVar_getData(dpiVar *var, uint32_t *numElements, dpiData **data);
@@ -1492,5 +1920,12 @@ int dpiVar_setFromStmt(dpiVar *var, uint32_t pos, dpiStmt *stmt);
 // set the number of elements in a PL/SQL index-by table
 int dpiVar_setNumElementsInArray(dpiVar *var, uint32_t numElements);
 
+// set the encoding in which fetched byte strings are returned
+int dpiVar_setOutputEncoding(dpiVar *var, const char *encoding);
+
+// release cached memory that is no longer needed
+int dpiVar_trimMemory(dpiVar *var, uint64_t lowWaterMark,
+        uint64_t *bytesReclaimed);
+
 #endif
 
@@ -0,0 +1,421 @@
+//-----------------------------------------------------------------------------
+// Copyright (c) 2017 Oracle and/or its affiliates.  All rights reserved.
+// This program is free software: you can modify it and/or redistribute it
+// under the terms of:
+//
+// (i)  the Universal Permissive License v 1.0 or at your option, any
+//      later version (http://oss.oracle.com/licenses/upl); and/or
+//
+// (ii) the Apache License v 2.0. (http://www.apache.org/licenses/LICENSE-2.0)
+//-----------------------------------------------------------------------------
+
+//-----------------------------------------------------------------------------
+// dpi.hpp
+//   Header only C++17 layer over ODPI-C providing typed access to the rows of
+// queries. Rows are mapped to user defined structures by a list of pointers
+// to members, one for each column, which is known at compile time. The type
+// of each member determines the native type used for fetching, so values are
+// extracted directly from the dpiData structures of the defined variables
+// without a switch on the native type, and byte strings are returned as
+// views of the fetched data rather than copies. Errors are raised as
+// exceptions.
+//-----------------------------------------------------------------------------
+
+#ifndef DPI_PUBLIC_HPP
+#define DPI_PUBLIC_HPP
+
+extern "C" {
+#include "dpi.h"
+}
+
+#include <cstddef>
+#include <optional>
+#include <stdexcept>
+#include <string>
+#include <string_view>
+#include <type_traits>
+#include <utility>
+#include <vector>
+
+#if __cplusplus > 201703L && __has_include(<span>)
+#include <span>
+#endif
+
+namespace dpi {
+
+//-----------------------------------------------------------------------------
+// Span
+//   Contiguous sequence of rows returned by a fetch. This is std::span when
+// compiled for C++20 and a minimal equivalent otherwise.
+//-----------------------------------------------------------------------------
+#if defined(__cpp_lib_span)
+template <typename T>
+using Span = std::span<T>;
+#else
+template <typename T>
+class Span {
+public:
+    constexpr Span() noexcept : ptr(nullptr), count(0) {}
+    constexpr Span(T *ptr, std::size_t count) noexcept :
+            ptr(ptr), count(count) {}
+    constexpr T *begin() const noexcept { return ptr; }
+    constexpr T *end() const noexcept { return ptr + count; }
+    constexpr T *data() const noexcept { return ptr; }
+    constexpr std::size_t size() const noexcept { return count; }
+    constexpr bool empty() const noexcept { return count == 0; }
+    constexpr T &operator[](std::size_t pos) const { return ptr[pos]; }
+private:
+    T *ptr;
+    std::size_t count;
+};
+#endif
+
+
+//-----------------------------------------------------------------------------
+// Error
+//   Exception raised when an ODPI-C function fails, containing the
+// information found in the dpiErrorInfo structure. Errors raised by the
+// database (ORA-xxxxx) are raised as DatabaseError and errors raised by
+// ODPI-C itself (DPI-xxxx) are raised as InterfaceError.
+//-----------------------------------------------------------------------------
+class Error : public std::runtime_error {
+public:
+    explicit Error(const dpiErrorInfo &info) :
+            std::runtime_error(std::string(info.message, info.messageLength)),
+            errorCode(info.code), errorOffset(info.offset),
+            errorFnName(info.fnName ? info.fnName : ""),
+            errorAction(info.action ? info.action : ""),
+            errorSqlState(info.sqlState ? info.sqlState : ""),
+            errorIsRecoverable(info.isRecoverable != 0) {}
+    int32_t code() const noexcept { return errorCode; }
+    uint16_t offset() const noexcept { return errorOffset; }
+    const std::string &fnName() const noexcept { return errorFnName; }
+    const std::string &action() const noexcept { return errorAction; }
+    const std::string &sqlState() const noexcept { return errorSqlState; }
+    bool isRecoverable() const noexcept { return errorIsRecoverable; }
+private:
+    int32_t errorCode;
+    uint16_t errorOffset;
+    std::string errorFnName;
+    std::string errorAction;
+    std::string errorSqlState;
+    bool errorIsRecoverable;
+};
+
+class DatabaseError : public Error {
+public:
+    explicit DatabaseError(const dpiErrorInfo &info) : Error(info) {}
+};
+
+class InterfaceError : public Error {
+public:
+    explicit InterfaceError(const dpiErrorInfo &info) : Error(info) {}
+};
+
+
+//-----------------------------------------------------------------------------
+// raiseError()
+//   Raise the last error that took place in the context as an exception.
+//-----------------------------------------------------------------------------
+[[noreturn]] inline void raiseError(const dpiContext *context)
+{
+    dpiErrorInfo info;
+
+    dpiContext_getError(context, &info);
+    if (info.code != 0)
+        throw DatabaseError(info);
+    throw InterfaceError(info);
+}
+
+
+//-----------------------------------------------------------------------------
+// check()
+//   Check the status returned by an ODPI-C function and raise the error that
+// took place in the context if the function failed.
+//-----------------------------------------------------------------------------
+inline void check(const dpiContext *context, int status)
+{
+    if (status < 0)
+        raiseError(context);
+}
+
+
+//-----------------------------------------------------------------------------
+// ValueTraits
+//   Compile time mapping of a C++ type to the native type used to fetch it and
+// the extraction of a value of that type from a dpiData structure. Null
+// values are extracted as value initialized objects unless the type is
+// std::optional, in which case they are extracted as std::nullopt.
+//-----------------------------------------------------------------------------
+template <typename T, typename Enable = void>
+struct ValueTraits {
+    static_assert(sizeof(T) == 0, "type cannot be fetched with ODPI-C");
+};
+
+template <typename T>
+struct ValueTraits<T, std::enable_if_t<std::is_integral_v<T> &&
+        std::is_signed_v<T>>> {
+    static constexpr dpiNativeTypeNum nativeTypeNum = DPI_NATIVE_TYPE_INT64;
+    static constexpr bool isNullable = false;
+    static T get(const dpiData &data) noexcept
+    {
+        return data.isNull ? T() : static_cast<T>(data.value.asInt64);
+    }
+};
+
+template <typename T>
+struct ValueTraits<T, std::enable_if_t<std::is_integral_v<T> &&
+        std::is_unsigned_v<T> && !std::is_same_v<T, bool>>> {
+    static constexpr dpiNativeTypeNum nativeTypeNum = DPI_NATIVE_TYPE_UINT64;
+    static constexpr bool isNullable = false;
+    static T get(const dpiData &data) noexcept
+    {
+        return data.isNull ? T() : static_cast<T>(data.value.asUint64);
+    }
+};
+
+template <>
+struct ValueTraits<bool> {
+    static constexpr dpiNativeTypeNum nativeTypeNum = DPI_NATIVE_TYPE_BOOLEAN;
+    static constexpr bool isNullable = false;
+    static bool get(const dpiData &data) noexcept
+    {
+        return !data.isNull && data.value.asBoolean != 0;
+    }
+};
+
+template <>
+struct ValueTraits<double> {
+    static constexpr dpiNativeTypeNum nativeTypeNum = DPI_NATIVE_TYPE_DOUBLE;
+    static constexpr bool isNullable = false;
+    static double get(const dpiData &data) noexcept
+    {
+        return data.isNull ? 0.0 : data.value.asDouble;
+    }
+};
+
+template <>
+struct ValueTraits<float> {
+    static constexpr dpiNativeTypeNum nativeTypeNum = DPI_NATIVE_TYPE_FLOAT;
+    static constexpr bool isNullable = false;
+    static float get(const dpiData &data) noexcept
+    {
+        return data.isNull ? 0.0f : data.value.asFloat;
+    }
+};
+
+template <>
+struct ValueTraits<std::string_view> {
+    static constexpr dpiNativeTypeNum nativeTypeNum = DPI_NATIVE_TYPE_BYTES;
+    static constexpr bool isNullable = false;
+    static std::string_view get(const dpiData &data) noexcept
+    {
+        return data.isNull ? std::string_view() :
+                std::string_view(data.value.asBytes.ptr,
+                        data.value.asBytes.length);
+    }
+};
+
+template <>
+struct ValueTraits<dpiTimestamp> {
+    static constexpr dpiNativeTypeNum nativeTypeNum =
+            DPI_NATIVE_TYPE_TIMESTAMP;
+    static constexpr bool isNullable = false;
+    static dpiTimestamp get(const dpiData &data) noexcept
+    {
+        return data.isNull ? dpiTimestamp() : data.value.asTimestamp;
+    }
+};
+
+template <>
+struct ValueTraits<dpiIntervalDS> {
+    static constexpr dpiNativeTypeNum nativeTypeNum =
+            DPI_NATIVE_TYPE_INTERVAL_DS;
+    static constexpr bool isNullable = false;
+    static dpiIntervalDS get(const dpiData &data) noexcept
+    {
+        return data.isNull ? dpiIntervalDS() : data.value.asIntervalDS;
+    }
+};
+
+template <>
+struct ValueTraits<dpiIntervalYM> {
+    static constexpr dpiNativeTypeNum nativeTypeNum =
+            DPI_NATIVE_TYPE_INTERVAL_YM;
+    static constexpr bool isNullable = false;
+    static dpiIntervalYM get(const dpiData &data) noexcept
+    {
+        return data.isNull ? dpiIntervalYM() : data.value.asIntervalYM;
+    }
+};
+
+template <typename T>
+struct ValueTraits<std::optional<T>> {
+    static constexpr dpiNativeTypeNum nativeTypeNum =
+            ValueTraits<T>::nativeTypeNum;
+    static constexpr bool isNullable = true;
+    static std::optional<T> get(const dpiData &data) noexcept
+    {
+        if (data.isNull)
+            return std::nullopt;
+        return ValueTraits<T>::get(data);
+    }
+};
+
+
+//-----------------------------------------------------------------------------
+// MemberTraits
+//   Compile time decomposition of a pointer to member into the class and the
+// type of the member.
+//-----------------------------------------------------------------------------
+template <typename T>
+struct MemberTraits;
+
+template <typename C, typename T>
+struct MemberTraits<T C::*> {
+    using ClassType = C;
+    using MemberType = T;
+};
+
+
+//-----------------------------------------------------------------------------
+// RowReader
+//   Fetches the rows of an executed query into instances of the structure
+// Row, assigning column i + 1 to the member identified by the i-th pointer to
+// member. A variable is defined for each mapped column, using the native type
+// implied by the type of the member; any remaining columns are fetched using
+// their default native types but are otherwise ignored. The views of byte
+// strings and the rows returned by next() remain valid until the next fetch
+// is performed.
+//-----------------------------------------------------------------------------
+template <typename Row, auto... Members>
+class RowReader {
+public:
+    static constexpr uint32_t numColumns = sizeof...(Members);
+
+    static_assert(numColumns > 0, "at least one column must be mapped");
+    static_assert((std::is_same_v<typename MemberTraits<
+            decltype(Members)>::ClassType, Row> && ...),
+            "all members must belong to the row structure");
+
+    RowReader(dpiContext *context, dpiConn *conn, dpiStmt *stmt,
+            uint32_t fetchArraySize = DPI_DEFAULT_FETCH_ARRAY_SIZE) :
+            context(context), stmt(stmt), fetchArraySize(fetchArraySize),
+            vars(), data(), moreRows(true)
+    {
+        static constexpr dpiNativeTypeNum nativeTypeNums[] = {
+            ValueTraits<typename MemberTraits<
+                    decltype(Members)>::MemberType>::nativeTypeNum...
+        };
+        uint32_t numQueryColumns, pos;
+        dpiQueryInfo info;
+
+        check(context, dpiStmt_getNumQueryColumns(stmt, &numQueryColumns));
+        if (numQueryColumns < numColumns)
+            throw std::invalid_argument("query has too few columns");
+        check(context, dpiStmt_setFetchArraySize(stmt, fetchArraySize));
+        for (pos = 0; pos < numColumns; pos++) {
+            check(context, dpiStmt_getQueryInfo(stmt, pos + 1, &info));
+            if (dpiConn_newVar(conn, info.typeInfo.oracleTypeNum,
+                    nativeTypeNums[pos], fetchArraySize,
+                    info.typeInfo.clientSizeInBytes, 1, 0,
+                    info.typeInfo.objectType, &vars[pos], &data[pos]) < 0) {
+                release();
+                raiseError(context);
+            }
+            if (dpiStmt_define(stmt, pos + 1, vars[pos]) < 0) {
+                release();
+                raiseError(context);
+            }
+        }
+    }
+
+    RowReader(const RowReader&) = delete;
+    RowReader &operator=(const RowReader&) = delete;
+
+    ~RowReader()
+    {
+        release();
+    }
+
+    // fetch the next batch of rows; an empty span is returned when all rows
+    // have been fetched
+    Span<const Row> next()
+    {
+        uint32_t bufferRowIndex, numRowsFetched;
+
+        if (!fetch(&bufferRowIndex, &numRowsFetched))
+            return Span<const Row>();
+        rows.resize(numRowsFetched);
+        for (uint32_t i = 0; i < numRowsFetched; i++)
+            extract(rows[i], bufferRowIndex + i,
+                    std::make_index_sequence<numColumns>());
+        return Span<const Row>(rows.data(), rows.size());
+    }
+
+    // fetch all remaining rows, calling the function with each one without
+    // storing the rows; the number of rows fetched is returned
+    template <typename Function>
+    uint64_t forEach(Function &&function)
+    {
+        uint32_t bufferRowIndex, numRowsFetched;
+        uint64_t numRows = 0;
+        Row row;
+
+        while (fetch(&bufferRowIndex, &numRowsFetched)) {
+            for (uint32_t i = 0; i < numRowsFetched; i++) {
+                extract(row, bufferRowIndex + i,
+                        std::make_index_sequence<numColumns>());
+                function(static_cast<const Row&>(row));
+            }
+            numRows += numRowsFetched;
+        }
+        return numRows;
+    }
+
+private:
+    dpiContext *context;
+    dpiStmt *stmt;
+    uint32_t fetchArraySize;
+    dpiVar *vars[numColumns];
+    dpiData *data[numColumns];
+    std::vector<Row> rows;
+    bool moreRows;
+
+    // assign each mapped member from the corresponding defined variable
+    template <std::size_t... Pos>
+    void extract(Row &row, uint32_t rowNum, std::index_sequence<Pos...>)
+            const noexcept
+    {
+        ((row.*Members = ValueTraits<typename MemberTraits<
+                decltype(Members)>::MemberType>::get(data[Pos][rowNum])), ...);
+    }
+
+    // fetch the next batch of rows into the defined variables
+    bool fetch(uint32_t *bufferRowIndex, uint32_t *numRowsFetched)
+    {
+        int moreRowsToFetch;
+
+        if (!moreRows)
+            return false;
+        check(context, dpiStmt_fetchRows(stmt, fetchArraySize,
+                bufferRowIndex, numRowsFetched, &moreRowsToFetch));
+        moreRows = (moreRowsToFetch != 0);
+        return *numRowsFetched > 0;
+    }
+
+    // release the defined variables
+    void release() noexcept
+    {
+        for (uint32_t pos = 0; pos < numColumns; pos++) {
+            if (vars[pos]) {
+                dpiVar_release(vars[pos]);
+                vars[pos] = nullptr;
+            }
+        }
+    }
+};
+
+}
+
+#endif
@@ -0,0 +1,94 @@
+//-----------------------------------------------------------------------------
+// Copyright (c) 2017 Oracle and/or its affiliates.  All rights reserved.
+// This program is free software: you can modify it and/or redistribute it
+// under the terms of:
+//
+// (i)  the Universal Permissive License v 1.0 or at your option, any
+//      later version (http://oss.oracle.com/licenses/upl); and/or
+//
+// (ii) the Apache License v 2.0. (http://www.apache.org/licenses/LICENSE-2.0)
+//-----------------------------------------------------------------------------
+
+//-----------------------------------------------------------------------------
+// TestAutoBind.c
+//   Measures the time taken to prepare, execute and fetch a large number of
+// queries which differ only in their literals, as generated by applications
+// which build SQL with inline literals, first with the default prepare mode
+// (each query is hard parsed by the database) and then with the prepare mode
+// DPI_MODE_PREPARE_AUTO_BIND (the literals are replaced by bind variables and
+// each query is found in the statement cache).
+//-----------------------------------------------------------------------------
+
+#include "SampleLib.h"
+#include <time.h>
+#define NUM_QUERIES                     10000
+
+//-----------------------------------------------------------------------------
+// runQueries()
+//   Prepare, execute and fetch the queries using a connection created with
+// the given prepare mode.
+//-----------------------------------------------------------------------------
+static int runQueries(const char *label, dpiPrepareMode prepareMode)
+{
+    dpiCommonCreateParams commonParams;
+    uint32_t i, sqlLength, bufferRowIndex;
+    struct timespec start, now;
+    dpiSampleParams *params;
+    const char *preparedSql;
+    char sql[200];
+    dpiConn *conn;
+    dpiStmt *stmt;
+    double elapsed;
+    int found;
+
+    // connect to the database using the prepare mode
+    params = dpiSamples_getParams();
+    if (dpiContext_initCommonCreateParams(params->context, &commonParams) < 0)
+        return dpiSamples_showError();
+    commonParams.prepareMode = prepareMode;
+    conn = dpiSamples_getConn(0, &commonParams);
+
+    // run each query in turn
+    timespec_get(&start, TIME_UTC);
+    for (i = 0; i < NUM_QUERIES; i++) {
+        sqlLength = (uint32_t) snprintf(sql, sizeof(sql),
+                "select count(*) from user_objects\n"
+                "where object_name <> 'OBJECT %u' and object_id > %u", i, i);
+        if (dpiConn_prepareStmt(conn, 0, sql, sqlLength, NULL, 0, &stmt) < 0)
+            return dpiSamples_showError();
+        if (dpiStmt_execute(stmt, DPI_MODE_EXEC_DEFAULT, NULL) < 0)
+            return dpiSamples_showError();
+        if (dpiStmt_fetch(stmt, &found, &bufferRowIndex) < 0)
+            return dpiSamples_showError();
+        if (i == NUM_QUERIES - 1) {
+            if (dpiStmt_getSql(stmt, &preparedSql, &sqlLength) < 0)
+                return dpiSamples_showError();
+            printf("%s:\n    Last SQL prepared: %.*s\n", label,
+                    sqlLength, preparedSql);
+        }
+        dpiStmt_release(stmt);
+    }
+    timespec_get(&now, TIME_UTC);
+    elapsed = (double) (now.tv_sec - start.tv_sec) +
+            (double) (now.tv_nsec - start.tv_nsec) / 1000000000.0;
+    printf("    %u queries in %.3f seconds (%.1f queries/s)\n", NUM_QUERIES,
+            elapsed, NUM_QUERIES / elapsed);
+
+    dpiConn_release(conn);
+    return 0;
+}
+
+
+//-----------------------------------------------------------------------------
+// main()
+//-----------------------------------------------------------------------------
+int main(int argc, char **argv)
+{
+    if (runQueries("Default prepare mode", DPI_MODE_PREPARE_DEFAULT) < 0)
+        return -1;
+    if (runQueries("Auto bind prepare mode", DPI_MODE_PREPARE_AUTO_BIND) < 0)
+        return -1;
+
+    printf("Done.\n");
+    return 0;
+}
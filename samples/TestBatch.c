@@ -0,0 +1,146 @@
+//-----------------------------------------------------------------------------
+// Copyright (c) 2017 Oracle and/or its affiliates.  All rights reserved.
+// This program is free software: you can modify it and/or redistribute it
+// under the terms of:
+//
+// (i)  the Universal Permissive License v 1.0 or at your option, any
+//      later version (http://oss.oracle.com/licenses/upl); and/or
+//
+// (ii) the Apache License v 2.0. (http://www.apache.org/licenses/LICENSE-2.0)
+//-----------------------------------------------------------------------------
+
+//-----------------------------------------------------------------------------
+// TestBatch.c
+//   Measures the time taken to process a large number of requests, each of
+// which executes the same four small DML statements, first by calling
+// dpiStmt_execute() for each statement (one round trip per statement) and
+// then by adding the statements to a batch and calling dpiBatch_execute()
+// (one round trip per request).
+//-----------------------------------------------------------------------------
+
+#include "SampleLib.h"
+#include <time.h>
+#define NUM_REQUESTS                    2000
+#define NUM_STMTS                       4
+
+static const char *sqls[NUM_STMTS] = {
+    "insert into TestTempTable (IntCol, StringCol) values (:1, 'New')",
+    "update TestTempTable set StringCol = 'Updated' where IntCol = :1",
+    "update TestTempTable set StringCol = StringCol || ' again' "
+            "where IntCol = :1",
+    "delete from TestTempTable where IntCol = :1"
+};
+
+//-----------------------------------------------------------------------------
+// getElapsed()
+//   Return the number of seconds of wall clock time elapsed since the start
+// time.
+//-----------------------------------------------------------------------------
+static double getElapsed(const struct timespec *start)
+{
+    struct timespec now;
+
+    timespec_get(&now, TIME_UTC);
+    return (double) (now.tv_sec - start->tv_sec) +
+            (double) (now.tv_nsec - start->tv_nsec) / 1000000000.0;
+}
+
+
+//-----------------------------------------------------------------------------
+// runStmts()
+//   Process the requests by executing each statement in turn.
+//-----------------------------------------------------------------------------
+static int runStmts(dpiStmt **stmts, dpiData *bindValue)
+{
+    struct timespec start;
+    uint32_t i, j;
+
+    timespec_get(&start, TIME_UTC);
+    for (i = 0; i < NUM_REQUESTS; i++) {
+        bindValue->value.asInt64 = i;
+        for (j = 0; j < NUM_STMTS; j++) {
+            if (dpiStmt_execute(stmts[j], DPI_MODE_EXEC_DEFAULT, NULL) < 0)
+                return dpiSamples_showError();
+        }
+    }
+    printf("Statement by statement: %.3f seconds\n", getElapsed(&start));
+    return 0;
+}
+
+
+//-----------------------------------------------------------------------------
+// runBatch()
+//   Process the requests by executing the statements as a batch.
+//-----------------------------------------------------------------------------
+static int runBatch(dpiConn *conn, dpiStmt **stmts, dpiData *bindValue)
+{
+    uint32_t i, numRowCounts;
+    struct timespec start;
+    uint64_t *rowCounts;
+    dpiBatch *batch;
+
+    if (dpiConn_newBatch(conn, &batch) < 0)
+        return dpiSamples_showError();
+    for (i = 0; i < NUM_STMTS; i++) {
+        if (dpiBatch_addStmt(batch, stmts[i]) < 0)
+            return dpiSamples_showError();
+    }
+    timespec_get(&start, TIME_UTC);
+    for (i = 0; i < NUM_REQUESTS; i++) {
+        bindValue->value.asInt64 = i;
+        if (dpiBatch_execute(batch, DPI_MODE_EXEC_DEFAULT) < 0)
+            return dpiSamples_showError();
+    }
+    printf("Batch: %.3f seconds\n", getElapsed(&start));
+    if (dpiBatch_getRowCounts(batch, &numRowCounts, &rowCounts) < 0)
+        return dpiSamples_showError();
+    for (i = 0; i < numRowCounts; i++)
+        printf("    Statement %u: %" PRIu64 " row(s) in last request\n", i,
+                rowCounts[i]);
+    dpiBatch_release(batch);
+    return 0;
+}
+
+
+//-----------------------------------------------------------------------------
+// main()
+//-----------------------------------------------------------------------------
+int main(int argc, char **argv)
+{
+    dpiStmt *stmts[NUM_STMTS];
+    dpiData *bindValue;
+    dpiConn *conn;
+    dpiVar *var;
+    uint32_t i;
+
+    // connect to database, create the bind variable and prepare statements
+    conn = dpiSamples_getConn(0, NULL);
+    if (dpiConn_newVar(conn, DPI_ORACLE_TYPE_NUMBER, DPI_NATIVE_TYPE_INT64, 1,
+            0, 0, 0, NULL, &var, &bindValue) < 0)
+        return dpiSamples_showError();
+    bindValue->isNull = 0;
+    for (i = 0; i < NUM_STMTS; i++) {
+        if (dpiConn_prepareStmt(conn, 0, sqls[i], strlen(sqls[i]), NULL, 0,
+                &stmts[i]) < 0)
+            return dpiSamples_showError();
+        if (dpiStmt_bindByPos(stmts[i], 1, var) < 0)
+            return dpiSamples_showError();
+    }
+
+    // process the requests both ways
+    if (runStmts(stmts, bindValue) < 0)
+        return -1;
+    if (runBatch(conn, stmts, bindValue) < 0)
+        return -1;
+
+    // clean up
+    if (dpiConn_rollback(conn) < 0)
+        return dpiSamples_showError();
+    for (i = 0; i < NUM_STMTS; i++)
+        dpiStmt_release(stmts[i]);
+    dpiVar_release(var);
+    dpiConn_release(conn);
+
+    printf("Done.\n");
+    return 0;
+}
@@ -0,0 +1,232 @@
+//-----------------------------------------------------------------------------
+// Copyright (c) 2017 Oracle and/or its affiliates.  All rights reserved.
+// This program is free software: you can modify it and/or redistribute it
+// under the terms of:
+//
+// (i)  the Universal Permissive License v 1.0 or at your option, any
+//      later version (http://oss.oracle.com/licenses/upl); and/or
+//
+// (ii) the Apache License v 2.0. (http://www.apache.org/licenses/LICENSE-2.0)
+//-----------------------------------------------------------------------------
+
+//-----------------------------------------------------------------------------
+// TestFetchAggregates.c
+//   Measures the time taken to compute the count, sum, minimum and maximum of
+// a large number of rows grouped by a low cardinality column, first by
+// fetching each row and aggregating its values in the application and then
+// with dpiStmt_fetchAggregates().
+//-----------------------------------------------------------------------------
+
+#include "SampleLib.h"
+#include <time.h>
+#define SQL_TEXT            "select mod(level, 10), level, to_char(level) " \
+                            "from dual connect by level <= :1"
+#define NUM_ROWS            1000000
+#define NUM_GROUPS          10
+#define FETCH_ARRAY_SIZE    1000
+
+// aggregates computed for each group in the application
+typedef struct {
+    uint64_t count;
+    int64_t sum;
+    char min[40];
+    uint32_t minLength;
+    char max[40];
+    uint32_t maxLength;
+} sampleGroup;
+
+
+//-----------------------------------------------------------------------------
+// compareBytes()
+//   Compare the byte strings in the same way as the database compares raw
+// data.
+//-----------------------------------------------------------------------------
+static int compareBytes(const char *ptr1, uint32_t length1, const char *ptr2,
+        uint32_t length2)
+{
+    int result;
+
+    result = memcmp(ptr1, ptr2, (length1 < length2) ? length1 : length2);
+    if (result == 0)
+        result = (length1 > length2) - (length1 < length2);
+    return result;
+}
+
+
+//-----------------------------------------------------------------------------
+// executeQuery()
+//   Prepare and execute the query, defining the first two columns as
+// integers.
+//-----------------------------------------------------------------------------
+static dpiStmt *executeQuery(dpiConn *conn, dpiVar *var)
+{
+    uint32_t numQueryColumns;
+    dpiStmt *stmt;
+
+    if (dpiConn_prepareStmt(conn, 0, SQL_TEXT, strlen(SQL_TEXT), NULL, 0,
+            &stmt) < 0)
+        return NULL;
+    if (dpiStmt_setFetchArraySize(stmt, FETCH_ARRAY_SIZE) < 0)
+        return NULL;
+    if (dpiStmt_bindByPos(stmt, 1, var) < 0)
+        return NULL;
+    if (dpiStmt_execute(stmt, 0, &numQueryColumns) < 0)
+        return NULL;
+    if (dpiStmt_defineValue(stmt, 1, DPI_ORACLE_TYPE_NUMBER,
+            DPI_NATIVE_TYPE_INT64, 0, 0, NULL) < 0)
+        return NULL;
+    if (dpiStmt_defineValue(stmt, 2, DPI_ORACLE_TYPE_NUMBER,
+            DPI_NATIVE_TYPE_INT64, 0, 0, NULL) < 0)
+        return NULL;
+    return stmt;
+}
+
+
+//-----------------------------------------------------------------------------
+// runRowByRow()
+//   Fetch each row and aggregate its values in the application.
+//-----------------------------------------------------------------------------
+static int runRowByRow(dpiConn *conn, dpiVar *var)
+{
+    sampleGroup groups[NUM_GROUPS], *group;
+    dpiNativeTypeNum nativeTypeNum;
+    dpiData *keyValue, *intValue;
+    uint32_t bufferRowIndex, i;
+    dpiData *stringValue;
+    dpiBytes *bytes;
+    clock_t start;
+    double elapsed;
+    dpiStmt *stmt;
+    int found;
+
+    memset(groups, 0, sizeof(groups));
+    start = clock();
+    stmt = executeQuery(conn, var);
+    if (!stmt)
+        return dpiSamples_showError();
+    while (1) {
+        if (dpiStmt_fetch(stmt, &found, &bufferRowIndex) < 0)
+            return dpiSamples_showError();
+        if (!found)
+            break;
+        if (dpiStmt_getQueryValue(stmt, 1, &nativeTypeNum, &keyValue) < 0 ||
+                dpiStmt_getQueryValue(stmt, 2, &nativeTypeNum,
+                        &intValue) < 0 ||
+                dpiStmt_getQueryValue(stmt, 3, &nativeTypeNum,
+                        &stringValue) < 0)
+            return dpiSamples_showError();
+        group = &groups[keyValue->value.asInt64];
+        bytes = &stringValue->value.asBytes;
+        group->count++;
+        group->sum += intValue->value.asInt64;
+        if (group->count == 1 || compareBytes(bytes->ptr, bytes->length,
+                group->min, group->minLength) < 0) {
+            memcpy(group->min, bytes->ptr, bytes->length);
+            group->minLength = bytes->length;
+        }
+        if (group->count == 1 || compareBytes(bytes->ptr, bytes->length,
+                group->max, group->maxLength) > 0) {
+            memcpy(group->max, bytes->ptr, bytes->length);
+            group->maxLength = bytes->length;
+        }
+    }
+    elapsed = (double) (clock() - start) / CLOCKS_PER_SEC;
+    dpiStmt_release(stmt);
+
+    printf("Row by row:\n");
+    for (i = 0; i < NUM_GROUPS; i++)
+        printf("    Group %u: count %" PRIu64 ", sum %" PRId64
+                ", min '%.*s', max '%.*s'\n", i, groups[i].count,
+                groups[i].sum, groups[i].minLength, groups[i].min,
+                groups[i].maxLength, groups[i].max);
+    printf("    Elapsed CPU time: %.3f seconds\n", elapsed);
+    return 0;
+}
+
+
+//-----------------------------------------------------------------------------
+// runAggregates()
+//   Fetch all rows with dpiStmt_fetchAggregates().
+//-----------------------------------------------------------------------------
+static int runAggregates(dpiConn *conn, dpiVar *var)
+{
+    dpiAggregateSpec specs[4] = {
+        { DPI_AGGREGATE_COUNT, 0 },
+        { DPI_AGGREGATE_SUM, 2 },
+        { DPI_AGGREGATE_MIN, 3 },
+        { DPI_AGGREGATE_MAX, 3 }
+    };
+    dpiData *key, *count, *sum, *min, *max;
+    dpiNativeTypeNum nativeTypeNum;
+    dpiAggregateResult *result;
+    uint32_t numGroups, i;
+    clock_t start;
+    double elapsed;
+    dpiStmt *stmt;
+
+    start = clock();
+    stmt = executeQuery(conn, var);
+    if (!stmt)
+        return dpiSamples_showError();
+    if (dpiStmt_fetchAggregates(stmt, 4, specs, 1, &result) < 0)
+        return dpiSamples_showError();
+    elapsed = (double) (clock() - start) / CLOCKS_PER_SEC;
+    dpiStmt_release(stmt);
+
+    printf("Aggregated by ODPI-C:\n");
+    if (dpiAggregateResult_getNumGroups(result, &numGroups) < 0)
+        return dpiSamples_showError();
+    for (i = 0; i < numGroups; i++) {
+        if (dpiAggregateResult_getGroupKey(result, i, &nativeTypeNum,
+                &key) < 0 ||
+                dpiAggregateResult_getValue(result, i, 0, &nativeTypeNum,
+                        &count) < 0 ||
+                dpiAggregateResult_getValue(result, i, 1, &nativeTypeNum,
+                        &sum) < 0 ||
+                dpiAggregateResult_getValue(result, i, 2, &nativeTypeNum,
+                        &min) < 0 ||
+                dpiAggregateResult_getValue(result, i, 3, &nativeTypeNum,
+                        &max) < 0)
+            return dpiSamples_showError();
+        printf("    Group %" PRId64 ": count %" PRIu64 ", sum %" PRId64
+                ", min '%.*s', max '%.*s'\n", key->value.asInt64,
+                count->value.asUint64, sum->value.asInt64,
+                min->value.asBytes.length, min->value.asBytes.ptr,
+                max->value.asBytes.length, max->value.asBytes.ptr);
+    }
+    printf("    Elapsed CPU time: %.3f seconds\n", elapsed);
+    dpiAggregateResult_release(result);
+    return 0;
+}
+
+
+//-----------------------------------------------------------------------------
+// main()
+//-----------------------------------------------------------------------------
+int main(int argc, char **argv)
+{
+    dpiData *bindValue;
+    dpiConn *conn;
+    dpiVar *var;
+
+    // connect to database and create the bind variable
+    conn = dpiSamples_getConn(0, NULL);
+    if (dpiConn_newVar(conn, DPI_ORACLE_TYPE_NUMBER, DPI_NATIVE_TYPE_INT64, 1,
+            0, 0, 0, NULL, &var, &bindValue) < 0)
+        return dpiSamples_showError();
+    bindValue->isNull = 0;
+    bindValue->value.asInt64 = NUM_ROWS;
+
+    // aggregate the rows both ways
+    if (runRowByRow(conn, var) < 0)
+        return -1;
+    if (runAggregates(conn, var) < 0)
+        return -1;
+
+    // clean up
+    dpiVar_release(var);
+    dpiConn_release(conn);
+
+    printf("Done.\n");
+    return 0;
+}
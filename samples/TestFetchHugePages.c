@@ -0,0 +1,137 @@
+//-----------------------------------------------------------------------------
+// Copyright (c) 2017 Oracle and/or its affiliates.  All rights reserved.
+// This program is free software: you can modify it and/or redistribute it
+// under the terms of:
+//
+// (i)  the Universal Permissive License v 1.0 or at your option, any
+//      later version (http://oss.oracle.com/licenses/upl); and/or
+//
+// (ii) the Apache License v 2.0. (http://www.apache.org/licenses/LICENSE-2.0)
+//-----------------------------------------------------------------------------
+
+//-----------------------------------------------------------------------------
+// TestFetchHugePages.c
+//   Measures the rows fetched per second and the number of page faults
+// incurred when fetching a large number of rows with a large fetch array
+// size, first with buffers allocated in the default way and then with buffers
+// backed by pre-faulted huge pages.
+//-----------------------------------------------------------------------------
+
+#include "SampleLib.h"
+#include <time.h>
+#ifndef _WIN32
+#include <sys/resource.h>
+#endif
+#define SQL_TEXT            "select level, rpad('X', 200, 'X') " \
+                            "from dual connect by level <= :1"
+#define NUM_ROWS            1000000
+#define FETCH_ARRAY_SIZE    20000
+
+//-----------------------------------------------------------------------------
+// getPageFaults()
+//   Return the number of page faults incurred by the process so far, or 0 if
+// this information is not available on this platform.
+//-----------------------------------------------------------------------------
+static uint64_t getPageFaults(void)
+{
+#ifdef _WIN32
+    return 0;
+#else
+    struct rusage usage;
+
+    if (getrusage(RUSAGE_SELF, &usage) < 0)
+        return 0;
+    return (uint64_t) (usage.ru_minflt + usage.ru_majflt);
+#endif
+}
+
+
+//-----------------------------------------------------------------------------
+// runFetch()
+//   Fetch all of the rows using a connection created with the specified
+// buffer mode and display the results.
+//-----------------------------------------------------------------------------
+static int runFetch(const char *label, dpiBufferMode bufferMode)
+{
+    uint64_t numRows, startFaults, numFaults;
+    uint32_t numQueryColumns, bufferRowIndex;
+    dpiCommonCreateParams commonParams;
+    dpiSampleParams *params;
+    dpiData *bindValue;
+    clock_t start;
+    double elapsed;
+    dpiStmt *stmt;
+    dpiConn *conn;
+    dpiVar *var;
+    int found;
+
+    // connect to database using the requested buffer mode
+    params = dpiSamples_getParams();
+    if (dpiContext_initCommonCreateParams(params->context, &commonParams) < 0)
+        return dpiSamples_showError();
+    commonParams.bufferMode = bufferMode;
+    conn = dpiSamples_getConn(0, &commonParams);
+
+    // create the bind variable
+    if (dpiConn_newVar(conn, DPI_ORACLE_TYPE_NUMBER, DPI_NATIVE_TYPE_INT64, 1,
+            0, 0, 0, NULL, &var, &bindValue) < 0)
+        return dpiSamples_showError();
+    bindValue->isNull = 0;
+    bindValue->value.asInt64 = NUM_ROWS;
+
+    // prepare and execute statement
+    startFaults = getPageFaults();
+    start = clock();
+    if (dpiConn_prepareStmt(conn, 0, SQL_TEXT, strlen(SQL_TEXT), NULL, 0,
+            &stmt) < 0)
+        return dpiSamples_showError();
+    if (dpiStmt_setFetchArraySize(stmt, FETCH_ARRAY_SIZE) < 0)
+        return dpiSamples_showError();
+    if (dpiStmt_bindByPos(stmt, 1, var) < 0)
+        return dpiSamples_showError();
+    if (dpiStmt_execute(stmt, 0, &numQueryColumns) < 0)
+        return dpiSamples_showError();
+
+    // fetch all rows
+    numRows = 0;
+    while (1) {
+        if (dpiStmt_fetch(stmt, &found, &bufferRowIndex) < 0)
+            return dpiSamples_showError();
+        if (!found)
+            break;
+        numRows++;
+    }
+    elapsed = (double) (clock() - start) / CLOCKS_PER_SEC;
+    numFaults = getPageFaults() - startFaults;
+
+    // display results
+    printf("%s:\n", label);
+    printf("    Rows fetched: %" PRIu64 "\n", numRows);
+    printf("    Page faults: %" PRIu64 "\n", numFaults);
+    printf("    Elapsed CPU time: %.3f seconds (%.0f rows/second)\n", elapsed,
+            (elapsed > 0) ? numRows / elapsed : 0.0);
+
+    // clean up
+    dpiVar_release(var);
+    dpiStmt_release(stmt);
+    dpiConn_release(conn);
+
+    return 0;
+}
+
+
+//-----------------------------------------------------------------------------
+// main()
+//-----------------------------------------------------------------------------
+int main(int argc, char **argv)
+{
+    if (runFetch("Default buffers", DPI_MODE_BUFFER_DEFAULT) < 0)
+        return -1;
+    if (runFetch("Huge page buffers",
+            DPI_MODE_BUFFER_HUGE_PAGES | DPI_MODE_BUFFER_PREFAULT) < 0)
+        return -1;
+
+    printf("Done.\n");
+    return 0;
+}
+
@@ -0,0 +1,198 @@
+//-----------------------------------------------------------------------------
+// Copyright (c) 2017 Oracle and/or its affiliates.  All rights reserved.
+// This program is free software: you can modify it and/or redistribute it
+// under the terms of:
+//
+// (i)  the Universal Permissive License v 1.0 or at your option, any
+//      later version (http://oss.oracle.com/licenses/upl); and/or
+//
+// (ii) the Apache License v 2.0. (http://www.apache.org/licenses/LICENSE-2.0)
+//-----------------------------------------------------------------------------
+
+//-----------------------------------------------------------------------------
+// TestFetchObjectLobs.c
+//   Measures the time taken to iterate over a large nested collection of
+// objects containing CLOB attributes. Only one in every LOB_READ_INTERVAL
+// CLOBs is actually read; the rest are only checked for null, which is the
+// access pattern that benefits from LOBs being borrowed from the object.
+//-----------------------------------------------------------------------------
+
+#include "SampleLib.h"
+#include <time.h>
+#define SQL_TEXT            "select cast(multiset(" \
+                            "    select udt_LobObjectGroup(g.column_value, " \
+                            "        cast(multiset(" \
+                            "            select udt_LobObject(level, " \
+                            "                case when mod(level, 7) != 0 " \
+                            "                then to_clob('Member ' || level) " \
+                            "                end) " \
+                            "            from dual " \
+                            "            connect by level <= :1" \
+                            "        ) as udt_LobObjectArray)) " \
+                            "    from table(sys.odcinumberlist(" \
+                            "        1, 2, 3, 4, 5, 6, 7, 8, 9, 10)) g" \
+                            ") as udt_LobObjectGroups) " \
+                            "from dual"
+#define NUM_MEMBERS         5000
+#define NUM_ITERATIONS      5
+#define LOB_READ_INTERVAL   100
+
+//-----------------------------------------------------------------------------
+// getAttributes()
+//   Return the element type of the collection type and its attributes.
+//-----------------------------------------------------------------------------
+static int getAttributes(dpiObjectType *collectionType,
+        dpiObjectType **elementType, dpiObjectAttr **attrs)
+{
+    dpiObjectTypeInfo typeInfo;
+
+    if (dpiObjectType_getInfo(collectionType, &typeInfo) < 0)
+        return -1;
+    *elementType = typeInfo.elementTypeInfo.objectType;
+    return dpiObjectType_getAttributes(*elementType, 2, attrs);
+}
+
+
+//-----------------------------------------------------------------------------
+// iterateMembers()
+//   Iterate over the members of a group, checking every CLOB for null and
+// reading the size of every LOB_READ_INTERVAL'th one.
+//-----------------------------------------------------------------------------
+static int iterateMembers(dpiObject *members, dpiObjectAttr **memberAttrs,
+        uint64_t *numMembers, uint64_t *numNulls, uint64_t *numRead)
+{
+    dpiData memberValue, attrValue;
+    int32_t index;
+    uint64_t size;
+    int exists;
+
+    if (dpiObject_getFirstIndex(members, &index, &exists) < 0)
+        return -1;
+    while (exists) {
+        if (dpiObject_getElementValueByIndex(members, index,
+                DPI_NATIVE_TYPE_OBJECT, &memberValue) < 0)
+            return -1;
+        if (dpiObject_getAttributeValue(memberValue.value.asObject,
+                memberAttrs[1], DPI_NATIVE_TYPE_LOB, &attrValue) < 0)
+            return -1;
+        if (attrValue.isNull)
+            (*numNulls)++;
+        else if (*numMembers % LOB_READ_INTERVAL == 0) {
+            if (dpiLob_getSize(attrValue.value.asLOB, &size) < 0)
+                return -1;
+            (*numRead)++;
+        }
+        (*numMembers)++;
+        dpiObject_release(memberValue.value.asObject);
+        if (dpiObject_getNextIndex(members, index, &index, &exists) < 0)
+            return -1;
+    }
+
+    return 0;
+}
+
+
+//-----------------------------------------------------------------------------
+// main()
+//-----------------------------------------------------------------------------
+int main(int argc, char **argv)
+{
+    dpiObjectAttr *groupAttrs[2], *memberAttrs[2];
+    uint64_t numMembers, numNulls, numRead;
+    uint32_t numQueryColumns, bufferRowIndex;
+    dpiData *groupsValue, groupValue, value;
+    dpiObjectType *groupType, *memberType;
+    dpiNativeTypeNum nativeTypeNum;
+    dpiObjectAttrInfo attrInfo;
+    int found, exists, i;
+    dpiQueryInfo queryInfo;
+    dpiData *bindValue;
+    int32_t index;
+    clock_t start;
+    double elapsed;
+    dpiStmt *stmt;
+    dpiConn *conn;
+    dpiVar *var;
+
+    // connect to database and create the bind variable
+    conn = dpiSamples_getConn(0, NULL);
+    if (dpiConn_newVar(conn, DPI_ORACLE_TYPE_NUMBER, DPI_NATIVE_TYPE_INT64, 1,
+            0, 0, 0, NULL, &var, &bindValue) < 0)
+        return dpiSamples_showError();
+    bindValue->isNull = 0;
+    bindValue->value.asInt64 = NUM_MEMBERS;
+
+    // prepare and execute statement
+    if (dpiConn_prepareStmt(conn, 0, SQL_TEXT, strlen(SQL_TEXT), NULL, 0,
+            &stmt) < 0)
+        return dpiSamples_showError();
+    if (dpiStmt_bindByPos(stmt, 1, var) < 0)
+        return dpiSamples_showError();
+    if (dpiStmt_execute(stmt, 0, &numQueryColumns) < 0)
+        return dpiSamples_showError();
+    if (dpiStmt_fetch(stmt, &found, &bufferRowIndex) < 0)
+        return dpiSamples_showError();
+    if (!found) {
+        printf("No rows returned!\n");
+        return 1;
+    }
+    if (dpiStmt_getQueryValue(stmt, 1, &nativeTypeNum, &groupsValue) < 0)
+        return dpiSamples_showError();
+
+    // determine the types and attributes of the nested collections
+    if (dpiStmt_getQueryInfo(stmt, 1, &queryInfo) < 0)
+        return dpiSamples_showError();
+    if (getAttributes(queryInfo.typeInfo.objectType, &groupType,
+            groupAttrs) < 0)
+        return dpiSamples_showError();
+    if (dpiObjectAttr_getInfo(groupAttrs[1], &attrInfo) < 0)
+        return dpiSamples_showError();
+    if (getAttributes(attrInfo.typeInfo.objectType, &memberType,
+            memberAttrs) < 0)
+        return dpiSamples_showError();
+
+    // iterate over the nested collections several times
+    numMembers = numNulls = numRead = 0;
+    start = clock();
+    for (i = 0; i < NUM_ITERATIONS; i++) {
+        if (dpiObject_getFirstIndex(groupsValue->value.asObject, &index,
+                &exists) < 0)
+            return dpiSamples_showError();
+        while (exists) {
+            if (dpiObject_getElementValueByIndex(groupsValue->value.asObject,
+                    index, DPI_NATIVE_TYPE_OBJECT, &groupValue) < 0)
+                return dpiSamples_showError();
+            if (dpiObject_getAttributeValue(groupValue.value.asObject,
+                    groupAttrs[1], DPI_NATIVE_TYPE_OBJECT, &value) < 0)
+                return dpiSamples_showError();
+            if (iterateMembers(value.value.asObject, memberAttrs, &numMembers,
+                    &numNulls, &numRead) < 0)
+                return dpiSamples_showError();
+            dpiObject_release(value.value.asObject);
+            dpiObject_release(groupValue.value.asObject);
+            if (dpiObject_getNextIndex(groupsValue->value.asObject, index,
+                    &index, &exists) < 0)
+                return dpiSamples_showError();
+        }
+    }
+    elapsed = (double) (clock() - start) / CLOCKS_PER_SEC;
+
+    // display results
+    printf("Members iterated: %" PRIu64 " (%" PRIu64 " null, %" PRIu64
+            " read)\n", numMembers, numNulls, numRead);
+    printf("Elapsed CPU time: %.3f seconds (%.0f members/second)\n", elapsed,
+            (elapsed > 0) ? numMembers / elapsed : 0.0);
+
+    // clean up
+    for (i = 0; i < 2; i++) {
+        dpiObjectAttr_release(groupAttrs[i]);
+        dpiObjectAttr_release(memberAttrs[i]);
+    }
+    dpiVar_release(var);
+    dpiStmt_release(stmt);
+    dpiConn_release(conn);
+
+    printf("Done.\n");
+    return 0;
+}
+
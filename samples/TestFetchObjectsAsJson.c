@@ -0,0 +1,95 @@
+//-----------------------------------------------------------------------------
+// Copyright (c) 2016 Oracle and/or its affiliates.  All rights reserved.
+// This program is free software: you can modify it and/or redistribute it
+// under the terms of:
+//
+// (i)  the Universal Permissive License v 1.0 or at your option, any
+//      later version (http://oss.oracle.com/licenses/upl); and/or
+//
+// (ii) the Apache License v 2.0. (http://www.apache.org/licenses/LICENSE-2.0)
+//-----------------------------------------------------------------------------
+
+//-----------------------------------------------------------------------------
+// TestFetchObjectsAsJson.c
+//   Tests fetching objects and serializing them as JSON, both to a buffer and
+// to a callback which writes the JSON to stdout.
+//-----------------------------------------------------------------------------
+
+#include "SampleLib.h"
+#define SQL_TEXT            "select ObjectCol " \
+                            "from TestObjects " \
+                            "order by IntCol"
+
+//-----------------------------------------------------------------------------
+// writeToStdout()
+//   Callback used for writing JSON to stdout.
+//-----------------------------------------------------------------------------
+static int writeToStdout(void *context, const char *data, uint32_t dataLength)
+{
+    if (fwrite(data, 1, dataLength, stdout) != dataLength)
+        return -1;
+    return 0;
+}
+
+
+//-----------------------------------------------------------------------------
+// main()
+//-----------------------------------------------------------------------------
+int main(int argc, char **argv)
+{
+    uint32_t numQueryColumns, bufferRowIndex;
+    dpiNativeTypeNum nativeTypeNum;
+    dpiJsonBuffer buffer;
+    dpiData *objColValue;
+    dpiStmt *stmt;
+    dpiConn *conn;
+    int found;
+
+    // connect to database
+    conn = dpiSamples_getConn(1, NULL);
+
+    // prepare and execute statement
+    if (dpiConn_prepareStmt(conn, 0, SQL_TEXT, strlen(SQL_TEXT), NULL, 0,
+            &stmt) < 0)
+        return dpiSamples_showError();
+    if (dpiStmt_execute(stmt, 0, &numQueryColumns) < 0)
+        return dpiSamples_showError();
+
+    // fetch rows
+    memset(&buffer, 0, sizeof(buffer));
+    while (1) {
+        if (dpiStmt_fetch(stmt, &found, &bufferRowIndex) < 0)
+            return dpiSamples_showError();
+        if (!found)
+            break;
+        if (dpiStmt_getQueryValue(stmt, 1, &nativeTypeNum, &objColValue) < 0)
+            return dpiSamples_showError();
+        if (objColValue->isNull) {
+            printf("Row: null\n");
+            continue;
+        }
+
+        // serialize to a buffer
+        buffer.length = 0;
+        if (dpiObject_toJson(objColValue->value.asObject, &buffer) < 0)
+            return dpiSamples_showError();
+        printf("Row (buffer, %u bytes): %s\n", buffer.length, buffer.ptr);
+
+        // serialize to a callback
+        printf("Row (callback): ");
+        if (dpiObject_writeJson(objColValue->value.asObject, writeToStdout,
+                NULL) < 0)
+            return dpiSamples_showError();
+        printf("\n");
+    }
+
+    // clean up
+    if (buffer.ptr)
+        free(buffer.ptr);
+    dpiStmt_release(stmt);
+    dpiConn_release(conn);
+
+    printf("Done.\n");
+    return 0;
+}
+
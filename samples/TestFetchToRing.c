@@ -0,0 +1,143 @@
+//-----------------------------------------------------------------------------
+// Copyright (c) 2017 Oracle and/or its affiliates.  All rights reserved.
+// This program is free software: you can modify it and/or redistribute it
+// under the terms of:
+//
+// (i)  the Universal Permissive License v 1.0 or at your option, any
+//      later version (http://oss.oracle.com/licenses/upl); and/or
+//
+// (ii) the Apache License v 2.0. (http://www.apache.org/licenses/LICENSE-2.0)
+//-----------------------------------------------------------------------------
+
+//-----------------------------------------------------------------------------
+// TestFetchToRing.c
+//   Exports a large number of rows to a ring buffer and consumes the batches
+// written to it, displaying the number of rows exported per second. For
+// simplicity the producer and the consumer run in the same process and the
+// ring buffer is allocated on the heap; in practice the ring buffer would be
+// placed in shared memory and consumed by another process.
+//-----------------------------------------------------------------------------
+
+#include "SampleLib.h"
+#include <time.h>
+#define SQL_TEXT            "select level, rpad('X', mod(level, 50), 'X') " \
+                            "from dual connect by level <= :1"
+#define NUM_ROWS            1000000
+#define FETCH_ARRAY_SIZE    10000
+#define RING_SIZE           (4 * 1024 * 1024)
+
+//-----------------------------------------------------------------------------
+// consumeBatches()
+//   Consume all of the batches currently available in the ring buffer,
+// summing the values of the first column and the lengths of the values of
+// the second column.
+//-----------------------------------------------------------------------------
+static uint64_t consumeBatches(dpiRing *ring, int64_t *sum,
+        uint64_t *numBytes)
+{
+    dpiRingColumn *columns;
+    uint64_t numRows = 0;
+    dpiRingBatch *batch;
+    uint32_t *offsets;
+    int64_t *values;
+    uint8_t *nulls;
+    uint32_t i;
+
+    while (1) {
+        batch = dpiRing_getBatch(ring);
+        if (!batch)
+            break;
+        columns = (dpiRingColumn*) (batch + 1);
+        nulls = (uint8_t*) batch + columns[0].nullsOffset;
+        values = (int64_t*) ((char*) batch + columns[0].valuesOffset);
+        for (i = 0; i < batch->numRows; i++) {
+            if (!nulls[i])
+                *sum += values[i];
+        }
+        offsets = (uint32_t*) ((char*) batch + columns[1].offsetsOffset);
+        *numBytes += offsets[batch->numRows];
+        numRows += batch->numRows;
+        dpiRing_releaseBatch(ring, batch);
+    }
+
+    return numRows;
+}
+
+
+//-----------------------------------------------------------------------------
+// main()
+//-----------------------------------------------------------------------------
+int main(int argc, char **argv)
+{
+    uint32_t numQueryColumns, numRowsExported;
+    uint64_t numRows, numBytes;
+    dpiData *bindValue;
+    double elapsed;
+    clock_t start;
+    dpiStmt *stmt;
+    dpiConn *conn;
+    dpiRing *ring;
+    int64_t sum;
+    dpiVar *var;
+    int moreRows;
+
+    // connect to database and allocate the ring buffer
+    conn = dpiSamples_getConn(0, NULL);
+    ring = malloc(RING_SIZE);
+    if (!ring) {
+        fprintf(stderr, "ERROR: unable to allocate ring buffer\n");
+        return -1;
+    }
+    if (dpiRing_init(ring, RING_SIZE) < 0)
+        return dpiSamples_showError();
+
+    // create the bind variable
+    if (dpiConn_newVar(conn, DPI_ORACLE_TYPE_NUMBER, DPI_NATIVE_TYPE_INT64, 1,
+            0, 0, 0, NULL, &var, &bindValue) < 0)
+        return dpiSamples_showError();
+    bindValue->isNull = 0;
+    bindValue->value.asInt64 = NUM_ROWS;
+
+    // prepare and execute statement
+    start = clock();
+    if (dpiConn_prepareStmt(conn, 0, SQL_TEXT, strlen(SQL_TEXT), NULL, 0,
+            &stmt) < 0)
+        return dpiSamples_showError();
+    if (dpiStmt_setFetchArraySize(stmt, FETCH_ARRAY_SIZE) < 0)
+        return dpiSamples_showError();
+    if (dpiStmt_bindByPos(stmt, 1, var) < 0)
+        return dpiSamples_showError();
+    if (dpiStmt_execute(stmt, 0, &numQueryColumns) < 0)
+        return dpiSamples_showError();
+
+    // export all rows, consuming the batches whenever the ring buffer is full
+    numRows = numBytes = 0;
+    sum = 0;
+    moreRows = 1;
+    while (moreRows) {
+        if (dpiStmt_fetchToRing(stmt, ring, FETCH_ARRAY_SIZE,
+                &numRowsExported, &moreRows) < 0)
+            return dpiSamples_showError();
+        if (numRowsExported == 0 && moreRows)
+            numRows += consumeBatches(ring, &sum, &numBytes);
+    }
+    numRows += consumeBatches(ring, &sum, &numBytes);
+    elapsed = (double) (clock() - start) / CLOCKS_PER_SEC;
+
+    // display results
+    printf("Rows consumed: %" PRIu64 "\n", numRows);
+    printf("Sum of first column: %" PRId64 "\n", sum);
+    printf("Bytes in second column: %" PRIu64 "\n", numBytes);
+    printf("Elapsed CPU time: %.3f seconds (%.0f rows/second)\n", elapsed,
+            (elapsed > 0) ? numRows / elapsed : 0.0);
+
+    // clean up
+    dpiVar_release(var);
+    dpiStmt_release(stmt);
+    dpiConn_release(conn);
+    free(ring);
+
+    printf("Done.\n");
+    return 0;
+}
+
@@ -0,0 +1,236 @@
+//-----------------------------------------------------------------------------
+// Copyright (c) 2017 Oracle and/or its affiliates.  All rights reserved.
+// This program is free software: you can modify it and/or redistribute it
+// under the terms of:
+//
+// (i)  the Universal Permissive License v 1.0 or at your option, any
+//      later version (http://oss.oracle.com/licenses/upl); and/or
+//
+// (ii) the Apache License v 2.0. (http://www.apache.org/licenses/LICENSE-2.0)
+//-----------------------------------------------------------------------------
+
+//-----------------------------------------------------------------------------
+// TestFetchTyped.cpp
+//   Fetches a large number of rows using the typed C++ layer found in dpi.hpp
+// and compares the time taken with hand written C code, both using
+// dpiStmt_getQueryValue() for each value and reading the dpiData structures
+// of defined variables directly.
+//-----------------------------------------------------------------------------
+
+#include <dpi.hpp>
+#include <chrono>
+#include <iostream>
+
+extern "C" {
+#include "SampleLib.h"
+}
+
+#define SQL_TEXT            "select level, 'Row ' || level, level / 8 " \
+                            "from dual connect by level <= 1000000"
+#define FETCH_ARRAY_SIZE    1000
+
+// structure to which each row is mapped
+struct TestRow {
+    int64_t intCol;
+    std::string_view stringCol;
+    std::optional<double> doubleCol;
+};
+
+// checksum of the values fetched, used to verify that each method fetches
+// the same values (and to prevent them from being optimized away)
+struct Checksum {
+    uint64_t numRows = 0;
+    int64_t intSum = 0;
+    uint64_t numBytes = 0;
+    double doubleSum = 0;
+};
+
+
+//-----------------------------------------------------------------------------
+// prepareAndExecute()
+//   Prepare and execute the query.
+//-----------------------------------------------------------------------------
+static dpiStmt *prepareAndExecute(dpiContext *context, dpiConn *conn)
+{
+    uint32_t numQueryColumns;
+    dpiStmt *stmt;
+
+    dpi::check(context, dpiConn_prepareStmt(conn, 0, SQL_TEXT,
+            strlen(SQL_TEXT), NULL, 0, &stmt));
+    dpi::check(context, dpiStmt_setFetchArraySize(stmt, FETCH_ARRAY_SIZE));
+    dpi::check(context, dpiStmt_execute(stmt, DPI_MODE_EXEC_DEFAULT,
+            &numQueryColumns));
+    return stmt;
+}
+
+
+//-----------------------------------------------------------------------------
+// fetchWithGetQueryValue()
+//   Fetch the rows one at a time and get each value with
+// dpiStmt_getQueryValue(), switching on the native type returned.
+//-----------------------------------------------------------------------------
+static Checksum fetchWithGetQueryValue(dpiContext *context, dpiConn *conn)
+{
+    dpiNativeTypeNum nativeTypeNum;
+    uint32_t bufferRowIndex, pos;
+    Checksum checksum;
+    dpiData *data;
+    dpiStmt *stmt;
+    int found;
+
+    stmt = prepareAndExecute(context, conn);
+    while (1) {
+        dpi::check(context, dpiStmt_fetch(stmt, &found, &bufferRowIndex));
+        if (!found)
+            break;
+        for (pos = 1; pos <= 3; pos++) {
+            dpi::check(context, dpiStmt_getQueryValue(stmt, pos,
+                    &nativeTypeNum, &data));
+            if (data->isNull)
+                continue;
+            switch (nativeTypeNum) {
+                case DPI_NATIVE_TYPE_INT64:
+                    checksum.intSum += data->value.asInt64;
+                    break;
+                case DPI_NATIVE_TYPE_DOUBLE:
+                    checksum.doubleSum += data->value.asDouble;
+                    break;
+                case DPI_NATIVE_TYPE_BYTES:
+                    checksum.numBytes += data->value.asBytes.length;
+                    break;
+                default:
+                    break;
+            }
+        }
+        checksum.numRows++;
+    }
+    dpiStmt_release(stmt);
+    return checksum;
+}
+
+
+//-----------------------------------------------------------------------------
+// fetchWithDefinedVars()
+//   Define variables for each column and read the dpiData structures of the
+// variables directly, as hand written C code would.
+//-----------------------------------------------------------------------------
+static Checksum fetchWithDefinedVars(dpiContext *context, dpiConn *conn)
+{
+    dpiData *intData, *stringData, *doubleData;
+    uint32_t bufferRowIndex, numRows, i;
+    dpiVar *intVar, *stringVar, *doubleVar;
+    Checksum checksum;
+    dpiStmt *stmt;
+    int moreRows;
+
+    stmt = prepareAndExecute(context, conn);
+    dpi::check(context, dpiConn_newVar(conn, DPI_ORACLE_TYPE_NUMBER,
+            DPI_NATIVE_TYPE_INT64, FETCH_ARRAY_SIZE, 0, 0, 0, NULL, &intVar,
+            &intData));
+    dpi::check(context, dpiConn_newVar(conn, DPI_ORACLE_TYPE_VARCHAR,
+            DPI_NATIVE_TYPE_BYTES, FETCH_ARRAY_SIZE, 44, 1, 0, NULL,
+            &stringVar, &stringData));
+    dpi::check(context, dpiConn_newVar(conn, DPI_ORACLE_TYPE_NUMBER,
+            DPI_NATIVE_TYPE_DOUBLE, FETCH_ARRAY_SIZE, 0, 0, 0, NULL,
+            &doubleVar, &doubleData));
+    dpi::check(context, dpiStmt_define(stmt, 1, intVar));
+    dpi::check(context, dpiStmt_define(stmt, 2, stringVar));
+    dpi::check(context, dpiStmt_define(stmt, 3, doubleVar));
+    moreRows = 1;
+    while (moreRows) {
+        dpi::check(context, dpiStmt_fetchRows(stmt, FETCH_ARRAY_SIZE,
+                &bufferRowIndex, &numRows, &moreRows));
+        for (i = bufferRowIndex; i < bufferRowIndex + numRows; i++) {
+            if (!intData[i].isNull)
+                checksum.intSum += intData[i].value.asInt64;
+            if (!stringData[i].isNull)
+                checksum.numBytes += stringData[i].value.asBytes.length;
+            if (!doubleData[i].isNull)
+                checksum.doubleSum += doubleData[i].value.asDouble;
+        }
+        checksum.numRows += numRows;
+    }
+    dpiVar_release(intVar);
+    dpiVar_release(stringVar);
+    dpiVar_release(doubleVar);
+    dpiStmt_release(stmt);
+    return checksum;
+}
+
+
+//-----------------------------------------------------------------------------
+// fetchWithRowReader()
+//   Fetch the rows using the typed C++ layer, mapping each row to TestRow.
+//-----------------------------------------------------------------------------
+static Checksum fetchWithRowReader(dpiContext *context, dpiConn *conn)
+{
+    Checksum checksum;
+    dpiStmt *stmt;
+
+    stmt = prepareAndExecute(context, conn);
+    {
+        dpi::RowReader<TestRow, &TestRow::intCol, &TestRow::stringCol,
+                &TestRow::doubleCol> reader(context, conn, stmt,
+                FETCH_ARRAY_SIZE);
+        checksum.numRows = reader.forEach([&](const TestRow &row) {
+            checksum.intSum += row.intCol;
+            checksum.numBytes += row.stringCol.size();
+            if (row.doubleCol)
+                checksum.doubleSum += *row.doubleCol;
+        });
+    }
+    dpiStmt_release(stmt);
+    return checksum;
+}
+
+
+//-----------------------------------------------------------------------------
+// runTest()
+//   Run the test and display the time taken and the checksum.
+//-----------------------------------------------------------------------------
+static void runTest(const char *name,
+        Checksum (*function)(dpiContext*, dpiConn*), dpiContext *context,
+        dpiConn *conn)
+{
+    std::chrono::steady_clock::time_point start;
+    std::chrono::duration<double> elapsed;
+    Checksum checksum;
+
+    start = std::chrono::steady_clock::now();
+    checksum = function(context, conn);
+    elapsed = std::chrono::steady_clock::now() - start;
+    std::cout << name << ": " << checksum.numRows << " rows in "
+            << elapsed.count() << " seconds (" << checksum.numRows /
+            elapsed.count() << " rows/second)" << std::endl;
+    std::cout << "    checksum: " << checksum.intSum << " / "
+            << checksum.numBytes << " / " << checksum.doubleSum << std::endl;
+}
+
+
+//-----------------------------------------------------------------------------
+// main()
+//-----------------------------------------------------------------------------
+int main(int argc, char **argv)
+{
+    dpiContext *context;
+    dpiConn *conn;
+
+    conn = dpiSamples_getConn(0, NULL);
+    context = dpiSamples_getParams()->context;
+    try {
+        runTest("C with dpiStmt_getQueryValue()", fetchWithGetQueryValue,
+                context, conn);
+        runTest("C with defined variables", fetchWithDefinedVars, context,
+                conn);
+        runTest("C++ with dpi::RowReader", fetchWithRowReader, context, conn);
+    } catch (const dpi::Error &e) {
+        std::cerr << "ERROR: " << e.what() << " (" << e.fnName() << ": "
+                << e.action() << ")" << std::endl;
+        return -1;
+    }
+    dpiConn_release(conn);
+
+    std::cout << "Done." << std::endl;
+    return 0;
+}
+
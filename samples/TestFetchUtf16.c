@@ -0,0 +1,249 @@
+//-----------------------------------------------------------------------------
+// Copyright (c) 2017 Oracle and/or its affiliates.  All rights reserved.
+// This program is free software: you can modify it and/or redistribute it
+// under the terms of:
+//
+// (i)  the Universal Permissive License v 1.0 or at your option, any
+//      later version (http://oss.oracle.com/licenses/upl); and/or
+//
+// (ii) the Apache License v 2.0. (http://www.apache.org/licenses/LICENSE-2.0)
+//-----------------------------------------------------------------------------
+
+//-----------------------------------------------------------------------------
+// TestFetchUtf16.c
+//   Measures the CPU time taken to transcode strings fetched from a UTF-8
+// connection into UTF-16, first by setting the output encoding of the fetch
+// variable with dpiVar_setOutputEncoding() and then by converting each
+// fetched value with iconv (MultiByteToWideChar on Windows). About
+// NUM_BYTES bytes of text are fetched for each of three kinds of text: ASCII
+// only, mostly ASCII (one non-ASCII character in every ten) and non-ASCII
+// only. The CPU time of a fetch without any conversion is subtracted from the
+// time of the fetch with the output encoding set; since clock() measures CPU
+// time, time spent waiting for the database is not included.
+//-----------------------------------------------------------------------------
+
+#include "SampleLib.h"
+#include <time.h>
+#ifdef _WIN32
+#include <windows.h>
+#else
+#include <iconv.h>
+#endif
+#define SQL_TEXT            "select rpad(:1, :2, :1) " \
+                            "from dual " \
+                            "connect by level <= :3"
+#define MAX_BYTES           4000
+#define NUM_BYTES           (8 * 1024 * 1024)
+#define ARRAY_SIZE          100
+#define NUM_ITERATIONS      5
+
+// the kinds of text fetched; the number of characters in each value is
+// chosen so that the value fits in MAX_BYTES bytes when encoded in UTF-8
+typedef struct {
+    const char *label;
+    const char *pattern;
+    int64_t numChars;
+} sampleText;
+
+static const sampleText sampleTexts[] = {
+    { "ASCII", "abcdefghij", 4000 },
+    { "90% ASCII", "abcdefghi\xc3\xa9", 3630 },
+    { "Non-ASCII", "\xc3\xa9", 2000 }
+};
+
+// the reference converter used for the comparison
+#ifdef _WIN32
+typedef void *dpiSampleConverter;
+#else
+typedef iconv_t dpiSampleConverter;
+#endif
+
+//-----------------------------------------------------------------------------
+// convertValue()
+//   Convert the value from UTF-8 to UTF-16 using the reference converter.
+//-----------------------------------------------------------------------------
+static int convertValue(dpiSampleConverter converter, dpiBytes *value,
+        char *buffer, size_t bufferSize)
+{
+#ifdef _WIN32
+    if (value->length > 0 && MultiByteToWideChar(CP_UTF8,
+            MB_ERR_INVALID_CHARS, value->ptr, (int) value->length,
+            (LPWSTR) buffer, (int) (bufferSize / 2)) == 0) {
+        printf("MultiByteToWideChar() failed: %lu\n", GetLastError());
+        return -1;
+    }
+#else
+    size_t inLength = value->length, outLength = bufferSize;
+    char *inPtr = value->ptr, *outPtr = buffer;
+
+    if (iconv(converter, &inPtr, &inLength, &outPtr, &outLength) ==
+            (size_t) -1) {
+        perror("iconv() failed");
+        return -1;
+    }
+#endif
+    return 0;
+}
+
+
+//-----------------------------------------------------------------------------
+// fetchRows()
+//   Execute the query for the given kind of text and fetch all of the rows.
+// If an output encoding is given, it is set on the fetch variable; if a
+// reference converter is given, each value is converted with it and the CPU
+// time taken by the conversion alone and the number of bytes converted are
+// accumulated. The CPU time taken by the fetch as a whole is returned.
+//-----------------------------------------------------------------------------
+static double fetchRows(dpiConn *conn, const sampleText *text,
+        const char *outputEncoding, dpiSampleConverter *converter,
+        double *convertElapsed, uint64_t *numBytes)
+{
+    uint32_t numQueryColumns, bufferRowIndex, i;
+    char buffer[MAX_BYTES * 2];
+    dpiData *bindData[3], *data;
+    dpiVar *bindVars[3], *var;
+    clock_t start, convertStart;
+    int found;
+    dpiStmt *stmt;
+
+    // create the bind variables
+    if (dpiConn_newVar(conn, DPI_ORACLE_TYPE_VARCHAR, DPI_NATIVE_TYPE_BYTES,
+            1, MAX_BYTES, 1, 0, NULL, &bindVars[0], &bindData[0]) < 0)
+        return dpiSamples_showError();
+    for (i = 1; i < 3; i++) {
+        if (dpiConn_newVar(conn, DPI_ORACLE_TYPE_NUMBER,
+                DPI_NATIVE_TYPE_INT64, 1, 0, 0, 0, NULL, &bindVars[i],
+                &bindData[i]) < 0)
+            return dpiSamples_showError();
+        bindData[i]->isNull = 0;
+    }
+    if (dpiVar_setFromBytes(bindVars[0], 0, text->pattern,
+            strlen(text->pattern)) < 0)
+        return dpiSamples_showError();
+    bindData[1]->value.asInt64 = text->numChars;
+    bindData[2]->value.asInt64 = NUM_BYTES / MAX_BYTES;
+
+    // create the fetch variable and set its output encoding, if applicable
+    if (dpiConn_newVar(conn, DPI_ORACLE_TYPE_VARCHAR, DPI_NATIVE_TYPE_BYTES,
+            ARRAY_SIZE, MAX_BYTES, 1, 0, NULL, &var, &data) < 0)
+        return dpiSamples_showError();
+    if (outputEncoding && dpiVar_setOutputEncoding(var, outputEncoding) < 0)
+        return dpiSamples_showError();
+
+    // prepare and execute the statement
+    if (dpiConn_prepareStmt(conn, 0, SQL_TEXT, strlen(SQL_TEXT), NULL, 0,
+            &stmt) < 0)
+        return dpiSamples_showError();
+    for (i = 0; i < 3; i++) {
+        if (dpiStmt_bindByPos(stmt, i + 1, bindVars[i]) < 0)
+            return dpiSamples_showError();
+    }
+    if (dpiStmt_setFetchArraySize(stmt, ARRAY_SIZE) < 0)
+        return dpiSamples_showError();
+    if (dpiStmt_execute(stmt, 0, &numQueryColumns) < 0)
+        return dpiSamples_showError();
+    if (dpiStmt_define(stmt, 1, var) < 0)
+        return dpiSamples_showError();
+
+    // fetch the rows, converting them with the reference converter, if
+    // applicable
+    start = clock();
+    while (1) {
+        if (dpiStmt_fetch(stmt, &found, &bufferRowIndex) < 0)
+            return dpiSamples_showError();
+        if (!found)
+            break;
+        if (converter) {
+            *numBytes += data[bufferRowIndex].value.asBytes.length;
+            convertStart = clock();
+            if (convertValue(*converter, &data[bufferRowIndex].value.asBytes,
+                    buffer, sizeof(buffer)) < 0)
+                return -1;
+            *convertElapsed += (double) (clock() - convertStart) /
+                    CLOCKS_PER_SEC;
+        }
+    }
+
+    // clean up
+    for (i = 0; i < 3; i++)
+        dpiVar_release(bindVars[i]);
+    dpiVar_release(var);
+    dpiStmt_release(stmt);
+
+    return (double) (clock() - start) / CLOCKS_PER_SEC;
+}
+
+
+//-----------------------------------------------------------------------------
+// main()
+//-----------------------------------------------------------------------------
+int main(int argc, char **argv)
+{
+    double plainElapsed, encodingElapsed, convertElapsed, elapsed;
+    dpiCommonCreateParams commonParams;
+    dpiSampleConverter converter;
+    dpiSampleParams *params;
+    uint64_t numBytes;
+    size_t i;
+    int j;
+    dpiConn *conn;
+
+    // connect to the database using UTF-8
+    params = dpiSamples_getParams();
+    if (dpiContext_initCommonCreateParams(params->context, &commonParams) < 0)
+        return dpiSamples_showError();
+    commonParams.encoding = "UTF-8";
+    commonParams.nencoding = "UTF-8";
+    conn = dpiSamples_getConn(0, &commonParams);
+
+    // create the reference converter; UTF-16 uses the platform endianness
+#ifdef _WIN32
+    converter = NULL;
+#else
+    j = 1;
+    converter = iconv_open((*(char *) &j) ? "UTF-16LE" : "UTF-16BE", "UTF-8");
+    if (converter == (iconv_t) -1) {
+        perror("iconv_open() failed");
+        return 1;
+    }
+#endif
+
+    // fetch each kind of text in each of the three ways
+    for (i = 0; i < sizeof(sampleTexts) / sizeof(sampleTexts[0]); i++) {
+        plainElapsed = encodingElapsed = convertElapsed = 0;
+        numBytes = 0;
+        for (j = 0; j < NUM_ITERATIONS; j++) {
+            elapsed = fetchRows(conn, &sampleTexts[i], NULL, NULL, NULL,
+                    NULL);
+            if (elapsed < 0)
+                return 1;
+            plainElapsed += elapsed;
+            elapsed = fetchRows(conn, &sampleTexts[i], "UTF-16", NULL, NULL,
+                    NULL);
+            if (elapsed < 0)
+                return 1;
+            encodingElapsed += elapsed;
+            if (fetchRows(conn, &sampleTexts[i], NULL, &converter,
+                    &convertElapsed, &numBytes) < 0)
+                return 1;
+        }
+        printf("%s: %" PRIu64 " bytes transcoded\n", sampleTexts[i].label,
+                numBytes);
+        printf("    dpiVar_setOutputEncoding(): %.3f seconds\n",
+                encodingElapsed - plainElapsed);
+#ifdef _WIN32
+        printf("    MultiByteToWideChar(): %.3f seconds\n", convertElapsed);
+#else
+        printf("    iconv(): %.3f seconds\n", convertElapsed);
+#endif
+    }
+
+    // clean up
+#ifndef _WIN32
+    iconv_close(converter);
+#endif
+    dpiConn_release(conn);
+
+    printf("Done.\n");
+    return 0;
+}
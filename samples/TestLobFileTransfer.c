@@ -0,0 +1,196 @@
+//-----------------------------------------------------------------------------
+// Copyright (c) 2017 Oracle and/or its affiliates.  All rights reserved.
+// This program is free software: you can modify it and/or redistribute it
+// under the terms of:
+//
+// (i)  the Universal Permissive License v 1.0 or at your option, any
+//      later version (http://oss.oracle.com/licenses/upl); and/or
+//
+// (ii) the Apache License v 2.0. (http://www.apache.org/licenses/LICENSE-2.0)
+//-----------------------------------------------------------------------------
+
+//-----------------------------------------------------------------------------
+// TestLobFileTransfer.c
+//   Measures the time taken to copy a large file into a temporary BLOB and
+// back out again, first with a loop of file reads and calls to
+// dpiLob_writeBytes() (and calls to dpiLob_readBytes() and file writes) and
+// then with dpiLob_writeFromFd() and dpiLob_readToFd(). The connection is
+// created in threaded mode so that the file I/O overlaps the round trips.
+//-----------------------------------------------------------------------------
+
+#include "SampleLib.h"
+#include <time.h>
+#define FILE_SIZE                       (64 * 1024 * 1024)
+#define LOOP_BUFFER_SIZE                65536
+
+//-----------------------------------------------------------------------------
+// getElapsed()
+//   Return the number of seconds of wall clock time elapsed since the start
+// time.
+//-----------------------------------------------------------------------------
+static double getElapsed(const struct timespec *start)
+{
+    struct timespec now;
+
+    timespec_get(&now, TIME_UTC);
+    return (double) (now.tv_sec - start->tv_sec) +
+            (double) (now.tv_nsec - start->tv_nsec) / 1000000000.0;
+}
+
+
+//-----------------------------------------------------------------------------
+// showResult()
+//   Display the time taken and throughput of a transfer.
+//-----------------------------------------------------------------------------
+static void showResult(const char *label, uint64_t numBytes, double elapsed)
+{
+    printf("    %s: %" PRIu64 " bytes in %.3f seconds (%.1f MB/s)\n", label,
+            numBytes, elapsed, (double) numBytes / (1024 * 1024) / elapsed);
+}
+
+
+//-----------------------------------------------------------------------------
+// runLoop()
+//   Copy the file into the LOB and back using a loop in the application.
+//-----------------------------------------------------------------------------
+static int runLoop(dpiLob *lob, FILE *sourceFile, FILE *targetFile)
+{
+    uint64_t offset, numBytes, bufferLength;
+    char buffer[LOOP_BUFFER_SIZE];
+    struct timespec start;
+    size_t numRead;
+
+    printf("Application loop:\n");
+    rewind(sourceFile);
+    rewind(targetFile);
+    if (dpiLob_trim(lob, 0) < 0)
+        return dpiSamples_showError();
+
+    // file to LOB
+    timespec_get(&start, TIME_UTC);
+    offset = 1;
+    while (1) {
+        numRead = fread(buffer, 1, sizeof(buffer), sourceFile);
+        if (numRead == 0)
+            break;
+        if (dpiLob_writeBytes(lob, offset, buffer, numRead) < 0)
+            return dpiSamples_showError();
+        offset += numRead;
+    }
+    showResult("File to LOB", offset - 1, getElapsed(&start));
+
+    // LOB to file
+    timespec_get(&start, TIME_UTC);
+    offset = 1;
+    numBytes = 0;
+    while (1) {
+        bufferLength = sizeof(buffer);
+        if (dpiLob_readBytes(lob, offset, sizeof(buffer), buffer,
+                &bufferLength) < 0)
+            return dpiSamples_showError();
+        if (bufferLength == 0)
+            break;
+        if (fwrite(buffer, 1, bufferLength, targetFile) != bufferLength) {
+            printf("ERROR: unable to write file\n");
+            return -1;
+        }
+        offset += bufferLength;
+        numBytes += bufferLength;
+    }
+    fflush(targetFile);
+    showResult("LOB to file", numBytes, getElapsed(&start));
+    return 0;
+}
+
+
+//-----------------------------------------------------------------------------
+// runTransfer()
+//   Copy the file into the LOB and back using dpiLob_writeFromFd() and
+// dpiLob_readToFd() with the given mode.
+//-----------------------------------------------------------------------------
+static int runTransfer(dpiLob *lob, FILE *sourceFile, FILE *targetFile,
+        const char *label, dpiLobTransferMode mode)
+{
+    struct timespec start;
+    uint64_t numBytes;
+
+    printf("%s:\n", label);
+    rewind(sourceFile);
+    rewind(targetFile);
+    if (dpiLob_trim(lob, 0) < 0)
+        return dpiSamples_showError();
+
+    // file to LOB
+    timespec_get(&start, TIME_UTC);
+    if (dpiLob_writeFromFd(lob, 1, fileno(sourceFile), mode, &numBytes) < 0)
+        return dpiSamples_showError();
+    showResult("File to LOB", numBytes, getElapsed(&start));
+
+    // LOB to file
+    timespec_get(&start, TIME_UTC);
+    if (dpiLob_readToFd(lob, 1, fileno(targetFile), mode, &numBytes) < 0)
+        return dpiSamples_showError();
+    showResult("LOB to file", numBytes, getElapsed(&start));
+    return 0;
+}
+
+
+//-----------------------------------------------------------------------------
+// main()
+//-----------------------------------------------------------------------------
+int main(int argc, char **argv)
+{
+    dpiCommonCreateParams commonParams;
+    FILE *sourceFile, *targetFile;
+    char buffer[LOOP_BUFFER_SIZE];
+    dpiSampleParams *params;
+    dpiConn *conn;
+    dpiLob *lob;
+    uint32_t i;
+
+    // connect to database in threaded mode and create the temporary LOB
+    params = dpiSamples_getParams();
+    if (dpiContext_initCommonCreateParams(params->context, &commonParams) < 0)
+        return dpiSamples_showError();
+    commonParams.createMode = DPI_MODE_CREATE_THREADED;
+    conn = dpiSamples_getConn(0, &commonParams);
+    if (dpiConn_newTempLob(conn, DPI_ORACLE_TYPE_BLOB, &lob) < 0)
+        return dpiSamples_showError();
+
+    // create the source file and the file into which the LOB is read
+    sourceFile = tmpfile();
+    targetFile = tmpfile();
+    if (!sourceFile || !targetFile) {
+        printf("ERROR: unable to create files\n");
+        return -1;
+    }
+    for (i = 0; i < sizeof(buffer); i++)
+        buffer[i] = (char) (i % 251);
+    for (i = 0; i < FILE_SIZE / sizeof(buffer); i++) {
+        if (fwrite(buffer, 1, sizeof(buffer), sourceFile) != sizeof(buffer)) {
+            printf("ERROR: unable to write file\n");
+            return -1;
+        }
+    }
+    fflush(sourceFile);
+
+    // copy the file both ways
+    if (runLoop(lob, sourceFile, targetFile) < 0)
+        return -1;
+    if (runTransfer(lob, sourceFile, targetFile, "Chunk aligned transfer",
+            DPI_MODE_LOB_TRANSFER_DEFAULT) < 0)
+        return -1;
+    if (runTransfer(lob, sourceFile, targetFile,
+            "Chunk aligned transfer (direct I/O, no cache)",
+            DPI_MODE_LOB_TRANSFER_DIRECT | DPI_MODE_LOB_TRANSFER_NO_CACHE) < 0)
+        return -1;
+
+    // clean up
+    fclose(sourceFile);
+    fclose(targetFile);
+    dpiLob_release(lob);
+    dpiConn_release(conn);
+
+    printf("Done.\n");
+    return 0;
+}
@@ -101,6 +101,26 @@ create type &main_user..udt_ObjectDataTypesArray as
 create type &main_user..udt_NestedArray is table of &main_user..udt_SubObject;
 /
 
+create type &main_user..udt_LobObject as object (
+    IntValue                            number(9),
+    ClobValue                           clob
+);
+/
+
+create type &main_user..udt_LobObjectArray is
+        table of &main_user..udt_LobObject;
+/
+
+create type &main_user..udt_LobObjectGroup as object (
+    GroupId                             number(9),
+    Members                             &main_user..udt_LobObjectArray
+);
+/
+
+create type &main_user..udt_LobObjectGroups is
+        table of &main_user..udt_LobObjectGroup;
+/
+
 -- create tables
 create table &main_user..TestNumbers (
     IntCol                              number(9) not null,
@@ -0,0 +1,1007 @@
+//-----------------------------------------------------------------------------
+// Copyright (c) 2017 Oracle and/or its affiliates.  All rights reserved.
+// This program is free software: you can modify it and/or redistribute it
+// under the terms of:
+//
+// (i)  the Universal Permissive License v 1.0 or at your option, any
+//      later version (http://oss.oracle.com/licenses/upl); and/or
+//
+// (ii) the Apache License v 2.0. (http://www.apache.org/licenses/LICENSE-2.0)
+//-----------------------------------------------------------------------------
+
+//-----------------------------------------------------------------------------
+// dpiAggregateResult.c
+//   Implementation of aggregates computed by dpiStmt_fetchAggregates(). The
+// aggregates are updated directly from the buffers used to define the query
+// after each fetch; values are only converted to C data values once all rows
+// have been fetched. Values which are compared (for minimums, maximums and
+// groups) or counted (for estimates of the number of distinct values) are
+// first transformed to a key whose bytes sort in the same order as the values
+// themselves. Distinct values are counted with HyperLogLog.
+//-----------------------------------------------------------------------------
+
+#include "dpiImpl.h"
+
+// size of the largest key which is not taken directly from the define buffer
+#define DPI_AGGREGATE_MAX_KEY_SIZE      8
+
+// forward declarations of internal functions only used in this file
+static int dpiAggregateResult__addGroup(dpiAggregateResult *result,
+        const char *key, uint32_t keyLength, uint32_t hash, int isNull,
+        uint32_t *groupIndex, dpiError *error);
+static int dpiAggregateResult__addToSum(dpiAggregateAccumulator *accumulator,
+        dpiNativeTypeNum nativeTypeNum, dpiVar *var, uint32_t pos,
+        dpiError *error);
+static int dpiAggregateResult__checkValue(dpiVar *var, uint32_t pos,
+        int *isNull, dpiError *error);
+static uint64_t dpiAggregateResult__decode(const char *key,
+        uint32_t numBytes);
+static int dpiAggregateResult__decodeKey(dpiAggregateResult *result,
+        dpiOracleTypeNum oracleTypeNum, dpiNativeTypeNum nativeTypeNum,
+        const char *key, uint32_t keyLength, dpiData *data, dpiError *error);
+static void dpiAggregateResult__encode(char *buffer, uint64_t value,
+        uint32_t numBytes);
+static uint64_t dpiAggregateResult__estimateDistinct(
+        const uint8_t *registers);
+static int dpiAggregateResult__findGroup(dpiAggregateResult *result,
+        dpiVar *var, uint32_t pos, uint32_t *groupIndex, dpiError *error);
+static void dpiAggregateResult__getKey(dpiVar *var, uint32_t pos,
+        char *buffer, const char **key, uint32_t *keyLength);
+static int dpiAggregateResult__getKeyType(dpiVar *var,
+        dpiNativeTypeNum *nativeTypeNum);
+static int dpiAggregateResult__getSumType(dpiVar *var,
+        dpiNativeTypeNum *nativeTypeNum);
+static double dpiAggregateResult__log(double value);
+static int dpiAggregateResult__setExtreme(
+        dpiAggregateAccumulator *accumulator, const char *key,
+        uint32_t keyLength, int isMin, dpiError *error);
+
+
+//-----------------------------------------------------------------------------
+// dpiAggregateResult__addGroup() [INTERNAL]
+//   Add a group with the given key to the result. The space for the groups
+// and their accumulators is doubled each time it is exhausted and the number
+// of hash buckets is kept at least as large as the number of groups.
+//-----------------------------------------------------------------------------
+static int dpiAggregateResult__addGroup(dpiAggregateResult *result,
+        const char *key, uint32_t keyLength, uint32_t hash, int isNull,
+        uint32_t *groupIndex, dpiError *error)
+{
+    dpiAggregateAccumulator *accumulators, *accumulator;
+    uint32_t allocatedGroups, numBuckets, *buckets, i;
+    dpiAggregateGroup *groups, *group;
+
+    // make sure there is space for the group and its accumulators
+    if (result->numGroups == result->allocatedGroups) {
+        allocatedGroups = (result->allocatedGroups > 0) ?
+                result->allocatedGroups * 2 : DPI_AGGREGATE_INITIAL_BUCKETS;
+        groups = realloc(result->groups,
+                allocatedGroups * sizeof(dpiAggregateGroup));
+        if (!groups)
+            return dpiError__set(error, "allocate groups", DPI_ERR_NO_MEMORY);
+        result->groups = groups;
+        if (result->numSpecs > 0) {
+            accumulators = realloc(result->accumulators,
+                    (size_t) allocatedGroups * result->numSpecs *
+                    sizeof(dpiAggregateAccumulator));
+            if (!accumulators)
+                return dpiError__set(error, "allocate accumulators",
+                        DPI_ERR_NO_MEMORY);
+            result->accumulators = accumulators;
+        }
+        result->allocatedGroups = allocatedGroups;
+    }
+
+    // make sure there are enough hash buckets; the groups are redistributed
+    // among the new buckets using the hash already calculated for each one
+    if (result->numGroups == result->numBuckets) {
+        numBuckets = result->numBuckets * 2;
+        buckets = calloc(numBuckets, sizeof(uint32_t));
+        if (!buckets)
+            return dpiError__set(error, "allocate buckets",
+                    DPI_ERR_NO_MEMORY);
+        for (i = 0; i < result->numGroups; i++) {
+            group = &result->groups[i];
+            group->next = buckets[group->hash & (numBuckets - 1)];
+            buckets[group->hash & (numBuckets - 1)] = i + 1;
+        }
+        free(result->buckets);
+        result->buckets = buckets;
+        result->numBuckets = numBuckets;
+    }
+
+    // initialize the group
+    group = &result->groups[result->numGroups];
+    memset(group, 0, sizeof(dpiAggregateGroup));
+    group->hash = hash;
+    group->key.isNull = isNull;
+    if (keyLength > 0) {
+        group->keyBytes = malloc(keyLength);
+        if (!group->keyBytes)
+            return dpiError__set(error, "allocate key", DPI_ERR_NO_MEMORY);
+        memcpy(group->keyBytes, key, keyLength);
+        group->keyLength = keyLength;
+    }
+    accumulator = &result->accumulators[(size_t) result->numGroups *
+            result->numSpecs];
+    memset(accumulator, 0, result->numSpecs *
+            sizeof(dpiAggregateAccumulator));
+    result->numGroups++;
+
+    // registers are required for estimating the number of distinct values
+    for (i = 0; i < result->numSpecs; i++, accumulator++) {
+        if (result->specs[i].aggregateType !=
+                DPI_AGGREGATE_DISTINCT_ESTIMATE)
+            continue;
+        accumulator->registers = calloc(DPI_AGGREGATE_NUM_REGISTERS, 1);
+        if (!accumulator->registers)
+            return dpiError__set(error, "allocate registers",
+                    DPI_ERR_NO_MEMORY);
+    }
+
+    // add the group to its bucket
+    *groupIndex = result->numGroups - 1;
+    group->next = result->buckets[hash & (result->numBuckets - 1)];
+    result->buckets[hash & (result->numBuckets - 1)] = result->numGroups;
+
+    return DPI_SUCCESS;
+}
+
+
+//-----------------------------------------------------------------------------
+// dpiAggregateResult__addRows() [INTERNAL]
+//   Add the specified rows of the variables to the aggregates. Null values are
+// ignored by all aggregates except the count of rows.
+//-----------------------------------------------------------------------------
+int dpiAggregateResult__addRows(dpiAggregateResult *result, dpiVar **vars,
+        uint32_t firstRow, uint32_t numRows, dpiError *error)
+{
+    uint32_t i, j, keyLength, groupIndex, registerIndex, rank;
+    char buffer[DPI_AGGREGATE_MAX_KEY_SIZE];
+    dpiAggregateAccumulator *accumulator;
+    const char *key;
+    uint64_t hash;
+    int isNull;
+    dpiVar *var;
+
+    for (i = firstRow; i < firstRow + numRows; i++) {
+
+        // determine the group to which the row belongs
+        groupIndex = 0;
+        if (result->groupByPos > 0 &&
+                dpiAggregateResult__findGroup(result,
+                        vars[result->groupByPos - 1], i, &groupIndex,
+                        error) < 0)
+            return DPI_FAILURE;
+
+        // update each of the accumulators of the group
+        accumulator = &result->accumulators[(size_t) groupIndex *
+                result->numSpecs];
+        for (j = 0; j < result->numSpecs; j++, accumulator++) {
+            if (result->specs[j].pos == 0) {
+                accumulator->count++;
+                continue;
+            }
+            var = vars[result->specs[j].pos - 1];
+            if (dpiAggregateResult__checkValue(var, i, &isNull, error) < 0)
+                return DPI_FAILURE;
+            if (isNull)
+                continue;
+            accumulator->count++;
+            switch (result->specs[j].aggregateType) {
+                case DPI_AGGREGATE_SUM:
+                    if (dpiAggregateResult__addToSum(accumulator,
+                            result->nativeTypeNums[j], var, i, error) < 0)
+                        return DPI_FAILURE;
+                    break;
+                case DPI_AGGREGATE_MIN:
+                case DPI_AGGREGATE_MAX:
+                    dpiAggregateResult__getKey(var, i, buffer, &key,
+                            &keyLength);
+                    if (dpiAggregateResult__setExtreme(accumulator, key,
+                            keyLength, result->specs[j].aggregateType ==
+                            DPI_AGGREGATE_MIN, error) < 0)
+                        return DPI_FAILURE;
+                    break;
+                case DPI_AGGREGATE_DISTINCT_ESTIMATE:
+
+                    // the first bits of the hash select the register and the
+                    // position of the first set bit in the remaining bits is
+                    // the rank; each register retains the highest rank seen
+                    dpiAggregateResult__getKey(var, i, buffer, &key,
+                            &keyLength);
+                    hash = dpiFingerprint__mix(((uint64_t) keyLength << 32) |
+                            dpiFingerprint__crc32c(0, key, keyLength));
+                    registerIndex = (uint32_t) (hash >>
+                            (64 - DPI_AGGREGATE_REGISTER_BITS));
+                    hash <<= DPI_AGGREGATE_REGISTER_BITS;
+                    for (rank = 1; rank <= 64 - DPI_AGGREGATE_REGISTER_BITS &&
+                            !(hash >> 63); rank++)
+                        hash <<= 1;
+                    if (rank > accumulator->registers[registerIndex])
+                        accumulator->registers[registerIndex] =
+                                (uint8_t) rank;
+                    break;
+                default:
+                    break;
+            }
+        }
+
+    }
+
+    return DPI_SUCCESS;
+}
+
+
+//-----------------------------------------------------------------------------
+// dpiAggregateResult__addToSum() [INTERNAL]
+//   Add the value at the specified position in the variable to the sum.
+// Integers are summed exactly and an error is raised if the sum overflows.
+//-----------------------------------------------------------------------------
+static int dpiAggregateResult__addToSum(dpiAggregateAccumulator *accumulator,
+        dpiNativeTypeNum nativeTypeNum, dpiVar *var, uint32_t pos,
+        dpiError *error)
+{
+    dpiData *sum = &accumulator->value;
+    uint64_t uint64Value;
+    int64_t int64Value;
+    double doubleValue;
+
+    switch (nativeTypeNum) {
+        case DPI_NATIVE_TYPE_INT64:
+            if (var->type->oracleTypeNum == DPI_ORACLE_TYPE_NATIVE_INT)
+                int64Value = var->data.asInt64[pos];
+            else if (dpiOci__numberToInt(var->env, &var->data.asNumber[pos],
+                    &int64Value, sizeof(int64_t), DPI_OCI_NUMBER_SIGNED,
+                    error) < 0)
+                return DPI_FAILURE;
+            if ((int64Value > 0 &&
+                    sum->value.asInt64 > INT64_MAX - int64Value) ||
+                    (int64Value < 0 &&
+                    sum->value.asInt64 < INT64_MIN - int64Value))
+                return dpiError__set(error, "add to sum", DPI_ERR_OVERFLOW,
+                        "int64_t");
+            sum->value.asInt64 += int64Value;
+            break;
+        case DPI_NATIVE_TYPE_UINT64:
+            if (var->type->oracleTypeNum == DPI_ORACLE_TYPE_NATIVE_UINT)
+                uint64Value = var->data.asUint64[pos];
+            else if (dpiOci__numberToInt(var->env, &var->data.asNumber[pos],
+                    &uint64Value, sizeof(uint64_t), DPI_OCI_NUMBER_UNSIGNED,
+                    error) < 0)
+                return DPI_FAILURE;
+            if (sum->value.asUint64 > UINT64_MAX - uint64Value)
+                return dpiError__set(error, "add to sum", DPI_ERR_OVERFLOW,
+                        "uint64_t");
+            sum->value.asUint64 += uint64Value;
+            break;
+        default:
+            if (var->type->oracleTypeNum == DPI_ORACLE_TYPE_NATIVE_FLOAT)
+                doubleValue = var->data.asFloat[pos];
+            else if (var->type->oracleTypeNum ==
+                    DPI_ORACLE_TYPE_NATIVE_DOUBLE)
+                doubleValue = var->data.asDouble[pos];
+            else if (dpiOci__numberToReal(var->env, &doubleValue,
+                    &var->data.asNumber[pos], error) < 0)
+                return DPI_FAILURE;
+            sum->value.asDouble += doubleValue;
+            break;
+    }
+
+    return DPI_SUCCESS;
+}
+
+
+//-----------------------------------------------------------------------------
+// dpiAggregateResult__allocate() [INTERNAL]
+//   Allocate and initialize an aggregate result. A reference to the
+// connection is retained so that the environment (and the encoding of the
+// byte strings in the result) remains valid for as long as the result does.
+//-----------------------------------------------------------------------------
+int dpiAggregateResult__allocate(dpiConn *conn, dpiAggregateResult **result,
+        dpiError *error)
+{
+    dpiAggregateResult *tempResult;
+
+    if (dpiGen__allocate(DPI_HTYPE_AGGREGATE_RESULT, conn->env,
+            (void**) &tempResult, error) < 0)
+        return DPI_FAILURE;
+    if (dpiGen__setRefCount(conn, error, 1) < 0) {
+        dpiAggregateResult__free(tempResult, error);
+        return DPI_FAILURE;
+    }
+    tempResult->conn = conn;
+
+    *result = tempResult;
+    return DPI_SUCCESS;
+}
+
+
+//-----------------------------------------------------------------------------
+// dpiAggregateResult__checkValue() [INTERNAL]
+//   Determine if the value at the specified position in the variable is null,
+// raising an error if the value could not be fetched.
+//-----------------------------------------------------------------------------
+static int dpiAggregateResult__checkValue(dpiVar *var, uint32_t pos,
+        int *isNull, dpiError *error)
+{
+    *isNull = (var->indicator[pos] == DPI_OCI_IND_NULL);
+    if (!*isNull && var->returnCode && var->returnCode[pos] != 0) {
+        dpiError__set(error, "check return code", DPI_ERR_COLUMN_FETCH, pos,
+                var->returnCode[pos]);
+        error->buffer->code = var->returnCode[pos];
+        return DPI_FAILURE;
+    }
+    return DPI_SUCCESS;
+}
+
+
+//-----------------------------------------------------------------------------
+// dpiAggregateResult__decode() [INTERNAL]
+//   Decode an unsigned integer stored in the key as the specified number of
+// bytes in big endian order.
+//-----------------------------------------------------------------------------
+static uint64_t dpiAggregateResult__decode(const char *key, uint32_t numBytes)
+{
+    uint64_t value = 0;
+    uint32_t i;
+
+    for (i = 0; i < numBytes; i++)
+        value = (value << 8) | (unsigned char) key[i];
+    return value;
+}
+
+
+//-----------------------------------------------------------------------------
+// dpiAggregateResult__decodeKey() [INTERNAL]
+//   Populate the data from a key created by dpiAggregateResult__getKey(). Byte
+// strings refer to the key directly.
+//-----------------------------------------------------------------------------
+static int dpiAggregateResult__decodeKey(dpiAggregateResult *result,
+        dpiOracleTypeNum oracleTypeNum, dpiNativeTypeNum nativeTypeNum,
+        const char *key, uint32_t keyLength, dpiData *data, dpiError *error)
+{
+    dpiOciNumber number;
+    uint64_t temp;
+    dpiOciDate date;
+    uint32_t bits;
+
+    data->isNull = 0;
+    switch (oracleTypeNum) {
+        case DPI_ORACLE_TYPE_NATIVE_INT:
+            temp = dpiAggregateResult__decode(key, sizeof(int64_t));
+            data->value.asInt64 = (int64_t) (temp ^ (UINT64_C(1) << 63));
+            break;
+        case DPI_ORACLE_TYPE_NATIVE_UINT:
+            data->value.asUint64 =
+                    dpiAggregateResult__decode(key, sizeof(uint64_t));
+            break;
+        case DPI_ORACLE_TYPE_NATIVE_FLOAT:
+            bits = (uint32_t) dpiAggregateResult__decode(key, sizeof(float));
+            bits = (bits & 0x80000000) ? bits ^ 0x80000000 : ~bits;
+            memcpy(&data->value.asFloat, &bits, sizeof(float));
+            break;
+        case DPI_ORACLE_TYPE_NATIVE_DOUBLE:
+            temp = dpiAggregateResult__decode(key, sizeof(double));
+            temp = (temp >> 63) ? temp ^ (UINT64_C(1) << 63) : ~temp;
+            memcpy(&data->value.asDouble, &temp, sizeof(double));
+            break;
+        case DPI_ORACLE_TYPE_BOOLEAN:
+            data->value.asBoolean = key[0];
+            break;
+        case DPI_ORACLE_TYPE_NUMBER:
+            number.value[0] = (unsigned char) keyLength;
+            memcpy(&number.value[1], key, keyLength);
+            if (nativeTypeNum == DPI_NATIVE_TYPE_INT64)
+                return dpiData__fromOracleNumberAsInteger(data, result->env,
+                        error, &number);
+            if (nativeTypeNum == DPI_NATIVE_TYPE_UINT64)
+                return dpiData__fromOracleNumberAsUnsignedInteger(data,
+                        result->env, error, &number);
+            return dpiData__fromOracleNumberAsDouble(data, result->env,
+                    error, &number);
+        case DPI_ORACLE_TYPE_DATE:
+            date.year = (int16_t) ((int32_t)
+                    dpiAggregateResult__decode(key, 2) - 32768);
+            date.month = (uint8_t) key[2];
+            date.day = (uint8_t) key[3];
+            date.hour = (uint8_t) key[4];
+            date.minute = (uint8_t) key[5];
+            date.second = (uint8_t) key[6];
+            return dpiData__fromOracleDate(data, &date);
+        case DPI_ORACLE_TYPE_NVARCHAR:
+        case DPI_ORACLE_TYPE_NCHAR:
+            data->value.asBytes.ptr = (char*) key;
+            data->value.asBytes.length = keyLength;
+            data->value.asBytes.encoding = result->env->nencoding;
+            break;
+        default:
+            data->value.asBytes.ptr = (char*) key;
+            data->value.asBytes.length = keyLength;
+            data->value.asBytes.encoding = result->env->encoding;
+            break;
+    }
+
+    return DPI_SUCCESS;
+}
+
+
+//-----------------------------------------------------------------------------
+// dpiAggregateResult__encode() [INTERNAL]
+//   Encode an unsigned integer in the buffer as the specified number of bytes
+// in big endian order, so that keys compare in the same order as the values.
+//-----------------------------------------------------------------------------
+static void dpiAggregateResult__encode(char *buffer, uint64_t value,
+        uint32_t numBytes)
+{
+    while (numBytes-- > 0) {
+        buffer[numBytes] = (char) (value & 0xff);
+        value >>= 8;
+    }
+}
+
+
+//-----------------------------------------------------------------------------
+// dpiAggregateResult__estimateDistinct() [INTERNAL]
+//   Return the estimate of the number of distinct values from the registers
+// using the HyperLogLog estimator. Linear counting is used instead for small
+// numbers of distinct values as long as some registers are still unset. The
+// 64-bit hash is mixed from the CRC-32C of each value and its length, so
+// it has only about 32 bits of entropy: values of the same length whose
+// CRC-32C collide are counted once. No correction is made for this, so the
+// estimate becomes increasingly low beyond about 100 million distinct values
+// (about 1% low at that point).
+//-----------------------------------------------------------------------------
+static uint64_t dpiAggregateResult__estimateDistinct(
+        const uint8_t *registers)
+{
+    double numRegisters, sum, estimate;
+    uint32_t i, numZero;
+
+    numRegisters = DPI_AGGREGATE_NUM_REGISTERS;
+    for (i = 0, sum = 0.0, numZero = 0; i < DPI_AGGREGATE_NUM_REGISTERS;
+            i++) {
+        sum += 1.0 / (double) (UINT64_C(1) << registers[i]);
+        if (registers[i] == 0)
+            numZero++;
+    }
+    estimate = 0.7213 / (1.0 + 1.079 / numRegisters) * numRegisters *
+            numRegisters / sum;
+    if (estimate <= 2.5 * numRegisters && numZero > 0)
+        estimate = numRegisters *
+                dpiAggregateResult__log(numRegisters / numZero);
+    return (uint64_t) (estimate + 0.5);
+}
+
+
+//-----------------------------------------------------------------------------
+// dpiAggregateResult__finalize() [INTERNAL]
+//   Populate the values of the aggregates and the keys of the groups once all
+// rows have been added. Aggregates other than counts are null if no values
+// other than nulls were found for the group.
+//-----------------------------------------------------------------------------
+int dpiAggregateResult__finalize(dpiAggregateResult *result, dpiError *error)
+{
+    dpiAggregateAccumulator *accumulator;
+    dpiAggregateGroup *group;
+    uint32_t i, j;
+
+    accumulator = result->accumulators;
+    for (i = 0; i < result->numGroups; i++) {
+        group = &result->groups[i];
+        if (!group->key.isNull && dpiAggregateResult__decodeKey(result,
+                result->groupByOracleTypeNum, result->groupByNativeTypeNum,
+                group->keyBytes, group->keyLength, &group->key, error) < 0)
+            return DPI_FAILURE;
+        for (j = 0; j < result->numSpecs; j++, accumulator++) {
+            switch (result->specs[j].aggregateType) {
+                case DPI_AGGREGATE_COUNT:
+                    accumulator->value.isNull = 0;
+                    accumulator->value.value.asUint64 = accumulator->count;
+                    break;
+                case DPI_AGGREGATE_DISTINCT_ESTIMATE:
+                    accumulator->value.isNull = 0;
+                    accumulator->value.value.asUint64 =
+                            dpiAggregateResult__estimateDistinct(
+                                    accumulator->registers);
+                    break;
+                case DPI_AGGREGATE_MIN:
+                case DPI_AGGREGATE_MAX:
+                    accumulator->value.isNull = (accumulator->count == 0);
+                    if (!accumulator->value.isNull &&
+                            dpiAggregateResult__decodeKey(result,
+                                    result->oracleTypeNums[j],
+                                    result->nativeTypeNums[j],
+                                    accumulator->key, accumulator->keyLength,
+                                    &accumulator->value, error) < 0)
+                        return DPI_FAILURE;
+                    break;
+                default:
+                    accumulator->value.isNull = (accumulator->count == 0);
+                    break;
+            }
+        }
+    }
+
+    return DPI_SUCCESS;
+}
+
+
+//-----------------------------------------------------------------------------
+// dpiAggregateResult__findGroup() [INTERNAL]
+//   Find the group for the value at the specified position in the variable,
+// adding a new group if one does not already exist. All null values belong to
+// the same group.
+//-----------------------------------------------------------------------------
+static int dpiAggregateResult__findGroup(dpiAggregateResult *result,
+        dpiVar *var, uint32_t pos, uint32_t *groupIndex, dpiError *error)
+{
+    char buffer[DPI_AGGREGATE_MAX_KEY_SIZE];
+    uint32_t hash, keyLength, index;
+    dpiAggregateGroup *group;
+    const char *key;
+    int isNull;
+
+    if (dpiAggregateResult__checkValue(var, pos, &isNull, error) < 0)
+        return DPI_FAILURE;
+    key = NULL;
+    keyLength = 0;
+    hash = 0;
+    if (!isNull) {
+        dpiAggregateResult__getKey(var, pos, buffer, &key, &keyLength);
+        hash = dpiFingerprint__crc32c(0, key, keyLength);
+    }
+    index = result->buckets[hash & (result->numBuckets - 1)];
+    while (index > 0) {
+        group = &result->groups[index - 1];
+        if (group->hash == hash && group->key.isNull == isNull &&
+                group->keyLength == keyLength &&
+                (keyLength == 0 ||
+                memcmp(group->keyBytes, key, keyLength) == 0)) {
+            *groupIndex = index - 1;
+            return DPI_SUCCESS;
+        }
+        index = group->next;
+    }
+    return dpiAggregateResult__addGroup(result, key, keyLength, hash, isNull,
+            groupIndex, error);
+}
+
+
+//-----------------------------------------------------------------------------
+// dpiAggregateResult__free() [INTERNAL]
+//   Free the memory for an aggregate result.
+//-----------------------------------------------------------------------------
+void dpiAggregateResult__free(dpiAggregateResult *result, dpiError *error)
+{
+    dpiAggregateAccumulator *accumulator;
+    uint32_t i;
+
+    if (result->groups) {
+        for (i = 0; i < result->numGroups; i++) {
+            if (result->groups[i].keyBytes)
+                free(result->groups[i].keyBytes);
+        }
+        free(result->groups);
+        result->groups = NULL;
+    }
+    if (result->accumulators) {
+        for (i = 0; i < result->numGroups * result->numSpecs; i++) {
+            accumulator = &result->accumulators[i];
+            if (accumulator->key)
+                free(accumulator->key);
+            if (accumulator->registers)
+                free(accumulator->registers);
+        }
+        free(result->accumulators);
+        result->accumulators = NULL;
+    }
+    if (result->buckets) {
+        free(result->buckets);
+        result->buckets = NULL;
+    }
+    if (result->specs) {
+        free(result->specs);
+        result->specs = NULL;
+    }
+    if (result->oracleTypeNums) {
+        free(result->oracleTypeNums);
+        result->oracleTypeNums = NULL;
+    }
+    if (result->nativeTypeNums) {
+        free(result->nativeTypeNums);
+        result->nativeTypeNums = NULL;
+    }
+    if (result->conn) {
+        dpiGen__setRefCount(result->conn, error, -1);
+        result->conn = NULL;
+    }
+    free(result);
+}
+
+
+//-----------------------------------------------------------------------------
+// dpiAggregateResult__getKey() [INTERNAL]
+//   Return the key for the (non-null) value at the specified position in the
+// variable. Numbers, strings and raw data are used directly from the define
+// buffer as Oracle numbers already compare correctly as bytes. Other values
+// are encoded in the buffer: the sign bit of integers is inverted and all
+// bits of negative floating point numbers are inverted so that they compare
+// correctly as unsigned integers stored in big endian order.
+//-----------------------------------------------------------------------------
+static void dpiAggregateResult__getKey(dpiVar *var, uint32_t pos,
+        char *buffer, const char **key, uint32_t *keyLength)
+{
+    dpiOciDate *date;
+    uint64_t temp;
+    uint32_t bits;
+
+    *key = buffer;
+    switch (var->type->oracleTypeNum) {
+        case DPI_ORACLE_TYPE_NATIVE_INT:
+            dpiAggregateResult__encode(buffer,
+                    var->data.asUint64[pos] ^ (UINT64_C(1) << 63),
+                    sizeof(int64_t));
+            *keyLength = sizeof(int64_t);
+            break;
+        case DPI_ORACLE_TYPE_NATIVE_UINT:
+            dpiAggregateResult__encode(buffer, var->data.asUint64[pos],
+                    sizeof(uint64_t));
+            *keyLength = sizeof(uint64_t);
+            break;
+        case DPI_ORACLE_TYPE_NATIVE_FLOAT:
+            memcpy(&bits, &var->data.asFloat[pos], sizeof(float));
+            bits = (bits & 0x80000000) ? ~bits : bits ^ 0x80000000;
+            dpiAggregateResult__encode(buffer, bits, sizeof(float));
+            *keyLength = sizeof(float);
+            break;
+        case DPI_ORACLE_TYPE_NATIVE_DOUBLE:
+            memcpy(&temp, &var->data.asDouble[pos], sizeof(double));
+            temp = (temp >> 63) ? ~temp : temp ^ (UINT64_C(1) << 63);
+            dpiAggregateResult__encode(buffer, temp, sizeof(double));
+            *keyLength = sizeof(double);
+            break;
+        case DPI_ORACLE_TYPE_BOOLEAN:
+            buffer[0] = (var->data.asBoolean[pos] != 0);
+            *keyLength = 1;
+            break;
+        case DPI_ORACLE_TYPE_NUMBER:
+            *key = (const char*) &var->data.asNumber[pos].value[1];
+            *keyLength = var->data.asNumber[pos].value[0];
+            break;
+        case DPI_ORACLE_TYPE_DATE:
+            date = &var->data.asDate[pos];
+            dpiAggregateResult__encode(buffer,
+                    (uint16_t) ((int32_t) date->year + 32768), 2);
+            buffer[2] = (char) date->month;
+            buffer[3] = (char) date->day;
+            buffer[4] = (char) date->hour;
+            buffer[5] = (char) date->minute;
+            buffer[6] = (char) date->second;
+            *keyLength = 7;
+            break;
+        default:
+            *key = var->data.asBytes + pos * var->sizeInBytes;
+            *keyLength = (var->actualLength32) ? var->actualLength32[pos] :
+                    var->actualLength16[pos];
+            break;
+    }
+}
+
+
+//-----------------------------------------------------------------------------
+// dpiAggregateResult__getKeyType() [INTERNAL]
+//   Return the native type used for returning values of the variable which
+// have been transformed to keys. Numbers are returned as doubles unless the
+// variable returns them as integers. Values stored in descriptors or handles
+// and values fetched in pieces (such as long columns) are not supported.
+//-----------------------------------------------------------------------------
+static int dpiAggregateResult__getKeyType(dpiVar *var,
+        dpiNativeTypeNum *nativeTypeNum)
+{
+    switch (var->type->oracleTypeNum) {
+        case DPI_ORACLE_TYPE_NATIVE_INT:
+        case DPI_ORACLE_TYPE_NATIVE_UINT:
+        case DPI_ORACLE_TYPE_NATIVE_FLOAT:
+        case DPI_ORACLE_TYPE_NATIVE_DOUBLE:
+        case DPI_ORACLE_TYPE_BOOLEAN:
+            *nativeTypeNum = var->type->defaultNativeTypeNum;
+            return DPI_SUCCESS;
+        case DPI_ORACLE_TYPE_NUMBER:
+            *nativeTypeNum = (var->nativeTypeNum == DPI_NATIVE_TYPE_INT64 ||
+                    var->nativeTypeNum == DPI_NATIVE_TYPE_UINT64) ?
+                    var->nativeTypeNum : DPI_NATIVE_TYPE_DOUBLE;
+            return DPI_SUCCESS;
+        case DPI_ORACLE_TYPE_DATE:
+            *nativeTypeNum = DPI_NATIVE_TYPE_TIMESTAMP;
+            return DPI_SUCCESS;
+        case DPI_ORACLE_TYPE_VARCHAR:
+        case DPI_ORACLE_TYPE_NVARCHAR:
+        case DPI_ORACLE_TYPE_CHAR:
+        case DPI_ORACLE_TYPE_NCHAR:
+        case DPI_ORACLE_TYPE_RAW:
+            if (var->dynamicBytes)
+                return DPI_FAILURE;
+            *nativeTypeNum = DPI_NATIVE_TYPE_BYTES;
+            return DPI_SUCCESS;
+        default:
+            break;
+    }
+    return DPI_FAILURE;
+}
+
+
+//-----------------------------------------------------------------------------
+// dpiAggregateResult__getSumType() [INTERNAL]
+//   Return the native type used for summing values of the variable. Integers
+// are summed as integers and all other numbers as doubles.
+//-----------------------------------------------------------------------------
+static int dpiAggregateResult__getSumType(dpiVar *var,
+        dpiNativeTypeNum *nativeTypeNum)
+{
+    switch (var->type->oracleTypeNum) {
+        case DPI_ORACLE_TYPE_NATIVE_INT:
+        case DPI_ORACLE_TYPE_NATIVE_UINT:
+            *nativeTypeNum = var->type->defaultNativeTypeNum;
+            return DPI_SUCCESS;
+        case DPI_ORACLE_TYPE_NATIVE_FLOAT:
+        case DPI_ORACLE_TYPE_NATIVE_DOUBLE:
+            *nativeTypeNum = DPI_NATIVE_TYPE_DOUBLE;
+            return DPI_SUCCESS;
+        case DPI_ORACLE_TYPE_NUMBER:
+            *nativeTypeNum = (var->nativeTypeNum == DPI_NATIVE_TYPE_INT64 ||
+                    var->nativeTypeNum == DPI_NATIVE_TYPE_UINT64) ?
+                    var->nativeTypeNum : DPI_NATIVE_TYPE_DOUBLE;
+            return DPI_SUCCESS;
+        default:
+            break;
+    }
+    return DPI_FAILURE;
+}
+
+
+//-----------------------------------------------------------------------------
+// dpiAggregateResult__log() [INTERNAL]
+//   Return the natural logarithm of a value which is at least one, so that
+// the library does not depend on the maths library. The value is reduced to
+// the range [1, 2) and the series for 2 * atanh((x - 1) / (x + 1)) is then
+// used, which converges quickly in that range.
+//-----------------------------------------------------------------------------
+static double dpiAggregateResult__log(double value)
+{
+    double result, term, square;
+    uint32_t i;
+
+    for (result = 0.0; value >= 2.0; value /= 2.0)
+        result += 0.69314718055994530942;
+    term = (value - 1.0) / (value + 1.0);
+    square = term * term;
+    for (i = 1; i < 40; i += 2, term *= square)
+        result += 2.0 * term / i;
+    return result;
+}
+
+
+//-----------------------------------------------------------------------------
+// dpiAggregateResult__setExtreme() [INTERNAL]
+//   Replace the minimum (or maximum) retained by the accumulator with the
+// given key if it is the first one or if it is smaller (or larger).
+//-----------------------------------------------------------------------------
+static int dpiAggregateResult__setExtreme(
+        dpiAggregateAccumulator *accumulator, const char *key,
+        uint32_t keyLength, int isMin, dpiError *error)
+{
+    uint32_t length;
+    char *tempKey;
+    int compare;
+
+    if (accumulator->count > 1) {
+        length = (keyLength < accumulator->keyLength) ? keyLength :
+                accumulator->keyLength;
+        compare = (length > 0) ? memcmp(key, accumulator->key, length) : 0;
+        if (compare == 0)
+            compare = (keyLength > accumulator->keyLength) -
+                    (keyLength < accumulator->keyLength);
+        if ((isMin && compare >= 0) || (!isMin && compare <= 0))
+            return DPI_SUCCESS;
+    }
+    if (keyLength > accumulator->allocatedKeyLength) {
+        tempKey = realloc(accumulator->key, keyLength);
+        if (!tempKey)
+            return dpiError__set(error, "allocate key", DPI_ERR_NO_MEMORY);
+        accumulator->key = tempKey;
+        accumulator->allocatedKeyLength = keyLength;
+    }
+    if (keyLength > 0)
+        memcpy(accumulator->key, key, keyLength);
+    accumulator->keyLength = keyLength;
+    return DPI_SUCCESS;
+}
+
+
+//-----------------------------------------------------------------------------
+// dpiAggregateResult__setSpecs() [INTERNAL]
+//   Set the aggregates to compute from the given specifications, checking
+// that each is supported by the column to which it refers. If no column is
+// used for grouping, a single group is created so that aggregates are
+// returned even if no rows are fetched.
+//-----------------------------------------------------------------------------
+int dpiAggregateResult__setSpecs(dpiAggregateResult *result,
+        uint32_t numSpecs, dpiAggregateSpec *specs, uint32_t groupByPos,
+        dpiVar **vars, uint32_t numVars, dpiError *error)
+{
+    dpiNativeTypeNum keyNativeTypeNum;
+    uint32_t i, groupIndex;
+    dpiAggregateSpec *spec;
+    int status;
+    dpiVar *var;
+
+    // allocate memory for the specifications and the hash buckets
+    if (numSpecs > 0) {
+        result->specs = malloc(numSpecs * sizeof(dpiAggregateSpec));
+        result->oracleTypeNums = calloc(numSpecs, sizeof(dpiOracleTypeNum));
+        result->nativeTypeNums = calloc(numSpecs, sizeof(dpiNativeTypeNum));
+        if (!result->specs || !result->oracleTypeNums ||
+                !result->nativeTypeNums)
+            return dpiError__set(error, "allocate specs", DPI_ERR_NO_MEMORY);
+        memcpy(result->specs, specs, numSpecs * sizeof(dpiAggregateSpec));
+    }
+    result->numSpecs = numSpecs;
+    result->buckets = calloc(DPI_AGGREGATE_INITIAL_BUCKETS, sizeof(uint32_t));
+    if (!result->buckets)
+        return dpiError__set(error, "allocate buckets", DPI_ERR_NO_MEMORY);
+    result->numBuckets = DPI_AGGREGATE_INITIAL_BUCKETS;
+
+    // check each of the specifications; a count with no column is a count of
+    // the number of rows
+    for (i = 0; i < numSpecs; i++) {
+        spec = &specs[i];
+        if (spec->pos > numVars || (spec->pos == 0 &&
+                spec->aggregateType != DPI_AGGREGATE_COUNT))
+            return dpiError__set(error, "check aggregate position",
+                    DPI_ERR_QUERY_POSITION_INVALID, spec->pos);
+        result->nativeTypeNums[i] = DPI_NATIVE_TYPE_UINT64;
+        if (spec->pos == 0)
+            continue;
+        var = vars[spec->pos - 1];
+        result->oracleTypeNums[i] = var->type->oracleTypeNum;
+        switch (spec->aggregateType) {
+            case DPI_AGGREGATE_COUNT:
+                status = DPI_SUCCESS;
+                break;
+            case DPI_AGGREGATE_SUM:
+                status = dpiAggregateResult__getSumType(var,
+                        &result->nativeTypeNums[i]);
+                break;
+            case DPI_AGGREGATE_MIN:
+            case DPI_AGGREGATE_MAX:
+                status = dpiAggregateResult__getKeyType(var,
+                        &result->nativeTypeNums[i]);
+                break;
+            case DPI_AGGREGATE_DISTINCT_ESTIMATE:
+                status = dpiAggregateResult__getKeyType(var,
+                        &keyNativeTypeNum);
+                break;
+            default:
+                status = DPI_FAILURE;
+                break;
+        }
+        if (status < 0)
+            return dpiError__set(error, "check aggregate",
+                    DPI_ERR_AGGREGATE_NOT_SUPPORTED, spec->aggregateType,
+                    spec->pos);
+    }
+
+    // check the column used for grouping, if one was specified
+    if (groupByPos > 0) {
+        if (groupByPos > numVars)
+            return dpiError__set(error, "check group by position",
+                    DPI_ERR_QUERY_POSITION_INVALID, groupByPos);
+        var = vars[groupByPos - 1];
+        if (dpiAggregateResult__getKeyType(var,
+                &result->groupByNativeTypeNum) < 0)
+            return dpiError__set(error, "check group by type",
+                    DPI_ERR_UNHANDLED_DATA_TYPE, var->type->oracleTypeNum);
+        result->groupByOracleTypeNum = var->type->oracleTypeNum;
+        result->groupByPos = groupByPos;
+        return DPI_SUCCESS;
+    }
+    return dpiAggregateResult__addGroup(result, NULL, 0, 0, 1, &groupIndex,
+            error);
+}
+
+
+//-----------------------------------------------------------------------------
+// dpiAggregateResult_addRef() [PUBLIC]
+//   Add a reference to the aggregate result.
+//-----------------------------------------------------------------------------
+int dpiAggregateResult_addRef(dpiAggregateResult *result)
+{
+    return dpiGen__addRef(result, DPI_HTYPE_AGGREGATE_RESULT, __func__);
+}
+
+
+//-----------------------------------------------------------------------------
+// dpiAggregateResult_getGroupKey() [PUBLIC]
+//   Return the value of the column used for grouping for the given
+// (zero-based) group.
+//-----------------------------------------------------------------------------
+int dpiAggregateResult_getGroupKey(dpiAggregateResult *result,
+        uint32_t groupIndex, dpiNativeTypeNum *nativeTypeNum, dpiData **data)
+{
+    dpiError error;
+
+    if (dpiGen__startPublicFn(result, DPI_HTYPE_AGGREGATE_RESULT, __func__,
+            &error) < 0)
+        return DPI_FAILURE;
+    DPI_CHECK_PTR_NOT_NULL(nativeTypeNum)
+    DPI_CHECK_PTR_NOT_NULL(data)
+    if (result->groupByPos == 0)
+        return dpiError__set(&error, "check group by position",
+                DPI_ERR_QUERY_POSITION_INVALID, result->groupByPos);
+    if (groupIndex >= result->numGroups)
+        return dpiError__set(&error, "check group index",
+                DPI_ERR_INVALID_ARRAY_POSITION, groupIndex,
+                result->numGroups);
+    *nativeTypeNum = result->groupByNativeTypeNum;
+    *data = &result->groups[groupIndex].key;
+    return DPI_SUCCESS;
+}
+
+
+//-----------------------------------------------------------------------------
+// dpiAggregateResult_getNumGroups() [PUBLIC]
+//   Return the number of groups in the aggregate result.
+//-----------------------------------------------------------------------------
+int dpiAggregateResult_getNumGroups(dpiAggregateResult *result,
+        uint32_t *numGroups)
+{
+    dpiError error;
+
+    if (dpiGen__startPublicFn(result, DPI_HTYPE_AGGREGATE_RESULT, __func__,
+            &error) < 0)
+        return DPI_FAILURE;
+    DPI_CHECK_PTR_NOT_NULL(numGroups)
+    *numGroups = result->numGroups;
+    return DPI_SUCCESS;
+}
+
+
+//-----------------------------------------------------------------------------
+// dpiAggregateResult_getValue() [PUBLIC]
+//   Return the value of the aggregate at the given (zero-based) index in the
+// specifications for the given (zero-based) group.
+//-----------------------------------------------------------------------------
+int dpiAggregateResult_getValue(dpiAggregateResult *result,
+        uint32_t groupIndex, uint32_t specIndex,
+        dpiNativeTypeNum *nativeTypeNum, dpiData **data)
+{
+    dpiError error;
+
+    if (dpiGen__startPublicFn(result, DPI_HTYPE_AGGREGATE_RESULT, __func__,
+            &error) < 0)
+        return DPI_FAILURE;
+    DPI_CHECK_PTR_NOT_NULL(nativeTypeNum)
+    DPI_CHECK_PTR_NOT_NULL(data)
+    if (groupIndex >= result->numGroups)
+        return dpiError__set(&error, "check group index",
+                DPI_ERR_INVALID_ARRAY_POSITION, groupIndex,
+                result->numGroups);
+    if (specIndex >= result->numSpecs)
+        return dpiError__set(&error, "check spec index",
+                DPI_ERR_INVALID_ARRAY_POSITION, specIndex, result->numSpecs);
+    *nativeTypeNum = result->nativeTypeNums[specIndex];
+    *data = &result->accumulators[(size_t) groupIndex * result->numSpecs +
+            specIndex].value;
+    return DPI_SUCCESS;
+}
+
+
+//-----------------------------------------------------------------------------
+// dpiAggregateResult_release() [PUBLIC]
+//   Release a reference to the aggregate result.
+//-----------------------------------------------------------------------------
+int dpiAggregateResult_release(dpiAggregateResult *result)
+{
+    return dpiGen__release(result, DPI_HTYPE_AGGREGATE_RESULT, __func__);
+}
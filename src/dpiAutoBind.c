@@ -0,0 +1,699 @@
+//-----------------------------------------------------------------------------
+// Copyright (c) 2017 Oracle and/or its affiliates.  All rights reserved.
+// This program is free software: you can modify it and/or redistribute it
+// under the terms of:
+//
+// (i)  the Universal Permissive License v 1.0 or at your option, any
+//      later version (http://oss.oracle.com/licenses/upl); and/or
+//
+// (ii) the Apache License v 2.0. (http://www.apache.org/licenses/LICENSE-2.0)
+//-----------------------------------------------------------------------------
+
+//-----------------------------------------------------------------------------
+// dpiAutoBind.c
+//   Implementation of the lexer used when statements are prepared with the
+// prepare mode DPI_MODE_PREPARE_AUTO_BIND. Numeric and string literals found
+// in queries and DML statements are replaced by bind variables, comments
+// other than hints are removed and runs of whitespace are collapsed to a
+// single space so that statements which differ only in their literals share
+// the same entry in the statement cache and the same cursor on the server.
+// Literals which may need to remain constant (those in select lists, in the
+// GROUP BY and ORDER BY clauses, in PIVOT and UNPIVOT clauses, in the lengths
+// of data types and in typed literals like DATE '2017-01-01') are left in
+// place. Statements which already contain bind variables are not changed at
+// all. The same lexer is used by batches to normalize DML statements and to
+// find the bind variables they contain; in that case all literals are left in
+// place.
+//-----------------------------------------------------------------------------
+
+#include "dpiImpl.h"
+
+// words which start the statements in which literals are replaced
+static const char *dpiAutoBindStatementWords[] = {
+    "DELETE", "INSERT", "MERGE", "SELECT", "UPDATE", "WITH", NULL
+};
+
+// words which end a select list or a GROUP BY or ORDER BY clause
+static const char *dpiAutoBindClauseEndWords[] = {
+    "EXCEPT", "FETCH", "FOR", "FROM", "HAVING", "INTERSECT", "MINUS",
+    "OFFSET", "UNION", "WHERE", NULL
+};
+
+// words which, when followed by parentheses, require the literals within
+// those parentheses to be constant
+static const char *dpiAutoBindConstantArgWords[] = {
+    "CHAR", "DAY", "DEC", "DECIMAL", "FLOAT", "NCHAR", "NUMBER", "NUMERIC",
+    "NVARCHAR2", "PIVOT", "RAW", "SAMPLE", "SECOND", "SEED", "TIMESTAMP",
+    "UNPIVOT", "UROWID", "VARCHAR", "VARCHAR2", "XML", "YEAR", NULL
+};
+
+// words which require the literal that immediately follows them to be
+// constant
+static const char *dpiAutoBindTypedLiteralWords[] = {
+    "DATE", "INTERVAL", "TIMESTAMP", "WAIT", NULL
+};
+
+// forward declarations of internal functions only used in this file
+static int dpiAutoBind__abandon(dpiAutoBind *autoBind);
+static int dpiAutoBind__addEntry(dpiAutoBind *autoBind, int isNumber,
+        uint32_t offset, uint32_t length, dpiError *error);
+static int dpiAutoBind__addLiteral(dpiAutoBind *autoBind, int isNumber,
+        const char *text, uint32_t textLength, uint32_t valueLength,
+        dpiError *error);
+static int dpiAutoBind__append(dpiAutoBind *autoBind, const char *text,
+        uint32_t textLength, dpiError *error);
+static int dpiAutoBind__isIdentChar(char ch);
+static int dpiAutoBind__isWord(const char *word, uint32_t wordLength,
+        const char *value);
+static int dpiAutoBind__isWordInList(const char *word, uint32_t wordLength,
+        const char **list);
+static int dpiAutoBind__processParen(dpiAutoBind *autoBind, char ch,
+        dpiError *error);
+static int dpiAutoBind__processWord(dpiAutoBind *autoBind, const char *word,
+        uint32_t wordLength, dpiError *error);
+static int dpiAutoBind__scanBind(dpiAutoBind *autoBind, const char **ptr,
+        const char *end, dpiError *error);
+static int dpiAutoBind__scanComment(dpiAutoBind *autoBind, const char **ptr,
+        const char *end, dpiError *error);
+static int dpiAutoBind__scanNumber(dpiAutoBind *autoBind, const char **ptr,
+        const char *end, dpiError *error);
+static int dpiAutoBind__scanQuotedName(dpiAutoBind *autoBind,
+        const char **ptr, const char *end, dpiError *error);
+static int dpiAutoBind__scanString(dpiAutoBind *autoBind, const char **ptr,
+        const char *end, uint32_t prefixLength, dpiError *error);
+static int dpiAutoBind__scanWord(dpiAutoBind *autoBind, const char **ptr,
+        const char *end, dpiError *error);
+static int dpiAutoBind__startToken(dpiAutoBind *autoBind, char firstChar,
+        dpiError *error);
+
+
+//-----------------------------------------------------------------------------
+// dpiAutoBind__abandon() [INTERNAL]
+//   Stop scanning the statement, which will then be prepared unchanged.
+//-----------------------------------------------------------------------------
+static int dpiAutoBind__abandon(dpiAutoBind *autoBind)
+{
+    autoBind->abandoned = 1;
+    return DPI_SUCCESS;
+}
+
+
+//-----------------------------------------------------------------------------
+// dpiAutoBind__addEntry() [INTERNAL]
+//   Add an entry to the list of literals, increasing the size of the list if
+// needed. When bind variables are being found the list contains the bind
+// variables instead and the offset refers to the normalized SQL.
+//-----------------------------------------------------------------------------
+static int dpiAutoBind__addEntry(dpiAutoBind *autoBind, int isNumber,
+        uint32_t offset, uint32_t length, dpiError *error)
+{
+    dpiAutoBindLiteral *literals, *literal;
+
+    if (autoBind->numLiterals == autoBind->allocatedLiterals) {
+        literals = realloc(autoBind->literals,
+                (autoBind->allocatedLiterals + 16) *
+                sizeof(dpiAutoBindLiteral));
+        if (!literals)
+            return dpiError__set(error, "allocate literals",
+                    DPI_ERR_NO_MEMORY);
+        autoBind->literals = literals;
+        autoBind->allocatedLiterals += 16;
+    }
+    literal = &autoBind->literals[autoBind->numLiterals++];
+    literal->isNumber = isNumber;
+    literal->offset = offset;
+    literal->length = length;
+    return DPI_SUCCESS;
+}
+
+
+//-----------------------------------------------------------------------------
+// dpiAutoBind__addLiteral() [INTERNAL]
+//   Add the literal to the list of literals and replace it by a bind
+// variable. The value of the literal has already been placed at the end of
+// the values buffer. Literals which need to remain constant are left in
+// place.
+//-----------------------------------------------------------------------------
+static int dpiAutoBind__addLiteral(dpiAutoBind *autoBind, int isNumber,
+        const char *text, uint32_t textLength, uint32_t valueLength,
+        dpiError *error)
+{
+    char name[20];
+    int keep;
+
+    // determine if the literal needs to remain constant
+    keep = autoBind->findBinds;
+    if (!keep)
+        keep = ((autoBind->keepMask | autoBind->constantMask) &
+                ((2ULL << autoBind->depth) - 1)) != 0;
+    if (!keep && autoBind->prevWord)
+        keep = dpiAutoBind__isWordInList(autoBind->prevWord,
+                autoBind->prevWordLength, dpiAutoBindTypedLiteralWords);
+    if (!keep && isNumber)
+        keep = (textLength > DPI_NUMBER_MAX_DIGITS);
+    else if (!keep)
+        keep = (valueLength > DPI_AUTO_BIND_MAX_STRING_SIZE);
+    if (!keep)
+        keep = (autoBind->numLiterals == DPI_AUTO_BIND_MAX_LITERALS);
+    autoBind->prevWord = NULL;
+    if (keep)
+        return dpiAutoBind__append(autoBind, text, textLength, error);
+
+    // add the literal; its value is already in the values buffer
+    if (dpiAutoBind__addEntry(autoBind, isNumber, autoBind->valuesLength,
+            valueLength, error) < 0)
+        return DPI_FAILURE;
+    autoBind->valuesLength += valueLength;
+
+    // replace it by a bind variable
+    snprintf(name, sizeof(name), ":DPI_B%u", autoBind->numLiterals);
+    if (dpiAutoBind__append(autoBind, name, (uint32_t) strlen(name),
+            error) < 0)
+        return DPI_FAILURE;
+    autoBind->afterBind = 1;
+    return DPI_SUCCESS;
+}
+
+
+//-----------------------------------------------------------------------------
+// dpiAutoBind__append() [INTERNAL]
+//   Append the text to the normalized SQL, increasing the size of the buffer
+// if needed.
+//-----------------------------------------------------------------------------
+static int dpiAutoBind__append(dpiAutoBind *autoBind, const char *text,
+        uint32_t textLength, dpiError *error)
+{
+    uint32_t allocatedSqlLength;
+    char *sql;
+
+    if (autoBind->sqlLength + textLength > autoBind->allocatedSqlLength) {
+        allocatedSqlLength = autoBind->allocatedSqlLength * 2 + textLength;
+        sql = realloc(autoBind->sql, allocatedSqlLength);
+        if (!sql)
+            return dpiError__set(error, "allocate SQL", DPI_ERR_NO_MEMORY);
+        autoBind->sql = sql;
+        autoBind->allocatedSqlLength = allocatedSqlLength;
+    }
+    memcpy(autoBind->sql + autoBind->sqlLength, text, textLength);
+    autoBind->sqlLength += textLength;
+    return DPI_SUCCESS;
+}
+
+
+//-----------------------------------------------------------------------------
+// dpiAutoBind__clear() [INTERNAL]
+//   Free the memory allocated while scanning the statement.
+//-----------------------------------------------------------------------------
+void dpiAutoBind__clear(dpiAutoBind *autoBind)
+{
+    if (autoBind->sql) {
+        free(autoBind->sql);
+        autoBind->sql = NULL;
+    }
+    if (autoBind->values) {
+        free(autoBind->values);
+        autoBind->values = NULL;
+    }
+    if (autoBind->literals) {
+        free(autoBind->literals);
+        autoBind->literals = NULL;
+    }
+    autoBind->numLiterals = 0;
+}
+
+
+//-----------------------------------------------------------------------------
+// dpiAutoBind__isIdentChar() [INTERNAL]
+//   Return whether the character may form part of an unquoted identifier.
+// Bytes which are not ASCII are assumed to be part of multibyte characters
+// found in identifiers.
+//-----------------------------------------------------------------------------
+static int dpiAutoBind__isIdentChar(char ch)
+{
+    return ((ch >= 'A' && ch <= 'Z') || (ch >= 'a' && ch <= 'z') ||
+            (ch >= '0' && ch <= '9') || ch == '_' || ch == '$' ||
+            ch == '#' || (unsigned char) ch >= 0x80);
+}
+
+
+//-----------------------------------------------------------------------------
+// dpiAutoBind__isWord() [INTERNAL]
+//   Return whether the word matches the given uppercase value, ignoring case.
+//-----------------------------------------------------------------------------
+static int dpiAutoBind__isWord(const char *word, uint32_t wordLength,
+        const char *value)
+{
+    uint32_t i;
+    char ch;
+
+    for (i = 0; i < wordLength; i++) {
+        ch = word[i];
+        if (ch >= 'a' && ch <= 'z')
+            ch -= 'a' - 'A';
+        if (ch != value[i])
+            return 0;
+    }
+    return (value[i] == '\0');
+}
+
+
+//-----------------------------------------------------------------------------
+// dpiAutoBind__isWordInList() [INTERNAL]
+//   Return whether the word matches any of the words in the list.
+//-----------------------------------------------------------------------------
+static int dpiAutoBind__isWordInList(const char *word, uint32_t wordLength,
+        const char **list)
+{
+    for (; *list; list++) {
+        if (dpiAutoBind__isWord(word, wordLength, *list))
+            return 1;
+    }
+    return 0;
+}
+
+
+//-----------------------------------------------------------------------------
+// dpiAutoBind__parse() [INTERNAL]
+//   Scan the statement, building the normalized SQL and the list of literals
+// that were replaced by bind variables or, if bind variables are to be found,
+// the list of bind variables the statement contains. If the statement is not
+// a candidate for this, the normalized SQL is left as NULL.
+//-----------------------------------------------------------------------------
+int dpiAutoBind__parse(dpiAutoBind *autoBind, const char *sql,
+        uint32_t sqlLength, int findBinds, dpiError *error)
+{
+    const char *ptr, *end;
+    int status;
+    char ch;
+
+    // allocate buffers; the values of the literals never take more space
+    // than the literals themselves
+    memset(autoBind, 0, sizeof(dpiAutoBind));
+    autoBind->findBinds = findBinds;
+    autoBind->allocatedSqlLength = sqlLength + 64;
+    autoBind->sql = malloc(autoBind->allocatedSqlLength);
+    autoBind->values = malloc(sqlLength + 1);
+    if (!autoBind->sql || !autoBind->values) {
+        dpiAutoBind__clear(autoBind);
+        return dpiError__set(error, "allocate SQL", DPI_ERR_NO_MEMORY);
+    }
+
+    // scan each token in turn
+    ptr = sql;
+    end = sql + sqlLength;
+    status = DPI_SUCCESS;
+    while (ptr < end && !autoBind->abandoned && status == DPI_SUCCESS) {
+        ch = *ptr;
+        if (ch == ' ' || ch == '\t' || ch == '\n' || ch == '\r' ||
+                ch == '\f' || ch == '\v') {
+            if (!autoBind->pendingSeparator)
+                autoBind->pendingSeparator = ' ';
+            ptr++;
+        } else if ((ch == '-' && ptr + 1 < end && ptr[1] == '-') ||
+                (ch == '/' && ptr + 1 < end && ptr[1] == '*')) {
+            status = dpiAutoBind__scanComment(autoBind, &ptr, end, error);
+        } else if ((ch >= '0' && ch <= '9') || (ch == '.' && ptr + 1 < end &&
+                ptr[1] >= '0' && ptr[1] <= '9')) {
+            status = dpiAutoBind__scanNumber(autoBind, &ptr, end, error);
+        } else if (ch == '\'') {
+            status = dpiAutoBind__scanString(autoBind, &ptr, end, 0, error);
+        } else if (dpiAutoBind__isIdentChar(ch)) {
+            status = dpiAutoBind__scanWord(autoBind, &ptr, end, error);
+        } else if (ch == ':' && ptr + 1 < end &&
+                (dpiAutoBind__isIdentChar(ptr[1]) || ptr[1] == '"')) {
+            if (autoBind->findBinds)
+                status = dpiAutoBind__scanBind(autoBind, &ptr, end, error);
+            else status = dpiAutoBind__abandon(autoBind);
+        } else if (ch == '"') {
+            status = dpiAutoBind__scanQuotedName(autoBind, &ptr, end, error);
+        } else {
+            status = dpiAutoBind__startToken(autoBind, ch, error);
+            if (status == DPI_SUCCESS)
+                status = dpiAutoBind__append(autoBind, ptr, 1, error);
+            if (status == DPI_SUCCESS)
+                status = dpiAutoBind__processParen(autoBind, ch, error);
+            ptr++;
+        }
+    }
+
+    // statements which are empty or which could not be scanned are prepared
+    // unchanged
+    if (status < 0 || autoBind->abandoned || autoBind->numWords == 0)
+        dpiAutoBind__clear(autoBind);
+    return status;
+}
+
+
+//-----------------------------------------------------------------------------
+// dpiAutoBind__processParen() [INTERNAL]
+//   Track the depth of parentheses. Literals within parentheses following a
+// data type, a function requiring constant arguments or a PIVOT or UNPIVOT
+// clause need to remain constant, as do those found in select lists and in
+// GROUP BY and ORDER BY clauses; these are tracked by setting the bit for the
+// depth at which they are found, which is cleared when the parentheses are
+// closed. Parentheses requiring constants use a separate mask so that words
+// ending a select list (like the FOR of a PIVOT clause) do not clear them.
+//-----------------------------------------------------------------------------
+static int dpiAutoBind__processParen(dpiAutoBind *autoBind, char ch,
+        dpiError *error)
+{
+    const char *word = autoBind->prevWord;
+    uint32_t wordLength = autoBind->prevWordLength;
+
+    autoBind->prevWord = NULL;
+    if (ch == '(') {
+        if (autoBind->depth == DPI_AUTO_BIND_MAX_DEPTH)
+            return dpiAutoBind__abandon(autoBind);
+        autoBind->depth++;
+        if (word && (dpiAutoBind__isWordInList(word, wordLength,
+                dpiAutoBindConstantArgWords) ||
+                (wordLength > 5 && dpiAutoBind__isWord(word, 5, "JSON_")) ||
+                (wordLength > 3 && dpiAutoBind__isWord(word, 3, "XML"))))
+            autoBind->constantMask |= 1ULL << autoBind->depth;
+    } else if (ch == ')') {
+        if (autoBind->depth == 0)
+            return dpiAutoBind__abandon(autoBind);
+        autoBind->depth--;
+        autoBind->keepMask &= (2ULL << autoBind->depth) - 1;
+        autoBind->constantMask &= (2ULL << autoBind->depth) - 1;
+    }
+    return DPI_SUCCESS;
+}
+
+
+//-----------------------------------------------------------------------------
+// dpiAutoBind__processWord() [INTERNAL]
+//   Process a keyword or identifier. The first word determines whether the
+// statement is a candidate for having its literals replaced; the remaining
+// words mark the start and end of the select lists and GROUP BY and ORDER BY
+// clauses in which literals are left in place.
+//-----------------------------------------------------------------------------
+static int dpiAutoBind__processWord(dpiAutoBind *autoBind, const char *word,
+        uint32_t wordLength, dpiError *error)
+{
+    const char *prevWord = autoBind->prevWord;
+    uint64_t bit = 1ULL << autoBind->depth;
+
+    // only queries and DML statements are candidates; PL/SQL declarations in
+    // the WITH clause are excluded as well
+    autoBind->numWords++;
+    if (autoBind->numWords == 1 && !dpiAutoBind__isWordInList(word,
+            wordLength, dpiAutoBindStatementWords))
+        return dpiAutoBind__abandon(autoBind);
+    if (autoBind->numWords == 2 && prevWord && dpiAutoBind__isWord(prevWord,
+            autoBind->prevWordLength, "WITH") &&
+            (dpiAutoBind__isWord(word, wordLength, "FUNCTION") ||
+             dpiAutoBind__isWord(word, wordLength, "PROCEDURE")))
+        return dpiAutoBind__abandon(autoBind);
+
+    // track select lists and GROUP BY and ORDER BY clauses
+    if (dpiAutoBind__isWord(word, wordLength, "SELECT"))
+        autoBind->keepMask |= bit;
+    else if (dpiAutoBind__isWord(word, wordLength, "BY") && prevWord &&
+            (dpiAutoBind__isWord(prevWord, autoBind->prevWordLength,
+                    "GROUP") ||
+             dpiAutoBind__isWord(prevWord, autoBind->prevWordLength,
+                    "ORDER") ||
+             dpiAutoBind__isWord(prevWord, autoBind->prevWordLength,
+                    "SIBLINGS")))
+        autoBind->keepMask |= bit;
+    else if (dpiAutoBind__isWordInList(word, wordLength,
+            dpiAutoBindClauseEndWords))
+        autoBind->keepMask &= ~bit;
+
+    autoBind->prevWord = word;
+    autoBind->prevWordLength = wordLength;
+    return dpiAutoBind__append(autoBind, word, wordLength, error);
+}
+
+
+//-----------------------------------------------------------------------------
+// dpiAutoBind__scanBind() [INTERNAL]
+//   Scan a bind variable, which is retained as is and added to the list of
+// bind variables found in the statement.
+//-----------------------------------------------------------------------------
+static int dpiAutoBind__scanBind(dpiAutoBind *autoBind, const char **ptr,
+        const char *end, dpiError *error)
+{
+    const char *start = *ptr, *pos = *ptr + 1;
+
+    if (*pos == '"') {
+        for (pos++; pos < end && *pos != '"'; pos++);
+        if (pos == end)
+            return dpiAutoBind__abandon(autoBind);
+        pos++;
+    } else {
+        while (pos < end && dpiAutoBind__isIdentChar(*pos))
+            pos++;
+    }
+    *ptr = pos;
+    autoBind->prevWord = NULL;
+    if (dpiAutoBind__startToken(autoBind, *start, error) < 0)
+        return DPI_FAILURE;
+    if (dpiAutoBind__addEntry(autoBind, 0, autoBind->sqlLength,
+            (uint32_t) (pos - start), error) < 0)
+        return DPI_FAILURE;
+    if (dpiAutoBind__append(autoBind, start, (uint32_t) (pos - start),
+            error) < 0)
+        return DPI_FAILURE;
+    autoBind->afterBind = 1;
+    return DPI_SUCCESS;
+}
+
+
+//-----------------------------------------------------------------------------
+// dpiAutoBind__scanComment() [INTERNAL]
+//   Scan a comment. Hints are retained as is (followed by a line break in the
+// case of single line hints) and all other comments are treated as
+// whitespace.
+//-----------------------------------------------------------------------------
+static int dpiAutoBind__scanComment(dpiAutoBind *autoBind, const char **ptr,
+        const char *end, dpiError *error)
+{
+    const char *start = *ptr, *pos;
+    int isHint, isSingleLine;
+
+    isSingleLine = (start[0] == '-');
+    isHint = (start + 2 < end && start[2] == '+');
+    if (isSingleLine) {
+        for (pos = start + 2; pos < end && *pos != '\n'; pos++);
+        *ptr = pos;
+    } else {
+        for (pos = start + 2; pos + 1 < end; pos++) {
+            if (pos[0] == '*' && pos[1] == '/')
+                break;
+        }
+        if (pos + 1 >= end)
+            return dpiAutoBind__abandon(autoBind);
+        pos += 2;
+        *ptr = pos;
+    }
+    if (!isHint) {
+        if (!autoBind->pendingSeparator)
+            autoBind->pendingSeparator = ' ';
+        return DPI_SUCCESS;
+    }
+    if (dpiAutoBind__startToken(autoBind, *start, error) < 0)
+        return DPI_FAILURE;
+    if (isSingleLine)
+        autoBind->pendingSeparator = '\n';
+    return dpiAutoBind__append(autoBind, start, (uint32_t) (pos - start),
+            error);
+}
+
+
+//-----------------------------------------------------------------------------
+// dpiAutoBind__scanNumber() [INTERNAL]
+//   Scan a numeric literal. Literals with a suffix denoting a binary floating
+// point number (or which are immediately followed by other characters) are
+// left in place.
+//-----------------------------------------------------------------------------
+static int dpiAutoBind__scanNumber(dpiAutoBind *autoBind, const char **ptr,
+        const char *end, dpiError *error)
+{
+    const char *start = *ptr, *pos = *ptr, *exponent;
+    uint32_t length;
+
+    while (pos < end && *pos >= '0' && *pos <= '9')
+        pos++;
+    if (pos < end && *pos == '.') {
+        for (pos++; pos < end && *pos >= '0' && *pos <= '9'; pos++);
+    }
+    if (pos < end && (*pos == 'e' || *pos == 'E')) {
+        exponent = pos + 1;
+        if (exponent < end && (*exponent == '+' || *exponent == '-'))
+            exponent++;
+        if (exponent < end && *exponent >= '0' && *exponent <= '9') {
+            for (pos = exponent; pos < end && *pos >= '0' && *pos <= '9';
+                    pos++);
+        }
+    }
+    length = (uint32_t) (pos - start);
+    *ptr = pos;
+    if (dpiAutoBind__startToken(autoBind, *start, error) < 0)
+        return DPI_FAILURE;
+    if (pos < end && dpiAutoBind__isIdentChar(*pos)) {
+        while (pos < end && dpiAutoBind__isIdentChar(*pos))
+            pos++;
+        *ptr = pos;
+        autoBind->prevWord = NULL;
+        return dpiAutoBind__append(autoBind, start, (uint32_t) (pos - start),
+                error);
+    }
+    memcpy(autoBind->values + autoBind->valuesLength, start, length);
+    return dpiAutoBind__addLiteral(autoBind, 1, start, length, length, error);
+}
+
+
+//-----------------------------------------------------------------------------
+// dpiAutoBind__scanQuotedName() [INTERNAL]
+//   Scan a quoted identifier, which is retained as is.
+//-----------------------------------------------------------------------------
+static int dpiAutoBind__scanQuotedName(dpiAutoBind *autoBind,
+        const char **ptr, const char *end, dpiError *error)
+{
+    const char *start = *ptr, *pos;
+
+    for (pos = start + 1; pos < end && *pos != '"'; pos++);
+    if (pos == end)
+        return dpiAutoBind__abandon(autoBind);
+    *ptr = ++pos;
+    autoBind->prevWord = NULL;
+    if (dpiAutoBind__startToken(autoBind, *start, error) < 0)
+        return DPI_FAILURE;
+    return dpiAutoBind__append(autoBind, start, (uint32_t) (pos - start),
+            error);
+}
+
+
+//-----------------------------------------------------------------------------
+// dpiAutoBind__scanString() [INTERNAL]
+//   Scan a string literal, including the prefix (if any) that precedes the
+// opening quote. Quotes are escaped by doubling them except in literals using
+// the alternative quoting mechanism (q'[...]'), where the text ends with the
+// closing delimiter followed by a quote. The value of the literal is placed
+// at the end of the values buffer. National character literals are left in
+// place.
+//-----------------------------------------------------------------------------
+static int dpiAutoBind__scanString(dpiAutoBind *autoBind, const char **ptr,
+        const char *end, uint32_t prefixLength, dpiError *error)
+{
+    const char *start = *ptr, *pos = *ptr + prefixLength + 1;
+    char *value, openChar, closeChar;
+    int isNational, isQuoted;
+    uint32_t valueLength;
+
+    isNational = (prefixLength > 0 && (*start == 'n' || *start == 'N'));
+    isQuoted = (prefixLength > 0 && (start[prefixLength - 1] == 'q' ||
+            start[prefixLength - 1] == 'Q'));
+    value = autoBind->values + autoBind->valuesLength;
+    valueLength = 0;
+
+    // literals using the alternative quoting mechanism
+    if (isQuoted) {
+        if (pos == end || *pos == ' ' || *pos == '\t' || *pos == '\n' ||
+                *pos == '\r')
+            return dpiAutoBind__abandon(autoBind);
+        openChar = *pos++;
+        switch (openChar) {
+            case '[':
+                closeChar = ']';
+                break;
+            case '{':
+                closeChar = '}';
+                break;
+            case '(':
+                closeChar = ')';
+                break;
+            case '<':
+                closeChar = '>';
+                break;
+            default:
+                closeChar = openChar;
+        }
+        while (pos + 1 < end && (pos[0] != closeChar || pos[1] != '\''))
+            value[valueLength++] = *pos++;
+        if (pos + 1 >= end)
+            return dpiAutoBind__abandon(autoBind);
+        pos += 2;
+
+    // all other literals
+    } else {
+        while (1) {
+            if (pos == end)
+                return dpiAutoBind__abandon(autoBind);
+            if (*pos == '\'') {
+                if (pos + 1 < end && pos[1] == '\'') {
+                    value[valueLength++] = '\'';
+                    pos += 2;
+                    continue;
+                }
+                pos++;
+                break;
+            }
+            value[valueLength++] = *pos++;
+        }
+    }
+
+    // add the literal, unless it is a national character literal
+    *ptr = pos;
+    if (dpiAutoBind__startToken(autoBind, *start, error) < 0)
+        return DPI_FAILURE;
+    if (isNational) {
+        autoBind->prevWord = NULL;
+        return dpiAutoBind__append(autoBind, start, (uint32_t) (pos - start),
+                error);
+    }
+    return dpiAutoBind__addLiteral(autoBind, 0, start,
+            (uint32_t) (pos - start), valueLength, error);
+}
+
+
+//-----------------------------------------------------------------------------
+// dpiAutoBind__scanWord() [INTERNAL]
+//   Scan a keyword or unquoted identifier. The prefixes q, n and nq are
+// recognized when immediately followed by a quote as the start of a string
+// literal.
+//-----------------------------------------------------------------------------
+static int dpiAutoBind__scanWord(dpiAutoBind *autoBind, const char **ptr,
+        const char *end, dpiError *error)
+{
+    const char *start = *ptr, *pos = *ptr;
+    uint32_t length;
+
+    while (pos < end && dpiAutoBind__isIdentChar(*pos))
+        pos++;
+    length = (uint32_t) (pos - start);
+    if (pos < end && *pos == '\'' && (dpiAutoBind__isWord(start, length,
+            "Q") || dpiAutoBind__isWord(start, length, "N") ||
+            dpiAutoBind__isWord(start, length, "NQ")))
+        return dpiAutoBind__scanString(autoBind, ptr, end, length, error);
+    *ptr = pos;
+    if (dpiAutoBind__startToken(autoBind, *start, error) < 0)
+        return DPI_FAILURE;
+    return dpiAutoBind__processWord(autoBind, start, length, error);
+}
+
+
+//-----------------------------------------------------------------------------
+// dpiAutoBind__startToken() [INTERNAL]
+//   Prepare to append a token to the normalized SQL by appending the
+// separator that replaces any whitespace and comments preceding it. A space
+// is also needed if a bind variable was just added and the token would
+// otherwise become part of its name.
+//-----------------------------------------------------------------------------
+static int dpiAutoBind__startToken(dpiAutoBind *autoBind, char firstChar,
+        dpiError *error)
+{
+    char separator;
+
+    separator = autoBind->pendingSeparator;
+    if (!separator && autoBind->afterBind &&
+            dpiAutoBind__isIdentChar(firstChar))
+        separator = ' ';
+    autoBind->pendingSeparator = 0;
+    autoBind->afterBind = 0;
+    if (separator && autoBind->sqlLength > 0)
+        return dpiAutoBind__append(autoBind, &separator, 1, error);
+    return DPI_SUCCESS;
+}
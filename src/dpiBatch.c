@@ -0,0 +1,759 @@
+//-----------------------------------------------------------------------------
+// Copyright (c) 2017 Oracle and/or its affiliates.  All rights reserved.
+// This program is free software: you can modify it and/or redistribute it
+// under the terms of:
+//
+// (i)  the Universal Permissive License v 1.0 or at your option, any
+//      later version (http://oss.oracle.com/licenses/upl); and/or
+//
+// (ii) the Apache License v 2.0. (http://www.apache.org/licenses/LICENSE-2.0)
+//-----------------------------------------------------------------------------
+
+//-----------------------------------------------------------------------------
+// dpiBatch.c
+//   Implementation of batches of DML statements executed in a single round
+// trip. The statements are executed in turn with execute immediate by an
+// anonymous PL/SQL block generated from their (normalized) text, using the
+// variables bound to each statement. The block only depends on the text of
+// the statements and the mode of execution so executing the same sequence of
+// statements again uses the block already prepared by the batch or, for
+// other batches, the block found in the statement cache.
+//-----------------------------------------------------------------------------
+
+#include "dpiImpl.h"
+
+// number of variables used to hold the results of each statement: the number
+// of rows affected, the error code and the error message
+#define DPI_BATCH_NUM_RESULT_VARS       3
+
+// forward declarations of internal functions only used in this file
+static int dpiBatch__append(dpiBatch *batch, const char *text,
+        uint32_t textLength, dpiError *error);
+static int dpiBatch__bind(dpiBatch *batch, dpiError *error);
+static int dpiBatch__check(dpiBatch *batch, const char *fnName,
+        dpiError *error);
+static void dpiBatch__clear(dpiBatch *batch, dpiError *error);
+static void dpiBatch__clearErrors(dpiBatch *batch);
+static int dpiBatch__execute(dpiBatch *batch, uint32_t mode,
+        dpiError *error);
+static int dpiBatch__findVar(dpiBatchEntry *entry, uint32_t entryIndex,
+        uint32_t bindIndex, dpiVar **var, dpiError *error);
+static int dpiBatch__generate(dpiBatch *batch, int stopOnError, int commit,
+        dpiError *error);
+static int dpiBatch__getResults(dpiBatch *batch, dpiError *error);
+static int dpiBatch__isName(const char *bindName, uint32_t bindNameLength,
+        const char *name, uint32_t nameLength);
+static int dpiBatch__prepare(dpiBatch *batch, dpiError *error);
+
+
+//-----------------------------------------------------------------------------
+// dpiBatch__allocate() [INTERNAL]
+//   Allocate and initialize a batch.
+//-----------------------------------------------------------------------------
+int dpiBatch__allocate(dpiConn *conn, dpiBatch **batch, dpiError *error)
+{
+    dpiBatch *tempBatch;
+
+    if (dpiGen__allocate(DPI_HTYPE_BATCH, conn->env, (void**) &tempBatch,
+            error) < 0)
+        return DPI_FAILURE;
+    if (dpiGen__setRefCount(conn, error, 1) < 0) {
+        dpiBatch__free(tempBatch, error);
+        return DPI_FAILURE;
+    }
+    tempBatch->conn = conn;
+
+    *batch = tempBatch;
+    return DPI_SUCCESS;
+}
+
+
+//-----------------------------------------------------------------------------
+// dpiBatch__append() [INTERNAL]
+//   Append the text to the block being generated, increasing the size of the
+// buffer if needed.
+//-----------------------------------------------------------------------------
+static int dpiBatch__append(dpiBatch *batch, const char *text,
+        uint32_t textLength, dpiError *error)
+{
+    uint32_t allocatedLength;
+    char *buffer;
+
+    if (batch->bufferLength + textLength > batch->allocatedBufferLength) {
+        allocatedLength = batch->allocatedBufferLength * 2 + textLength + 256;
+        buffer = realloc(batch->buffer, allocatedLength);
+        if (!buffer)
+            return dpiError__set(error, "allocate SQL", DPI_ERR_NO_MEMORY);
+        batch->buffer = buffer;
+        batch->allocatedBufferLength = allocatedLength;
+    }
+    memcpy(batch->buffer + batch->bufferLength, text, textLength);
+    batch->bufferLength += textLength;
+    return DPI_SUCCESS;
+}
+
+
+//-----------------------------------------------------------------------------
+// dpiBatch__bind() [INTERNAL]
+//   Bind the variables bound to each statement, followed by the variables
+// which hold its results, to the block by position in the order in which
+// they appear in the block. Each bind variable appears in the block only once
+// so its position is the same whether positions refer to bind variables or
+// to their names. The variables which hold the results are set to null so
+// that those of statements which are not executed remain null. The block is
+// executed only once so variables bound to the statements must hold a single
+// row; dynamically sized variables are also rejected as binding them to a
+// PL/SQL block would convert them to LOB variables.
+//-----------------------------------------------------------------------------
+static int dpiBatch__bind(dpiBatch *batch, dpiError *error)
+{
+    dpiBatchEntry *entry;
+    dpiVar *var = NULL;
+    uint32_t i, j, pos;
+
+    pos = 0;
+    for (i = 0; i < batch->numEntries; i++) {
+        entry = &batch->entries[i];
+        if (!entry->stmt->handle)
+            return dpiError__set(error, "check closed", DPI_ERR_STMT_CLOSED);
+        for (j = 0; j < entry->numBinds; j++) {
+            if (dpiBatch__findVar(entry, i, j, &var, error) < 0)
+                return DPI_FAILURE;
+            if (var->maxArraySize > 1 || var->isDynamic)
+                return dpiError__set(error, "check variable",
+                        DPI_ERR_BATCH_VAR_NOT_SUPPORTED,
+                        entry->binds[j].length, entry->sql +
+                        entry->binds[j].offset, i);
+            if (dpiStmt__bind(batch->stmt, var, 1, ++pos, NULL, 0, error) < 0)
+                return DPI_FAILURE;
+        }
+        for (j = 0; j < DPI_BATCH_NUM_RESULT_VARS; j++) {
+            var = batch->resultVars[i * DPI_BATCH_NUM_RESULT_VARS + j];
+            var->externalData->isNull = 1;
+            if (dpiStmt__bind(batch->stmt, var, 1, ++pos, NULL, 0, error) < 0)
+                return DPI_FAILURE;
+        }
+    }
+    return DPI_SUCCESS;
+}
+
+
+//-----------------------------------------------------------------------------
+// dpiBatch__check() [INTERNAL]
+//   Determine if the batch is valid and its connection is still open.
+//-----------------------------------------------------------------------------
+static int dpiBatch__check(dpiBatch *batch, const char *fnName,
+        dpiError *error)
+{
+    if (dpiGen__startPublicFn(batch, DPI_HTYPE_BATCH, fnName, error) < 0)
+        return DPI_FAILURE;
+    if (!batch->conn->handle || batch->conn->closing)
+        return dpiError__set(error, "check connection", DPI_ERR_NOT_CONNECTED);
+    return DPI_SUCCESS;
+}
+
+
+//-----------------------------------------------------------------------------
+// dpiBatch__clear() [INTERNAL]
+//   Remove all of the statements from the batch, releasing the references
+// held to them, along with the results of the last execution.
+//-----------------------------------------------------------------------------
+static void dpiBatch__clear(dpiBatch *batch, dpiError *error)
+{
+    dpiBatchEntry *entry;
+    uint32_t i;
+
+    for (i = 0; i < batch->numEntries; i++) {
+        entry = &batch->entries[i];
+        if (entry->stmt) {
+            dpiGen__setRefCount(entry->stmt, error, -1);
+            entry->stmt = NULL;
+        }
+        if (entry->sql) {
+            free(entry->sql);
+            entry->sql = NULL;
+        }
+        if (entry->binds) {
+            free(entry->binds);
+            entry->binds = NULL;
+        }
+    }
+    batch->numEntries = 0;
+    batch->numRowCounts = 0;
+    dpiBatch__clearErrors(batch);
+}
+
+
+//-----------------------------------------------------------------------------
+// dpiBatch__clearErrors() [INTERNAL]
+//   Clear the errors that took place during the last execution.
+//-----------------------------------------------------------------------------
+static void dpiBatch__clearErrors(dpiBatch *batch)
+{
+    if (batch->errors) {
+        free(batch->errors);
+        batch->errors = NULL;
+    }
+    batch->numErrors = 0;
+}
+
+
+//-----------------------------------------------------------------------------
+// dpiBatch__execute() [INTERNAL]
+//   Execute all of the statements in the batch in a single round trip. Unless
+// the mode DPI_MODE_EXEC_BATCH_ERRORS is specified, execution stops at the
+// first statement which fails and its error is raised. The commit requested
+// by the mode DPI_MODE_EXEC_COMMIT_ON_SUCCESS is performed by the block once
+// all of the statements have been executed so that no commit takes place if
+// execution was stopped.
+//-----------------------------------------------------------------------------
+static int dpiBatch__execute(dpiBatch *batch, uint32_t mode,
+        dpiError *error)
+{
+    int stopOnError, commit;
+
+    // clear the results of any previous execution
+    batch->numRowCounts = 0;
+    dpiBatch__clearErrors(batch);
+    if (mode & ~(DPI_MODE_EXEC_BATCH_ERRORS |
+            DPI_MODE_EXEC_COMMIT_ON_SUCCESS))
+        return dpiError__set(error, "check mode", DPI_ERR_NOT_SUPPORTED);
+    if (batch->numEntries == 0)
+        return DPI_SUCCESS;
+
+    // generate and prepare the block, then bind and execute it
+    stopOnError = !(mode & DPI_MODE_EXEC_BATCH_ERRORS);
+    commit = ((mode & DPI_MODE_EXEC_COMMIT_ON_SUCCESS) != 0);
+    if (dpiBatch__generate(batch, stopOnError, commit, error) < 0)
+        return DPI_FAILURE;
+    if (dpiBatch__prepare(batch, error) < 0)
+        return DPI_FAILURE;
+    if (dpiBatch__bind(batch, error) < 0)
+        return DPI_FAILURE;
+    if (dpiStmt__execute(batch->stmt, 1, DPI_MODE_EXEC_DEFAULT, 0, error) < 0)
+        return DPI_FAILURE;
+
+    // determine the results of each statement; the error of the statement
+    // which stopped execution is raised
+    if (dpiBatch__getResults(batch, error) < 0)
+        return DPI_FAILURE;
+    if (stopOnError && batch->numErrors > 0) {
+        *error->buffer = batch->errors[0];
+        return DPI_FAILURE;
+    }
+    return DPI_SUCCESS;
+}
+
+
+//-----------------------------------------------------------------------------
+// dpiBatch__findVar() [INTERNAL]
+//   Find the variable bound to the given bind variable of the statement. For
+// statements bound by position this is the variable bound to the position of
+// the bind variable in the statement; otherwise it is the variable bound to
+// the name of the bind variable.
+//-----------------------------------------------------------------------------
+static int dpiBatch__findVar(dpiBatchEntry *entry, uint32_t entryIndex,
+        uint32_t bindIndex, dpiVar **var, dpiError *error)
+{
+    dpiAutoBindLiteral *bind = &entry->binds[bindIndex];
+    const char *bindName = entry->sql + bind->offset;
+    dpiBindVar *bindVar;
+    uint32_t i;
+
+    for (i = 0; i < entry->stmt->numBindVars; i++) {
+        bindVar = &entry->stmt->bindVars[i];
+        if (bindVar->pos > 0 && bindVar->pos != bindIndex + 1)
+            continue;
+        if (bindVar->pos == 0 && !dpiBatch__isName(bindName + 1,
+                bind->length - 1, bindVar->name, bindVar->nameLength))
+            continue;
+        if (bindVar->var) {
+            *var = bindVar->var;
+            return DPI_SUCCESS;
+        }
+    }
+    return dpiError__set(error, "find variable", DPI_ERR_BATCH_NOT_BOUND,
+            bind->length, bindName, entryIndex);
+}
+
+
+//-----------------------------------------------------------------------------
+// dpiBatch__free() [INTERNAL]
+//   Free the memory associated with the batch.
+//-----------------------------------------------------------------------------
+void dpiBatch__free(dpiBatch *batch, dpiError *error)
+{
+    uint32_t i;
+
+    dpiBatch__clear(batch, error);
+    if (batch->entries) {
+        free(batch->entries);
+        batch->entries = NULL;
+    }
+    if (batch->rowCounts) {
+        free(batch->rowCounts);
+        batch->rowCounts = NULL;
+    }
+    if (batch->stmt) {
+        dpiGen__setRefCount(batch->stmt, error, -1);
+        batch->stmt = NULL;
+    }
+    if (batch->resultVars) {
+        for (i = 0; i < batch->numResultVars; i++)
+            dpiGen__setRefCount(batch->resultVars[i], error, -1);
+        free(batch->resultVars);
+        batch->resultVars = NULL;
+    }
+    if (batch->sql) {
+        free(batch->sql);
+        batch->sql = NULL;
+    }
+    if (batch->buffer) {
+        free(batch->buffer);
+        batch->buffer = NULL;
+    }
+    if (batch->conn) {
+        dpiGen__setRefCount(batch->conn, error, -1);
+        batch->conn = NULL;
+    }
+    free(batch);
+}
+
+
+//-----------------------------------------------------------------------------
+// dpiBatch__generate() [INTERNAL]
+//   Generate the anonymous PL/SQL block which executes each statement in turn
+// and places the number of rows it affected in a bind variable. Errors are
+// caught and their code and message are placed in two more bind variables;
+// unless execution continues after errors, the block then returns. The bind
+// variables of each statement are replaced in the block by bind variables
+// with unique names which are passed to execute immediate in order.
+//-----------------------------------------------------------------------------
+static int dpiBatch__generate(dpiBatch *batch, int stopOnError, int commit,
+        dpiError *error)
+{
+    const char *ptr, *end, *quote;
+    uint32_t i, j, length, pos;
+    dpiBatchEntry *entry;
+    char text[200];
+
+    batch->bufferLength = 0;
+    if (dpiBatch__append(batch, "begin ", 6, error) < 0)
+        return DPI_FAILURE;
+    pos = 0;
+    for (i = 0; i < batch->numEntries; i++) {
+        entry = &batch->entries[i];
+
+        // the statement is placed in a string literal with its quotes doubled
+        if (dpiBatch__append(batch, "begin execute immediate '", 25,
+                error) < 0)
+            return DPI_FAILURE;
+        ptr = entry->sql;
+        end = entry->sql + entry->sqlLength;
+        while (ptr < end) {
+            quote = memchr(ptr, '\'', (size_t) (end - ptr));
+            length = (quote) ? (uint32_t) (quote - ptr) + 1 :
+                    (uint32_t) (end - ptr);
+            if (dpiBatch__append(batch, ptr, length, error) < 0)
+                return DPI_FAILURE;
+            if (quote && dpiBatch__append(batch, "'", 1, error) < 0)
+                return DPI_FAILURE;
+            ptr += length;
+        }
+        if (dpiBatch__append(batch, "'", 1, error) < 0)
+            return DPI_FAILURE;
+
+        // the bind variables of the statement are passed in order
+        for (j = 0; j < entry->numBinds; j++) {
+            length = (uint32_t) snprintf(text, sizeof(text), "%s:DPI_B%u",
+                    (j == 0) ? " using " : ", ", ++pos);
+            if (dpiBatch__append(batch, text, length, error) < 0)
+                return DPI_FAILURE;
+        }
+
+        // the results of the statement are placed in their bind variables
+        pos += DPI_BATCH_NUM_RESULT_VARS;
+        length = (uint32_t) snprintf(text, sizeof(text),
+                "; :DPI_B%u := sql%%rowcount; exception when others then "
+                ":DPI_B%u := sqlcode; :DPI_B%u := sqlerrm;%s end; ",
+                pos - 2, pos - 1, pos, (stopOnError) ? " return;" : "");
+        if (dpiBatch__append(batch, text, length, error) < 0)
+            return DPI_FAILURE;
+
+    }
+    if (commit && dpiBatch__append(batch, "commit; ", 8, error) < 0)
+        return DPI_FAILURE;
+    return dpiBatch__append(batch, "end;", 4, error);
+}
+
+
+//-----------------------------------------------------------------------------
+// dpiBatch__getResults() [INTERNAL]
+//   Determine the number of rows affected by each statement and the errors
+// which took place from the variables which hold the results of each
+// statement. Statements which were not executed affected no rows. Error codes
+// are made positive, as they are for all other errors, and the offset of each
+// error is the (zero-based) index of the statement in the batch.
+//-----------------------------------------------------------------------------
+static int dpiBatch__getResults(dpiBatch *batch, dpiError *error)
+{
+    dpiData *count, *code, *message;
+    dpiErrorBuffer *buffer;
+    uint32_t i, numErrors;
+    dpiVar **resultVars;
+
+    // determine the number of errors and allocate memory for them
+    numErrors = 0;
+    for (i = 0; i < batch->numEntries; i++) {
+        resultVars = &batch->resultVars[i * DPI_BATCH_NUM_RESULT_VARS];
+        code = resultVars[1]->externalData;
+        if (!code->isNull && code->value.asInt64 != 0)
+            numErrors++;
+    }
+    if (numErrors > 0) {
+        batch->errors = calloc(numErrors, sizeof(dpiErrorBuffer));
+        if (!batch->errors)
+            return dpiError__set(error, "allocate errors", DPI_ERR_NO_MEMORY);
+    }
+
+    // populate the row counts and errors
+    for (i = 0; i < batch->numEntries; i++) {
+        resultVars = &batch->resultVars[i * DPI_BATCH_NUM_RESULT_VARS];
+        count = resultVars[0]->externalData;
+        code = resultVars[1]->externalData;
+        message = resultVars[2]->externalData;
+        batch->rowCounts[i] = (count->isNull) ? 0 :
+                (uint64_t) count->value.asInt64;
+        if (code->isNull || code->value.asInt64 == 0)
+            continue;
+        buffer = &batch->errors[batch->numErrors++];
+        buffer->code = (int32_t) ((code->value.asInt64 < 0) ?
+                -code->value.asInt64 : code->value.asInt64);
+        buffer->offset = (uint16_t) i;
+        buffer->fnName = error->buffer->fnName;
+        buffer->action = "execute";
+        strcpy(buffer->encoding, batch->env->encoding);
+        if (!message->isNull) {
+            buffer->messageLength = message->value.asBytes.length;
+            if (buffer->messageLength > sizeof(buffer->message))
+                buffer->messageLength = sizeof(buffer->message);
+            memcpy(buffer->message, message->value.asBytes.ptr,
+                    buffer->messageLength);
+        }
+    }
+    batch->numRowCounts = batch->numEntries;
+    return DPI_SUCCESS;
+}
+
+
+//-----------------------------------------------------------------------------
+// dpiBatch__isName() [INTERNAL]
+//   Return whether the name used to bind a variable matches the name of the
+// bind variable found in the statement. A leading colon in the name used to
+// bind the variable is ignored. Names are compared without regard to case
+// unless the bind variable in the statement is quoted.
+//-----------------------------------------------------------------------------
+static int dpiBatch__isName(const char *bindName, uint32_t bindNameLength,
+        const char *name, uint32_t nameLength)
+{
+    char ch1, ch2;
+    uint32_t i;
+
+    if (nameLength > 0 && name[0] == ':') {
+        name++;
+        nameLength--;
+    }
+    if (bindNameLength >= 2 && bindName[0] == '"') {
+        bindName++;
+        bindNameLength -= 2;
+        if (nameLength >= 2 && name[0] == '"') {
+            name++;
+            nameLength -= 2;
+        }
+        return (nameLength == bindNameLength &&
+                strncmp(name, bindName, nameLength) == 0);
+    }
+    if (nameLength != bindNameLength)
+        return 0;
+    for (i = 0; i < nameLength; i++) {
+        ch1 = name[i];
+        ch2 = bindName[i];
+        if (ch1 >= 'a' && ch1 <= 'z')
+            ch1 -= 'a' - 'A';
+        if (ch2 >= 'a' && ch2 <= 'z')
+            ch2 -= 'a' - 'A';
+        if (ch1 != ch2)
+            return 0;
+    }
+    return 1;
+}
+
+
+//-----------------------------------------------------------------------------
+// dpiBatch__prepare() [INTERNAL]
+//   Create any variables needed to hold the results of the statements and
+// prepare the generated block, unless it is the same as the block prepared
+// for the last execution. The text of the block prepared is retained by
+// exchanging it with the buffer used to generate the block.
+//-----------------------------------------------------------------------------
+static int dpiBatch__prepare(dpiBatch *batch, dpiError *error)
+{
+    uint32_t numResultVars, tempLength;
+    dpiVar **resultVars, *var;
+    dpiData *data;
+    dpiStmt *stmt;
+    char *tempSql;
+    int status;
+
+    // create the variables which hold the results of the statements
+    numResultVars = batch->numEntries * DPI_BATCH_NUM_RESULT_VARS;
+    if (batch->numResultVars < numResultVars) {
+        resultVars = realloc(batch->resultVars,
+                numResultVars * sizeof(dpiVar*));
+        if (!resultVars)
+            return dpiError__set(error, "allocate result variables",
+                    DPI_ERR_NO_MEMORY);
+        batch->resultVars = resultVars;
+        while (batch->numResultVars < numResultVars) {
+            if (batch->numResultVars % DPI_BATCH_NUM_RESULT_VARS == 2)
+                status = dpiVar__allocate(batch->conn, DPI_ORACLE_TYPE_VARCHAR,
+                        DPI_NATIVE_TYPE_BYTES, 1, DPI_BATCH_MAX_MESSAGE_SIZE,
+                        0, 0, NULL, &var, &data, error);
+            else status = dpiVar__allocate(batch->conn,
+                    DPI_ORACLE_TYPE_NATIVE_INT, DPI_NATIVE_TYPE_INT64, 1, 0, 0,
+                    0, NULL, &var, &data, error);
+            if (status < 0)
+                return DPI_FAILURE;
+            batch->resultVars[batch->numResultVars++] = var;
+        }
+    }
+
+    // if the block is unchanged, the statement already prepared is used
+    if (batch->stmt && batch->sqlLength == batch->bufferLength &&
+            memcmp(batch->sql, batch->buffer, batch->bufferLength) == 0)
+        return DPI_SUCCESS;
+
+    // otherwise, the statement is released and the block prepared
+    if (batch->stmt) {
+        dpiGen__setRefCount(batch->stmt, error, -1);
+        batch->stmt = NULL;
+    }
+    if (dpiStmt__allocate(batch->conn, 0, &stmt, error) < 0)
+        return DPI_FAILURE;
+    if (dpiStmt__prepare(stmt, batch->buffer, batch->bufferLength, NULL, 0,
+            error) < 0) {
+        dpiStmt__free(stmt, error);
+        dpiConn__decrementOpenChildCount(batch->conn, error);
+        return DPI_FAILURE;
+    }
+    batch->stmt = stmt;
+    tempSql = batch->sql;
+    tempLength = batch->allocatedSqlLength;
+    batch->sql = batch->buffer;
+    batch->sqlLength = batch->bufferLength;
+    batch->allocatedSqlLength = batch->allocatedBufferLength;
+    batch->buffer = tempSql;
+    batch->bufferLength = 0;
+    batch->allocatedBufferLength = tempLength;
+    return DPI_SUCCESS;
+}
+
+
+//-----------------------------------------------------------------------------
+// dpiBatch_addRef() [PUBLIC]
+//   Add a reference to the batch.
+//-----------------------------------------------------------------------------
+int dpiBatch_addRef(dpiBatch *batch)
+{
+    return dpiGen__addRef(batch, DPI_HTYPE_BATCH, __func__);
+}
+
+
+//-----------------------------------------------------------------------------
+// dpiBatch_addStmt() [PUBLIC]
+//   Add a statement to the batch. Only DML statements without a RETURNING
+// INTO clause can be added. The statement is normalized and the bind
+// variables it contains are found once, when it is added; the variables bound
+// to it are only looked up when the batch is executed. A reference to the
+// statement is retained until the batch is cleared or destroyed.
+//-----------------------------------------------------------------------------
+int dpiBatch_addStmt(dpiBatch *batch, dpiStmt *stmt)
+{
+    uint32_t sqlLength, allocatedEntries, i;
+    dpiBatchEntry *entries, *entry;
+    dpiAutoBind autoBind;
+    uint64_t *rowCounts;
+    const char *sql;
+    dpiError error;
+
+    // validate parameters
+    if (dpiBatch__check(batch, __func__, &error) < 0)
+        return DPI_FAILURE;
+    if (dpiGen__checkHandle(stmt, DPI_HTYPE_STMT, "check statement",
+            &error) < 0)
+        return DPI_FAILURE;
+    if (!stmt->handle)
+        return dpiError__set(&error, "check closed", DPI_ERR_STMT_CLOSED);
+    if (stmt->conn != batch->conn)
+        return dpiError__set(&error, "check connection",
+                DPI_ERR_BATCH_WRONG_CONN);
+    if ((stmt->statementType != DPI_STMT_TYPE_INSERT &&
+            stmt->statementType != DPI_STMT_TYPE_UPDATE &&
+            stmt->statementType != DPI_STMT_TYPE_DELETE &&
+            stmt->statementType != DPI_STMT_TYPE_MERGE) || stmt->isReturning)
+        return dpiError__set(&error, "check statement type",
+                DPI_ERR_BATCH_NOT_DML);
+
+    // normalize the statement and find its bind variables
+    if (dpiOci__attrGet(stmt->handle, DPI_OCI_HTYPE_STMT, (void*) &sql,
+            &sqlLength, DPI_OCI_ATTR_STATEMENT, "get statement", &error) < 0)
+        return DPI_FAILURE;
+    if (dpiAutoBind__parse(&autoBind, sql, sqlLength, 1, &error) < 0)
+        return DPI_FAILURE;
+    if (!autoBind.sql)
+        return dpiError__set(&error, "scan statement", DPI_ERR_BATCH_NOT_DML);
+    sqlLength = autoBind.sqlLength;
+    for (i = 0; i < autoBind.sqlLength; i++) {
+        if (autoBind.sql[i] == '\'')
+            sqlLength++;
+    }
+    if (sqlLength > DPI_BATCH_MAX_STMT_SIZE) {
+        dpiAutoBind__clear(&autoBind);
+        return dpiError__set(&error, "check length",
+                DPI_ERR_BATCH_STMT_TOO_LONG, DPI_BATCH_MAX_STMT_SIZE);
+    }
+
+    // allocate memory for additional statements, if needed
+    if (batch->numEntries == batch->allocatedEntries) {
+        allocatedEntries = batch->allocatedEntries + 8;
+        entries = realloc(batch->entries,
+                allocatedEntries * sizeof(dpiBatchEntry));
+        if (entries)
+            batch->entries = entries;
+        rowCounts = realloc(batch->rowCounts,
+                allocatedEntries * sizeof(uint64_t));
+        if (rowCounts)
+            batch->rowCounts = rowCounts;
+        if (!entries || !rowCounts) {
+            dpiAutoBind__clear(&autoBind);
+            return dpiError__set(&error, "allocate statements",
+                    DPI_ERR_NO_MEMORY);
+        }
+        batch->allocatedEntries = allocatedEntries;
+    }
+
+    // add the statement, taking ownership of the normalized SQL and the list
+    // of bind variables
+    entry = &batch->entries[batch->numEntries++];
+    entry->sql = autoBind.sql;
+    entry->sqlLength = autoBind.sqlLength;
+    entry->binds = autoBind.literals;
+    entry->numBinds = autoBind.numLiterals;
+    autoBind.sql = NULL;
+    autoBind.literals = NULL;
+    dpiAutoBind__clear(&autoBind);
+    dpiGen__setRefCount(stmt, &error, 1);
+    entry->stmt = stmt;
+    return DPI_SUCCESS;
+}
+
+
+//-----------------------------------------------------------------------------
+// dpiBatch_clear() [PUBLIC]
+//   Remove all of the statements from the batch.
+//-----------------------------------------------------------------------------
+int dpiBatch_clear(dpiBatch *batch)
+{
+    dpiError error;
+
+    if (dpiGen__startPublicFn(batch, DPI_HTYPE_BATCH, __func__, &error) < 0)
+        return DPI_FAILURE;
+    dpiBatch__clear(batch, &error);
+    return DPI_SUCCESS;
+}
+
+
+//-----------------------------------------------------------------------------
+// dpiBatch_execute() [PUBLIC]
+//   Execute all of the statements in the batch in a single round trip.
+//-----------------------------------------------------------------------------
+int dpiBatch_execute(dpiBatch *batch, dpiExecMode mode)
+{
+    dpiError error;
+
+    if (dpiBatch__check(batch, __func__, &error) < 0)
+        return DPI_FAILURE;
+    return dpiBatch__execute(batch, mode, &error);
+}
+
+
+//-----------------------------------------------------------------------------
+// dpiBatch_getErrorCount() [PUBLIC]
+//   Return the number of errors that took place during the last execution of
+// the batch.
+//-----------------------------------------------------------------------------
+int dpiBatch_getErrorCount(dpiBatch *batch, uint32_t *count)
+{
+    dpiError error;
+
+    if (dpiGen__startPublicFn(batch, DPI_HTYPE_BATCH, __func__, &error) < 0)
+        return DPI_FAILURE;
+    DPI_CHECK_PTR_NOT_NULL(count)
+    *count = batch->numErrors;
+    return DPI_SUCCESS;
+}
+
+
+//-----------------------------------------------------------------------------
+// dpiBatch_getErrors() [PUBLIC]
+//   Return the errors that took place during the last execution of the
+// batch.
+//-----------------------------------------------------------------------------
+int dpiBatch_getErrors(dpiBatch *batch, uint32_t numErrors,
+        dpiErrorInfo *errors)
+{
+    dpiError error, tempError;
+    uint32_t i;
+
+    if (dpiGen__startPublicFn(batch, DPI_HTYPE_BATCH, __func__, &error) < 0)
+        return DPI_FAILURE;
+    DPI_CHECK_PTR_NOT_NULL(errors)
+    if (numErrors < batch->numErrors)
+        return dpiError__set(&error, "check num errors",
+                DPI_ERR_ARRAY_SIZE_TOO_SMALL, numErrors);
+    for (i = 0; i < batch->numErrors; i++) {
+        tempError.buffer = &batch->errors[i];
+        dpiError__getInfo(&tempError, &errors[i]);
+    }
+    return DPI_SUCCESS;
+}
+
+
+//-----------------------------------------------------------------------------
+// dpiBatch_getRowCounts() [PUBLIC]
+//   Return the number of rows affected by each of the statements during the
+// last execution of the batch.
+//-----------------------------------------------------------------------------
+int dpiBatch_getRowCounts(dpiBatch *batch, uint32_t *numRowCounts,
+        uint64_t **rowCounts)
+{
+    dpiError error;
+
+    if (dpiGen__startPublicFn(batch, DPI_HTYPE_BATCH, __func__, &error) < 0)
+        return DPI_FAILURE;
+    DPI_CHECK_PTR_NOT_NULL(numRowCounts)
+    DPI_CHECK_PTR_NOT_NULL(rowCounts)
+    *numRowCounts = batch->numRowCounts;
+    *rowCounts = batch->rowCounts;
+    return DPI_SUCCESS;
+}
+
+
+//-----------------------------------------------------------------------------
+// dpiBatch_release() [PUBLIC]
+//   Release a reference to the batch.
+//-----------------------------------------------------------------------------
+int dpiBatch_release(dpiBatch *batch)
+{
+    return dpiGen__release(batch, DPI_HTYPE_BATCH, __func__);
+}
@@ -14,20 +14,72 @@
 //   Implementation of connection.
 //-----------------------------------------------------------------------------
 
+#ifdef _WIN32
+#include <windows.h>
+#endif
 #include "dpiImpl.h"
 #include <time.h>
 
 // forward declarations of internal functions only used in this file
+static int dpiConn__cacheObjectType(dpiConn *conn, dpiObjectType *objType,
+        const char *name, uint32_t nameLength, dpiError *error);
+static int dpiConn__clearObjectTypeCache(dpiConn *conn, dpiError *error);
+static int dpiConn__getCachedObjectType(dpiConn *conn, const char *name,
+        uint32_t nameLength, dpiObjectType **objType, dpiError *error);
 static int dpiConn__getServerCharset(dpiConn *conn, dpiError *error);
 static int dpiConn__getSession(dpiConn *conn, uint32_t mode,
         const char *connectString, uint32_t connectStringLength,
         dpiConnCreateParams *params, void *authInfo, dpiError *error);
+static int dpiConn__reuseObjectType(dpiConn *conn, dpiObjectType *objType);
 static int dpiConn__setAttributesFromCreateParams(void *handle,
         uint32_t handleType, const char *userName, uint32_t userNameLength,
         const char *password, uint32_t passwordLength,
         const dpiConnCreateParams *params, dpiError *error);
 
 
+//-----------------------------------------------------------------------------
+// dpiConn__cacheObjectType() [INTERNAL]
+//   Add the object type to the cache of object types maintained by the
+// connection, using the name that was supplied to dpiConn_getObjectType() as
+// the key. The element types of collections are added as well (without a key)
+// so that they are retained along with the collection type. When the last
+// reference to a cached object type is released it is retired instead of
+// being freed (see dpiObjectType__free()) so that looking it up again does
+// not require it to be described again; retired object types are freed when
+// the connection is closed. The cache is only held in memory: each object
+// type refers to a type descriptor object pinned in the OCI object cache,
+// which can only be obtained from the server, so object types cannot be saved
+// to and restored from a file.
+//-----------------------------------------------------------------------------
+static int dpiConn__cacheObjectType(dpiConn *conn, dpiObjectType *objType,
+        const char *name, uint32_t nameLength, dpiError *error)
+{
+    dpiObjectType *current;
+    char *tempName;
+
+    tempName = malloc(nameLength);
+    if (!tempName)
+        return dpiError__set(error, "allocate lookup name", DPI_ERR_NO_MEMORY);
+    memcpy(tempName, name, nameLength);
+    objType->lookupName = tempName;
+    objType->lookupNameLength = nameLength;
+    if (conn->env->threaded &&
+            dpiOci__threadMutexAcquire(conn->env, error) < 0)
+        return DPI_FAILURE;
+    for (current = objType; current && !current->isCached;
+            current = current->elementTypeInfo.objectType) {
+        current->isCached = 1;
+        current->nextCached = conn->objectTypeCache;
+        conn->objectTypeCache = current;
+    }
+    if (conn->env->threaded &&
+            dpiOci__threadMutexRelease(conn->env, error) < 0)
+        return DPI_FAILURE;
+
+    return DPI_SUCCESS;
+}
+
+
 //-----------------------------------------------------------------------------
 // dpiConn__checkConnected() [INTERNAL]
 //   Validate the connection handle and determine the error structure to use.
@@ -44,6 +96,43 @@ static int dpiConn__checkConnected(dpiConn *conn, const char *fnName,
 }
 
 
+//-----------------------------------------------------------------------------
+// dpiConn__clearObjectTypeCache() [INTERNAL]
+//   Remove all object types from the cache of object types maintained by the
+// connection. Object types which have been retired are freed; the remaining
+// object types are still referenced and remain valid, but are freed normally
+// when their last reference is released.
+//-----------------------------------------------------------------------------
+static int dpiConn__clearObjectTypeCache(dpiConn *conn, dpiError *error)
+{
+    dpiObjectType *objType, *retired = NULL;
+
+    if (conn->env->threaded &&
+            dpiOci__threadMutexAcquire(conn->env, error) < 0)
+        return DPI_FAILURE;
+    while (conn->objectTypeCache) {
+        objType = conn->objectTypeCache;
+        conn->objectTypeCache = objType->nextCached;
+        objType->isCached = 0;
+        objType->nextCached = NULL;
+        if (objType->cacheState == DPI_OBJECT_TYPE_STATE_RETIRED) {
+            objType->nextCached = retired;
+            retired = objType;
+        }
+    }
+    if (conn->env->threaded &&
+            dpiOci__threadMutexRelease(conn->env, error) < 0)
+        return DPI_FAILURE;
+    while (retired) {
+        objType = retired;
+        retired = objType->nextCached;
+        dpiObjectType__free(objType, error);
+    }
+
+    return DPI_SUCCESS;
+}
+
+
 //-----------------------------------------------------------------------------
 // dpiConn__close() [INTERNAL]
 //   Internal method used for closing the connection. Any transaction is rolled
@@ -58,8 +147,16 @@ static int dpiConn__close(dpiConn *conn, int mode, const char *tag,
     uint32_t serverStatus;
     time_t *lastTimeUsed;
 
-    // rollback any outstanding transaction
-    if (dpiOci__transRollback(conn, propagateErrors, error) < 0)
+    // object types retired to the cache cannot be used once the session has
+    // been released, so free them now
+    if (dpiConn__clearObjectTypeCache(conn, error) < 0)
+        return DPI_FAILURE;
+
+    // rollback any outstanding transaction; this is skipped for sessions known
+    // to be unusable, as the attempt can only fail (and may take a long time
+    // to do so); the transaction is rolled back by the database in any case
+    if (!conn->dropSession &&
+            dpiOci__transRollback(conn, propagateErrors, error) < 0)
         return DPI_FAILURE;
 
     // handle standalone connections
@@ -127,6 +224,14 @@ static int dpiConn__close(dpiConn *conn, int mode, const char *tag,
             return DPI_FAILURE;
         conn->sessionHandle = NULL;
 
+        // release the slot held in the admission class, if applicable
+        dpiPool__releaseClass(conn->pool, conn->poolClass, error);
+        conn->poolClass = NULL;
+
+        // resize the pool, if it is being sized elastically
+        if (conn->pool && conn->pool->sizer.isEnabled)
+            dpiPool__evaluateSize(conn->pool, error);
+
     }
 
     conn->handle = NULL;
@@ -353,6 +458,50 @@ int dpiConn__getAttributeText(dpiConn *conn, uint32_t attribute,
 }
 
 
+//-----------------------------------------------------------------------------
+// dpiConn__getCachedObjectType() [INTERNAL]
+//   Look up the object type in the cache of object types maintained by the
+// connection using the name that was supplied to dpiConn_getObjectType(). If
+// found, a reference is added to the object type before it is returned;
+// otherwise, NULL is returned. Retired object types are reused (see
+// dpiConn__reuseObjectType()); object types whose last reference has been
+// released but which have not yet been retired are skipped.
+//-----------------------------------------------------------------------------
+static int dpiConn__getCachedObjectType(dpiConn *conn, const char *name,
+        uint32_t nameLength, dpiObjectType **objType, dpiError *error)
+{
+    dpiObjectType *current;
+
+    *objType = NULL;
+    if (conn->env->threaded &&
+            dpiOci__threadMutexAcquire(conn->env, error) < 0)
+        return DPI_FAILURE;
+    for (current = conn->objectTypeCache; current;
+            current = current->nextCached) {
+        if (!current->lookupName || current->lookupNameLength != nameLength ||
+                memcmp(current->lookupName, name, nameLength) != 0)
+            continue;
+        if (current->refCount > 0) {
+            current->refCount++;
+            *objType = current;
+            break;
+        }
+        if (dpiConn__reuseObjectType(conn, current)) {
+            *objType = current;
+            break;
+        }
+    }
+    if (conn->env->threaded &&
+            dpiOci__threadMutexRelease(conn->env, error) < 0)
+        return DPI_FAILURE;
+    if (*objType && (dpiDebugLevel & DPI_DEBUG_LEVEL_REFS))
+        fprintf(stderr, "ODPI: ref %p (%s) -> %d\n", *objType,
+                (*objType)->typeDef->name, (*objType)->refCount);
+
+    return DPI_SUCCESS;
+}
+
+
 //-----------------------------------------------------------------------------
 // dpiConn__getHandles() [INTERNAL]
 //   Get the server and session handle from the service context handle.
@@ -448,7 +597,7 @@ static int dpiConn__getSession(dpiConn *conn, uint32_t mode,
     while (1) {
 
         // acquire the new session
-        if (dpiOci__sessionGet(conn->env, &conn->handle, authInfo,
+        if (dpiOci__sessionGet(conn, authInfo,
                 connectString, connectStringLength, params->tag,
                 params->tagLength, &params->outTag, &params->outTagLength,
                 &params->outTagFound, mode, error) < 0)
@@ -528,6 +677,24 @@ static int dpiConn__getSession(dpiConn *conn, uint32_t mode,
 }
 
 
+//-----------------------------------------------------------------------------
+// dpiConn__getTransactionInProgress() [INTERNAL]
+//   Determine if a transaction is in progress on the session. The state is
+// maintained by the client so no round trip is required. Clients earlier than
+// 12.1 cannot report it so a transaction is assumed to be in progress.
+//-----------------------------------------------------------------------------
+int dpiConn__getTransactionInProgress(dpiConn *conn, int *inProgress,
+        dpiError *error)
+{
+    *inProgress = 1;
+    if (conn->env->versionInfo->versionNum < 12 || !conn->sessionHandle)
+        return DPI_SUCCESS;
+    return dpiOci__attrGet(conn->sessionHandle, DPI_OCI_HTYPE_SESSION,
+            (void*) inProgress, NULL, DPI_OCI_ATTR_TRANSACTION_IN_PROGRESS,
+            "get transaction in progress", error);
+}
+
+
 //-----------------------------------------------------------------------------
 // dpiConn__incrementOpenChildCount() [INTERNAL]
 //   Increment the open child count as a child is being opened.
@@ -557,6 +724,94 @@ int dpiConn__incrementOpenChildCount(dpiConn *conn, dpiError *error)
 }
 
 
+//-----------------------------------------------------------------------------
+// dpiConn__replaceSession() [INTERNAL]
+//   Replace the session of a connection acquired from a homogeneous pool with
+// a new session from the same pool. The original session is dropped from the
+// pool as this is only done when it is known to be unusable; errors raised
+// while doing so are ignored for the same reason. The new session is
+// acquired without a tag and takes over the slot held in the admission class
+// by the original session. Object types cached by the connection are
+// discarded so that they are looked up again using the new session.
+//-----------------------------------------------------------------------------
+int dpiConn__replaceSession(dpiConn *conn, dpiError *error)
+{
+    dpiErrorBuffer localErrorBuffer;
+    dpiConnCreateParams params;
+    dpiPoolClass *poolClass;
+    dpiError localError;
+    dpiPool *pool;
+    int status;
+
+    // only sessions from homogeneous pools can be replaced transparently
+    pool = conn->pool;
+    if (!pool || conn->standalone || !pool->homogeneous)
+        return dpiError__set(error, "check pool", DPI_ERR_NOT_SUPPORTED);
+
+    // drop the original session, retaining the slot in the admission class
+    localError = *error;
+    localError.buffer = &localErrorBuffer;
+    poolClass = conn->poolClass;
+    conn->poolClass = NULL;
+    conn->dropSession = 1;
+    if (conn->handle)
+        dpiConn__close(conn, DPI_MODE_CONN_CLOSE_DEFAULT, NULL, 0, 0,
+                &localError);
+    conn->dropSession = 0;
+    dpiConn__clearObjectTypeCache(conn, &localError);
+
+    // acquire a new session; the connection already holds a reference to
+    // the pool so the one added when acquiring the session is released
+    memset(&params, 0, sizeof(params));
+    status = dpiConn__get(conn, NULL, 0, NULL, 0, pool->name,
+            pool->nameLength, &params, pool, error);
+    dpiGen__setRefCount(pool, &localError, -1);
+    if (status < 0) {
+        dpiPool__releaseClass(pool, poolClass, &localError);
+        return DPI_FAILURE;
+    }
+    conn->poolClass = poolClass;
+
+    return DPI_SUCCESS;
+}
+
+
+//-----------------------------------------------------------------------------
+// dpiConn__reuseObjectType() [INTERNAL]
+//   Reuse a retired object type found in the cache of object types maintained
+// by the connection. A reference is added to the object type and, on its
+// behalf, to the connection; its element type is reused in the same way if it
+// was retired along with it, or a reference is simply added to it otherwise.
+// Returns 1 if the object type was reused and 0 if it cannot be reused yet
+// since it (or its element type) is still being retired. This must be called
+// while holding the environment mutex, if the environment is threaded.
+//-----------------------------------------------------------------------------
+static int dpiConn__reuseObjectType(dpiConn *conn, dpiObjectType *objType)
+{
+    dpiObjectType *current, *next;
+
+    // verify that the object type and each unreferenced element type have
+    // been retired completely
+    for (current = objType; current && current->refCount == 0;
+            current = current->elementTypeInfo.objectType) {
+        if (current->cacheState != DPI_OBJECT_TYPE_STATE_RETIRED)
+            return 0;
+    }
+
+    // add the references; the types that were retired become active again
+    for (current = objType; current; current = next) {
+        next = current->elementTypeInfo.objectType;
+        if (current->refCount++ > 0)
+            break;
+        current->checkInt = current->typeDef->checkInt;
+        current->cacheState = DPI_OBJECT_TYPE_STATE_ACTIVE;
+        conn->refCount++;
+    }
+
+    return 1;
+}
+
+
 //-----------------------------------------------------------------------------
 // dpiConn__setAppContext() [INTERNAL]
 //   Populate the session handle with the application context.
@@ -671,6 +926,12 @@ int dpiConn__setAttributeText(dpiConn *conn, uint32_t attribute,
         return DPI_FAILURE;
     DPI_CHECK_PTR_AND_LENGTH(value)
 
+    // object types cached by the name supplied by the caller may resolve to
+    // different types once the current schema is changed
+    if (attribute == DPI_OCI_ATTR_CURRENT_SCHEMA &&
+            dpiConn__clearObjectTypeCache(conn, &error) < 0)
+        return DPI_FAILURE;
+
     // determine pointer to pass (OCI uses different sizes)
     switch (attribute) {
         case DPI_OCI_ATTR_ACTION:
@@ -1188,6 +1449,13 @@ int dpiConn_getObjectType(dpiConn *conn, const char *name, uint32_t nameLength,
     DPI_CHECK_PTR_NOT_NULL(name)
     DPI_CHECK_PTR_NOT_NULL(objType)
 
+    // use the object type from the cache, if it has been looked up before
+    if (dpiConn__getCachedObjectType(conn, name, nameLength, objType,
+            &error) < 0)
+        return DPI_FAILURE;
+    if (*objType)
+        return DPI_SUCCESS;
+
     // allocate describe handle
     if (dpiOci__handleAlloc(conn->env, &describeHandle, DPI_OCI_HTYPE_DESCRIBE,
             "allocate describe handle", &error) < 0)
@@ -1236,7 +1504,58 @@ int dpiConn_getObjectType(dpiConn *conn, const char *name, uint32_t nameLength,
     status = dpiObjectType__allocate(conn, param, DPI_OCI_ATTR_NAME, objType,
             &error);
     dpiOci__handleFree(describeHandle, DPI_OCI_HTYPE_DESCRIBE);
-    return status;
+    if (status < 0)
+        return DPI_FAILURE;
+
+    // add the object type to the cache
+    if (dpiConn__cacheObjectType(conn, *objType, name, nameLength,
+            &error) < 0) {
+        dpiObjectType_release(*objType);
+        *objType = NULL;
+        return DPI_FAILURE;
+    }
+
+    return DPI_SUCCESS;
+}
+
+
+//-----------------------------------------------------------------------------
+// dpiConn_getRetryInfo() [PUBLIC]
+//   Return statistics about the executions retried on the connection. As with
+// round trips, the connection need not be open.
+//-----------------------------------------------------------------------------
+int dpiConn_getRetryInfo(dpiConn *conn, dpiRetryInfo *info)
+{
+    dpiError error;
+
+    if (dpiGen__startPublicFn(conn, DPI_HTYPE_CONN, __func__, &error) < 0)
+        return DPI_FAILURE;
+    DPI_CHECK_PTR_NOT_NULL(info)
+    *info = conn->retryInfo;
+    return DPI_SUCCESS;
+}
+
+
+//-----------------------------------------------------------------------------
+// dpiConn_getRoundTrips() [PUBLIC]
+//   Return the number of round trips made to the database by the connection.
+// The connection need not be open so that round trips made while closing it
+// can be examined as well.
+//-----------------------------------------------------------------------------
+int dpiConn_getRoundTrips(dpiConn *conn, uint64_t *roundTrips)
+{
+    dpiError error;
+
+    if (dpiGen__startPublicFn(conn, DPI_HTYPE_CONN, __func__, &error) < 0)
+        return DPI_FAILURE;
+    DPI_CHECK_PTR_NOT_NULL(roundTrips)
+#ifdef _WIN32
+    *roundTrips = (uint64_t) InterlockedCompareExchange64(
+            (volatile LONG64*) &conn->roundTrips, 0, 0);
+#else
+    *roundTrips = __atomic_load_n(&conn->roundTrips, __ATOMIC_RELAXED);
+#endif
+    return DPI_SUCCESS;
 }
 
 
@@ -1282,6 +1601,24 @@ int dpiConn_getStmtCacheSize(dpiConn *conn, uint32_t *cacheSize)
 }
 
 
+//-----------------------------------------------------------------------------
+// dpiConn_newBatch() [PUBLIC]
+//   Create a new batch of statements and return it. Batches are not supported
+// when the client encoding is UTF-16.
+//-----------------------------------------------------------------------------
+int dpiConn_newBatch(dpiConn *conn, dpiBatch **batch)
+{
+    dpiError error;
+
+    if (dpiConn__checkConnected(conn, __func__, &error) < 0)
+        return DPI_FAILURE;
+    DPI_CHECK_PTR_NOT_NULL(batch)
+    if (conn->env->charsetId == DPI_CHARSET_ID_UTF16)
+        return dpiError__set(&error, "check encoding", DPI_ERR_NOT_SUPPORTED);
+    return dpiBatch__allocate(conn, batch, &error);
+}
+
+
 //-----------------------------------------------------------------------------
 // dpiConn_newDeqOptions() [PUBLIC]
 //   Create a new dequeue options object and return it.
@@ -1488,6 +1825,7 @@ int dpiConn_prepareStmt(dpiConn *conn, int scrollable, const char *sql,
 {
     dpiStmt *tempStmt;
     dpiError error;
+    int status;
 
     *stmt = NULL;
     if (dpiConn__checkConnected(conn, __func__, &error) < 0)
@@ -1497,8 +1835,12 @@ int dpiConn_prepareStmt(dpiConn *conn, int scrollable, const char *sql,
     DPI_CHECK_PTR_NOT_NULL(stmt)
     if (dpiStmt__allocate(conn, scrollable, &tempStmt, &error) < 0)
         return DPI_FAILURE;
-    if (dpiStmt__prepare(tempStmt, sql, sqlLength, tag, tagLength,
-            &error) < 0) {
+    if (conn->env->prepareMode & DPI_MODE_PREPARE_AUTO_BIND)
+        status = dpiStmt__prepareAutoBind(tempStmt, sql, sqlLength, tag,
+                tagLength, &error);
+    else status = dpiStmt__prepare(tempStmt, sql, sqlLength, tag, tagLength,
+            &error);
+    if (status < 0) {
         dpiStmt__free(tempStmt, &error);
         dpiConn__decrementOpenChildCount(conn, &error);
         return DPI_FAILURE;
@@ -1668,3 +2010,22 @@ int dpiConn_startupDatabase(dpiConn *conn, dpiStartupMode mode)
     return dpiOci__dbStartup(conn, mode, &error);
 }
 
+
+//-----------------------------------------------------------------------------
+// dpiConn_trimMemory() [PUBLIC]
+//   Release memory cached by the environment used by the connection that is
+// no longer needed, retaining no more than the low-water mark, and return the
+// number of bytes released.
+//-----------------------------------------------------------------------------
+int dpiConn_trimMemory(dpiConn *conn, uint64_t lowWaterMark,
+        uint64_t *bytesReclaimed)
+{
+    dpiError error;
+
+    if (dpiConn__checkConnected(conn, __func__, &error) < 0)
+        return DPI_FAILURE;
+    DPI_CHECK_PTR_NOT_NULL(bytesReclaimed)
+    *bytesReclaimed = 0;
+    return dpiEnv__trimMemory(conn->env, lowWaterMark, bytesReclaimed,
+            &error);
+}
@@ -50,6 +50,35 @@ int dpiContext__initConnCreateParams(const dpiContext *context,
 }
 
 
+//-----------------------------------------------------------------------------
+// dpiContext__initInterposeParams() [INTERNAL]
+//   Initialize the interposer parameters to default values. The version
+// supported by the library is filled in; no calls are interposed.
+//-----------------------------------------------------------------------------
+int dpiContext__initInterposeParams(const dpiContext *context,
+        dpiInterposeParams *params, dpiError *error)
+{
+    memset(params, 0, sizeof(dpiInterposeParams));
+    params->version = DPI_INTERPOSE_VERSION;
+    return DPI_SUCCESS;
+}
+
+
+//-----------------------------------------------------------------------------
+// dpiContext__initPoolClassParams() [INTERNAL]
+//   Initialize the pool admission class parameters to default values.
+//-----------------------------------------------------------------------------
+int dpiContext__initPoolClassParams(const dpiContext *context,
+        dpiPoolClassParams *params, dpiError *error)
+{
+    memset(params, 0, sizeof(dpiPoolClassParams));
+    params->minSessions = 1;
+    params->maxSessions = 1;
+    params->backoffPercent = DPI_DEFAULT_POOL_CLASS_BACKOFF;
+    return DPI_SUCCESS;
+}
+
+
 //-----------------------------------------------------------------------------
 // dpiContext__initPoolCreateParams() [INTERNAL]
 //   Initialize the pool creation parameters to default values.
@@ -69,6 +98,40 @@ int dpiContext__initPoolCreateParams(const dpiContext *context,
 }
 
 
+//-----------------------------------------------------------------------------
+// dpiContext__initPoolSizingParams() [INTERNAL]
+//   Initialize the pool sizing parameters to default values.
+//-----------------------------------------------------------------------------
+int dpiContext__initPoolSizingParams(const dpiContext *context,
+        dpiPoolSizingParams *params, dpiError *error)
+{
+    memset(params, 0, sizeof(dpiPoolSizingParams));
+    params->minSessions = 1;
+    params->maxSessions = 1;
+    params->sessionIncrement = 1;
+    params->spareSessions = 1;
+    params->sampleInterval = DPI_DEFAULT_POOL_SAMPLE_INTERVAL;
+    params->waitThreshold = DPI_DEFAULT_POOL_WAIT_THRESHOLD;
+    return DPI_SUCCESS;
+}
+
+
+//-----------------------------------------------------------------------------
+// dpiContext__initRetryParams() [INTERNAL]
+//   Initialize the retry parameters to default values.
+//-----------------------------------------------------------------------------
+int dpiContext__initRetryParams(const dpiContext *context,
+        dpiRetryParams *params, dpiError *error)
+{
+    memset(params, 0, sizeof(dpiRetryParams));
+    params->maxAttempts = DPI_DEFAULT_RETRY_MAX_ATTEMPTS;
+    params->initialDelay = DPI_DEFAULT_RETRY_INITIAL_DELAY;
+    params->maxDelay = DPI_DEFAULT_RETRY_MAX_DELAY;
+    params->deadline = DPI_DEFAULT_RETRY_DEADLINE;
+    return DPI_SUCCESS;
+}
+
+
 //-----------------------------------------------------------------------------
 // dpiContext__initSubscrCreateParams() [INTERNAL]
 //   Initialize the subscription creation parameters to default values.
@@ -230,6 +293,38 @@ int dpiContext_initConnCreateParams(const dpiContext *context,
 }
 
 
+//-----------------------------------------------------------------------------
+// dpiContext_initInterposeParams() [PUBLIC]
+//   Initialize the interposer parameters to default values.
+//-----------------------------------------------------------------------------
+int dpiContext_initInterposeParams(const dpiContext *context,
+        dpiInterposeParams *params)
+{
+    dpiError error;
+
+    if (dpiContext__startPublicFn(context, __func__, &error) < 0)
+        return DPI_FAILURE;
+    DPI_CHECK_PTR_NOT_NULL(params)
+    return dpiContext__initInterposeParams(context, params, &error);
+}
+
+
+//-----------------------------------------------------------------------------
+// dpiContext_initPoolClassParams() [PUBLIC]
+//   Initialize the pool admission class parameters to default values.
+//-----------------------------------------------------------------------------
+int dpiContext_initPoolClassParams(const dpiContext *context,
+        dpiPoolClassParams *params)
+{
+    dpiError error;
+
+    if (dpiContext__startPublicFn(context, __func__, &error) < 0)
+        return DPI_FAILURE;
+    DPI_CHECK_PTR_NOT_NULL(params)
+    return dpiContext__initPoolClassParams(context, params, &error);
+}
+
+
 //-----------------------------------------------------------------------------
 // dpiContext_initPoolCreateParams() [PUBLIC]
 //   Initialize the pool creation parameters to default values.
@@ -246,6 +341,38 @@ int dpiContext_initPoolCreateParams(const dpiContext *context,
 }
 
 
+//-----------------------------------------------------------------------------
+// dpiContext_initPoolSizingParams() [PUBLIC]
+//   Initialize the pool sizing parameters to default values.
+//-----------------------------------------------------------------------------
+int dpiContext_initPoolSizingParams(const dpiContext *context,
+        dpiPoolSizingParams *params)
+{
+    dpiError error;
+
+    if (dpiContext__startPublicFn(context, __func__, &error) < 0)
+        return DPI_FAILURE;
+    DPI_CHECK_PTR_NOT_NULL(params)
+    return dpiContext__initPoolSizingParams(context, params, &error);
+}
+
+
+//-----------------------------------------------------------------------------
+// dpiContext_initRetryParams() [PUBLIC]
+//   Initialize the retry parameters to default values.
+//-----------------------------------------------------------------------------
+int dpiContext_initRetryParams(const dpiContext *context,
+        dpiRetryParams *params)
+{
+    dpiError error;
+
+    if (dpiContext__startPublicFn(context, __func__, &error) < 0)
+        return DPI_FAILURE;
+    DPI_CHECK_PTR_NOT_NULL(params)
+    return dpiContext__initRetryParams(context, params, &error);
+}
+
+
 //-----------------------------------------------------------------------------
 // dpiContext_initSubscrCreateParams() [PUBLIC]
 //   Initialize the subscription creation parameters to default values.
@@ -261,3 +388,23 @@ int dpiContext_initSubscrCreateParams(const dpiContext *context,
     return dpiContext__initSubscrCreateParams(context, params, &error);
 }
 
+
+//-----------------------------------------------------------------------------
+// dpiContext_setInterposer() [PUBLIC]
+//   Install the interposer on OCI calls that require round trips, replacing
+// any interposer that was already installed. The interposer is shared by all
+// contexts. If the parameters are NULL, the interposer is removed.
+//-----------------------------------------------------------------------------
+int dpiContext_setInterposer(const dpiContext *context,
+        const dpiInterposeParams *params)
+{
+    dpiError error;
+
+    if (dpiContext__startPublicFn(context, __func__, &error) < 0)
+        return DPI_FAILURE;
+    if (params && params->version != DPI_INTERPOSE_VERSION)
+        return dpiError__set(&error, "check version",
+                DPI_ERR_INTERPOSE_VERSION, params->version,
+                DPI_INTERPOSE_VERSION);
+    return dpiGlobal__setInterposer(params, &error);
+}
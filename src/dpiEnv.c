@@ -209,6 +209,8 @@ int dpiEnv__init(dpiEnv *env, const dpiContext *context,
     // create the new environment handle
     env->context = context;
     env->versionInfo = context->versionInfo;
+    env->bufferMode = params->bufferMode;
+    env->prepareMode = params->prepareMode;
     if (dpiOci__envNlsCreate(env, params->createMode | DPI_OCI_OBJECT,
             error) < 0)
         return DPI_FAILURE;
@@ -369,3 +371,60 @@ static int dpiEnv__initErrorForThread(dpiEnv *env,
     return DPI_SUCCESS;
 }
 
+
+//-----------------------------------------------------------------------------
+// dpiEnv__trimMemory() [INTERNAL]
+//   Shrink the array of thread error structures so that it no longer holds
+// the empty slots at its end that were left behind by threads that have since
+// terminated. The array is left alone if it does not exceed the low-water
+// mark. The number of bytes released is added to the supplied total.
+//-----------------------------------------------------------------------------
+int dpiEnv__trimMemory(dpiEnv *env, uint64_t lowWaterMark,
+        uint64_t *bytesReclaimed, dpiError *error)
+{
+    dpiErrorForThread **tempArray = NULL;
+    uint32_t i, numUsed, numRequired;
+
+    // the array is only used for threaded environments
+    if (!env->threadKey)
+        return DPI_SUCCESS;
+
+    // acquire the mutex to ensure the array is handled properly
+    if (dpiOci__threadMutexAcquire(env, error) < 0)
+        return DPI_FAILURE;
+
+    // determine the number of slots that must be retained; slots are always
+    // allocated in groups of 8
+    for (i = 0, numUsed = 0; i < env->numErrorsForThread; i++) {
+        if (env->errorsForThread[i])
+            numUsed = i + 1;
+    }
+    numRequired = (numUsed + 7) & ~7u;
+
+    // allocate a smaller array and transfer the slots still in use to it
+    if (numRequired < env->numErrorsForThread &&
+            env->numErrorsForThread * sizeof(dpiErrorForThread*) >
+                    lowWaterMark) {
+        if (numRequired > 0) {
+            tempArray = calloc(numRequired, sizeof(dpiErrorForThread*));
+            if (!tempArray) {
+                dpiOci__threadMutexRelease(env, error);
+                return dpiError__set(error, "allocate thread errors",
+                        DPI_ERR_NO_MEMORY);
+            }
+            for (i = 0; i < numUsed; i++)
+                tempArray[i] = env->errorsForThread[i];
+        }
+        free(env->errorsForThread);
+        *bytesReclaimed += (env->numErrorsForThread - numRequired) *
+                sizeof(dpiErrorForThread*);
+        env->errorsForThread = tempArray;
+        env->numErrorsForThread = numRequired;
+    }
+
+    // release mutex
+    if (dpiOci__threadMutexRelease(env, error) < 0)
+        return DPI_FAILURE;
+
+    return DPI_SUCCESS;
+}
@@ -39,24 +39,42 @@ int dpiError__check(dpiError *error, int status, dpiConn *conn,
     else if (!error->handle)
         return dpiError__set(error, action, DPI_ERR_ERR_NOT_INITIALIZED);
 
-    // fetch OCI error
+    // an error injected by an interposer was never raised by OCI; the error
+    // number has already been placed in the error buffer so only the message
+    // needs to be generated
     error->buffer->action = action;
-    strcpy(error->buffer->encoding, error->encoding);
-    if (dpiOci__errorGet(error->handle, DPI_OCI_HTYPE_ERROR, action,
-            error) < 0)
-        return DPI_FAILURE;
-    if (dpiDebugLevel & DPI_DEBUG_LEVEL_ERRORS)
-        fprintf(stderr, "ODPI: OCI error %.*s (%s / %s)\n",
-                error->buffer->messageLength, error->buffer->message,
-                error->buffer->fnName, action);
+    if (status == DPI_OCI_ERROR_INJECTED) {
+        strcpy(error->buffer->encoding, DPI_CHARSET_NAME_UTF8);
+        error->buffer->offset = 0;
+        error->buffer->isRecoverable = 0;
+        error->buffer->messageLength = (uint32_t) sprintf(
+                error->buffer->message,
+                "ORA-%.5d: error injected by interposer",
+                error->buffer->code);
+        if (dpiDebugLevel & DPI_DEBUG_LEVEL_ERRORS)
+            fprintf(stderr, "ODPI: injected error %.*s (%s / %s)\n",
+                    error->buffer->messageLength, error->buffer->message,
+                    error->buffer->fnName, action);
 
-    // determine if error is recoverable (Transaction Guard)
-    // if the attribute cannot be read properly, simply leave it as false;
-    // otherwise, that error will mask the one that we really want to see
-    error->buffer->isRecoverable = 0;
-    dpiOci__attrGet(error->handle, DPI_OCI_HTYPE_ERROR,
-            (void*) &error->buffer->isRecoverable, 0,
-            DPI_OCI_ATTR_ERROR_IS_RECOVERABLE, NULL, error);
+    // otherwise, fetch OCI error
+    } else {
+        strcpy(error->buffer->encoding, error->encoding);
+        if (dpiOci__errorGet(error->handle, DPI_OCI_HTYPE_ERROR, action,
+                error) < 0)
+            return DPI_FAILURE;
+        if (dpiDebugLevel & DPI_DEBUG_LEVEL_ERRORS)
+            fprintf(stderr, "ODPI: OCI error %.*s (%s / %s)\n",
+                    error->buffer->messageLength, error->buffer->message,
+                    error->buffer->fnName, action);
+
+        // determine if error is recoverable (Transaction Guard)
+        // if the attribute cannot be read properly, simply leave it as false;
+        // otherwise, that error will mask the one that we really want to see
+        error->buffer->isRecoverable = 0;
+        dpiOci__attrGet(error->handle, DPI_OCI_HTYPE_ERROR,
+                (void*) &error->buffer->isRecoverable, 0,
+                DPI_OCI_ATTR_ERROR_IS_RECOVERABLE, NULL, error);
+    }
 
     // check for certain errors which indicate that the session is dead and
     // should be dropped from the session pool (if a session pool was used)
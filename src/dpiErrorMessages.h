@@ -72,5 +72,27 @@ static const char* const dpiErrorMessages[DPI_ERR_MAX - DPI_ERR_NO_ERR] = {
     "DPI-1052: unable to get NLS environment variable", // DPI_ERR_NLS_ENV_VAR_GET,
     "DPI-1053: parameter %s cannot be a NULL pointer while corresponding length parameter is non-zero", // DPI_ERR_PTR_LENGTH_MISMATCH
     "DPI-1054: connection cannot be closed when open statements or LOBs exist", // DPI_ERR_OPEN_CHILD_OBJS
+    "DPI-1055: JSON output was aborted by the write callback", // DPI_ERR_JSON_WRITE_ABORTED
+    "DPI-1056: pool minimum of %u sessions exceeds maximum of %u sessions", // DPI_ERR_POOL_MIN_EXCEEDS_MAX
+    "DPI-1057: ring buffer is too small to hold a single row", // DPI_ERR_RING_TOO_SMALL
+    "DPI-1058: sort key variable is not bound to the statement", // DPI_ERR_SORT_KEY_NOT_BOUND
+    "DPI-1059: value in row %u is not valid %s", // DPI_ERR_INVALID_ENCODED_DATA
+    "DPI-1060: call was interrupted after %u ms as it exceeded its timeout of %u ms", // DPI_ERR_CALL_TIMEOUT
+    "DPI-1061: pool class %u is not valid; it must be less than %u", // DPI_ERR_INVALID_POOL_CLASS
+    "DPI-1062: pool class %u rejected the request as %u sessions are busy and %u requests are queued", // DPI_ERR_POOL_CLASS_FULL
+    "DPI-1063: pool class %u rejected the request after it was queued for %u ms", // DPI_ERR_POOL_CLASS_TIMEOUT
+    "DPI-1064: values of native type %d cannot be shared", // DPI_ERR_NOT_SHAREABLE
+    "DPI-1065: interposer version %u is not supported (expected %u)", // DPI_ERR_INTERPOSE_VERSION
+    "DPI-1066: aggregate %d is not supported for the column at position %u", // DPI_ERR_AGGREGATE_NOT_SUPPORTED
+    "DPI-1067: transfers between LOBs and files are only supported for binary LOBs", // DPI_ERR_LOB_TRANSFER_NOT_BINARY
+    "DPI-1068: file %s failed with OS error %d", // DPI_ERR_FILE_IO
+    "DPI-1069: only DML statements without a RETURNING INTO clause can be added to a batch", // DPI_ERR_BATCH_NOT_DML
+    "DPI-1070: statements added to a batch cannot exceed %u bytes", // DPI_ERR_BATCH_STMT_TOO_LONG
+    "DPI-1071: no variable is bound to %.*s of statement %u in the batch", // DPI_ERR_BATCH_NOT_BOUND
+    "DPI-1072: statements added to a batch must be prepared on the connection used to create it", // DPI_ERR_BATCH_WRONG_CONN
+    "DPI-1073: variable bound to %.*s of statement %u in the batch must have an array size of 1 and cannot be dynamically sized", // DPI_ERR_BATCH_VAR_NOT_SUPPORTED
+    "DPI-1074: parameter %s cannot be zero", // DPI_ERR_PARAM_ZERO
+    "DPI-1075: sort key %u contains numbers as bytes which cannot be sorted numerically", // DPI_ERR_SORT_NUMBER_AS_BYTES
+    "DPI-1076: LOB offset must be at least 1 and cannot be more than one past the end of the LOB", // DPI_ERR_INVALID_LOB_OFFSET
 };
 
@@ -0,0 +1,430 @@
+//-----------------------------------------------------------------------------
+// Copyright (c) 2017 Oracle and/or its affiliates.  All rights reserved.
+// This program is free software: you can modify it and/or redistribute it
+// under the terms of:
+//
+// (i)  the Universal Permissive License v 1.0 or at your option, any
+//      later version (http://oss.oracle.com/licenses/upl); and/or
+//
+// (ii) the Apache License v 2.0. (http://www.apache.org/licenses/LICENSE-2.0)
+//-----------------------------------------------------------------------------
+
+//-----------------------------------------------------------------------------
+// dpiFingerprint.c
+//   Implementation of fingerprints of query results. Each value is hashed
+// with CRC32C directly from the buffers used to define the query, in a
+// canonical form that does not depend on the fetch array size or on the
+// platform. The value hashes are then combined into per-column and per-row
+// hashes and into ordered and order-independent digests of the rows.
+//-----------------------------------------------------------------------------
+
+#include "dpiImpl.h"
+
+// the CRC32C instruction is used when available; on x86 it is selected at
+// runtime so that the library does not need to be compiled for SSE 4.2
+#if defined(__GNUC__) && (defined(__x86_64__) || defined(__i386__))
+#include <nmmintrin.h>
+#define DPI_CRC32C_SSE42
+#elif defined(__ARM_FEATURE_CRC32)
+#include <arm_acle.h>
+#define DPI_CRC32C_ARM
+#endif
+
+// maximum size of the canonical form of a fixed size value
+#define DPI_FINGERPRINT_MAX_VALUE_SIZE  24
+
+// table used for computing CRC32C (Castagnoli polynomial) without hardware
+// support
+static const uint32_t dpiFingerprintCrcTable[256] = {
+    0x00000000, 0xf26b8303, 0xe13b70f7, 0x1350f3f4,
+    0xc79a971f, 0x35f1141c, 0x26a1e7e8, 0xd4ca64eb,
+    0x8ad958cf, 0x78b2dbcc, 0x6be22838, 0x9989ab3b,
+    0x4d43cfd0, 0xbf284cd3, 0xac78bf27, 0x5e133c24,
+    0x105ec76f, 0xe235446c, 0xf165b798, 0x030e349b,
+    0xd7c45070, 0x25afd373, 0x36ff2087, 0xc494a384,
+    0x9a879fa0, 0x68ec1ca3, 0x7bbcef57, 0x89d76c54,
+    0x5d1d08bf, 0xaf768bbc, 0xbc267848, 0x4e4dfb4b,
+    0x20bd8ede, 0xd2d60ddd, 0xc186fe29, 0x33ed7d2a,
+    0xe72719c1, 0x154c9ac2, 0x061c6936, 0xf477ea35,
+    0xaa64d611, 0x580f5512, 0x4b5fa6e6, 0xb93425e5,
+    0x6dfe410e, 0x9f95c20d, 0x8cc531f9, 0x7eaeb2fa,
+    0x30e349b1, 0xc288cab2, 0xd1d83946, 0x23b3ba45,
+    0xf779deae, 0x05125dad, 0x1642ae59, 0xe4292d5a,
+    0xba3a117e, 0x4851927d, 0x5b016189, 0xa96ae28a,
+    0x7da08661, 0x8fcb0562, 0x9c9bf696, 0x6ef07595,
+    0x417b1dbc, 0xb3109ebf, 0xa0406d4b, 0x522bee48,
+    0x86e18aa3, 0x748a09a0, 0x67dafa54, 0x95b17957,
+    0xcba24573, 0x39c9c670, 0x2a993584, 0xd8f2b687,
+    0x0c38d26c, 0xfe53516f, 0xed03a29b, 0x1f682198,
+    0x5125dad3, 0xa34e59d0, 0xb01eaa24, 0x42752927,
+    0x96bf4dcc, 0x64d4cecf, 0x77843d3b, 0x85efbe38,
+    0xdbfc821c, 0x2997011f, 0x3ac7f2eb, 0xc8ac71e8,
+    0x1c661503, 0xee0d9600, 0xfd5d65f4, 0x0f36e6f7,
+    0x61c69362, 0x93ad1061, 0x80fde395, 0x72966096,
+    0xa65c047d, 0x5437877e, 0x4767748a, 0xb50cf789,
+    0xeb1fcbad, 0x197448ae, 0x0a24bb5a, 0xf84f3859,
+    0x2c855cb2, 0xdeeedfb1, 0xcdbe2c45, 0x3fd5af46,
+    0x7198540d, 0x83f3d70e, 0x90a324fa, 0x62c8a7f9,
+    0xb602c312, 0x44694011, 0x5739b3e5, 0xa55230e6,
+    0xfb410cc2, 0x092a8fc1, 0x1a7a7c35, 0xe811ff36,
+    0x3cdb9bdd, 0xceb018de, 0xdde0eb2a, 0x2f8b6829,
+    0x82f63b78, 0x709db87b, 0x63cd4b8f, 0x91a6c88c,
+    0x456cac67, 0xb7072f64, 0xa457dc90, 0x563c5f93,
+    0x082f63b7, 0xfa44e0b4, 0xe9141340, 0x1b7f9043,
+    0xcfb5f4a8, 0x3dde77ab, 0x2e8e845f, 0xdce5075c,
+    0x92a8fc17, 0x60c37f14, 0x73938ce0, 0x81f80fe3,
+    0x55326b08, 0xa759e80b, 0xb4091bff, 0x466298fc,
+    0x1871a4d8, 0xea1a27db, 0xf94ad42f, 0x0b21572c,
+    0xdfeb33c7, 0x2d80b0c4, 0x3ed04330, 0xccbbc033,
+    0xa24bb5a6, 0x502036a5, 0x4370c551, 0xb11b4652,
+    0x65d122b9, 0x97baa1ba, 0x84ea524e, 0x7681d14d,
+    0x2892ed69, 0xdaf96e6a, 0xc9a99d9e, 0x3bc21e9d,
+    0xef087a76, 0x1d63f975, 0x0e330a81, 0xfc588982,
+    0xb21572c9, 0x407ef1ca, 0x532e023e, 0xa145813d,
+    0x758fe5d6, 0x87e466d5, 0x94b49521, 0x66df1622,
+    0x38cc2a06, 0xcaa7a905, 0xd9f75af1, 0x2b9cd9f2,
+    0xff56bd19, 0x0d3d3e1a, 0x1e6dcdee, 0xec064eed,
+    0xc38d26c4, 0x31e6a5c7, 0x22b65633, 0xd0ddd530,
+    0x0417b1db, 0xf67c32d8, 0xe52cc12c, 0x1747422f,
+    0x49547e0b, 0xbb3ffd08, 0xa86f0efc, 0x5a048dff,
+    0x8ecee914, 0x7ca56a17, 0x6ff599e3, 0x9d9e1ae0,
+    0xd3d3e1ab, 0x21b862a8, 0x32e8915c, 0xc083125f,
+    0x144976b4, 0xe622f5b7, 0xf5720643, 0x07198540,
+    0x590ab964, 0xab613a67, 0xb831c993, 0x4a5a4a90,
+    0x9e902e7b, 0x6cfbad78, 0x7fab5e8c, 0x8dc0dd8f,
+    0xe330a81a, 0x115b2b19, 0x020bd8ed, 0xf0605bee,
+    0x24aa3f05, 0xd6c1bc06, 0xc5914ff2, 0x37faccf1,
+    0x69e9f0d5, 0x9b8273d6, 0x88d28022, 0x7ab90321,
+    0xae7367ca, 0x5c18e4c9, 0x4f48173d, 0xbd23943e,
+    0xf36e6f75, 0x0105ec76, 0x12551f82, 0xe03e9c81,
+    0x34f4f86a, 0xc69f7b69, 0xd5cf889d, 0x27a40b9e,
+    0x79b737ba, 0x8bdcb4b9, 0x988c474d, 0x6ae7c44e,
+    0xbe2da0a5, 0x4c4623a6, 0x5f16d052, 0xad7d5351
+};
+
+// forward declarations of internal functions only used in this file
+static void dpiFingerprint__encode(unsigned char *buffer, uint32_t *length,
+        uint64_t value, uint32_t numBytes);
+static void dpiFingerprint__encodeTimestamp(unsigned char *buffer,
+        uint32_t *length, dpiTimestamp *value);
+static int dpiFingerprint__hashValue(dpiVar *var, uint32_t pos,
+        uint32_t *hash, dpiError *error);
+#if defined(DPI_CRC32C_SSE42) || defined(DPI_CRC32C_ARM)
+static uint32_t dpiFingerprint__crc32cHw(uint32_t crc,
+        const unsigned char *ptr, size_t length);
+#endif
+
+
+//-----------------------------------------------------------------------------
+// dpiFingerprint__addRows() [INTERNAL]
+//   Add the specified rows of the variables to the fingerprint. The hash of
+// each value is combined with its column position so that each column
+// contributes independently to the row hash; the row hashes are then summed
+// for the order-independent digest and chained for the ordered digest.
+//-----------------------------------------------------------------------------
+int dpiFingerprint__addRows(dpiFingerprint *fingerprint, dpiVar **vars,
+        uint32_t numVars, uint32_t firstRow, uint32_t numRows,
+        dpiError *error)
+{
+    uint64_t rowHash, valueHash;
+    uint32_t i, j, hash = 0;
+
+    // objects, cursors, LOB locators and rowids have no canonical form
+    for (j = 0; j < numVars; j++) {
+        switch (vars[j]->nativeTypeNum) {
+            case DPI_NATIVE_TYPE_LOB:
+            case DPI_NATIVE_TYPE_OBJECT:
+            case DPI_NATIVE_TYPE_STMT:
+            case DPI_NATIVE_TYPE_ROWID:
+                return dpiError__set(error, "check native type",
+                        DPI_ERR_UNHANDLED_DATA_TYPE, vars[j]->nativeTypeNum);
+            default:
+                break;
+        }
+    }
+
+    for (i = firstRow; i < firstRow + numRows; i++) {
+        rowHash = 0;
+        for (j = 0; j < numVars; j++) {
+            if (dpiFingerprint__hashValue(vars[j], i, &hash, error) < 0)
+                return DPI_FAILURE;
+            valueHash = dpiFingerprint__mix(((uint64_t) j << 32) | hash);
+            if (j < fingerprint->numColumns)
+                fingerprint->columnDigests[j] += valueHash;
+            rowHash += valueHash;
+        }
+        rowHash = dpiFingerprint__mix(rowHash);
+        fingerprint->orderedDigest =
+                dpiFingerprint__mix(fingerprint->orderedDigest + rowHash);
+        fingerprint->unorderedDigest += rowHash;
+        fingerprint->numRows++;
+    }
+
+    return DPI_SUCCESS;
+}
+
+
+//-----------------------------------------------------------------------------
+// dpiFingerprint__crc32c() [INTERNAL]
+//   Continue calculating the CRC32C of a sequence of bytes. The initial value
+// is zero and the calculation can be continued across multiple calls.
+//-----------------------------------------------------------------------------
+uint32_t dpiFingerprint__crc32c(uint32_t crc, const void *ptr,
+        size_t length)
+{
+    const unsigned char *bytes = (const unsigned char*) ptr;
+
+#if defined(DPI_CRC32C_SSE42)
+    if (__builtin_cpu_supports("sse4.2"))
+        return dpiFingerprint__crc32cHw(crc, bytes, length);
+#elif defined(DPI_CRC32C_ARM)
+    return dpiFingerprint__crc32cHw(crc, bytes, length);
+#endif
+    crc = ~crc;
+    while (length-- > 0)
+        crc = dpiFingerprintCrcTable[(crc ^ *bytes++) & 0xff] ^ (crc >> 8);
+    return ~crc;
+}
+
+
+#if defined(DPI_CRC32C_SSE42) || defined(DPI_CRC32C_ARM)
+//-----------------------------------------------------------------------------
+// dpiFingerprint__crc32cHw() [INTERNAL]
+//   Continue calculating the CRC32C of a sequence of bytes using the CRC32C
+// instruction, eight bytes at a time where possible.
+//-----------------------------------------------------------------------------
+#ifdef DPI_CRC32C_SSE42
+__attribute__((target("sse4.2")))
+#endif
+static uint32_t dpiFingerprint__crc32cHw(uint32_t crc,
+        const unsigned char *ptr, size_t length)
+{
+    uint64_t value;
+
+    crc = ~crc;
+    while (length >= sizeof(uint64_t)) {
+        memcpy(&value, ptr, sizeof(uint64_t));
+#if defined(DPI_CRC32C_SSE42) && defined(__x86_64__)
+        crc = (uint32_t) _mm_crc32_u64(crc, value);
+#elif defined(DPI_CRC32C_SSE42)
+        crc = _mm_crc32_u32(crc, (uint32_t) value);
+        crc = _mm_crc32_u32(crc, (uint32_t) (value >> 32));
+#else
+        crc = __crc32cd(crc, value);
+#endif
+        ptr += sizeof(uint64_t);
+        length -= sizeof(uint64_t);
+    }
+    while (length-- > 0) {
+#ifdef DPI_CRC32C_SSE42
+        crc = _mm_crc32_u8(crc, *ptr++);
+#else
+        crc = __crc32cb(crc, *ptr++);
+#endif
+    }
+    return ~crc;
+}
+#endif
+
+
+//-----------------------------------------------------------------------------
+// dpiFingerprint__encode() [INTERNAL]
+//   Encode an unsigned integer in the buffer as the specified number of bytes
+// in little endian order, so that the canonical form of values does not
+// depend on the platform.
+//-----------------------------------------------------------------------------
+static void dpiFingerprint__encode(unsigned char *buffer, uint32_t *length,
+        uint64_t value, uint32_t numBytes)
+{
+    uint32_t i;
+
+    for (i = 0; i < numBytes; i++, value >>= 8)
+        buffer[(*length)++] = (unsigned char) (value & 0xff);
+}
+
+
+//-----------------------------------------------------------------------------
+// dpiFingerprint__encodeTimestamp() [INTERNAL]
+//   Encode a timestamp in the buffer. Dates are encoded in the same way with
+// zero fractional seconds and time zone offsets.
+//-----------------------------------------------------------------------------
+static void dpiFingerprint__encodeTimestamp(unsigned char *buffer,
+        uint32_t *length, dpiTimestamp *value)
+{
+    dpiFingerprint__encode(buffer, length, (uint16_t) value->year, 2);
+    buffer[(*length)++] = value->month;
+    buffer[(*length)++] = value->day;
+    buffer[(*length)++] = value->hour;
+    buffer[(*length)++] = value->minute;
+    buffer[(*length)++] = value->second;
+    dpiFingerprint__encode(buffer, length, value->fsecond, 4);
+    buffer[(*length)++] = (unsigned char) value->tzHourOffset;
+    buffer[(*length)++] = (unsigned char) value->tzMinuteOffset;
+}
+
+
+//-----------------------------------------------------------------------------
+// dpiFingerprint__hashValue() [INTERNAL]
+//   Calculate the hash of the value at the specified position in the
+// variable. The canonical form of a value is a tag byte (0 for null and 1
+// otherwise) followed by the value itself. Numbers are hashed in Oracle's
+// own format and strings and raw data are hashed with a length prefix, all
+// directly from the define buffers. Only types stored in descriptors, such as
+// timestamps and intervals, and LOBs read as bytes are first converted to C
+// data values.
+//-----------------------------------------------------------------------------
+static int dpiFingerprint__hashValue(dpiVar *var, uint32_t pos,
+        uint32_t *hash, dpiError *error)
+{
+    unsigned char buffer[DPI_FINGERPRINT_MAX_VALUE_SIZE];
+    dpiDynamicBytes *dynamicBytes;
+    dpiTimestamp timestamp;
+    uint32_t i, length;
+    const char *ptr;
+    uint64_t temp;
+    dpiData data;
+
+    // null values consist of the tag byte only
+    length = 0;
+    if (var->indicator[pos] == DPI_OCI_IND_NULL) {
+        buffer[length++] = 0;
+        *hash = dpiFingerprint__crc32c(0, buffer, length);
+        return DPI_SUCCESS;
+    }
+    if (var->returnCode && var->returnCode[pos] != 0) {
+        dpiError__set(error, "check return code", DPI_ERR_COLUMN_FETCH, pos,
+                var->returnCode[pos]);
+        error->buffer->code = var->returnCode[pos];
+        return DPI_FAILURE;
+    }
+    buffer[length++] = 1;
+
+    switch (var->type->oracleTypeNum) {
+        case DPI_ORACLE_TYPE_NATIVE_INT:
+        case DPI_ORACLE_TYPE_NATIVE_UINT:
+            dpiFingerprint__encode(buffer, &length, var->data.asUint64[pos],
+                    sizeof(uint64_t));
+            break;
+        case DPI_ORACLE_TYPE_NATIVE_FLOAT:
+            memcpy(&i, &var->data.asFloat[pos], sizeof(float));
+            dpiFingerprint__encode(buffer, &length, i, sizeof(float));
+            break;
+        case DPI_ORACLE_TYPE_NATIVE_DOUBLE:
+            memcpy(&temp, &var->data.asDouble[pos], sizeof(double));
+            dpiFingerprint__encode(buffer, &length, temp, sizeof(double));
+            break;
+        case DPI_ORACLE_TYPE_BOOLEAN:
+            buffer[length++] = (var->data.asBoolean[pos] != 0);
+            break;
+        case DPI_ORACLE_TYPE_NUMBER:
+            memcpy(buffer + length, var->data.asNumber[pos].value,
+                    var->data.asNumber[pos].value[0] + 1);
+            length += var->data.asNumber[pos].value[0] + 1;
+            break;
+        case DPI_ORACLE_TYPE_DATE:
+            memset(&timestamp, 0, sizeof(timestamp));
+            timestamp.year = var->data.asDate[pos].year;
+            timestamp.month = var->data.asDate[pos].month;
+            timestamp.day = var->data.asDate[pos].day;
+            timestamp.hour = var->data.asDate[pos].hour;
+            timestamp.minute = var->data.asDate[pos].minute;
+            timestamp.second = var->data.asDate[pos].second;
+            dpiFingerprint__encodeTimestamp(buffer, &length, &timestamp);
+            break;
+        case DPI_ORACLE_TYPE_VARCHAR:
+        case DPI_ORACLE_TYPE_NVARCHAR:
+        case DPI_ORACLE_TYPE_CHAR:
+        case DPI_ORACLE_TYPE_NCHAR:
+        case DPI_ORACLE_TYPE_ROWID:
+        case DPI_ORACLE_TYPE_RAW:
+        case DPI_ORACLE_TYPE_LONG_VARCHAR:
+        case DPI_ORACLE_TYPE_LONG_RAW:
+            if (var->dynamicBytes) {
+                dynamicBytes = &var->dynamicBytes[pos];
+                for (i = 0, temp = 0; i < dynamicBytes->numChunks; i++)
+                    temp += dynamicBytes->chunks[i].length;
+                dpiFingerprint__encode(buffer, &length, temp,
+                        sizeof(uint32_t));
+                *hash = dpiFingerprint__crc32c(0, buffer, length);
+                for (i = 0; i < dynamicBytes->numChunks; i++)
+                    *hash = dpiFingerprint__crc32c(*hash,
+                            dynamicBytes->chunks[i].ptr,
+                            dynamicBytes->chunks[i].length);
+                return DPI_SUCCESS;
+            }
+            ptr = var->data.asBytes + pos * var->sizeInBytes;
+            temp = (var->actualLength32) ? var->actualLength32[pos] :
+                    var->actualLength16[pos];
+            dpiFingerprint__encode(buffer, &length, temp, sizeof(uint32_t));
+            *hash = dpiFingerprint__crc32c(0, buffer, length);
+            *hash = dpiFingerprint__crc32c(*hash, ptr, (size_t) temp);
+            return DPI_SUCCESS;
+        default:
+
+            // remaining types are first converted to C data values
+            if (dpiVar__getValue(var, pos, &data, error) < 0)
+                return DPI_FAILURE;
+            switch (var->nativeTypeNum) {
+                case DPI_NATIVE_TYPE_BYTES:
+                    dpiFingerprint__encode(buffer, &length,
+                            data.value.asBytes.length, sizeof(uint32_t));
+                    *hash = dpiFingerprint__crc32c(0, buffer, length);
+                    *hash = dpiFingerprint__crc32c(*hash,
+                            data.value.asBytes.ptr,
+                            data.value.asBytes.length);
+                    return DPI_SUCCESS;
+                case DPI_NATIVE_TYPE_TIMESTAMP:
+                    dpiFingerprint__encodeTimestamp(buffer, &length,
+                            &data.value.asTimestamp);
+                    break;
+                case DPI_NATIVE_TYPE_INTERVAL_DS:
+                    dpiFingerprint__encode(buffer, &length,
+                            (uint32_t) data.value.asIntervalDS.days, 4);
+                    dpiFingerprint__encode(buffer, &length,
+                            (uint32_t) data.value.asIntervalDS.hours, 4);
+                    dpiFingerprint__encode(buffer, &length,
+                            (uint32_t) data.value.asIntervalDS.minutes, 4);
+                    dpiFingerprint__encode(buffer, &length,
+                            (uint32_t) data.value.asIntervalDS.seconds, 4);
+                    dpiFingerprint__encode(buffer, &length,
+                            (uint32_t) data.value.asIntervalDS.fseconds, 4);
+                    break;
+                case DPI_NATIVE_TYPE_INTERVAL_YM:
+                    dpiFingerprint__encode(buffer, &length,
+                            (uint32_t) data.value.asIntervalYM.years, 4);
+                    dpiFingerprint__encode(buffer, &length,
+                            (uint32_t) data.value.asIntervalYM.months, 4);
+                    break;
+                case DPI_NATIVE_TYPE_DOUBLE:
+                    memcpy(&temp, &data.value.asDouble, sizeof(double));
+                    dpiFingerprint__encode(buffer, &length, temp,
+                            sizeof(double));
+                    break;
+                default:
+                    return dpiError__set(error, "check native type",
+                            DPI_ERR_UNHANDLED_DATA_TYPE, var->nativeTypeNum);
+            }
+            break;
+    }
+
+    *hash = dpiFingerprint__crc32c(0, buffer, length);
+    return DPI_SUCCESS;
+}
+
+
+//-----------------------------------------------------------------------------
+// dpiFingerprint__mix() [INTERNAL]
+//   Mix the bits of the value so that each bit of the input affects all bits
+// of the output (the 64-bit finalizer of MurmurHash3). This is a bijection,
+// so distinct inputs always result in distinct outputs.
+//-----------------------------------------------------------------------------
+uint64_t dpiFingerprint__mix(uint64_t value)
+{
+    value ^= value >> 33;
+    value *= UINT64_C(0xff51afd7ed558ccd);
+    value ^= value >> 33;
+    value *= UINT64_C(0xc4ceb9fe1a85ec53);
+    value ^= value >> 33;
+    return value;
+}
+
@@ -97,6 +97,24 @@ static const dpiTypeDef dpiAllTypeDefs[DPI_HTYPE_MAX - DPI_HTYPE_NONE - 1] = {
         sizeof(dpiRowid),               // size of structure
         0x6204fa04,                     // check integer
         (dpiTypeFreeProc) dpiRowid__free
+    },
+    {
+        "dpiSharedResult",              // name
+        sizeof(dpiSharedResult),        // size of structure
+        0x5c7e19b3,                     // check integer
+        (dpiTypeFreeProc) dpiSharedResult__free
+    },
+    {
+        "dpiAggregateResult",           // name
+        sizeof(dpiAggregateResult),     // size of structure
+        0x3a9d6e41,                     // check integer
+        (dpiTypeFreeProc) dpiAggregateResult__free
+    },
+    {
+        "dpiBatch",                     // name
+        sizeof(dpiBatch),               // size of structure
+        0x71c53e08,                     // check integer
+        (dpiTypeFreeProc) dpiBatch__free
     }
 };
 
@@ -80,7 +80,13 @@ static int dpiGlobal__createEnv(const char *fnName, dpiError *error)
     // not do so; this check minimizes but does not eliminate the risk
     if (dpiGlobalEnv)
         dpiEnv__free(tempEnv, error);
-    else dpiGlobalEnv = tempEnv;
+    else {
+        if (dpiWatchdog__initialize(tempEnv, error) < 0) {
+            dpiEnv__free(tempEnv, error);
+            return DPI_FAILURE;
+        }
+        dpiGlobalEnv = tempEnv;
+    }
 
     // determine the value of the environment variable DPI_DEBUG_LEVEL and
     // convert to an integer; if the value in the environment variable is not a
@@ -232,3 +238,15 @@ int dpiGlobal__lookupEncoding(uint16_t charsetId, char *encoding,
     return DPI_SUCCESS;
 }
 
+
+//-----------------------------------------------------------------------------
+// dpiGlobal__setInterposer() [INTERNAL]
+//   Install the interposer on calls that require round trips (or remove it if
+// the parameters are NULL). The mutex of the global environment is used to
+// serialize changes made by different threads.
+//-----------------------------------------------------------------------------
+int dpiGlobal__setInterposer(const dpiInterposeParams *params,
+        dpiError *error)
+{
+    return dpiOci__setInterposer(dpiGlobalEnv, params, error);
+}
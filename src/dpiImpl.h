@@ -46,6 +46,76 @@ extern long dpiDebugLevel;
 // define internal chunk size used for dynamic binding/fetching
 #define DPI_DYNAMIC_BYTES_CHUNK_SIZE                65536
 
+// define size of buffer used for staging JSON passed to write callbacks
+#define DPI_JSON_CHUNK_SIZE                         8192
+
+// define size of huge pages and the smallest buffer that will be placed in
+// them; the size of base pages is used when pre-faulting buffers
+#define DPI_HUGE_PAGE_SIZE                          (2 * 1024 * 1024)
+#define DPI_BASE_PAGE_SIZE                          4096
+
+// define NUMA memory policy constants (from linux/mempolicy.h) and the
+// maximum number of NUMA nodes supported when binding buffers to a node
+#define DPI_MPOL_PREFERRED                          1
+#define DPI_MPOL_F_NODE                             1
+#define DPI_MPOL_F_ADDR                             2
+#define DPI_MAX_NUMA_NODES                          1024
+
+// define the minimum size of the blocks in which data is transferred between
+// LOBs and files and the largest block that will be used in order to satisfy
+// the alignment required by direct I/O
+#define DPI_LOB_TRANSFER_BLOCK_SIZE                 (1024 * 1024)
+#define DPI_LOB_TRANSFER_MAX_BLOCK_SIZE             (16 * 1024 * 1024)
+
+// define the largest string literal and the largest number of literals that
+// are replaced by bind variables when statements are prepared with the prepare
+// mode DPI_MODE_PREPARE_AUTO_BIND and the deepest nesting of parentheses
+// tracked while doing so
+#define DPI_AUTO_BIND_MAX_STRING_SIZE               2000
+#define DPI_AUTO_BIND_MAX_LITERALS                  65535
+#define DPI_AUTO_BIND_MAX_DEPTH                     62
+#define DPI_BATCH_MAX_STMT_SIZE                     32767
+#define DPI_BATCH_MAX_MESSAGE_SIZE                  512
+
+// define the granularity of the watchdog which interrupts calls that exceed
+// their timeout, the number of slots in its timer wheel, the number of ticks
+// without any calls in progress after which its thread exits and the interval
+// at which a completed call waits for the watchdog to finish breaking it
+#define DPI_WATCHDOG_TICK_MS                        10
+#define DPI_WATCHDOG_NUM_SLOTS                      512
+#define DPI_WATCHDOG_IDLE_TICKS                     512
+#define DPI_WATCHDOG_POLL_MS                        1
+
+// define the states of a call monitored by the watchdog
+#define DPI_WATCHDOG_STATE_WAITING                  0
+#define DPI_WATCHDOG_STATE_BREAKING                 1
+#define DPI_WATCHDOG_STATE_FIRED                    2
+
+// define the interval at which requests queued by a pool admission class
+// check whether a session has become available
+#define DPI_POOL_CLASS_POLL_MS                      1
+
+// define the number of hash buckets used to find shared queries in progress
+// and the interval at which callers waiting for a shared query check whether
+// it has completed
+#define DPI_SHARED_QUERY_NUM_BUCKETS                64
+#define DPI_SHARED_QUERY_POLL_MS                    1
+
+// define the number of bits of the hash used to select a register when
+// estimating the number of distinct values (and therefore the number of
+// registers) and the initial number of hash buckets used to find groups when
+// computing aggregates
+#define DPI_AGGREGATE_REGISTER_BITS                 12
+#define DPI_AGGREGATE_NUM_REGISTERS                 4096
+#define DPI_AGGREGATE_INITIAL_BUCKETS               16
+
+// define the states of an object type held in the cache of object types
+// maintained by a connection; object types are retired instead of being freed
+// when their last reference is released and are reused from there
+#define DPI_OBJECT_TYPE_STATE_ACTIVE                0
+#define DPI_OBJECT_TYPE_STATE_RETIRING              1
+#define DPI_OBJECT_TYPE_STATE_RETIRED               2
+
 // define well-known character sets
 #define DPI_CHARSET_ID_ASCII                        1
 #define DPI_CHARSET_ID_UTF8                         873
@@ -201,6 +271,7 @@ extern long dpiDebugLevel;
 #define DPI_OCI_ATTR_LTXID                          462
 #define DPI_OCI_ATTR_DML_ROW_COUNT_ARRAY            469
 #define DPI_OCI_ATTR_ERROR_IS_RECOVERABLE           472
+#define DPI_OCI_ATTR_TRANSACTION_IN_PROGRESS        484
 #define DPI_OCI_ATTR_DBOP                           485
 #define DPI_OCI_ATTR_SPOOL_MAX_LIFETIME_SESSION     490
 #define DPI_OCI_ATTR_BREAK_ON_NET_TIMEOUT           495
@@ -246,6 +317,7 @@ extern long dpiDebugLevel;
 
 // define session pool constants
 #define DPI_OCI_SPD_FORCE                           0x0001
+#define DPI_OCI_SPC_REINITIALIZE                    0x0001
 #define DPI_OCI_SPC_HOMOGENEOUS                     0x0002
 #define DPI_OCI_SPC_STMTCACHE                       0x0004
 
@@ -321,6 +393,11 @@ extern long dpiDebugLevel;
 #define DPI_OCI_STMT_CACHE                          0x00000040
 #define DPI_OCI_TRANS_TWOPHASE                      0x01000000
 
+// define status used in place of the status returned by OCI when an
+// interposer injects an error instead of making the call; OCI never returns
+// this value itself
+#define DPI_OCI_ERROR_INJECTED                      -99999
+
 //-----------------------------------------------------------------------------
 // Macros
 //-----------------------------------------------------------------------------
@@ -396,6 +473,28 @@ typedef enum {
     DPI_ERR_NLS_ENV_VAR_GET,
     DPI_ERR_PTR_LENGTH_MISMATCH,
     DPI_ERR_OPEN_CHILD_OBJS,
+    DPI_ERR_JSON_WRITE_ABORTED,
+    DPI_ERR_POOL_MIN_EXCEEDS_MAX,
+    DPI_ERR_RING_TOO_SMALL,
+    DPI_ERR_SORT_KEY_NOT_BOUND,
+    DPI_ERR_INVALID_ENCODED_DATA,
+    DPI_ERR_CALL_TIMEOUT,
+    DPI_ERR_INVALID_POOL_CLASS,
+    DPI_ERR_POOL_CLASS_FULL,
+    DPI_ERR_POOL_CLASS_TIMEOUT,
+    DPI_ERR_NOT_SHAREABLE,
+    DPI_ERR_INTERPOSE_VERSION,
+    DPI_ERR_AGGREGATE_NOT_SUPPORTED,
+    DPI_ERR_LOB_TRANSFER_NOT_BINARY,
+    DPI_ERR_FILE_IO,
+    DPI_ERR_BATCH_NOT_DML,
+    DPI_ERR_BATCH_STMT_TOO_LONG,
+    DPI_ERR_BATCH_NOT_BOUND,
+    DPI_ERR_BATCH_WRONG_CONN,
+    DPI_ERR_BATCH_VAR_NOT_SUPPORTED,
+    DPI_ERR_PARAM_ZERO,
+    DPI_ERR_SORT_NUMBER_AS_BYTES,
+    DPI_ERR_INVALID_LOB_OFFSET,
     DPI_ERR_MAX
 } dpiErrorNum;
 
@@ -415,6 +514,9 @@ typedef enum {
     DPI_HTYPE_ENQ_OPTIONS,
     DPI_HTYPE_MSG_PROPS,
     DPI_HTYPE_ROWID,
+    DPI_HTYPE_SHARED_RESULT,
+    DPI_HTYPE_AGGREGATE_RESULT,
+    DPI_HTYPE_BATCH,
     DPI_HTYPE_MAX
 } dpiHandleTypeNum;
 
@@ -484,6 +586,8 @@ typedef struct {
     uint16_t ncharsetId;
     void *baseDate;
     int threaded;
+    dpiBufferMode bufferMode;
+    dpiPrepareMode prepareMode;
 } dpiEnv;
 
 struct dpiErrorForThread {
@@ -492,6 +596,20 @@ struct dpiErrorForThread {
     uint32_t pos;
 };
 
+typedef struct dpiWatchdogEntry dpiWatchdogEntry;
+
+struct dpiWatchdogEntry {
+    dpiConn *conn;
+    uint64_t startTime;
+    uint64_t expireTime;
+    uint32_t timeout;
+    uint32_t slot;
+    int state;
+    dpiWatchdogEntry *prev;
+    dpiWatchdogEntry *next;
+    dpiWatchdogEntry *nextExpired;
+};
+
 typedef void (*dpiTypeFreeProc)(void*, dpiError*);
 
 typedef struct {
@@ -541,10 +659,116 @@ typedef struct {
     uint32_t nameLength;
 } dpiBindVar;
 
+typedef struct {
+    int isNumber;
+    uint32_t offset;
+    uint32_t length;
+} dpiAutoBindLiteral;
+
+typedef struct {
+    char *sql;
+    uint32_t sqlLength;
+    uint32_t allocatedSqlLength;
+    char *values;
+    uint32_t valuesLength;
+    dpiAutoBindLiteral *literals;
+    uint32_t numLiterals;
+    uint32_t allocatedLiterals;
+    uint32_t numWords;
+    uint32_t depth;
+    uint64_t keepMask;
+    uint64_t constantMask;
+    const char *prevWord;
+    uint32_t prevWordLength;
+    char pendingSeparator;
+    int afterBind;
+    int abandoned;
+    int findBinds;
+} dpiAutoBind;
+
+typedef struct {
+    dpiStmt *stmt;
+    char *sql;
+    uint32_t sqlLength;
+    dpiAutoBindLiteral *binds;
+    uint32_t numBinds;
+} dpiBatchEntry;
+
+typedef struct {
+    uint64_t count;
+    dpiData value;
+    char *key;
+    uint32_t keyLength;
+    uint32_t allocatedKeyLength;
+    uint8_t *registers;
+} dpiAggregateAccumulator;
+
+typedef struct {
+    uint32_t hash;
+    uint32_t next;
+    dpiData key;
+    char *keyBytes;
+    uint32_t keyLength;
+} dpiAggregateGroup;
+
+typedef struct {
+    dpiEnv *env;
+    int fd;
+    int readFromFile;
+    dpiLobTransferMode mode;
+    int isDirect;
+    int originalFlags;
+    uint32_t blockSize;
+    char *allocatedBuffer;
+    char *buffers[2];
+    uint64_t lengths[2];
+    uint32_t fileIndex;
+    int64_t fileOffset;
+    int osError;
+    void *threadId;
+    void *threadHandle;
+} dpiLobTransfer;
+
 
 //-----------------------------------------------------------------------------
 // External implementation type definitions
 //-----------------------------------------------------------------------------
+typedef struct {
+    int isEnabled;
+    int inProgress;
+    dpiPoolSizingParams params;
+    uint64_t intervalStart;
+    uint64_t totalWaitTime;
+    uint32_t numAcquires;
+    uint32_t numFailures;
+    uint32_t peakBusyCount;
+} dpiPoolSizer;
+
+typedef struct dpiSharedQuery dpiSharedQuery;
+
+struct dpiSharedQuery {
+    char *key;
+    uint32_t keyLength;
+    uint32_t hash;
+    unsigned numUsers;
+    int done;
+    dpiSharedResult *result;
+    dpiErrorBuffer errorBuffer;
+    dpiSharedQuery *next;
+};
+
+typedef struct {
+    int isEnabled;
+    dpiPoolClassParams params;
+    double limit;
+    uint64_t lastDecreaseTime;
+    uint32_t busyCount;
+    uint32_t queuedCount;
+    uint64_t numAdmitted;
+    uint64_t numRejected;
+    uint64_t numTimedOut;
+} dpiPoolClass;
+
 struct dpiPool {
     dpiType_HEAD
     void *handle;
@@ -554,11 +778,19 @@ struct dpiPool {
     int pingTimeout;
     int homogeneous;
     int externalAuth;
+    uint32_t minSessions;
+    uint32_t maxSessions;
+    uint32_t sessionIncrement;
+    dpiPoolSizer sizer;
+    dpiPoolClass classes[DPI_MAX_POOL_CLASSES];
+    dpiRetryInfo retryInfo;
+    dpiSharedQuery *sharedQueries[DPI_SHARED_QUERY_NUM_BUCKETS];
 };
 
 struct dpiConn {
     dpiType_HEAD
     dpiPool *pool;
+    dpiPoolClass *poolClass;
     void *handle;
     void *serverHandle;
     void *sessionHandle;
@@ -568,10 +800,13 @@ struct dpiConn {
     uint32_t commitMode;
     uint16_t charsetId;
     unsigned openChildCount;
+    dpiObjectType *objectTypeCache;
     int externalHandle;
     int dropSession;
     int standalone;
     int closing;
+    uint64_t roundTrips;
+    dpiRetryInfo retryInfo;
 };
 
 struct dpiContext {
@@ -596,9 +831,15 @@ struct dpiStmt {
     dpiErrorBuffer *batchErrors;
     uint64_t rowCount;
     uint64_t bufferMinRow;
+    uint64_t fetchLimit;
+    uint32_t *permutation;
+    uint32_t permutationLength;
+    int permutationPending;
+    uint64_t *permutedRowCounts;
     uint16_t statementType;
     int isOwned;
     int hasRowsToFetch;
+    uint32_t prefetchRows;
     int scrollable;
     int isReturning;
     int deleteFromCache;
@@ -661,6 +902,7 @@ struct dpiVar {
     uint32_t *actualLength32;
     uint32_t sizeInBytes;
     int isDynamic;
+    int isImplicitDefine;
     dpiObjectType *objectType;
     void **objectIndicator;
     dpiReferenceBuffer *references;
@@ -668,6 +910,10 @@ struct dpiVar {
     char *tempBuffer;
     dpiData *externalData;
     dpiOracleData data;
+    size_t dataMappedLength;
+    uint16_t outputCharsetId;
+    char *transcodeBuffer;
+    size_t transcodeBufferSize;
     dpiError *error;
 };
 
@@ -677,6 +923,8 @@ struct dpiLob {
     const dpiOracleType *type;
     void *locator;
     char *buffer;
+    dpiObject *borrowedFrom;
+    dpiLob *nextBorrowed;
 };
 
 struct dpiObjectAttr {
@@ -687,6 +935,22 @@ struct dpiObjectAttr {
     dpiDataTypeInfo typeInfo;
 };
 
+typedef struct {
+    char *name;
+    uint32_t nameLength;
+    dpiDataTypeInfo typeInfo;
+    char *key;
+    uint32_t keyLength;
+} dpiJsonPlanEntry;
+
+typedef struct {
+    dpiJsonBuffer *buffer;
+    dpiJsonWriteCallback callback;
+    void *callbackContext;
+    char chunk[DPI_JSON_CHUNK_SIZE];
+    uint32_t chunkLength;
+} dpiJsonWriter;
+
 struct dpiObjectType {
     dpiType_HEAD
     dpiConn *conn;
@@ -699,6 +963,12 @@ struct dpiObjectType {
     dpiDataTypeInfo elementTypeInfo;
     int isCollection;
     uint16_t numAttributes;
+    dpiJsonPlanEntry *jsonPlan;
+    const char *lookupName;
+    uint32_t lookupNameLength;
+    dpiObjectType *nextCached;
+    int isCached;
+    int cacheState;
 };
 
 struct dpiObject {
@@ -707,6 +977,7 @@ struct dpiObject {
     void *instance;
     void *indicator;
     int isIndependent;
+    dpiLob *borrowedLobs;
 };
 
 struct dpiRowid {
@@ -716,6 +987,57 @@ struct dpiRowid {
     uint16_t bufferLength;
 };
 
+struct dpiSharedResult {
+    dpiType_HEAD
+    dpiPool *pool;
+    uint32_t numColumns;
+    dpiQueryInfo *queryInfo;
+    dpiNativeTypeNum *nativeTypeNums;
+    uint32_t numRows;
+    uint32_t allocatedRows;
+    dpiData *data;
+    dpiDynamicBytes buffer;
+};
+
+struct dpiAggregateResult {
+    dpiType_HEAD
+    dpiConn *conn;
+    uint32_t numSpecs;
+    dpiAggregateSpec *specs;
+    dpiOracleTypeNum *oracleTypeNums;
+    dpiNativeTypeNum *nativeTypeNums;
+    uint32_t groupByPos;
+    dpiOracleTypeNum groupByOracleTypeNum;
+    dpiNativeTypeNum groupByNativeTypeNum;
+    uint32_t numGroups;
+    uint32_t allocatedGroups;
+    dpiAggregateGroup *groups;
+    dpiAggregateAccumulator *accumulators;
+    uint32_t numBuckets;
+    uint32_t *buckets;
+};
+
+struct dpiBatch {
+    dpiType_HEAD
+    dpiConn *conn;
+    uint32_t numEntries;
+    uint32_t allocatedEntries;
+    dpiBatchEntry *entries;
+    uint64_t *rowCounts;
+    uint32_t numRowCounts;
+    uint32_t numErrors;
+    dpiErrorBuffer *errors;
+    dpiStmt *stmt;
+    char *sql;
+    uint32_t sqlLength;
+    uint32_t allocatedSqlLength;
+    char *buffer;
+    uint32_t bufferLength;
+    uint32_t allocatedBufferLength;
+    uint32_t numResultVars;
+    dpiVar **resultVars;
+};
+
 struct dpiSubscr {
     dpiType_HEAD
     dpiConn *conn;
@@ -744,6 +1066,36 @@ struct dpiMsgProps {
 };
 
 
+//-----------------------------------------------------------------------------
+// definition of internal dpiAggregateResult methods
+//-----------------------------------------------------------------------------
+int dpiAggregateResult__addRows(dpiAggregateResult *result, dpiVar **vars,
+        uint32_t firstRow, uint32_t numRows, dpiError *error);
+int dpiAggregateResult__allocate(dpiConn *conn, dpiAggregateResult **result,
+        dpiError *error);
+int dpiAggregateResult__finalize(dpiAggregateResult *result,
+        dpiError *error);
+void dpiAggregateResult__free(dpiAggregateResult *result, dpiError *error);
+int dpiAggregateResult__setSpecs(dpiAggregateResult *result,
+        uint32_t numSpecs, dpiAggregateSpec *specs, uint32_t groupByPos,
+        dpiVar **vars, uint32_t numVars, dpiError *error);
+
+
+//-----------------------------------------------------------------------------
+// definition of internal dpiAutoBind methods
+//-----------------------------------------------------------------------------
+void dpiAutoBind__clear(dpiAutoBind *autoBind);
+int dpiAutoBind__parse(dpiAutoBind *autoBind, const char *sql,
+        uint32_t sqlLength, int findBinds, dpiError *error);
+
+
+//-----------------------------------------------------------------------------
+// definition of internal dpiBatch methods
+//-----------------------------------------------------------------------------
+int dpiBatch__allocate(dpiConn *conn, dpiBatch **batch, dpiError *error);
+void dpiBatch__free(dpiBatch *batch, dpiError *error);
+
+
 //-----------------------------------------------------------------------------
 // definition of internal dpiContext methods
 //-----------------------------------------------------------------------------
@@ -751,8 +1103,16 @@ int dpiContext__initCommonCreateParams(const dpiContext *context,
         dpiCommonCreateParams *params, dpiError *error);
 int dpiContext__initConnCreateParams(const dpiContext *context,
         dpiConnCreateParams *params, dpiError *error);
+int dpiContext__initInterposeParams(const dpiContext *context,
+        dpiInterposeParams *params, dpiError *error);
+int dpiContext__initPoolClassParams(const dpiContext *context,
+        dpiPoolClassParams *params, dpiError *error);
 int dpiContext__initPoolCreateParams(const dpiContext *context,
         dpiPoolCreateParams *params, dpiError *error);
+int dpiContext__initPoolSizingParams(const dpiContext *context,
+        dpiPoolSizingParams *params, dpiError *error);
+int dpiContext__initRetryParams(const dpiContext *context,
+        dpiRetryParams *params, dpiError *error);
 int dpiContext__initSubscrCreateParams(const dpiContext *context,
         dpiSubscrCreateParams *params, dpiError *error);
 int dpiContext__startPublicFn(const dpiContext *context, const char *fnName,
@@ -806,6 +1166,8 @@ int dpiEnv__init(dpiEnv *env, const dpiContext *context,
         const dpiCommonCreateParams *params, dpiError *error);
 int dpiEnv__getEncodingInfo(dpiEnv *env, dpiEncodingInfo *info);
 int dpiEnv__initError(dpiEnv *env, dpiError *error);
+int dpiEnv__trimMemory(dpiEnv *env, uint64_t lowWaterMark,
+        uint64_t *bytesReclaimed, dpiError *error);
 
 
 //-----------------------------------------------------------------------------
@@ -818,6 +1180,17 @@ int dpiError__set(dpiError *error, const char *context, dpiErrorNum errorNum,
         ...);
 
 
+//-----------------------------------------------------------------------------
+// definition of internal dpiFingerprint methods
+//-----------------------------------------------------------------------------
+int dpiFingerprint__addRows(dpiFingerprint *fingerprint, dpiVar **vars,
+        uint32_t numVars, uint32_t firstRow, uint32_t numRows,
+        dpiError *error);
+uint32_t dpiFingerprint__crc32c(uint32_t crc, const void *ptr,
+        size_t length);
+uint64_t dpiFingerprint__mix(uint64_t value);
+
+
 //-----------------------------------------------------------------------------
 // definition of internal dpiGen methods
 //-----------------------------------------------------------------------------
@@ -840,6 +1213,8 @@ int dpiGlobal__lookupCharSet(const char *name, uint16_t *charsetId,
         dpiError *error);
 int dpiGlobal__lookupEncoding(uint16_t charsetId, char *encoding,
         dpiError *error);
+int dpiGlobal__setInterposer(const dpiInterposeParams *params,
+        dpiError *error);
 
 
 //-----------------------------------------------------------------------------
@@ -861,7 +1236,10 @@ int dpiConn__get(dpiConn *conn, const char *userName, uint32_t userNameLength,
         const char *connectString, uint32_t connectStringLength,
         dpiConnCreateParams *createParams, dpiPool *pool, dpiError *error);
 int dpiConn__getServerVersion(dpiConn *conn, dpiError *error);
+int dpiConn__getTransactionInProgress(dpiConn *conn, int *inProgress,
+        dpiError *error);
 int dpiConn__incrementOpenChildCount(dpiConn *conn, dpiError *error);
+int dpiConn__replaceSession(dpiConn *conn, dpiError *error);
 
 
 //-----------------------------------------------------------------------------
@@ -870,7 +1248,21 @@ int dpiConn__incrementOpenChildCount(dpiConn *conn, dpiError *error);
 int dpiPool__acquireConnection(dpiPool *pool, const char *userName,
         uint32_t userNameLength, const char *password, uint32_t passwordLength,
         dpiConnCreateParams *params, dpiConn **conn, dpiError *error);
+void dpiPool__addRetryInfo(dpiPool *pool, dpiRetryInfo *info,
+        dpiError *error);
+void dpiPool__evaluateSize(dpiPool *pool, dpiError *error);
 void dpiPool__free(dpiPool *pool, dpiError *error);
+void dpiPool__recordLatency(dpiPool *pool, dpiPoolClass *poolClass,
+        uint64_t elapsed, dpiError *error);
+void dpiPool__releaseClass(dpiPool *pool, dpiPoolClass *poolClass,
+        dpiError *error);
+
+
+//-----------------------------------------------------------------------------
+// definition of internal dpiSort methods
+//-----------------------------------------------------------------------------
+int dpiSort__sortRows(dpiVar **keyVars, uint32_t numKeyVars, uint32_t numRows,
+        uint32_t *permutation, dpiError *error);
 
 
 //-----------------------------------------------------------------------------
@@ -878,10 +1270,20 @@ void dpiPool__free(dpiPool *pool, dpiError *error);
 //-----------------------------------------------------------------------------
 int dpiStmt__allocate(dpiConn *conn, int scrollable, dpiStmt **stmt,
         dpiError *error);
+int dpiStmt__bind(dpiStmt *stmt, dpiVar *var, int addReference,
+        uint32_t pos, const char *name, uint32_t nameLength, dpiError *error);
+int dpiStmt__execute(dpiStmt *stmt, uint32_t numIters, uint32_t mode,
+        int reExecute, dpiError *error);
 void dpiStmt__free(dpiStmt *stmt, dpiError *error);
 int dpiStmt__init(dpiStmt *stmt, dpiError *error);
 int dpiStmt__prepare(dpiStmt *stmt, const char *sql, uint32_t sqlLength,
         const char *tag, uint32_t tagLength, dpiError *error);
+int dpiStmt__prepareAutoBind(dpiStmt *stmt, const char *sql,
+        uint32_t sqlLength, const char *tag, uint32_t tagLength,
+        dpiError *error);
+int dpiStmt__queryShared(dpiConn *conn, const char *sql, uint32_t sqlLength,
+        uint32_t numBinds, dpiNativeTypeNum *bindNativeTypeNums,
+        dpiData *bindValues, dpiSharedResult *result, dpiError *error);
 
 
 //-----------------------------------------------------------------------------
@@ -902,13 +1304,28 @@ void dpiVar__free(dpiVar *var, dpiError *error);
 int32_t dpiVar__inBindCallback(dpiVar *var, void *bindp, uint32_t iter,
         uint32_t index, void **bufpp, uint32_t *alenp, uint8_t *piecep,
         void **indpp);
+uint64_t dpiVar__getMemoryUsage(dpiVar *var);
 int dpiVar__getValue(dpiVar *var, uint32_t pos, dpiData *data,
         dpiError *error);
 int dpiVar__setValue(dpiVar *var, uint32_t pos, dpiData *data,
         dpiError *error);
+int dpiVar__permute(dpiVar *var, const uint32_t *permutation,
+        uint32_t numRows, dpiError *error);
 int32_t dpiVar__outBindCallback(dpiVar *var, void *bindp, uint32_t iter,
         uint32_t index, void **bufpp, uint32_t **alenpp, uint8_t *piecep,
         void **indpp, uint16_t **rcodepp);
+void dpiVar__resetBytes(dpiVar *var, uint32_t numRows);
+void dpiVar__trimMemory(dpiVar *var, uint64_t lowWaterMark,
+        uint64_t *bytesReclaimed);
+
+
+//-----------------------------------------------------------------------------
+// definition of internal dpiJson methods
+//-----------------------------------------------------------------------------
+void dpiJson__freePlan(dpiJsonPlanEntry *plan, uint16_t numEntries,
+        dpiError *error);
+int dpiJson__writeObject(dpiJsonWriter *writer, dpiObject *obj,
+        dpiError *error);
 
 
 //-----------------------------------------------------------------------------
@@ -916,7 +1333,10 @@ int32_t dpiVar__outBindCallback(dpiVar *var, void *bindp, uint32_t iter,
 //-----------------------------------------------------------------------------
 int dpiLob__allocate(dpiConn *conn, const dpiOracleType *type, dpiLob **lob,
         dpiError *error);
+int dpiLob__borrow(dpiObject *obj, const dpiOracleType *type, void *locator,
+        dpiLob **lob, dpiError *error);
 void dpiLob__free(dpiLob *lob, dpiError *error);
+int dpiLob__promote(dpiLob *lob, dpiError *error);
 int dpiLob__readBytes(dpiLob *lob, uint64_t offset, uint64_t amount,
         char *value, uint64_t *valueLength, dpiError *error);
 int dpiLob__setFromBytes(dpiLob *lob, const char *value, uint64_t valueLength,
@@ -955,6 +1375,36 @@ int dpiRowid__allocate(dpiConn *conn, dpiRowid **rowid, dpiError *error);
 void dpiRowid__free(dpiRowid *rowid, dpiError *error);
 
 
+//-----------------------------------------------------------------------------
+// definition of internal dpiSharedResult methods
+//-----------------------------------------------------------------------------
+int dpiSharedResult__addRows(dpiSharedResult *result, dpiVar **vars,
+        uint32_t numVars, uint32_t startPos, uint32_t numRows,
+        dpiError *error);
+int dpiSharedResult__allocate(dpiPool *pool, dpiSharedResult **result,
+        dpiError *error);
+void dpiSharedResult__free(dpiSharedResult *result, dpiError *error);
+int dpiSharedResult__setColumns(dpiSharedResult *result, uint32_t numColumns,
+        dpiQueryInfo *queryInfo, dpiError *error);
+
+
+//-----------------------------------------------------------------------------
+// definition of internal dpiRing methods
+//-----------------------------------------------------------------------------
+int dpiRing__exportRows(dpiRing *ring, dpiVar **vars, uint32_t numVars,
+        uint32_t firstRow, uint32_t *numRows, dpiError *error);
+
+
+//-----------------------------------------------------------------------------
+// definition of internal dpiTranscode methods
+//-----------------------------------------------------------------------------
+int dpiTranscode__convertRows(dpiVar *var, uint32_t numRows, dpiError *error);
+uint32_t dpiTranscode__narrowAscii(const uint16_t *source, uint32_t numChars,
+        char *target);
+uint32_t dpiTranscode__widenAscii(const char *source, uint32_t numChars,
+        uint16_t *target);
+
+
 //-----------------------------------------------------------------------------
 // definition of internal dpiSubscr methods
 //-----------------------------------------------------------------------------
@@ -1066,7 +1516,7 @@ int dpiOci__intervalSetDaySecond(dpiEnv *env, int32_t day, int32_t hour,
         dpiError *error);
 int dpiOci__intervalSetYearMonth(dpiEnv *env, int32_t year, int32_t month,
         void *interval, dpiError *error);
-int dpiOci__lobClose(dpiLob *lob, dpiError *error);
+int dpiOci__lobClose(dpiLob *lob, int checkError, dpiError *error);
 int dpiOci__lobCreateTemporary(dpiLob *lob, dpiError *error);
 int dpiOci__lobFileExists(dpiLob *lob, int *exists, dpiError *error);
 int dpiOci__lobFileGetName(dpiLob *lob, char *dirAlias,
@@ -1142,6 +1592,7 @@ int dpiOci__rawPtr(dpiEnv *env, void *handle, void **ptr);
 int dpiOci__rawResize(dpiEnv *env, void **handle, uint32_t newSize,
         dpiError *error);
 int dpiOci__rawSize(dpiEnv *env, void *handle, uint32_t *size);
+int dpiOci__reset(dpiConn *conn, dpiError *error);
 int dpiOci__rowidToChar(dpiRowid *rowid, char *buffer, uint16_t *bufferSize,
         dpiError *error);
 int dpiOci__serverAttach(dpiConn *conn, const char *connectString,
@@ -1152,7 +1603,7 @@ int dpiOci__serverRelease(dpiConn *conn, char *buffer, uint32_t bufferSize,
 int dpiOci__sessionBegin(dpiConn *conn, uint32_t credentialType,
         uint32_t mode, dpiError *error);
 int dpiOci__sessionEnd(dpiConn *conn, int checkError, dpiError *error);
-int dpiOci__sessionGet(dpiEnv *env, void **handle, void *authInfo,
+int dpiOci__sessionGet(dpiConn *conn, void *authInfo,
         const char *connectString, uint32_t connectStringLength,
         const char *tag, uint32_t tagLength, const char **outTag,
         uint32_t *outTagLength, int *found, uint32_t mode, dpiError *error);
@@ -1165,6 +1616,8 @@ int dpiOci__sessionPoolDestroy(dpiPool *pool, uint32_t mode, int checkError,
         dpiError *error);
 int dpiOci__sessionRelease(dpiConn *conn, const char *tag, uint32_t tagLength,
         uint32_t mode, int checkError, dpiError *error);
+int dpiOci__setInterposer(dpiEnv *env, const dpiInterposeParams *params,
+        dpiError *error);
 int dpiOci__stmtExecute(dpiStmt *stmt, uint32_t numIters, uint32_t mode,
         dpiError *error);
 int dpiOci__stmtFetch2(dpiStmt *stmt, uint32_t numRows, uint16_t fetchMode,
@@ -1197,6 +1650,10 @@ int dpiOci__tableNext(dpiObject *obj, int32_t index, int32_t *nextIndex,
 int dpiOci__tablePrev(dpiObject *obj, int32_t index, int32_t *prevIndex,
         int *exists, dpiError *error);
 int dpiOci__tableSize(dpiObject *obj, int32_t *size, dpiError *error);
+int dpiOci__threadCreate(dpiEnv *env, void (*start)(void*), void *arg,
+        void **threadId, void **threadHandle, dpiError *error);
+int dpiOci__threadJoin(dpiEnv *env, void *threadId, void *threadHandle,
+        dpiError *error);
 int dpiOci__threadKeyDestroy(dpiEnv *env, void *handle, dpiError *error);
 int dpiOci__threadKeyGet(dpiEnv *env, void **value, dpiError *error);
 int dpiOci__threadKeyInit(dpiEnv *env, void **handle, void *destroyFunc,
@@ -1224,10 +1681,16 @@ void dpiMsgProps__free(dpiMsgProps *props, dpiError *error);
 //-----------------------------------------------------------------------------
 // definition of internal dpiUtils methods
 //-----------------------------------------------------------------------------
+int dpiUtils__allocateBuffer(size_t length, dpiBufferMode mode, void **ptr,
+        size_t *mappedLength, dpiError *error);
 void dpiUtils__clearMemory(void *ptr, size_t length);
+void dpiUtils__freeBuffer(void *ptr, size_t mappedLength);
+int32_t dpiUtils__getBufferNode(const void *ptr);
 int dpiUtils__getAttrStringWithDup(const char *action, const void *ociHandle,
         uint32_t ociHandleType, uint32_t ociAttribute, const char **value,
         uint32_t *valueLength, dpiError *error);
+uint64_t dpiUtils__getMicroseconds(void);
+uint64_t dpiUtils__getMilliseconds(void);
 int dpiUtils__parseNumberString(const char *value, uint32_t valueLength,
         uint16_t charsetId, int *isNegative, int16_t *decimalPointIndex,
         uint8_t *numDigits, uint8_t *digits, dpiError *error);
@@ -1237,6 +1700,17 @@ int dpiUtils__parseOracleNumber(void *oracleValue, int *isNegative,
 int dpiUtils__setAttributesFromCommonCreateParams(void *handle,
         uint32_t handleType, const dpiCommonCreateParams *params,
         dpiError *error);
+void dpiUtils__sleep(uint32_t milliseconds);
+
+
+//-----------------------------------------------------------------------------
+// definition of internal dpiWatchdog methods
+//-----------------------------------------------------------------------------
+int dpiWatchdog__addEntry(dpiWatchdogEntry *entry, dpiConn *conn,
+        uint32_t timeout, dpiError *error);
+int dpiWatchdog__initialize(dpiEnv *env, dpiError *error);
+int dpiWatchdog__removeEntry(dpiWatchdogEntry *entry, int status,
+        dpiError *error);
 
 #endif
 
@@ -0,0 +1,696 @@
+//-----------------------------------------------------------------------------
+// Copyright (c) 2017 Oracle and/or its affiliates.  All rights reserved.
+// This program is free software: you can modify it and/or redistribute it
+// under the terms of:
+//
+// (i)  the Universal Permissive License v 1.0 or at your option, any
+//      later version (http://oss.oracle.com/licenses/upl); and/or
+//
+// (ii) the Apache License v 2.0. (http://www.apache.org/licenses/LICENSE-2.0)
+//-----------------------------------------------------------------------------
+
+//-----------------------------------------------------------------------------
+// dpiJson.c
+//   Implementation of serializing objects and collections as JSON. The object
+// instance and its indicator structure are walked directly using the OCI
+// attribute and element accessors; no ODPI-C handles are created for nested
+// objects, collections or LOBs. The attribute names and JSON keys for each
+// object type are computed once and cached on the object type.
+//-----------------------------------------------------------------------------
+
+#include "dpiImpl.h"
+
+// forward declarations of internal functions only used in this file
+static int dpiJson__write(dpiJsonWriter *writer, const char *data,
+        uint32_t dataLength, dpiError *error);
+static int dpiJson__writeInstance(dpiJsonWriter *writer,
+        dpiObjectType *objType, void *instance, void *indicator,
+        dpiError *error);
+static int dpiJson__writeString(dpiJsonWriter *writer, const char *value,
+        uint32_t valueLength, dpiError *error);
+static int dpiJson__writeValue(dpiJsonWriter *writer, dpiObjectType *objType,
+        const dpiDataTypeInfo *typeInfo, dpiOracleData *value,
+        void *indicator, dpiError *error);
+
+// characters used for base64 encoding of binary data
+static const char dpiJsonBase64Chars[] =
+        "ABCDEFGHIJKLMNOPQRSTUVWXYZabcdefghijklmnopqrstuvwxyz0123456789+/";
+
+// characters used for escaping control characters
+static const char dpiJsonHexChars[] = "0123456789abcdef";
+
+
+//-----------------------------------------------------------------------------
+// dpiJson__buildPlan() [INTERNAL]
+//   Build the plan used for serializing objects of the given type. This
+// consists of the name and type information of each attribute along with the
+// quoted and escaped key written for it. If another thread builds the plan at
+// the same time, the first one to complete is retained.
+//-----------------------------------------------------------------------------
+static int dpiJson__buildPlan(dpiObjectType *objType, dpiError *error)
+{
+    dpiJsonPlanEntry *plan, *entry;
+    dpiJsonBuffer keyBuffer;
+    dpiJsonWriter keyWriter;
+    dpiObjectAttr **attrs;
+    int status;
+    uint16_t i;
+
+    // acquire the attributes of the type
+    attrs = calloc(objType->numAttributes, sizeof(dpiObjectAttr*));
+    plan = calloc(objType->numAttributes, sizeof(dpiJsonPlanEntry));
+    if (!attrs || !plan) {
+        if (attrs)
+            free(attrs);
+        if (plan)
+            free(plan);
+        return dpiError__set(error, "allocate JSON plan", DPI_ERR_NO_MEMORY);
+    }
+    if (dpiObjectType_getAttributes(objType, objType->numAttributes,
+            attrs) < 0) {
+        free(attrs);
+        free(plan);
+        return DPI_FAILURE;
+    }
+
+    // populate the plan; the attributes themselves are not retained as they
+    // hold a reference to the type which would prevent it from being freed
+    status = DPI_SUCCESS;
+    memset(&keyWriter, 0, sizeof(keyWriter));
+    keyWriter.buffer = &keyBuffer;
+    for (i = 0; i < objType->numAttributes && status == DPI_SUCCESS; i++) {
+        entry = &plan[i];
+        memset(&keyBuffer, 0, sizeof(keyBuffer));
+        entry->name = malloc(attrs[i]->nameLength);
+        if (!entry->name) {
+            status = dpiError__set(error, "allocate name", DPI_ERR_NO_MEMORY);
+            break;
+        }
+        memcpy(entry->name, attrs[i]->name, attrs[i]->nameLength);
+        entry->nameLength = attrs[i]->nameLength;
+        entry->typeInfo = attrs[i]->typeInfo;
+        if (entry->typeInfo.objectType)
+            dpiGen__setRefCount(entry->typeInfo.objectType, error, 1);
+        status = dpiJson__writeString(&keyWriter, attrs[i]->name,
+                attrs[i]->nameLength, error);
+        if (status == DPI_SUCCESS)
+            status = dpiJson__write(&keyWriter, ":", 1, error);
+        entry->key = keyBuffer.ptr;
+        entry->keyLength = keyBuffer.length;
+    }
+    for (i = 0; i < objType->numAttributes; i++)
+        dpiGen__setRefCount(attrs[i], error, -1);
+    free(attrs);
+    if (status < 0) {
+        dpiJson__freePlan(plan, objType->numAttributes, error);
+        return DPI_FAILURE;
+    }
+
+    // install the plan on the type
+    if (objType->env->threaded &&
+            dpiOci__threadMutexAcquire(objType->env, error) < 0) {
+        dpiJson__freePlan(plan, objType->numAttributes, error);
+        return DPI_FAILURE;
+    }
+    if (!objType->jsonPlan) {
+        objType->jsonPlan = plan;
+        plan = NULL;
+    }
+    if (objType->env->threaded)
+        dpiOci__threadMutexRelease(objType->env, error);
+    if (plan)
+        dpiJson__freePlan(plan, objType->numAttributes, error);
+
+    return DPI_SUCCESS;
+}
+
+
+//-----------------------------------------------------------------------------
+// dpiJson__checkCharset() [INTERNAL]
+//   Check that character data in the given character set can be written to
+// JSON without conversion.
+//-----------------------------------------------------------------------------
+static int dpiJson__checkCharset(uint16_t charsetId, dpiError *error)
+{
+    if (charsetId != DPI_CHARSET_ID_UTF8 && charsetId != DPI_CHARSET_ID_ASCII)
+        return dpiError__set(error, "check JSON charset",
+                DPI_ERR_NOT_SUPPORTED);
+    return DPI_SUCCESS;
+}
+
+
+//-----------------------------------------------------------------------------
+// dpiJson__flush() [INTERNAL]
+//   Pass any data staged in the writer to the write callback.
+//-----------------------------------------------------------------------------
+static int dpiJson__flush(dpiJsonWriter *writer, dpiError *error)
+{
+    uint32_t chunkLength;
+
+    if (writer->buffer || writer->chunkLength == 0)
+        return DPI_SUCCESS;
+    chunkLength = writer->chunkLength;
+    writer->chunkLength = 0;
+    if ((*writer->callback)(writer->callbackContext, writer->chunk,
+            chunkLength) < 0)
+        return dpiError__set(error, "write JSON", DPI_ERR_JSON_WRITE_ABORTED);
+    return DPI_SUCCESS;
+}
+
+
+//-----------------------------------------------------------------------------
+// dpiJson__freePlan() [INTERNAL]
+//   Free the plan used for serializing objects of a particular type.
+//-----------------------------------------------------------------------------
+void dpiJson__freePlan(dpiJsonPlanEntry *plan, uint16_t numEntries,
+        dpiError *error)
+{
+    dpiJsonPlanEntry *entry;
+    uint16_t i;
+
+    for (i = 0; i < numEntries; i++) {
+        entry = &plan[i];
+        if (entry->name)
+            free(entry->name);
+        if (entry->key)
+            free(entry->key);
+        if (entry->typeInfo.objectType)
+            dpiGen__setRefCount(entry->typeInfo.objectType, error, -1);
+    }
+    free(plan);
+}
+
+
+//-----------------------------------------------------------------------------
+// dpiJson__write() [INTERNAL]
+//   Write data to the buffer or stage it for the write callback. Buffers are
+// grown as needed and always have space for a terminating null character.
+// Data larger than the staging area is passed through to the callback
+// directly.
+//-----------------------------------------------------------------------------
+static int dpiJson__write(dpiJsonWriter *writer, const char *data,
+        uint32_t dataLength, dpiError *error)
+{
+    dpiJsonBuffer *buffer = writer->buffer;
+    uint64_t allocatedLength;
+    char *ptr;
+
+    // write to buffer, if applicable
+    if (buffer) {
+        if ((uint64_t) buffer->length + dataLength >= buffer->allocatedLength) {
+            allocatedLength = (buffer->allocatedLength > 0) ?
+                    buffer->allocatedLength : DPI_JSON_CHUNK_SIZE;
+            while (allocatedLength <= (uint64_t) buffer->length + dataLength)
+                allocatedLength *= 2;
+            if (allocatedLength > UINT_MAX)
+                return dpiError__set(error, "check JSON buffer size",
+                        DPI_ERR_NOT_SUPPORTED);
+            ptr = realloc(buffer->ptr, (size_t) allocatedLength);
+            if (!ptr)
+                return dpiError__set(error, "allocate JSON buffer",
+                        DPI_ERR_NO_MEMORY);
+            buffer->ptr = ptr;
+            buffer->allocatedLength = (uint32_t) allocatedLength;
+        }
+        memcpy(buffer->ptr + buffer->length, data, dataLength);
+        buffer->length += dataLength;
+        buffer->ptr[buffer->length] = '\0';
+        return DPI_SUCCESS;
+    }
+
+    // otherwise, stage the data for the callback
+    if (writer->chunkLength + dataLength > DPI_JSON_CHUNK_SIZE) {
+        if (dpiJson__flush(writer, error) < 0)
+            return DPI_FAILURE;
+        if (dataLength > DPI_JSON_CHUNK_SIZE) {
+            if ((*writer->callback)(writer->callbackContext, data,
+                    dataLength) < 0)
+                return dpiError__set(error, "write JSON",
+                        DPI_ERR_JSON_WRITE_ABORTED);
+            return DPI_SUCCESS;
+        }
+    }
+    memcpy(writer->chunk + writer->chunkLength, data, dataLength);
+    writer->chunkLength += dataLength;
+    return DPI_SUCCESS;
+}
+
+
+//-----------------------------------------------------------------------------
+// dpiJson__writeBase64() [INTERNAL]
+//   Write binary data as a base64 encoded JSON string.
+//-----------------------------------------------------------------------------
+static int dpiJson__writeBase64(dpiJsonWriter *writer,
+        const unsigned char *value, uint64_t valueLength, dpiError *error)
+{
+    uint32_t outLength, group;
+    char out[256];
+    uint64_t i;
+
+    out[0] = '"';
+    outLength = 1;
+    for (i = 0; i < valueLength; i += 3) {
+        group = (uint32_t) value[i] << 16;
+        if (i + 1 < valueLength)
+            group |= (uint32_t) value[i + 1] << 8;
+        if (i + 2 < valueLength)
+            group |= value[i + 2];
+        out[outLength++] = dpiJsonBase64Chars[(group >> 18) & 0x3f];
+        out[outLength++] = dpiJsonBase64Chars[(group >> 12) & 0x3f];
+        out[outLength++] = (i + 1 < valueLength) ?
+                dpiJsonBase64Chars[(group >> 6) & 0x3f] : '=';
+        out[outLength++] = (i + 2 < valueLength) ?
+                dpiJsonBase64Chars[group & 0x3f] : '=';
+        if (outLength > sizeof(out) - 4) {
+            if (dpiJson__write(writer, out, outLength, error) < 0)
+                return DPI_FAILURE;
+            outLength = 0;
+        }
+    }
+    out[outLength++] = '"';
+    return dpiJson__write(writer, out, outLength, error);
+}
+
+
+//-----------------------------------------------------------------------------
+// dpiJson__writeCollection() [INTERNAL]
+//   Write the elements of a collection as a JSON array.
+//-----------------------------------------------------------------------------
+static int dpiJson__writeCollection(dpiJsonWriter *writer,
+        dpiObjectType *objType, void *instance, dpiError *error)
+{
+    void *elementIndicator;
+    dpiOracleData value;
+    int32_t index, size;
+    dpiObject tempObj;
+    int exists, first;
+
+    // the OCI table functions expect an object; one is populated on the stack
+    // so that no handle needs to be allocated
+    memset(&tempObj, 0, sizeof(tempObj));
+    tempObj.env = objType->env;
+    tempObj.type = objType;
+    tempObj.instance = instance;
+
+    // write each of the elements
+    if (dpiJson__write(writer, "[", 1, error) < 0)
+        return DPI_FAILURE;
+    if (dpiOci__tableSize(&tempObj, &size, error) < 0)
+        return DPI_FAILURE;
+    exists = (size != 0);
+    if (exists && dpiOci__tableFirst(&tempObj, &index, error) < 0)
+        return DPI_FAILURE;
+    for (first = 1; exists; first = 0) {
+        if (!first && dpiJson__write(writer, ",", 1, error) < 0)
+            return DPI_FAILURE;
+        if (dpiOci__collGetElem(objType->conn, instance, index, &exists,
+                &value.asRaw, &elementIndicator, error) < 0)
+            return DPI_FAILURE;
+        if (dpiJson__writeValue(writer, objType, &objType->elementTypeInfo,
+                &value, elementIndicator, error) < 0)
+            return DPI_FAILURE;
+        if (dpiOci__tableNext(&tempObj, index, &index, &exists, error) < 0)
+            return DPI_FAILURE;
+    }
+    return dpiJson__write(writer, "]", 1, error);
+}
+
+
+//-----------------------------------------------------------------------------
+// dpiJson__writeDouble() [INTERNAL]
+//   Write a floating point number. Values that cannot be represented in JSON
+// (infinity and NaN) are written as null.
+//-----------------------------------------------------------------------------
+static int dpiJson__writeDouble(dpiJsonWriter *writer, double value,
+        int precision, dpiError *error)
+{
+    char buffer[32];
+    int length;
+
+    if (value - value != 0)
+        return dpiJson__write(writer, "null", 4, error);
+    length = snprintf(buffer, sizeof(buffer), "%.*g", precision, value);
+    return dpiJson__write(writer, buffer, (uint32_t) length, error);
+}
+
+
+//-----------------------------------------------------------------------------
+// dpiJson__writeInstance() [INTERNAL]
+//   Write an object instance (or collection) as JSON. Objects are written as
+// JSON objects with a key for each attribute and collections are written as
+// JSON arrays. Atomically null instances are written as null.
+//-----------------------------------------------------------------------------
+static int dpiJson__writeInstance(dpiJsonWriter *writer,
+        dpiObjectType *objType, void *instance, void *indicator,
+        dpiError *error)
+{
+    void *valueIndicator, *tdo;
+    int16_t scalarValueIndicator;
+    dpiJsonPlanEntry *entry;
+    dpiOracleData value;
+    dpiObjectAttr attr;
+    dpiObject tempObj;
+    uint16_t i;
+
+    // handle null instances and collections
+    if (!instance || (indicator && *((int16_t*) indicator) == DPI_OCI_IND_NULL))
+        return dpiJson__write(writer, "null", 4, error);
+    if (objType->isCollection)
+        return dpiJson__writeCollection(writer, objType, instance, error);
+
+    // build the plan for the type, if needed
+    if (!objType->jsonPlan && dpiJson__buildPlan(objType, error) < 0)
+        return DPI_FAILURE;
+
+    // the OCI attribute functions expect an object and an attribute; these
+    // are populated on the stack so that no handles need to be allocated
+    memset(&tempObj, 0, sizeof(tempObj));
+    tempObj.env = objType->env;
+    tempObj.type = objType;
+    tempObj.instance = instance;
+    tempObj.indicator = indicator;
+    memset(&attr, 0, sizeof(attr));
+
+    // write each of the attributes
+    if (dpiJson__write(writer, "{", 1, error) < 0)
+        return DPI_FAILURE;
+    for (i = 0; i < objType->numAttributes; i++) {
+        entry = &objType->jsonPlan[i];
+        if (i > 0 && dpiJson__write(writer, ",", 1, error) < 0)
+            return DPI_FAILURE;
+        if (dpiJson__write(writer, entry->key, entry->keyLength, error) < 0)
+            return DPI_FAILURE;
+        attr.name = entry->name;
+        attr.nameLength = entry->nameLength;
+        if (dpiOci__objectGetAttr(&tempObj, &attr, &scalarValueIndicator,
+                &valueIndicator, &value.asRaw, &tdo, error) < 0)
+            return DPI_FAILURE;
+        if (!valueIndicator)
+            valueIndicator = &scalarValueIndicator;
+        if (dpiJson__writeValue(writer, objType, &entry->typeInfo, &value,
+                valueIndicator, error) < 0)
+            return DPI_FAILURE;
+    }
+    return dpiJson__write(writer, "}", 1, error);
+}
+
+
+//-----------------------------------------------------------------------------
+// dpiJson__writeLob() [INTERNAL]
+//   Write the contents of a LOB. Character LOBs are written as JSON strings
+// and binary LOBs as base64 encoded JSON strings. The locator is owned by the
+// object so a LOB is populated on the stack rather than allocated.
+//-----------------------------------------------------------------------------
+static int dpiJson__writeLob(dpiJsonWriter *writer, dpiObjectType *objType,
+        const dpiDataTypeInfo *typeInfo, void *locator, dpiError *error)
+{
+    uint64_t length, lengthInBytes;
+    char *buffer;
+    dpiLob lob;
+    int status;
+
+    // populate the LOB structure
+    memset(&lob, 0, sizeof(lob));
+    lob.env = objType->env;
+    lob.conn = objType->conn;
+    lob.locator = locator;
+    lob.type = dpiOracleType__getFromNum(typeInfo->oracleTypeNum, error);
+    if (!lob.type)
+        return DPI_FAILURE;
+
+    // determine length of LOB in bytes
+    if (dpiOci__lobGetLength2(&lob, &length, error) < 0)
+        return DPI_FAILURE;
+    if (typeInfo->oracleTypeNum == DPI_ORACLE_TYPE_CLOB) {
+        if (dpiJson__checkCharset(lob.env->charsetId, error) < 0)
+            return DPI_FAILURE;
+        lengthInBytes = length * lob.env->maxBytesPerCharacter;
+    } else if (typeInfo->oracleTypeNum == DPI_ORACLE_TYPE_NCLOB) {
+        if (dpiJson__checkCharset(lob.env->ncharsetId, error) < 0)
+            return DPI_FAILURE;
+        lengthInBytes = length * lob.env->nmaxBytesPerCharacter;
+    } else lengthInBytes = length;
+    if (lengthInBytes > UINT_MAX)
+        return dpiError__set(error, "check max length", DPI_ERR_NOT_SUPPORTED);
+
+    // read the contents of the LOB
+    buffer = malloc((size_t) lengthInBytes + 1);
+    if (!buffer)
+        return dpiError__set(error, "allocate LOB buffer", DPI_ERR_NO_MEMORY);
+    if (length > 0 && dpiLob__readBytes(&lob, 1, length, buffer,
+            &lengthInBytes, error) < 0) {
+        free(buffer);
+        return DPI_FAILURE;
+    }
+    if (length == 0)
+        lengthInBytes = 0;
+
+    // write the contents
+    if (lob.type->isCharacterData)
+        status = dpiJson__writeString(writer, buffer,
+                (uint32_t) lengthInBytes, error);
+    else status = dpiJson__writeBase64(writer, (unsigned char*) buffer,
+            lengthInBytes, error);
+    free(buffer);
+    return status;
+}
+
+
+//-----------------------------------------------------------------------------
+// dpiJson__writeNumber() [INTERNAL]
+//   Write an Oracle number. The number is converted directly from its internal
+// representation so that no precision is lost.
+//-----------------------------------------------------------------------------
+static int dpiJson__writeNumber(dpiJsonWriter *writer, void *oracleValue,
+        dpiError *error)
+{
+    uint8_t numDigits, digits[DPI_NUMBER_MAX_DIGITS];
+    char buffer[DPI_NUMBER_AS_TEXT_CHARS];
+    int16_t decimalPointIndex, i;
+    uint32_t length = 0;
+    int isNegative;
+
+    // parse the OCINumber structure
+    if (dpiUtils__parseOracleNumber(oracleValue, &isNegative,
+            &decimalPointIndex, &numDigits, digits, error) < 0)
+        return DPI_FAILURE;
+
+    // if negative, include the sign
+    if (isNegative)
+        buffer[length++] = '-';
+
+    // if the decimal point index is 0 or less, add the decimal point and any
+    // leading zeroes that are needed
+    if (decimalPointIndex <= 0) {
+        buffer[length++] = '0';
+        buffer[length++] = '.';
+        for (; decimalPointIndex < 0; decimalPointIndex++)
+            buffer[length++] = '0';
+    }
+
+    // add each of the digits
+    for (i = 0; i < numDigits; i++) {
+        if (i > 0 && i == decimalPointIndex)
+            buffer[length++] = '.';
+        buffer[length++] = '0' + digits[i];
+    }
+
+    // if the decimal point index exceeds the number of digits, add any
+    // trailing zeroes that are needed
+    for (i = numDigits; i < decimalPointIndex; i++)
+        buffer[length++] = '0';
+
+    return dpiJson__write(writer, buffer, length, error);
+}
+
+
+//-----------------------------------------------------------------------------
+// dpiJson__writeObject() [INTERNAL]
+//   Write the object as JSON and flush any data staged for the callback.
+//-----------------------------------------------------------------------------
+int dpiJson__writeObject(dpiJsonWriter *writer, dpiObject *obj,
+        dpiError *error)
+{
+    if (dpiJson__writeInstance(writer, obj->type, obj->instance,
+            obj->indicator, error) < 0)
+        return DPI_FAILURE;
+    return dpiJson__flush(writer, error);
+}
+
+
+//-----------------------------------------------------------------------------
+// dpiJson__writeString() [INTERNAL]
+//   Write a quoted JSON string, escaping characters as required. The value is
+// assumed to be encoded in UTF-8 already.
+//-----------------------------------------------------------------------------
+static int dpiJson__writeString(dpiJsonWriter *writer, const char *value,
+        uint32_t valueLength, dpiError *error)
+{
+    uint32_t i, runStart, escapeLength;
+    char escape[6];
+    unsigned char c;
+
+    if (dpiJson__write(writer, "\"", 1, error) < 0)
+        return DPI_FAILURE;
+    for (i = 0, runStart = 0; i < valueLength; i++) {
+        c = (unsigned char) value[i];
+        if (c >= 0x20 && c != '"' && c != '\\')
+            continue;
+        if (i > runStart && dpiJson__write(writer, value + runStart,
+                i - runStart, error) < 0)
+            return DPI_FAILURE;
+        runStart = i + 1;
+        escape[0] = '\\';
+        escapeLength = 2;
+        switch (c) {
+            case '"':
+            case '\\':
+                escape[1] = (char) c;
+                break;
+            case '\b':
+                escape[1] = 'b';
+                break;
+            case '\f':
+                escape[1] = 'f';
+                break;
+            case '\n':
+                escape[1] = 'n';
+                break;
+            case '\r':
+                escape[1] = 'r';
+                break;
+            case '\t':
+                escape[1] = 't';
+                break;
+            default:
+                escape[1] = 'u';
+                escape[2] = '0';
+                escape[3] = '0';
+                escape[4] = dpiJsonHexChars[c >> 4];
+                escape[5] = dpiJsonHexChars[c & 0x0f];
+                escapeLength = 6;
+                break;
+        }
+        if (dpiJson__write(writer, escape, escapeLength, error) < 0)
+            return DPI_FAILURE;
+    }
+    if (i > runStart && dpiJson__write(writer, value + runStart,
+            i - runStart, error) < 0)
+        return DPI_FAILURE;
+    return dpiJson__write(writer, "\"", 1, error);
+}
+
+
+//-----------------------------------------------------------------------------
+// dpiJson__writeTimestamp() [INTERNAL]
+//   Write a date or timestamp as an ISO 8601 JSON string. Fractional seconds
+// are included only if non-zero and the time zone only if requested.
+//-----------------------------------------------------------------------------
+static int dpiJson__writeTimestamp(dpiJsonWriter *writer,
+        dpiTimestamp *timestamp, int withTZ, dpiError *error)
+{
+    int length, tzHourOffset, tzMinuteOffset;
+    uint32_t fsecond;
+    char buffer[64];
+
+    length = snprintf(buffer, sizeof(buffer),
+            "\"%.4d-%.2d-%.2dT%.2d:%.2d:%.2d", timestamp->year,
+            timestamp->month, timestamp->day, timestamp->hour,
+            timestamp->minute, timestamp->second);
+    if (timestamp->fsecond > 0) {
+        fsecond = timestamp->fsecond;
+        length += snprintf(buffer + length, sizeof(buffer) - length, ".%.9u",
+                fsecond);
+        while (buffer[length - 1] == '0')
+            length--;
+    }
+    if (withTZ) {
+        tzHourOffset = timestamp->tzHourOffset;
+        tzMinuteOffset = timestamp->tzMinuteOffset;
+        buffer[length++] = (tzHourOffset < 0 || tzMinuteOffset < 0) ?
+                '-' : '+';
+        length += snprintf(buffer + length, sizeof(buffer) - length,
+                "%.2d:%.2d", abs(tzHourOffset), abs(tzMinuteOffset));
+    }
+    buffer[length++] = '"';
+    return dpiJson__write(writer, buffer, (uint32_t) length, error);
+}
+
+
+//-----------------------------------------------------------------------------
+// dpiJson__writeValue() [INTERNAL]
+//   Write an attribute value or collection element as JSON.
+//-----------------------------------------------------------------------------
+static int dpiJson__writeValue(dpiJsonWriter *writer, dpiObjectType *objType,
+        const dpiDataTypeInfo *typeInfo, dpiOracleData *value,
+        void *indicator, dpiError *error)
+{
+    dpiOracleTypeNum oracleTypeNum;
+    uint32_t length;
+    dpiData data;
+    char *ptr;
+
+    // null values are written as such (type is irrelevant)
+    if (*((int16_t*) indicator) == DPI_OCI_IND_NULL)
+        return dpiJson__write(writer, "null", 4, error);
+
+    // write all other values
+    oracleTypeNum = typeInfo->oracleTypeNum;
+    switch (oracleTypeNum) {
+        case DPI_ORACLE_TYPE_CHAR:
+        case DPI_ORACLE_TYPE_VARCHAR:
+        case DPI_ORACLE_TYPE_NCHAR:
+        case DPI_ORACLE_TYPE_NVARCHAR:
+            if (dpiJson__checkCharset((oracleTypeNum == DPI_ORACLE_TYPE_CHAR ||
+                    oracleTypeNum == DPI_ORACLE_TYPE_VARCHAR) ?
+                    objType->env->charsetId : objType->env->ncharsetId,
+                    error) < 0)
+                return DPI_FAILURE;
+            dpiOci__stringPtr(objType->env, *value->asString, &ptr);
+            dpiOci__stringSize(objType->env, *value->asString, &length);
+            return dpiJson__writeString(writer, ptr, length, error);
+        case DPI_ORACLE_TYPE_NATIVE_INT:
+        case DPI_ORACLE_TYPE_NUMBER:
+            return dpiJson__writeNumber(writer, value->asNumber, error);
+        case DPI_ORACLE_TYPE_NATIVE_FLOAT:
+            return dpiJson__writeDouble(writer, *value->asFloat, 9, error);
+        case DPI_ORACLE_TYPE_NATIVE_DOUBLE:
+            return dpiJson__writeDouble(writer, *value->asDouble, 17, error);
+        case DPI_ORACLE_TYPE_DATE:
+            dpiData__fromOracleDate(&data, value->asDate);
+            return dpiJson__writeTimestamp(writer, &data.value.asTimestamp, 0,
+                    error);
+        case DPI_ORACLE_TYPE_TIMESTAMP:
+        case DPI_ORACLE_TYPE_TIMESTAMP_TZ:
+        case DPI_ORACLE_TYPE_TIMESTAMP_LTZ:
+            if (dpiData__fromOracleTimestamp(&data, objType->env, error,
+                    *value->asTimestamp,
+                    oracleTypeNum != DPI_ORACLE_TYPE_TIMESTAMP) < 0)
+                return DPI_FAILURE;
+            return dpiJson__writeTimestamp(writer, &data.value.asTimestamp,
+                    oracleTypeNum != DPI_ORACLE_TYPE_TIMESTAMP, error);
+        case DPI_ORACLE_TYPE_BOOLEAN:
+            if (*value->asBoolean)
+                return dpiJson__write(writer, "true", 4, error);
+            return dpiJson__write(writer, "false", 5, error);
+        case DPI_ORACLE_TYPE_CLOB:
+        case DPI_ORACLE_TYPE_NCLOB:
+        case DPI_ORACLE_TYPE_BLOB:
+            return dpiJson__writeLob(writer, objType, typeInfo,
+                    *value->asLobLocator, error);
+        case DPI_ORACLE_TYPE_OBJECT:
+            if (!typeInfo->objectType)
+                break;
+            if (typeInfo->objectType->isCollection)
+                return dpiJson__writeInstance(writer, typeInfo->objectType,
+                        *value->asCollection, indicator, error);
+            return dpiJson__writeInstance(writer, typeInfo->objectType,
+                    value->asRaw, indicator, error);
+        default:
+            break;
+    }
+
+    return dpiError__set(error, "write JSON value",
+            DPI_ERR_UNHANDLED_DATA_TYPE, typeInfo->ociTypeCode);
+}
+
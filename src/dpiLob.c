@@ -14,8 +14,24 @@
 //   Implementation of LOB data.
 //-----------------------------------------------------------------------------
 
+#ifdef _WIN32
+#include <io.h>
+#else
+#if defined(__linux__) && !defined(_GNU_SOURCE)
+#define _GNU_SOURCE
+#endif
+#include <unistd.h>
+#include <fcntl.h>
+#endif
+#include <errno.h>
 #include "dpiImpl.h"
 
+// forward declarations of internal functions only used in this file
+static int dpiLob__startFileTransfer(dpiLobTransfer *transfer,
+        dpiError *error);
+static void dpiLob__transferFile(void *arg);
+
+
 //-----------------------------------------------------------------------------
 // dpiLob__allocate() [INTERNAL]
 //   Allocate and initialize LOB object.
@@ -51,6 +67,45 @@ int dpiLob__allocate(dpiConn *conn, const dpiOracleType *type, dpiLob **lob,
 }
 
 
+//-----------------------------------------------------------------------------
+// dpiLob__borrow() [INTERNAL]
+//   Return a LOB which refers to a locator owned by an object (an attribute
+// value or collection element). No descriptor is allocated and no reference
+// to the connection is held; instead the LOB is cached on the object, keyed
+// by the locator, and returned again each time the same attribute value or
+// collection element is retrieved. The LOB remains owned by the object until
+// dpiLob__promote() is called.
+//-----------------------------------------------------------------------------
+int dpiLob__borrow(dpiObject *obj, const dpiOracleType *type, void *locator,
+        dpiLob **lob, dpiError *error)
+{
+    dpiLob *tempLob;
+
+    // return the LOB already borrowed for this locator, if one exists
+    for (tempLob = obj->borrowedLobs; tempLob;
+            tempLob = tempLob->nextBorrowed) {
+        if (tempLob->locator == locator) {
+            *lob = tempLob;
+            return DPI_SUCCESS;
+        }
+    }
+
+    // otherwise, allocate a new one and add it to the list on the object
+    if (dpiGen__allocate(DPI_HTYPE_LOB, obj->env, (void**) &tempLob,
+            error) < 0)
+        return DPI_FAILURE;
+    tempLob->conn = obj->type->conn;
+    tempLob->type = type;
+    tempLob->locator = locator;
+    tempLob->borrowedFrom = obj;
+    tempLob->nextBorrowed = obj->borrowedLobs;
+    obj->borrowedLobs = tempLob;
+
+    *lob = tempLob;
+    return DPI_SUCCESS;
+}
+
+
 //-----------------------------------------------------------------------------
 // dpiLob__check() [INTERNAL]
 //   Check that the LOB is valid and get an error handle for subsequent calls.
@@ -75,6 +130,10 @@ static int dpiLob__close(dpiLob *lob, int propagateErrors, dpiError *error)
 {
     int isTemporary;
 
+    // borrowed LOBs do not own their locator or hold a connection reference
+    if (lob->borrowedFrom)
+        lob->locator = NULL;
+
     if (lob->locator) {
         if (dpiOci__lobIsTemporary(lob, &isTemporary, propagateErrors,
                 error) < 0)
@@ -87,7 +146,7 @@ static int dpiLob__close(dpiLob *lob, int propagateErrors, dpiError *error)
         lob->locator = NULL;
         dpiConn__decrementOpenChildCount(lob->conn, error);
     }
-    if (lob->conn) {
+    if (lob->conn && !lob->borrowedFrom) {
         dpiGen__setRefCount(lob->conn, error, -1);
         lob->conn = NULL;
     }
@@ -100,6 +159,33 @@ static int dpiLob__close(dpiLob *lob, int propagateErrors, dpiError *error)
 }
 
 
+//-----------------------------------------------------------------------------
+// dpiLob__finishFileTransfer() [INTERNAL]
+//   Wait for the file I/O started by dpiLob__startFileTransfer() to complete.
+// If no thread was started (because the environment is not threaded), the
+// file I/O is performed now instead, unless errors are not being propagated
+// because the LOB operation it would have overlapped has already failed.
+//-----------------------------------------------------------------------------
+static int dpiLob__finishFileTransfer(dpiLobTransfer *transfer,
+        int propagateErrors, dpiError *error)
+{
+    if (transfer->threadHandle) {
+        if (dpiOci__threadJoin(transfer->env, transfer->threadId,
+                transfer->threadHandle, error) < 0)
+            return DPI_FAILURE;
+        transfer->threadId = NULL;
+        transfer->threadHandle = NULL;
+    } else if (propagateErrors) {
+        dpiLob__transferFile(transfer);
+    }
+    if (propagateErrors && transfer->osError != 0)
+        return dpiError__set(error, "transfer file", DPI_ERR_FILE_IO,
+                (transfer->readFromFile) ? "read" : "write",
+                transfer->osError);
+    return DPI_SUCCESS;
+}
+
+
 //-----------------------------------------------------------------------------
 // dpiLob__free() [INTERNAL]
 //   Free the memory for a LOB.
@@ -111,6 +197,230 @@ void dpiLob__free(dpiLob *lob, dpiError *error)
 }
 
 
+//-----------------------------------------------------------------------------
+// dpiLob__freeTransfer() [INTERNAL]
+//   Free the buffers used by a transfer between a LOB and a file and restore
+// the flags of the file descriptor if direct I/O was enabled.
+//-----------------------------------------------------------------------------
+static void dpiLob__freeTransfer(dpiLobTransfer *transfer)
+{
+#ifdef O_DIRECT
+    if (transfer->isDirect)
+        fcntl(transfer->fd, F_SETFL, transfer->originalFlags);
+#endif
+    free(transfer->allocatedBuffer);
+}
+
+
+//-----------------------------------------------------------------------------
+// dpiLob__initTransfer() [INTERNAL]
+//   Prepare for a transfer between a binary LOB and a file. Data is
+// transferred in blocks which are a multiple of the LOB chunk size; if direct
+// I/O is requested, they must also be a multiple of the page size and are
+// placed in page aligned buffers. Two buffers are allocated so that file I/O
+// on one can overlap the LOB operation on the other. The kernel is advised
+// that the file will be accessed sequentially.
+//-----------------------------------------------------------------------------
+static int dpiLob__initTransfer(dpiLob *lob, int fd, dpiLobTransferMode mode,
+        int readFromFile, dpiLobTransfer *transfer, dpiError *error)
+{
+    uint32_t chunkSize, alignedSize, divisor, remainder, temp;
+
+    // character LOBs would require the file contents to be converted
+    if (lob->type->isCharacterData)
+        return dpiError__set(error, "check LOB type",
+                DPI_ERR_LOB_TRANSFER_NOT_BINARY);
+    memset(transfer, 0, sizeof(dpiLobTransfer));
+    transfer->env = lob->env;
+    transfer->fd = fd;
+    transfer->readFromFile = readFromFile;
+    transfer->fileOffset = -1;
+
+    // determine the chunk size; BFILEs do not have one
+    chunkSize = DPI_BASE_PAGE_SIZE;
+    if (lob->type->oracleTypeNum != DPI_ORACLE_TYPE_BFILE) {
+        if (dpiOci__lobGetChunkSize(lob, &chunkSize, error) < 0)
+            return DPI_FAILURE;
+        if (chunkSize == 0)
+            chunkSize = DPI_BASE_PAGE_SIZE;
+    }
+
+    // direct I/O needs blocks that are a multiple of both the chunk size and
+    // the page size; if the least common multiple is too large, direct I/O is
+    // not used
+    alignedSize = chunkSize;
+    if (mode & DPI_MODE_LOB_TRANSFER_DIRECT) {
+        divisor = chunkSize;
+        remainder = DPI_BASE_PAGE_SIZE;
+        while (remainder > 0) {
+            temp = divisor % remainder;
+            divisor = remainder;
+            remainder = temp;
+        }
+        if (chunkSize / divisor <=
+                DPI_LOB_TRANSFER_MAX_BLOCK_SIZE / DPI_BASE_PAGE_SIZE)
+            alignedSize = chunkSize / divisor * DPI_BASE_PAGE_SIZE;
+        else mode &= ~DPI_MODE_LOB_TRANSFER_DIRECT;
+    }
+    transfer->mode = mode;
+    transfer->blockSize = alignedSize * ((DPI_LOB_TRANSFER_BLOCK_SIZE +
+            alignedSize - 1) / alignedSize);
+
+    // allocate the two buffers
+    transfer->allocatedBuffer = malloc(2 * (size_t) transfer->blockSize +
+            DPI_BASE_PAGE_SIZE);
+    if (!transfer->allocatedBuffer)
+        return dpiError__set(error, "allocate transfer buffers",
+                DPI_ERR_NO_MEMORY);
+    transfer->buffers[0] = (char*) (((uintptr_t) transfer->allocatedBuffer +
+            DPI_BASE_PAGE_SIZE - 1) & ~((uintptr_t) DPI_BASE_PAGE_SIZE - 1));
+    transfer->buffers[1] = transfer->buffers[0] + transfer->blockSize;
+
+    // the file offset is only known for files that support seeking; direct
+    // I/O also requires it to be page aligned
+#ifndef _WIN32
+    transfer->fileOffset = (int64_t) lseek(fd, 0, SEEK_CUR);
+#ifdef POSIX_FADV_SEQUENTIAL
+    if (transfer->fileOffset >= 0)
+        posix_fadvise(fd, transfer->fileOffset, 0, POSIX_FADV_SEQUENTIAL);
+#endif
+#ifdef O_DIRECT
+    if ((mode & DPI_MODE_LOB_TRANSFER_DIRECT) && transfer->fileOffset >= 0 &&
+            transfer->fileOffset % DPI_BASE_PAGE_SIZE == 0) {
+        transfer->originalFlags = fcntl(fd, F_GETFL);
+        if (transfer->originalFlags >= 0 && fcntl(fd, F_SETFL,
+                transfer->originalFlags | O_DIRECT) == 0)
+            transfer->isDirect = 1;
+    }
+#endif
+#endif
+
+    return DPI_SUCCESS;
+}
+
+
+//-----------------------------------------------------------------------------
+// dpiLob__promote() [INTERNAL]
+//   Promote a borrowed LOB to an independent one by copying the locator into
+// a newly allocated descriptor and acquiring a reference to the connection.
+// The LOB is removed from the list cached on the object; the reference it
+// held now belongs to the caller that retrieved the LOB, which is expected to
+// release it in the same way as any other LOB. LOBs that are not borrowed are
+// left untouched.
+//-----------------------------------------------------------------------------
+int dpiLob__promote(dpiLob *lob, dpiError *error)
+{
+    dpiLob **link;
+    void *locator;
+
+    if (!lob->borrowedFrom)
+        return DPI_SUCCESS;
+    if (!lob->locator)
+        return dpiError__set(error, "check closed", DPI_ERR_LOB_CLOSED);
+    if (dpiOci__descriptorAlloc(lob->env, &locator, DPI_OCI_DTYPE_LOB,
+            "allocate descriptor", error) < 0)
+        return DPI_FAILURE;
+    if (dpiOci__lobLocatorAssign(lob, &locator, error) < 0) {
+        dpiOci__descriptorFree(locator, DPI_OCI_DTYPE_LOB);
+        return DPI_FAILURE;
+    }
+    if (dpiGen__setRefCount(lob->conn, error, 1) < 0) {
+        dpiOci__descriptorFree(locator, DPI_OCI_DTYPE_LOB);
+        return DPI_FAILURE;
+    }
+    if (dpiConn__incrementOpenChildCount(lob->conn, error) < 0) {
+        dpiGen__setRefCount(lob->conn, error, -1);
+        dpiOci__descriptorFree(locator, DPI_OCI_DTYPE_LOB);
+        return DPI_FAILURE;
+    }
+    lob->locator = locator;
+    for (link = &lob->borrowedFrom->borrowedLobs; *link;
+            link = &(*link)->nextBorrowed) {
+        if (*link == lob) {
+            *link = lob->nextBorrowed;
+            break;
+        }
+    }
+    lob->borrowedFrom = NULL;
+    lob->nextBorrowed = NULL;
+    return DPI_SUCCESS;
+}
+
+
+//-----------------------------------------------------------------------------
+// dpiLob__readBlock() [INTERNAL]
+//   Read the next block of a transfer from the LOB into the specified buffer.
+// The length of the block is zero once all of the data has been read.
+//-----------------------------------------------------------------------------
+static int dpiLob__readBlock(dpiLob *lob, dpiLobTransfer *transfer,
+        uint32_t bufferIndex, uint64_t *offset, uint64_t *bytesLeft,
+        dpiError *error)
+{
+    uint64_t lengthInBytes, lengthInChars = 0;
+
+    transfer->lengths[bufferIndex] = 0;
+    if (*bytesLeft == 0)
+        return DPI_SUCCESS;
+    lengthInBytes = (*bytesLeft < transfer->blockSize) ? *bytesLeft :
+            transfer->blockSize;
+    if (dpiOci__lobRead2(lob, *offset, &lengthInBytes, &lengthInChars,
+            transfer->buffers[bufferIndex], transfer->blockSize, error) < 0)
+        return DPI_FAILURE;
+    if (lengthInBytes > *bytesLeft)
+        lengthInBytes = *bytesLeft;
+    transfer->lengths[bufferIndex] = lengthInBytes;
+    *bytesLeft = (lengthInBytes == 0) ? 0 : *bytesLeft - lengthInBytes;
+    *offset += lengthInBytes;
+    return DPI_SUCCESS;
+}
+
+
+//-----------------------------------------------------------------------------
+// dpiLob__readBlocksToFile() [INTERNAL]
+//   Read the data in the LOB starting at the specified offset and write it to
+// the file. Each block is written to the file while the next block is read
+// from the LOB. The offset must be within the LOB or immediately after its
+// end, in which case no data is transferred.
+//-----------------------------------------------------------------------------
+static int dpiLob__readBlocksToFile(dpiLob *lob, uint64_t offset,
+        dpiLobTransfer *transfer, uint64_t *numBytes, dpiError *error)
+{
+    uint64_t lobLength, bytesLeft;
+    uint32_t lobIndex;
+    int status;
+
+    // determine how much data is to be transferred and read the first block
+    if (dpiOci__lobGetLength2(lob, &lobLength, error) < 0)
+        return DPI_FAILURE;
+    if (offset == 0 || offset > lobLength + 1)
+        return dpiError__set(error, "check offset",
+                DPI_ERR_INVALID_LOB_OFFSET);
+    bytesLeft = lobLength - offset + 1;
+    lobIndex = 0;
+    if (dpiLob__readBlock(lob, transfer, lobIndex, &offset, &bytesLeft,
+            error) < 0)
+        return DPI_FAILURE;
+
+    // write each block to the file while the next one is read from the LOB
+    while (transfer->lengths[lobIndex] > 0) {
+        transfer->fileIndex = lobIndex;
+        lobIndex = 1 - lobIndex;
+        if (dpiLob__startFileTransfer(transfer, error) < 0)
+            return DPI_FAILURE;
+        status = dpiLob__readBlock(lob, transfer, lobIndex, &offset,
+                &bytesLeft, error);
+        if (dpiLob__finishFileTransfer(transfer, (status == DPI_SUCCESS),
+                error) < 0)
+            return DPI_FAILURE;
+        if (status < 0)
+            return DPI_FAILURE;
+        *numBytes += transfer->lengths[transfer->fileIndex];
+    }
+
+    return DPI_SUCCESS;
+}
+
+
 //-----------------------------------------------------------------------------
 // dpiLob__readBytes() [INTERNAL]
 //   Return a portion (or all) of the data in the LOB.
@@ -144,7 +454,7 @@ int dpiLob__readBytes(dpiLob *lob, uint64_t offset, uint64_t amount,
 
     // if file was opened in this routine, close it again
     if (lob->type->oracleTypeNum == DPI_ORACLE_TYPE_BFILE && !isOpen) {
-        if (dpiOci__lobClose(lob, error) < 0)
+        if (dpiOci__lobClose(lob, 1, error) < 0)
             return DPI_FAILURE;
     }
 
@@ -152,6 +462,42 @@ int dpiLob__readBytes(dpiLob *lob, uint64_t offset, uint64_t amount,
 }
 
 
+//-----------------------------------------------------------------------------
+// dpiLob__readToFile() [INTERNAL]
+//   Read the data in the LOB starting at the specified offset and write it to
+// the file. BFILEs are opened for the duration of the transfer if they are
+// not already open and are closed again even if the transfer fails; errors
+// closing them are ignored in that case so that the original error is
+// retained.
+//-----------------------------------------------------------------------------
+static int dpiLob__readToFile(dpiLob *lob, uint64_t offset,
+        dpiLobTransfer *transfer, uint64_t *numBytes, dpiError *error)
+{
+    int status, isOpen = 1;
+
+    // for files, open the file if needed
+    *numBytes = 0;
+    if (lob->type->oracleTypeNum == DPI_ORACLE_TYPE_BFILE) {
+        if (dpiOci__lobIsOpen(lob, &isOpen, error) < 0)
+            return DPI_FAILURE;
+        if (!isOpen) {
+            if (dpiOci__lobOpen(lob, error) < 0)
+                return DPI_FAILURE;
+        }
+    }
+
+    // transfer the data and, if the file was opened in this routine, close
+    // it again
+    status = dpiLob__readBlocksToFile(lob, offset, transfer, numBytes, error);
+    if (!isOpen) {
+        if (dpiOci__lobClose(lob, (status == DPI_SUCCESS), error) < 0)
+            return DPI_FAILURE;
+    }
+
+    return status;
+}
+
+
 //-----------------------------------------------------------------------------
 // dpiLob__setFromBytes() [INTERNAL]
 //   Clear the LOB completely and then write the specified bytes to it.
@@ -167,13 +513,155 @@ int dpiLob__setFromBytes(dpiLob *lob, const char *value, uint64_t valueLength,
 }
 
 
+//-----------------------------------------------------------------------------
+// dpiLob__startFileTransfer() [INTERNAL]
+//   Start the file I/O for the next block of a transfer in a separate thread
+// so that it overlaps the LOB operation performed by the caller. This is only
+// possible if the environment is threaded; otherwise the file I/O is
+// performed by dpiLob__finishFileTransfer().
+//-----------------------------------------------------------------------------
+static int dpiLob__startFileTransfer(dpiLobTransfer *transfer,
+        dpiError *error)
+{
+    if (!transfer->env->threaded)
+        return DPI_SUCCESS;
+    return dpiOci__threadCreate(transfer->env, dpiLob__transferFile, transfer,
+            &transfer->threadId, &transfer->threadHandle, error);
+}
+
+
+//-----------------------------------------------------------------------------
+// dpiLob__transferFile() [INTERNAL]
+//   Read the next block of a transfer from the file or write the current
+// block to the file, depending on the direction of the transfer. Only
+// operating system calls are made so this is safe to run in a separate
+// thread; the error number is retained for the caller to check. Reads stop
+// early only at the end of the file. Direct I/O is disabled before writing a
+// final block that is not a multiple of the page size. If caching is not
+// wanted, the kernel is advised that the block will not be needed again.
+//-----------------------------------------------------------------------------
+static void dpiLob__transferFile(void *arg)
+{
+    dpiLobTransfer *transfer = (dpiLobTransfer*) arg;
+    uint64_t length, bytesDone;
+    int64_t numBytes;
+    char *buffer;
+
+    buffer = transfer->buffers[transfer->fileIndex];
+    if (transfer->readFromFile) {
+        length = transfer->blockSize;
+        transfer->lengths[transfer->fileIndex] = 0;
+    } else {
+        length = transfer->lengths[transfer->fileIndex];
+#ifdef O_DIRECT
+        if (transfer->isDirect && length % DPI_BASE_PAGE_SIZE != 0) {
+            fcntl(transfer->fd, F_SETFL, transfer->originalFlags);
+            transfer->isDirect = 0;
+        }
+#endif
+    }
+
+    // read or write until the block is complete or the end of file is reached
+    bytesDone = 0;
+    while (bytesDone < length) {
+#ifdef _WIN32
+        if (transfer->readFromFile)
+            numBytes = _read(transfer->fd, buffer + bytesDone,
+                    (unsigned) (length - bytesDone));
+        else numBytes = _write(transfer->fd, buffer + bytesDone,
+                (unsigned) (length - bytesDone));
+#else
+        if (transfer->readFromFile)
+            numBytes = read(transfer->fd, buffer + bytesDone,
+                    (size_t) (length - bytesDone));
+        else numBytes = write(transfer->fd, buffer + bytesDone,
+                (size_t) (length - bytesDone));
+#endif
+        if (numBytes < 0 && errno == EINTR)
+            continue;
+        if (numBytes < 0) {
+            transfer->osError = errno;
+            return;
+        }
+        if (numBytes == 0)
+            break;
+        bytesDone += (uint64_t) numBytes;
+        if (transfer->readFromFile && transfer->isDirect &&
+                numBytes % DPI_BASE_PAGE_SIZE != 0)
+            break;
+    }
+    if (transfer->readFromFile)
+        transfer->lengths[transfer->fileIndex] = bytesDone;
+
+    // track the file offset and drop the block from the cache, if requested
+    if (transfer->fileOffset >= 0) {
+#ifdef POSIX_FADV_DONTNEED
+        if (transfer->mode & DPI_MODE_LOB_TRANSFER_NO_CACHE)
+            posix_fadvise(transfer->fd, transfer->fileOffset,
+                    (off_t) bytesDone, POSIX_FADV_DONTNEED);
+#endif
+        transfer->fileOffset += bytesDone;
+    }
+}
+
+
+//-----------------------------------------------------------------------------
+// dpiLob__writeFromFile() [INTERNAL]
+//   Read the data in the file until the end of the file is reached and write
+// it to the LOB starting at the specified offset. The next block is read from
+// the file while each block is written to the LOB.
+//-----------------------------------------------------------------------------
+static int dpiLob__writeFromFile(dpiLob *lob, uint64_t offset,
+        dpiLobTransfer *transfer, uint64_t *numBytes, dpiError *error)
+{
+    uint32_t lobIndex;
+    int status, isEnd;
+
+    // read the first block from the file
+    *numBytes = 0;
+    transfer->fileIndex = 0;
+    if (dpiLob__finishFileTransfer(transfer, 1, error) < 0)
+        return DPI_FAILURE;
+
+    // write each block to the LOB while the next one is read from the file;
+    // a block shorter than the block size means the end of file was reached
+    while (transfer->lengths[transfer->fileIndex] > 0) {
+        lobIndex = transfer->fileIndex;
+        transfer->fileIndex = 1 - lobIndex;
+        transfer->lengths[transfer->fileIndex] = 0;
+        isEnd = (transfer->lengths[lobIndex] < transfer->blockSize);
+        if (!isEnd && dpiLob__startFileTransfer(transfer, error) < 0)
+            return DPI_FAILURE;
+        status = dpiOci__lobWrite2(lob, offset, transfer->buffers[lobIndex],
+                transfer->lengths[lobIndex], error);
+        if (!isEnd && dpiLob__finishFileTransfer(transfer,
+                (status == DPI_SUCCESS), error) < 0)
+            return DPI_FAILURE;
+        if (status < 0)
+            return DPI_FAILURE;
+        offset += transfer->lengths[lobIndex];
+        *numBytes += transfer->lengths[lobIndex];
+    }
+
+    return DPI_SUCCESS;
+}
+
+
 //-----------------------------------------------------------------------------
 // dpiLob_addRef() [PUBLIC]
-//   Add a reference to the LOB.
+//   Add a reference to the LOB. If the LOB is borrowed from an object it is
+// promoted first, so that it holds both the reference returned when the LOB
+// was retrieved and the reference added here.
 //-----------------------------------------------------------------------------
 int dpiLob_addRef(dpiLob *lob)
 {
-    return dpiGen__addRef(lob, DPI_HTYPE_LOB, __func__);
+    dpiError error;
+
+    if (dpiGen__startPublicFn(lob, DPI_HTYPE_LOB, __func__, &error) < 0)
+        return DPI_FAILURE;
+    if (dpiLob__promote(lob, &error) < 0)
+        return DPI_FAILURE;
+    return dpiGen__setRefCount(lob, &error, 1);
 }
 
 
@@ -201,7 +689,7 @@ int dpiLob_closeResource(dpiLob *lob)
 
     if (dpiLob__check(lob, __func__, &error) < 0)
         return DPI_FAILURE;
-    return dpiOci__lobClose(lob, &error);
+    return dpiOci__lobClose(lob, 1, &error);
 }
 
 
@@ -394,13 +882,68 @@ int dpiLob_readBytes(dpiLob *lob, uint64_t offset, uint64_t amount,
 }
 
 
+//-----------------------------------------------------------------------------
+// dpiLob_readBytesWithTimeout() [PUBLIC]
+//   Return a portion (or all) of the data in the LOB, as with
+// dpiLob_readBytes(), but interrupt the read if it takes longer than the
+// specified timeout (in milliseconds).
+//-----------------------------------------------------------------------------
+int dpiLob_readBytesWithTimeout(dpiLob *lob, uint64_t offset, uint64_t amount,
+        char *value, uint64_t *valueLength, uint32_t timeout)
+{
+    dpiWatchdogEntry entry;
+    dpiError error;
+    int status;
+
+    if (dpiLob__check(lob, __func__, &error) < 0)
+        return DPI_FAILURE;
+    DPI_CHECK_PTR_NOT_NULL(value)
+    DPI_CHECK_PTR_NOT_NULL(valueLength)
+    if (dpiWatchdog__addEntry(&entry, lob->conn, timeout, &error) < 0)
+        return DPI_FAILURE;
+    status = dpiLob__readBytes(lob, offset, amount, value, valueLength,
+            &error);
+    return dpiWatchdog__removeEntry(&entry, status, &error);
+}
+
+
+//-----------------------------------------------------------------------------
+// dpiLob_readToFd() [PUBLIC]
+//   Read the data in the binary LOB starting at the specified offset and write
+// it to the file descriptor at its current position.
+//-----------------------------------------------------------------------------
+int dpiLob_readToFd(dpiLob *lob, uint64_t offset, int fd,
+        dpiLobTransferMode mode, uint64_t *numBytes)
+{
+    dpiLobTransfer transfer;
+    dpiError error;
+    int status;
+
+    if (dpiLob__check(lob, __func__, &error) < 0)
+        return DPI_FAILURE;
+    DPI_CHECK_PTR_NOT_NULL(numBytes)
+    if (dpiLob__initTransfer(lob, fd, mode, 0, &transfer, &error) < 0)
+        return DPI_FAILURE;
+    status = dpiLob__readToFile(lob, offset, &transfer, numBytes, &error);
+    dpiLob__freeTransfer(&transfer);
+    return status;
+}
+
+
 //-----------------------------------------------------------------------------
 // dpiLob_release() [PUBLIC]
-//   Release a reference to the LOB.
+//   Release a reference to the LOB. LOBs borrowed from an object are owned by
+// that object so releasing them has no effect.
 //-----------------------------------------------------------------------------
 int dpiLob_release(dpiLob *lob)
 {
-    return dpiGen__release(lob, DPI_HTYPE_LOB, __func__);
+    dpiError error;
+
+    if (dpiGen__startPublicFn(lob, DPI_HTYPE_LOB, __func__, &error) < 0)
+        return DPI_FAILURE;
+    if (lob->borrowedFrom)
+        return DPI_SUCCESS;
+    return dpiGen__setRefCount(lob, &error, -1);
 }
 
 
@@ -468,3 +1011,26 @@ int dpiLob_writeBytes(dpiLob *lob, uint64_t offset, const char *value,
     return dpiOci__lobWrite2(lob, offset, value, valueLength, &error);
 }
 
+
+//-----------------------------------------------------------------------------
+// dpiLob_writeFromFd() [PUBLIC]
+//   Read the data in the file descriptor from its current position until the
+// end of the file and write it to the binary LOB at the specified offset.
+//-----------------------------------------------------------------------------
+int dpiLob_writeFromFd(dpiLob *lob, uint64_t offset, int fd,
+        dpiLobTransferMode mode, uint64_t *numBytes)
+{
+    dpiLobTransfer transfer;
+    dpiError error;
+    int status;
+
+    if (dpiLob__check(lob, __func__, &error) < 0)
+        return DPI_FAILURE;
+    DPI_CHECK_PTR_NOT_NULL(numBytes)
+    if (dpiLob__initTransfer(lob, fd, mode, 1, &transfer, &error) < 0)
+        return DPI_FAILURE;
+    status = dpiLob__writeFromFile(lob, offset, &transfer, numBytes, &error);
+    dpiLob__freeTransfer(&transfer);
+    return status;
+}
+
@@ -98,6 +98,13 @@ static void dpiObject__clearOracleValue(dpiEnv *env, dpiError *error,
 //-----------------------------------------------------------------------------
 void dpiObject__free(dpiObject *obj, dpiError *error)
 {
+    dpiLob *lob;
+
+    while (obj->borrowedLobs) {
+        lob = obj->borrowedLobs;
+        obj->borrowedLobs = lob->nextBorrowed;
+        dpiLob__free(lob, error);
+    }
     if (obj->isIndependent) {
         dpiOci__objectFree(obj, error);
         obj->isIndependent = 0;
@@ -207,20 +214,11 @@ static int dpiObject__fromOracleValue(dpiObject *obj, dpiError *error,
         case DPI_ORACLE_TYPE_BLOB:
         case DPI_ORACLE_TYPE_BFILE:
             if (nativeTypeNum == DPI_NATIVE_TYPE_LOB) {
-                dpiLob *tempLob;
-                if (dpiGen__allocate(DPI_HTYPE_LOB, obj->env,
-                        (void**) &tempLob, error) < 0)
-                    return DPI_FAILURE;
-                if (dpiGen__setRefCount(obj->type->conn, error, 1) < 0) {
-                    dpiLob__free(tempLob, error);
-                    return DPI_FAILURE;
-                }
-                tempLob->conn = obj->type->conn;
-                tempLob->type = dpiOracleType__getFromNum(
-                        typeInfo->oracleTypeNum, error);
-                tempLob->locator = *(value->asLobLocator);
-                data->value.asLOB = tempLob;
-                return DPI_SUCCESS;
+                const dpiOracleType *lobType;
+                lobType = dpiOracleType__getFromNum(typeInfo->oracleTypeNum,
+                        error);
+                return dpiLob__borrow(obj, lobType, *(value->asLobLocator),
+                        &data->value.asLOB, error);
             }
             break;
         default:
@@ -712,6 +710,35 @@ int dpiObject_setElementValueByIndex(dpiObject *obj, int32_t index,
 }
 
 
+//-----------------------------------------------------------------------------
+// dpiObject_toJson() [PUBLIC]
+//   Serialize the object as JSON, appending it to the buffer. The buffer is
+// grown as needed and on failure is restored to its original length.
+//-----------------------------------------------------------------------------
+int dpiObject_toJson(dpiObject *obj, dpiJsonBuffer *buffer)
+{
+    dpiJsonWriter writer;
+    uint32_t origLength;
+    dpiError error;
+
+    if (dpiGen__startPublicFn(obj, DPI_HTYPE_OBJECT, __func__, &error) < 0)
+        return DPI_FAILURE;
+    DPI_CHECK_PTR_NOT_NULL(buffer)
+    origLength = buffer->length;
+    writer.buffer = buffer;
+    writer.callback = NULL;
+    writer.callbackContext = NULL;
+    writer.chunkLength = 0;
+    if (dpiJson__writeObject(&writer, obj, &error) < 0) {
+        buffer->length = origLength;
+        if (buffer->ptr)
+            buffer->ptr[origLength] = '\0';
+        return DPI_FAILURE;
+    }
+    return DPI_SUCCESS;
+}
+
+
 //-----------------------------------------------------------------------------
 // dpiObject_trim() [PUBLIC]
 //   Trim a number of elements from the end of the collection.
@@ -725,3 +752,32 @@ int dpiObject_trim(dpiObject *obj, uint32_t numToTrim)
     return dpiOci__collTrim(obj->type->conn, numToTrim, obj->instance, &error);
 }
 
+
+//-----------------------------------------------------------------------------
+// dpiObject_writeJson() [PUBLIC]
+//   Serialize the object as JSON, passing it to the callback in pieces. Data
+// is staged internally so that the callback is called infrequently.
+//-----------------------------------------------------------------------------
+int dpiObject_writeJson(dpiObject *obj, dpiJsonWriteCallback callback,
+        void *context)
+{
+    dpiJsonWriter *writer;
+    dpiError error;
+    int status;
+
+    if (dpiGen__startPublicFn(obj, DPI_HTYPE_OBJECT, __func__, &error) < 0)
+        return DPI_FAILURE;
+    DPI_CHECK_PTR_NOT_NULL(callback)
+    writer = malloc(sizeof(dpiJsonWriter));
+    if (!writer)
+        return dpiError__set(&error, "allocate JSON writer",
+                DPI_ERR_NO_MEMORY);
+    writer->buffer = NULL;
+    writer->callback = callback;
+    writer->callbackContext = context;
+    writer->chunkLength = 0;
+    status = dpiJson__writeObject(writer, obj, &error);
+    free(writer);
+    return status;
+}
+
@@ -19,6 +19,8 @@
 // forward declarations of internal functions only used in this file
 static int dpiObjectType__init(dpiObjectType *objType, void *param,
         uint32_t nameAttribute, dpiError *error);
+static int dpiObjectType__retire(dpiObjectType *objType, int *retired,
+        dpiError *error);
 
 
 //-----------------------------------------------------------------------------
@@ -109,10 +111,27 @@ static int dpiObjectType__describe(dpiObjectType *objType,
 
 //-----------------------------------------------------------------------------
 // dpiObjectType__free() [INTERNAL]
-//   Free the memory for an object type.
+//   Free the memory for an object type. Object types held in the cache of
+// object types maintained by the connection are retired instead.
 //-----------------------------------------------------------------------------
 void dpiObjectType__free(dpiObjectType *objType, dpiError *error)
 {
+    int retired;
+
+    if (objType->isCached) {
+        if (dpiObjectType__retire(objType, &retired, error) < 0 || retired)
+            return;
+    }
+    if (objType->lookupName) {
+        free((void*) objType->lookupName);
+        objType->lookupName = NULL;
+    }
+
+    // retired object types have already released their references
+    if (objType->cacheState == DPI_OBJECT_TYPE_STATE_RETIRED) {
+        objType->conn = NULL;
+        objType->elementTypeInfo.objectType = NULL;
+    }
     if (objType->conn) {
         dpiGen__setRefCount(objType->conn, error, -1);
         objType->conn = NULL;
@@ -121,6 +140,10 @@ void dpiObjectType__free(dpiObjectType *objType, dpiError *error)
         dpiGen__setRefCount(objType->elementTypeInfo.objectType, error, -1);
         objType->elementTypeInfo.objectType = NULL;
     }
+    if (objType->jsonPlan) {
+        dpiJson__freePlan(objType->jsonPlan, objType->numAttributes, error);
+        objType->jsonPlan = NULL;
+    }
     if (objType->schema) {
         free((void*) objType->schema);
         objType->schema = NULL;
@@ -180,6 +203,54 @@ static int dpiObjectType__init(dpiObjectType *objType, void *param,
 }
 
 
+//-----------------------------------------------------------------------------
+// dpiObjectType__retire() [INTERNAL]
+//   Retire an object type held in the cache of object types maintained by the
+// connection when its last reference is released, so that it can be reused
+// without being described again. The references it holds to its element
+// type, to the types used by its JSON plan and to the connection are released
+// as they would otherwise keep the connection open; the object type can only
+// be reused once this is complete. If the cache is cleared before then, the
+// object type is not retired and must be freed by the caller instead.
+//-----------------------------------------------------------------------------
+static int dpiObjectType__retire(dpiObjectType *objType, int *retired,
+        dpiError *error)
+{
+    dpiConn *conn = objType->conn;
+    dpiEnv *env = objType->env;
+
+    // mark the object type as being retired
+    if (env->threaded && dpiOci__threadMutexAcquire(env, error) < 0)
+        return DPI_FAILURE;
+    *retired = objType->isCached;
+    if (*retired)
+        objType->cacheState = DPI_OBJECT_TYPE_STATE_RETIRING;
+    if (env->threaded && dpiOci__threadMutexRelease(env, error) < 0)
+        return DPI_FAILURE;
+    if (!*retired)
+        return DPI_SUCCESS;
+
+    // release the references to other object types
+    if (objType->jsonPlan) {
+        dpiJson__freePlan(objType->jsonPlan, objType->numAttributes, error);
+        objType->jsonPlan = NULL;
+    }
+    if (objType->elementTypeInfo.objectType)
+        dpiGen__setRefCount(objType->elementTypeInfo.objectType, error, -1);
+
+    // mark the object type as retired and release the reference to the
+    // connection; the object type must not be accessed after this point if it
+    // is still cached, as it may be reused or freed by another thread
+    if (env->threaded && dpiOci__threadMutexAcquire(env, error) < 0)
+        return DPI_FAILURE;
+    objType->cacheState = DPI_OBJECT_TYPE_STATE_RETIRED;
+    *retired = objType->isCached;
+    if (env->threaded && dpiOci__threadMutexRelease(env, error) < 0)
+        return DPI_FAILURE;
+    return dpiGen__setRefCount(conn, error, -1);
+}
+
+
 //-----------------------------------------------------------------------------
 // dpiObjectType_addRef() [PUBLIC]
 //   Add a reference to the object type.
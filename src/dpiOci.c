@@ -25,6 +25,11 @@
 #include "dpiImpl.h"
 
 // forward declarations of internal functions only used in this file
+static void dpiOci__interposeAfter(const dpiInterposeParams *interposer,
+        dpiInterposeCallInfo *info, uint64_t startTime, int status);
+static int dpiOci__interposeBefore(const dpiInterposeParams *interposer,
+        dpiInterposeCallInfo *info, uint32_t callClasses, const char *fnName,
+        uint64_t *startTime, dpiError *error);
 static int dpiOci__loadLib(dpiError *error);
 static int dpiOci__loadLibValidate(dpiError *error);
 static int dpiOci__loadSymbol(const char *symbolName, void **symbol,
@@ -37,6 +42,61 @@ static int dpiOci__loadSymbol(const char *symbolName, void **symbol,
             error) < 0) \
         return DPI_FAILURE;
 
+// macro to record a round trip to the database made on a connection; it is
+// used by DPI_OCI_CALL() for every wrapper whose OCI function requires a round
+// trip (or is assumed to when OCI does not document otherwise); all other
+// wrappers are purely local; round trips made by session pools as a whole and
+// those that are not made on behalf of a connection are not recorded; the
+// count is incremented atomically as the watchdog thread calls OCIBreak() on
+// connections that are in use by other threads
+#ifdef _WIN32
+#define DPI_OCI_ROUND_TRIP(conn) \
+    InterlockedIncrement64((volatile LONG64*) &(conn)->roundTrips)
+#else
+#define DPI_OCI_ROUND_TRIP(conn) \
+    __atomic_fetch_add(&(conn)->roundTrips, 1, __ATOMIC_RELAXED)
+#endif
+
+// macro to acquire the interposer that is currently installed (or NULL if no
+// interposer is installed); it may be replaced by another thread at any time
+// so it is acquired once and the same parameters used for the entire call
+#ifdef _WIN32
+#define DPI_OCI_GET_INTERPOSER() \
+    ((const dpiInterposeParams*) InterlockedCompareExchangePointer( \
+            (PVOID volatile*) &dpiOciInterposer, NULL, NULL))
+#else
+#define DPI_OCI_GET_INTERPOSER() \
+    __atomic_load_n(&dpiOciInterposer, __ATOMIC_ACQUIRE)
+#endif
+
+// macro to make a call to an OCI function that requires a round trip to the
+// database; if an interposer has been installed for the round trip class or
+// for the (more specific) class given, it is notified before and after the
+// call and may inject an error in place of making the call; the round trip is
+// recorded on the given connection (unless it is NULL) only if the OCI
+// function was actually called
+#define DPI_OCI_CALL(callClass, fnName, conn, status, call) \
+    { \
+        const dpiInterposeParams *interposer = DPI_OCI_GET_INTERPOSER(); \
+        dpiConn *roundTripConn = (conn); \
+        int injected = 0; \
+        if (interposer && (interposer->callClasses & \
+                (DPI_INTERPOSE_CALL_ROUND_TRIP | (callClass)))) { \
+            dpiInterposeCallInfo callInfo; \
+            uint64_t startTime; \
+            if (dpiOci__interposeBefore(interposer, &callInfo, \
+                    DPI_INTERPOSE_CALL_ROUND_TRIP | (callClass), fnName, \
+                    &startTime, error) < 0) { \
+                status = DPI_OCI_ERROR_INJECTED; \
+                injected = 1; \
+            } else status = call; \
+            dpiOci__interposeAfter(interposer, &callInfo, startTime, \
+                    status); \
+        } else status = call; \
+        if (!injected && roundTripConn) \
+            DPI_OCI_ROUND_TRIP(roundTripConn); \
+    }
+
 
 // typedefs for all OCI functions used by ODPI-C
 typedef int (*dpiOciFnType__aqDeq)(void *svchp, void *errhp,
@@ -255,6 +315,7 @@ typedef void *(*dpiOciFnType__rawPtr)(void *env, const void *raw);
 typedef int (*dpiOciFnType__rawResize)(void *env, void *err, uint32_t new_size,
         void **raw);
 typedef uint32_t (*dpiOciFnType__rawSize)(void * env, const void *raw);
+typedef int (*dpiOciFnType__reset)(void *hndlp, void *errhp);
 typedef int (*dpiOciFnType__rowidToChar)(void *rowidDesc, char *outbfp,
         uint16_t *outbflp, void *errhp);
 typedef int (*dpiOciFnType__serverAttach)(void *srvhp, void *errhp,
@@ -322,6 +383,17 @@ typedef int (*dpiOciFnType__tablePrev)(void *env, void *err, int32_t index,
         const void *tbl, int32_t *prev_index, int *exists);
 typedef int (*dpiOciFnType__tableSize)(void *env, void *err, const void *tbl,
         int32_t *size);
+typedef int (*dpiOciFnType__threadCreate)(void *hndl, void *err,
+        void (*start)(void*), void *arg, void *tid, void *tHnd);
+typedef int (*dpiOciFnType__threadClose)(void *hndl, void *err, void *tHnd);
+typedef int (*dpiOciFnType__threadHndDestroy)(void *hndl, void *err,
+        void **thnd);
+typedef int (*dpiOciFnType__threadHndInit)(void *hndl, void *err,
+        void **thnd);
+typedef int (*dpiOciFnType__threadIdDestroy)(void *hndl, void *err,
+        void **tid);
+typedef int (*dpiOciFnType__threadIdInit)(void *hndl, void *err, void **tid);
+typedef int (*dpiOciFnType__threadJoin)(void *hndl, void *err, void *tHnd);
 typedef int (*dpiOciFnType__threadKeyDestroy)(void *hndl, void *err,
         void **key);
 typedef int (*dpiOciFnType__threadKeyGet)(void *hndl, void *err, void *key,
@@ -473,6 +545,7 @@ static struct {
     dpiOciFnType__rawPtr fnRawPtr;
     dpiOciFnType__rawResize fnRawResize;
     dpiOciFnType__rawSize fnRawSize;
+    dpiOciFnType__reset fnReset;
     dpiOciFnType__rowidToChar fnRowidToChar;
     dpiOciFnType__serverAttach fnServerAttach;
     dpiOciFnType__serverDetach fnServerDetach;
@@ -502,6 +575,13 @@ static struct {
     dpiOciFnType__tableNext fnTableNext;
     dpiOciFnType__tablePrev fnTablePrev;
     dpiOciFnType__tableSize fnTableSize;
+    dpiOciFnType__threadClose fnThreadClose;
+    dpiOciFnType__threadCreate fnThreadCreate;
+    dpiOciFnType__threadHndDestroy fnThreadHndDestroy;
+    dpiOciFnType__threadHndInit fnThreadHndInit;
+    dpiOciFnType__threadIdDestroy fnThreadIdDestroy;
+    dpiOciFnType__threadIdInit fnThreadIdInit;
+    dpiOciFnType__threadJoin fnThreadJoin;
     dpiOciFnType__threadKeyDestroy fnThreadKeyDestroy;
     dpiOciFnType__threadKeyGet fnThreadKeyGet;
     dpiOciFnType__threadKeyInit fnThreadKeyInit;
@@ -518,6 +598,20 @@ static struct {
     dpiOciFnType__typeByFullName fnTypeByFullName;
 } dpiOciSymbols;
 
+// interposer installed on calls that require round trips; no calls are
+// interposed until one is installed; the parameters of each interposer are
+// copied to memory that is retained for the lifetime of the process, since
+// calls in progress on other threads may still be using an interposer after
+// it has been replaced; the list is only modified while the mutex of the
+// global environment is held
+typedef struct dpiOciInterposerEntry dpiOciInterposerEntry;
+struct dpiOciInterposerEntry {
+    dpiInterposeParams params;
+    dpiOciInterposerEntry *next;
+};
+static const dpiInterposeParams *dpiOciInterposer = NULL;
+static dpiOciInterposerEntry *dpiOciInterposerEntries = NULL;
+
 
 //-----------------------------------------------------------------------------
 // dpiOci__aqDeq() [INTERNAL]
@@ -530,9 +624,10 @@ int dpiOci__aqDeq(dpiConn *conn, const char *queueName, void *options,
     int status;
 
     DPI_OCI_LOAD_SYMBOL("OCIAQDeq", dpiOciSymbols.fnAqDeq)
-    status = (*dpiOciSymbols.fnAqDeq)(conn->handle, error->handle, queueName,
+    DPI_OCI_CALL(DPI_INTERPOSE_CALL_AQ, "OCIAQDeq", conn, status,
+            (*dpiOciSymbols.fnAqDeq)(conn->handle, error->handle, queueName,
             options, msgProps, payloadType, payload, payloadInd, msgId,
-            DPI_OCI_DEFAULT);
+            DPI_OCI_DEFAULT))
     return dpiError__check(error, status, conn, "dequeue message");
 }
 
@@ -548,9 +643,10 @@ int dpiOci__aqEnq(dpiConn *conn, const char *queueName, void *options,
     int status;
 
     DPI_OCI_LOAD_SYMBOL("OCIAQEnq", dpiOciSymbols.fnAqEnq)
-    status = (*dpiOciSymbols.fnAqEnq)(conn->handle, error->handle, queueName,
+    DPI_OCI_CALL(DPI_INTERPOSE_CALL_AQ, "OCIAQEnq", conn, status,
+            (*dpiOciSymbols.fnAqEnq)(conn->handle, error->handle, queueName,
             options, msgProps, payloadType, payload, payloadInd, msgId,
-            DPI_OCI_DEFAULT);
+            DPI_OCI_DEFAULT))
     return dpiError__check(error, status, conn, "enqueue message");
 }
 
@@ -765,7 +861,8 @@ int dpiOci__break(dpiConn *conn, dpiError *error)
     int status;
 
     DPI_OCI_LOAD_SYMBOL("OCIBreak", dpiOciSymbols.fnBreak)
-    status = (*dpiOciSymbols.fnBreak)(conn->handle, error->handle);
+    DPI_OCI_CALL(DPI_INTERPOSE_CALL_ROUND_TRIP, "OCIBreak", conn, status,
+            (*dpiOciSymbols.fnBreak)(conn->handle, error->handle))
     return dpiError__check(error, status, conn, "break execution");
 }
 
@@ -1010,8 +1107,9 @@ int dpiOci__dbShutdown(dpiConn *conn, uint32_t mode, dpiError *error)
     int status;
 
     DPI_OCI_LOAD_SYMBOL("OCIDBShutdown", dpiOciSymbols.fnDbShutdown)
-    status = (*dpiOciSymbols.fnDbShutdown)(conn->handle, error->handle, NULL,
-            mode);
+    DPI_OCI_CALL(DPI_INTERPOSE_CALL_ROUND_TRIP, "OCIDBShutdown", conn, status,
+            (*dpiOciSymbols.fnDbShutdown)(conn->handle, error->handle, NULL,
+            mode))
     return dpiError__check(error, status, NULL, "shutdown database");
 }
 
@@ -1025,8 +1123,9 @@ int dpiOci__dbStartup(dpiConn *conn, uint32_t mode, dpiError *error)
     int status;
 
     DPI_OCI_LOAD_SYMBOL("OCIDBStartup", dpiOciSymbols.fnDbStartup)
-    status = (*dpiOciSymbols.fnDbStartup)(conn->handle, error->handle, NULL,
-            DPI_OCI_DEFAULT, mode);
+    DPI_OCI_CALL(DPI_INTERPOSE_CALL_ROUND_TRIP, "OCIDBStartup", conn, status,
+            (*dpiOciSymbols.fnDbStartup)(conn->handle, error->handle, NULL,
+            DPI_OCI_DEFAULT, mode))
     return dpiError__check(error, status, NULL, "startup database");
 }
 
@@ -1113,8 +1212,9 @@ int dpiOci__describeAny(dpiConn *conn, void *obj, uint32_t objLength,
     int status;
 
     DPI_OCI_LOAD_SYMBOL("OCIDescribeAny", dpiOciSymbols.fnDescribeAny)
-    status = (*dpiOciSymbols.fnDescribeAny)(conn->handle, error->handle, obj,
-            objLength, objType, 0, DPI_OCI_PTYPE_TYPE, describeHandle);
+    DPI_OCI_CALL(DPI_INTERPOSE_CALL_ROUND_TRIP, "OCIDescribeAny", conn, status,
+            (*dpiOciSymbols.fnDescribeAny)(conn->handle, error->handle, obj,
+            objLength, objType, 0, DPI_OCI_PTYPE_TYPE, describeHandle))
     return dpiError__check(error, status, conn, "describe type");
 }
 
@@ -1261,6 +1361,53 @@ int dpiOci__handleFree(void *handle, uint32_t handleType)
 }
 
 
+//-----------------------------------------------------------------------------
+// dpiOci__interposeAfter() [INTERNAL]
+//   Notify the interposer that a call has completed (or that an error was
+// injected in place of it) with the given status. The elapsed time includes
+// any time spent by the interposer before the call was made.
+//-----------------------------------------------------------------------------
+static void dpiOci__interposeAfter(const dpiInterposeParams *interposer,
+        dpiInterposeCallInfo *info, uint64_t startTime, int status)
+{
+    if (!interposer->afterCall)
+        return;
+    info->elapsedTime = dpiUtils__getMicroseconds() - startTime;
+    info->failed = (status == DPI_OCI_ERROR ||
+            status == DPI_OCI_INVALID_HANDLE ||
+            status == DPI_OCI_ERROR_INJECTED);
+    (*interposer->afterCall)(interposer->callbackContext, info);
+}
+
+
+//-----------------------------------------------------------------------------
+// dpiOci__interposeBefore() [INTERNAL]
+//   Notify the interposer that a call is about to be made. If the interposer
+// returns a non-zero Oracle error number, that error is placed in the error
+// buffer (where it is found by dpiError__check()) and DPI_FAILURE is returned
+// to indicate that the call must not be made.
+//-----------------------------------------------------------------------------
+static int dpiOci__interposeBefore(const dpiInterposeParams *interposer,
+        dpiInterposeCallInfo *info, uint32_t callClasses, const char *fnName,
+        uint64_t *startTime, dpiError *error)
+{
+    int32_t errorNum;
+
+    info->callClasses = callClasses;
+    info->fnName = fnName;
+    info->elapsedTime = 0;
+    info->failed = 0;
+    *startTime = dpiUtils__getMicroseconds();
+    if (!interposer->beforeCall)
+        return DPI_SUCCESS;
+    errorNum = (*interposer->beforeCall)(interposer->callbackContext, info);
+    if (errorNum == 0)
+        return DPI_SUCCESS;
+    error->buffer->code = errorNum;
+    return DPI_FAILURE;
+}
+
+
 //-----------------------------------------------------------------------------
 // dpiOci__intervalGetDaySecond() [INTERNAL]
 //   Wrapper for OCIIntervalGetDaySecond().
@@ -1505,14 +1652,17 @@ static int dpiOci__loadSymbol(const char *symbolName, void **symbol,
 // dpiOci__lobClose() [INTERNAL]
 //   Wrapper for OCILobClose().
 //-----------------------------------------------------------------------------
-int dpiOci__lobClose(dpiLob *lob, dpiError *error)
+int dpiOci__lobClose(dpiLob *lob, int checkError, dpiError *error)
 {
     int status;
 
     DPI_OCI_LOAD_SYMBOL("OCILobClose", dpiOciSymbols.fnLobClose)
-    status = (*dpiOciSymbols.fnLobClose)(lob->conn->handle, error->handle,
-            lob->locator);
-    return dpiError__check(error, status, lob->conn, "close LOB");
+    DPI_OCI_CALL(DPI_INTERPOSE_CALL_LOB, "OCILobClose", lob->conn, status,
+            (*dpiOciSymbols.fnLobClose)(lob->conn->handle, error->handle,
+            lob->locator))
+    if (checkError)
+        return dpiError__check(error, status, lob->conn, "close LOB");
+    return DPI_SUCCESS;
 }
 
 
@@ -1530,9 +1680,10 @@ int dpiOci__lobCreateTemporary(dpiLob *lob, dpiError *error)
     if (lob->type->oracleTypeNum == DPI_ORACLE_TYPE_BLOB)
         lobType = DPI_OCI_TEMP_BLOB;
     else lobType = DPI_OCI_TEMP_CLOB;
-    status = (*dpiOciSymbols.fnLobCreateTemporary)(lob->conn->handle,
+    DPI_OCI_CALL(DPI_INTERPOSE_CALL_LOB, "OCILobCreateTemporary", lob->conn,
+            status, (*dpiOciSymbols.fnLobCreateTemporary)(lob->conn->handle,
             error->handle, lob->locator, DPI_OCI_DEFAULT,
-            lob->type->charsetForm, lobType, 1, DPI_OCI_DURATION_SESSION);
+            lob->type->charsetForm, lobType, 1, DPI_OCI_DURATION_SESSION))
     return dpiError__check(error, status, lob->conn, "create temporary LOB");
 }
 
@@ -1546,8 +1697,9 @@ int dpiOci__lobFileExists(dpiLob *lob, int *exists, dpiError *error)
     int status;
 
     DPI_OCI_LOAD_SYMBOL("OCILobFileExists", dpiOciSymbols.fnLobFileExists)
-    status = (*dpiOciSymbols.fnLobFileExists)(lob->conn->handle, error->handle,
-            lob->locator, exists);
+    DPI_OCI_CALL(DPI_INTERPOSE_CALL_LOB, "OCILobFileExists", lob->conn, status,
+            (*dpiOciSymbols.fnLobFileExists)(lob->conn->handle, error->handle,
+            lob->locator, exists))
     return dpiError__check(error, status, lob->conn, "get file exists");
 }
 
@@ -1595,8 +1747,9 @@ int dpiOci__lobFlushBuffer(dpiLob *lob, dpiError *error)
     int status;
 
     DPI_OCI_LOAD_SYMBOL("OCILobFlushBuffer", dpiOciSymbols.fnLobFlushBuffer)
-    status = (*dpiOciSymbols.fnLobFlushBuffer)(lob->conn->handle,
-            error->handle, lob->locator, 0);
+    DPI_OCI_CALL(DPI_INTERPOSE_CALL_LOB, "OCILobFlushBuffer", lob->conn,
+            status, (*dpiOciSymbols.fnLobFlushBuffer)(lob->conn->handle,
+            error->handle, lob->locator, 0))
     return dpiError__check(error, status, lob->conn, "flush LOB");
 }
 
@@ -1611,8 +1764,9 @@ int dpiOci__lobFreeTemporary(dpiLob *lob, int checkError, dpiError *error)
 
     DPI_OCI_LOAD_SYMBOL("OCILobFreeTemporary",
             dpiOciSymbols.fnLobFreeTemporary)
-    status = (*dpiOciSymbols.fnLobFreeTemporary)(lob->conn->handle,
-            error->handle, lob->locator);
+    DPI_OCI_CALL(DPI_INTERPOSE_CALL_LOB, "OCILobFreeTemporary", lob->conn,
+            status, (*dpiOciSymbols.fnLobFreeTemporary)(lob->conn->handle,
+            error->handle, lob->locator))
     if (checkError)
         return dpiError__check(error, status, lob->conn, "free temporary LOB");
     return DPI_SUCCESS;
@@ -1628,8 +1782,9 @@ int dpiOci__lobGetChunkSize(dpiLob *lob, uint32_t *size, dpiError *error)
     int status;
 
     DPI_OCI_LOAD_SYMBOL("OCILobGetChunkSize", dpiOciSymbols.fnLobGetChunkSize)
-    status = (*dpiOciSymbols.fnLobGetChunkSize)(lob->conn->handle,
-            error->handle, lob->locator, size);
+    DPI_OCI_CALL(DPI_INTERPOSE_CALL_LOB, "OCILobGetChunkSize", lob->conn,
+            status, (*dpiOciSymbols.fnLobGetChunkSize)(lob->conn->handle,
+            error->handle, lob->locator, size))
     return dpiError__check(error, status, lob->conn, "get chunk size");
 }
 
@@ -1643,8 +1798,9 @@ int dpiOci__lobGetLength2(dpiLob *lob, uint64_t *size, dpiError *error)
     int status;
 
     DPI_OCI_LOAD_SYMBOL("OCILobGetLength2", dpiOciSymbols.fnLobGetLength2)
-    status = (*dpiOciSymbols.fnLobGetLength2)(lob->conn->handle, error->handle,
-            lob->locator, size);
+    DPI_OCI_CALL(DPI_INTERPOSE_CALL_LOB, "OCILobGetLength2", lob->conn, status,
+            (*dpiOciSymbols.fnLobGetLength2)(lob->conn->handle, error->handle,
+            lob->locator, size))
     return dpiError__check(error, status, lob->conn, "get length");
 }
 
@@ -1658,8 +1814,9 @@ int dpiOci__lobIsOpen(dpiLob *lob, int *isOpen, dpiError *error)
     int status;
 
     DPI_OCI_LOAD_SYMBOL("OCILobIsOpen", dpiOciSymbols.fnLobIsOpen)
-    status = (*dpiOciSymbols.fnLobIsOpen)(lob->conn->handle, error->handle,
-            lob->locator, isOpen);
+    DPI_OCI_CALL(DPI_INTERPOSE_CALL_LOB, "OCILobIsOpen", lob->conn, status,
+            (*dpiOciSymbols.fnLobIsOpen)(lob->conn->handle, error->handle,
+            lob->locator, isOpen))
     return dpiError__check(error, status, lob->conn, "check is open");
 }
 
@@ -1711,8 +1868,9 @@ int dpiOci__lobOpen(dpiLob *lob, dpiError *error)
     DPI_OCI_LOAD_SYMBOL("OCILobOpen", dpiOciSymbols.fnLobOpen)
     mode = (lob->type->oracleTypeNum == DPI_ORACLE_TYPE_BFILE) ?
             DPI_OCI_LOB_READONLY : DPI_OCI_LOB_READWRITE;
-    status = (*dpiOciSymbols.fnLobOpen)(lob->conn->handle, error->handle,
-            lob->locator, mode);
+    DPI_OCI_CALL(DPI_INTERPOSE_CALL_LOB, "OCILobOpen", lob->conn, status,
+            (*dpiOciSymbols.fnLobOpen)(lob->conn->handle, error->handle,
+            lob->locator, mode))
     return dpiError__check(error, status, lob->conn, "close LOB");
 }
 
@@ -1731,10 +1889,11 @@ int dpiOci__lobRead2(dpiLob *lob, uint64_t offset, uint64_t *amountInBytes,
     DPI_OCI_LOAD_SYMBOL("OCILobRead2", dpiOciSymbols.fnLobRead2)
     charsetId = (lob->type->charsetForm == DPI_SQLCS_NCHAR) ?
             lob->env->ncharsetId : lob->env->charsetId;
-    status = (*dpiOciSymbols.fnLobRead2)(lob->conn->handle, error->handle,
+    DPI_OCI_CALL(DPI_INTERPOSE_CALL_LOB, "OCILobRead2", lob->conn, status,
+            (*dpiOciSymbols.fnLobRead2)(lob->conn->handle, error->handle,
             lob->locator, amountInBytes, amountInChars, offset, buffer,
             bufferLength, DPI_OCI_ONE_PIECE, NULL, NULL, charsetId,
-            lob->type->charsetForm);
+            lob->type->charsetForm))
     return dpiError__check(error, status, lob->conn, "read from LOB");
 }
 
@@ -1748,8 +1907,9 @@ int dpiOci__lobTrim2(dpiLob *lob, uint64_t newLength, dpiError *error)
     int status;
 
     DPI_OCI_LOAD_SYMBOL("OCILobTrim2", dpiOciSymbols.fnLobTrim2)
-    status = (*dpiOciSymbols.fnLobTrim2)(lob->conn->handle, error->handle,
-            lob->locator, newLength);
+    DPI_OCI_CALL(DPI_INTERPOSE_CALL_LOB, "OCILobTrim2", lob->conn, status,
+            (*dpiOciSymbols.fnLobTrim2)(lob->conn->handle, error->handle,
+            lob->locator, newLength))
     if (status == DPI_OCI_INVALID_HANDLE)
         return dpiOci__lobCreateTemporary(lob, error);
     return dpiError__check(error, status, lob->conn, "trim LOB");
@@ -1770,10 +1930,11 @@ int dpiOci__lobWrite2(dpiLob *lob, uint64_t offset, const char *value,
     DPI_OCI_LOAD_SYMBOL("OCILobWrite2", dpiOciSymbols.fnLobWrite2)
     charsetId = (lob->type->charsetForm == DPI_SQLCS_NCHAR) ?
             lob->env->ncharsetId : lob->env->charsetId;
-    status = (*dpiOciSymbols.fnLobWrite2)(lob->conn->handle, error->handle,
-            lob->locator, &lengthInBytes, &lengthInChars, offset, (void*) value,
-            valueLength, DPI_OCI_ONE_PIECE, NULL, NULL, charsetId,
-            lob->type->charsetForm);
+    DPI_OCI_CALL(DPI_INTERPOSE_CALL_LOB, "OCILobWrite2", lob->conn, status,
+            (*dpiOciSymbols.fnLobWrite2)(lob->conn->handle, error->handle,
+            lob->locator, &lengthInBytes, &lengthInChars, offset, (void*)
+            value, valueLength, DPI_OCI_ONE_PIECE, NULL, NULL, charsetId,
+            lob->type->charsetForm))
     return dpiError__check(error, status, lob->conn, "write to LOB");
 }
 
@@ -2107,9 +2268,10 @@ int dpiOci__passwordChange(dpiConn *conn, const char *userName,
     int status;
 
     DPI_OCI_LOAD_SYMBOL("OCIPasswordChange", dpiOciSymbols.fnPasswordChange)
-    status = (*dpiOciSymbols.fnPasswordChange)(conn->handle, error->handle,
-            userName, userNameLength, oldPassword, oldPasswordLength,
-            newPassword, newPasswordLength, mode);
+    DPI_OCI_CALL(DPI_INTERPOSE_CALL_ROUND_TRIP, "OCIPasswordChange", conn,
+            status, (*dpiOciSymbols.fnPasswordChange)(conn->handle,
+            error->handle, userName, userNameLength, oldPassword,
+            oldPasswordLength, newPassword, newPasswordLength, mode))
     return dpiError__check(error, status, conn, "change password");
 }
 
@@ -2139,8 +2301,9 @@ int dpiOci__ping(dpiConn *conn, dpiError *error)
     int status;
 
     DPI_OCI_LOAD_SYMBOL("OCIPing", dpiOciSymbols.fnPing)
-    status = (*dpiOciSymbols.fnPing)(conn->handle, error->handle,
-            DPI_OCI_DEFAULT);
+    DPI_OCI_CALL(DPI_INTERPOSE_CALL_ROUND_TRIP, "OCIPing", conn, status,
+            (*dpiOciSymbols.fnPing)(conn->handle, error->handle,
+            DPI_OCI_DEFAULT))
     return dpiError__check(error, status, conn, "ping");
 }
 
@@ -2205,6 +2368,21 @@ int dpiOci__rawSize(dpiEnv *env, void *handle, uint32_t *size)
 }
 
 
+//-----------------------------------------------------------------------------
+// dpiOci__reset() [INTERNAL]
+//   Wrapper for OCIReset().
+//-----------------------------------------------------------------------------
+int dpiOci__reset(dpiConn *conn, dpiError *error)
+{
+    int status;
+
+    DPI_OCI_LOAD_SYMBOL("OCIReset", dpiOciSymbols.fnReset)
+    DPI_OCI_CALL(DPI_INTERPOSE_CALL_ROUND_TRIP, "OCIReset", conn, status,
+            (*dpiOciSymbols.fnReset)(conn->handle, error->handle))
+    return dpiError__check(error, status, conn, "reset after break");
+}
+
+
 //-----------------------------------------------------------------------------
 // dpiOci__rowidToChar() [INTERNAL]
 //   Wrapper for OCIRowidToChar().
@@ -2235,8 +2413,10 @@ int dpiOci__serverAttach(dpiConn *conn, const char *connectString,
     int status;
 
     DPI_OCI_LOAD_SYMBOL("OCIServerAttach", dpiOciSymbols.fnServerAttach)
-    status = (*dpiOciSymbols.fnServerAttach)(conn->serverHandle, error->handle,
-            connectString, connectStringLength, DPI_OCI_DEFAULT);
+    DPI_OCI_CALL(DPI_INTERPOSE_CALL_ROUND_TRIP, "OCIServerAttach", conn,
+            status, (*dpiOciSymbols.fnServerAttach)(conn->serverHandle,
+            error->handle, connectString, connectStringLength,
+            DPI_OCI_DEFAULT))
     return dpiError__check(error, status, conn, "server attach");
 }
 
@@ -2250,8 +2430,9 @@ int dpiOci__serverDetach(dpiConn *conn, int checkError, dpiError *error)
     int status;
 
     DPI_OCI_LOAD_SYMBOL("OCIServerDetach", dpiOciSymbols.fnServerDetach)
-    status = (*dpiOciSymbols.fnServerDetach)(conn->serverHandle, error->handle,
-            DPI_OCI_DEFAULT);
+    DPI_OCI_CALL(DPI_INTERPOSE_CALL_ROUND_TRIP, "OCIServerDetach", conn,
+            status, (*dpiOciSymbols.fnServerDetach)(conn->serverHandle,
+            error->handle, DPI_OCI_DEFAULT))
     if (checkError)
         return dpiError__check(error, status, conn, "detatch from server");
     return DPI_SUCCESS;
@@ -2268,8 +2449,9 @@ int dpiOci__serverRelease(dpiConn *conn, char *buffer, uint32_t bufferSize,
     int status;
 
     DPI_OCI_LOAD_SYMBOL("OCIServerRelease", dpiOciSymbols.fnServerRelease)
-    status = (*dpiOciSymbols.fnServerRelease)(conn->handle, error->handle,
-            buffer, bufferSize, DPI_OCI_HTYPE_SVCCTX, version);
+    DPI_OCI_CALL(DPI_INTERPOSE_CALL_ROUND_TRIP, "OCIServerRelease", conn,
+            status, (*dpiOciSymbols.fnServerRelease)(conn->handle,
+            error->handle, buffer, bufferSize, DPI_OCI_HTYPE_SVCCTX, version))
     return dpiError__check(error, status, conn, "get server version");
 }
 
@@ -2284,8 +2466,9 @@ int dpiOci__sessionBegin(dpiConn *conn, uint32_t credentialType,
     int status;
 
     DPI_OCI_LOAD_SYMBOL("OCISessionBegin", dpiOciSymbols.fnSessionBegin)
-    status = (*dpiOciSymbols.fnSessionBegin)(conn->handle, error->handle,
-            conn->sessionHandle, credentialType, mode);
+    DPI_OCI_CALL(DPI_INTERPOSE_CALL_ROUND_TRIP, "OCISessionBegin", conn,
+            status, (*dpiOciSymbols.fnSessionBegin)(conn->handle,
+            error->handle, conn->sessionHandle, credentialType, mode))
     return dpiError__check(error, status, conn, "begin session");
 }
 
@@ -2299,8 +2482,9 @@ int dpiOci__sessionEnd(dpiConn *conn, int checkError, dpiError *error)
     int status;
 
     DPI_OCI_LOAD_SYMBOL("OCISessionEnd", dpiOciSymbols.fnSessionEnd)
-    status = (*dpiOciSymbols.fnSessionEnd)(conn->handle, error->handle,
-            conn->sessionHandle, DPI_OCI_DEFAULT);
+    DPI_OCI_CALL(DPI_INTERPOSE_CALL_ROUND_TRIP, "OCISessionEnd", conn, status,
+            (*dpiOciSymbols.fnSessionEnd)(conn->handle, error->handle,
+            conn->sessionHandle, DPI_OCI_DEFAULT))
     if (checkError)
         return dpiError__check(error, status, conn, "end session");
     return DPI_SUCCESS;
@@ -2311,7 +2495,7 @@ int dpiOci__sessionEnd(dpiConn *conn, int checkError, dpiError *error)
 // dpiOci__sessionGet() [INTERNAL]
 //   Wrapper for OCISessionGet().
 //-----------------------------------------------------------------------------
-int dpiOci__sessionGet(dpiEnv *env, void **handle, void *authInfo,
+int dpiOci__sessionGet(dpiConn *conn, void *authInfo,
         const char *connectString, uint32_t connectStringLength,
         const char *tag, uint32_t tagLength, const char **outTag,
         uint32_t *outTagLength, int *found, uint32_t mode, dpiError *error)
@@ -2319,9 +2503,10 @@ int dpiOci__sessionGet(dpiEnv *env, void **handle, void *authInfo,
     int status;
 
     DPI_OCI_LOAD_SYMBOL("OCISessionGet", dpiOciSymbols.fnSessionGet)
-    status = (*dpiOciSymbols.fnSessionGet)(env->handle, error->handle, handle,
-            authInfo, connectString, connectStringLength, tag, tagLength,
-            outTag, outTagLength, found, mode);
+    DPI_OCI_CALL(DPI_INTERPOSE_CALL_ROUND_TRIP, "OCISessionGet", conn, status,
+            (*dpiOciSymbols.fnSessionGet)(conn->env->handle, error->handle,
+            &conn->handle, authInfo, connectString, connectStringLength, tag,
+            tagLength, outTag, outTagLength, found, mode))
     return dpiError__check(error, status, NULL, "get session");
 }
 
@@ -2378,14 +2563,60 @@ int dpiOci__sessionRelease(dpiConn *conn, const char *tag, uint32_t tagLength,
     int status;
 
     DPI_OCI_LOAD_SYMBOL("OCISessionRelease", dpiOciSymbols.fnSessionRelease)
-    status = (*dpiOciSymbols.fnSessionRelease)(conn->handle, error->handle,
-            tag, tagLength, mode);
+    DPI_OCI_CALL(DPI_INTERPOSE_CALL_ROUND_TRIP, "OCISessionRelease",
+            (mode & DPI_OCI_SESSRLS_DROPSESS) ? conn : NULL, status,
+            (*dpiOciSymbols.fnSessionRelease)(conn->handle, error->handle, tag,
+            tagLength, mode))
     if (checkError)
         return dpiError__check(error, status, conn, "release session");
     return DPI_SUCCESS;
 }
 
 
+//-----------------------------------------------------------------------------
+// dpiOci__setInterposer() [INTERNAL]
+//   Install the interposer on calls that require round trips, replacing any
+// interposer that was already installed. If the parameters are NULL, the
+// interposer is removed instead. The environment is the global environment;
+// its mutex serializes changes to the interposer made by different threads
+// while the new interposer is published atomically to calls made by other
+// threads, which acquire it without holding the mutex.
+//-----------------------------------------------------------------------------
+int dpiOci__setInterposer(dpiEnv *env, const dpiInterposeParams *params,
+        dpiError *error)
+{
+    dpiOciInterposerEntry *entry = NULL;
+
+    // copy the parameters to memory retained for the lifetime of the process
+    if (params) {
+        entry = malloc(sizeof(dpiOciInterposerEntry));
+        if (!entry)
+            return dpiError__set(error, "allocate interposer",
+                    DPI_ERR_NO_MEMORY);
+        entry->params = *params;
+    }
+
+    // publish the new interposer while holding the mutex
+    if (dpiOci__threadMutexAcquire(env, error) < 0) {
+        if (entry)
+            free(entry);
+        return DPI_FAILURE;
+    }
+    if (entry) {
+        entry->next = dpiOciInterposerEntries;
+        dpiOciInterposerEntries = entry;
+    }
+#ifdef _WIN32
+    InterlockedExchangePointer((PVOID volatile*) &dpiOciInterposer,
+            (entry) ? &entry->params : NULL);
+#else
+    __atomic_store_n(&dpiOciInterposer, (entry) ? &entry->params : NULL,
+            __ATOMIC_RELEASE);
+#endif
+    return dpiOci__threadMutexRelease(env, error);
+}
+
+
 //-----------------------------------------------------------------------------
 // dpiOci__stmtExecute() [INTERNAL]
 //   Wrapper for OCIStmtExecute().
@@ -2396,8 +2627,9 @@ int dpiOci__stmtExecute(dpiStmt *stmt, uint32_t numIters, uint32_t mode,
     int status;
 
     DPI_OCI_LOAD_SYMBOL("OCIStmtExecute", dpiOciSymbols.fnStmtExecute)
-    status = (*dpiOciSymbols.fnStmtExecute)(stmt->conn->handle, stmt->handle,
-            error->handle, numIters, 0, 0, 0, mode);
+    DPI_OCI_CALL(DPI_INTERPOSE_CALL_ROUND_TRIP, "OCIStmtExecute", stmt->conn,
+            status, (*dpiOciSymbols.fnStmtExecute)(stmt->conn->handle,
+            stmt->handle, error->handle, numIters, 0, 0, 0, mode))
     return dpiError__check(error, status, stmt->conn, "execute");
 }
 
@@ -2409,11 +2641,24 @@ int dpiOci__stmtExecute(dpiStmt *stmt, uint32_t numIters, uint32_t mode,
 int dpiOci__stmtFetch2(dpiStmt *stmt, uint32_t numRows, uint16_t fetchMode,
         int32_t offset, dpiError *error)
 {
+    dpiConn *conn;
     int status;
 
     DPI_OCI_LOAD_SYMBOL("OCIStmtFetch2", dpiOciSymbols.fnStmtFetch2)
-    status = (*dpiOciSymbols.fnStmtFetch2)(stmt->handle, error->handle,
-            numRows, fetchMode, offset, DPI_OCI_DEFAULT);
+
+    // the first fetch after a query is executed is satisfied from the rows
+    // prefetched during execution without a round trip, but only if it
+    // requests no more rows than were prefetched
+    conn = stmt->conn;
+    if (stmt->prefetchRows > 0 && numRows <= stmt->prefetchRows &&
+            (fetchMode == DPI_MODE_FETCH_NEXT ||
+            fetchMode == DPI_MODE_FETCH_FIRST))
+        conn = NULL;
+    stmt->prefetchRows = 0;
+
+    DPI_OCI_CALL(DPI_INTERPOSE_CALL_FETCH, "OCIStmtFetch2", conn, status,
+            (*dpiOciSymbols.fnStmtFetch2)(stmt->handle, error->handle, numRows,
+            fetchMode, offset, DPI_OCI_DEFAULT))
     if (status == DPI_OCI_NO_DATA || fetchMode == DPI_MODE_FETCH_LAST)
         stmt->hasRowsToFetch = 0;
     else if (dpiError__check(error, status, stmt->conn, "fetch") < 0)
@@ -2581,8 +2826,9 @@ int dpiOci__subscriptionRegister(dpiConn *conn, void **handle, dpiError *error)
 
     DPI_OCI_LOAD_SYMBOL("OCISubscriptionRegister",
             dpiOciSymbols.fnSubscriptionRegister)
-    status = (*dpiOciSymbols.fnSubscriptionRegister)(conn->handle, handle, 1,
-            error->handle, DPI_OCI_DEFAULT);
+    DPI_OCI_CALL(DPI_INTERPOSE_CALL_ROUND_TRIP, "OCISubscriptionRegister",
+            conn, status, (*dpiOciSymbols.fnSubscriptionRegister)(conn->handle,
+            handle, 1, error->handle, DPI_OCI_DEFAULT))
     return dpiError__check(error, status, conn, "register");
 }
 
@@ -2597,8 +2843,10 @@ int dpiOci__subscriptionUnRegister(dpiSubscr *subscr, dpiError *error)
 
     DPI_OCI_LOAD_SYMBOL("OCISubscriptionUnRegister",
             dpiOciSymbols.fnSubscriptionUnRegister)
-    status = (*dpiOciSymbols.fnSubscriptionUnRegister)(subscr->conn->handle,
-            subscr->handle, error->handle, DPI_OCI_DEFAULT);
+    DPI_OCI_CALL(DPI_INTERPOSE_CALL_ROUND_TRIP, "OCISubscriptionUnRegister",
+            subscr->conn, status,
+            (*dpiOciSymbols.fnSubscriptionUnRegister)(subscr->conn->handle,
+            subscr->handle, error->handle, DPI_OCI_DEFAULT))
     return dpiError__check(error, status, subscr->conn, "unregister");
 }
 
@@ -2711,6 +2959,71 @@ int dpiOci__tableSize(dpiObject *obj, int32_t *size, dpiError *error)
 }
 
 
+//-----------------------------------------------------------------------------
+// dpiOci__threadCreate() [INTERNAL]
+//   Wrapper for OCIThreadCreate(). The thread id and thread handle are
+// allocated first with OCIThreadIdInit() and OCIThreadHndInit(). If the caller
+// requests them, they are returned so that the thread can be joined with
+// dpiOci__threadJoin(); otherwise the thread is never joined and they are
+// retained for the lifetime of the process.
+//-----------------------------------------------------------------------------
+int dpiOci__threadCreate(dpiEnv *env, void (*start)(void*), void *arg,
+        void **threadId, void **threadHandle, dpiError *error)
+{
+    void *tempThreadId, *tempThreadHandle;
+    int status;
+
+    DPI_OCI_LOAD_SYMBOL("OCIThreadIdInit", dpiOciSymbols.fnThreadIdInit)
+    DPI_OCI_LOAD_SYMBOL("OCIThreadHndInit", dpiOciSymbols.fnThreadHndInit)
+    DPI_OCI_LOAD_SYMBOL("OCIThreadCreate", dpiOciSymbols.fnThreadCreate)
+    status = (*dpiOciSymbols.fnThreadIdInit)(env->handle, error->handle,
+            &tempThreadId);
+    if (dpiError__check(error, status, NULL, "initialize thread id") < 0)
+        return DPI_FAILURE;
+    status = (*dpiOciSymbols.fnThreadHndInit)(env->handle, error->handle,
+            &tempThreadHandle);
+    if (dpiError__check(error, status, NULL, "initialize thread handle") < 0)
+        return DPI_FAILURE;
+    status = (*dpiOciSymbols.fnThreadCreate)(env->handle, error->handle,
+            start, arg, tempThreadId, tempThreadHandle);
+    if (dpiError__check(error, status, NULL, "create thread") < 0)
+        return DPI_FAILURE;
+    if (threadId)
+        *threadId = tempThreadId;
+    if (threadHandle)
+        *threadHandle = tempThreadHandle;
+    return DPI_SUCCESS;
+}
+
+
+//-----------------------------------------------------------------------------
+// dpiOci__threadJoin() [INTERNAL]
+//   Wrapper for OCIThreadJoin(). Once the thread has terminated, the thread
+// handle is closed and the thread id and thread handle created by
+// dpiOci__threadCreate() are destroyed.
+//-----------------------------------------------------------------------------
+int dpiOci__threadJoin(dpiEnv *env, void *threadId, void *threadHandle,
+        dpiError *error)
+{
+    int status;
+
+    DPI_OCI_LOAD_SYMBOL("OCIThreadJoin", dpiOciSymbols.fnThreadJoin)
+    DPI_OCI_LOAD_SYMBOL("OCIThreadClose", dpiOciSymbols.fnThreadClose)
+    DPI_OCI_LOAD_SYMBOL("OCIThreadHndDestroy",
+            dpiOciSymbols.fnThreadHndDestroy)
+    DPI_OCI_LOAD_SYMBOL("OCIThreadIdDestroy", dpiOciSymbols.fnThreadIdDestroy)
+    status = (*dpiOciSymbols.fnThreadJoin)(env->handle, error->handle,
+            threadHandle);
+    if (dpiError__check(error, status, NULL, "join thread") < 0)
+        return DPI_FAILURE;
+    (*dpiOciSymbols.fnThreadClose)(env->handle, error->handle, threadHandle);
+    (*dpiOciSymbols.fnThreadHndDestroy)(env->handle, error->handle,
+            &threadHandle);
+    (*dpiOciSymbols.fnThreadIdDestroy)(env->handle, error->handle, &threadId);
+    return DPI_SUCCESS;
+}
+
+
 //-----------------------------------------------------------------------------
 // dpiOci__threadKeyDestroy() [INTERNAL]
 //   Wrapper for OCIThreadKeyDestroy().
@@ -2838,8 +3151,8 @@ int dpiOci__transCommit(dpiConn *conn, uint32_t flags, dpiError *error)
     int status;
 
     DPI_OCI_LOAD_SYMBOL("OCITransCommit", dpiOciSymbols.fnTransCommit)
-    status = (*dpiOciSymbols.fnTransCommit)(conn->handle, error->handle,
-            flags);
+    DPI_OCI_CALL(DPI_INTERPOSE_CALL_ROUND_TRIP, "OCITransCommit", conn, status,
+            (*dpiOciSymbols.fnTransCommit)(conn->handle, error->handle, flags))
     return dpiError__check(error, status, conn, "commit");
 }
 
@@ -2853,8 +3166,9 @@ int dpiOci__transPrepare(dpiConn *conn, int *commitNeeded, dpiError *error)
     int status;
 
     DPI_OCI_LOAD_SYMBOL("OCITransPrepare", dpiOciSymbols.fnTransPrepare)
-    status = (*dpiOciSymbols.fnTransPrepare)(conn->handle, error->handle,
-            DPI_OCI_DEFAULT);
+    DPI_OCI_CALL(DPI_INTERPOSE_CALL_ROUND_TRIP, "OCITransPrepare", conn,
+            status, (*dpiOciSymbols.fnTransPrepare)(conn->handle,
+            error->handle, DPI_OCI_DEFAULT))
     *commitNeeded = (status == DPI_OCI_SUCCESS);
     return dpiError__check(error, status, conn, "prepare transaction");
 }
@@ -2869,8 +3183,9 @@ int dpiOci__transRollback(dpiConn *conn, int checkError, dpiError *error)
     int status;
 
     DPI_OCI_LOAD_SYMBOL("OCITransRollback", dpiOciSymbols.fnTransRollback)
-    status = (*dpiOciSymbols.fnTransRollback)(conn->handle, error->handle,
-            DPI_OCI_DEFAULT);
+    DPI_OCI_CALL(DPI_INTERPOSE_CALL_ROUND_TRIP, "OCITransRollback", conn,
+            status, (*dpiOciSymbols.fnTransRollback)(conn->handle,
+            error->handle, DPI_OCI_DEFAULT))
     if (checkError)
         return dpiError__check(error, status, conn, "rollback");
     return DPI_SUCCESS;
@@ -2886,8 +3201,9 @@ int dpiOci__transStart(dpiConn *conn, dpiError *error)
     int status;
 
     DPI_OCI_LOAD_SYMBOL("OCITransStart", dpiOciSymbols.fnTransStart)
-    status = (*dpiOciSymbols.fnTransStart)(conn->handle, error->handle, 0,
-            DPI_OCI_TRANS_NEW);
+    DPI_OCI_CALL(DPI_INTERPOSE_CALL_ROUND_TRIP, "OCITransStart", conn, status,
+            (*dpiOciSymbols.fnTransStart)(conn->handle, error->handle, 0,
+            DPI_OCI_TRANS_NEW))
     return dpiError__check(error, status, conn, "start transaction");
 }
 
@@ -2902,9 +3218,10 @@ int dpiOci__typeByFullName(dpiConn *conn, const char *name,
     int status;
 
     DPI_OCI_LOAD_SYMBOL("OCITypeByFullName", dpiOciSymbols.fnTypeByFullName)
-    status = (*dpiOciSymbols.fnTypeByFullName)(conn->env->handle,
+    DPI_OCI_CALL(DPI_INTERPOSE_CALL_ROUND_TRIP, "OCITypeByFullName", conn,
+            status, (*dpiOciSymbols.fnTypeByFullName)(conn->env->handle,
             error->handle, conn->handle, name, nameLength, NULL, 0,
-            DPI_OCI_DURATION_SESSION, DPI_OCI_TYPEGET_ALL, tdo);
+            DPI_OCI_DURATION_SESSION, DPI_OCI_TYPEGET_ALL, tdo))
     return dpiError__check(error, status, conn, "get type by full name");
 }
 
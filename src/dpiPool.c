@@ -16,34 +16,172 @@
 
 #include "dpiImpl.h"
 
+// forward declarations of internal functions only used in this file
+static int dpiPool__admit(dpiPool *pool, uint32_t classNum,
+        dpiPoolClass **poolClass, dpiError *error);
+static void dpiPool__recordAcquire(dpiPool *pool, uint64_t startTime,
+        int status, dpiError *error);
+static int dpiPool__resize(dpiPool *pool, const dpiPoolSizingParams *params,
+        uint32_t numAcquires, uint32_t numFailures, uint64_t totalWaitTime,
+        uint32_t peakBusyCount, dpiError *error);
+
+
 //-----------------------------------------------------------------------------
 // dpiPool__acquireConnection() [INTERNAL]
-//   Internal method used for acquiring a connection from a pool.
+//   Internal method used for acquiring a connection from a pool. The request
+// must first be admitted by its admission class, if limits have been set for
+// it. If the pool is being sized elastically, the time taken to acquire the
+// connection is recorded as well.
 //-----------------------------------------------------------------------------
 int dpiPool__acquireConnection(dpiPool *pool, const char *userName,
         uint32_t userNameLength, const char *password, uint32_t passwordLength,
         dpiConnCreateParams *params, dpiConn **conn, dpiError *error)
 {
+    dpiPoolClass *poolClass;
+    uint64_t startTime = 0;
     dpiConn *tempConn;
+    int status;
+
+    // admit the request to its class before any session is used
+    if (dpiPool__admit(pool, params->poolClass, &poolClass, error) < 0)
+        return DPI_FAILURE;
 
     // allocate new connection
     if (dpiGen__allocate(DPI_HTYPE_CONN, pool->env, (void**) &tempConn,
-            error) < 0)
+            error) < 0) {
+        dpiPool__releaseClass(pool, poolClass, error);
         return DPI_FAILURE;
+    }
 
     // create the connection
-    if (dpiConn__get(tempConn, userName, userNameLength, password,
-            passwordLength, pool->name, pool->nameLength, params, pool,
-            error) < 0) {
+    if (pool->sizer.isEnabled)
+        startTime = dpiUtils__getMilliseconds();
+    status = dpiConn__get(tempConn, userName, userNameLength, password,
+            passwordLength, pool->name, pool->nameLength, params, pool, error);
+    if (pool->sizer.isEnabled)
+        dpiPool__recordAcquire(pool, startTime, status, error);
+    if (status < 0) {
         dpiConn__free(tempConn, error);
+        dpiPool__releaseClass(pool, poolClass, error);
         return DPI_FAILURE;
     }
 
+    tempConn->poolClass = poolClass;
     *conn = tempConn;
     return DPI_SUCCESS;
 }
 
 
+//-----------------------------------------------------------------------------
+// dpiPool__addRetryInfo() [INTERNAL]
+//   Add the statistics of an execution retried on a connection acquired from
+// the pool to the totals maintained by the pool. Errors are not reported so
+// that the result of the execution is not disturbed.
+//-----------------------------------------------------------------------------
+void dpiPool__addRetryInfo(dpiPool *pool, dpiRetryInfo *info,
+        dpiError *error)
+{
+    dpiErrorBuffer localErrorBuffer;
+    dpiError localError;
+
+    localError = *error;
+    localError.buffer = &localErrorBuffer;
+    if (pool->env->threaded &&
+            dpiOci__threadMutexAcquire(pool->env, &localError) < 0)
+        return;
+    pool->retryInfo.numRetries += info->numRetries;
+    pool->retryInfo.numSessionsReplaced += info->numSessionsReplaced;
+    pool->retryInfo.numSucceeded += info->numSucceeded;
+    pool->retryInfo.numFailed += info->numFailed;
+    if (pool->env->threaded)
+        dpiOci__threadMutexRelease(pool->env, &localError);
+}
+
+
+//-----------------------------------------------------------------------------
+// dpiPool__addToSharedQueryKey() [INTERNAL]
+//   Append the value to the key of a shared query. If no key is specified,
+// only the length of the key is calculated.
+//-----------------------------------------------------------------------------
+static void dpiPool__addToSharedQueryKey(char *key, uint32_t *keyLength,
+        const void *value, uint32_t valueLength)
+{
+    if (key)
+        memcpy(key + *keyLength, value, valueLength);
+    *keyLength += valueLength;
+}
+
+
+//-----------------------------------------------------------------------------
+// dpiPool__admit() [INTERNAL]
+//   Admit a request to acquire a connection to the given admission class. If
+// no limits have been set for the class the request is admitted without
+// being counted. If the class already has as many busy sessions as its
+// current limit permits, the request is queued if the environment is
+// threaded and the queue is not full; otherwise it is rejected immediately.
+// Queued requests wait until a session of the class is released or until
+// the queue timeout expires. OCI provides no condition variables so queued
+// requests poll at a short interval.
+//-----------------------------------------------------------------------------
+static int dpiPool__admit(dpiPool *pool, uint32_t classNum,
+        dpiPoolClass **poolClass, dpiError *error)
+{
+    int queued = 0, done = 0, status = DPI_SUCCESS;
+    uint64_t startTime, elapsed = 0;
+    dpiPoolClass *tempClass;
+
+    // validate class
+    *poolClass = NULL;
+    if (classNum >= DPI_MAX_POOL_CLASSES)
+        return dpiError__set(error, "check pool class",
+                DPI_ERR_INVALID_POOL_CLASS, classNum, DPI_MAX_POOL_CLASSES);
+    tempClass = &pool->classes[classNum];
+
+    // wait until the request has been admitted or rejected
+    startTime = dpiUtils__getMilliseconds();
+    while (1) {
+        if (pool->env->threaded &&
+                dpiOci__threadMutexAcquire(pool->env, error) < 0)
+            return DPI_FAILURE;
+        if (!tempClass->isEnabled) {
+            if (queued)
+                tempClass->queuedCount--;
+            done = 1;
+        } else if (tempClass->busyCount < (uint32_t) tempClass->limit) {
+            if (queued)
+                tempClass->queuedCount--;
+            tempClass->busyCount++;
+            tempClass->numAdmitted++;
+            *poolClass = tempClass;
+            done = 1;
+        } else if (!queued) {
+            if (!pool->env->threaded ||
+                    tempClass->queuedCount >= tempClass->params.maxQueued) {
+                tempClass->numRejected++;
+                status = dpiError__set(error, "check pool class",
+                        DPI_ERR_POOL_CLASS_FULL, classNum,
+                        tempClass->busyCount, tempClass->queuedCount);
+            } else {
+                tempClass->queuedCount++;
+                queued = 1;
+            }
+        } else if (tempClass->params.queueTimeout > 0 &&
+                elapsed >= tempClass->params.queueTimeout) {
+            tempClass->queuedCount--;
+            tempClass->numTimedOut++;
+            status = dpiError__set(error, "wait for pool class",
+                    DPI_ERR_POOL_CLASS_TIMEOUT, classNum, (uint32_t) elapsed);
+        }
+        if (pool->env->threaded)
+            dpiOci__threadMutexRelease(pool->env, error);
+        if (done || status < 0)
+            return status;
+        dpiUtils__sleep(DPI_POOL_CLASS_POLL_MS);
+        elapsed = dpiUtils__getMilliseconds() - startTime;
+    }
+}
+
+
 //-----------------------------------------------------------------------------
 // dpiPool__checkConnected() [INTERNAL]
 //   Determine if the session pool is connected to the database. If not, an
@@ -120,6 +258,9 @@ static int dpiPool__create(dpiPool *pool, const char *userName,
         return DPI_FAILURE;
 
     // set reamining attributes directly
+    pool->minSessions = createParams->minSessions;
+    pool->maxSessions = createParams->maxSessions;
+    pool->sessionIncrement = createParams->sessionIncrement;
     pool->homogeneous = createParams->homogeneous;
     pool->externalAuth = createParams->externalAuth;
     pool->pingInterval = createParams->pingInterval;
@@ -128,6 +269,174 @@ static int dpiPool__create(dpiPool *pool, const char *userName,
 }
 
 
+//-----------------------------------------------------------------------------
+// dpiPool__evaluateSize() [INTERNAL]
+//   Called when a connection is released back to the pool. Once the sample
+// interval has elapsed, and no other thread is already resizing the pool, the
+// statistics gathered when connections were acquired are used to resize the
+// pool and are then reset. Errors encountered while doing so are not
+// reported; a separate error buffer is used so that the result of releasing
+// the connection is not disturbed and the next evaluation will simply try
+// again.
+//-----------------------------------------------------------------------------
+void dpiPool__evaluateSize(dpiPool *pool, dpiError *error)
+{
+    uint32_t numAcquires, numFailures, peakBusyCount;
+    dpiPoolSizer *sizer = &pool->sizer;
+    dpiErrorBuffer localErrorBuffer;
+    uint64_t now, totalWaitTime;
+    dpiPoolSizingParams params;
+    dpiError localError;
+    int evaluate = 0;
+
+    // use a separate error buffer
+    localError = *error;
+    localError.buffer = &localErrorBuffer;
+
+    // if the sample interval has elapsed and no other thread is already
+    // resizing the pool, take a snapshot of the statistics and reset them
+    now = dpiUtils__getMilliseconds();
+    if (pool->env->threaded &&
+            dpiOci__threadMutexAcquire(pool->env, &localError) < 0)
+        return;
+    if (pool->handle && sizer->isEnabled && !sizer->inProgress &&
+            now - sizer->intervalStart >=
+            (uint64_t) sizer->params.sampleInterval * 1000) {
+        evaluate = 1;
+        sizer->inProgress = 1;
+        params = sizer->params;
+        numAcquires = sizer->numAcquires;
+        numFailures = sizer->numFailures;
+        totalWaitTime = sizer->totalWaitTime;
+        peakBusyCount = sizer->peakBusyCount;
+        sizer->intervalStart = now;
+        sizer->numAcquires = 0;
+        sizer->numFailures = 0;
+        sizer->totalWaitTime = 0;
+        sizer->peakBusyCount = 0;
+    }
+    if (pool->env->threaded)
+        dpiOci__threadMutexRelease(pool->env, &localError);
+    if (!evaluate)
+        return;
+
+    // resize the pool outside of the mutex as this may create sessions
+    dpiPool__resize(pool, &params, numAcquires, numFailures, totalWaitTime,
+            peakBusyCount, &localError);
+    if (pool->env->threaded &&
+            dpiOci__threadMutexAcquire(pool->env, &localError) < 0)
+        return;
+    sizer->inProgress = 0;
+    if (pool->env->threaded)
+        dpiOci__threadMutexRelease(pool->env, &localError);
+}
+
+
+//-----------------------------------------------------------------------------
+// dpiPool__executeSharedQuery() [INTERNAL]
+//   Execute a shared query on a connection acquired from the pool with the
+// default parameters. The connection is released as soon as all of the rows
+// have been fetched; errors raised while releasing it are not reported so
+// that the outcome of the query is retained.
+//-----------------------------------------------------------------------------
+static int dpiPool__executeSharedQuery(dpiPool *pool, const char *sql,
+        uint32_t sqlLength, uint32_t numBinds,
+        dpiNativeTypeNum *bindNativeTypeNums, dpiData *bindValues,
+        dpiSharedResult **result, dpiError *error)
+{
+    dpiErrorBuffer localErrorBuffer;
+    dpiSharedResult *tempResult;
+    dpiConnCreateParams params;
+    dpiError localError;
+    dpiConn *conn;
+    int status;
+
+    // acquire a connection
+    if (dpiContext__initConnCreateParams(pool->env->context, &params,
+            error) < 0)
+        return DPI_FAILURE;
+    if (dpiSharedResult__allocate(pool, &tempResult, error) < 0)
+        return DPI_FAILURE;
+    if (dpiPool__acquireConnection(pool, NULL, 0, NULL, 0, &params, &conn,
+            error) < 0) {
+        dpiSharedResult__free(tempResult, error);
+        return DPI_FAILURE;
+    }
+
+    // execute the query and release the connection
+    status = dpiStmt__queryShared(conn, sql, sqlLength, numBinds,
+            bindNativeTypeNums, bindValues, tempResult, error);
+    localError = *error;
+    localError.buffer = &localErrorBuffer;
+    dpiGen__setRefCount(conn, &localError, -1);
+    if (status < 0) {
+        dpiSharedResult__free(tempResult, error);
+        return DPI_FAILURE;
+    }
+
+    *result = tempResult;
+    return DPI_SUCCESS;
+}
+
+
+//-----------------------------------------------------------------------------
+// dpiPool__finishSharedQuery() [INTERNAL]
+//   Publish the outcome of a shared query to the callers which joined it.
+// The query is first removed from the pool so that callers arriving later
+// start a new query instead of receiving a result which may be stale. As it
+// can no longer be joined, the number of callers waiting for it is then known
+// and a reference to the result is added for each of them before it is
+// published. If the query failed, its error is published instead. Errors are
+// not reported so that the outcome of the query is retained.
+//-----------------------------------------------------------------------------
+static void dpiPool__finishSharedQuery(dpiPool *pool, dpiSharedQuery *query,
+        dpiSharedResult *result, dpiError *error)
+{
+    dpiErrorBuffer localErrorBuffer;
+    unsigned numWaiting, numUsers;
+    dpiSharedQuery **bucket;
+    dpiError localError;
+
+    // remove the query from the pool
+    localError = *error;
+    localError.buffer = &localErrorBuffer;
+    bucket = &pool->sharedQueries[query->hash % DPI_SHARED_QUERY_NUM_BUCKETS];
+    if (pool->env->threaded &&
+            dpiOci__threadMutexAcquire(pool->env, &localError) < 0)
+        return;
+    while (*bucket != query)
+        bucket = &(*bucket)->next;
+    *bucket = query->next;
+    numWaiting = query->numUsers - 1;
+    if (pool->env->threaded)
+        dpiOci__threadMutexRelease(pool->env, &localError);
+
+    // add a reference to the result for each of the waiting callers
+    if (!result)
+        memcpy(&query->errorBuffer, error->buffer, sizeof(dpiErrorBuffer));
+    else if (numWaiting > 0 && dpiGen__setRefCount(result, &localError,
+            (int) numWaiting) < 0) {
+        memcpy(&query->errorBuffer, &localErrorBuffer,
+                sizeof(dpiErrorBuffer));
+        result = NULL;
+    }
+
+    // publish the outcome; the last caller to see it frees the query
+    if (pool->env->threaded &&
+            dpiOci__threadMutexAcquire(pool->env, &localError) < 0)
+        return;
+    query->result = result;
+    query->done = 1;
+    numUsers = --query->numUsers;
+    if (pool->env->threaded)
+        dpiOci__threadMutexRelease(pool->env, &localError);
+    if (numUsers == 0) {
+        free(query->key);
+        free(query);
+    }
+}
+
+
 //-----------------------------------------------------------------------------
 // dpiPool__free() [INTERNAL]
 //   Free any memory associated with the pool.
@@ -172,6 +481,385 @@ static int dpiPool__getAttributeUint(dpiPool *pool, uint32_t attribute,
 }
 
 
+//-----------------------------------------------------------------------------
+// dpiPool__getSharedQueryKey() [INTERNAL]
+//   Build the key which identifies a shared query from the SQL text and the
+// bind values. The key is built in two passes: the first calculates its
+// length and the second populates it. Each value is added field by field so
+// that padding does not affect the key. Values which refer to handles are
+// only valid for the connection on which they were created and are rejected.
+//-----------------------------------------------------------------------------
+static int dpiPool__getSharedQueryKey(const char *sql, uint32_t sqlLength,
+        uint32_t numBinds, dpiNativeTypeNum *bindNativeTypeNums,
+        dpiData *bindValues, char **key, uint32_t *keyLength,
+        dpiError *error)
+{
+    dpiTimestamp *timestamp;
+    char *tempKey = NULL;
+    uint32_t pass, i;
+    dpiData *data;
+
+    for (pass = 0; pass < 2; pass++) {
+        *keyLength = 0;
+        dpiPool__addToSharedQueryKey(tempKey, keyLength, &sqlLength,
+                sizeof(sqlLength));
+        dpiPool__addToSharedQueryKey(tempKey, keyLength, sql, sqlLength);
+        for (i = 0; i < numBinds; i++) {
+            data = &bindValues[i];
+            dpiPool__addToSharedQueryKey(tempKey, keyLength,
+                    &bindNativeTypeNums[i], sizeof(dpiNativeTypeNum));
+            dpiPool__addToSharedQueryKey(tempKey, keyLength, &data->isNull,
+                    sizeof(data->isNull));
+            if (data->isNull)
+                continue;
+            switch (bindNativeTypeNums[i]) {
+                case DPI_NATIVE_TYPE_INT64:
+                case DPI_NATIVE_TYPE_UINT64:
+                    dpiPool__addToSharedQueryKey(tempKey, keyLength,
+                            &data->value.asInt64, sizeof(int64_t));
+                    break;
+                case DPI_NATIVE_TYPE_FLOAT:
+                    dpiPool__addToSharedQueryKey(tempKey, keyLength,
+                            &data->value.asFloat, sizeof(float));
+                    break;
+                case DPI_NATIVE_TYPE_DOUBLE:
+                    dpiPool__addToSharedQueryKey(tempKey, keyLength,
+                            &data->value.asDouble, sizeof(double));
+                    break;
+                case DPI_NATIVE_TYPE_BYTES:
+                    dpiPool__addToSharedQueryKey(tempKey, keyLength,
+                            &data->value.asBytes.length, sizeof(uint32_t));
+                    dpiPool__addToSharedQueryKey(tempKey, keyLength,
+                            data->value.asBytes.ptr,
+                            data->value.asBytes.length);
+                    break;
+                case DPI_NATIVE_TYPE_TIMESTAMP:
+                    timestamp = &data->value.asTimestamp;
+                    dpiPool__addToSharedQueryKey(tempKey, keyLength,
+                            &timestamp->year, sizeof(timestamp->year));
+                    dpiPool__addToSharedQueryKey(tempKey, keyLength,
+                            &timestamp->month, sizeof(timestamp->month));
+                    dpiPool__addToSharedQueryKey(tempKey, keyLength,
+                            &timestamp->day, sizeof(timestamp->day));
+                    dpiPool__addToSharedQueryKey(tempKey, keyLength,
+                            &timestamp->hour, sizeof(timestamp->hour));
+                    dpiPool__addToSharedQueryKey(tempKey, keyLength,
+                            &timestamp->minute, sizeof(timestamp->minute));
+                    dpiPool__addToSharedQueryKey(tempKey, keyLength,
+                            &timestamp->second, sizeof(timestamp->second));
+                    dpiPool__addToSharedQueryKey(tempKey, keyLength,
+                            &timestamp->fsecond, sizeof(timestamp->fsecond));
+                    dpiPool__addToSharedQueryKey(tempKey, keyLength,
+                            &timestamp->tzHourOffset,
+                            sizeof(timestamp->tzHourOffset));
+                    dpiPool__addToSharedQueryKey(tempKey, keyLength,
+                            &timestamp->tzMinuteOffset,
+                            sizeof(timestamp->tzMinuteOffset));
+                    break;
+                case DPI_NATIVE_TYPE_INTERVAL_DS:
+                    dpiPool__addToSharedQueryKey(tempKey, keyLength,
+                            &data->value.asIntervalDS, sizeof(dpiIntervalDS));
+                    break;
+                case DPI_NATIVE_TYPE_INTERVAL_YM:
+                    dpiPool__addToSharedQueryKey(tempKey, keyLength,
+                            &data->value.asIntervalYM, sizeof(dpiIntervalYM));
+                    break;
+                case DPI_NATIVE_TYPE_BOOLEAN:
+                    dpiPool__addToSharedQueryKey(tempKey, keyLength,
+                            &data->value.asBoolean, sizeof(int));
+                    break;
+                default:
+                    return dpiError__set(error, "check bind type",
+                            DPI_ERR_NOT_SHAREABLE, bindNativeTypeNums[i]);
+            }
+        }
+        if (pass == 0) {
+            tempKey = malloc(*keyLength);
+            if (!tempKey)
+                return dpiError__set(error, "allocate key",
+                        DPI_ERR_NO_MEMORY);
+        }
+    }
+
+    *key = tempKey;
+    return DPI_SUCCESS;
+}
+
+
+//-----------------------------------------------------------------------------
+// dpiPool__joinSharedQuery() [INTERNAL]
+//   Join the shared query with the given key if one is in progress;
+// otherwise, start a new one which the caller is then responsible for
+// executing. Queries in progress are found using the FNV-1a hash of their
+// keys. The key is owned (or freed) by this function.
+//-----------------------------------------------------------------------------
+static int dpiPool__joinSharedQuery(dpiPool *pool, char *key,
+        uint32_t keyLength, dpiSharedQuery **query, int *isLeader,
+        dpiError *error)
+{
+    dpiSharedQuery *tempQuery, **bucket;
+    uint32_t hash, i;
+
+    // calculate the hash of the key
+    hash = 2166136261u;
+    for (i = 0; i < keyLength; i++)
+        hash = (hash ^ (uint8_t) key[i]) * 16777619u;
+    bucket = &pool->sharedQueries[hash % DPI_SHARED_QUERY_NUM_BUCKETS];
+
+    // look for a query in progress with the same key
+    if (pool->env->threaded &&
+            dpiOci__threadMutexAcquire(pool->env, error) < 0) {
+        free(key);
+        return DPI_FAILURE;
+    }
+    for (tempQuery = *bucket; tempQuery; tempQuery = tempQuery->next) {
+        if (tempQuery->hash == hash && tempQuery->keyLength == keyLength &&
+                memcmp(tempQuery->key, key, keyLength) == 0)
+            break;
+    }
+
+    // join the query, if one was found; otherwise, start a new one
+    if (tempQuery) {
+        tempQuery->numUsers++;
+        free(key);
+        *isLeader = 0;
+    } else {
+        tempQuery = calloc(1, sizeof(dpiSharedQuery));
+        if (!tempQuery) {
+            if (pool->env->threaded)
+                dpiOci__threadMutexRelease(pool->env, error);
+            free(key);
+            return dpiError__set(error, "allocate shared query",
+                    DPI_ERR_NO_MEMORY);
+        }
+        tempQuery->key = key;
+        tempQuery->keyLength = keyLength;
+        tempQuery->hash = hash;
+        tempQuery->numUsers = 1;
+        tempQuery->next = *bucket;
+        *bucket = tempQuery;
+        *isLeader = 1;
+    }
+    if (pool->env->threaded)
+        dpiOci__threadMutexRelease(pool->env, error);
+
+    *query = tempQuery;
+    return DPI_SUCCESS;
+}
+
+
+//-----------------------------------------------------------------------------
+// dpiPool__recordAcquire() [INTERNAL]
+//   Record the time taken to acquire a connection from the pool (and whether
+// the attempt succeeded) along with the number of busy sessions. The pool is
+// not resized here; that is left to dpiPool__evaluateSize(), which is called
+// when connections are released, so that the time taken to resize the pool
+// is never added to the time taken to acquire a connection. Errors are not
+// reported; a separate error buffer is used so that the result of acquiring
+// the connection is not disturbed.
+//-----------------------------------------------------------------------------
+static void dpiPool__recordAcquire(dpiPool *pool, uint64_t startTime,
+        int status, dpiError *error)
+{
+    dpiPoolSizer *sizer = &pool->sizer;
+    dpiErrorBuffer localErrorBuffer;
+    dpiError localError;
+    uint32_t busyCount;
+    uint64_t now;
+
+    // use a separate error buffer
+    localError = *error;
+    localError.buffer = &localErrorBuffer;
+
+    // determine the number of busy sessions
+    now = dpiUtils__getMilliseconds();
+    if (dpiOci__attrGet(pool->handle, DPI_OCI_HTYPE_SPOOL, &busyCount, NULL,
+            DPI_OCI_ATTR_SPOOL_BUSY_COUNT, "get busy count", &localError) < 0)
+        return;
+
+    // accumulate statistics
+    if (pool->env->threaded &&
+            dpiOci__threadMutexAcquire(pool->env, &localError) < 0)
+        return;
+    if (sizer->isEnabled) {
+        sizer->numAcquires++;
+        sizer->totalWaitTime += now - startTime;
+        if (status < 0)
+            sizer->numFailures++;
+        if (busyCount > sizer->peakBusyCount)
+            sizer->peakBusyCount = busyCount;
+    }
+    if (pool->env->threaded)
+        dpiOci__threadMutexRelease(pool->env, &localError);
+}
+
+
+//-----------------------------------------------------------------------------
+// dpiPool__recordLatency() [INTERNAL]
+//   Record the time taken by an execution on a connection admitted by the
+// given admission class. If the class has a latency target, its limit is
+// adjusted using additive increase and multiplicative decrease: executions
+// that meet the target raise the limit by one session for each full limit's
+// worth of such executions, while an execution that misses the target cuts
+// the limit to the configured percentage of its value. The limit is cut at
+// most once per measurement window: executions that were already in progress
+// when the limit was last cut experienced the load that caused that cut, so
+// missing the target does not cut the limit again. The limit is kept between
+// the minimum and maximum number of sessions of the class. Errors are not
+// reported so that the result of the execution is not disturbed.
+//-----------------------------------------------------------------------------
+void dpiPool__recordLatency(dpiPool *pool, dpiPoolClass *poolClass,
+        uint64_t elapsed, dpiError *error)
+{
+    dpiErrorBuffer localErrorBuffer;
+    double minLimit, maxLimit;
+    dpiError localError;
+    uint64_t now;
+
+    // use a separate error buffer
+    localError = *error;
+    localError.buffer = &localErrorBuffer;
+    now = dpiUtils__getMilliseconds();
+
+    // adjust the limit
+    if (pool->env->threaded &&
+            dpiOci__threadMutexAcquire(pool->env, &localError) < 0)
+        return;
+    if (poolClass->isEnabled && poolClass->params.latencyTarget > 0) {
+        maxLimit = poolClass->params.maxSessions;
+        minLimit = (poolClass->params.minSessions > 0) ?
+                poolClass->params.minSessions : 1;
+        if (minLimit > maxLimit)
+            minLimit = maxLimit;
+        if (elapsed > poolClass->params.latencyTarget) {
+            if (now - elapsed >= poolClass->lastDecreaseTime) {
+                poolClass->limit = poolClass->limit *
+                        poolClass->params.backoffPercent / 100;
+                poolClass->lastDecreaseTime = now;
+            }
+        } else poolClass->limit += 1 /
+                ((poolClass->limit < 1) ? 1 : poolClass->limit);
+        if (poolClass->limit < minLimit)
+            poolClass->limit = minLimit;
+        if (poolClass->limit > maxLimit)
+            poolClass->limit = maxLimit;
+    }
+    if (pool->env->threaded)
+        dpiOci__threadMutexRelease(pool->env, &localError);
+}
+
+
+//-----------------------------------------------------------------------------
+// dpiPool__reinitialize() [INTERNAL]
+//   Change the minimum, maximum and increment of the pool. OCI creates or
+// terminates sessions as needed to match the new values.
+//-----------------------------------------------------------------------------
+static int dpiPool__reinitialize(dpiPool *pool, uint32_t minSessions,
+        uint32_t maxSessions, uint32_t sessionIncrement, dpiError *error)
+{
+    if (minSessions > maxSessions)
+        return dpiError__set(error, "check pool size",
+                DPI_ERR_POOL_MIN_EXCEEDS_MAX, minSessions, maxSessions);
+    if (dpiOci__sessionPoolCreate(pool, NULL, 0, minSessions, maxSessions,
+            sessionIncrement, NULL, 0, NULL, 0, DPI_OCI_SPC_REINITIALIZE,
+            error) < 0)
+        return DPI_FAILURE;
+    pool->minSessions = minSessions;
+    pool->maxSessions = maxSessions;
+    pool->sessionIncrement = sessionIncrement;
+    return DPI_SUCCESS;
+}
+
+
+//-----------------------------------------------------------------------------
+// dpiPool__releaseClass() [INTERNAL]
+//   Release the slot held in the admission class by a connection whose
+// session has been released back to the pool (or never acquired). The slot
+// is released even if the limits of the class have since been removed so
+// that the count of busy sessions remains accurate if they are set again.
+// Errors are not reported.
+//-----------------------------------------------------------------------------
+void dpiPool__releaseClass(dpiPool *pool, dpiPoolClass *poolClass,
+        dpiError *error)
+{
+    dpiErrorBuffer localErrorBuffer;
+    dpiError localError;
+
+    if (!poolClass)
+        return;
+    localError = *error;
+    localError.buffer = &localErrorBuffer;
+    if (pool->env->threaded &&
+            dpiOci__threadMutexAcquire(pool->env, &localError) < 0)
+        return;
+    poolClass->busyCount--;
+    if (pool->env->threaded)
+        dpiOci__threadMutexRelease(pool->env, &localError);
+}
+
+
+//-----------------------------------------------------------------------------
+// dpiPool__resize() [INTERNAL]
+//   Determine the size the pool ought to be, given the statistics gathered
+// during the last sample interval, and reinitialize it if that differs from
+// its current size. Demand is the peak number of busy sessions plus the
+// number of spare sessions requested. If acquires failed, waited too long or
+// demand exceeded the maximum, the maximum is grown by at least the increment;
+// otherwise, if demand fell below the maximum, the maximum is shrunk by at
+// most the increment. The minimum follows demand so that sessions are opened
+// ahead of it and idle sessions can be timed out by the pool. All values are
+// kept within the limits specified by the sizing parameters.
+//-----------------------------------------------------------------------------
+static int dpiPool__resize(dpiPool *pool, const dpiPoolSizingParams *params,
+        uint32_t numAcquires, uint32_t numFailures, uint64_t totalWaitTime,
+        uint32_t peakBusyCount, dpiError *error)
+{
+    uint32_t demand, minSessions, maxSessions, sessionIncrement;
+    uint64_t averageWaitTime;
+
+    // determine demand and the average time taken to acquire a connection
+    demand = (peakBusyCount > UINT_MAX - params->spareSessions) ? UINT_MAX :
+            peakBusyCount + params->spareSessions;
+    averageWaitTime = (numAcquires > 0) ? totalWaitTime / numAcquires : 0;
+
+    // determine new maximum
+    maxSessions = pool->maxSessions;
+    if (numFailures > 0 || averageWaitTime >= params->waitThreshold ||
+            demand > maxSessions) {
+        if (maxSessions > UINT_MAX - params->sessionIncrement)
+            maxSessions = UINT_MAX;
+        else maxSessions += params->sessionIncrement;
+        if (demand > maxSessions)
+            maxSessions = demand;
+    } else if (demand < maxSessions) {
+        if (maxSessions - demand > params->sessionIncrement)
+            maxSessions -= params->sessionIncrement;
+        else maxSessions = demand;
+    }
+    if (maxSessions > params->maxSessions)
+        maxSessions = params->maxSessions;
+    if (maxSessions < params->minSessions)
+        maxSessions = params->minSessions;
+
+    // determine new minimum and increment
+    minSessions = demand;
+    if (minSessions > maxSessions)
+        minSessions = maxSessions;
+    if (minSessions < params->minSessions)
+        minSessions = params->minSessions;
+    sessionIncrement = params->sessionIncrement;
+    if (sessionIncrement > maxSessions - minSessions)
+        sessionIncrement = maxSessions - minSessions;
+
+    // reinitialize the pool only if something has changed
+    if (minSessions == pool->minSessions && maxSessions == pool->maxSessions &&
+            sessionIncrement == pool->sessionIncrement)
+        return DPI_SUCCESS;
+    return dpiPool__reinitialize(pool, minSessions, maxSessions,
+            sessionIncrement, error);
+}
+
+
 //-----------------------------------------------------------------------------
 // dpiPool__setAttributeUint() [INTERNAL]
 //   Set the value of the OCI attribute as an unsigned integer.
@@ -209,6 +897,45 @@ static int dpiPool__setAttributeUint(dpiPool *pool, uint32_t attribute,
 }
 
 
+//-----------------------------------------------------------------------------
+// dpiPool__waitForSharedQuery() [INTERNAL]
+//   Wait for a shared query started by another caller to complete and return
+// its result, or the error it raised. OCI provides no condition variables so
+// waiting callers poll at a short interval.
+//-----------------------------------------------------------------------------
+static int dpiPool__waitForSharedQuery(dpiPool *pool, dpiSharedQuery *query,
+        dpiSharedResult **result, dpiError *error)
+{
+    int done = 0, freeQuery = 0;
+
+    while (1) {
+        if (pool->env->threaded &&
+                dpiOci__threadMutexAcquire(pool->env, error) < 0)
+            return DPI_FAILURE;
+        if (query->done) {
+            *result = query->result;
+            if (!query->result)
+                memcpy(error->buffer, &query->errorBuffer,
+                        sizeof(dpiErrorBuffer));
+            freeQuery = (--query->numUsers == 0);
+            done = 1;
+        }
+        if (pool->env->threaded)
+            dpiOci__threadMutexRelease(pool->env, error);
+        if (done)
+            break;
+        dpiUtils__sleep(DPI_SHARED_QUERY_POLL_MS);
+    }
+
+    // the last caller to see the outcome frees the query
+    if (freeQuery) {
+        free(query->key);
+        free(query);
+    }
+    return (*result) ? DPI_SUCCESS : DPI_FAILURE;
+}
+
+
 //-----------------------------------------------------------------------------
 // dpiPool_acquireConnection() [PUBLIC]
 //   Acquire a connection from the pool.
@@ -341,6 +1068,38 @@ int dpiPool_getBusyCount(dpiPool *pool, uint32_t *value)
 }
 
 
+//-----------------------------------------------------------------------------
+// dpiPool_getClassInfo() [PUBLIC]
+//   Return the current limit and statistics of the admission class.
+//-----------------------------------------------------------------------------
+int dpiPool_getClassInfo(dpiPool *pool, uint32_t poolClass,
+        dpiPoolClassInfo *info)
+{
+    dpiPoolClass *tempClass;
+    dpiError error;
+
+    if (dpiPool__checkConnected(pool, __func__, &error) < 0)
+        return DPI_FAILURE;
+    DPI_CHECK_PTR_NOT_NULL(info)
+    if (poolClass >= DPI_MAX_POOL_CLASSES)
+        return dpiError__set(&error, "check pool class",
+                DPI_ERR_INVALID_POOL_CLASS, poolClass, DPI_MAX_POOL_CLASSES);
+    tempClass = &pool->classes[poolClass];
+    if (pool->env->threaded &&
+            dpiOci__threadMutexAcquire(pool->env, &error) < 0)
+        return DPI_FAILURE;
+    info->limit = (tempClass->isEnabled) ? (uint32_t) tempClass->limit : 0;
+    info->busyCount = tempClass->busyCount;
+    info->queuedCount = tempClass->queuedCount;
+    info->numAdmitted = tempClass->numAdmitted;
+    info->numRejected = tempClass->numRejected;
+    info->numTimedOut = tempClass->numTimedOut;
+    if (pool->env->threaded)
+        return dpiOci__threadMutexRelease(pool->env, &error);
+    return DPI_SUCCESS;
+}
+
+
 //-----------------------------------------------------------------------------
 // dpiPool_getEncodingInfo() [PUBLIC]
 //   Get the encoding information from the pool.
@@ -398,6 +1157,28 @@ int dpiPool_getOpenCount(dpiPool *pool, uint32_t *value)
 }
 
 
+//-----------------------------------------------------------------------------
+// dpiPool_getRetryInfo() [PUBLIC]
+//   Return statistics about the executions retried on connections acquired
+// from the pool.
+//-----------------------------------------------------------------------------
+int dpiPool_getRetryInfo(dpiPool *pool, dpiRetryInfo *info)
+{
+    dpiError error;
+
+    if (dpiPool__checkConnected(pool, __func__, &error) < 0)
+        return DPI_FAILURE;
+    DPI_CHECK_PTR_NOT_NULL(info)
+    if (pool->env->threaded &&
+            dpiOci__threadMutexAcquire(pool->env, &error) < 0)
+        return DPI_FAILURE;
+    *info = pool->retryInfo;
+    if (pool->env->threaded)
+        return dpiOci__threadMutexRelease(pool->env, &error);
+    return DPI_SUCCESS;
+}
+
+
 //-----------------------------------------------------------------------------
 // dpiPool_getStmtCacheSize() [PUBLIC]
 //   Return the pool's default statement cache size.
@@ -420,6 +1201,64 @@ int dpiPool_getTimeout(dpiPool *pool, uint32_t *value)
 }
 
 
+//-----------------------------------------------------------------------------
+// dpiPool_queryShared() [PUBLIC]
+//   Execute a query and fetch all of its rows on behalf of all callers with
+// the same SQL and bind values whose calls overlap. The first such caller
+// executes the query on a connection acquired from the pool and the others
+// wait for it to complete and share its result (or error). Nothing is
+// retained once the query has completed.
+//-----------------------------------------------------------------------------
+int dpiPool_queryShared(dpiPool *pool, const char *sql, uint32_t sqlLength,
+        uint32_t numBinds, dpiNativeTypeNum *bindNativeTypeNums,
+        dpiData *bindValues, dpiSharedResult **result)
+{
+    dpiSharedQuery *query = NULL;
+    int isLeader = 0, status;
+    char *key = NULL;
+    uint32_t keyLength;
+    dpiError error;
+
+    if (dpiPool__checkConnected(pool, __func__, &error) < 0)
+        return DPI_FAILURE;
+    DPI_CHECK_PTR_AND_LENGTH(sql)
+    if (numBinds > 0) {
+        DPI_CHECK_PTR_NOT_NULL(bindNativeTypeNums)
+        DPI_CHECK_PTR_NOT_NULL(bindValues)
+    }
+    DPI_CHECK_PTR_NOT_NULL(result)
+    *result = NULL;
+    if (dpiPool__getSharedQueryKey(sql, sqlLength, numBinds,
+            bindNativeTypeNums, bindValues, &key, &keyLength, &error) < 0)
+        return DPI_FAILURE;
+    if (dpiPool__joinSharedQuery(pool, key, keyLength, &query, &isLeader,
+            &error) < 0)
+        return DPI_FAILURE;
+    if (!isLeader)
+        return dpiPool__waitForSharedQuery(pool, query, result, &error);
+    status = dpiPool__executeSharedQuery(pool, sql, sqlLength, numBinds,
+            bindNativeTypeNums, bindValues, result, &error);
+    dpiPool__finishSharedQuery(pool, query, *result, &error);
+    return status;
+}
+
+
+//-----------------------------------------------------------------------------
+// dpiPool_reconfigure() [PUBLIC]
+//   Change the minimum, maximum and increment of the pool.
+//-----------------------------------------------------------------------------
+int dpiPool_reconfigure(dpiPool *pool, uint32_t minSessions,
+        uint32_t maxSessions, uint32_t sessionIncrement)
+{
+    dpiError error;
+
+    if (dpiPool__checkConnected(pool, __func__, &error) < 0)
+        return DPI_FAILURE;
+    return dpiPool__reinitialize(pool, minSessions, maxSessions,
+            sessionIncrement, &error);
+}
+
+
 //-----------------------------------------------------------------------------
 // dpiPool_release() [PUBLIC]
 //   Release a reference to the pool.
@@ -430,6 +1269,58 @@ int dpiPool_release(dpiPool *pool)
 }
 
 
+//-----------------------------------------------------------------------------
+// dpiPool_setClassParams() [PUBLIC]
+//   Set the limits of the admission class using the given parameters or
+// remove them if the parameters are NULL. The statistics of the class are
+// reset when limits are set for it after having been removed.
+//-----------------------------------------------------------------------------
+int dpiPool_setClassParams(dpiPool *pool, uint32_t poolClass,
+        dpiPoolClassParams *params)
+{
+    dpiPoolClass *tempClass;
+    dpiError error;
+
+    // validate parameters
+    if (dpiPool__checkConnected(pool, __func__, &error) < 0)
+        return DPI_FAILURE;
+    if (poolClass >= DPI_MAX_POOL_CLASSES)
+        return dpiError__set(&error, "check pool class",
+                DPI_ERR_INVALID_POOL_CLASS, poolClass, DPI_MAX_POOL_CLASSES);
+    if (params && params->maxSessions == 0)
+        return dpiError__set(&error, "check max sessions",
+                DPI_ERR_PARAM_ZERO, "maxSessions");
+    if (params && params->minSessions > params->maxSessions)
+        return dpiError__set(&error, "check class params",
+                DPI_ERR_POOL_MIN_EXCEEDS_MAX, params->minSessions,
+                params->maxSessions);
+
+    // enable or disable the limits; the limit starts at the maximum
+    tempClass = &pool->classes[poolClass];
+    if (pool->env->threaded &&
+            dpiOci__threadMutexAcquire(pool->env, &error) < 0)
+        return DPI_FAILURE;
+    if (!params) {
+        tempClass->isEnabled = 0;
+    } else {
+        if (!tempClass->isEnabled) {
+            tempClass->numAdmitted = 0;
+            tempClass->numRejected = 0;
+            tempClass->numTimedOut = 0;
+        }
+        tempClass->params = *params;
+        if (tempClass->params.backoffPercent > 100)
+            tempClass->params.backoffPercent = 100;
+        tempClass->limit = params->maxSessions;
+        tempClass->lastDecreaseTime = 0;
+        tempClass->isEnabled = 1;
+    }
+    if (pool->env->threaded)
+        return dpiOci__threadMutexRelease(pool->env, &error);
+    return DPI_SUCCESS;
+}
+
+
 //-----------------------------------------------------------------------------
 // dpiPool_setGetMode() [PUBLIC]
 //   Set the pool's "get" mode.
@@ -452,6 +1343,53 @@ int dpiPool_setMaxLifetimeSession(dpiPool *pool, uint32_t value)
 }
 
 
+//-----------------------------------------------------------------------------
+// dpiPool_setSizingParams() [PUBLIC]
+//   Enable elastic sizing of the pool using the given parameters or disable
+// it if the parameters are NULL.
+//-----------------------------------------------------------------------------
+int dpiPool_setSizingParams(dpiPool *pool, dpiPoolSizingParams *params)
+{
+    dpiPoolSizer *sizer = &pool->sizer;
+    dpiError error;
+
+    // validate parameters
+    if (dpiPool__checkConnected(pool, __func__, &error) < 0)
+        return DPI_FAILURE;
+    if (params && params->maxSessions == 0)
+        return dpiError__set(&error, "check max sessions",
+                DPI_ERR_PARAM_ZERO, "maxSessions");
+    if (params && params->sampleInterval == 0)
+        return dpiError__set(&error, "check sample interval",
+                DPI_ERR_PARAM_ZERO, "sampleInterval");
+    if (params && params->minSessions > params->maxSessions)
+        return dpiError__set(&error, "check sizing params",
+                DPI_ERR_POOL_MIN_EXCEEDS_MAX, params->minSessions,
+                params->maxSessions);
+
+    // enable or disable sizing; the statistics are reset when it is enabled
+    if (pool->env->threaded &&
+            dpiOci__threadMutexAcquire(pool->env, &error) < 0)
+        return DPI_FAILURE;
+    if (!params) {
+        sizer->isEnabled = 0;
+    } else {
+        if (!sizer->isEnabled) {
+            sizer->intervalStart = dpiUtils__getMilliseconds();
+            sizer->totalWaitTime = 0;
+            sizer->numAcquires = 0;
+            sizer->numFailures = 0;
+            sizer->peakBusyCount = 0;
+        }
+        sizer->params = *params;
+        sizer->isEnabled = 1;
+    }
+    if (pool->env->threaded)
+        return dpiOci__threadMutexRelease(pool->env, &error);
+    return DPI_SUCCESS;
+}
+
+
 //-----------------------------------------------------------------------------
 // dpiPool_setStmtCacheSize() [PUBLIC]
 //   Set the pool's default statement cache size.
@@ -0,0 +1,347 @@
+//-----------------------------------------------------------------------------
+// Copyright (c) 2017 Oracle and/or its affiliates.  All rights reserved.
+// This program is free software: you can modify it and/or redistribute it
+// under the terms of:
+//
+// (i)  the Universal Permissive License v 1.0 or at your option, any
+//      later version (http://oss.oracle.com/licenses/upl); and/or
+//
+// (ii) the Apache License v 2.0. (http://www.apache.org/licenses/LICENSE-2.0)
+//-----------------------------------------------------------------------------
+
+//-----------------------------------------------------------------------------
+// dpiRing.c
+//   Implementation of ring buffers used for exporting fetched rows in
+// columnar batches. The ring buffer lives in memory supplied by the caller,
+// typically shared memory mapped by several processes. There is a single
+// producer and a single consumer, each of which only ever updates its own
+// position, so no locks are required.
+//-----------------------------------------------------------------------------
+
+#ifdef _WIN32
+#include <windows.h>
+#endif
+#include "dpiImpl.h"
+
+// all batches and all arrays within batches are aligned to 8 bytes
+#define DPI_RING_ALIGN(n)       (((n) + 7) & ~((uint64_t) 7))
+
+// forward declarations of internal functions only used in this file
+static uint64_t dpiRing__getBatchLength(dpiVar **vars, uint32_t numVars,
+        uint32_t firstRow, uint32_t numRows);
+static int dpiRing__getValueSize(dpiNativeTypeNum nativeTypeNum,
+        uint32_t *valueSize);
+static uint64_t dpiRing__loadPos(volatile uint64_t *pos);
+static void dpiRing__storePos(volatile uint64_t *pos, uint64_t value);
+static void dpiRing__writeBatch(char *ptr, uint64_t length, dpiVar **vars,
+        uint32_t numVars, uint32_t firstRow, uint32_t numRows);
+
+
+//-----------------------------------------------------------------------------
+// dpiRing__exportRows() [INTERNAL]
+//   Export the specified rows of the variables to the ring buffer as a single
+// batch. If the ring buffer does not have enough space for all of the rows,
+// the number of rows is halved until it does; the number of rows actually
+// exported is returned, which is zero if the ring buffer is full.
+//-----------------------------------------------------------------------------
+int dpiRing__exportRows(dpiRing *ring, dpiVar **vars, uint32_t numVars,
+        uint32_t firstRow, uint32_t *numRows, dpiError *error)
+{
+    uint64_t length, writePos, available, offset, toEnd;
+    dpiRingBatch *padding;
+    uint32_t i, valueSize;
+    char *data;
+
+    // only native types with a fixed size or byte strings can be exported
+    for (i = 0; i < numVars; i++) {
+        if (dpiRing__getValueSize(vars[i]->nativeTypeNum, &valueSize) < 0)
+            return dpiError__set(error, "check native type",
+                    DPI_ERR_UNHANDLED_DATA_TYPE, vars[i]->nativeTypeNum);
+    }
+
+    data = (char*) (ring + 1);
+    writePos = ring->writePos;
+    while (1) {
+
+        // reduce the number of rows until the batch fits in the free space
+        available = ring->size - (writePos - dpiRing__loadPos(&ring->readPos));
+        while (1) {
+            length = dpiRing__getBatchLength(vars, numVars, firstRow,
+                    *numRows);
+            if (length <= available && length <= UINT32_MAX)
+                break;
+            if (*numRows == 1) {
+                if (length > ring->size)
+                    return dpiError__set(error, "check ring size",
+                            DPI_ERR_RING_TOO_SMALL);
+                *numRows = 0;
+                return DPI_SUCCESS;
+            }
+            *numRows /= 2;
+        }
+
+        // batches are contiguous; if there is not enough space before the end
+        // of the ring buffer, the remainder is skipped and the search repeated
+        // from the start of the ring buffer
+        offset = writePos % ring->size;
+        toEnd = ring->size - offset;
+        if (length <= toEnd)
+            break;
+        if (toEnd >= sizeof(dpiRingBatch)) {
+            padding = (dpiRingBatch*) (data + offset);
+            padding->length = toEnd;
+            padding->numRows = 0;
+            padding->numColumns = 0;
+        }
+        writePos += toEnd;
+        dpiRing__storePos(&ring->writePos, writePos);
+
+    }
+
+    // write the batch and make it visible to the consumer
+    dpiRing__writeBatch(data + offset, length, vars, numVars, firstRow,
+            *numRows);
+    dpiRing__storePos(&ring->writePos, writePos + length);
+    return DPI_SUCCESS;
+}
+
+
+//-----------------------------------------------------------------------------
+// dpiRing__getBatchLength() [INTERNAL]
+//   Return the number of bytes required to store the specified rows of the
+// variables as a batch.
+//-----------------------------------------------------------------------------
+static uint64_t dpiRing__getBatchLength(dpiVar **vars, uint32_t numVars,
+        uint32_t firstRow, uint32_t numRows)
+{
+    uint64_t length, bytesLength;
+    uint32_t i, j, valueSize;
+    dpiData *data;
+
+    length = sizeof(dpiRingBatch) + numVars * sizeof(dpiRingColumn);
+    for (i = 0; i < numVars; i++) {
+        dpiRing__getValueSize(vars[i]->nativeTypeNum, &valueSize);
+        length += DPI_RING_ALIGN(numRows);
+        if (valueSize > 0) {
+            length += DPI_RING_ALIGN((uint64_t) numRows * valueSize);
+            continue;
+        }
+        bytesLength = 0;
+        for (j = 0; j < numRows; j++) {
+            data = &vars[i]->externalData[firstRow + j];
+            if (!data->isNull)
+                bytesLength += data->value.asBytes.length;
+        }
+        length += DPI_RING_ALIGN(((uint64_t) numRows + 1) * sizeof(uint32_t));
+        length += DPI_RING_ALIGN(bytesLength);
+    }
+
+    return length;
+}
+
+
+//-----------------------------------------------------------------------------
+// dpiRing__getValueSize() [INTERNAL]
+//   Return the size of each value stored for the native type, or zero for byte
+// strings, which are stored with an array of offsets. Native types that
+// cannot be exported result in a failure.
+//-----------------------------------------------------------------------------
+static int dpiRing__getValueSize(dpiNativeTypeNum nativeTypeNum,
+        uint32_t *valueSize)
+{
+    switch (nativeTypeNum) {
+        case DPI_NATIVE_TYPE_INT64:
+        case DPI_NATIVE_TYPE_UINT64:
+            *valueSize = sizeof(int64_t);
+            return DPI_SUCCESS;
+        case DPI_NATIVE_TYPE_FLOAT:
+            *valueSize = sizeof(float);
+            return DPI_SUCCESS;
+        case DPI_NATIVE_TYPE_DOUBLE:
+            *valueSize = sizeof(double);
+            return DPI_SUCCESS;
+        case DPI_NATIVE_TYPE_BOOLEAN:
+            *valueSize = sizeof(int);
+            return DPI_SUCCESS;
+        case DPI_NATIVE_TYPE_TIMESTAMP:
+            *valueSize = sizeof(dpiTimestamp);
+            return DPI_SUCCESS;
+        case DPI_NATIVE_TYPE_INTERVAL_DS:
+            *valueSize = sizeof(dpiIntervalDS);
+            return DPI_SUCCESS;
+        case DPI_NATIVE_TYPE_INTERVAL_YM:
+            *valueSize = sizeof(dpiIntervalYM);
+            return DPI_SUCCESS;
+        case DPI_NATIVE_TYPE_BYTES:
+            *valueSize = 0;
+            return DPI_SUCCESS;
+        default:
+            break;
+    }
+    return DPI_FAILURE;
+}
+
+
+//-----------------------------------------------------------------------------
+// dpiRing__loadPos() [INTERNAL]
+//   Return the value of a position in the ring buffer that is updated by the
+// other party. Memory written by the other party before it updated the
+// position is guaranteed to be visible once the new position is seen.
+//-----------------------------------------------------------------------------
+static uint64_t dpiRing__loadPos(volatile uint64_t *pos)
+{
+#ifdef _WIN32
+    return (uint64_t) InterlockedCompareExchange64((volatile LONG64*) pos, 0,
+            0);
+#else
+    return __atomic_load_n(pos, __ATOMIC_ACQUIRE);
+#endif
+}
+
+
+//-----------------------------------------------------------------------------
+// dpiRing__storePos() [INTERNAL]
+//   Update a position in the ring buffer. All memory written before the
+// position is updated is made visible to the other party.
+//-----------------------------------------------------------------------------
+static void dpiRing__storePos(volatile uint64_t *pos, uint64_t value)
+{
+#ifdef _WIN32
+    InterlockedExchange64((volatile LONG64*) pos, (LONG64) value);
+#else
+    __atomic_store_n(pos, value, __ATOMIC_RELEASE);
+#endif
+}
+
+
+//-----------------------------------------------------------------------------
+// dpiRing__writeBatch() [INTERNAL]
+//   Write the specified rows of the variables to the ring buffer as a batch.
+// Each column consists of an array of null indicators followed by either an
+// array of fixed size values or, for byte strings, an array of offsets and
+// the concatenated bytes of all of the values.
+//-----------------------------------------------------------------------------
+static void dpiRing__writeBatch(char *ptr, uint64_t length, dpiVar **vars,
+        uint32_t numVars, uint32_t firstRow, uint32_t numRows)
+{
+    uint32_t i, j, valueSize, bytesLength, *offsets;
+    dpiRingColumn *column;
+    dpiRingBatch *batch;
+    uint64_t pos;
+    dpiData *data;
+    char *values;
+
+    batch = (dpiRingBatch*) ptr;
+    batch->length = length;
+    batch->numRows = numRows;
+    batch->numColumns = numVars;
+    column = (dpiRingColumn*) (batch + 1);
+    pos = sizeof(dpiRingBatch) + numVars * sizeof(dpiRingColumn);
+    for (i = 0; i < numVars; i++, column++) {
+        dpiRing__getValueSize(vars[i]->nativeTypeNum, &valueSize);
+        data = &vars[i]->externalData[firstRow];
+        column->nativeTypeNum = vars[i]->nativeTypeNum;
+        column->valueSize = valueSize;
+
+        // null indicators
+        column->nullsOffset = pos;
+        for (j = 0; j < numRows; j++)
+            ptr[pos + j] = (char) data[j].isNull;
+        pos += DPI_RING_ALIGN(numRows);
+
+        // fixed size values are copied directly from the data structures
+        if (valueSize > 0) {
+            column->offsetsOffset = 0;
+            column->valuesOffset = pos;
+            values = ptr + pos;
+            for (j = 0; j < numRows; j++, values += valueSize) {
+                if (data[j].isNull)
+                    memset(values, 0, valueSize);
+                else memcpy(values, &data[j].value, valueSize);
+            }
+            pos += DPI_RING_ALIGN((uint64_t) numRows * valueSize);
+            continue;
+        }
+
+        // byte strings are concatenated with an array of offsets; the length
+        // of each value is the difference between consecutive offsets
+        column->offsetsOffset = pos;
+        offsets = (uint32_t*) (ptr + pos);
+        pos += DPI_RING_ALIGN(((uint64_t) numRows + 1) * sizeof(uint32_t));
+        column->valuesOffset = pos;
+        values = ptr + pos;
+        bytesLength = 0;
+        for (j = 0; j < numRows; j++) {
+            offsets[j] = bytesLength;
+            if (data[j].isNull)
+                continue;
+            memcpy(values + bytesLength, data[j].value.asBytes.ptr,
+                    data[j].value.asBytes.length);
+            bytesLength += data[j].value.asBytes.length;
+        }
+        offsets[numRows] = bytesLength;
+        pos += DPI_RING_ALIGN(bytesLength);
+    }
+}
+
+
+//-----------------------------------------------------------------------------
+// dpiRing_getBatch() [PUBLIC]
+//   Return the next batch of rows available in the ring buffer, or NULL if no
+// batch is available. Any padding written by the producer at the end of the
+// ring buffer is skipped.
+//-----------------------------------------------------------------------------
+dpiRingBatch *dpiRing_getBatch(dpiRing *ring)
+{
+    uint64_t readPos, offset, toEnd;
+    dpiRingBatch *batch;
+
+    readPos = ring->readPos;
+    while (readPos != dpiRing__loadPos(&ring->writePos)) {
+        offset = readPos % ring->size;
+        toEnd = ring->size - offset;
+        if (toEnd >= sizeof(dpiRingBatch)) {
+            batch = (dpiRingBatch*) ((char*) (ring + 1) + offset);
+            if (batch->numColumns > 0)
+                return batch;
+        }
+        readPos += toEnd;
+        dpiRing__storePos(&ring->readPos, readPos);
+    }
+
+    return NULL;
+}
+
+
+//-----------------------------------------------------------------------------
+// dpiRing_init() [PUBLIC]
+//   Initialize the ring buffer in the memory supplied by the caller. The size
+// includes the header; the remainder is used for batches of rows.
+//-----------------------------------------------------------------------------
+int dpiRing_init(dpiRing *ring, uint64_t size)
+{
+    dpiError error;
+
+    if (dpiGlobal__initError(__func__, &error) < 0)
+        return DPI_FAILURE;
+    DPI_CHECK_PTR_NOT_NULL(ring)
+    if (size < sizeof(dpiRing) + sizeof(dpiRingBatch) + sizeof(dpiRingColumn))
+        return dpiError__set(&error, "check ring size",
+                DPI_ERR_RING_TOO_SMALL);
+    ring->size = (size - sizeof(dpiRing)) & ~((uint64_t) 7);
+    ring->writePos = 0;
+    ring->readPos = 0;
+    return DPI_SUCCESS;
+}
+
+
+//-----------------------------------------------------------------------------
+// dpiRing_releaseBatch() [PUBLIC]
+//   Release the batch most recently returned by dpiRing_getBatch() so that
+// the space it occupies can be reused by the producer.
+//-----------------------------------------------------------------------------
+void dpiRing_releaseBatch(dpiRing *ring, dpiRingBatch *batch)
+{
+    dpiRing__storePos(&ring->readPos, ring->readPos + batch->length);
+}
+
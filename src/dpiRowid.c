@@ -73,10 +73,8 @@ int dpiRowid_addRef(dpiRowid *rowid)
 int dpiRowid_getStringValue(dpiRowid *rowid, const char **value,
         uint32_t *valueLength)
 {
-    char temp, *adjustedBuffer, *sourcePtr;
-    uint16_t *targetPtr;
+    char temp, *adjustedBuffer;
     dpiError error;
-    uint16_t i;
 
     if (dpiGen__startPublicFn(rowid, DPI_HTYPE_ROWID, __func__, &error) < 0)
         return DPI_FAILURE;
@@ -106,10 +104,8 @@ int dpiRowid_getStringValue(dpiRowid *rowid, const char **value,
                 rowid->buffer = NULL;
                 return DPI_FAILURE;
             }
-            sourcePtr = rowid->buffer;
-            targetPtr = (uint16_t*) adjustedBuffer;
-            for (i = 0; i < rowid->bufferLength; i++)
-                *targetPtr++ = *sourcePtr++;
+            dpiTranscode__widenAscii(rowid->buffer, rowid->bufferLength,
+                    (uint16_t*) adjustedBuffer);
             free(rowid->buffer);
             rowid->buffer = adjustedBuffer;
             rowid->bufferLength *= 2;
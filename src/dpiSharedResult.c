@@ -0,0 +1,335 @@
+//-----------------------------------------------------------------------------
+// Copyright (c) 2017 Oracle and/or its affiliates.  All rights reserved.
+// This program is free software: you can modify it and/or redistribute it
+// under the terms of:
+//
+// (i)  the Universal Permissive License v 1.0 or at your option, any
+//      later version (http://oss.oracle.com/licenses/upl); and/or
+//
+// (ii) the Apache License v 2.0. (http://www.apache.org/licenses/LICENSE-2.0)
+//-----------------------------------------------------------------------------
+
+//-----------------------------------------------------------------------------
+// dpiSharedResult.c
+//   Implementation of the results of queries shared by all callers of
+// dpiPool_queryShared() with the same SQL and bind values. All rows are
+// fetched before the result is handed out and it is never modified after
+// that, so it can be read by any number of threads without locking. Byte
+// strings are copied to chunks owned by the result as the define buffers of
+// the statement are reused for each fetch.
+//-----------------------------------------------------------------------------
+
+#include "dpiImpl.h"
+
+// forward declarations of internal functions only used in this file
+static int dpiSharedResult__copyBytes(dpiSharedResult *result,
+        const char *ptr, uint32_t length, char **copy, dpiError *error);
+
+
+//-----------------------------------------------------------------------------
+// dpiSharedResult__addRows() [INTERNAL]
+//   Add the specified rows of the variables to the result. The space for the
+// rows is doubled each time it is exhausted.
+//-----------------------------------------------------------------------------
+int dpiSharedResult__addRows(dpiSharedResult *result, dpiVar **vars,
+        uint32_t numVars, uint32_t startPos, uint32_t numRows,
+        dpiError *error)
+{
+    uint32_t allocatedRows, i, j;
+    dpiData *data, *sourceData;
+
+    // make sure there is space for the rows
+    if (result->numRows + numRows > result->allocatedRows) {
+        allocatedRows = (result->allocatedRows > 0) ?
+                result->allocatedRows : numRows;
+        while (allocatedRows < result->numRows + numRows)
+            allocatedRows *= 2;
+        data = realloc(result->data,
+                (size_t) allocatedRows * numVars * sizeof(dpiData));
+        if (!data)
+            return dpiError__set(error, "allocate rows", DPI_ERR_NO_MEMORY);
+        result->data = data;
+        result->allocatedRows = allocatedRows;
+    }
+
+    // copy the values; byte strings are copied to the chunks of the result
+    data = &result->data[(size_t) result->numRows * numVars];
+    for (i = 0; i < numRows; i++) {
+        for (j = 0; j < numVars; j++, data++) {
+            sourceData = &vars[j]->externalData[startPos + i];
+            *data = *sourceData;
+            if (data->isNull ||
+                    result->nativeTypeNums[j] != DPI_NATIVE_TYPE_BYTES)
+                continue;
+            data->value.asBytes.ptr = NULL;
+            if (sourceData->value.asBytes.length > 0 &&
+                    dpiSharedResult__copyBytes(result,
+                            sourceData->value.asBytes.ptr,
+                            sourceData->value.asBytes.length,
+                            &data->value.asBytes.ptr, error) < 0)
+                return DPI_FAILURE;
+        }
+    }
+    result->numRows += numRows;
+
+    return DPI_SUCCESS;
+}
+
+
+//-----------------------------------------------------------------------------
+// dpiSharedResult__allocate() [INTERNAL]
+//   Allocate and initialize a shared result. A reference to the pool is
+// retained so that the environment (and the encoding of the byte strings in
+// the result) remains valid for as long as the result does.
+//-----------------------------------------------------------------------------
+int dpiSharedResult__allocate(dpiPool *pool, dpiSharedResult **result,
+        dpiError *error)
+{
+    dpiSharedResult *tempResult;
+
+    if (dpiGen__allocate(DPI_HTYPE_SHARED_RESULT, pool->env,
+            (void**) &tempResult, error) < 0)
+        return DPI_FAILURE;
+    if (dpiGen__setRefCount(pool, error, 1) < 0) {
+        dpiSharedResult__free(tempResult, error);
+        return DPI_FAILURE;
+    }
+    tempResult->pool = pool;
+
+    *result = tempResult;
+    return DPI_SUCCESS;
+}
+
+
+//-----------------------------------------------------------------------------
+// dpiSharedResult__copyBytes() [INTERNAL]
+//   Copy the byte string to the last chunk of the result, allocating a new
+// chunk if there is not enough space remaining in it.
+//-----------------------------------------------------------------------------
+static int dpiSharedResult__copyBytes(dpiSharedResult *result,
+        const char *ptr, uint32_t length, char **copy, dpiError *error)
+{
+    dpiDynamicBytes *buffer = &result->buffer;
+    dpiDynamicBytesChunk *chunk, *chunks;
+    uint32_t allocatedChunks;
+
+    chunk = (buffer->numChunks > 0) ?
+            &buffer->chunks[buffer->numChunks - 1] : NULL;
+    if (!chunk || chunk->allocatedLength - chunk->length < length) {
+
+        // make sure there is space for another chunk
+        if (buffer->numChunks == buffer->allocatedChunks) {
+            allocatedChunks = buffer->allocatedChunks + 8;
+            chunks = calloc(allocatedChunks, sizeof(dpiDynamicBytesChunk));
+            if (!chunks)
+                return dpiError__set(error, "allocate chunks",
+                        DPI_ERR_NO_MEMORY);
+            if (buffer->chunks) {
+                memcpy(chunks, buffer->chunks,
+                        buffer->numChunks * sizeof(dpiDynamicBytesChunk));
+                free(buffer->chunks);
+            }
+            buffer->chunks = chunks;
+            buffer->allocatedChunks = allocatedChunks;
+        }
+
+        // allocate the chunk, which may be larger than usual if the byte
+        // string itself is larger
+        chunk = &buffer->chunks[buffer->numChunks];
+        chunk->allocatedLength = (length > DPI_DYNAMIC_BYTES_CHUNK_SIZE) ?
+                length : DPI_DYNAMIC_BYTES_CHUNK_SIZE;
+        chunk->length = 0;
+        chunk->ptr = malloc(chunk->allocatedLength);
+        if (!chunk->ptr)
+            return dpiError__set(error, "allocate chunk", DPI_ERR_NO_MEMORY);
+        buffer->numChunks++;
+
+    }
+
+    *copy = chunk->ptr + chunk->length;
+    memcpy(*copy, ptr, length);
+    chunk->length += length;
+    return DPI_SUCCESS;
+}
+
+
+//-----------------------------------------------------------------------------
+// dpiSharedResult__free() [INTERNAL]
+//   Free the memory for a shared result.
+//-----------------------------------------------------------------------------
+void dpiSharedResult__free(dpiSharedResult *result, dpiError *error)
+{
+    uint32_t i;
+
+    if (result->buffer.chunks) {
+        for (i = 0; i < result->buffer.numChunks; i++)
+            free(result->buffer.chunks[i].ptr);
+        free(result->buffer.chunks);
+        result->buffer.chunks = NULL;
+    }
+    if (result->data) {
+        free(result->data);
+        result->data = NULL;
+    }
+    if (result->queryInfo) {
+        free(result->queryInfo);
+        result->queryInfo = NULL;
+    }
+    if (result->nativeTypeNums) {
+        free(result->nativeTypeNums);
+        result->nativeTypeNums = NULL;
+    }
+    if (result->pool) {
+        dpiGen__setRefCount(result->pool, error, -1);
+        result->pool = NULL;
+    }
+    free(result);
+}
+
+
+//-----------------------------------------------------------------------------
+// dpiSharedResult__setColumns() [INTERNAL]
+//   Set the columns of the result from the query information of the
+// statement. Values which refer to handles (such as LOBs) are only valid for
+// the connection which fetched them and cannot be shared.
+//-----------------------------------------------------------------------------
+int dpiSharedResult__setColumns(dpiSharedResult *result, uint32_t numColumns,
+        dpiQueryInfo *queryInfo, dpiError *error)
+{
+    dpiNativeTypeNum nativeTypeNum;
+    uint32_t i;
+    char *name;
+
+    result->queryInfo = calloc(numColumns, sizeof(dpiQueryInfo));
+    result->nativeTypeNums = calloc(numColumns, sizeof(dpiNativeTypeNum));
+    if (!result->queryInfo || !result->nativeTypeNums)
+        return dpiError__set(error, "allocate columns", DPI_ERR_NO_MEMORY);
+    result->numColumns = numColumns;
+    for (i = 0; i < numColumns; i++) {
+        nativeTypeNum = queryInfo[i].typeInfo.defaultNativeTypeNum;
+        switch (nativeTypeNum) {
+            case DPI_NATIVE_TYPE_LOB:
+            case DPI_NATIVE_TYPE_OBJECT:
+            case DPI_NATIVE_TYPE_STMT:
+            case DPI_NATIVE_TYPE_ROWID:
+                return dpiError__set(error, "check column type",
+                        DPI_ERR_NOT_SHAREABLE, nativeTypeNum);
+            default:
+                break;
+        }
+        result->nativeTypeNums[i] = nativeTypeNum;
+        result->queryInfo[i] = queryInfo[i];
+        result->queryInfo[i].name = NULL;
+        if (queryInfo[i].nameLength > 0) {
+            if (dpiSharedResult__copyBytes(result, queryInfo[i].name,
+                    queryInfo[i].nameLength, &name, error) < 0)
+                return DPI_FAILURE;
+            result->queryInfo[i].name = name;
+        }
+    }
+
+    return DPI_SUCCESS;
+}
+
+
+//-----------------------------------------------------------------------------
+// dpiSharedResult_addRef() [PUBLIC]
+//   Add a reference to the shared result.
+//-----------------------------------------------------------------------------
+int dpiSharedResult_addRef(dpiSharedResult *result)
+{
+    return dpiGen__addRef(result, DPI_HTYPE_SHARED_RESULT, __func__);
+}
+
+
+//-----------------------------------------------------------------------------
+// dpiSharedResult_getNumColumns() [PUBLIC]
+//   Return the number of columns in the shared result.
+//-----------------------------------------------------------------------------
+int dpiSharedResult_getNumColumns(dpiSharedResult *result,
+        uint32_t *numColumns)
+{
+    dpiError error;
+
+    if (dpiGen__startPublicFn(result, DPI_HTYPE_SHARED_RESULT, __func__,
+            &error) < 0)
+        return DPI_FAILURE;
+    DPI_CHECK_PTR_NOT_NULL(numColumns)
+    *numColumns = result->numColumns;
+    return DPI_SUCCESS;
+}
+
+
+//-----------------------------------------------------------------------------
+// dpiSharedResult_getNumRows() [PUBLIC]
+//   Return the number of rows in the shared result.
+//-----------------------------------------------------------------------------
+int dpiSharedResult_getNumRows(dpiSharedResult *result, uint32_t *numRows)
+{
+    dpiError error;
+
+    if (dpiGen__startPublicFn(result, DPI_HTYPE_SHARED_RESULT, __func__,
+            &error) < 0)
+        return DPI_FAILURE;
+    DPI_CHECK_PTR_NOT_NULL(numRows)
+    *numRows = result->numRows;
+    return DPI_SUCCESS;
+}
+
+
+//-----------------------------------------------------------------------------
+// dpiSharedResult_getQueryInfo() [PUBLIC]
+//   Return information about the column at the specified position.
+//-----------------------------------------------------------------------------
+int dpiSharedResult_getQueryInfo(dpiSharedResult *result, uint32_t pos,
+        dpiQueryInfo *info)
+{
+    dpiError error;
+
+    if (dpiGen__startPublicFn(result, DPI_HTYPE_SHARED_RESULT, __func__,
+            &error) < 0)
+        return DPI_FAILURE;
+    DPI_CHECK_PTR_NOT_NULL(info)
+    if (pos == 0 || pos > result->numColumns)
+        return dpiError__set(&error, "check query position",
+                DPI_ERR_QUERY_POSITION_INVALID, pos);
+    memcpy(info, &result->queryInfo[pos - 1], sizeof(dpiQueryInfo));
+    return DPI_SUCCESS;
+}
+
+
+//-----------------------------------------------------------------------------
+// dpiSharedResult_getValue() [PUBLIC]
+//   Return the value of the column at the specified position in the given
+// (zero-based) row. The value must not be modified as it is shared.
+//-----------------------------------------------------------------------------
+int dpiSharedResult_getValue(dpiSharedResult *result, uint32_t rowIndex,
+        uint32_t pos, dpiNativeTypeNum *nativeTypeNum, dpiData **data)
+{
+    dpiError error;
+
+    if (dpiGen__startPublicFn(result, DPI_HTYPE_SHARED_RESULT, __func__,
+            &error) < 0)
+        return DPI_FAILURE;
+    DPI_CHECK_PTR_NOT_NULL(nativeTypeNum)
+    DPI_CHECK_PTR_NOT_NULL(data)
+    if (rowIndex >= result->numRows)
+        return dpiError__set(&error, "check row index",
+                DPI_ERR_INVALID_ARRAY_POSITION, rowIndex, result->numRows);
+    if (pos == 0 || pos > result->numColumns)
+        return dpiError__set(&error, "check query position",
+                DPI_ERR_QUERY_POSITION_INVALID, pos);
+    *nativeTypeNum = result->nativeTypeNums[pos - 1];
+    *data = &result->data[(size_t) rowIndex * result->numColumns + pos - 1];
+    return DPI_SUCCESS;
+}
+
+
+//-----------------------------------------------------------------------------
+// dpiSharedResult_release() [PUBLIC]
+//   Release a reference to the shared result.
+//-----------------------------------------------------------------------------
+int dpiSharedResult_release(dpiSharedResult *result)
+{
+    return dpiGen__release(result, DPI_HTYPE_SHARED_RESULT, __func__);
+}
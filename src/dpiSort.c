@@ -0,0 +1,250 @@
+//-----------------------------------------------------------------------------
+// Copyright (c) 2017 Oracle and/or its affiliates.  All rights reserved.
+// This program is free software: you can modify it and/or redistribute it
+// under the terms of:
+//
+// (i)  the Universal Permissive License v 1.0 or at your option, any
+//      later version (http://oss.oracle.com/licenses/upl); and/or
+//
+// (ii) the Apache License v 2.0. (http://www.apache.org/licenses/LICENSE-2.0)
+//-----------------------------------------------------------------------------
+
+//-----------------------------------------------------------------------------
+// dpiSort.c
+//   Implementation of sorting the rows of variables by one or more key
+// columns. A least significant digit radix sort is performed on the native
+// values of the keys, starting with the last key, so that no comparisons are
+// required and the cost is linear in the number of rows.
+//-----------------------------------------------------------------------------
+
+#include "dpiImpl.h"
+
+// forward declarations of internal functions only used in this file
+static void dpiSort__byBuckets(const uint16_t *buckets, uint32_t numBuckets,
+        uint32_t numRows, uint32_t **order, uint32_t **tempOrder);
+static void dpiSort__byBytes(dpiData *data, uint32_t numRows,
+        uint16_t *buckets, uint32_t **order, uint32_t **tempOrder);
+static void dpiSort__byKeys(const uint64_t *keys, uint32_t numRows,
+        uint16_t *buckets, uint32_t **order, uint32_t **tempOrder);
+static uint64_t dpiSort__getKey(dpiNativeTypeNum nativeTypeNum,
+        dpiData *data, int lowPart);
+
+
+//-----------------------------------------------------------------------------
+// dpiSort__byBuckets() [INTERNAL]
+//   Perform a stable counting sort of the rows in the current order using the
+// bucket of each row. The result is placed in the temporary order and the
+// two orders are then swapped. If all of the rows are in the same bucket
+// nothing needs to be done.
+//-----------------------------------------------------------------------------
+static void dpiSort__byBuckets(const uint16_t *buckets, uint32_t numBuckets,
+        uint32_t numRows, uint32_t **order, uint32_t **tempOrder)
+{
+    uint32_t counts[UINT8_MAX + 2], i, offset, count, row, *temp;
+
+    memset(counts, 0, numBuckets * sizeof(uint32_t));
+    for (i = 0; i < numRows; i++)
+        counts[buckets[i]]++;
+    for (i = 0, offset = 0; i < numBuckets; i++) {
+        if (counts[i] == numRows)
+            return;
+        count = counts[i];
+        counts[i] = offset;
+        offset += count;
+    }
+    for (i = 0; i < numRows; i++) {
+        row = (*order)[i];
+        (*tempOrder)[counts[buckets[row]]++] = row;
+    }
+    temp = *order;
+    *order = *tempOrder;
+    *tempOrder = temp;
+}
+
+
+//-----------------------------------------------------------------------------
+// dpiSort__byBytes() [INTERNAL]
+//   Sort the rows by the byte strings, one byte position at a time starting
+// with the last position. Values which are shorter than a position sort
+// before all values which have a byte at that position.
+//-----------------------------------------------------------------------------
+static void dpiSort__byBytes(dpiData *data, uint32_t numRows,
+        uint16_t *buckets, uint32_t **order, uint32_t **tempOrder)
+{
+    uint32_t i, pos, maxLength = 0;
+    dpiBytes *bytes;
+
+    for (i = 0; i < numRows; i++) {
+        if (!data[i].isNull && data[i].value.asBytes.length > maxLength)
+            maxLength = data[i].value.asBytes.length;
+    }
+    for (pos = maxLength; pos > 0; pos--) {
+        for (i = 0; i < numRows; i++) {
+            bytes = &data[i].value.asBytes;
+            if (data[i].isNull || bytes->length < pos)
+                buckets[i] = 0;
+            else buckets[i] = (uint8_t) bytes->ptr[pos - 1] + 1;
+        }
+        dpiSort__byBuckets(buckets, UINT8_MAX + 2, numRows, order, tempOrder);
+    }
+}
+
+
+//-----------------------------------------------------------------------------
+// dpiSort__byKeys() [INTERNAL]
+//   Sort the rows by the unsigned keys, one byte at a time starting with the
+// least significant byte.
+//-----------------------------------------------------------------------------
+static void dpiSort__byKeys(const uint64_t *keys, uint32_t numRows,
+        uint16_t *buckets, uint32_t **order, uint32_t **tempOrder)
+{
+    uint32_t i, shift;
+
+    for (shift = 0; shift < 64; shift += 8) {
+        for (i = 0; i < numRows; i++)
+            buckets[i] = (uint16_t) ((keys[i] >> shift) & 0xff);
+        dpiSort__byBuckets(buckets, UINT8_MAX + 1, numRows, order, tempOrder);
+    }
+}
+
+
+//-----------------------------------------------------------------------------
+// dpiSort__getKey() [INTERNAL]
+//   Return an unsigned key for the value which sorts in the same order as the
+// value itself. Timestamps require two keys: the low part is the fractional
+// seconds and the high part is the remainder of the timestamp. Time zone
+// offsets are ignored.
+//-----------------------------------------------------------------------------
+static uint64_t dpiSort__getKey(dpiNativeTypeNum nativeTypeNum,
+        dpiData *data, int lowPart)
+{
+    dpiTimestamp *timestamp;
+    uint32_t floatBits;
+    uint64_t bits;
+
+    if (data->isNull)
+        return 0;
+    switch (nativeTypeNum) {
+        case DPI_NATIVE_TYPE_INT64:
+            return (uint64_t) data->value.asInt64 ^ (UINT64_C(1) << 63);
+        case DPI_NATIVE_TYPE_UINT64:
+            return data->value.asUint64;
+        case DPI_NATIVE_TYPE_FLOAT:
+            memcpy(&floatBits, &data->value.asFloat, sizeof(float));
+            if (floatBits & (UINT32_C(1) << 31))
+                return ~floatBits;
+            return floatBits | (UINT32_C(1) << 31);
+        case DPI_NATIVE_TYPE_DOUBLE:
+            memcpy(&bits, &data->value.asDouble, sizeof(double));
+            if (bits & (UINT64_C(1) << 63))
+                return ~bits;
+            return bits | (UINT64_C(1) << 63);
+        case DPI_NATIVE_TYPE_BOOLEAN:
+            return (data->value.asBoolean != 0);
+        case DPI_NATIVE_TYPE_TIMESTAMP:
+            timestamp = &data->value.asTimestamp;
+            if (lowPart)
+                return timestamp->fsecond;
+            return ((uint64_t) (timestamp->year + 32768) << 40) |
+                    ((uint64_t) timestamp->month << 32) |
+                    ((uint64_t) timestamp->day << 24) |
+                    ((uint64_t) timestamp->hour << 16) |
+                    ((uint64_t) timestamp->minute << 8) | timestamp->second;
+        default:
+            break;
+    }
+    return 0;
+}
+
+
+//-----------------------------------------------------------------------------
+// dpiSort__sortRows() [INTERNAL]
+//   Determine the order of the rows when sorted by the values of the key
+// variables in ascending order. Null values sort after all other values, as
+// they do in the database. The order is returned as a permutation: element
+// i is the original position of the row which sorts in position i. The sort
+// is stable so rows with equal keys retain their original order.
+//-----------------------------------------------------------------------------
+int dpiSort__sortRows(dpiVar **keyVars, uint32_t numKeyVars, uint32_t numRows,
+        uint32_t *permutation, dpiError *error)
+{
+    uint32_t *order, *tempOrder, *allocatedOrder, i, j;
+    uint16_t *buckets;
+    uint64_t *keys;
+    dpiData *data;
+    dpiVar *var;
+
+    // only native types which can be converted to unsigned keys or compared
+    // byte by byte can be used as keys; numbers represented as bytes would be
+    // compared byte by byte (so that "10" sorts before "9") and are rejected
+    for (j = 0; j < numKeyVars; j++) {
+        switch (keyVars[j]->nativeTypeNum) {
+            case DPI_NATIVE_TYPE_INT64:
+            case DPI_NATIVE_TYPE_UINT64:
+            case DPI_NATIVE_TYPE_FLOAT:
+            case DPI_NATIVE_TYPE_DOUBLE:
+            case DPI_NATIVE_TYPE_BOOLEAN:
+            case DPI_NATIVE_TYPE_TIMESTAMP:
+                break;
+            case DPI_NATIVE_TYPE_BYTES:
+                if (keyVars[j]->type->oracleTypeNum == DPI_ORACLE_TYPE_NUMBER)
+                    return dpiError__set(error, "check number as bytes",
+                            DPI_ERR_SORT_NUMBER_AS_BYTES, j);
+                break;
+            default:
+                return dpiError__set(error, "check native type",
+                        DPI_ERR_UNHANDLED_DATA_TYPE,
+                        keyVars[j]->nativeTypeNum);
+        }
+    }
+
+    // allocate memory for the keys, buckets and second order
+    allocatedOrder = malloc(numRows * sizeof(uint32_t));
+    buckets = malloc(numRows * sizeof(uint16_t));
+    keys = malloc(numRows * sizeof(uint64_t));
+    if (!allocatedOrder || !buckets || !keys) {
+        if (allocatedOrder)
+            free(allocatedOrder);
+        if (buckets)
+            free(buckets);
+        if (keys)
+            free(keys);
+        return dpiError__set(error, "allocate sort buffers",
+                DPI_ERR_NO_MEMORY);
+    }
+
+    // sort by each key in turn, starting with the last one
+    order = permutation;
+    tempOrder = allocatedOrder;
+    for (i = 0; i < numRows; i++)
+        order[i] = i;
+    for (j = numKeyVars; j > 0; j--) {
+        var = keyVars[j - 1];
+        data = var->externalData;
+        if (var->nativeTypeNum == DPI_NATIVE_TYPE_BYTES) {
+            dpiSort__byBytes(data, numRows, buckets, &order, &tempOrder);
+        } else {
+            if (var->nativeTypeNum == DPI_NATIVE_TYPE_TIMESTAMP) {
+                for (i = 0; i < numRows; i++)
+                    keys[i] = dpiSort__getKey(var->nativeTypeNum, &data[i],
+                            1);
+                dpiSort__byKeys(keys, numRows, buckets, &order, &tempOrder);
+            }
+            for (i = 0; i < numRows; i++)
+                keys[i] = dpiSort__getKey(var->nativeTypeNum, &data[i], 0);
+            dpiSort__byKeys(keys, numRows, buckets, &order, &tempOrder);
+        }
+        for (i = 0; i < numRows; i++)
+            buckets[i] = (uint16_t) (data[i].isNull != 0);
+        dpiSort__byBuckets(buckets, 2, numRows, &order, &tempOrder);
+    }
+
+    // the final order may be in the allocated buffer
+    if (order != permutation)
+        memcpy(permutation, order, numRows * sizeof(uint32_t));
+    free(allocatedOrder);
+    free(buckets);
+    free(keys);
+    return DPI_SUCCESS;
+}
+
@@ -17,14 +17,27 @@
 #include "dpiImpl.h"
 
 // forward declarations of internal functions only used in this file
+static int dpiStmt__fetch(dpiStmt *stmt, int convertValues,
+        dpiError *error);
+static int dpiStmt__fetchAggregates(dpiStmt *stmt, uint32_t numSpecs,
+        dpiAggregateSpec *specs, uint32_t groupByPos,
+        dpiAggregateResult *result, dpiError *error);
+static int dpiStmt__getBindValues(dpiStmt *stmt, dpiError *error);
 static int dpiStmt__getQueryInfo(dpiStmt *stmt, uint32_t pos,
         dpiQueryInfo *info, dpiError *error);
 static int dpiStmt__getQueryInfoFromParam(dpiStmt *stmt, void *param,
         dpiQueryInfo *info, dpiError *error);
-static int dpiStmt__postFetch(dpiStmt *stmt, dpiError *error);
+static int dpiStmt__isRetryable(dpiStmt *stmt, int inTransaction,
+        dpiError *error);
+static int dpiStmt__postFetch(dpiStmt *stmt, int convertValues,
+        dpiError *error);
 static int dpiStmt__preFetch(dpiStmt *stmt, dpiError *error);
 static int dpiStmt__reExecute(dpiStmt *stmt, uint32_t numIters,
         dpiExecMode mode, dpiError *error);
+static int dpiStmt__rebind(dpiStmt *stmt, dpiError *error);
+static int dpiStmt__replaceSession(dpiStmt *stmt, const char *sql,
+        uint32_t sqlLength, dpiRetryInfo *info, dpiError *error);
+static int dpiStmt__setBindValues(dpiStmt *stmt, dpiError *error);
 
 
 //-----------------------------------------------------------------------------
@@ -62,7 +75,7 @@ int dpiStmt__allocate(dpiConn *conn, int scrollable, dpiStmt **stmt,
 //   Bind the variable to the statement using either a position or a name. A
 // reference to the variable will be retained.
 //-----------------------------------------------------------------------------
-static int dpiStmt__bind(dpiStmt *stmt, dpiVar *var, int addReference,
+int dpiStmt__bind(dpiStmt *stmt, dpiVar *var, int addReference,
         uint32_t pos, const char *name, uint32_t nameLength, dpiError *error)
 {
     dpiBindVar *bindVars, *entry;
@@ -204,6 +217,21 @@ static int dpiStmt__bind(dpiStmt *stmt, dpiVar *var, int addReference,
 }
 
 
+//-----------------------------------------------------------------------------
+// dpiStmt__cancelFetch() [INTERNAL]
+//   Cancel the cursor associated with the statement once the fetch limit has
+// been reached. Fetching zero rows tells OCI to cancel the cursor; any rows
+// already fetched into the buffers are left untouched.
+//-----------------------------------------------------------------------------
+static int dpiStmt__cancelFetch(dpiStmt *stmt, dpiError *error)
+{
+    if (dpiOci__stmtFetch2(stmt, 0, DPI_MODE_FETCH_NEXT, 0, error) < 0)
+        return DPI_FAILURE;
+    stmt->hasRowsToFetch = 0;
+    return DPI_SUCCESS;
+}
+
+
 //-----------------------------------------------------------------------------
 // dpiStmt__checkOpen() [INTERNAL]
 //   Determine if the statement is open and available for use.
@@ -259,6 +287,26 @@ static void dpiStmt__clearBindVars(dpiStmt *stmt, dpiError *error)
 }
 
 
+//-----------------------------------------------------------------------------
+// dpiStmt__clearPermutation() [INTERNAL]
+//   Clear the permutation established by sorting the bind variables, along
+// with the row counts reordered using it.
+//-----------------------------------------------------------------------------
+static void dpiStmt__clearPermutation(dpiStmt *stmt)
+{
+    if (stmt->permutation) {
+        free(stmt->permutation);
+        stmt->permutation = NULL;
+    }
+    if (stmt->permutedRowCounts) {
+        free(stmt->permutedRowCounts);
+        stmt->permutedRowCounts = NULL;
+    }
+    stmt->permutationLength = 0;
+    stmt->permutationPending = 0;
+}
+
+
 //-----------------------------------------------------------------------------
 // dpiStmt__clearQueryVars() [INTERNAL]
 //   Clear the query variables associated with the statement.
@@ -302,6 +350,7 @@ static int dpiStmt__close(dpiStmt *stmt, const char *tag,
 {
     dpiStmt__clearBatchErrors(stmt, error);
     dpiStmt__clearBindVars(stmt, error);
+    dpiStmt__clearPermutation(stmt);
     dpiStmt__clearQueryVars(stmt, error);
     if (stmt->handle) {
         if (stmt->isOwned)
@@ -438,6 +487,7 @@ static int dpiStmt__createQueryVars(dpiStmt *stmt, dpiError *error)
     // indicate start of fetch
     stmt->bufferRowIndex = stmt->fetchArraySize;
     stmt->hasRowsToFetch = 1;
+    stmt->rowCount = 0;
     return DPI_SUCCESS;
 }
 
@@ -500,36 +550,34 @@ int dpiStmt__define(dpiStmt *stmt, uint32_t pos, dpiVar *var, dpiError *error)
 // dpiStmt__execute() [INTERNAL]
 //   Internal execution of statement.
 //-----------------------------------------------------------------------------
-static int dpiStmt__execute(dpiStmt *stmt, uint32_t numIters,
+int dpiStmt__execute(dpiStmt *stmt, uint32_t numIters,
         uint32_t mode, int reExecute, dpiError *error)
 {
-    uint32_t prefetchSize, i, j;
-    dpiData *data;
-    dpiVar *var;
+    uint64_t startTime = 0;
+    uint32_t prefetchSize;
+    int status;
+
+    // the permutation established by sorting the bind variables only applies
+    // to the execution which immediately follows the sort
+    if (stmt->permutationPending && numIters == stmt->permutationLength)
+        stmt->permutationPending = 0;
+    else dpiStmt__clearPermutation(stmt);
 
     // for all bound variables, transfer data from dpiData structure to Oracle
     // buffer structures
-    for (i = 0; i < stmt->numBindVars; i++) {
-        var = stmt->bindVars[i].var;
-        for (j = 0; j < var->maxArraySize; j++) {
-            data = &var->externalData[j];
-            if (var->type->oracleTypeNum == DPI_ORACLE_TYPE_STMT &&
-                    data->value.asStmt == stmt)
-                return dpiError__set(error, "bind to self",
-                        DPI_ERR_NOT_SUPPORTED);
-            if (dpiVar__setValue(var, j, data, error) < 0)
-                return DPI_FAILURE;
-        }
-        if (stmt->isReturning || var->isDynamic)
-            var->error = error;
-    }
+    if (dpiStmt__setBindValues(stmt, error) < 0)
+        return DPI_FAILURE;
 
     // for queries, set the prefetch rows to the fetch array size in order to
-    // avoid the network round trip for the first fetch
+    // avoid the network round trip for the first fetch; if a fetch limit has
+    // been set and is smaller, no more rows than that are prefetched
     if (stmt->statementType == DPI_STMT_TYPE_SELECT) {
-        if (dpiOci__attrSet(stmt->handle, DPI_OCI_HTYPE_STMT,
-                &stmt->fetchArraySize, sizeof(stmt->fetchArraySize),
-                DPI_OCI_ATTR_PREFETCH_ROWS, "set prefetch rows", error) < 0)
+        prefetchSize = stmt->fetchArraySize;
+        if (stmt->fetchLimit > 0 && stmt->fetchLimit < prefetchSize)
+            prefetchSize = (uint32_t) stmt->fetchLimit;
+        if (dpiOci__attrSet(stmt->handle, DPI_OCI_HTYPE_STMT, &prefetchSize,
+                sizeof(prefetchSize), DPI_OCI_ATTR_PREFETCH_ROWS,
+                "set prefetch rows", error) < 0)
             return DPI_FAILURE;
     }
 
@@ -540,10 +588,17 @@ static int dpiStmt__execute(dpiStmt *stmt, uint32_t numIters,
     if (stmt->scrollable)
         mode |= DPI_OCI_STMT_SCROLLABLE_READONLY;
 
-    // perform execution
+    // perform execution; if the connection was admitted by an admission
+    // class, the time taken is recorded in order to adjust its limit
     // re-execute statement for ORA-01007: variable not in select list
     // drop statement from cache for all but ORA-00001: unique key violated
-    if (dpiOci__stmtExecute(stmt, numIters, mode, error) < 0) {
+    if (stmt->conn->poolClass)
+        startTime = dpiUtils__getMilliseconds();
+    status = dpiOci__stmtExecute(stmt, numIters, mode, error);
+    if (stmt->conn->poolClass)
+        dpiPool__recordLatency(stmt->conn->pool, stmt->conn->poolClass,
+                dpiUtils__getMilliseconds() - startTime, error);
+    if (status < 0) {
         dpiOci__attrGet(stmt->handle, DPI_OCI_HTYPE_STMT,
                 &error->buffer->offset, 0, DPI_OCI_ATTR_PARSE_ERROR_OFFSET,
                 "set parse offset", error);
@@ -560,23 +615,19 @@ static int dpiStmt__execute(dpiStmt *stmt, uint32_t numIters,
     if (stmt->isReturning || stmt->statementType == DPI_STMT_TYPE_BEGIN ||
             stmt->statementType == DPI_STMT_TYPE_DECLARE ||
             stmt->statementType == DPI_STMT_TYPE_CALL) {
-        for (i = 0; i < stmt->numBindVars; i++) {
-            var = stmt->bindVars[i].var;
-            for (j = 0; j < var->maxArraySize; j++) {
-                if (dpiVar__getValue(var, j, &var->externalData[j],
-                        error) < 0)
-                    return DPI_FAILURE;
-            }
-            var->error = NULL;
-        }
+        if (dpiStmt__getBindValues(stmt, error) < 0)
+            return DPI_FAILURE;
     }
 
     // determine number of query columns (for queries)
     // reset prefetch rows to 0 as subsequent fetches can fetch directly into
-    // the defined fetch areas
+    // the defined fetch areas; the number of rows prefetched is retained so
+    // that a first fetch requesting no more rows than that is known to be
+    // satisfied without a round trip
     if (stmt->statementType == DPI_STMT_TYPE_SELECT) {
         if (dpiStmt__createQueryVars(stmt, error) < 0)
             return DPI_FAILURE;
+        stmt->prefetchRows = prefetchSize;
         prefetchSize = 0;
         if (dpiOci__attrSet(stmt->handle, DPI_OCI_HTYPE_STMT, &prefetchSize,
                 sizeof(prefetchSize), DPI_OCI_ATTR_PREFETCH_ROWS,
@@ -588,19 +639,203 @@ static int dpiStmt__execute(dpiStmt *stmt, uint32_t numIters,
 }
 
 
+//-----------------------------------------------------------------------------
+// dpiStmt__executeShared() [INTERNAL]
+//   Bind the values to the query, execute it and add all of the rows it
+// returns to the shared result.
+//-----------------------------------------------------------------------------
+static int dpiStmt__executeShared(dpiStmt *stmt, uint32_t numBinds,
+        dpiNativeTypeNum *bindNativeTypeNums, dpiData *bindValues,
+        dpiSharedResult *result, dpiError *error)
+{
+    uint32_t numRows, i;
+    dpiVar *var;
+
+    // only queries can be shared
+    if (stmt->statementType != DPI_STMT_TYPE_SELECT)
+        return dpiError__set(error, "check statement type",
+                DPI_ERR_NOT_SUPPORTED);
+
+    // bind the values and execute the query; as with dpiStmt_execute() no
+    // iterations are requested since the query has not been defined yet
+    for (i = 0; i < numBinds; i++) {
+        if (dpiStmt__createBindVar(stmt, bindNativeTypeNums[i],
+                &bindValues[i], &var, i + 1, NULL, 0, error) < 0)
+            return DPI_FAILURE;
+    }
+    if (dpiStmt__execute(stmt, 0, DPI_MODE_EXEC_DEFAULT, 1, error) < 0)
+        return DPI_FAILURE;
+    if (dpiSharedResult__setColumns(result, stmt->numQueryVars,
+            stmt->queryInfo, error) < 0)
+        return DPI_FAILURE;
+
+    // fetch all of the rows
+    while (1) {
+        if (stmt->bufferRowIndex >= stmt->bufferRowCount) {
+            if (!stmt->hasRowsToFetch)
+                break;
+            if (dpiStmt__fetch(stmt, 1, error) < 0)
+                return DPI_FAILURE;
+            if (stmt->bufferRowIndex >= stmt->bufferRowCount)
+                break;
+        }
+        numRows = stmt->bufferRowCount - stmt->bufferRowIndex;
+        if (dpiSharedResult__addRows(result, stmt->queryVars,
+                stmt->numQueryVars, stmt->bufferRowIndex, numRows,
+                error) < 0)
+            return DPI_FAILURE;
+        stmt->bufferRowIndex += numRows;
+        stmt->rowCount += numRows;
+    }
+
+    return DPI_SUCCESS;
+}
+
+
+//-----------------------------------------------------------------------------
+// dpiStmt__executeWithRetry() [INTERNAL]
+//   Execute the statement, replaying it when it fails with an error that
+// retrying may overcome. If the session is known to be unusable it is first
+// replaced by a new session from the pool, but only if no transaction was in
+// progress before the statement was executed, since the work done in that
+// transaction would otherwise be lost silently and the caller could then
+// commit only part of it. Attempts are separated by a delay which doubles
+// each time (up to the maximum) and is randomly reduced by up to half so that
+// clients which failed together do not retry together.
+// Retrying stops once the maximum number of attempts has been made or when
+// the next attempt could not start before the deadline; the error raised by
+// the last attempt is the one returned. The statistics are added to those of
+// the connection and of its pool, if applicable.
+//-----------------------------------------------------------------------------
+static int dpiStmt__executeWithRetry(dpiStmt *stmt, uint32_t numIters,
+        dpiExecMode mode, dpiRetryParams *params, dpiError *error)
+{
+    uint32_t attempt, delay, maxDelay, sqlLength = 0, seed, i;
+    dpiErrorBuffer localErrorBuffer;
+    uint64_t startTime, elapsed;
+    int status, inTransaction;
+    dpiError localError;
+    dpiRetryInfo info;
+    char *sql = NULL;
+    const char *tmp;
+
+    // determine if a transaction is in progress before the statement is
+    // executed for the first time
+    if (dpiConn__getTransactionInProgress(stmt->conn, &inTransaction,
+            error) < 0)
+        return DPI_FAILURE;
+
+    memset(&info, 0, sizeof(info));
+    startTime = dpiUtils__getMilliseconds();
+    seed = (uint32_t) (startTime ^ (uintptr_t) stmt) | 1;
+    for (attempt = 1; ; attempt++) {
+
+        // before replaying the statement, replace the session (or just the
+        // statement, if that is all that remains to be done) when it is known
+        // to be unusable; then perform the execution
+        if (attempt > 1 && (stmt->conn->dropSession || !stmt->handle))
+            status = dpiStmt__replaceSession(stmt, sql, sqlLength, &info,
+                    error);
+        else status = DPI_SUCCESS;
+        if (status == DPI_SUCCESS)
+            status = dpiStmt__execute(stmt, numIters, mode, 1, error);
+        if (status == DPI_SUCCESS) {
+            if (attempt > 1)
+                info.numSucceeded++;
+            break;
+        }
+
+        // stop if retrying cannot help
+        if (!dpiStmt__isRetryable(stmt, inTransaction, error)) {
+            if (attempt > 1)
+                info.numFailed++;
+            break;
+        }
+
+        // determine the delay before the next attempt and stop if the maximum
+        // number of attempts has been made or the deadline would be exceeded
+        maxDelay = params->initialDelay;
+        for (i = 1; i < attempt && maxDelay < params->maxDelay; i++)
+            maxDelay *= 2;
+        if (maxDelay > params->maxDelay)
+            maxDelay = params->maxDelay;
+        seed ^= seed << 13;
+        seed ^= seed >> 17;
+        seed ^= seed << 5;
+        delay = maxDelay - seed % (maxDelay / 2 + 1);
+        elapsed = dpiUtils__getMilliseconds() - startTime;
+        if (attempt >= params->maxAttempts || (params->deadline > 0 &&
+                elapsed + delay >= params->deadline)) {
+            info.numFailed++;
+            break;
+        }
+
+        // the SQL text must be retained if the statement is to be prepared
+        // again on a new session; a separate error is used so that the error
+        // from the execution is retained if this fails
+        if (!sql && stmt->handle && stmt->conn->dropSession) {
+            localError = *error;
+            localError.buffer = &localErrorBuffer;
+            if (dpiOci__attrGet(stmt->handle, DPI_OCI_HTYPE_STMT,
+                    (void*) &tmp, &sqlLength, DPI_OCI_ATTR_STATEMENT,
+                    "get statement", &localError) < 0)
+                break;
+            sql = malloc(sqlLength);
+            if (!sql) {
+                status = dpiError__set(error, "allocate SQL",
+                        DPI_ERR_NO_MEMORY);
+                break;
+            }
+            memcpy(sql, tmp, sqlLength);
+        }
+
+        dpiUtils__sleep(delay);
+        info.numRetries++;
+    }
+
+    // record statistics
+    if (sql)
+        free(sql);
+    if (info.numRetries > 0 || info.numSessionsReplaced > 0 ||
+            info.numFailed > 0) {
+        stmt->conn->retryInfo.numRetries += info.numRetries;
+        stmt->conn->retryInfo.numSessionsReplaced += info.numSessionsReplaced;
+        stmt->conn->retryInfo.numSucceeded += info.numSucceeded;
+        stmt->conn->retryInfo.numFailed += info.numFailed;
+        if (stmt->conn->pool)
+            dpiPool__addRetryInfo(stmt->conn->pool, &info, error);
+    }
+
+    return status;
+}
+
+
 //-----------------------------------------------------------------------------
 // dpiStmt__fetch() [INTERNAL]
-//   Performs the actual fetch from Oracle.
+//   Performs the actual fetch from Oracle. The values fetched are converted to
+// C data values unless requested otherwise.
 //-----------------------------------------------------------------------------
-static int dpiStmt__fetch(dpiStmt *stmt, dpiError *error)
+static int dpiStmt__fetch(dpiStmt *stmt, int convertValues,
+        dpiError *error)
 {
+    uint32_t numRows;
+
+    // if a fetch limit has been set, fetch no more rows than are needed to
+    // reach it; if it has already been reached, cancel the cursor instead
+    numRows = stmt->fetchArraySize;
+    if (stmt->fetchLimit > 0) {
+        if (stmt->rowCount >= stmt->fetchLimit)
+            return dpiStmt__cancelFetch(stmt, error);
+        if (stmt->fetchLimit - stmt->rowCount < numRows)
+            numRows = (uint32_t) (stmt->fetchLimit - stmt->rowCount);
+    }
+
     // perform any pre-fetch activities required
     if (dpiStmt__preFetch(stmt, error) < 0)
         return DPI_FAILURE;
 
     // perform fetch
-    if (dpiOci__stmtFetch2(stmt, stmt->fetchArraySize, DPI_MODE_FETCH_NEXT, 0,
-            error) < 0)
+    if (dpiOci__stmtFetch2(stmt, numRows, DPI_MODE_FETCH_NEXT, 0, error) < 0)
         return DPI_FAILURE;
 
     // determine the number of rows fetched into buffers
@@ -614,13 +849,56 @@ static int dpiStmt__fetch(dpiStmt *stmt, dpiError *error)
     stmt->bufferRowIndex = 0;
 
     // perform post-fetch activities required
-    if (dpiStmt__postFetch(stmt, error) < 0)
+    if (dpiStmt__postFetch(stmt, convertValues, error) < 0)
         return DPI_FAILURE;
 
+    // if the fetch limit has now been reached, cancel the cursor so that no
+    // further rows are transferred from the database
+    if (stmt->fetchLimit > 0 && stmt->hasRowsToFetch &&
+            stmt->rowCount + stmt->bufferRowCount >= stmt->fetchLimit)
+        return dpiStmt__cancelFetch(stmt, error);
+
     return DPI_SUCCESS;
 }
 
 
+//-----------------------------------------------------------------------------
+// dpiStmt__fetchAggregates() [INTERNAL]
+//   Fetch all remaining rows and add them to the aggregate result, which is
+// finalized once the last row has been added. Rows already in the buffers are
+// included.
+//-----------------------------------------------------------------------------
+static int dpiStmt__fetchAggregates(dpiStmt *stmt, uint32_t numSpecs,
+        dpiAggregateSpec *specs, uint32_t groupByPos,
+        dpiAggregateResult *result, dpiError *error)
+{
+    uint32_t numRows;
+
+    if (dpiStmt__preFetch(stmt, error) < 0)
+        return DPI_FAILURE;
+    if (dpiAggregateResult__setSpecs(result, numSpecs, specs, groupByPos,
+            stmt->queryVars, stmt->numQueryVars, error) < 0)
+        return DPI_FAILURE;
+    while (1) {
+        if (stmt->bufferRowIndex >= stmt->bufferRowCount) {
+            if (!stmt->hasRowsToFetch)
+                break;
+            if (dpiStmt__fetch(stmt, 0, error) < 0)
+                return DPI_FAILURE;
+            if (stmt->bufferRowIndex >= stmt->bufferRowCount)
+                break;
+        }
+        numRows = stmt->bufferRowCount - stmt->bufferRowIndex;
+        if (dpiAggregateResult__addRows(result, stmt->queryVars,
+                stmt->bufferRowIndex, numRows, error) < 0)
+            return DPI_FAILURE;
+        stmt->bufferRowIndex += numRows;
+        stmt->rowCount += numRows;
+    }
+    return dpiAggregateResult__finalize(result, error);
+}
+
+
 //-----------------------------------------------------------------------------
 // dpiStmt__free() [INTERNAL]
 //   Free the memory associated with the statement.
@@ -632,6 +910,48 @@ void dpiStmt__free(dpiStmt *stmt, dpiError *error)
 }
 
 
+//-----------------------------------------------------------------------------
+// dpiStmt__fetchRows() [INTERNAL]
+//   Return the rows available in the buffer, fetching more rows from the
+// database first if the buffer has been exhausted. If a timeout (in
+// milliseconds) is specified, the fetch is interrupted by the watchdog if it
+// takes longer than that.
+//-----------------------------------------------------------------------------
+static int dpiStmt__fetchRows(dpiStmt *stmt, uint32_t maxRows,
+        uint32_t timeout, uint32_t *bufferRowIndex, uint32_t *numRowsFetched,
+        int *moreRows, dpiError *error)
+{
+    dpiWatchdogEntry entry;
+    int status;
+
+    if (stmt->bufferRowIndex >= stmt->bufferRowCount) {
+        if (stmt->hasRowsToFetch) {
+            if (dpiWatchdog__addEntry(&entry, stmt->conn, timeout, error) < 0)
+                return DPI_FAILURE;
+            status = dpiStmt__fetch(stmt, 1, error);
+            if (dpiWatchdog__removeEntry(&entry, status, error) < 0)
+                return DPI_FAILURE;
+        }
+        if (stmt->bufferRowIndex >= stmt->bufferRowCount) {
+            *moreRows = 0;
+            *bufferRowIndex = 0;
+            *numRowsFetched = 0;
+            return DPI_SUCCESS;
+        }
+    }
+    *bufferRowIndex = stmt->bufferRowIndex;
+    *numRowsFetched = stmt->bufferRowCount - stmt->bufferRowIndex;
+    *moreRows = stmt->hasRowsToFetch;
+    if (*numRowsFetched > maxRows) {
+        *numRowsFetched = maxRows;
+        *moreRows = 1;
+    }
+    stmt->bufferRowIndex += *numRowsFetched;
+    stmt->rowCount += *numRowsFetched;
+    return DPI_SUCCESS;
+}
+
+
 //-----------------------------------------------------------------------------
 // dpiStmt__getBatchErrors() [INTERNAL]
 //   Get batch errors after statement executed with batch errors enabled.
@@ -707,6 +1027,9 @@ static int dpiStmt__getBatchErrors(dpiStmt *stmt, dpiError *error)
             break;
         }
         localError.buffer->fnName = error->buffer->fnName;
+        if (stmt->permutation && rowOffset >= 0 &&
+                (uint32_t) rowOffset < stmt->permutationLength)
+            rowOffset = (int32_t) stmt->permutation[rowOffset];
         localError.buffer->offset = rowOffset;
 
     }
@@ -720,6 +1043,29 @@ static int dpiStmt__getBatchErrors(dpiStmt *stmt, dpiError *error)
 }
 
 
+//-----------------------------------------------------------------------------
+// dpiStmt__getBindValues() [INTERNAL]
+//   Transfer data from Oracle buffer structures to dpiData structures for all
+// bound variables.
+//-----------------------------------------------------------------------------
+static int dpiStmt__getBindValues(dpiStmt *stmt, dpiError *error)
+{
+    uint32_t i, j;
+    dpiVar *var;
+
+    for (i = 0; i < stmt->numBindVars; i++) {
+        var = stmt->bindVars[i].var;
+        for (j = 0; j < var->maxArraySize; j++) {
+            if (dpiVar__getValue(var, j, &var->externalData[j], error) < 0)
+                return DPI_FAILURE;
+        }
+        var->error = NULL;
+    }
+
+    return DPI_SUCCESS;
+}
+
+
 //-----------------------------------------------------------------------------
 // dpiStmt__getQueryInfo() [INTERNAL]
 //   Get query information for the position in question.
@@ -798,24 +1144,66 @@ int dpiStmt__init(dpiStmt *stmt, dpiError *error)
 }
 
 
+//-----------------------------------------------------------------------------
+// dpiStmt__isRetryable() [INTERNAL]
+//   Determine if the error raised while executing the statement may be
+// overcome by executing it again. Errors which show that the session is
+// unusable can only be overcome by replacing the session, which is only
+// possible for connections acquired from homogeneous pools that have no
+// other statements or LOBs open, as these would be left referring to the
+// original session, and when no transaction was in progress on the original
+// session before the statement was executed. Errors raised while replacing
+// the session are always considered transient. Otherwise, errors which
+// Transaction Guard reports as recoverable and a small number of transient
+// errors may be overcome.
+//-----------------------------------------------------------------------------
+static int dpiStmt__isRetryable(dpiStmt *stmt, int inTransaction,
+        dpiError *error)
+{
+    dpiConn *conn = stmt->conn;
+
+    if (conn->dropSession)
+        return (!inTransaction && conn->pool && !conn->standalone &&
+                conn->pool->homogeneous && conn->openChildCount == 1);
+    if (!stmt->handle || error->buffer->isRecoverable)
+        return 1;
+    switch (error->buffer->code) {
+        case    60: // deadlock detected while waiting for resource
+        case 25408: // can not safely replay call
+            return 1;
+    }
+    return 0;
+}
+
+
 //-----------------------------------------------------------------------------
 // dpiStmt__postFetch() [INTERNAL]
 //   Performs the transformations required to convert Oracle data values into
-// C data values.
+// C data values, transcoding byte strings if an output encoding has been set
+// on the variable. If the values are not to be converted (as is the case when
+// computing fingerprints directly from the define buffers), only the state
+// of the variables is updated.
 //-----------------------------------------------------------------------------
-static int dpiStmt__postFetch(dpiStmt *stmt, dpiError *error)
+static int dpiStmt__postFetch(dpiStmt *stmt, int convertValues,
+        dpiError *error)
 {
     uint32_t i, j;
     dpiVar *var;
 
     for (i = 0; i < stmt->numQueryVars; i++) {
         var = stmt->queryVars[i];
-        for (j = 0; j < stmt->bufferRowCount; j++) {
+        if (var->transcodeBuffer)
+            dpiVar__resetBytes(var, var->maxArraySize);
+        for (j = 0; convertValues && j < stmt->bufferRowCount; j++) {
             if (dpiVar__getValue(var, j, &var->externalData[j], error) < 0)
                 return DPI_FAILURE;
             if (var->type->requiresPreFetch)
                 var->requiresPreFetch = 1;
         }
+        if (convertValues && var->outputCharsetId &&
+                dpiTranscode__convertRows(var, stmt->bufferRowCount,
+                        error) < 0)
+            return DPI_FAILURE;
         var->error = NULL;
     }
 
@@ -849,6 +1237,7 @@ static int dpiStmt__preFetch(dpiStmt *stmt, dpiError *error)
                     queryInfo->typeInfo.clientSizeInBytes, 1, 0,
                     queryInfo->typeInfo.objectType, &var, &data, error) < 0)
                 return DPI_FAILURE;
+            var->isImplicitDefine = 1;
             if (dpiStmt__define(stmt, i + 1, var, error) < 0)
                 return DPI_FAILURE;
             dpiGen__setRefCount(var, error, -1);
@@ -880,6 +1269,97 @@ int dpiStmt__prepare(dpiStmt *stmt, const char *sql, uint32_t sqlLength,
 }
 
 
+//-----------------------------------------------------------------------------
+// dpiStmt__prepareAutoBind() [INTERNAL]
+//   Prepare a statement for execution after replacing the literals it
+// contains by bind variables and then bind the values of those literals by
+// position. Numeric literals are bound as numbers and string literals as
+// fixed length strings so that comparisons behave as they did with the
+// literals. Statements which are not candidates for this (and all statements
+// when the client encoding is UTF-16) are prepared unchanged.
+//-----------------------------------------------------------------------------
+int dpiStmt__prepareAutoBind(dpiStmt *stmt, const char *sql,
+        uint32_t sqlLength, const char *tag, uint32_t tagLength,
+        dpiError *error)
+{
+    dpiOracleTypeNum oracleTypeNum;
+    dpiAutoBindLiteral *literal;
+    dpiData *varData, data;
+    dpiAutoBind autoBind;
+    uint32_t i, size;
+    dpiVar *var;
+    int status;
+
+    // scan the statement; prepare it unchanged if it is not a candidate
+    if (stmt->env->charsetId == DPI_CHARSET_ID_UTF16)
+        return dpiStmt__prepare(stmt, sql, sqlLength, tag, tagLength, error);
+    if (dpiAutoBind__parse(&autoBind, sql, sqlLength, 0, error) < 0)
+        return DPI_FAILURE;
+    if (!autoBind.sql)
+        return dpiStmt__prepare(stmt, sql, sqlLength, tag, tagLength, error);
+
+    // prepare the normalized statement and bind the literals; empty strings
+    // are null, as they are in the database
+    status = dpiStmt__prepare(stmt, autoBind.sql, autoBind.sqlLength, tag,
+            tagLength, error);
+    for (i = 0; i < autoBind.numLiterals && status == DPI_SUCCESS; i++) {
+        literal = &autoBind.literals[i];
+        oracleTypeNum = (literal->isNumber) ? DPI_ORACLE_TYPE_NUMBER :
+                DPI_ORACLE_TYPE_CHAR;
+        size = (literal->isNumber || literal->length == 0) ? 1 :
+                literal->length;
+        if (dpiVar__allocate(stmt->conn, oracleTypeNum, DPI_NATIVE_TYPE_BYTES,
+                1, size, 1, 0, NULL, &var, &varData, error) < 0) {
+            status = DPI_FAILURE;
+            break;
+        }
+        data.isNull = (literal->length == 0);
+        data.value.asBytes.ptr = autoBind.values + literal->offset;
+        data.value.asBytes.length = literal->length;
+        if (dpiVar__copyData(var, 0, &data, error) < 0 ||
+                dpiStmt__bind(stmt, var, 0, i + 1, NULL, 0, error) < 0) {
+            dpiVar__free(var, error);
+            status = DPI_FAILURE;
+        }
+    }
+    dpiAutoBind__clear(&autoBind);
+    return status;
+}
+
+
+//-----------------------------------------------------------------------------
+// dpiStmt__queryShared() [INTERNAL]
+//   Execute the query on the connection on behalf of all callers of
+// dpiPool_queryShared() with the same SQL and bind values, adding all of the
+// rows it returns to the shared result. The statement is released before
+// returning so that the connection can be released as well; errors raised
+// while releasing it are not reported so that the original error is retained.
+//-----------------------------------------------------------------------------
+int dpiStmt__queryShared(dpiConn *conn, const char *sql, uint32_t sqlLength,
+        uint32_t numBinds, dpiNativeTypeNum *bindNativeTypeNums,
+        dpiData *bindValues, dpiSharedResult *result, dpiError *error)
+{
+    dpiErrorBuffer localErrorBuffer;
+    dpiError localError;
+    dpiStmt *stmt;
+    int status;
+
+    if (dpiStmt__allocate(conn, 0, &stmt, error) < 0)
+        return DPI_FAILURE;
+    if (dpiStmt__prepare(stmt, sql, sqlLength, NULL, 0, error) < 0) {
+        dpiStmt__free(stmt, error);
+        dpiConn__decrementOpenChildCount(conn, error);
+        return DPI_FAILURE;
+    }
+    status = dpiStmt__executeShared(stmt, numBinds, bindNativeTypeNums,
+            bindValues, result, error);
+    localError = *error;
+    localError.buffer = &localErrorBuffer;
+    dpiGen__setRefCount(stmt, &localError, -1);
+    return status;
+}
+
+
 //-----------------------------------------------------------------------------
 // dpiStmt__reExecute() [INTERNAL]
 //   Re-execute the statement after receiving the error ORA-01007: variable not
@@ -891,10 +1371,8 @@ static int dpiStmt__reExecute(dpiStmt *stmt, uint32_t numIters,
         dpiExecMode mode, dpiError *error)
 {
     void *origHandle, *newHandle;
-    uint32_t sqlLength, i;
     dpiError localError;
-    dpiBindVar *bindVar;
-    dpiVar *var;
+    uint32_t sqlLength;
     int status;
     char *sql;
 
@@ -925,6 +1403,25 @@ static int dpiStmt__reExecute(dpiStmt *stmt, uint32_t numIters,
     dpiStmt__clearQueryVars(stmt, error);
 
     // perform binds
+    if (dpiStmt__rebind(stmt, error) < 0)
+        return DPI_FAILURE;
+
+    // now re-execute the statement
+    return dpiStmt__execute(stmt, numIters, mode, 0, error);
+}
+
+
+//-----------------------------------------------------------------------------
+// dpiStmt__rebind() [INTERNAL]
+//   Bind all of the bound variables a second time. This is needed when the
+// statement handle is replaced.
+//-----------------------------------------------------------------------------
+static int dpiStmt__rebind(dpiStmt *stmt, dpiError *error)
+{
+    dpiBindVar *bindVar;
+    dpiVar *var;
+    uint32_t i;
+
     for (i = 0; i < stmt->numBindVars; i++) {
         bindVar = &stmt->bindVars[i];
         if (!bindVar->var)
@@ -938,8 +1435,78 @@ static int dpiStmt__reExecute(dpiStmt *stmt, uint32_t numIters,
         }
     }
 
-    // now re-execute the statement
-    return dpiStmt__execute(stmt, numIters, mode, 0, error);
+    return DPI_SUCCESS;
+}
+
+
+//-----------------------------------------------------------------------------
+// dpiStmt__replaceSession() [INTERNAL]
+//   Replace the unusable session of the connection by a new session from the
+// pool (unless that has already been done) and prepare the statement again
+// using the new session, binding all of the bound variables again.
+// Variables defined by the caller are discarded as they would be if the
+// statement had been prepared again.
+//-----------------------------------------------------------------------------
+static int dpiStmt__replaceSession(dpiStmt *stmt, const char *sql,
+        uint32_t sqlLength, dpiRetryInfo *info, dpiError *error)
+{
+    dpiErrorBuffer localErrorBuffer;
+    dpiError localError;
+
+    // release the original statement, removing it from the statement cache;
+    // errors are ignored as the session it was prepared on is unusable
+    if (stmt->handle) {
+        localError = *error;
+        localError.buffer = &localErrorBuffer;
+        stmt->deleteFromCache = 1;
+        dpiOci__stmtRelease(stmt, NULL, 0, 0, &localError);
+        stmt->handle = NULL;
+        stmt->deleteFromCache = 0;
+    }
+
+    // replace the session, if needed
+    if (stmt->conn->dropSession || !stmt->conn->handle) {
+        if (dpiConn__replaceSession(stmt->conn, error) < 0)
+            return DPI_FAILURE;
+        info->numSessionsReplaced++;
+    }
+
+    // prepare the statement again and perform binds
+    if (dpiStmt__prepare(stmt, sql, sqlLength, NULL, 0, error) < 0)
+        return DPI_FAILURE;
+    dpiStmt__clearBatchErrors(stmt, error);
+    dpiStmt__clearQueryVars(stmt, error);
+    return dpiStmt__rebind(stmt, error);
+}
+
+
+//-----------------------------------------------------------------------------
+// dpiStmt__setBindValues() [INTERNAL]
+//   Transfer data from dpiData structures to Oracle buffer structures for all
+// bound variables.
+//-----------------------------------------------------------------------------
+static int dpiStmt__setBindValues(dpiStmt *stmt, dpiError *error)
+{
+    uint32_t i, j;
+    dpiData *data;
+    dpiVar *var;
+
+    for (i = 0; i < stmt->numBindVars; i++) {
+        var = stmt->bindVars[i].var;
+        for (j = 0; j < var->maxArraySize; j++) {
+            data = &var->externalData[j];
+            if (var->type->oracleTypeNum == DPI_ORACLE_TYPE_STMT &&
+                    data->value.asStmt == stmt)
+                return dpiError__set(error, "bind to self",
+                        DPI_ERR_NOT_SUPPORTED);
+            if (dpiVar__setValue(var, j, data, error) < 0)
+                return DPI_FAILURE;
+        }
+        if (stmt->isReturning || var->isDynamic)
+            var->error = error;
+    }
+
+    return DPI_SUCCESS;
 }
 
 
@@ -1170,6 +1737,57 @@ int dpiStmt_executeMany(dpiStmt *stmt, dpiExecMode mode, uint32_t numIters)
 }
 
 
+//-----------------------------------------------------------------------------
+// dpiStmt_executeWithRetry() [PUBLIC]
+//   Execute the statement, replaying it when it fails with a recoverable
+// error. The caller declares that the statement is idempotent by calling
+// this function.
+//-----------------------------------------------------------------------------
+int dpiStmt_executeWithRetry(dpiStmt *stmt, dpiExecMode mode,
+        dpiRetryParams *params, uint32_t *numQueryColumns)
+{
+    uint32_t numIters;
+    dpiError error;
+
+    if (dpiStmt__checkOpen(stmt, __func__, &error) < 0)
+        return DPI_FAILURE;
+    DPI_CHECK_PTR_NOT_NULL(params)
+    numIters = (stmt->statementType == DPI_STMT_TYPE_SELECT) ? 0 : 1;
+    if (dpiStmt__executeWithRetry(stmt, numIters, mode, params, &error) < 0)
+        return DPI_FAILURE;
+    if (numQueryColumns)
+        *numQueryColumns = stmt->numQueryVars;
+    return DPI_SUCCESS;
+}
+
+
+//-----------------------------------------------------------------------------
+// dpiStmt_executeWithTimeout() [PUBLIC]
+//   Execute a statement, as with dpiStmt_execute(), but interrupt the call if
+// it takes longer than the specified timeout (in milliseconds).
+//-----------------------------------------------------------------------------
+int dpiStmt_executeWithTimeout(dpiStmt *stmt, dpiExecMode mode,
+        uint32_t timeout, uint32_t *numQueryColumns)
+{
+    dpiWatchdogEntry entry;
+    uint32_t numIters;
+    dpiError error;
+    int status;
+
+    if (dpiStmt__checkOpen(stmt, __func__, &error) < 0)
+        return DPI_FAILURE;
+    numIters = (stmt->statementType == DPI_STMT_TYPE_SELECT) ? 0 : 1;
+    if (dpiWatchdog__addEntry(&entry, stmt->conn, timeout, &error) < 0)
+        return DPI_FAILURE;
+    status = dpiStmt__execute(stmt, numIters, mode, 1, &error);
+    if (dpiWatchdog__removeEntry(&entry, status, &error) < 0)
+        return DPI_FAILURE;
+    if (numQueryColumns)
+        *numQueryColumns = stmt->numQueryVars;
+    return DPI_SUCCESS;
+}
+
+
 //-----------------------------------------------------------------------------
 // dpiStmt_fetch() [PUBLIC]
 //   Fetch a row from the database.
@@ -1183,7 +1801,7 @@ int dpiStmt_fetch(dpiStmt *stmt, int *found, uint32_t *bufferRowIndex)
     DPI_CHECK_PTR_NOT_NULL(found)
     DPI_CHECK_PTR_NOT_NULL(bufferRowIndex)
     if (stmt->bufferRowIndex >= stmt->bufferRowCount) {
-        if (stmt->hasRowsToFetch && dpiStmt__fetch(stmt, &error) < 0)
+        if (stmt->hasRowsToFetch && dpiStmt__fetch(stmt, 1, &error) < 0)
             return DPI_FAILURE;
         if (stmt->bufferRowIndex >= stmt->bufferRowCount) {
             *found = 0;
@@ -1198,6 +1816,79 @@ int dpiStmt_fetch(dpiStmt *stmt, int *found, uint32_t *bufferRowIndex)
 }
 
 
+//-----------------------------------------------------------------------------
+// dpiStmt_fetchAggregates() [PUBLIC]
+//   Fetch all remaining rows and compute the specified aggregates over them,
+// optionally grouped by the values of one of the columns. Rows fetched from
+// the database are aggregated directly from the define buffers and are not
+// converted to C data values.
+//-----------------------------------------------------------------------------
+int dpiStmt_fetchAggregates(dpiStmt *stmt, uint32_t numSpecs,
+        dpiAggregateSpec *specs, uint32_t groupByPos,
+        dpiAggregateResult **result)
+{
+    dpiAggregateResult *tempResult;
+    dpiError error;
+
+    if (dpiStmt__checkOpen(stmt, __func__, &error) < 0)
+        return DPI_FAILURE;
+    if (numSpecs > 0 && !specs)
+        return dpiError__set(&error, "check parameter specs",
+                DPI_ERR_NULL_POINTER_PARAMETER, "specs");
+    DPI_CHECK_PTR_NOT_NULL(result)
+    if (!stmt->queryVars)
+        return dpiError__set(&error, "check query vars",
+                DPI_ERR_QUERY_NOT_EXECUTED);
+    if (dpiAggregateResult__allocate(stmt->conn, &tempResult, &error) < 0)
+        return DPI_FAILURE;
+    if (dpiStmt__fetchAggregates(stmt, numSpecs, specs, groupByPos,
+            tempResult, &error) < 0) {
+        dpiAggregateResult__free(tempResult, &error);
+        return DPI_FAILURE;
+    }
+    *result = tempResult;
+    return DPI_SUCCESS;
+}
+
+
+//-----------------------------------------------------------------------------
+// dpiStmt_fetchFingerprint() [PUBLIC]
+//   Fetch all remaining rows and add them to the fingerprint. Rows already in
+// the buffers are included. Rows fetched from the database are hashed
+// directly from the define buffers and are not converted to C data values.
+//-----------------------------------------------------------------------------
+int dpiStmt_fetchFingerprint(dpiStmt *stmt, dpiFingerprint *fingerprint)
+{
+    uint32_t numRows;
+    dpiError error;
+
+    if (dpiStmt__checkOpen(stmt, __func__, &error) < 0)
+        return DPI_FAILURE;
+    DPI_CHECK_PTR_NOT_NULL(fingerprint)
+    if (fingerprint->numColumns > 0 && !fingerprint->columnDigests)
+        return dpiError__set(&error, "check column digests",
+                DPI_ERR_NULL_POINTER_PARAMETER, "columnDigests");
+    while (1) {
+        if (stmt->bufferRowIndex >= stmt->bufferRowCount) {
+            if (!stmt->hasRowsToFetch)
+                break;
+            if (dpiStmt__fetch(stmt, 0, &error) < 0)
+                return DPI_FAILURE;
+            if (stmt->bufferRowIndex >= stmt->bufferRowCount)
+                break;
+        }
+        numRows = stmt->bufferRowCount - stmt->bufferRowIndex;
+        if (dpiFingerprint__addRows(fingerprint, stmt->queryVars,
+                stmt->numQueryVars, stmt->bufferRowIndex, numRows,
+                &error) < 0)
+            return DPI_FAILURE;
+        stmt->bufferRowIndex += numRows;
+        stmt->rowCount += numRows;
+    }
+    return DPI_SUCCESS;
+}
+
+
 //-----------------------------------------------------------------------------
 // dpiStmt_fetchRows() [PUBLIC]
 //   Fetch rows into buffers and return the number of rows that were so
@@ -1214,25 +1905,70 @@ int dpiStmt_fetchRows(dpiStmt *stmt, uint32_t maxRows,
     DPI_CHECK_PTR_NOT_NULL(bufferRowIndex)
     DPI_CHECK_PTR_NOT_NULL(numRowsFetched)
     DPI_CHECK_PTR_NOT_NULL(moreRows)
+    return dpiStmt__fetchRows(stmt, maxRows, 0, bufferRowIndex,
+            numRowsFetched, moreRows, &error);
+}
+
+
+//-----------------------------------------------------------------------------
+// dpiStmt_fetchRowsWithTimeout() [PUBLIC]
+//   Fetch rows into buffers, as with dpiStmt_fetchRows(), but interrupt the
+// fetch from the database if it takes longer than the specified timeout (in
+// milliseconds).
+//-----------------------------------------------------------------------------
+int dpiStmt_fetchRowsWithTimeout(dpiStmt *stmt, uint32_t maxRows,
+        uint32_t timeout, uint32_t *bufferRowIndex, uint32_t *numRowsFetched,
+        int *moreRows)
+{
+    dpiError error;
+
+    if (dpiStmt__checkOpen(stmt, __func__, &error) < 0)
+        return DPI_FAILURE;
+    DPI_CHECK_PTR_NOT_NULL(bufferRowIndex)
+    DPI_CHECK_PTR_NOT_NULL(numRowsFetched)
+    DPI_CHECK_PTR_NOT_NULL(moreRows)
+    return dpiStmt__fetchRows(stmt, maxRows, timeout, bufferRowIndex,
+            numRowsFetched, moreRows, &error);
+}
+
+
+//-----------------------------------------------------------------------------
+// dpiStmt_fetchToRing() [PUBLIC]
+//   Fetch rows into buffers and export them to the ring buffer as a single
+// batch, up to the maximum number of rows specified. Fewer rows are exported
+// if the ring buffer does not have enough free space; if it is full, no rows
+// are exported and the caller should wait for the consumer to release some
+// batches before trying again.
+//-----------------------------------------------------------------------------
+int dpiStmt_fetchToRing(dpiStmt *stmt, dpiRing *ring, uint32_t maxRows,
+        uint32_t *numRowsExported, int *moreRows)
+{
+    dpiError error;
+
+    if (dpiStmt__checkOpen(stmt, __func__, &error) < 0)
+        return DPI_FAILURE;
+    DPI_CHECK_PTR_NOT_NULL(ring)
+    DPI_CHECK_PTR_NOT_NULL(numRowsExported)
+    DPI_CHECK_PTR_NOT_NULL(moreRows)
     if (stmt->bufferRowIndex >= stmt->bufferRowCount) {
-        if (stmt->hasRowsToFetch && dpiStmt__fetch(stmt, &error) < 0)
+        if (stmt->hasRowsToFetch && dpiStmt__fetch(stmt, 1, &error) < 0)
             return DPI_FAILURE;
         if (stmt->bufferRowIndex >= stmt->bufferRowCount) {
             *moreRows = 0;
-            *bufferRowIndex = 0;
-            *numRowsFetched = 0;
+            *numRowsExported = 0;
             return DPI_SUCCESS;
         }
     }
-    *bufferRowIndex = stmt->bufferRowIndex;
-    *numRowsFetched = stmt->bufferRowCount - stmt->bufferRowIndex;
-    *moreRows = stmt->hasRowsToFetch;
-    if (*numRowsFetched > maxRows) {
-        *numRowsFetched = maxRows;
-        *moreRows = 1;
-    }
-    stmt->bufferRowIndex += *numRowsFetched;
-    stmt->rowCount += *numRowsFetched;
+    *numRowsExported = stmt->bufferRowCount - stmt->bufferRowIndex;
+    if (*numRowsExported > maxRows)
+        *numRowsExported = maxRows;
+    if (dpiRing__exportRows(ring, stmt->queryVars, stmt->numQueryVars,
+            stmt->bufferRowIndex, numRowsExported, &error) < 0)
+        return DPI_FAILURE;
+    stmt->bufferRowIndex += *numRowsExported;
+    stmt->rowCount += *numRowsExported;
+    *moreRows = (stmt->hasRowsToFetch ||
+            stmt->bufferRowIndex < stmt->bufferRowCount);
     return DPI_SUCCESS;
 }
 
@@ -1364,6 +2100,22 @@ int dpiStmt_getFetchArraySize(dpiStmt *stmt, uint32_t *arraySize)
 }
 
 
+//-----------------------------------------------------------------------------
+// dpiStmt_getFetchLimit() [PUBLIC]
+//   Get the maximum number of rows that will be fetched from the database.
+//-----------------------------------------------------------------------------
+int dpiStmt_getFetchLimit(dpiStmt *stmt, uint64_t *maxRows)
+{
+    dpiError error;
+
+    if (dpiStmt__checkOpen(stmt, __func__, &error) < 0)
+        return DPI_FAILURE;
+    DPI_CHECK_PTR_NOT_NULL(maxRows)
+    *maxRows = stmt->fetchLimit;
+    return DPI_SUCCESS;
+}
+
+
 //-----------------------------------------------------------------------------
 // dpiStmt_getImplicitResult() [PUBLIC]
 //   Return the next implicit result from the previously executed statement. If
@@ -1418,7 +2170,8 @@ int dpiStmt_getInfo(dpiStmt *stmt, dpiStmtInfo *info)
             stmt->statementType == DPI_STMT_TYPE_ALTER);
     info->isDML = (stmt->statementType == DPI_STMT_TYPE_INSERT ||
             stmt->statementType == DPI_STMT_TYPE_UPDATE ||
-            stmt->statementType == DPI_STMT_TYPE_DELETE);
+            stmt->statementType == DPI_STMT_TYPE_DELETE ||
+            stmt->statementType == DPI_STMT_TYPE_MERGE);
     info->statementType = stmt->statementType;
     info->isReturning = stmt->isReturning;
     return DPI_SUCCESS;
@@ -1539,6 +2292,7 @@ int dpiStmt_getRowCounts(dpiStmt *stmt, uint32_t *numRowCounts,
         uint64_t **rowCounts)
 {
     dpiError error;
+    uint32_t i;
 
     if (dpiStmt__checkOpen(stmt, __func__, &error) < 0)
         return DPI_FAILURE;
@@ -1547,9 +2301,44 @@ int dpiStmt_getRowCounts(dpiStmt *stmt, uint32_t *numRowCounts,
     if (stmt->env->versionInfo->versionNum < 12)
         return dpiError__set(&error, "unsupported Oracle client",
                 DPI_ERR_NOT_SUPPORTED);
-    return dpiOci__attrGet(stmt->handle, DPI_OCI_HTYPE_STMT, rowCounts,
+    if (dpiOci__attrGet(stmt->handle, DPI_OCI_HTYPE_STMT, rowCounts,
             numRowCounts, DPI_OCI_ATTR_DML_ROW_COUNT_ARRAY, "get row counts",
-            &error);
+            &error) < 0)
+        return DPI_FAILURE;
+
+    // if the bind variables were sorted before execution, return the row
+    // counts in the original order of the rows
+    if (!stmt->permutation || *numRowCounts != stmt->permutationLength)
+        return DPI_SUCCESS;
+    if (!stmt->permutedRowCounts) {
+        stmt->permutedRowCounts = malloc(*numRowCounts * sizeof(uint64_t));
+        if (!stmt->permutedRowCounts)
+            return dpiError__set(&error, "allocate row counts",
+                    DPI_ERR_NO_MEMORY);
+    }
+    for (i = 0; i < *numRowCounts; i++)
+        stmt->permutedRowCounts[stmt->permutation[i]] = (*rowCounts)[i];
+    *rowCounts = stmt->permutedRowCounts;
+    return DPI_SUCCESS;
+}
+
+
+//-----------------------------------------------------------------------------
+// dpiStmt_getSql() [PUBLIC]
+//   Return the SQL text that was prepared. When the statement was prepared on
+// a connection using the prepare mode DPI_MODE_PREPARE_AUTO_BIND this is the
+// normalized text in which literals have been replaced by bind variables.
+//-----------------------------------------------------------------------------
+int dpiStmt_getSql(dpiStmt *stmt, const char **sql, uint32_t *sqlLength)
+{
+    dpiError error;
+
+    if (dpiStmt__checkOpen(stmt, __func__, &error) < 0)
+        return DPI_FAILURE;
+    DPI_CHECK_PTR_NOT_NULL(sql)
+    DPI_CHECK_PTR_NOT_NULL(sqlLength)
+    return dpiOci__attrGet(stmt->handle, DPI_OCI_HTYPE_STMT, (void*) sql,
+            sqlLength, DPI_OCI_ATTR_STATEMENT, "get statement", &error);
 }
 
 
@@ -1665,7 +2454,7 @@ int dpiStmt_scroll(dpiStmt *stmt, dpiFetchMode mode, int32_t offset,
     stmt->bufferRowIndex = 0;
 
     // perform post-fetch activities required
-    if (dpiStmt__postFetch(stmt, &error) < 0)
+    if (dpiStmt__postFetch(stmt, 1, &error) < 0)
         return DPI_FAILURE;
 
     return DPI_SUCCESS;
@@ -1698,3 +2487,150 @@ int dpiStmt_setFetchArraySize(dpiStmt *stmt, uint32_t arraySize)
     return DPI_SUCCESS;
 }
 
+
+//-----------------------------------------------------------------------------
+// dpiStmt_setFetchLimit() [PUBLIC]
+//   Set the maximum number of rows that will be fetched from the database. A
+// value of 0 means that there is no limit. Scrollable cursors are not
+// supported.
+//-----------------------------------------------------------------------------
+int dpiStmt_setFetchLimit(dpiStmt *stmt, uint64_t maxRows)
+{
+    dpiError error;
+
+    if (dpiStmt__checkOpen(stmt, __func__, &error) < 0)
+        return DPI_FAILURE;
+    if (stmt->scrollable)
+        return dpiError__set(&error, "check scrollable",
+                DPI_ERR_NOT_SUPPORTED);
+    stmt->fetchLimit = maxRows;
+    return DPI_SUCCESS;
+}
+
+
+//-----------------------------------------------------------------------------
+// dpiStmt_sortBinds() [PUBLIC]
+//   Sort the first rows of all of the variables bound to the statement by the
+// values of the key variables, so that rows with adjacent keys are sent to
+// the database together. The permutation is retained so that batch errors
+// and row counts from the next execution refer to the original positions of
+// the rows.
+//-----------------------------------------------------------------------------
+int dpiStmt_sortBinds(dpiStmt *stmt, uint32_t numIters, uint32_t numKeyVars,
+        dpiVar **keyVars, uint32_t *permutation)
+{
+    uint32_t i, j;
+    dpiError error;
+    dpiVar *var;
+    int found;
+
+    // validate parameters
+    if (dpiStmt__checkOpen(stmt, __func__, &error) < 0)
+        return DPI_FAILURE;
+    if (numKeyVars > 0)
+        DPI_CHECK_PTR_NOT_NULL(keyVars)
+    for (i = 0; i < stmt->numBindVars; i++) {
+        var = stmt->bindVars[i].var;
+        if (var->isArray)
+            return dpiError__set(&error, "check array", DPI_ERR_NOT_SUPPORTED);
+        if (var->maxArraySize < numIters)
+            return dpiError__set(&error, "check array size",
+                    DPI_ERR_ARRAY_SIZE_TOO_SMALL, var->maxArraySize);
+    }
+    for (i = 0; i < numKeyVars; i++) {
+        if (dpiGen__checkHandle(keyVars[i], DPI_HTYPE_VAR, "check key variable",
+                &error) < 0)
+            return DPI_FAILURE;
+        for (j = 0, found = 0; j < stmt->numBindVars && !found; j++)
+            found = (stmt->bindVars[j].var == keyVars[i]);
+        if (!found)
+            return dpiError__set(&error, "check key variable",
+                    DPI_ERR_SORT_KEY_NOT_BOUND);
+    }
+
+    // determine the order of the rows
+    dpiStmt__clearPermutation(stmt);
+    if (numIters == 0)
+        return DPI_SUCCESS;
+    stmt->permutation = malloc(numIters * sizeof(uint32_t));
+    if (!stmt->permutation)
+        return dpiError__set(&error, "allocate permutation",
+                DPI_ERR_NO_MEMORY);
+    if (dpiSort__sortRows(keyVars, numKeyVars, numIters, stmt->permutation,
+            &error) < 0) {
+        dpiStmt__clearPermutation(stmt);
+        return DPI_FAILURE;
+    }
+
+    // reorder each variable, taking care to reorder variables bound more
+    // than once only once
+    for (i = 0; i < stmt->numBindVars; i++) {
+        var = stmt->bindVars[i].var;
+        for (j = 0, found = 0; j < i && !found; j++)
+            found = (stmt->bindVars[j].var == var);
+        if (!found && dpiVar__permute(var, stmt->permutation, numIters,
+                &error) < 0) {
+            dpiStmt__clearPermutation(stmt);
+            return DPI_FAILURE;
+        }
+    }
+    stmt->permutationLength = numIters;
+    stmt->permutationPending = 1;
+    if (permutation)
+        memcpy(permutation, stmt->permutation, numIters * sizeof(uint32_t));
+    return DPI_SUCCESS;
+}
+
+
+//-----------------------------------------------------------------------------
+// dpiStmt_trimMemory() [PUBLIC]
+//   Release memory cached by the statement that is no longer needed and
+// return the number of bytes released. Once all rows of a query have been
+// fetched, the query variables that were created internally and that exceed
+// the low-water mark are released; they are created again when the statement
+// is next executed. Spare dynamic bytes buffers of all remaining query and
+// bind variables are also released.
+//-----------------------------------------------------------------------------
+int dpiStmt_trimMemory(dpiStmt *stmt, uint64_t lowWaterMark,
+        uint64_t *bytesReclaimed)
+{
+    uint64_t usage;
+    dpiError error;
+    dpiVar *var;
+    uint32_t i;
+
+    if (dpiStmt__checkOpen(stmt, __func__, &error) < 0)
+        return DPI_FAILURE;
+    DPI_CHECK_PTR_NOT_NULL(bytesReclaimed)
+    *bytesReclaimed = 0;
+
+    // release query variables created by the statement once all rows have
+    // been fetched; variables defined by the caller are retained so that the
+    // types chosen for them continue to be used
+    if (stmt->queryVars && !stmt->scrollable && !stmt->hasRowsToFetch &&
+            stmt->bufferRowIndex >= stmt->bufferRowCount) {
+        for (i = 0; i < stmt->numQueryVars; i++) {
+            var = stmt->queryVars[i];
+            if (!var || !var->isImplicitDefine)
+                continue;
+            usage = dpiVar__getMemoryUsage(var);
+            if (usage <= lowWaterMark)
+                continue;
+            dpiGen__setRefCount(var, &error, -1);
+            stmt->queryVars[i] = NULL;
+            *bytesReclaimed += usage;
+        }
+    }
+
+    // release spare dynamic bytes buffers of the remaining variables
+    for (i = 0; i < stmt->numQueryVars; i++) {
+        if (stmt->queryVars && stmt->queryVars[i])
+            dpiVar__trimMemory(stmt->queryVars[i], lowWaterMark,
+                    bytesReclaimed);
+    }
+    for (i = 0; i < stmt->numBindVars; i++)
+        dpiVar__trimMemory(stmt->bindVars[i].var, lowWaterMark,
+                bytesReclaimed);
+
+    return DPI_SUCCESS;
+}
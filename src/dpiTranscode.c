@@ -0,0 +1,324 @@
+//-----------------------------------------------------------------------------
+// Copyright (c) 2017 Oracle and/or its affiliates.  All rights reserved.
+// This program is free software: you can modify it and/or redistribute it
+// under the terms of:
+//
+// (i)  the Universal Permissive License v 1.0 or at your option, any
+//      later version (http://oss.oracle.com/licenses/upl); and/or
+//
+// (ii) the Apache License v 2.0. (http://www.apache.org/licenses/LICENSE-2.0)
+//-----------------------------------------------------------------------------
+
+//-----------------------------------------------------------------------------
+// dpiTranscode.c
+//   Implementation of transcoding between UTF-8 and UTF-16. UTF-16 always
+// uses the platform endianness in order to be compatible with OCI. Runs of
+// ASCII characters, which dominate most character data, are validated and
+// converted 16 characters at a time using SIMD instructions when they are
+// available; other characters are validated and converted one at a time.
+//-----------------------------------------------------------------------------
+
+#include "dpiImpl.h"
+
+// SSE2 is always available on x86-64 and NEON is always available on 64-bit
+// ARM so no runtime detection is required
+#if defined(__x86_64__) || defined(_M_X64)
+#include <emmintrin.h>
+#define DPI_TRANSCODE_SSE2
+#elif defined(__aarch64__) && defined(__ARM_NEON) && \
+        defined(__BYTE_ORDER__) && __BYTE_ORDER__ == __ORDER_LITTLE_ENDIAN__
+#include <arm_neon.h>
+#define DPI_TRANSCODE_NEON
+#endif
+
+// forward declarations of internal functions only used in this file
+static int dpiTranscode__fromUtf8(const uint8_t *source,
+        uint32_t sourceLength, uint16_t *target, uint32_t *targetLength);
+static int dpiTranscode__fromUtf16(const uint16_t *source,
+        uint32_t sourceLength, uint8_t *target, uint32_t *targetLength);
+
+
+//-----------------------------------------------------------------------------
+// dpiTranscode__convertRows() [INTERNAL]
+//   Transcode the byte strings found in the first rows of the variable to the
+// output encoding requested for the variable. All of the transcoded values are
+// placed in a single buffer owned by the variable, which is enlarged as
+// needed, and the pointers in the dpiData structures are adjusted to refer to
+// it. The pointers are reset to the original buffers before the next fetch.
+//-----------------------------------------------------------------------------
+int dpiTranscode__convertRows(dpiVar *var, uint32_t numRows, dpiError *error)
+{
+    uint32_t i, targetLength, sourceCharsetId;
+    size_t requiredSize, offset;
+    const char *encoding;
+    dpiBytes *bytes;
+    dpiData *data;
+    int status;
+
+    // determine the size of buffer required to hold all of the transcoded
+    // values; each value is aligned so that UTF-16 characters can be
+    // accessed directly
+    requiredSize = 0;
+    for (i = 0; i < numRows; i++) {
+        data = &var->externalData[i];
+        if (data->isNull)
+            continue;
+        if (var->outputCharsetId == DPI_CHARSET_ID_UTF16)
+            requiredSize += (size_t) data->value.asBytes.length * 2;
+        else requiredSize += (size_t) data->value.asBytes.length / 2 * 3;
+        requiredSize = (requiredSize + 7) & ~((size_t) 7);
+    }
+
+    // enlarge the buffer, if needed
+    if (requiredSize > var->transcodeBufferSize) {
+        if (var->transcodeBuffer)
+            free(var->transcodeBuffer);
+        var->transcodeBufferSize = 0;
+        var->transcodeBuffer = malloc(requiredSize);
+        if (!var->transcodeBuffer)
+            return dpiError__set(error, "allocate transcode buffer",
+                    DPI_ERR_NO_MEMORY);
+        var->transcodeBufferSize = requiredSize;
+    }
+
+    // transcode each of the values
+    if (var->type->charsetForm == DPI_SQLCS_IMPLICIT)
+        sourceCharsetId = var->env->charsetId;
+    else sourceCharsetId = var->env->ncharsetId;
+    encoding = (var->outputCharsetId == DPI_CHARSET_ID_UTF16) ?
+            DPI_CHARSET_NAME_UTF16 : DPI_CHARSET_NAME_UTF8;
+    for (i = 0, offset = 0; i < numRows; i++) {
+        data = &var->externalData[i];
+        if (data->isNull)
+            continue;
+        bytes = &data->value.asBytes;
+        if (var->outputCharsetId == DPI_CHARSET_ID_UTF16)
+            status = dpiTranscode__fromUtf8((const uint8_t*) bytes->ptr,
+                    bytes->length,
+                    (uint16_t*) (var->transcodeBuffer + offset),
+                    &targetLength);
+        else status = dpiTranscode__fromUtf16((const uint16_t*) bytes->ptr,
+                bytes->length, (uint8_t*) var->transcodeBuffer + offset,
+                &targetLength);
+        if (status < 0)
+            return dpiError__set(error, "transcode value",
+                    DPI_ERR_INVALID_ENCODED_DATA, i,
+                    (sourceCharsetId == DPI_CHARSET_ID_UTF16) ?
+                            DPI_CHARSET_NAME_UTF16 : DPI_CHARSET_NAME_UTF8);
+        bytes->ptr = var->transcodeBuffer + offset;
+        bytes->length = targetLength;
+        bytes->encoding = encoding;
+        offset = (offset + targetLength + 7) & ~((size_t) 7);
+    }
+
+    return DPI_SUCCESS;
+}
+
+
+//-----------------------------------------------------------------------------
+// dpiTranscode__fromUtf8() [INTERNAL]
+//   Validate the UTF-8 string and convert it to UTF-16. The target must have
+// space for twice as many bytes as the source. Overlong sequences, surrogates
+// and code points beyond U+10FFFF are rejected.
+//-----------------------------------------------------------------------------
+static int dpiTranscode__fromUtf8(const uint8_t *source,
+        uint32_t sourceLength, uint16_t *target, uint32_t *targetLength)
+{
+    uint32_t pos = 0, numChars = 0, codePoint, numExtra, i;
+    uint8_t ch;
+
+    while (pos < sourceLength) {
+
+        // convert any run of ASCII characters in bulk
+        if (source[pos] < 0x80) {
+            i = dpiTranscode__widenAscii((const char*) source + pos,
+                    sourceLength - pos, target + numChars);
+            pos += i;
+            numChars += i;
+            continue;
+        }
+
+        // determine the length of the sequence and the minimum code point it
+        // is permitted to encode
+        ch = source[pos];
+        if (ch >= 0xc2 && ch <= 0xdf) {
+            numExtra = 1;
+            codePoint = ch & 0x1f;
+        } else if (ch >= 0xe0 && ch <= 0xef) {
+            numExtra = 2;
+            codePoint = ch & 0x0f;
+        } else if (ch >= 0xf0 && ch <= 0xf4) {
+            numExtra = 3;
+            codePoint = ch & 0x07;
+        } else return DPI_FAILURE;
+        if (sourceLength - pos <= numExtra)
+            return DPI_FAILURE;
+        for (i = 1; i <= numExtra; i++) {
+            if ((source[pos + i] & 0xc0) != 0x80)
+                return DPI_FAILURE;
+            codePoint = (codePoint << 6) | (source[pos + i] & 0x3f);
+        }
+        if ((numExtra == 2 && codePoint < 0x800) ||
+                (numExtra == 3 && codePoint < 0x10000) ||
+                (codePoint >= 0xd800 && codePoint <= 0xdfff) ||
+                codePoint > 0x10ffff)
+            return DPI_FAILURE;
+        pos += numExtra + 1;
+
+        // code points outside the basic multilingual plane require a
+        // surrogate pair
+        if (codePoint >= 0x10000) {
+            codePoint -= 0x10000;
+            target[numChars++] = (uint16_t) (0xd800 | (codePoint >> 10));
+            target[numChars++] = (uint16_t) (0xdc00 | (codePoint & 0x3ff));
+        } else target[numChars++] = (uint16_t) codePoint;
+
+    }
+
+    *targetLength = numChars * 2;
+    return DPI_SUCCESS;
+}
+
+
+//-----------------------------------------------------------------------------
+// dpiTranscode__fromUtf16() [INTERNAL]
+//   Validate the UTF-16 string and convert it to UTF-8. The target must have
+// space for one and a half times as many bytes as the source. Strings with an
+// odd number of bytes and unpaired surrogates are rejected.
+//-----------------------------------------------------------------------------
+static int dpiTranscode__fromUtf16(const uint16_t *source,
+        uint32_t sourceLength, uint8_t *target, uint32_t *targetLength)
+{
+    uint32_t pos = 0, numBytes = 0, numChars, codePoint, i;
+    uint16_t ch;
+
+    if (sourceLength % 2 != 0)
+        return DPI_FAILURE;
+    numChars = sourceLength / 2;
+    while (pos < numChars) {
+
+        // convert any run of ASCII characters in bulk
+        ch = source[pos];
+        if (ch < 0x80) {
+            i = dpiTranscode__narrowAscii(source + pos, numChars - pos,
+                    (char*) target + numBytes);
+            pos += i;
+            numBytes += i;
+            continue;
+        }
+
+        // characters in the basic multilingual plane require two or three
+        // bytes; surrogate pairs require four bytes
+        pos++;
+        if (ch < 0x800) {
+            target[numBytes++] = (uint8_t) (0xc0 | (ch >> 6));
+            target[numBytes++] = (uint8_t) (0x80 | (ch & 0x3f));
+        } else if (ch < 0xd800 || ch > 0xdfff) {
+            target[numBytes++] = (uint8_t) (0xe0 | (ch >> 12));
+            target[numBytes++] = (uint8_t) (0x80 | ((ch >> 6) & 0x3f));
+            target[numBytes++] = (uint8_t) (0x80 | (ch & 0x3f));
+        } else {
+            if (ch > 0xdbff || pos == numChars || source[pos] < 0xdc00 ||
+                    source[pos] > 0xdfff)
+                return DPI_FAILURE;
+            codePoint = 0x10000 + (((uint32_t) (ch & 0x3ff) << 10) |
+                    (source[pos++] & 0x3ff));
+            target[numBytes++] = (uint8_t) (0xf0 | (codePoint >> 18));
+            target[numBytes++] = (uint8_t) (0x80 | ((codePoint >> 12) & 0x3f));
+            target[numBytes++] = (uint8_t) (0x80 | ((codePoint >> 6) & 0x3f));
+            target[numBytes++] = (uint8_t) (0x80 | (codePoint & 0x3f));
+        }
+
+    }
+
+    *targetLength = numBytes;
+    return DPI_SUCCESS;
+}
+
+
+//-----------------------------------------------------------------------------
+// dpiTranscode__narrowAscii() [INTERNAL]
+//   Convert UTF-16 characters to single byte characters for as long as they
+// are ASCII characters. The number of characters converted is returned; if
+// this is less than the number of characters supplied, the next character is
+// not an ASCII character.
+//-----------------------------------------------------------------------------
+uint32_t dpiTranscode__narrowAscii(const uint16_t *source, uint32_t numChars,
+        char *target)
+{
+    uint32_t i = 0;
+#if defined(DPI_TRANSCODE_SSE2)
+    __m128i low, high, mask, zero;
+
+    mask = _mm_set1_epi16((short) 0xff80);
+    zero = _mm_setzero_si128();
+    for (; i + 16 <= numChars; i += 16) {
+        low = _mm_loadu_si128((const __m128i*) (source + i));
+        high = _mm_loadu_si128((const __m128i*) (source + i + 8));
+        if (_mm_movemask_epi8(_mm_cmpeq_epi16(_mm_and_si128(
+                _mm_or_si128(low, high), mask), zero)) != 0xffff)
+            break;
+        _mm_storeu_si128((__m128i*) (target + i),
+                _mm_packus_epi16(low, high));
+    }
+#elif defined(DPI_TRANSCODE_NEON)
+    uint16x8_t low, high;
+
+    for (; i + 16 <= numChars; i += 16) {
+        low = vld1q_u16(source + i);
+        high = vld1q_u16(source + i + 8);
+        if (vmaxvq_u16(vorrq_u16(low, high)) >= 0x80)
+            break;
+        vst1q_u8((uint8_t*) target + i,
+                vcombine_u8(vmovn_u16(low), vmovn_u16(high)));
+    }
+#endif
+
+    for (; i < numChars && source[i] < 0x80; i++)
+        target[i] = (char) source[i];
+    return i;
+}
+
+
+//-----------------------------------------------------------------------------
+// dpiTranscode__widenAscii() [INTERNAL]
+//   Convert single byte characters to UTF-16 characters for as long as they
+// are ASCII characters. The number of characters converted is returned; if
+// this is less than the number of characters supplied, the next character is
+// not an ASCII character.
+//-----------------------------------------------------------------------------
+uint32_t dpiTranscode__widenAscii(const char *source, uint32_t numChars,
+        uint16_t *target)
+{
+    const uint8_t *bytes = (const uint8_t*) source;
+    uint32_t i = 0;
+#if defined(DPI_TRANSCODE_SSE2)
+    __m128i chunk, zero;
+
+    zero = _mm_setzero_si128();
+    for (; i + 16 <= numChars; i += 16) {
+        chunk = _mm_loadu_si128((const __m128i*) (bytes + i));
+        if (_mm_movemask_epi8(chunk) != 0)
+            break;
+        _mm_storeu_si128((__m128i*) (target + i),
+                _mm_unpacklo_epi8(chunk, zero));
+        _mm_storeu_si128((__m128i*) (target + i + 8),
+                _mm_unpackhi_epi8(chunk, zero));
+    }
+#elif defined(DPI_TRANSCODE_NEON)
+    uint8x16_t chunk;
+
+    for (; i + 16 <= numChars; i += 16) {
+        chunk = vld1q_u8(bytes + i);
+        if (vmaxvq_u8(chunk) >= 0x80)
+            break;
+        vst1q_u16(target + i, vmovl_u8(vget_low_u8(chunk)));
+        vst1q_u16(target + i + 8, vmovl_u8(vget_high_u8(chunk)));
+    }
+#endif
+
+    for (; i < numChars && bytes[i] < 0x80; i++)
+        target[i] = bytes[i];
+    return i;
+}
+
@@ -14,8 +14,119 @@
 //   Utility methods that aren't specific to a particular type.
 //-----------------------------------------------------------------------------
 
+#ifdef _WIN32
+#include <windows.h>
+#else
+#include <time.h>
+#include <sys/mman.h>
+#endif
+#ifdef __linux__
+#include <unistd.h>
+#include <sys/syscall.h>
+#endif
 #include "dpiImpl.h"
 
+// forward declarations of internal functions only used in this file
+static void dpiUtils__bindToLocalNode(void *ptr, size_t length);
+
+
+//-----------------------------------------------------------------------------
+// dpiUtils__allocateBuffer() [INTERNAL]
+//   Allocate a buffer of the specified length. If huge pages are requested
+// and the buffer is at least as large as a huge page, the buffer is mapped
+// directly from the operating system, first using explicit huge pages and
+// then, if none are available, using anonymous memory with a transparent huge
+// page hint. If NUMA local placement is requested and the buffer is at least
+// as large as a base page, the buffer is mapped (if it was not already) and
+// its pages are bound to the NUMA node of the calling thread. Otherwise, or
+// if mapping fails, malloc() is used. The mapped length is returned so that
+// the buffer can be freed correctly; it is zero when malloc() was used. If
+// pre-faulting is requested, each page is touched so that page faults occur
+// now instead of during the first fetch.
+//-----------------------------------------------------------------------------
+int dpiUtils__allocateBuffer(size_t length, dpiBufferMode mode, void **ptr,
+        size_t *mappedLength, dpiError *error)
+{
+    size_t i;
+
+    *ptr = NULL;
+    *mappedLength = 0;
+#ifndef _WIN32
+    if ((mode & DPI_MODE_BUFFER_HUGE_PAGES) && length >= DPI_HUGE_PAGE_SIZE) {
+        *mappedLength = (length + DPI_HUGE_PAGE_SIZE - 1) &
+                ~((size_t) DPI_HUGE_PAGE_SIZE - 1);
+#ifdef MAP_HUGETLB
+        *ptr = mmap(NULL, *mappedLength, PROT_READ | PROT_WRITE,
+                MAP_PRIVATE | MAP_ANONYMOUS | MAP_HUGETLB, -1, 0);
+        if (*ptr == MAP_FAILED)
+            *ptr = NULL;
+#endif
+        if (!*ptr) {
+            *ptr = mmap(NULL, *mappedLength, PROT_READ | PROT_WRITE,
+                    MAP_PRIVATE | MAP_ANONYMOUS, -1, 0);
+            if (*ptr == MAP_FAILED)
+                *ptr = NULL;
+#ifdef MADV_HUGEPAGE
+            else madvise(*ptr, *mappedLength, MADV_HUGEPAGE);
+#endif
+        }
+        if (!*ptr)
+            *mappedLength = 0;
+    }
+    if ((mode & DPI_MODE_BUFFER_NUMA_LOCAL) && length >= DPI_BASE_PAGE_SIZE) {
+        if (!*ptr) {
+            *mappedLength = (length + DPI_BASE_PAGE_SIZE - 1) &
+                    ~((size_t) DPI_BASE_PAGE_SIZE - 1);
+            *ptr = mmap(NULL, *mappedLength, PROT_READ | PROT_WRITE,
+                    MAP_PRIVATE | MAP_ANONYMOUS, -1, 0);
+            if (*ptr == MAP_FAILED) {
+                *ptr = NULL;
+                *mappedLength = 0;
+            }
+        }
+        if (*ptr)
+            dpiUtils__bindToLocalNode(*ptr, *mappedLength);
+    }
+#endif
+    if (!*ptr) {
+        *ptr = malloc(length);
+        if (!*ptr)
+            return dpiError__set(error, "allocate buffer", DPI_ERR_NO_MEMORY);
+    }
+    if (mode & DPI_MODE_BUFFER_PREFAULT) {
+        for (i = 0; i < length; i += DPI_BASE_PAGE_SIZE)
+            ((volatile char*) *ptr)[i] = 0;
+    }
+    return DPI_SUCCESS;
+}
+
+
+//-----------------------------------------------------------------------------
+// dpiUtils__bindToLocalNode() [INTERNAL]
+//   Bind the pages of a mapped buffer to the NUMA node of the CPU on which the
+// calling thread is running, so that they are allocated there when first
+// touched no matter which thread touches them. This is only a preference:
+// if the node has no free memory, pages are allocated elsewhere. Failures
+// (such as on platforms without NUMA support) are ignored.
+//-----------------------------------------------------------------------------
+static void dpiUtils__bindToLocalNode(void *ptr, size_t length)
+{
+#ifdef __linux__
+    unsigned long nodeMask[DPI_MAX_NUMA_NODES / (8 * sizeof(unsigned long))];
+    unsigned cpu, node;
+
+    if (syscall(SYS_getcpu, &cpu, &node, NULL) < 0 ||
+            node >= DPI_MAX_NUMA_NODES)
+        return;
+    memset(nodeMask, 0, sizeof(nodeMask));
+    nodeMask[node / (8 * sizeof(unsigned long))] =
+            1UL << (node % (8 * sizeof(unsigned long)));
+    syscall(SYS_mbind, ptr, length, DPI_MPOL_PREFERRED, nodeMask,
+            DPI_MAX_NUMA_NODES + 1, 0);
+#endif
+}
+
+
 //-----------------------------------------------------------------------------
 // dpiUtils__clearMemory() [INTERNAL]
 //   Method for clearing memory that will not be optimised away by the
@@ -32,6 +143,41 @@ void dpiUtils__clearMemory(void *ptr, size_t length)
 }
 
 
+//-----------------------------------------------------------------------------
+// dpiUtils__freeBuffer() [INTERNAL]
+//   Free a buffer allocated by dpiUtils__allocateBuffer().
+//-----------------------------------------------------------------------------
+void dpiUtils__freeBuffer(void *ptr, size_t mappedLength)
+{
+#ifndef _WIN32
+    if (mappedLength > 0) {
+        munmap(ptr, mappedLength);
+        return;
+    }
+#endif
+    free(ptr);
+}
+
+
+//-----------------------------------------------------------------------------
+// dpiUtils__getBufferNode() [INTERNAL]
+//   Return the NUMA node on which the page containing the given address
+// resides, or -1 if this cannot be determined. If the page has not been
+// touched yet, it is allocated by this call.
+//-----------------------------------------------------------------------------
+int32_t dpiUtils__getBufferNode(const void *ptr)
+{
+#ifdef __linux__
+    int node;
+
+    if (ptr && syscall(SYS_get_mempolicy, &node, NULL, 0, ptr,
+            DPI_MPOL_F_NODE | DPI_MPOL_F_ADDR) == 0)
+        return node;
+#endif
+    return -1;
+}
+
+
 //-----------------------------------------------------------------------------
 // dpiUtils__getAttrStringWithDup() [INTERNAL]
 //   Get the string attribute from the OCI and duplicate its contents.
@@ -53,6 +199,51 @@ int dpiUtils__getAttrStringWithDup(const char *action, const void *ociHandle,
 }
 
 
+//-----------------------------------------------------------------------------
+// dpiUtils__getMicroseconds() [INTERNAL]
+//   Return the number of microseconds elapsed since an arbitrary fixed point
+// in the past. As with dpiUtils__getMilliseconds(), a monotonic clock is used
+// and the values returned are only useful for measuring elapsed time.
+//-----------------------------------------------------------------------------
+uint64_t dpiUtils__getMicroseconds(void)
+{
+#ifdef _WIN32
+    LARGE_INTEGER counter, frequency;
+
+    QueryPerformanceFrequency(&frequency);
+    QueryPerformanceCounter(&counter);
+    return (uint64_t) (counter.QuadPart / frequency.QuadPart) * 1000000 +
+            (uint64_t) (counter.QuadPart % frequency.QuadPart) * 1000000 /
+            frequency.QuadPart;
+#else
+    struct timespec ts;
+
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return (uint64_t) ts.tv_sec * 1000000 + (uint64_t) ts.tv_nsec / 1000;
+#endif
+}
+
+
+//-----------------------------------------------------------------------------
+// dpiUtils__getMilliseconds() [INTERNAL]
+//   Return the number of milliseconds elapsed since an arbitrary fixed point
+// in the past. A monotonic clock is used so that the values returned are not
+// affected by changes to the system time; they are only useful for measuring
+// elapsed time.
+//-----------------------------------------------------------------------------
+uint64_t dpiUtils__getMilliseconds(void)
+{
+#ifdef _WIN32
+    return GetTickCount64();
+#else
+    struct timespec ts;
+
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return (uint64_t) ts.tv_sec * 1000 + (uint64_t) ts.tv_nsec / 1000000;
+#endif
+}
+
+
 //-----------------------------------------------------------------------------
 // dpiUtils__parseNumberString() [INTERNAL]
 //   Parse the contents of a string that is supposed to contain a number. The
@@ -81,7 +272,6 @@ int dpiUtils__parseNumberString(const char *value, uint32_t valueLength,
     int exponentIsNegative, exponent;
     uint8_t numExponentDigits, digit;
     uint32_t convertedValueLength;
-    uint16_t *utf16chars, i;
     const char *endValue;
 
     // empty strings are not valid numbers
@@ -102,15 +292,11 @@ int dpiUtils__parseNumberString(const char *value, uint32_t valueLength,
     // obviously not part of a valid numeric string
     // also verify maximum length of number
     if (charsetId == DPI_CHARSET_ID_UTF16) {
-        utf16chars = (uint16_t*) value;
-        convertedValue[0] = '\0';
         convertedValueLength = valueLength / 2;
-        for (i = 0; i < convertedValueLength; i++) {
-            if (*utf16chars > 127)
-                return dpiError__set(error, "convert from UTF-16",
-                        DPI_ERR_INVALID_NUMBER);
-            convertedValue[i] = (char) *utf16chars++;
-        }
+        if (dpiTranscode__narrowAscii((const uint16_t*) value,
+                convertedValueLength, convertedValue) != convertedValueLength)
+            return dpiError__set(error, "convert from UTF-16",
+                    DPI_ERR_INVALID_NUMBER);
         value = convertedValue;
         valueLength = convertedValueLength;
     }
@@ -326,3 +512,20 @@ int dpiUtils__setAttributesFromCommonCreateParams(void *handle,
     return DPI_SUCCESS;
 }
 
+
+//-----------------------------------------------------------------------------
+// dpiUtils__sleep() [INTERNAL]
+//   Sleep for the specified number of milliseconds.
+//-----------------------------------------------------------------------------
+void dpiUtils__sleep(uint32_t milliseconds)
+{
+#ifdef _WIN32
+    Sleep(milliseconds);
+#else
+    struct timespec ts;
+
+    ts.tv_sec = milliseconds / 1000;
+    ts.tv_nsec = (long) (milliseconds % 1000) * 1000000;
+    nanosleep(&ts, NULL);
+#endif
+}
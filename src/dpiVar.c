@@ -17,7 +17,12 @@
 #include "dpiImpl.h"
 
 // forward declarations of internal functions only used in this file
+static int dpiVar__copyRange(dpiVar *var, uint32_t pos, dpiVar *sourceVar,
+        uint32_t sourcePos, uint32_t numElements, dpiError *error);
 static int dpiVar__initBuffers(dpiVar *var, dpiError *error);
+static void dpiVar__permuteArray(void *array, size_t elementSize,
+        const uint32_t *permutation, uint32_t numRows, char *element,
+        uint8_t *moved);
 static int dpiVar__setBytesFromDynamicBytes(dpiVar *var, dpiBytes *bytes,
         dpiDynamicBytes *dynBytes, dpiError *error);
 static int dpiVar__setBytesFromLob(dpiVar *var, dpiBytes *bytes,
@@ -152,9 +157,9 @@ static int dpiVar__allocateBuffers(dpiVar *var, dpiError *error)
         if (dataLength > INT_MAX)
             return dpiError__set(error, "check max array size",
                     DPI_ERR_ARRAY_SIZE_TOO_BIG, var->maxArraySize);
-        var->data.asRaw = malloc((size_t) dataLength);
-        if (!var->data.asRaw)
-            return dpiError__set(error, "allocate buffer", DPI_ERR_NO_MEMORY);
+        if (dpiUtils__allocateBuffer((size_t) dataLength, var->env->bufferMode,
+                &var->data.asRaw, &var->dataMappedLength, error) < 0)
+            return DPI_FAILURE;
     }
 
     // allocate the indicator for the variable
@@ -342,6 +347,32 @@ static int dpiVar__checkArraySize(dpiVar *var, uint32_t pos,
 }
 
 
+//-----------------------------------------------------------------------------
+// dpiVar__checkBytesLength() [INTERNAL]
+//   Verifies that a byte string of the given length can be stored in the
+// variable. Numbers represented as bytes are limited by the size of the
+// buffer used to convert them and other byte strings are limited by the size
+// of the variable, unless its buffers are allocated dynamically.
+//-----------------------------------------------------------------------------
+static int dpiVar__checkBytesLength(dpiVar *var, uint32_t valueLength,
+        dpiError *error)
+{
+    uint32_t maxLength;
+
+    if (var->tempBuffer) {
+        maxLength = DPI_NUMBER_AS_TEXT_CHARS;
+        if (var->env->charsetId == DPI_CHARSET_ID_UTF16)
+            maxLength *= 2;
+    } else if (!var->dynamicBytes) {
+        maxLength = var->sizeInBytes;
+    } else return DPI_SUCCESS;
+    if (valueLength > maxLength)
+        return dpiError__set(error, "check source length",
+                DPI_ERR_BUFFER_SIZE_TOO_SMALL, maxLength);
+    return DPI_SUCCESS;
+}
+
+
 //-----------------------------------------------------------------------------
 // dpiVar__convertToLob() [INTERNAL]
 //   Convert the variable from using dynamic bytes for a long string to using a
@@ -386,6 +417,49 @@ int dpiVar__convertToLob(dpiVar *var, dpiError *error)
 }
 
 
+//-----------------------------------------------------------------------------
+// dpiVar__copyBytes() [INTERNAL]
+//   Copy the byte string into the buffers of the variable at the given array
+// position, which is not null and whose length has already been verified.
+// For dynamic bytes, a single chunk of the required size is reserved. The
+// byte string may be another element of the same variable.
+//-----------------------------------------------------------------------------
+static int dpiVar__copyBytes(dpiVar *var, uint32_t pos, const char *value,
+        uint32_t valueLength, dpiError *error)
+{
+    dpiDynamicBytes *dynBytes;
+    dpiBytes *bytes;
+
+    // for dynamic bytes, allocate space as needed
+    bytes = &var->externalData[pos].value.asBytes;
+    if (var->dynamicBytes) {
+        dynBytes = &var->dynamicBytes[pos];
+        if (dpiVar__allocateDynamicBytes(dynBytes, valueLength, error) < 0)
+            return DPI_FAILURE;
+        memmove(dynBytes->chunks->ptr, value, valueLength);
+        dynBytes->numChunks = 1;
+        dynBytes->chunks->length = valueLength;
+        bytes->ptr = dynBytes->chunks->ptr;
+
+    // for everything else, space has already been allocated
+    } else {
+        if (valueLength > 0)
+            memmove(bytes->ptr, value, valueLength);
+        if (var->type->sizeInBytes == 0) {
+            if (var->actualLength32)
+                var->actualLength32[pos] = valueLength;
+            else if (var->actualLength16)
+                var->actualLength16[pos] = (uint16_t) valueLength;
+        }
+        if (var->returnCode)
+            var->returnCode[pos] = 0;
+    }
+    bytes->length = valueLength;
+
+    return DPI_SUCCESS;
+}
+
+
 //-----------------------------------------------------------------------------
 // dpiVar__copyData() [INTERNAL]
 //   Copy the data from the source to the target variable at the given array
@@ -427,6 +501,82 @@ int dpiVar__copyData(dpiVar *var, uint32_t pos, dpiData *sourceData,
 }
 
 
+//-----------------------------------------------------------------------------
+// dpiVar__copyRange() [INTERNAL]
+//   Copy the data from a range of elements in the source variable to the same
+// number of elements in the target variable. Values that are held entirely in
+// the dpiData structures are moved as a single block. Byte strings are first
+// verified to fit, so that either all of them are copied or none of them are,
+// and are then copied directly into the buffers of the target variable,
+// reserving a single chunk of the required size for each dynamic element.
+// Values that refer to other handles are copied one element at a time so that
+// references are managed correctly.
+//-----------------------------------------------------------------------------
+static int dpiVar__copyRange(dpiVar *var, uint32_t pos, dpiVar *sourceVar,
+        uint32_t sourcePos, uint32_t numElements, dpiError *error)
+{
+    dpiData *sourceData, *targetData;
+    uint32_t i, offset;
+    int reverse;
+
+    // values contained entirely in the dpiData structures
+    switch (var->nativeTypeNum) {
+        case DPI_NATIVE_TYPE_BYTES:
+        case DPI_NATIVE_TYPE_LOB:
+        case DPI_NATIVE_TYPE_OBJECT:
+        case DPI_NATIVE_TYPE_STMT:
+        case DPI_NATIVE_TYPE_ROWID:
+            break;
+        default:
+            memmove(&var->externalData[pos],
+                    &sourceVar->externalData[sourcePos],
+                    numElements * sizeof(dpiData));
+            return DPI_SUCCESS;
+    }
+
+    // when copying within the same variable to a later position, copy from
+    // the end of the range so that no element is overwritten before it has
+    // been copied
+    reverse = (var == sourceVar && pos > sourcePos);
+
+    // values that refer to other handles and byte strings that are written to
+    // LOBs internally are copied one element at a time
+    if (var->nativeTypeNum != DPI_NATIVE_TYPE_BYTES || var->references) {
+        for (i = 0; i < numElements; i++) {
+            offset = (reverse) ? numElements - i - 1 : i;
+            if (dpiVar__copyData(var, pos + offset,
+                    &sourceVar->externalData[sourcePos + offset], error) < 0)
+                return DPI_FAILURE;
+        }
+        return DPI_SUCCESS;
+    }
+
+    // verify that all of the byte strings fit in the target variable
+    for (i = 0; i < numElements; i++) {
+        sourceData = &sourceVar->externalData[sourcePos + i];
+        if (!sourceData->isNull && dpiVar__checkBytesLength(var,
+                sourceData->value.asBytes.length, error) < 0)
+            return DPI_FAILURE;
+    }
+
+    // copy the byte strings
+    for (i = 0; i < numElements; i++) {
+        offset = (reverse) ? numElements - i - 1 : i;
+        sourceData = &sourceVar->externalData[sourcePos + offset];
+        targetData = &var->externalData[pos + offset];
+        targetData->isNull = sourceData->isNull;
+        if (sourceData->isNull)
+            continue;
+        if (dpiVar__copyBytes(var, pos + offset,
+                sourceData->value.asBytes.ptr,
+                sourceData->value.asBytes.length, error) < 0)
+            return DPI_FAILURE;
+    }
+
+    return DPI_SUCCESS;
+}
+
+
 //-----------------------------------------------------------------------------
 // dpiVar__defineCallback() [INTERNAL]
 //   Callback which runs during OCI statement execution and allocates the
@@ -720,8 +870,9 @@ static void dpiVar__finalizeBuffers(dpiVar *var, dpiError *error)
         var->externalData = NULL;
     }
     if (var->data.asRaw) {
-        free(var->data.asRaw);
+        dpiUtils__freeBuffer(var->data.asRaw, var->dataMappedLength);
         var->data.asRaw = NULL;
+        var->dataMappedLength = 0;
     }
     if (var->objectIndicator) {
         free(var->objectIndicator);
@@ -731,6 +882,11 @@ static void dpiVar__finalizeBuffers(dpiVar *var, dpiError *error)
         free(var->tempBuffer);
         var->tempBuffer = NULL;
     }
+    if (var->transcodeBuffer) {
+        free(var->transcodeBuffer);
+        var->transcodeBuffer = NULL;
+        var->transcodeBufferSize = 0;
+    }
 }
 
 
@@ -753,6 +909,54 @@ void dpiVar__free(dpiVar *var, dpiError *error)
 }
 
 
+//-----------------------------------------------------------------------------
+// dpiVar__getMemoryUsage() [INTERNAL]
+//   Return the number of bytes of memory allocated for the buffers of the
+// variable. Memory allocated by OCI or referenced by other handles is not
+// included.
+//-----------------------------------------------------------------------------
+uint64_t dpiVar__getMemoryUsage(dpiVar *var)
+{
+    dpiDynamicBytes *dynBytes;
+    uint64_t usage = 0;
+    uint32_t i, j;
+
+    if (var->data.asRaw)
+        usage += (uint64_t) var->maxArraySize * var->sizeInBytes;
+    if (var->indicator)
+        usage += var->maxArraySize * sizeof(int16_t);
+    if (var->returnCode)
+        usage += var->maxArraySize * sizeof(uint16_t);
+    if (var->actualLength16)
+        usage += var->maxArraySize * sizeof(uint16_t);
+    if (var->actualLength32)
+        usage += var->maxArraySize * sizeof(uint32_t);
+    if (var->externalData)
+        usage += var->maxArraySize * sizeof(dpiData);
+    if (var->objectIndicator)
+        usage += var->maxArraySize * sizeof(void*);
+    if (var->references)
+        usage += var->maxArraySize * sizeof(dpiReferenceBuffer);
+    if (var->tempBuffer)
+        usage += var->maxArraySize * DPI_NUMBER_AS_TEXT_CHARS *
+                ((var->env->charsetId == DPI_CHARSET_ID_UTF16) ? 2 : 1);
+    usage += var->transcodeBufferSize;
+    if (var->dynamicBytes) {
+        usage += var->maxArraySize * sizeof(dpiDynamicBytes);
+        for (i = 0; i < var->maxArraySize; i++) {
+            dynBytes = &var->dynamicBytes[i];
+            usage += dynBytes->allocatedChunks * sizeof(dpiDynamicBytesChunk);
+            for (j = 0; j < dynBytes->allocatedChunks; j++) {
+                if (dynBytes->chunks[j].ptr)
+                    usage += dynBytes->chunks[j].allocatedLength;
+            }
+        }
+    }
+
+    return usage;
+}
+
+
 //-----------------------------------------------------------------------------
 // dpiVar__getValue() [PRIVATE]
 //   Returns the contents of the variable in the type specified, if possible.
@@ -1002,6 +1206,153 @@ int32_t dpiVar__outBindCallback(dpiVar *var, void *bindp, uint32_t iter,
 }
 
 
+//-----------------------------------------------------------------------------
+// dpiVar__permute() [INTERNAL]
+//   Reorder the first rows of the variable in place so that row i becomes the
+// row previously found at position permutation[i]. All of the arrays
+// associated with the variable are reordered together, after which the
+// pointers to the buffers of byte strings, which depend on the position, are
+// reset.
+//-----------------------------------------------------------------------------
+int dpiVar__permute(dpiVar *var, const uint32_t *permutation,
+        uint32_t numRows, dpiError *error)
+{
+    size_t tempBufferSize = 0, elementSize;
+    uint8_t *moved;
+    char *element;
+
+    // determine the size of the largest element which needs to be moved
+    elementSize = sizeof(dpiData);
+    if (var->sizeInBytes > elementSize)
+        elementSize = var->sizeInBytes;
+    if (var->tempBuffer) {
+        tempBufferSize = DPI_NUMBER_AS_TEXT_CHARS;
+        if (var->env->charsetId == DPI_CHARSET_ID_UTF16)
+            tempBufferSize *= 2;
+        if (tempBufferSize > elementSize)
+            elementSize = tempBufferSize;
+    }
+
+    // allocate memory for a single element and for tracking the rows moved
+    element = malloc(elementSize);
+    moved = malloc(numRows);
+    if (!element || !moved) {
+        if (element)
+            free(element);
+        if (moved)
+            free(moved);
+        return dpiError__set(error, "allocate permutation buffers",
+                DPI_ERR_NO_MEMORY);
+    }
+
+    // reorder each of the arrays
+    dpiVar__permuteArray(var->externalData, sizeof(dpiData), permutation,
+            numRows, element, moved);
+    dpiVar__permuteArray(var->indicator, sizeof(int16_t), permutation,
+            numRows, element, moved);
+    if (var->data.asRaw && var->sizeInBytes > 0)
+        dpiVar__permuteArray(var->data.asRaw, var->sizeInBytes, permutation,
+                numRows, element, moved);
+    if (var->actualLength16)
+        dpiVar__permuteArray(var->actualLength16, sizeof(uint16_t),
+                permutation, numRows, element, moved);
+    if (var->actualLength32)
+        dpiVar__permuteArray(var->actualLength32, sizeof(uint32_t),
+                permutation, numRows, element, moved);
+    if (var->returnCode)
+        dpiVar__permuteArray(var->returnCode, sizeof(uint16_t), permutation,
+                numRows, element, moved);
+    if (var->objectIndicator)
+        dpiVar__permuteArray(var->objectIndicator, sizeof(void*),
+                permutation, numRows, element, moved);
+    if (var->references)
+        dpiVar__permuteArray(var->references, sizeof(dpiReferenceBuffer),
+                permutation, numRows, element, moved);
+    if (var->dynamicBytes)
+        dpiVar__permuteArray(var->dynamicBytes, sizeof(dpiDynamicBytes),
+                permutation, numRows, element, moved);
+    if (var->tempBuffer)
+        dpiVar__permuteArray(var->tempBuffer, tempBufferSize, permutation,
+                numRows, element, moved);
+    free(element);
+    free(moved);
+
+    // reset pointers for byte strings which refer to the buffers by position
+    dpiVar__resetBytes(var, numRows);
+
+    return DPI_SUCCESS;
+}
+
+
+//-----------------------------------------------------------------------------
+// dpiVar__permuteArray() [INTERNAL]
+//   Reorder the first elements of the array in place by following each cycle
+// of the permutation, so that only a single element needs to be held in
+// temporary storage.
+//-----------------------------------------------------------------------------
+static void dpiVar__permuteArray(void *array, size_t elementSize,
+        const uint32_t *permutation, uint32_t numRows, char *element,
+        uint8_t *moved)
+{
+    uint32_t start, pos, nextPos;
+    char *ptr = (char*) array;
+
+    memset(moved, 0, numRows);
+    for (start = 0; start < numRows; start++) {
+        if (moved[start] || permutation[start] == start)
+            continue;
+        memcpy(element, ptr + start * elementSize, elementSize);
+        pos = start;
+        while (1) {
+            moved[pos] = 1;
+            nextPos = permutation[pos];
+            if (nextPos == start) {
+                memcpy(ptr + pos * elementSize, element, elementSize);
+                break;
+            }
+            memcpy(ptr + pos * elementSize, ptr + nextPos * elementSize,
+                    elementSize);
+            pos = nextPos;
+        }
+    }
+}
+
+
+//-----------------------------------------------------------------------------
+// dpiVar__resetBytes() [INTERNAL]
+//   Reset the pointers and encodings of the byte strings found in the first
+// rows of the variable so that they refer to the buffers used for fetching
+// and binding once again. This is needed after the rows have been reordered
+// or transcoded. Dynamic byte strings are set when their values are
+// retrieved so their pointers are left untouched.
+//-----------------------------------------------------------------------------
+void dpiVar__resetBytes(dpiVar *var, uint32_t numRows)
+{
+    uint32_t i, tempBufferSize;
+    const char *encoding;
+    dpiBytes *bytes;
+
+    if (var->nativeTypeNum != DPI_NATIVE_TYPE_BYTES)
+        return;
+    tempBufferSize = DPI_NUMBER_AS_TEXT_CHARS;
+    if (var->env->charsetId == DPI_CHARSET_ID_UTF16)
+        tempBufferSize *= 2;
+    if (var->type->charsetForm == DPI_SQLCS_IMPLICIT)
+        encoding = var->env->encoding;
+    else encoding = var->env->nencoding;
+    for (i = 0; i < numRows; i++) {
+        bytes = &var->externalData[i].value.asBytes;
+        bytes->encoding = encoding;
+        if (var->dynamicBytes)
+            continue;
+        if (var->tempBuffer)
+            bytes->ptr = var->tempBuffer + i * tempBufferSize;
+        else if (!var->isDynamic)
+            bytes->ptr = var->data.asBytes + i * var->sizeInBytes;
+    }
+}
+
+
 //-----------------------------------------------------------------------------
 // dpiVar__setBytesFromDynamicBytes() [PRIVATE]
 //   Set the pointer and length in the dpiBytes structure to the values
@@ -1100,57 +1451,20 @@ static int dpiVar__setBytesFromLob(dpiVar *var, dpiBytes *bytes,
 static int dpiVar__setFromBytes(dpiVar *var, uint32_t pos, const char *value,
         uint32_t valueLength, dpiError *error)
 {
-    dpiDynamicBytes *dynBytes;
-    dpiBytes *bytes;
-    dpiData *data;
-
     // validate the target can accept the input
-    if ((var->tempBuffer && var->env->charsetId == DPI_CHARSET_ID_UTF16 &&
-                    valueLength > DPI_NUMBER_AS_TEXT_CHARS * 2) ||
-            (var->tempBuffer && var->env->charsetId != DPI_CHARSET_ID_UTF16 &&
-                    valueLength > DPI_NUMBER_AS_TEXT_CHARS) ||
-            (!var->dynamicBytes && !var->tempBuffer &&
-                    valueLength > var->sizeInBytes))
-        return dpiError__set(error, "check source length",
-                DPI_ERR_BUFFER_SIZE_TOO_SMALL, var->sizeInBytes);
+    if (dpiVar__checkBytesLength(var, valueLength, error) < 0)
+        return DPI_FAILURE;
 
     // mark the value as not null
-    data = &var->externalData[pos];
-    data->isNull = 0;
+    var->externalData[pos].isNull = 0;
 
     // for internally used LOBs, write the data directly
     if (var->references)
         return dpiLob__setFromBytes(var->references[pos].asLOB, value,
                 valueLength, error);
 
-    // for dynamic bytes, allocate space as needed
-    bytes = &data->value.asBytes;
-    if (var->dynamicBytes) {
-        dynBytes = &var->dynamicBytes[pos];
-        if (dpiVar__allocateDynamicBytes(dynBytes, valueLength, error) < 0)
-            return DPI_FAILURE;
-        memcpy(dynBytes->chunks->ptr, value, valueLength);
-        dynBytes->numChunks = 1;
-        dynBytes->chunks->length = valueLength;
-        bytes->ptr = dynBytes->chunks->ptr;
-        bytes->length = valueLength;
-
-    // for everything else, space has already been allocated
-    } else {
-        bytes->length = valueLength;
-        if (valueLength > 0)
-            memcpy(bytes->ptr, value, valueLength);
-        if (var->type->sizeInBytes == 0) {
-            if (var->actualLength32)
-                var->actualLength32[pos] = valueLength;
-            else if (var->actualLength16)
-                var->actualLength16[pos] = (uint16_t) valueLength;
-        }
-        if (var->returnCode)
-            var->returnCode[pos] = 0;
-    }
-
-    return DPI_SUCCESS;
+    // for everything else, copy the data into the buffers of the variable
+    return dpiVar__copyBytes(var, pos, value, valueLength, error);
 }
 
 
@@ -1182,8 +1496,12 @@ static int dpiVar__setFromLob(dpiVar *var, uint32_t pos, dpiLob *lob,
         var->references[pos].asLOB = NULL;
     }
 
-    // add reference to passed object
-    dpiGen__setRefCount(lob, error, 1);
+    // add reference to passed object; LOBs borrowed from an object are
+    // promoted first as the object may repoint them at any time
+    if (dpiLob__promote(lob, error) < 0)
+        return DPI_FAILURE;
+    if (dpiGen__setRefCount(lob, error, 1) < 0)
+        return DPI_FAILURE;
     var->references[pos].asLOB = lob;
     var->data.asLobLocator[pos] = lob->locator;
     data->value.asLOB = lob;
@@ -1414,6 +1732,55 @@ int dpiVar__setValue(dpiVar *var, uint32_t pos, dpiData *data,
 }
 
 
+//-----------------------------------------------------------------------------
+// dpiVar__trimMemory() [INTERNAL]
+//   Release the chunks used for dynamic bytes that are not currently holding
+// any data, starting with the last element of the array, until no more than
+// the low-water mark of such memory remains. Chunks holding data are never
+// released so any values previously fetched or set remain valid. The number
+// of bytes released is added to the supplied total.
+//-----------------------------------------------------------------------------
+void dpiVar__trimMemory(dpiVar *var, uint64_t lowWaterMark,
+        uint64_t *bytesReclaimed)
+{
+    dpiDynamicBytesChunk *chunk;
+    dpiDynamicBytes *dynBytes;
+    uint64_t spareBytes = 0;
+    uint32_t i, j;
+
+    // only dynamic bytes grow beyond the size fixed when the variable was
+    // created
+    if (!var->dynamicBytes)
+        return;
+
+    // determine the amount of memory held in chunks not holding data
+    for (i = 0; i < var->maxArraySize; i++) {
+        dynBytes = &var->dynamicBytes[i];
+        for (j = dynBytes->numChunks; j < dynBytes->allocatedChunks; j++) {
+            if (dynBytes->chunks[j].ptr)
+                spareBytes += dynBytes->chunks[j].allocatedLength;
+        }
+    }
+
+    // release spare chunks until the low-water mark is reached
+    for (i = var->maxArraySize; i > 0 && spareBytes > lowWaterMark; i--) {
+        dynBytes = &var->dynamicBytes[i - 1];
+        for (j = dynBytes->allocatedChunks;
+                j > dynBytes->numChunks && spareBytes > lowWaterMark; j--) {
+            chunk = &dynBytes->chunks[j - 1];
+            if (!chunk->ptr)
+                continue;
+            free(chunk->ptr);
+            chunk->ptr = NULL;
+            spareBytes -= chunk->allocatedLength;
+            *bytesReclaimed += chunk->allocatedLength;
+            chunk->allocatedLength = 0;
+            chunk->length = 0;
+        }
+    }
+}
+
+
 //-----------------------------------------------------------------------------
 // dpiVar__validateTypes() [PRIVATE]
 //   Validate that the Oracle type and the native type are compatible with
@@ -1483,6 +1850,60 @@ int dpiVar_copyData(dpiVar *var, uint32_t pos, dpiVar *sourceVar,
 }
 
 
+//-----------------------------------------------------------------------------
+// dpiVar_copyRange() [PUBLIC]
+//   Copy the data from a range of elements in the source variable to the same
+// number of elements in the target variable, starting at the given array
+// positions. The same restrictions apply as for dpiVar_copyData().
+//-----------------------------------------------------------------------------
+int dpiVar_copyRange(dpiVar *var, uint32_t pos, dpiVar *sourceVar,
+        uint32_t sourcePos, uint32_t numElements)
+{
+    dpiError error;
+
+    if (dpiGen__startPublicFn(var, DPI_HTYPE_VAR, __func__, &error) < 0)
+        return DPI_FAILURE;
+    if (dpiGen__checkHandle(sourceVar, DPI_HTYPE_VAR, "check source var",
+            &error) < 0)
+        return DPI_FAILURE;
+    if ((uint64_t) pos + numElements > var->maxArraySize)
+        return dpiError__set(&error, "check array size",
+                DPI_ERR_INVALID_ARRAY_POSITION,
+                (pos < var->maxArraySize) ? var->maxArraySize : pos,
+                var->maxArraySize);
+    if ((uint64_t) sourcePos + numElements > sourceVar->maxArraySize)
+        return dpiError__set(&error, "check source size",
+                DPI_ERR_INVALID_ARRAY_POSITION,
+                (sourcePos < sourceVar->maxArraySize) ?
+                        sourceVar->maxArraySize : sourcePos,
+                sourceVar->maxArraySize);
+    if (var->nativeTypeNum != sourceVar->nativeTypeNum)
+        return dpiError__set(&error, "check types match",
+                DPI_ERR_NOT_SUPPORTED);
+    if (numElements == 0 || (var == sourceVar && pos == sourcePos))
+        return DPI_SUCCESS;
+    return dpiVar__copyRange(var, pos, sourceVar, sourcePos, numElements,
+            &error);
+}
+
+
+//-----------------------------------------------------------------------------
+// dpiVar_getBufferNode() [PUBLIC]
+//   Return the NUMA node on which the buffer used for transferring data to and
+// from the database resides, or -1 if this cannot be determined.
+//-----------------------------------------------------------------------------
+int dpiVar_getBufferNode(dpiVar *var, int32_t *node)
+{
+    dpiError error;
+
+    if (dpiGen__startPublicFn(var, DPI_HTYPE_VAR, __func__, &error) < 0)
+        return DPI_FAILURE;
+    DPI_CHECK_PTR_NOT_NULL(node)
+    *node = dpiUtils__getBufferNode(var->data.asRaw);
+    return DPI_SUCCESS;
+}
+
+
 //-----------------------------------------------------------------------------
 // dpiVar_getData() [PUBLIC]
 //   Return a pointer to the array of dpiData structures allocated for the
@@ -1664,3 +2085,85 @@ int dpiVar_setNumElementsInArray(dpiVar *var, uint32_t numElements)
     return DPI_SUCCESS;
 }
 
+
+//-----------------------------------------------------------------------------
+// dpiVar_setOutputEncoding() [PUBLIC]
+//   Set the encoding in which byte strings fetched into the variable are
+// returned, if it differs from the encoding used by the connection. Only
+// UTF-8 and UTF-16 are supported; a NULL encoding removes the override.
+//-----------------------------------------------------------------------------
+int dpiVar_setOutputEncoding(dpiVar *var, const char *encoding)
+{
+    uint16_t outputCharsetId, sourceCharsetId;
+    dpiError error;
+
+    if (dpiGen__startPublicFn(var, DPI_HTYPE_VAR, __func__, &error) < 0)
+        return DPI_FAILURE;
+
+    // a NULL encoding removes any override
+    if (!encoding) {
+        var->outputCharsetId = 0;
+        return DPI_SUCCESS;
+    }
+
+    // only character data can be transcoded
+    if (var->nativeTypeNum != DPI_NATIVE_TYPE_BYTES)
+        return dpiError__set(&error, "check native type",
+                DPI_ERR_NOT_SUPPORTED);
+    switch (var->type->oracleTypeNum) {
+        case DPI_ORACLE_TYPE_RAW:
+        case DPI_ORACLE_TYPE_LONG_RAW:
+        case DPI_ORACLE_TYPE_BLOB:
+        case DPI_ORACLE_TYPE_BFILE:
+            return dpiError__set(&error, "check Oracle type",
+                    DPI_ERR_NOT_SUPPORTED);
+        default:
+            break;
+    }
+
+    // determine the output encoding
+    if (strcmp(encoding, DPI_CHARSET_NAME_UTF8) == 0)
+        outputCharsetId = DPI_CHARSET_ID_UTF8;
+    else if (strcmp(encoding, DPI_CHARSET_NAME_UTF16) == 0)
+        outputCharsetId = DPI_CHARSET_ID_UTF16;
+    else return dpiError__set(&error, "check encoding",
+            DPI_ERR_INVALID_CHARSET, encoding);
+
+    // the encoding of the data as fetched must be UTF-8 or UTF-16; ASCII is
+    // treated as UTF-8 since it is a subset
+    if (var->type->charsetForm == DPI_SQLCS_IMPLICIT)
+        sourceCharsetId = var->env->charsetId;
+    else sourceCharsetId = var->env->ncharsetId;
+    if (sourceCharsetId == DPI_CHARSET_ID_ASCII)
+        sourceCharsetId = DPI_CHARSET_ID_UTF8;
+    if (sourceCharsetId != DPI_CHARSET_ID_UTF8 &&
+            sourceCharsetId != DPI_CHARSET_ID_UTF16)
+        return dpiError__set(&error, "check source encoding",
+                DPI_ERR_NOT_SUPPORTED);
+
+    // no transcoding is needed if the encodings are identical
+    var->outputCharsetId =
+            (outputCharsetId == sourceCharsetId) ? 0 : outputCharsetId;
+    return DPI_SUCCESS;
+}
+
+
+//-----------------------------------------------------------------------------
+// dpiVar_trimMemory() [PUBLIC]
+//   Release memory cached by the variable for dynamic bytes that is not
+// currently holding data, retaining no more than the low-water mark, and
+// return the number of bytes released.
+//-----------------------------------------------------------------------------
+int dpiVar_trimMemory(dpiVar *var, uint64_t lowWaterMark,
+        uint64_t *bytesReclaimed)
+{
+    dpiError error;
+
+    if (dpiGen__startPublicFn(var, DPI_HTYPE_VAR, __func__, &error) < 0)
+        return DPI_FAILURE;
+    DPI_CHECK_PTR_NOT_NULL(bytesReclaimed)
+    *bytesReclaimed = 0;
+    dpiVar__trimMemory(var, lowWaterMark, bytesReclaimed);
+    return DPI_SUCCESS;
+}
+
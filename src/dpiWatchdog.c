@@ -0,0 +1,315 @@
+//-----------------------------------------------------------------------------
+// Copyright (c) 2017 Oracle and/or its affiliates.  All rights reserved.
+// This program is free software: you can modify it and/or redistribute it
+// under the terms of:
+//
+// (i)  the Universal Permissive License v 1.0 or at your option, any
+//      later version (http://oss.oracle.com/licenses/upl); and/or
+//
+// (ii) the Apache License v 2.0. (http://www.apache.org/licenses/LICENSE-2.0)
+//-----------------------------------------------------------------------------
+
+//-----------------------------------------------------------------------------
+// dpiWatchdog.c
+//   Implementation of the watchdog which interrupts calls that exceed their
+// timeout. Calls made with a timeout place an entry (owned by the caller) in a
+// hashed timer wheel before the call is made and remove it afterwards, both
+// in constant time. A single thread, started when the first such call is
+// made, advances the wheel once per tick and calls OCIBreak() on the
+// connection of each call whose deadline has passed. The thread exits once no
+// calls with a timeout have been in progress for DPI_WATCHDOG_IDLE_TICKS ticks
+// and is started again by the next such call.
+//-----------------------------------------------------------------------------
+
+#include "dpiImpl.h"
+
+// forward declarations of internal functions only used in this file
+static void dpiWatchdog__breakCalls(dpiWatchdogEntry *expired,
+        dpiError *error);
+static void dpiWatchdog__expireSlot(uint64_t tick, uint64_t now,
+        dpiWatchdogEntry **expired, dpiError *error);
+static void dpiWatchdog__run(void *arg);
+
+// state of the watchdog; all of it except the environment (which is set once
+// at initialization) is protected by the mutex of the environment
+static dpiEnv *dpiWatchdogEnv = NULL;
+static dpiWatchdogEntry *dpiWatchdogSlots[DPI_WATCHDOG_NUM_SLOTS];
+static uint64_t dpiWatchdogTick = 0;
+static uint32_t dpiWatchdogNumEntries = 0;
+static int dpiWatchdogStarted = 0;
+static void *dpiWatchdogThreadId = NULL;
+static void *dpiWatchdogThreadHandle = NULL;
+
+
+//-----------------------------------------------------------------------------
+// dpiWatchdog__addEntry() [INTERNAL]
+//   Add an entry to the timer wheel for a call about to be made on the given
+// connection, starting the watchdog thread if it is not already running. A
+// thread that previously exited is joined first. A timeout of zero means that
+// the call is never interrupted and no entry is added.
+//-----------------------------------------------------------------------------
+int dpiWatchdog__addEntry(dpiWatchdogEntry *entry, dpiConn *conn,
+        uint32_t timeout, dpiError *error)
+{
+    dpiWatchdogEntry **slot;
+    void *errorHandle;
+    uint64_t tick;
+
+    // a timeout of zero means no timeout
+    entry->conn = NULL;
+    if (timeout == 0)
+        return DPI_SUCCESS;
+
+    // the call is broken from another thread so the connection must have been
+    // created in threaded mode
+    if (!conn->env->threaded)
+        return dpiError__set(error, "check threaded mode",
+                DPI_ERR_NOT_SUPPORTED);
+
+    // populate entry
+    entry->timeout = timeout;
+    entry->startTime = dpiUtils__getMilliseconds();
+    entry->expireTime = entry->startTime + timeout;
+    entry->state = DPI_WATCHDOG_STATE_WAITING;
+    entry->prev = NULL;
+    entry->nextExpired = NULL;
+
+    // acquire the mutex and start the thread, if needed; the thread is given
+    // its own error handle which it frees when it exits
+    if (dpiOci__threadMutexAcquire(dpiWatchdogEnv, error) < 0)
+        return DPI_FAILURE;
+    if (!dpiWatchdogStarted) {
+        if (dpiWatchdogThreadHandle) {
+            if (dpiOci__threadJoin(dpiWatchdogEnv, dpiWatchdogThreadId,
+                    dpiWatchdogThreadHandle, error) < 0) {
+                dpiOci__threadMutexRelease(dpiWatchdogEnv, error);
+                return DPI_FAILURE;
+            }
+            dpiWatchdogThreadId = NULL;
+            dpiWatchdogThreadHandle = NULL;
+        }
+        if (dpiOci__handleAlloc(dpiWatchdogEnv, &errorHandle,
+                DPI_OCI_HTYPE_ERROR, "allocate watchdog error", error) < 0) {
+            dpiOci__threadMutexRelease(dpiWatchdogEnv, error);
+            return DPI_FAILURE;
+        }
+        dpiWatchdogTick = entry->startTime / DPI_WATCHDOG_TICK_MS;
+        if (dpiOci__threadCreate(dpiWatchdogEnv, dpiWatchdog__run,
+                errorHandle, &dpiWatchdogThreadId, &dpiWatchdogThreadHandle,
+                error) < 0) {
+            dpiOci__handleFree(errorHandle, DPI_OCI_HTYPE_ERROR);
+            dpiOci__threadMutexRelease(dpiWatchdogEnv, error);
+            return DPI_FAILURE;
+        }
+        dpiWatchdogStarted = 1;
+    }
+
+    // an entry whose deadline falls in a tick that has already been processed
+    // is placed in the slot of the next tick to be processed
+    tick = entry->expireTime / DPI_WATCHDOG_TICK_MS;
+    if (tick < dpiWatchdogTick)
+        tick = dpiWatchdogTick;
+    entry->slot = (uint32_t) (tick % DPI_WATCHDOG_NUM_SLOTS);
+    slot = &dpiWatchdogSlots[entry->slot];
+    entry->next = *slot;
+    if (*slot)
+        (*slot)->prev = entry;
+    *slot = entry;
+    entry->conn = conn;
+    dpiWatchdogNumEntries++;
+
+    return dpiOci__threadMutexRelease(dpiWatchdogEnv, error);
+}
+
+
+//-----------------------------------------------------------------------------
+// dpiWatchdog__breakCalls() [INTERNAL]
+//   Break the calls in the list of expired entries and release the references
+// held on their connections. This is done without holding the mutex so that
+// a slow break does not delay other calls. Once all of them have been broken
+// the entries are marked as fired, which allows the callers waiting for that
+// to remove them.
+//-----------------------------------------------------------------------------
+static void dpiWatchdog__breakCalls(dpiWatchdogEntry *expired,
+        dpiError *error)
+{
+    dpiWatchdogEntry *entry, *nextEntry;
+    dpiError connError;
+
+    connError.buffer = error->buffer;
+    for (entry = expired; entry; entry = entry->nextExpired) {
+        if (dpiEnv__initError(entry->conn->env, &connError) < 0)
+            continue;
+        dpiOci__break(entry->conn, &connError);
+        dpiGen__setRefCount(entry->conn, &connError, -1);
+    }
+    if (dpiOci__threadMutexAcquire(dpiWatchdogEnv, error) < 0)
+        return;
+    for (entry = expired; entry; entry = nextEntry) {
+        nextEntry = entry->nextExpired;
+        entry->state = DPI_WATCHDOG_STATE_FIRED;
+    }
+    dpiOci__threadMutexRelease(dpiWatchdogEnv, error);
+}
+
+
+//-----------------------------------------------------------------------------
+// dpiWatchdog__expireSlot() [INTERNAL]
+//   Mark the calls in the slot for the given tick whose deadline has passed
+// as being broken and add them to the list of expired entries. A reference is
+// held on the connection of each one until it has been broken. Entries in the
+// slot that belong to a later revolution of the wheel are left alone. The
+// mutex is held by the caller.
+//-----------------------------------------------------------------------------
+static void dpiWatchdog__expireSlot(uint64_t tick, uint64_t now,
+        dpiWatchdogEntry **expired, dpiError *error)
+{
+    dpiWatchdogEntry *entry;
+    dpiError connError;
+
+    connError.buffer = error->buffer;
+    entry = dpiWatchdogSlots[tick % DPI_WATCHDOG_NUM_SLOTS];
+    for (; entry; entry = entry->next) {
+        if (entry->state != DPI_WATCHDOG_STATE_WAITING ||
+                entry->expireTime > now)
+            continue;
+        entry->state = DPI_WATCHDOG_STATE_FIRED;
+        if (dpiEnv__initError(entry->conn->env, &connError) < 0 ||
+                dpiGen__setRefCount(entry->conn, &connError, 1) < 0)
+            continue;
+        entry->state = DPI_WATCHDOG_STATE_BREAKING;
+        entry->nextExpired = *expired;
+        *expired = entry;
+    }
+}
+
+
+//-----------------------------------------------------------------------------
+// dpiWatchdog__initialize() [INTERNAL]
+//   Initialize the watchdog using the given (global) environment, the mutex of
+// which protects the timer wheel. The thread itself is not started until the
+// first call with a timeout is made.
+//-----------------------------------------------------------------------------
+int dpiWatchdog__initialize(dpiEnv *env, dpiError *error)
+{
+    if (dpiOci__threadMutexInit(env, &env->mutex, error) < 0)
+        return DPI_FAILURE;
+    dpiWatchdogEnv = env;
+    return DPI_SUCCESS;
+}
+
+
+//-----------------------------------------------------------------------------
+// dpiWatchdog__removeEntry() [INTERNAL]
+//   Remove the entry from the timer wheel after the call has completed with
+// the given status. If the watchdog interrupted the call the connection is
+// reset so that it can continue to be used and the error raised by the
+// interrupted call is replaced by a timeout error.
+//-----------------------------------------------------------------------------
+int dpiWatchdog__removeEntry(dpiWatchdogEntry *entry, int status,
+        dpiError *error)
+{
+    dpiErrorBuffer localErrorBuffer;
+    dpiError localError;
+    uint64_t elapsed;
+    int state;
+
+    // nothing to do if no entry was added
+    if (!entry->conn)
+        return status;
+
+    // remove the entry from its slot; if the watchdog thread is in the process
+    // of breaking the call, wait for that to complete since the entry remains
+    // on its list of expired entries until then; a separate error is used so
+    // that the error from the call is retained
+    localError.buffer = &localErrorBuffer;
+    localError.handle = error->handle;
+    localError.encoding = error->encoding;
+    localError.charsetId = error->charsetId;
+    if (dpiOci__threadMutexAcquire(dpiWatchdogEnv, &localError) < 0) {
+        memcpy(error->buffer, &localErrorBuffer, sizeof(localErrorBuffer));
+        return DPI_FAILURE;
+    }
+    if (entry->prev)
+        entry->prev->next = entry->next;
+    else dpiWatchdogSlots[entry->slot] = entry->next;
+    if (entry->next)
+        entry->next->prev = entry->prev;
+    dpiWatchdogNumEntries--;
+    while (1) {
+        state = entry->state;
+        dpiOci__threadMutexRelease(dpiWatchdogEnv, &localError);
+        if (state != DPI_WATCHDOG_STATE_BREAKING)
+            break;
+        dpiUtils__sleep(DPI_WATCHDOG_POLL_MS);
+        if (dpiOci__threadMutexAcquire(dpiWatchdogEnv, &localError) < 0) {
+            memcpy(error->buffer, &localErrorBuffer, sizeof(localErrorBuffer));
+            return DPI_FAILURE;
+        }
+    }
+    if (state == DPI_WATCHDOG_STATE_WAITING)
+        return status;
+
+    // the call was interrupted (or completed just as the deadline passed);
+    // in either case the break must be cleared
+    elapsed = dpiUtils__getMilliseconds() - entry->startTime;
+    if (dpiOci__reset(entry->conn, &localError) < 0 && status == DPI_SUCCESS) {
+        memcpy(error->buffer, &localErrorBuffer, sizeof(localErrorBuffer));
+        return DPI_FAILURE;
+    }
+
+    // replace the error raised by the interrupted call (ORA-01013: user
+    // requested cancel of current operation)
+    if (status < 0 && error->buffer->code == 1013)
+        return dpiError__set(error, "check timeout", DPI_ERR_CALL_TIMEOUT,
+                (uint32_t) elapsed, entry->timeout);
+    return status;
+}
+
+
+//-----------------------------------------------------------------------------
+// dpiWatchdog__run() [INTERNAL]
+//   Main loop of the watchdog thread. Once per tick the slots for all ticks
+// that have completed since the last pass are processed and the calls found
+// to have expired are broken after the mutex has been released. If the thread
+// was delayed by more than a full revolution of the wheel, each slot is
+// processed just once. The thread exits, freeing the error handle it was
+// given, once no calls have been in progress for DPI_WATCHDOG_IDLE_TICKS
+// ticks.
+//-----------------------------------------------------------------------------
+static void dpiWatchdog__run(void *arg)
+{
+    uint64_t now, currentTick, lastBusyTick;
+    dpiWatchdogEntry *expired;
+    dpiErrorBuffer errorBuffer;
+    dpiError error;
+
+    error.buffer = &errorBuffer;
+    error.handle = arg;
+    error.encoding = dpiWatchdogEnv->encoding;
+    error.charsetId = dpiWatchdogEnv->charsetId;
+    lastBusyTick = dpiUtils__getMilliseconds() / DPI_WATCHDOG_TICK_MS;
+    while (1) {
+        dpiUtils__sleep(DPI_WATCHDOG_TICK_MS);
+        now = dpiUtils__getMilliseconds();
+        currentTick = now / DPI_WATCHDOG_TICK_MS;
+        if (dpiOci__threadMutexAcquire(dpiWatchdogEnv, &error) < 0)
+            continue;
+        if (dpiWatchdogNumEntries > 0)
+            lastBusyTick = currentTick;
+        else if (currentTick - lastBusyTick >= DPI_WATCHDOG_IDLE_TICKS) {
+            dpiWatchdogStarted = 0;
+            dpiOci__threadMutexRelease(dpiWatchdogEnv, &error);
+            break;
+        }
+        if (currentTick - dpiWatchdogTick > DPI_WATCHDOG_NUM_SLOTS)
+            dpiWatchdogTick = currentTick - DPI_WATCHDOG_NUM_SLOTS;
+        expired = NULL;
+        while (dpiWatchdogTick < currentTick)
+            dpiWatchdog__expireSlot(dpiWatchdogTick++, now, &expired, &error);
+        dpiOci__threadMutexRelease(dpiWatchdogEnv, &error);
+        if (expired)
+            dpiWatchdog__breakCalls(expired, &error);
+    }
+    dpiOci__handleFree(arg, DPI_OCI_HTYPE_ERROR);
+}
@@ -0,0 +1,1569 @@
+//-----------------------------------------------------------------------------
+// Copyright (c) 2017 Oracle and/or its affiliates.  All rights reserved.
+// This program is free software: you can modify it and/or redistribute it
+// under the terms of:
+//
+// (i)  the Universal Permissive License v 1.0 or at your option, any
+//      later version (http://oss.oracle.com/licenses/upl); and/or
+//
+// (ii) the Apache License v 2.0. (http://www.apache.org/licenses/LICENSE-2.0)
+//-----------------------------------------------------------------------------
+
+//-----------------------------------------------------------------------------
+// StubOci.c
+//   Stub implementation of the subset of OCI needed to connect, acquire
+// connections from a session pool, perform transaction control and execute
+// queries. It is built as a shared library named libclntsh so that ODPI-C
+// loads it in place of the Oracle Client libraries, which allows the round
+// trip budgets verified by TestRoundTrips to be checked without a database.
+// Queries return a single VARCHAR2 column containing the row number; the
+// number of rows is given by the integer found at the end of the SQL text and
+// queries calling sleep() wait for the given number of seconds when executed.
+// PL/SQL blocks calling sleep() wait for the given number of seconds or
+// until interrupted by OCIBreak() and PL/SQL blocks calling kill_session(N)
+// kill the session they are executed on (failing with ORA-00028) the first N
+// times they are executed using sessions from a pool (or every time, for
+// standalone connections). DML statements start a transaction on the session
+// (unless committed on success) which lasts until it is committed or rolled
+// back. All other statements succeed without doing anything. Temporary LOBs
+// are held in memory and have a fixed chunk size. Object types may be looked
+// up by any name and are described as object types without any attributes.
+// Threads may be created and joined and mutexes are real, but thread keys are
+// shared by all threads.
+//-----------------------------------------------------------------------------
+
+#include <stdint.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <ctype.h>
+#include <time.h>
+#include <pthread.h>
+
+// constants used by OCI (from the OCI header files)
+#define STUB_CHARSET_ID_UTF8            873
+#define STUB_HTYPE_ENV                  1
+#define STUB_HTYPE_SVCCTX               3
+#define STUB_HTYPE_STMT                 4
+#define STUB_HTYPE_DESCRIBE             7
+#define STUB_HTYPE_SERVER               8
+#define STUB_HTYPE_SESSION              9
+#define STUB_DTYPE_PARAM                53
+#define STUB_ATTR_DATA_SIZE             1
+#define STUB_ATTR_DATA_TYPE             2
+#define STUB_ATTR_NAME                  4
+#define STUB_ATTR_SCHEMA_NAME           9
+#define STUB_ATTR_SERVER                6
+#define STUB_ATTR_SESSION               7
+#define STUB_ATTR_IS_NULL               7
+#define STUB_ATTR_PARAM_COUNT           18
+#define STUB_ATTR_STMT_TYPE             24
+#define STUB_ATTR_CHARSET_ID            31
+#define STUB_ATTR_CHARSET_FORM          32
+#define STUB_ATTR_SERVER_STATUS         143
+#define STUB_ATTR_REF_TDO               110
+#define STUB_ATTR_PARAM                 124
+#define STUB_ATTR_STATEMENT             144
+#define STUB_ATTR_ROWS_FETCHED          197
+#define STUB_ATTR_NCHARSET_ID           262
+#define STUB_ATTR_TYPECODE              216
+#define STUB_ATTR_NUM_TYPE_ATTRS        228
+#define STUB_ATTR_CHAR_SIZE             286
+#define STUB_ATTR_TXN_IN_PROGRESS       484
+#define STUB_NLS_CHARSET_MAXBYTESZ      91
+#define STUB_SESSRLS_DROPSESS           1
+#define STUB_COMMIT_ON_SUCCESS          0x20
+#define STUB_SERVER_NORMAL              1
+#define STUB_SQLT_CHR                   1
+#define STUB_SQLT_INT                   3
+#define STUB_SQLCS_IMPLICIT             1
+#define STUB_STMT_TYPE_SELECT           1
+#define STUB_STMT_TYPE_UPDATE           2
+#define STUB_STMT_TYPE_DELETE           3
+#define STUB_STMT_TYPE_INSERT           4
+#define STUB_STMT_TYPE_BEGIN            8
+#define STUB_STMT_TYPE_MERGE            16
+#define STUB_MAX_BINDS                  32
+#define STUB_NO_DATA                    100
+#define STUB_ERROR                      -1
+#define STUB_ERR_CANCELLED              1013
+#define STUB_ERR_SESSION_KILLED         28
+#define STUB_COLUMN_NAME                "VALUE"
+#define STUB_COLUMN_SIZE                40
+#define STUB_TYPE_SCHEMA                "STUB"
+#define STUB_TYPE_NAME                  "UDT_STUB"
+#define STUB_TYPECODE_OBJECT            108
+#define STUB_LOB_CHUNK_SIZE             8132
+#define STUB_RELEASE_STRING             "Oracle Database 12c Stub Release " \
+                                        "12.1.0.2.0"
+
+// forward declarations
+typedef struct dpiStubHandle dpiStubHandle;
+
+// structure used for the variables bound to a statement
+typedef struct {
+    uint32_t pos;
+    void *value;
+    uint16_t dataType;
+    int16_t *indicator;
+    uint32_t *length;
+    uint16_t *returnCode;
+    uint32_t maxArraySize;
+    uint32_t *actualArraySize;
+} dpiStubBind;
+
+// structure used for all handles and descriptors; only the members relevant
+// to the type of handle are used
+struct dpiStubHandle {
+    uint32_t handleType;
+    uint16_t charsetId;
+    dpiStubHandle *server;
+    dpiStubHandle *session;
+    dpiStubHandle *pool;
+    dpiStubHandle *freeSession;
+    char poolName[32];
+    char contextKey[64];
+    void *contextValue;
+    uint16_t statementType;
+    char *sql;
+    uint32_t sqlLength;
+    uint64_t numRows;
+    uint64_t rowNum;
+    uint32_t rowsFetched;
+    char *defineBuffer;
+    uint64_t defineSize;
+    uint16_t defineType;
+    int16_t *defineIndicator;
+    uint32_t *defineLength;
+    uint16_t *defineLength16;
+    uint16_t *defineReturnCode;
+    dpiStubBind binds[STUB_MAX_BINDS];
+    uint32_t numBinds;
+    uint32_t sleepTime;
+    uint32_t numKills;
+    volatile int broken;
+    int inTransaction;
+    int32_t errorCode;
+    char *lobData;
+    uint64_t lobLength;
+    int isTemporaryLob;
+};
+
+// type descriptor object referenced by all object types
+static int dpiStubTdo;
+
+// forward declarations of internal functions only used in this file
+static dpiStubBind *dpiStub__findBind(dpiStubHandle *stmt, uint32_t pos);
+
+
+//-----------------------------------------------------------------------------
+// dpiStub__allocate() [INTERNAL]
+//   Allocate a handle of the given type.
+//-----------------------------------------------------------------------------
+static void *dpiStub__allocate(uint32_t handleType)
+{
+    dpiStubHandle *handle;
+
+    handle = calloc(1, sizeof(dpiStubHandle));
+    if (handle)
+        handle->handleType = handleType;
+    return handle;
+}
+
+
+//-----------------------------------------------------------------------------
+// dpiStub__executeBatch() [INTERNAL]
+//   Perform the work of the blocks generated for batches of statements. Each
+// statement affects one row unless its text contains "fail", in which case
+// it fails with ORA-00001 and, if the block returns on errors, the remaining
+// statements are not executed.
+//-----------------------------------------------------------------------------
+static void dpiStub__executeBatch(dpiStubHandle *stmt)
+{
+    uint32_t rowCountPos, codePos, messagePos;
+    char *pos, *results, *handler, saved;
+    dpiStubBind *bind;
+    int failed;
+
+    pos = stmt->sql;
+    while ((pos = strstr(pos, "execute immediate '")) != NULL) {
+        results = strstr(pos, " := sql%rowcount;");
+        if (!results)
+            break;
+        while (results > pos && *results != ':')
+            results--;
+        if (sscanf(results, ":DPI_B%u := sql%%rowcount; exception when "
+                "others then :DPI_B%u := sqlcode; :DPI_B%u := sqlerrm;",
+                &rowCountPos, &codePos, &messagePos) != 3)
+            break;
+        saved = *results;
+        *results = '\0';
+        failed = (strstr(pos, "fail") != NULL);
+        *results = saved;
+        handler = strstr(results, "sqlerrm;");
+        pos = handler;
+        if (!handler)
+            break;
+        bind = dpiStub__findBind(stmt, (failed) ? codePos : rowCountPos);
+        if (bind) {
+            *((int64_t*) bind->value) = (failed) ? -1 : 1;
+            *bind->indicator = 0;
+        }
+        if (!failed)
+            continue;
+        bind = dpiStub__findBind(stmt, messagePos);
+        if (bind) {
+            strcpy(bind->value, "ORA-00001: unique constraint violated");
+            *bind->length = (uint32_t) strlen(bind->value);
+            *bind->indicator = 0;
+            if (bind->returnCode)
+                *bind->returnCode = 0;
+        }
+        if (strncmp(handler, "sqlerrm; return;", 16) == 0)
+            break;
+    }
+}
+
+
+//-----------------------------------------------------------------------------
+// dpiStub__findBind() [INTERNAL]
+//   Return the variable bound at the given position, or NULL if no variable
+// is bound there.
+//-----------------------------------------------------------------------------
+static dpiStubBind *dpiStub__findBind(dpiStubHandle *stmt, uint32_t pos)
+{
+    uint32_t i;
+
+    for (i = 0; i < stmt->numBinds; i++) {
+        if (stmt->binds[i].pos == pos)
+            return &stmt->binds[i];
+    }
+    return NULL;
+}
+
+
+//-----------------------------------------------------------------------------
+// dpiStub__freeServiceContext() [INTERNAL]
+//   Free a service context along with its server and session handles.
+//-----------------------------------------------------------------------------
+static void dpiStub__freeServiceContext(dpiStubHandle *svcctx)
+{
+    if (svcctx->session)
+        free(svcctx->session->contextValue);
+    free(svcctx->session);
+    free(svcctx->server);
+    free(svcctx);
+}
+
+
+//-----------------------------------------------------------------------------
+// dpiStub__sleep() [INTERNAL]
+//   Sleep for the given number of milliseconds, checking every millisecond
+// whether the service context has been broken. A negative value is returned
+// if the sleep was interrupted.
+//-----------------------------------------------------------------------------
+static int dpiStub__sleep(dpiStubHandle *svcctx, uint32_t milliseconds)
+{
+    struct timespec ts;
+    uint32_t i;
+
+    ts.tv_sec = 0;
+    ts.tv_nsec = 1000000;
+    for (i = 0; i < milliseconds; i++) {
+        if (svcctx->broken)
+            return -1;
+        nanosleep(&ts, NULL);
+    }
+    return 0;
+}
+
+
+//-----------------------------------------------------------------------------
+// dpiStub__setAttr() [INTERNAL]
+//   Set the value of an attribute, if the caller has requested it.
+//-----------------------------------------------------------------------------
+static void dpiStub__setAttr(void *attribute, uint32_t *size,
+        const void *value, uint32_t valueSize)
+{
+    memcpy(attribute, value, valueSize);
+    if (size)
+        *size = valueSize;
+}
+
+
+//-----------------------------------------------------------------------------
+// OCIAttrGet()
+//   Return the value of the attributes needed by ODPI-C. All other attributes
+// are left unchanged.
+//-----------------------------------------------------------------------------
+int OCIAttrGet(const void *trgthndlp, uint32_t trghndltyp, void *attributep,
+        uint32_t *sizep, uint32_t attrtype, void *errhp)
+{
+    dpiStubHandle *handle = (dpiStubHandle*) trgthndlp;
+    uint16_t uint16Value;
+    uint32_t uint32Value;
+    const char *name;
+    uint8_t uint8Value;
+
+    // describe attributes of the only column returned by queries
+    if (handle->handleType == STUB_DTYPE_PARAM) {
+        switch (attrtype) {
+            case STUB_ATTR_NAME:
+                name = STUB_COLUMN_NAME;
+                *(const char**) attributep = name;
+                if (sizep)
+                    *sizep = (uint32_t) strlen(name);
+                break;
+            case STUB_ATTR_DATA_TYPE:
+                uint16Value = STUB_SQLT_CHR;
+                dpiStub__setAttr(attributep, sizep, &uint16Value,
+                        sizeof(uint16_t));
+                break;
+            case STUB_ATTR_DATA_SIZE:
+            case STUB_ATTR_CHAR_SIZE:
+                uint16Value = STUB_COLUMN_SIZE;
+                dpiStub__setAttr(attributep, sizep, &uint16Value,
+                        sizeof(uint16_t));
+                break;
+            case STUB_ATTR_CHARSET_FORM:
+                uint8Value = STUB_SQLCS_IMPLICIT;
+                dpiStub__setAttr(attributep, sizep, &uint8Value,
+                        sizeof(uint8_t));
+                break;
+            case STUB_ATTR_IS_NULL:
+                uint8Value = 1;
+                dpiStub__setAttr(attributep, sizep, &uint8Value,
+                        sizeof(uint8_t));
+                break;
+        }
+        return 0;
+    }
+
+    // describe attributes of object types; the describe handle also serves as
+    // the parameter descriptor of the type
+    if (handle->handleType == STUB_HTYPE_DESCRIBE) {
+        switch (attrtype) {
+            case STUB_ATTR_PARAM:
+                *(void**) attributep = handle;
+                break;
+            case STUB_ATTR_SCHEMA_NAME:
+            case STUB_ATTR_NAME:
+                name = (attrtype == STUB_ATTR_NAME) ? STUB_TYPE_NAME :
+                        STUB_TYPE_SCHEMA;
+                *(const char**) attributep = name;
+                if (sizep)
+                    *sizep = (uint32_t) strlen(name);
+                break;
+            case STUB_ATTR_REF_TDO:
+                *(void**) attributep = &dpiStubTdo;
+                break;
+            case STUB_ATTR_TYPECODE:
+                uint16Value = STUB_TYPECODE_OBJECT;
+                dpiStub__setAttr(attributep, sizep, &uint16Value,
+                        sizeof(uint16_t));
+                break;
+            case STUB_ATTR_NUM_TYPE_ATTRS:
+                uint16Value = 0;
+                dpiStub__setAttr(attributep, sizep, &uint16Value,
+                        sizeof(uint16_t));
+                break;
+        }
+        return 0;
+    }
+
+    // all other handles
+    switch (trghndltyp) {
+        case STUB_HTYPE_ENV:
+            if (attrtype == STUB_ATTR_CHARSET_ID ||
+                    attrtype == STUB_ATTR_NCHARSET_ID)
+                dpiStub__setAttr(attributep, sizep, &handle->charsetId,
+                        sizeof(uint16_t));
+            break;
+        case STUB_HTYPE_SVCCTX:
+            if (attrtype == STUB_ATTR_SERVER)
+                *(void**) attributep = handle->server;
+            else if (attrtype == STUB_ATTR_SESSION)
+                *(void**) attributep = handle->session;
+            break;
+        case STUB_HTYPE_STMT:
+            if (attrtype == STUB_ATTR_STMT_TYPE)
+                dpiStub__setAttr(attributep, sizep, &handle->statementType,
+                        sizeof(uint16_t));
+            else if (attrtype == STUB_ATTR_STATEMENT) {
+                *(const char**) attributep = handle->sql;
+                if (sizep)
+                    *sizep = handle->sqlLength;
+            } else if (attrtype == STUB_ATTR_PARAM_COUNT) {
+                uint32Value = 1;
+                dpiStub__setAttr(attributep, sizep, &uint32Value,
+                        sizeof(uint32_t));
+            } else if (attrtype == STUB_ATTR_ROWS_FETCHED)
+                dpiStub__setAttr(attributep, sizep, &handle->rowsFetched,
+                        sizeof(uint32_t));
+            break;
+        case STUB_HTYPE_SERVER:
+            if (attrtype == STUB_ATTR_CHARSET_ID) {
+                uint16Value = STUB_CHARSET_ID_UTF8;
+                dpiStub__setAttr(attributep, sizep, &uint16Value,
+                        sizeof(uint16_t));
+            } else if (attrtype == STUB_ATTR_SERVER_STATUS) {
+                uint32Value = (handle->errorCode == STUB_ERR_SESSION_KILLED) ?
+                        0 : STUB_SERVER_NORMAL;
+                dpiStub__setAttr(attributep, sizep, &uint32Value,
+                        sizeof(uint32_t));
+            }
+            break;
+        case STUB_HTYPE_SESSION:
+            if (attrtype == STUB_ATTR_TXN_IN_PROGRESS)
+                dpiStub__setAttr(attributep, sizep, &handle->inTransaction,
+                        sizeof(int));
+            break;
+    }
+    return 0;
+}
+
+
+//-----------------------------------------------------------------------------
+// OCIAttrSet()
+//   Set the value of the attributes needed by the stub. All other attributes
+// are ignored.
+//-----------------------------------------------------------------------------
+int OCIAttrSet(void *trgthndlp, uint32_t trghndltyp, void *attributep,
+        uint32_t size, uint32_t attrtype, void *errhp)
+{
+    dpiStubHandle *handle = (dpiStubHandle*) trgthndlp;
+
+    if (trghndltyp == STUB_HTYPE_SVCCTX) {
+        if (attrtype == STUB_ATTR_SERVER)
+            handle->server = (dpiStubHandle*) attributep;
+        else if (attrtype == STUB_ATTR_SESSION)
+            handle->session = (dpiStubHandle*) attributep;
+    }
+    return 0;
+}
+
+
+//-----------------------------------------------------------------------------
+// OCIBindByName2()
+//   Bind a variable by name. The name is not retained; the variable is
+// recorded with position zero so that it is never found by position.
+//-----------------------------------------------------------------------------
+int OCIBindByName2(void *stmtp, void **bindpp, void *errhp,
+        const char *placeholder, int32_t placeh_len, void *valuep,
+        int64_t value_sz, uint16_t dty, void *indp, uint32_t *alenp,
+        uint16_t *rcodep, uint32_t maxarr_len, uint32_t *curelep,
+        uint32_t mode)
+{
+    dpiStubHandle *stmt = (dpiStubHandle*) stmtp;
+    dpiStubBind *bind;
+
+    if (stmt->numBinds == STUB_MAX_BINDS)
+        return -1;
+    bind = &stmt->binds[stmt->numBinds++];
+    bind->pos = 0;
+    bind->value = valuep;
+    bind->dataType = dty;
+    bind->indicator = (int16_t*) indp;
+    bind->length = alenp;
+    bind->returnCode = rcodep;
+    bind->maxArraySize = maxarr_len;
+    bind->actualArraySize = (maxarr_len > 0) ? curelep : NULL;
+    *bindpp = bind;
+    return 0;
+}
+
+
+//-----------------------------------------------------------------------------
+// OCIBindByPos2()
+//   Bind a variable by position, replacing any variable already bound at that
+// position.
+//-----------------------------------------------------------------------------
+int OCIBindByPos2(void *stmtp, void **bindpp, void *errhp, uint32_t position,
+        void *valuep, int64_t value_sz, uint16_t dty, void *indp,
+        uint32_t *alenp, uint16_t *rcodep, uint32_t maxarr_len,
+        uint32_t *curelep, uint32_t mode)
+{
+    dpiStubHandle *stmt = (dpiStubHandle*) stmtp;
+    dpiStubBind *bind;
+    uint32_t i;
+
+    for (i = 0; i < stmt->numBinds; i++) {
+        if (stmt->binds[i].pos == position)
+            break;
+    }
+    if (i == STUB_MAX_BINDS)
+        return -1;
+    if (i == stmt->numBinds)
+        stmt->numBinds++;
+    bind = &stmt->binds[i];
+    bind->pos = position;
+    bind->value = valuep;
+    bind->dataType = dty;
+    bind->indicator = (int16_t*) indp;
+    bind->length = alenp;
+    bind->returnCode = rcodep;
+    bind->maxArraySize = maxarr_len;
+    bind->actualArraySize = (maxarr_len > 0) ? curelep : NULL;
+    *bindpp = bind;
+    return 0;
+}
+
+
+//-----------------------------------------------------------------------------
+// OCIBreak()
+//   Interrupt the call currently in progress on the service context.
+//-----------------------------------------------------------------------------
+int OCIBreak(void *hndlp, void *errhp)
+{
+    ((dpiStubHandle*) hndlp)->broken = 1;
+    return 0;
+}
+
+
+//-----------------------------------------------------------------------------
+// OCIClientVersion()
+//   Report version 12.1 so that the code paths for clients older than 12.2
+// (such as pinging pooled sessions) are exercised.
+//-----------------------------------------------------------------------------
+void OCIClientVersion(int *major_version, int *minor_version, int *update_num,
+        int *patch_num, int *port_update_num)
+{
+    *major_version = 12;
+    *minor_version = 1;
+    *update_num = 0;
+    *patch_num = 2;
+    *port_update_num = 0;
+}
+
+
+//-----------------------------------------------------------------------------
+// OCIContextGetValue()
+//   Return the value stored in the session context for the given key.
+//-----------------------------------------------------------------------------
+int OCIContextGetValue(void *hdl, void *err, const char *key, uint8_t keylen,
+        void **ctx_value)
+{
+    dpiStubHandle *session = (dpiStubHandle*) hdl;
+
+    *ctx_value = NULL;
+    if (keylen < sizeof(session->contextKey) &&
+            strncmp(session->contextKey, key, keylen) == 0 &&
+            session->contextKey[keylen] == '\0')
+        *ctx_value = session->contextValue;
+    return 0;
+}
+
+
+//-----------------------------------------------------------------------------
+// OCIContextSetValue()
+//   Store the value in the session context; only a single key is supported.
+//-----------------------------------------------------------------------------
+int OCIContextSetValue(void *hdl, void *err, uint16_t duration,
+        const char *key, uint8_t keylen, void *ctx_value)
+{
+    dpiStubHandle *session = (dpiStubHandle*) hdl;
+
+    if (keylen >= sizeof(session->contextKey))
+        return -1;
+    memcpy(session->contextKey, key, keylen);
+    session->contextKey[keylen] = '\0';
+    free(session->contextValue);
+    session->contextValue = ctx_value;
+    return 0;
+}
+
+
+//-----------------------------------------------------------------------------
+// OCIDateTimeConstruct()
+//   Nothing to do.
+//-----------------------------------------------------------------------------
+int OCIDateTimeConstruct(void *hndl, void *err, void *datetime, int16_t yr,
+        uint8_t mnth, uint8_t dy, uint8_t hr, uint8_t mm, uint8_t ss,
+        uint32_t fsec, const char *tz, size_t tzLength)
+{
+    return 0;
+}
+
+
+//-----------------------------------------------------------------------------
+// OCIDefineByPos()
+//   Record the buffers into which query rows are to be placed.
+//-----------------------------------------------------------------------------
+int OCIDefineByPos(void *stmtp, void **defnp, void *errhp, uint32_t position,
+        void *valuep, int32_t value_sz, uint16_t dty, void *indp,
+        uint16_t *rlenp, uint16_t *rcodep, uint32_t mode)
+{
+    dpiStubHandle *stmt = (dpiStubHandle*) stmtp;
+
+    stmt->defineBuffer = (char*) valuep;
+    stmt->defineSize = (uint64_t) value_sz;
+    stmt->defineType = dty;
+    stmt->defineIndicator = (int16_t*) indp;
+    stmt->defineLength = NULL;
+    stmt->defineLength16 = rlenp;
+    stmt->defineReturnCode = rcodep;
+    *defnp = stmt;
+    return 0;
+}
+
+
+//-----------------------------------------------------------------------------
+// OCIDefineByPos2()
+//   Record the buffers into which query rows are to be placed.
+//-----------------------------------------------------------------------------
+int OCIDefineByPos2(void *stmtp, void **defnp, void *errhp, uint32_t position,
+        void *valuep, uint64_t value_sz, uint16_t dty, void *indp,
+        uint32_t *rlenp, uint16_t *rcodep, uint32_t mode)
+{
+    dpiStubHandle *stmt = (dpiStubHandle*) stmtp;
+
+    stmt->defineBuffer = (char*) valuep;
+    stmt->defineSize = value_sz;
+    stmt->defineType = dty;
+    stmt->defineIndicator = (int16_t*) indp;
+    stmt->defineLength = rlenp;
+    stmt->defineLength16 = NULL;
+    stmt->defineReturnCode = rcodep;
+    *defnp = stmt;
+    return 0;
+}
+
+
+//-----------------------------------------------------------------------------
+// OCIDescribeAny()
+//   Nothing to do; all object types are described in the same way.
+//-----------------------------------------------------------------------------
+int OCIDescribeAny(void *svchp, void *errhp, void *objptr, uint32_t objnm_len,
+        uint8_t objptr_typ, uint8_t info_level, uint8_t objtyp, void *dschp)
+{
+    return 0;
+}
+
+
+//-----------------------------------------------------------------------------
+// OCIDescriptorAlloc()
+//   Allocate a descriptor.
+//-----------------------------------------------------------------------------
+int OCIDescriptorAlloc(const void *parenth, void **descpp,
+        const uint32_t type, const size_t xtramem_sz, void **usrmempp)
+{
+    *descpp = dpiStub__allocate(type);
+    return (*descpp) ? 0 : -1;
+}
+
+
+//-----------------------------------------------------------------------------
+// OCIDescriptorFree()
+//   Free a descriptor.
+//-----------------------------------------------------------------------------
+int OCIDescriptorFree(void *descp, const uint32_t type)
+{
+    free(((dpiStubHandle*) descp)->lobData);
+    free(descp);
+    return 0;
+}
+
+
+//-----------------------------------------------------------------------------
+// OCIEnvNlsCreate()
+//   Create an environment handle using the requested character set, if one
+// was specified, or UTF-8 if not.
+//-----------------------------------------------------------------------------
+int OCIEnvNlsCreate(void **envp, uint32_t mode, void *ctxp, void *malocfp,
+        void *ralocfp, void *mfreefp, size_t xtramem_sz, void **usrmempp,
+        uint16_t charset, uint16_t ncharset)
+{
+    dpiStubHandle *env;
+
+    env = dpiStub__allocate(STUB_HTYPE_ENV);
+    if (!env)
+        return -1;
+    env->charsetId = (charset) ? charset : STUB_CHARSET_ID_UTF8;
+    *envp = env;
+    return 0;
+}
+
+
+//-----------------------------------------------------------------------------
+// OCIErrorGet()
+//   Return the error raised when a call is interrupted or a session is killed
+// or a generic error otherwise; the stub itself never raises other errors
+// except when it runs out of memory.
+//-----------------------------------------------------------------------------
+int OCIErrorGet(void *hndlp, uint32_t recordno, char *sqlstate,
+        int32_t *errcodep, char *bufp, uint32_t bufsiz, uint32_t type)
+{
+    dpiStubHandle *handle = (dpiStubHandle*) hndlp;
+
+    if (recordno != 1)
+        return STUB_NO_DATA;
+    if (handle->errorCode == STUB_ERR_CANCELLED) {
+        *errcodep = STUB_ERR_CANCELLED;
+        snprintf(bufp, bufsiz,
+                "ORA-01013: user requested cancel of current operation");
+        return 0;
+    }
+    if (handle->errorCode == STUB_ERR_SESSION_KILLED) {
+        *errcodep = STUB_ERR_SESSION_KILLED;
+        snprintf(bufp, bufsiz, "ORA-00028: your session has been killed");
+        return 0;
+    }
+    *errcodep = 1;
+    snprintf(bufp, bufsiz, "ORA-00001: stub OCI library error");
+    return 0;
+}
+
+
+//-----------------------------------------------------------------------------
+// OCIHandleAlloc()
+//   Allocate a handle.
+//-----------------------------------------------------------------------------
+int OCIHandleAlloc(const void *parenth, void **hndlpp, const uint32_t type,
+        const size_t xtramem_sz, void **usrmempp)
+{
+    *hndlpp = dpiStub__allocate(type);
+    return (*hndlpp) ? 0 : -1;
+}
+
+
+//-----------------------------------------------------------------------------
+// OCIHandleFree()
+//   Free a handle.
+//-----------------------------------------------------------------------------
+int OCIHandleFree(void *hndlp, const uint32_t type)
+{
+    dpiStubHandle *handle = (dpiStubHandle*) hndlp;
+
+    if (type == STUB_HTYPE_SESSION && handle)
+        free(handle->contextValue);
+    free(hndlp);
+    return 0;
+}
+
+
+//-----------------------------------------------------------------------------
+// OCILobCreateTemporary()
+//   Make the LOB an empty temporary LOB.
+//-----------------------------------------------------------------------------
+int OCILobCreateTemporary(void *svchp, void *errhp, void *locp, uint16_t csid,
+        uint8_t csfrm, uint8_t lobtype, int cache, uint16_t duration)
+{
+    dpiStubHandle *lob = (dpiStubHandle*) locp;
+
+    free(lob->lobData);
+    lob->lobData = NULL;
+    lob->lobLength = 0;
+    lob->isTemporaryLob = 1;
+    return 0;
+}
+
+
+//-----------------------------------------------------------------------------
+// OCILobFreeTemporary()
+//   Free the data held by the temporary LOB.
+//-----------------------------------------------------------------------------
+int OCILobFreeTemporary(void *svchp, void *errhp, void *locp)
+{
+    dpiStubHandle *lob = (dpiStubHandle*) locp;
+
+    free(lob->lobData);
+    lob->lobData = NULL;
+    lob->lobLength = 0;
+    lob->isTemporaryLob = 0;
+    return 0;
+}
+
+
+//-----------------------------------------------------------------------------
+// OCILobGetChunkSize()
+//   Return the fixed chunk size.
+//-----------------------------------------------------------------------------
+int OCILobGetChunkSize(void *svchp, void *errhp, void *locp,
+        uint32_t *chunksizep)
+{
+    *chunksizep = STUB_LOB_CHUNK_SIZE;
+    return 0;
+}
+
+
+//-----------------------------------------------------------------------------
+// OCILobGetLength2()
+//   Return the length of the LOB.
+//-----------------------------------------------------------------------------
+int OCILobGetLength2(void *svchp, void *errhp, void *locp, uint64_t *lenp)
+{
+    *lenp = ((dpiStubHandle*) locp)->lobLength;
+    return 0;
+}
+
+
+//-----------------------------------------------------------------------------
+// OCILobIsTemporary()
+//   Return whether the LOB is a temporary LOB.
+//-----------------------------------------------------------------------------
+int OCILobIsTemporary(void *envp, void *errhp, void *locp, int *is_temporary)
+{
+    *is_temporary = ((dpiStubHandle*) locp)->isTemporaryLob;
+    return 0;
+}
+
+
+//-----------------------------------------------------------------------------
+// OCILobRead2()
+//   Copy the requested portion of the LOB (offsets start at 1) into the
+// buffer. Character LOBs are treated as single byte data.
+//-----------------------------------------------------------------------------
+int OCILobRead2(void *svchp, void *errhp, void *locp, uint64_t *byte_amtp,
+        uint64_t *char_amtp, uint64_t offset, void *bufp, uint64_t bufl,
+        uint8_t piece, void *ctxp, void *cbfp, uint16_t csid, uint8_t csfrm)
+{
+    dpiStubHandle *lob = (dpiStubHandle*) locp;
+    uint64_t amount;
+
+    amount = (*byte_amtp > 0) ? *byte_amtp : *char_amtp;
+    if (amount > bufl)
+        amount = bufl;
+    if (offset == 0 || offset > lob->lobLength)
+        amount = 0;
+    else if (amount > lob->lobLength - offset + 1)
+        amount = lob->lobLength - offset + 1;
+    if (amount > 0)
+        memcpy(bufp, lob->lobData + offset - 1, amount);
+    *byte_amtp = amount;
+    *char_amtp = amount;
+    return 0;
+}
+
+
+//-----------------------------------------------------------------------------
+// OCILobTrim2()
+//   Trim the LOB to the given length.
+//-----------------------------------------------------------------------------
+int OCILobTrim2(void *svchp, void *errhp, void *locp, uint64_t newlen)
+{
+    dpiStubHandle *lob = (dpiStubHandle*) locp;
+
+    if (newlen < lob->lobLength)
+        lob->lobLength = newlen;
+    return 0;
+}
+
+
+//-----------------------------------------------------------------------------
+// OCILobWrite2()
+//   Write the buffer to the LOB at the given offset (offsets start at 1),
+// extending the LOB with zero bytes if the offset is beyond its end.
+//-----------------------------------------------------------------------------
+int OCILobWrite2(void *svchp, void *errhp, void *locp, uint64_t *byte_amtp,
+        uint64_t *char_amtp, uint64_t offset, void *bufp, uint64_t buflen,
+        uint8_t piece, void *ctxp, void *cbfp, uint16_t csid, uint8_t csfrm)
+{
+    dpiStubHandle *lob = (dpiStubHandle*) locp;
+    uint64_t newLength;
+    char *newData;
+
+    if (offset == 0)
+        return STUB_ERROR;
+    newLength = offset - 1 + buflen;
+    if (newLength > lob->lobLength) {
+        newData = realloc(lob->lobData, newLength);
+        if (!newData)
+            return STUB_ERROR;
+        memset(newData + lob->lobLength, 0, newLength - lob->lobLength);
+        lob->lobData = newData;
+        lob->lobLength = newLength;
+    }
+    memcpy(lob->lobData + offset - 1, bufp, buflen);
+    *byte_amtp = buflen;
+    return 0;
+}
+
+
+//-----------------------------------------------------------------------------
+// OCIMemoryAlloc()
+//   Allocate cleared memory.
+//-----------------------------------------------------------------------------
+int OCIMemoryAlloc(void *hdl, void *err, void **mem, uint16_t dur,
+        uint32_t size, uint32_t flags)
+{
+    *mem = calloc(1, size);
+    return (*mem) ? 0 : -1;
+}
+
+
+//-----------------------------------------------------------------------------
+// OCIMemoryFree()
+//   Free memory allocated by OCIMemoryAlloc().
+//-----------------------------------------------------------------------------
+int OCIMemoryFree(void *hdl, void *err, void *mem)
+{
+    free(mem);
+    return 0;
+}
+
+
+//-----------------------------------------------------------------------------
+// OCINlsCharSetConvert()
+//   Copy the source to the destination; only ASCII data is converted by
+// ODPI-C during initialization.
+//-----------------------------------------------------------------------------
+int OCINlsCharSetConvert(void *envhp, void *errhp, uint16_t dstid,
+        void *dstp, size_t dstlen, uint16_t srcid, const void *srcp,
+        size_t srclen, size_t *rsize)
+{
+    if (srclen > dstlen)
+        srclen = dstlen;
+    memcpy(dstp, srcp, srclen);
+    *rsize = srclen;
+    return 0;
+}
+
+
+//-----------------------------------------------------------------------------
+// OCINlsCharSetIdToName()
+//   Return the name of the only character set supported.
+//-----------------------------------------------------------------------------
+int OCINlsCharSetIdToName(void *envhp, char *buf, size_t buflen, uint16_t id)
+{
+    if (id != STUB_CHARSET_ID_UTF8)
+        return -1;
+    snprintf(buf, buflen, "AL32UTF8");
+    return 0;
+}
+
+
+//-----------------------------------------------------------------------------
+// OCINlsCharSetNameToId()
+//   Return the id of the only character set supported.
+//-----------------------------------------------------------------------------
+uint16_t OCINlsCharSetNameToId(void *envhp, const char *name)
+{
+    if (strcmp(name, "AL32UTF8") == 0)
+        return STUB_CHARSET_ID_UTF8;
+    return 0;
+}
+
+
+//-----------------------------------------------------------------------------
+// OCINlsEnvironmentVariableGet()
+//   Return UTF-8 for both the character set and the national character set.
+//-----------------------------------------------------------------------------
+int OCINlsEnvironmentVariableGet(void *val, size_t size, uint16_t item,
+        uint16_t charset, size_t *rsize)
+{
+    *(uint16_t*) val = STUB_CHARSET_ID_UTF8;
+    if (rsize)
+        *rsize = sizeof(uint16_t);
+    return 0;
+}
+
+
+//-----------------------------------------------------------------------------
+// OCINlsNameMap()
+//   Map the only character set supported between its Oracle and IANA names.
+//-----------------------------------------------------------------------------
+int OCINlsNameMap(void *envhp, char *buf, size_t buflen, const char *srcbuf,
+        uint32_t flag)
+{
+    if (strcmp(srcbuf, "AL32UTF8") == 0)
+        snprintf(buf, buflen, "UTF-8");
+    else if (strcmp(srcbuf, "UTF-8") == 0)
+        snprintf(buf, buflen, "AL32UTF8");
+    else return -1;
+    return 0;
+}
+
+
+//-----------------------------------------------------------------------------
+// OCINlsNumericInfoGet()
+//   Return the maximum number of bytes per character for UTF-8.
+//-----------------------------------------------------------------------------
+int OCINlsNumericInfoGet(void *envhp, void *errhp, int32_t *val,
+        uint16_t item)
+{
+    *val = (item == STUB_NLS_CHARSET_MAXBYTESZ) ? 4 : 0;
+    return 0;
+}
+
+
+//-----------------------------------------------------------------------------
+// OCIObjectPin()
+//   Return the type descriptor object referenced by all object types.
+//-----------------------------------------------------------------------------
+int OCIObjectPin(void *env, void *err, void *object_ref, void *corhdl,
+        int pin_option, uint16_t pin_duration, int lock_option, void **object)
+{
+    *object = object_ref;
+    return 0;
+}
+
+
+//-----------------------------------------------------------------------------
+// OCIParamGet()
+//   Return a descriptor for the only column returned by queries.
+//-----------------------------------------------------------------------------
+int OCIParamGet(const void *hndlp, uint32_t htype, void *errhp,
+        void **parmdpp, uint32_t pos)
+{
+    *parmdpp = dpiStub__allocate(STUB_DTYPE_PARAM);
+    return (*parmdpp) ? 0 : -1;
+}
+
+
+//-----------------------------------------------------------------------------
+// OCIPing()
+//   Nothing to do.
+//-----------------------------------------------------------------------------
+int OCIPing(void *svchp, void *errhp, uint32_t mode)
+{
+    return 0;
+}
+
+
+//-----------------------------------------------------------------------------
+// OCIReset()
+//   Clear the interrupt on the service context.
+//-----------------------------------------------------------------------------
+int OCIReset(void *hndlp, void *errhp)
+{
+    ((dpiStubHandle*) hndlp)->broken = 0;
+    return 0;
+}
+
+
+//-----------------------------------------------------------------------------
+// OCIServerAttach()
+//   Nothing to do.
+//-----------------------------------------------------------------------------
+int OCIServerAttach(void *srvhp, void *errhp, const char *dblink,
+        int32_t dblink_len, uint32_t mode)
+{
+    return 0;
+}
+
+
+//-----------------------------------------------------------------------------
+// OCIServerDetach()
+//   Nothing to do.
+//-----------------------------------------------------------------------------
+int OCIServerDetach(void *srvhp, void *errhp, uint32_t mode)
+{
+    return 0;
+}
+
+
+//-----------------------------------------------------------------------------
+// OCIServerRelease()
+//   Return the release string and version of the stub "server".
+//-----------------------------------------------------------------------------
+int OCIServerRelease(void *hndlp, void *errhp, char *bufp, uint32_t bufsz,
+        uint8_t hndltype, uint32_t *version)
+{
+    snprintf(bufp, bufsz, "%s", STUB_RELEASE_STRING);
+    *version = (12 << 24) | (1 << 20) | (2 << 8);
+    return 0;
+}
+
+
+//-----------------------------------------------------------------------------
+// OCISessionBegin()
+//   Nothing to do.
+//-----------------------------------------------------------------------------
+int OCISessionBegin(void *svchp, void *errhp, void *usrhp, uint32_t credt,
+        uint32_t mode)
+{
+    return 0;
+}
+
+
+//-----------------------------------------------------------------------------
+// OCISessionEnd()
+//   Nothing to do.
+//-----------------------------------------------------------------------------
+int OCISessionEnd(void *svchp, void *errhp, void *usrhp, uint32_t mode)
+{
+    return 0;
+}
+
+
+//-----------------------------------------------------------------------------
+// OCISessionGet()
+//   Acquire a session from the pool identified by the pool name, reusing the
+// session most recently released to the pool if there is one.
+//-----------------------------------------------------------------------------
+int OCISessionGet(void *envhp, void *errhp, void **svchp, void *authhp,
+        const char *poolName, uint32_t poolName_len, const char *tagInfo,
+        uint32_t tagInfo_len, const char **retTagInfo,
+        uint32_t *retTagInfo_len, int *found, uint32_t mode)
+{
+    dpiStubHandle *pool, *svcctx;
+    char name[32];
+    void *ptr;
+
+    // locate the pool
+    if (poolName_len == 0 || poolName_len >= sizeof(name))
+        return -1;
+    memcpy(name, poolName, poolName_len);
+    name[poolName_len] = '\0';
+    if (sscanf(name, "%p", &ptr) != 1)
+        return -1;
+    pool = (dpiStubHandle*) ptr;
+
+    // reuse the free session, if there is one; otherwise, create one
+    if (pool->freeSession) {
+        svcctx = pool->freeSession;
+        pool->freeSession = NULL;
+    } else {
+        svcctx = dpiStub__allocate(STUB_HTYPE_SVCCTX);
+        if (!svcctx)
+            return -1;
+        svcctx->server = dpiStub__allocate(STUB_HTYPE_SERVER);
+        svcctx->session = dpiStub__allocate(STUB_HTYPE_SESSION);
+        if (!svcctx->server || !svcctx->session) {
+            dpiStub__freeServiceContext(svcctx);
+            return -1;
+        }
+        svcctx->pool = pool;
+    }
+
+    *svchp = svcctx;
+    if (retTagInfo)
+        *retTagInfo = NULL;
+    if (retTagInfo_len)
+        *retTagInfo_len = 0;
+    if (found)
+        *found = 0;
+    return 0;
+}
+
+
+//-----------------------------------------------------------------------------
+// OCISessionPoolCreate()
+//   Create a session pool; its name identifies the pool handle.
+//-----------------------------------------------------------------------------
+int OCISessionPoolCreate(void *envhp, void *errhp, void *spoolhp,
+        char **poolName, uint32_t *poolNameLen, const char *connStr,
+        uint32_t connStrLen, uint32_t sessMin, uint32_t sessMax,
+        uint32_t sessIncr, const char *userid, uint32_t useridLen,
+        const char *password, uint32_t passwordLen, uint32_t mode)
+{
+    dpiStubHandle *pool = (dpiStubHandle*) spoolhp;
+
+    snprintf(pool->poolName, sizeof(pool->poolName), "%p", spoolhp);
+    *poolName = pool->poolName;
+    *poolNameLen = (uint32_t) strlen(pool->poolName);
+    return 0;
+}
+
+
+//-----------------------------------------------------------------------------
+// OCISessionPoolDestroy()
+//   Destroy the session pool and the free session, if there is one.
+//-----------------------------------------------------------------------------
+int OCISessionPoolDestroy(void *spoolhp, void *errhp, uint32_t mode)
+{
+    dpiStubHandle *pool = (dpiStubHandle*) spoolhp;
+
+    if (pool->freeSession) {
+        dpiStub__freeServiceContext(pool->freeSession);
+        pool->freeSession = NULL;
+    }
+    return 0;
+}
+
+
+//-----------------------------------------------------------------------------
+// OCISessionRelease()
+//   Release the session back to its pool or drop it, if requested.
+//-----------------------------------------------------------------------------
+int OCISessionRelease(void *svchp, void *errhp, const char *tag,
+        uint32_t tag_len, uint32_t mode)
+{
+    dpiStubHandle *svcctx = (dpiStubHandle*) svchp;
+
+    if (mode & STUB_SESSRLS_DROPSESS || svcctx->pool->freeSession)
+        dpiStub__freeServiceContext(svcctx);
+    else svcctx->pool->freeSession = svcctx;
+    return 0;
+}
+
+
+//-----------------------------------------------------------------------------
+// OCIStmtExecute()
+//   Position queries before the first row and perform the work of PL/SQL
+// blocks. Statements which sleep fail with ORA-01013 if interrupted while
+// sleeping and statements executed on a killed session fail with ORA-00028.
+// DML statements start a transaction unless committed on success.
+//-----------------------------------------------------------------------------
+int OCIStmtExecute(void *svchp, void *stmtp, void *errhp, uint32_t iters,
+        uint32_t rowoff, const void *snap_in, void *snap_out, uint32_t mode)
+{
+    dpiStubHandle *svcctx = (dpiStubHandle*) svchp;
+    dpiStubHandle *stmt = (dpiStubHandle*) stmtp;
+
+    ((dpiStubHandle*) errhp)->errorCode = 0;
+    if (stmt->numKills > 0 && svcctx->server && (!svcctx->pool ||
+            svcctx->pool->numKills < stmt->numKills)) {
+        if (svcctx->pool)
+            svcctx->pool->numKills++;
+        svcctx->server->errorCode = STUB_ERR_SESSION_KILLED;
+    }
+    if (svcctx->server &&
+            svcctx->server->errorCode == STUB_ERR_SESSION_KILLED) {
+        ((dpiStubHandle*) errhp)->errorCode = STUB_ERR_SESSION_KILLED;
+        return STUB_ERROR;
+    }
+    stmt->rowNum = 0;
+    stmt->rowsFetched = 0;
+    if (stmt->sleepTime > 0) {
+        if (dpiStub__sleep((dpiStubHandle*) svchp, stmt->sleepTime) < 0) {
+            ((dpiStubHandle*) errhp)->errorCode = STUB_ERR_CANCELLED;
+            return STUB_ERROR;
+        }
+    } else if (stmt->statementType == STUB_STMT_TYPE_BEGIN &&
+            strstr(stmt->sql, "execute immediate '"))
+        dpiStub__executeBatch(stmt);
+    if (svcctx->session && (stmt->statementType == STUB_STMT_TYPE_INSERT ||
+            stmt->statementType == STUB_STMT_TYPE_UPDATE ||
+            stmt->statementType == STUB_STMT_TYPE_DELETE ||
+            stmt->statementType == STUB_STMT_TYPE_MERGE))
+        svcctx->session->inTransaction = !(mode & STUB_COMMIT_ON_SUCCESS);
+    return 0;
+}
+
+
+//-----------------------------------------------------------------------------
+// OCIStmtFetch2()
+//   Place the next rows in the defined buffers. Each row contains the row
+// number as a string or, if the column was defined as a native integer, as an
+// integer. The return code of each row is cleared, as ODPI-C checks it.
+//-----------------------------------------------------------------------------
+int OCIStmtFetch2(void *stmtp, void *errhp, uint32_t nrows,
+        uint16_t orientation, int32_t scrollOffset, uint32_t mode)
+{
+    dpiStubHandle *stmt = (dpiStubHandle*) stmtp;
+    uint32_t i, length;
+    int64_t intValue;
+    char *value;
+
+    stmt->rowsFetched = 0;
+    for (i = 0; i < nrows && stmt->rowNum < stmt->numRows; i++) {
+        stmt->rowNum++;
+        value = stmt->defineBuffer + i * stmt->defineSize;
+        if (stmt->defineType == STUB_SQLT_INT) {
+            intValue = (int64_t) stmt->rowNum;
+            length = sizeof(int64_t);
+            memcpy(value, &intValue, length);
+        } else length = (uint32_t) snprintf(value, stmt->defineSize, "%lu",
+                (unsigned long) stmt->rowNum);
+        if (stmt->defineIndicator)
+            stmt->defineIndicator[i] = 0;
+        if (stmt->defineLength)
+            stmt->defineLength[i] = length;
+        else if (stmt->defineLength16)
+            stmt->defineLength16[i] = (uint16_t) length;
+        if (stmt->defineReturnCode)
+            stmt->defineReturnCode[i] = 0;
+        stmt->rowsFetched++;
+    }
+    return (stmt->rowsFetched < nrows) ? STUB_NO_DATA : 0;
+}
+
+
+//-----------------------------------------------------------------------------
+// OCIStmtPrepare2()
+//   Prepare a statement; statements starting with "select" are queries and
+// return the number of rows given by the integer at the end of the SQL text;
+// statements starting with "begin" are PL/SQL blocks; both may call sleep()
+// and PL/SQL blocks may also call kill_session(). Statements starting with
+// "insert", "update", "delete" or "merge" are DML statements.
+//-----------------------------------------------------------------------------
+int OCIStmtPrepare2(void *svchp, void **stmtp, void *errhp, const char *stmt,
+        uint32_t stmt_len, const char *key, uint32_t key_len,
+        uint32_t language, uint32_t mode)
+{
+    const char *sleepText, *killText;
+    dpiStubHandle *handle;
+    uint32_t pos;
+
+    handle = dpiStub__allocate(STUB_HTYPE_STMT);
+    if (!handle)
+        return -1;
+    handle->sql = malloc(stmt_len + 1);
+    if (!handle->sql) {
+        free(handle);
+        return -1;
+    }
+    memcpy(handle->sql, stmt, stmt_len);
+    handle->sql[stmt_len] = '\0';
+    handle->sqlLength = stmt_len;
+    if (stmt_len >= 6 && strncasecmp(stmt, "select", 6) == 0) {
+        handle->statementType = STUB_STMT_TYPE_SELECT;
+        pos = stmt_len;
+        while (pos > 0 && isdigit((unsigned char) stmt[pos - 1]))
+            pos--;
+        for (; pos < stmt_len; pos++)
+            handle->numRows = handle->numRows * 10 + (stmt[pos] - '0');
+    } else if (stmt_len >= 6 && strncasecmp(stmt, "update", 6) == 0) {
+        handle->statementType = STUB_STMT_TYPE_UPDATE;
+    } else if (stmt_len >= 6 && strncasecmp(stmt, "delete", 6) == 0) {
+        handle->statementType = STUB_STMT_TYPE_DELETE;
+    } else if (stmt_len >= 6 && strncasecmp(stmt, "insert", 6) == 0) {
+        handle->statementType = STUB_STMT_TYPE_INSERT;
+    } else if (stmt_len >= 5 && strncasecmp(stmt, "merge", 5) == 0) {
+        handle->statementType = STUB_STMT_TYPE_MERGE;
+    } else if (stmt_len >= 5 && strncasecmp(stmt, "begin", 5) == 0) {
+        handle->statementType = STUB_STMT_TYPE_BEGIN;
+        killText = strstr(handle->sql, "kill_session(");
+        if (killText)
+            handle->numKills = (uint32_t) strtoul(killText + 13, NULL, 10);
+    }
+    if (handle->statementType == STUB_STMT_TYPE_SELECT ||
+            handle->statementType == STUB_STMT_TYPE_BEGIN) {
+        sleepText = strstr(handle->sql, "sleep(");
+        if (sleepText)
+            handle->sleepTime =
+                    (uint32_t) (strtod(sleepText + 6, NULL) * 1000);
+    }
+    *stmtp = handle;
+    return 0;
+}
+
+
+//-----------------------------------------------------------------------------
+// OCIStmtRelease()
+//   Release the statement.
+//-----------------------------------------------------------------------------
+int OCIStmtRelease(void *stmtp, void *errhp, const char *key, uint32_t key_len,
+        uint32_t mode)
+{
+    free(((dpiStubHandle*) stmtp)->sql);
+    free(stmtp);
+    return 0;
+}
+
+
+//-----------------------------------------------------------------------------
+// OCIThreadClose()
+//   Nothing to do.
+//-----------------------------------------------------------------------------
+int OCIThreadClose(void *hndl, void *err, void *tHnd)
+{
+    return 0;
+}
+
+
+//-----------------------------------------------------------------------------
+// OCIThreadCreate()
+//   Create a thread running the given function and store it in the thread
+// handle so that it can be joined.
+//-----------------------------------------------------------------------------
+int OCIThreadCreate(void *hndl, void *err, void (*start)(void*), void *arg,
+        void *tid, void *tHnd)
+{
+    int status;
+
+    status = pthread_create((pthread_t*) tHnd, NULL,
+            (void *(*)(void*)) start, arg);
+    return (status == 0) ? 0 : STUB_ERROR;
+}
+
+
+//-----------------------------------------------------------------------------
+// OCIThreadHndDestroy()
+//   Destroy a thread handle.
+//-----------------------------------------------------------------------------
+int OCIThreadHndDestroy(void *hndl, void *err, void **thnd)
+{
+    free(*thnd);
+    *thnd = NULL;
+    return 0;
+}
+
+
+//-----------------------------------------------------------------------------
+// OCIThreadHndInit()
+//   Create a thread handle, which holds the thread once it is created.
+//-----------------------------------------------------------------------------
+int OCIThreadHndInit(void *hndl, void *err, void **thnd)
+{
+    *thnd = malloc(sizeof(pthread_t));
+    return (*thnd) ? 0 : STUB_ERROR;
+}
+
+
+//-----------------------------------------------------------------------------
+// OCIThreadIdDestroy()
+//   Destroy a thread id.
+//-----------------------------------------------------------------------------
+int OCIThreadIdDestroy(void *hndl, void *err, void **tid)
+{
+    free(*tid);
+    *tid = NULL;
+    return 0;
+}
+
+
+//-----------------------------------------------------------------------------
+// OCIThreadIdInit()
+//   Create a thread id; nothing is stored in it.
+//-----------------------------------------------------------------------------
+int OCIThreadIdInit(void *hndl, void *err, void **tid)
+{
+    *tid = malloc(1);
+    return (*tid) ? 0 : STUB_ERROR;
+}
+
+
+//-----------------------------------------------------------------------------
+// OCIThreadJoin()
+//   Wait for the thread to terminate.
+//-----------------------------------------------------------------------------
+int OCIThreadJoin(void *hndl, void *err, void *tHnd)
+{
+    return (pthread_join(*((pthread_t*) tHnd), NULL) == 0) ? 0 : STUB_ERROR;
+}
+
+
+//-----------------------------------------------------------------------------
+// OCIThreadKeyDestroy()
+//   Destroy a thread key.
+//-----------------------------------------------------------------------------
+int OCIThreadKeyDestroy(void *hndl, void *err, void **key)
+{
+    free(*key);
+    *key = NULL;
+    return 0;
+}
+
+
+//-----------------------------------------------------------------------------
+// OCIThreadKeyGet()
+//   Return the value stored in a thread key.
+//-----------------------------------------------------------------------------
+int OCIThreadKeyGet(void *hndl, void *err, void *key, void **pValue)
+{
+    *pValue = *(void**) key;
+    return 0;
+}
+
+
+//-----------------------------------------------------------------------------
+// OCIThreadKeyInit()
+//   Create a thread key; the value is shared by all threads so this is simply
+// storage for a pointer.
+//-----------------------------------------------------------------------------
+int OCIThreadKeyInit(void *hndl, void *err, void **key, void *destFn)
+{
+    *key = calloc(1, sizeof(void*));
+    return (*key) ? 0 : -1;
+}
+
+
+//-----------------------------------------------------------------------------
+// OCIThreadKeySet()
+//   Store a value in a thread key.
+//-----------------------------------------------------------------------------
+int OCIThreadKeySet(void *hndl, void *err, void *key, void *value)
+{
+    *(void**) key = value;
+    return 0;
+}
+
+
+//-----------------------------------------------------------------------------
+// OCIThreadMutexAcquire()
+//   Acquire a mutex.
+//-----------------------------------------------------------------------------
+int OCIThreadMutexAcquire(void *hndl, void *err, void *mutex)
+{
+    return pthread_mutex_lock((pthread_mutex_t*) mutex) ? STUB_ERROR : 0;
+}
+
+
+//-----------------------------------------------------------------------------
+// OCIThreadMutexDestroy()
+//   Destroy a mutex.
+//-----------------------------------------------------------------------------
+int OCIThreadMutexDestroy(void *hndl, void *err, void **mutex)
+{
+    pthread_mutex_destroy((pthread_mutex_t*) *mutex);
+    free(*mutex);
+    *mutex = NULL;
+    return 0;
+}
+
+
+//-----------------------------------------------------------------------------
+// OCIThreadMutexInit()
+//   Create a mutex.
+//-----------------------------------------------------------------------------
+int OCIThreadMutexInit(void *hndl, void *err, void **mutex)
+{
+    *mutex = malloc(sizeof(pthread_mutex_t));
+    if (!*mutex)
+        return -1;
+    pthread_mutex_init((pthread_mutex_t*) *mutex, NULL);
+    return 0;
+}
+
+
+//-----------------------------------------------------------------------------
+// OCIThreadMutexRelease()
+//   Release a mutex.
+//-----------------------------------------------------------------------------
+int OCIThreadMutexRelease(void *hndl, void *err, void *mutex)
+{
+    return pthread_mutex_unlock((pthread_mutex_t*) mutex) ? STUB_ERROR : 0;
+}
+
+
+//-----------------------------------------------------------------------------
+// OCIThreadProcessInit()
+//   Nothing to do.
+//-----------------------------------------------------------------------------
+void OCIThreadProcessInit(void)
+{
+}
+
+
+//-----------------------------------------------------------------------------
+// OCITransCommit()
+//   End the transaction in progress on the session, if any.
+//-----------------------------------------------------------------------------
+int OCITransCommit(void *svchp, void *errhp, uint32_t flags)
+{
+    dpiStubHandle *svcctx = (dpiStubHandle*) svchp;
+
+    if (svcctx->session)
+        svcctx->session->inTransaction = 0;
+    return 0;
+}
+
+
+//-----------------------------------------------------------------------------
+// OCITransRollback()
+//   End the transaction in progress on the session, if any.
+//-----------------------------------------------------------------------------
+int OCITransRollback(void *svchp, void *errhp, uint32_t flags)
+{
+    dpiStubHandle *svcctx = (dpiStubHandle*) svchp;
+
+    if (svcctx->session)
+        svcctx->session->inTransaction = 0;
+    return 0;
+}
+
+
+//-----------------------------------------------------------------------------
+// OCITypeByFullName()
+//   Return the type descriptor object referenced by all object types.
+//-----------------------------------------------------------------------------
+int OCITypeByFullName(void *env, void *err, const void *svc,
+        const char *full_type_name, uint32_t full_type_name_length,
+        const char *version_name, uint32_t version_name_length,
+        uint16_t pin_duration, int get_option, void **tdo)
+{
+    *tdo = &dpiStubTdo;
+    return 0;
+}
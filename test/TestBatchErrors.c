@@ -19,6 +19,52 @@
 #define NUM_ROWS                        3
 #define NUM_ERR                         2
 
+//-----------------------------------------------------------------------------
+// dpiTest__prepareBatchWithError()
+//   Prepare a batch of three statements bound to the same variable, the second
+// of which fails with ORA-00001: unique constraint violated.
+//-----------------------------------------------------------------------------
+static int dpiTest__prepareBatchWithError(dpiTestCase *testCase,
+        dpiConn *conn, dpiBatch **batch)
+{
+    const char *sqls[NUM_ROWS] = {
+        "insert into TestTempTable (IntCol) values (:1)",
+        "insert into TestTempTable (IntCol, StringCol) "
+                "values (:intVal, 'fail')",
+        "update TestTempTable set StringCol = 'It''s done' "
+                "where IntCol = :intVal"
+    };
+    dpiData *intColValue;
+    dpiVar *intColVar;
+    dpiStmt *stmt;
+    int i;
+
+    if (dpiConn_newBatch(conn, batch) < 0)
+        return dpiTestCase_setFailedFromError(testCase);
+    if (dpiConn_newVar(conn, DPI_ORACLE_TYPE_NATIVE_INT, DPI_NATIVE_TYPE_INT64,
+            1, 0, 0, 0, NULL, &intColVar, &intColValue) < 0)
+        return dpiTestCase_setFailedFromError(testCase);
+    dpiData_setInt64(intColValue, 1);
+    for (i = 0; i < NUM_ROWS; i++) {
+        if (dpiConn_prepareStmt(conn, 0, sqls[i], strlen(sqls[i]), NULL, 0,
+                &stmt) < 0)
+            return dpiTestCase_setFailedFromError(testCase);
+        if (i == 0 && dpiStmt_bindByPos(stmt, 1, intColVar) < 0)
+            return dpiTestCase_setFailedFromError(testCase);
+        if (i > 0 && dpiStmt_bindByName(stmt, "intVal", 6, intColVar) < 0)
+            return dpiTestCase_setFailedFromError(testCase);
+        if (dpiBatch_addStmt(*batch, stmt) < 0)
+            return dpiTestCase_setFailedFromError(testCase);
+        if (dpiStmt_release(stmt) < 0)
+            return dpiTestCase_setFailedFromError(testCase);
+    }
+    if (dpiVar_release(intColVar) < 0)
+        return dpiTestCase_setFailedFromError(testCase);
+
+    return DPI_SUCCESS;
+}
+
+
 //-----------------------------------------------------------------------------
 // dpiTest__prepareInsertWithErrors()
 //   Prepare insert statement for execution with known errors.
@@ -198,6 +244,343 @@ int dpiTest_2302_verifyGetBatchErrorsWithLesserNumErrVal(dpiTestCase *testCase,
 }
 
 
+//-----------------------------------------------------------------------------
+// dpiTest_2303_verifyBatchErrOffsetsAfterSortBinds()
+//   Prepare array of data to insert that will result in errors, with the rows
+// in the reverse order of the string column; call dpiStmt_sortBinds() using
+// the string column as the key and confirm that the permutation returned
+// reverses the rows; call dpiStmt_executeMany() with mode set to
+// DPI_MODE_EXEC_BATCH_ERRORS and confirm that the row offsets returned by
+// dpiStmt_getBatchErrors() refer to the original positions of the rows (no
+// error).
+//-----------------------------------------------------------------------------
+int dpiTest_2303_verifyBatchErrOffsetsAfterSortBinds(dpiTestCase *testCase,
+        dpiTestParams *params)
+{
+    const char *stringValues[NUM_ROWS] = { "TEST 3", "TEST 2", "TEST 1" };
+    const char *sql = "insert into TestTempTable values (:1, :2)";
+    int64_t intValues[NUM_ROWS] = { 71113434343434, 3, 3 };
+    uint32_t permutation[NUM_ROWS], count, i;
+    dpiData *intColValue, *stringColValue;
+    dpiVar *intColVar, *stringColVar;
+    dpiErrorInfo errorInfo[NUM_ERR];
+    dpiStmt *stmt;
+    dpiConn *conn;
+
+    // prepare statement and bind variables
+    if (dpiTestCase_getConnection(testCase, &conn) < 0)
+        return DPI_FAILURE;
+    if (dpiTest__truncateTable(testCase, conn) < 0)
+        return DPI_FAILURE;
+    if (dpiConn_prepareStmt(conn, 0, sql, strlen(sql), NULL, 0, &stmt) < 0)
+        return dpiTestCase_setFailedFromError(testCase);
+    if (dpiConn_newVar(conn, DPI_ORACLE_TYPE_NUMBER, DPI_NATIVE_TYPE_INT64,
+            NUM_ROWS, 0, 0, 0, NULL, &intColVar, &intColValue) < 0)
+        return dpiTestCase_setFailedFromError(testCase);
+    if (dpiStmt_bindByPos(stmt, 1, intColVar) < 0)
+        return dpiTestCase_setFailedFromError(testCase);
+    if (dpiConn_newVar(conn, DPI_ORACLE_TYPE_VARCHAR, DPI_NATIVE_TYPE_BYTES,
+            NUM_ROWS, 30, 0, 0, NULL, &stringColVar, &stringColValue) < 0)
+        return dpiTestCase_setFailedFromError(testCase);
+    if (dpiStmt_bindByPos(stmt, 2, stringColVar) < 0)
+        return dpiTestCase_setFailedFromError(testCase);
+    for (i = 0; i < NUM_ROWS; i++) {
+        dpiData_setInt64(&intColValue[i], intValues[i]);
+        if (dpiVar_setFromBytes(stringColVar, i, stringValues[i],
+                strlen(stringValues[i])) < 0)
+            return dpiTestCase_setFailedFromError(testCase);
+    }
+
+    // sort the rows and verify the permutation and the values
+    if (dpiStmt_sortBinds(stmt, NUM_ROWS, 1, &stringColVar, permutation) < 0)
+        return dpiTestCase_setFailedFromError(testCase);
+    for (i = 0; i < NUM_ROWS; i++) {
+        if (dpiTestCase_expectUintEqual(testCase, permutation[i],
+                NUM_ROWS - 1 - i) < 0)
+            return DPI_FAILURE;
+        if (dpiTestCase_expectIntEqual(testCase, intColValue[i].value.asInt64,
+                intValues[NUM_ROWS - 1 - i]) < 0)
+            return DPI_FAILURE;
+    }
+
+    // execute and verify the batch errors refer to the original rows
+    if (dpiStmt_executeMany(stmt, DPI_MODE_EXEC_BATCH_ERRORS, NUM_ROWS) < 0)
+        return dpiTestCase_setFailedFromError(testCase);
+    if (dpiStmt_getBatchErrorCount(stmt, &count) < 0)
+        return dpiTestCase_setFailedFromError(testCase);
+    if (dpiTestCase_expectUintEqual(testCase, count, NUM_ERR) < 0)
+        return DPI_FAILURE;
+    if (dpiStmt_getBatchErrors(stmt, NUM_ERR, errorInfo) < 0)
+        return dpiTestCase_setFailedFromError(testCase);
+    if (dpiTestCase_expectUintEqual(testCase, errorInfo[0].offset, 1) < 0)
+        return DPI_FAILURE;
+    if (dpiTestCase_expectUintEqual(testCase, errorInfo[1].offset, 0) < 0)
+        return DPI_FAILURE;
+
+    // cleanup
+    if (dpiVar_release(intColVar) < 0)
+        return dpiTestCase_setFailedFromError(testCase);
+    if (dpiVar_release(stringColVar) < 0)
+        return dpiTestCase_setFailedFromError(testCase);
+    if (dpiStmt_release(stmt) < 0)
+        return dpiTestCase_setFailedFromError(testCase);
+
+    return DPI_SUCCESS;
+}
+
+
+//-----------------------------------------------------------------------------
+// dpiTest_2304_verifyBatchStopsAtFirstError()
+//   Prepare a batch of three statements, the second of which fails; call
+// dpiBatch_execute() with mode set to DPI_MODE_EXEC_DEFAULT and confirm that
+// the error raised is that of the second statement and that the third
+// statement was not executed.
+//-----------------------------------------------------------------------------
+int dpiTest_2304_verifyBatchStopsAtFirstError(dpiTestCase *testCase,
+        dpiTestParams *params)
+{
+    uint64_t expectedRowCounts[NUM_ROWS] = { 1, 0, 0 }, *rowCounts;
+    uint32_t numRowCounts, i;
+    dpiErrorInfo errorInfo;
+    dpiBatch *batch;
+    dpiConn *conn;
+
+    if (dpiTestCase_getConnection(testCase, &conn) < 0)
+        return DPI_FAILURE;
+    if (dpiTest__truncateTable(testCase, conn) < 0)
+        return DPI_FAILURE;
+    if (dpiTest__prepareBatchWithError(testCase, conn, &batch) < 0)
+        return DPI_FAILURE;
+    if (dpiBatch_execute(batch, DPI_MODE_EXEC_DEFAULT) == DPI_SUCCESS)
+        return dpiTestCase_setFailed(testCase, "Expected error ORA-00001.");
+    dpiTestSuite_getErrorInfo(&errorInfo);
+    if (dpiTestCase_expectIntEqual(testCase, errorInfo.code, 1) < 0)
+        return DPI_FAILURE;
+    if (dpiTestCase_expectUintEqual(testCase, errorInfo.offset, 1) < 0)
+        return DPI_FAILURE;
+    if (dpiBatch_getRowCounts(batch, &numRowCounts, &rowCounts) < 0)
+        return dpiTestCase_setFailedFromError(testCase);
+    if (dpiTestCase_expectUintEqual(testCase, numRowCounts, NUM_ROWS) < 0)
+        return DPI_FAILURE;
+    for (i = 0; i < NUM_ROWS; i++) {
+        if (dpiTestCase_expectUintEqual(testCase, rowCounts[i],
+                expectedRowCounts[i]) < 0)
+            return DPI_FAILURE;
+    }
+    if (dpiBatch_release(batch) < 0)
+        return dpiTestCase_setFailedFromError(testCase);
+
+    return DPI_SUCCESS;
+}
+
+
+//-----------------------------------------------------------------------------
+// dpiTest_2305_verifyBatchErrorsMappedToStatements()
+//   Prepare a batch of three statements, the second of which fails; call
+// dpiBatch_execute() with mode set to DPI_MODE_EXEC_BATCH_ERRORS; confirm
+// that one error is returned by dpiBatch_getErrors() with an offset
+// identifying the second statement and that the row counts returned by
+// dpiBatch_getRowCounts() match expectations (no error).
+//-----------------------------------------------------------------------------
+int dpiTest_2305_verifyBatchErrorsMappedToStatements(dpiTestCase *testCase,
+        dpiTestParams *params)
+{
+    uint64_t expectedRowCounts[NUM_ROWS] = { 1, 0, 1 }, *rowCounts;
+    uint32_t numRowCounts, count, i;
+    dpiErrorInfo errorInfo;
+    dpiBatch *batch;
+    dpiConn *conn;
+
+    if (dpiTestCase_getConnection(testCase, &conn) < 0)
+        return DPI_FAILURE;
+    if (dpiTest__truncateTable(testCase, conn) < 0)
+        return DPI_FAILURE;
+    if (dpiTest__prepareBatchWithError(testCase, conn, &batch) < 0)
+        return DPI_FAILURE;
+    if (dpiBatch_execute(batch, DPI_MODE_EXEC_BATCH_ERRORS) < 0)
+        return dpiTestCase_setFailedFromError(testCase);
+    if (dpiBatch_getErrorCount(batch, &count) < 0)
+        return dpiTestCase_setFailedFromError(testCase);
+    if (dpiTestCase_expectUintEqual(testCase, count, 1) < 0)
+        return DPI_FAILURE;
+    if (dpiBatch_getErrors(batch, 1, &errorInfo) < 0)
+        return dpiTestCase_setFailedFromError(testCase);
+    if (dpiTestCase_expectIntEqual(testCase, errorInfo.code, 1) < 0)
+        return DPI_FAILURE;
+    if (dpiTestCase_expectUintEqual(testCase, errorInfo.offset, 1) < 0)
+        return DPI_FAILURE;
+    if (dpiBatch_getRowCounts(batch, &numRowCounts, &rowCounts) < 0)
+        return dpiTestCase_setFailedFromError(testCase);
+    if (dpiTestCase_expectUintEqual(testCase, numRowCounts, NUM_ROWS) < 0)
+        return DPI_FAILURE;
+    for (i = 0; i < NUM_ROWS; i++) {
+        if (dpiTestCase_expectUintEqual(testCase, rowCounts[i],
+                expectedRowCounts[i]) < 0)
+            return DPI_FAILURE;
+    }
+    if (dpiBatch_release(batch) < 0)
+        return dpiTestCase_setFailedFromError(testCase);
+
+    return DPI_SUCCESS;
+}
+
+
+//-----------------------------------------------------------------------------
+// dpiTest_2306_verifyBatchRejectsQuery()
+//   Prepare a query and call dpiBatch_addStmt() (error DPI-1069).
+//-----------------------------------------------------------------------------
+int dpiTest_2306_verifyBatchRejectsQuery(dpiTestCase *testCase,
+        dpiTestParams *params)
+{
+    const char *expectedError = "DPI-1069: only DML statements without a "
+            "RETURNING INTO clause can be added to a batch";
+    const char *sql = "select IntCol from TestTempTable";
+    dpiBatch *batch;
+    dpiStmt *stmt;
+    dpiConn *conn;
+
+    if (dpiTestCase_getConnection(testCase, &conn) < 0)
+        return DPI_FAILURE;
+    if (dpiConn_newBatch(conn, &batch) < 0)
+        return dpiTestCase_setFailedFromError(testCase);
+    if (dpiConn_prepareStmt(conn, 0, sql, strlen(sql), NULL, 0, &stmt) < 0)
+        return dpiTestCase_setFailedFromError(testCase);
+    dpiBatch_addStmt(batch, stmt);
+    if (dpiTestCase_expectError(testCase, expectedError) < 0)
+        return DPI_FAILURE;
+    if (dpiStmt_release(stmt) < 0)
+        return dpiTestCase_setFailedFromError(testCase);
+    if (dpiBatch_release(batch) < 0)
+        return dpiTestCase_setFailedFromError(testCase);
+
+    return DPI_SUCCESS;
+}
+
+
+//-----------------------------------------------------------------------------
+// dpiTest_2307_verifyBatchWithUnboundVariable()
+//   Add a statement to a batch without binding its variable and call
+// dpiBatch_execute() (error DPI-1071).
+//-----------------------------------------------------------------------------
+int dpiTest_2307_verifyBatchWithUnboundVariable(dpiTestCase *testCase,
+        dpiTestParams *params)
+{
+    const char *expectedError = "DPI-1071: no variable is bound to :1 of "
+            "statement 0 in the batch";
+    const char *sql = "delete from TestTempTable where IntCol = :1";
+    dpiBatch *batch;
+    dpiStmt *stmt;
+    dpiConn *conn;
+
+    if (dpiTestCase_getConnection(testCase, &conn) < 0)
+        return DPI_FAILURE;
+    if (dpiConn_newBatch(conn, &batch) < 0)
+        return dpiTestCase_setFailedFromError(testCase);
+    if (dpiConn_prepareStmt(conn, 0, sql, strlen(sql), NULL, 0, &stmt) < 0)
+        return dpiTestCase_setFailedFromError(testCase);
+    if (dpiBatch_addStmt(batch, stmt) < 0)
+        return dpiTestCase_setFailedFromError(testCase);
+    dpiBatch_execute(batch, DPI_MODE_EXEC_DEFAULT);
+    if (dpiTestCase_expectError(testCase, expectedError) < 0)
+        return DPI_FAILURE;
+    if (dpiStmt_release(stmt) < 0)
+        return dpiTestCase_setFailedFromError(testCase);
+    if (dpiBatch_release(batch) < 0)
+        return dpiTestCase_setFailedFromError(testCase);
+
+    return DPI_SUCCESS;
+}
+
+
+//-----------------------------------------------------------------------------
+// dpiTest_2308_verifyBatchWithMultiRowVariable()
+//   Add a statement to a batch after binding a variable with an array size
+// greater than 1 to it and call dpiBatch_execute() (error DPI-1073).
+//-----------------------------------------------------------------------------
+int dpiTest_2308_verifyBatchWithMultiRowVariable(dpiTestCase *testCase,
+        dpiTestParams *params)
+{
+    const char *expectedError = "DPI-1073: variable bound to :1 of "
+            "statement 0 in the batch must have an array size of 1 and cannot "
+            "be dynamically sized";
+    const char *sql = "delete from TestTempTable where IntCol = :1";
+    dpiData *intColValue;
+    dpiVar *intColVar;
+    dpiBatch *batch;
+    dpiStmt *stmt;
+    dpiConn *conn;
+
+    if (dpiTestCase_getConnection(testCase, &conn) < 0)
+        return DPI_FAILURE;
+    if (dpiConn_newBatch(conn, &batch) < 0)
+        return dpiTestCase_setFailedFromError(testCase);
+    if (dpiConn_newVar(conn, DPI_ORACLE_TYPE_NATIVE_INT, DPI_NATIVE_TYPE_INT64,
+            NUM_ROWS, 0, 0, 0, NULL, &intColVar, &intColValue) < 0)
+        return dpiTestCase_setFailedFromError(testCase);
+    if (dpiConn_prepareStmt(conn, 0, sql, strlen(sql), NULL, 0, &stmt) < 0)
+        return dpiTestCase_setFailedFromError(testCase);
+    if (dpiStmt_bindByPos(stmt, 1, intColVar) < 0)
+        return dpiTestCase_setFailedFromError(testCase);
+    if (dpiBatch_addStmt(batch, stmt) < 0)
+        return dpiTestCase_setFailedFromError(testCase);
+    dpiBatch_execute(batch, DPI_MODE_EXEC_DEFAULT);
+    if (dpiTestCase_expectError(testCase, expectedError) < 0)
+        return DPI_FAILURE;
+    if (dpiVar_release(intColVar) < 0)
+        return dpiTestCase_setFailedFromError(testCase);
+    if (dpiStmt_release(stmt) < 0)
+        return dpiTestCase_setFailedFromError(testCase);
+    if (dpiBatch_release(batch) < 0)
+        return dpiTestCase_setFailedFromError(testCase);
+
+    return DPI_SUCCESS;
+}
+
+
+//-----------------------------------------------------------------------------
+// dpiTest_2309_verifySortBindsWithNumberAsBytes()
+//   Bind a NUMBER variable with native type DPI_NATIVE_TYPE_BYTES and call
+// dpiStmt_sortBinds() using it as the key (error DPI-1075).
+//-----------------------------------------------------------------------------
+int dpiTest_2309_verifySortBindsWithNumberAsBytes(dpiTestCase *testCase,
+        dpiTestParams *params)
+{
+    const char *expectedError = "DPI-1075: sort key 0 contains numbers as "
+            "bytes which cannot be sorted numerically";
+    const char *sql = "delete from TestTempTable where IntCol = :1";
+    const char *values[NUM_ROWS] = { "9", "10", "8" };
+    dpiData *intColValue;
+    dpiVar *intColVar;
+    dpiStmt *stmt;
+    dpiConn *conn;
+    uint32_t i;
+
+    if (dpiTestCase_getConnection(testCase, &conn) < 0)
+        return DPI_FAILURE;
+    if (dpiConn_prepareStmt(conn, 0, sql, strlen(sql), NULL, 0, &stmt) < 0)
+        return dpiTestCase_setFailedFromError(testCase);
+    if (dpiConn_newVar(conn, DPI_ORACLE_TYPE_NUMBER, DPI_NATIVE_TYPE_BYTES,
+            NUM_ROWS, 0, 0, 0, NULL, &intColVar, &intColValue) < 0)
+        return dpiTestCase_setFailedFromError(testCase);
+    if (dpiStmt_bindByPos(stmt, 1, intColVar) < 0)
+        return dpiTestCase_setFailedFromError(testCase);
+    for (i = 0; i < NUM_ROWS; i++) {
+        if (dpiVar_setFromBytes(intColVar, i, values[i],
+                strlen(values[i])) < 0)
+            return dpiTestCase_setFailedFromError(testCase);
+    }
+    dpiStmt_sortBinds(stmt, NUM_ROWS, 1, &intColVar, NULL);
+    if (dpiTestCase_expectError(testCase, expectedError) < 0)
+        return DPI_FAILURE;
+    if (dpiVar_release(intColVar) < 0)
+        return dpiTestCase_setFailedFromError(testCase);
+    if (dpiStmt_release(stmt) < 0)
+        return dpiTestCase_setFailedFromError(testCase);
+
+    return DPI_SUCCESS;
+}
+
+
 //-----------------------------------------------------------------------------
 // main()
 //-----------------------------------------------------------------------------
@@ -210,6 +593,20 @@ int main(int argc, char **argv)
             "dpiStmt_getBatchErrors() returns expected results");
     dpiTestSuite_addCase(dpiTest_2302_verifyGetBatchErrorsWithLesserNumErrVal,
             "dpiStmt_getBatchErrors() with numErrors less than required");
+    dpiTestSuite_addCase(dpiTest_2303_verifyBatchErrOffsetsAfterSortBinds,
+            "dpiStmt_sortBinds() maps batch error offsets to original rows");
+    dpiTestSuite_addCase(dpiTest_2304_verifyBatchStopsAtFirstError,
+            "dpiBatch_execute() stops at the first error");
+    dpiTestSuite_addCase(dpiTest_2305_verifyBatchErrorsMappedToStatements,
+            "dpiBatch_getErrors() maps errors to statements");
+    dpiTestSuite_addCase(dpiTest_2306_verifyBatchRejectsQuery,
+            "dpiBatch_addStmt() with a query");
+    dpiTestSuite_addCase(dpiTest_2307_verifyBatchWithUnboundVariable,
+            "dpiBatch_execute() with a variable which is not bound");
+    dpiTestSuite_addCase(dpiTest_2308_verifyBatchWithMultiRowVariable,
+            "dpiBatch_execute() with a variable with many rows");
+    dpiTestSuite_addCase(dpiTest_2309_verifySortBindsWithNumberAsBytes,
+            "dpiStmt_sortBinds() with a number variable as bytes");
     return dpiTestSuite_run();
 }
 
@@ -16,6 +16,70 @@
 
 #include "TestLib.h"
 
+// structure used for recording the calls seen by an interposer
+typedef struct {
+    uint32_t numCalls;
+    uint32_t numFailed;
+    int32_t errorNum;
+    char lastFnName[64];
+} dpiTestInterposer;
+
+
+//-----------------------------------------------------------------------------
+// dpiTest__afterCall() [INTERNAL]
+//   Record the completion of a call made through the interposer.
+//-----------------------------------------------------------------------------
+static void dpiTest__afterCall(void *context, const dpiInterposeCallInfo *info)
+{
+    dpiTestInterposer *interposer = (dpiTestInterposer*) context;
+
+    interposer->numCalls++;
+    if (info->failed)
+        interposer->numFailed++;
+    strncpy(interposer->lastFnName, info->fnName,
+            sizeof(interposer->lastFnName) - 1);
+}
+
+
+//-----------------------------------------------------------------------------
+// dpiTest__beforeCall() [INTERNAL]
+//   Return the error number which the interposer is configured to inject (or
+// zero if the call is to be made).
+//-----------------------------------------------------------------------------
+static int32_t dpiTest__beforeCall(void *context,
+        const dpiInterposeCallInfo *info)
+{
+    dpiTestInterposer *interposer = (dpiTestInterposer*) context;
+
+    return interposer->errorNum;
+}
+
+
+//-----------------------------------------------------------------------------
+// dpiTest__setInterposer() [INTERNAL]
+//   Install an interposer for the given call classes which records calls in
+// the given structure.
+//-----------------------------------------------------------------------------
+static int dpiTest__setInterposer(dpiTestCase *testCase,
+        uint32_t callClasses, dpiTestInterposer *interposer)
+{
+    dpiInterposeParams params;
+    dpiContext *context;
+
+    memset(interposer, 0, sizeof(dpiTestInterposer));
+    dpiTestSuite_getContext(&context);
+    if (dpiContext_initInterposeParams(context, &params) < 0)
+        return dpiTestCase_setFailedFromError(testCase);
+    params.callClasses = callClasses;
+    params.beforeCall = dpiTest__beforeCall;
+    params.afterCall = dpiTest__afterCall;
+    params.callbackContext = interposer;
+    if (dpiContext_setInterposer(context, &params) < 0)
+        return dpiTestCase_setFailedFromError(testCase);
+    return DPI_SUCCESS;
+}
+
+
 //-----------------------------------------------------------------------------
 // dpiTest_100_validMajorMinor()
 //   Verify that dpiContext_create() succeeds when valid major and minor
@@ -125,6 +189,114 @@ int dpiTest_105_destroyTwice(dpiTestCase *testCase, dpiTestParams *params)
 }
 
 
+//-----------------------------------------------------------------------------
+// dpiTest_106_interposeRoundTrips()
+//   Install an interposer for calls requiring round trips and verify that a
+// ping is seen by it; install it for LOB calls only and verify that a ping is
+// not seen; remove it and verify that a ping is no longer seen.
+//-----------------------------------------------------------------------------
+int dpiTest_106_interposeRoundTrips(dpiTestCase *testCase,
+        dpiTestParams *params)
+{
+    dpiTestInterposer interposer;
+    dpiContext *context;
+    dpiConn *conn;
+
+    if (dpiTestCase_getConnection(testCase, &conn) < 0)
+        return DPI_FAILURE;
+    if (dpiTest__setInterposer(testCase, DPI_INTERPOSE_CALL_ROUND_TRIP,
+            &interposer) < 0)
+        return DPI_FAILURE;
+    if (dpiConn_ping(conn) < 0)
+        return dpiTestCase_setFailedFromError(testCase);
+    if (dpiTestCase_expectUintEqual(testCase, interposer.numCalls, 1) < 0)
+        return DPI_FAILURE;
+    if (dpiTestCase_expectStringEqual(testCase, interposer.lastFnName,
+            strlen(interposer.lastFnName), "OCIPing", 7) < 0)
+        return DPI_FAILURE;
+    if (dpiTest__setInterposer(testCase, DPI_INTERPOSE_CALL_LOB,
+            &interposer) < 0)
+        return DPI_FAILURE;
+    if (dpiConn_ping(conn) < 0)
+        return dpiTestCase_setFailedFromError(testCase);
+    if (dpiTestCase_expectUintEqual(testCase, interposer.numCalls, 0) < 0)
+        return DPI_FAILURE;
+    dpiTestSuite_getContext(&context);
+    if (dpiContext_setInterposer(context, NULL) < 0)
+        return dpiTestCase_setFailedFromError(testCase);
+    if (dpiConn_ping(conn) < 0)
+        return dpiTestCase_setFailedFromError(testCase);
+    return dpiTestCase_expectUintEqual(testCase, interposer.numCalls, 0);
+}
+
+
+//-----------------------------------------------------------------------------
+// dpiTest_107_interposeInjectError()
+//   Install an interposer which injects an error in place of calls requiring
+// round trips and verify that the error is raised (error ORA-01013) and that
+// no round trip is counted for the call that was not made.
+//-----------------------------------------------------------------------------
+int dpiTest_107_interposeInjectError(dpiTestCase *testCase,
+        dpiTestParams *params)
+{
+    const char *expectedError = "ORA-01013: error injected by interposer";
+    uint64_t roundTripsBefore, roundTripsAfter;
+    dpiTestInterposer interposer;
+    dpiContext *context;
+    dpiConn *conn;
+    int status;
+
+    if (dpiTestCase_getConnection(testCase, &conn) < 0)
+        return DPI_FAILURE;
+    if (dpiTest__setInterposer(testCase, DPI_INTERPOSE_CALL_ROUND_TRIP,
+            &interposer) < 0)
+        return DPI_FAILURE;
+    if (dpiConn_getRoundTrips(conn, &roundTripsBefore) < 0)
+        return dpiTestCase_setFailedFromError(testCase);
+    interposer.errorNum = 1013;
+    dpiConn_ping(conn);
+    status = dpiTestCase_expectError(testCase, expectedError);
+    dpiTestSuite_getContext(&context);
+    if (dpiContext_setInterposer(context, NULL) < 0)
+        return dpiTestCase_setFailedFromError(testCase);
+    if (status < 0)
+        return DPI_FAILURE;
+    if (dpiTestCase_expectUintEqual(testCase, interposer.numFailed, 1) < 0)
+        return DPI_FAILURE;
+    if (dpiConn_getRoundTrips(conn, &roundTripsAfter) < 0)
+        return dpiTestCase_setFailedFromError(testCase);
+    if (dpiTestCase_expectUintEqual(testCase, roundTripsAfter,
+            roundTripsBefore) < 0)
+        return DPI_FAILURE;
+    if (dpiConn_ping(conn) < 0)
+        return dpiTestCase_setFailedFromError(testCase);
+    return DPI_SUCCESS;
+}
+
+
+//-----------------------------------------------------------------------------
+// dpiTest_108_interposeInvalidVersion()
+//   Call dpiContext_setInterposer() with a version of the interposer
+// parameters which is not supported (error DPI-1065).
+//-----------------------------------------------------------------------------
+int dpiTest_108_interposeInvalidVersion(dpiTestCase *testCase,
+        dpiTestParams *params)
+{
+    dpiInterposeParams interposeParams;
+    char expectedError[200];
+    dpiContext *context;
+
+    dpiTestSuite_getContext(&context);
+    if (dpiContext_initInterposeParams(context, &interposeParams) < 0)
+        return dpiTestCase_setFailedFromError(testCase);
+    interposeParams.version = DPI_INTERPOSE_VERSION + 1;
+    dpiContext_setInterposer(context, &interposeParams);
+    sprintf(expectedError, "DPI-1065: interposer version %d is not supported "
+            "(expected %d)", DPI_INTERPOSE_VERSION + 1, DPI_INTERPOSE_VERSION);
+    return dpiTestCase_expectError(testCase, expectedError);
+}
+
+
 //-----------------------------------------------------------------------------
 // main()
 //-----------------------------------------------------------------------------
@@ -143,6 +315,12 @@ int main(int argc, char **argv)
             "dpiContext_destroy() with NULL pointer");
     dpiTestSuite_addCase(dpiTest_105_destroyTwice,
             "dpiContext_destroy() called twice on same pointer");
+    dpiTestSuite_addCase(dpiTest_106_interposeRoundTrips,
+            "dpiContext_setInterposer() for calls requiring round trips");
+    dpiTestSuite_addCase(dpiTest_107_interposeInjectError,
+            "dpiContext_setInterposer() with an injected error");
+    dpiTestSuite_addCase(dpiTest_108_interposeInvalidVersion,
+            "dpiContext_setInterposer() with an unsupported version");
     return dpiTestSuite_run();
 }
 
@@ -31,6 +31,70 @@ static int dpiTest__expectErrorInvalidOracleType(dpiTestCase *testCase,
 }
 
 
+//-----------------------------------------------------------------------------
+// dpiTest__transferFile() [INTERNAL]
+//   Write a file of the given size to a temporary BLOB with
+// dpiLob_writeFromFd(), read it back into a second file with
+// dpiLob_readToFd() and verify that the contents of the two files match.
+//-----------------------------------------------------------------------------
+static int dpiTest__transferFile(dpiTestCase *testCase, dpiConn *conn,
+        dpiLobTransferMode mode, uint32_t fileSize)
+{
+    char *sourceData, *targetData;
+    FILE *sourceFile, *targetFile;
+    uint64_t numBytes, lobSize;
+    uint32_t i;
+    dpiLob *lob;
+
+    // populate the source file
+    sourceData = malloc(fileSize);
+    targetData = malloc(fileSize);
+    if (!sourceData || !targetData)
+        return dpiTestCase_setFailed(testCase, "Out of memory.");
+    for (i = 0; i < fileSize; i++)
+        sourceData[i] = (char) ((i * 31) % 251);
+    sourceFile = tmpfile();
+    targetFile = tmpfile();
+    if (!sourceFile || !targetFile)
+        return dpiTestCase_setFailed(testCase, "Unable to create file.");
+    if (fwrite(sourceData, 1, fileSize, sourceFile) != fileSize ||
+            fflush(sourceFile) != 0)
+        return dpiTestCase_setFailed(testCase, "Unable to write file.");
+    rewind(sourceFile);
+
+    // transfer the file to the LOB and back to the target file
+    if (dpiConn_newTempLob(conn, DPI_ORACLE_TYPE_BLOB, &lob) < 0)
+        return dpiTestCase_setFailedFromError(testCase);
+    if (dpiLob_writeFromFd(lob, 1, fileno(sourceFile), mode, &numBytes) < 0)
+        return dpiTestCase_setFailedFromError(testCase);
+    if (dpiTestCase_expectUintEqual(testCase, numBytes, fileSize) < 0)
+        return DPI_FAILURE;
+    if (dpiLob_getSize(lob, &lobSize) < 0)
+        return dpiTestCase_setFailedFromError(testCase);
+    if (dpiTestCase_expectUintEqual(testCase, lobSize, fileSize) < 0)
+        return DPI_FAILURE;
+    if (dpiLob_readToFd(lob, 1, fileno(targetFile), mode, &numBytes) < 0)
+        return dpiTestCase_setFailedFromError(testCase);
+    if (dpiTestCase_expectUintEqual(testCase, numBytes, fileSize) < 0)
+        return DPI_FAILURE;
+    if (dpiLob_release(lob) < 0)
+        return dpiTestCase_setFailedFromError(testCase);
+
+    // verify the contents of the target file
+    rewind(targetFile);
+    if (fread(targetData, 1, fileSize, targetFile) != fileSize)
+        return dpiTestCase_setFailed(testCase, "Unable to read file.");
+    if (memcmp(sourceData, targetData, fileSize) != 0)
+        return dpiTestCase_setFailed(testCase, "File contents do not match.");
+    fclose(sourceFile);
+    fclose(targetFile);
+    free(sourceData);
+    free(targetData);
+
+    return DPI_SUCCESS;
+}
+
+
 //-----------------------------------------------------------------------------
 // dpiTest_1900_createAllTypesOfLobs()
 //   Call dpiConn_newTempLob() for lobType values of DPI_ORACLE_TYPE_CLOB,
@@ -150,6 +214,9 @@ int dpiTest_1903_closeLobAndVerifyPubFuncsOfLobs(dpiTestCase *testCase,
     if (dpiTestCase_expectError(testCase, expectedError) < 0)
         return DPI_FAILURE;
     dpiLob_readBytes(lob, 0, 0, NULL, NULL);
+    if (dpiTestCase_expectError(testCase, expectedError) < 0)
+        return DPI_FAILURE;
+    dpiLob_readToFd(lob, 0, 0, DPI_MODE_LOB_TRANSFER_DEFAULT, NULL);
     if (dpiTestCase_expectError(testCase, expectedError) < 0)
         return DPI_FAILURE;
     dpiLob_setDirectoryAndFileName(lob, NULL, 0, NULL, 0);
@@ -164,7 +231,142 @@ int dpiTest_1903_closeLobAndVerifyPubFuncsOfLobs(dpiTestCase *testCase,
     dpiLob_writeBytes(lob, 0, NULL, 0);
     if (dpiTestCase_expectError(testCase, expectedError) < 0)
         return DPI_FAILURE;
+    dpiLob_writeFromFd(lob, 0, 0, DPI_MODE_LOB_TRANSFER_DEFAULT, NULL);
+    if (dpiTestCase_expectError(testCase, expectedError) < 0)
+        return DPI_FAILURE;
+
+    return DPI_SUCCESS;
+}
+
+
+//-----------------------------------------------------------------------------
+// dpiTest_1904_transferFileToBlobAndBack()
+//   Call dpiConn_newTempLob() for a BLOB; call dpiLob_writeFromFd() with a
+// file spanning several transfer blocks and then dpiLob_readToFd() (no error)
+// and verify that the file contents are unchanged.
+//-----------------------------------------------------------------------------
+int dpiTest_1904_transferFileToBlobAndBack(dpiTestCase *testCase,
+        dpiTestParams *params)
+{
+    dpiConn *conn;
+
+    if (dpiTestCase_getConnection(testCase, &conn) < 0)
+        return DPI_FAILURE;
+    if (dpiTest__transferFile(testCase, conn, DPI_MODE_LOB_TRANSFER_DEFAULT,
+            2500000) < 0)
+        return DPI_FAILURE;
+    return dpiTest__transferFile(testCase, conn, DPI_MODE_LOB_TRANSFER_DEFAULT,
+            0);
+}
+
+
+//-----------------------------------------------------------------------------
+// dpiTest_1905_transferFileWithOverlappedIO()
+//   Create a connection in threaded mode so that file I/O is performed in a
+// separate thread; call dpiLob_writeFromFd() and dpiLob_readToFd(), first
+// with caching disabled and then with direct I/O requested (no error), and
+// verify that the file contents are unchanged.
+//-----------------------------------------------------------------------------
+int dpiTest_1905_transferFileWithOverlappedIO(dpiTestCase *testCase,
+        dpiTestParams *params)
+{
+    dpiCommonCreateParams commonParams;
+    dpiContext *context;
+    dpiConn *conn;
 
+    dpiTestSuite_getContext(&context);
+    if (dpiContext_initCommonCreateParams(context, &commonParams) < 0)
+        return dpiTestCase_setFailedFromError(testCase);
+    commonParams.createMode = DPI_MODE_CREATE_THREADED;
+    if (dpiConn_create(context, params->mainUserName,
+            params->mainUserNameLength, params->mainPassword,
+            params->mainPasswordLength, params->connectString,
+            params->connectStringLength, &commonParams, NULL, &conn) < 0)
+        return dpiTestCase_setFailedFromError(testCase);
+    if (dpiTest__transferFile(testCase, conn, DPI_MODE_LOB_TRANSFER_NO_CACHE,
+            2500000) < 0)
+        return DPI_FAILURE;
+    if (dpiTest__transferFile(testCase, conn, DPI_MODE_LOB_TRANSFER_DIRECT,
+            2500000) < 0)
+        return DPI_FAILURE;
+    if (dpiConn_release(conn) < 0)
+        return dpiTestCase_setFailedFromError(testCase);
+    return DPI_SUCCESS;
+}
+
+
+//-----------------------------------------------------------------------------
+// dpiTest_1906_transferFileToClob()
+//   Call dpiConn_newTempLob() for a CLOB; call dpiLob_writeFromFd() (error
+// DPI-1067).
+//-----------------------------------------------------------------------------
+int dpiTest_1906_transferFileToClob(dpiTestCase *testCase,
+        dpiTestParams *params)
+{
+    uint64_t numBytes;
+    dpiConn *conn;
+    dpiLob *lob;
+
+    if (dpiTestCase_getConnection(testCase, &conn) < 0)
+        return DPI_FAILURE;
+    if (dpiConn_newTempLob(conn, DPI_ORACLE_TYPE_CLOB, &lob) < 0)
+        return dpiTestCase_setFailedFromError(testCase);
+    dpiLob_writeFromFd(lob, 1, 0, DPI_MODE_LOB_TRANSFER_DEFAULT, &numBytes);
+    if (dpiTestCase_expectError(testCase, "DPI-1067: transfers between LOBs "
+            "and files are only supported for binary LOBs") < 0)
+        return DPI_FAILURE;
+    if (dpiLob_release(lob) < 0)
+        return dpiTestCase_setFailedFromError(testCase);
+    return DPI_SUCCESS;
+}
+
+
+//-----------------------------------------------------------------------------
+// dpiTest_1907_transferFileWithInvalidOffset()
+//   Call dpiConn_newTempLob() for a BLOB and populate it; call
+// dpiLob_readToFd() with an offset of 0 and with an offset more than one past
+// the end of the LOB (error DPI-1076); call dpiLob_readToFd() with an offset
+// one past the end of the LOB and verify that no data is transferred (no
+// error).
+//-----------------------------------------------------------------------------
+int dpiTest_1907_transferFileWithInvalidOffset(dpiTestCase *testCase,
+        dpiTestParams *params)
+{
+    const char *expectedError = "DPI-1076: LOB offset must be at least 1 and "
+            "cannot be more than one past the end of the LOB";
+    const char *value = "LOB data";
+    uint64_t numBytes, offset;
+    FILE *targetFile;
+    dpiConn *conn;
+    dpiLob *lob;
+
+    if (dpiTestCase_getConnection(testCase, &conn) < 0)
+        return DPI_FAILURE;
+    if (dpiConn_newTempLob(conn, DPI_ORACLE_TYPE_BLOB, &lob) < 0)
+        return dpiTestCase_setFailedFromError(testCase);
+    if (dpiLob_setFromBytes(lob, value, strlen(value)) < 0)
+        return dpiTestCase_setFailedFromError(testCase);
+    targetFile = tmpfile();
+    if (!targetFile)
+        return dpiTestCase_setFailed(testCase, "Unable to create file.");
+    dpiLob_readToFd(lob, 0, fileno(targetFile),
+            DPI_MODE_LOB_TRANSFER_DEFAULT, &numBytes);
+    if (dpiTestCase_expectError(testCase, expectedError) < 0)
+        return DPI_FAILURE;
+    offset = strlen(value) + 2;
+    dpiLob_readToFd(lob, offset, fileno(targetFile),
+            DPI_MODE_LOB_TRANSFER_DEFAULT, &numBytes);
+    if (dpiTestCase_expectError(testCase, expectedError) < 0)
+        return DPI_FAILURE;
+    offset = strlen(value) + 1;
+    if (dpiLob_readToFd(lob, offset, fileno(targetFile),
+            DPI_MODE_LOB_TRANSFER_DEFAULT, &numBytes) < 0)
+        return dpiTestCase_setFailedFromError(testCase);
+    if (dpiTestCase_expectUintEqual(testCase, numBytes, 0) < 0)
+        return DPI_FAILURE;
+    fclose(targetFile);
+    if (dpiLob_release(lob) < 0)
+        return dpiTestCase_setFailedFromError(testCase);
     return DPI_SUCCESS;
 }
 
@@ -183,6 +385,14 @@ int main(int argc, char **argv)
             "call dpiLob_release() twice");
     dpiTestSuite_addCase(dpiTest_1903_closeLobAndVerifyPubFuncsOfLobs,
             "call all LOB public functions after closing the lob");
+    dpiTestSuite_addCase(dpiTest_1904_transferFileToBlobAndBack,
+            "transfer a file to a BLOB and back");
+    dpiTestSuite_addCase(dpiTest_1905_transferFileWithOverlappedIO,
+            "transfer a file to a BLOB and back in threaded mode");
+    dpiTestSuite_addCase(dpiTest_1906_transferFileToClob,
+            "transfer a file to a CLOB");
+    dpiTestSuite_addCase(dpiTest_1907_transferFileWithInvalidOffset,
+            "transfer a BLOB to a file with invalid offsets");
     return dpiTestSuite_run();
 }
 
@@ -476,6 +476,47 @@ int dpiTest_1310_verifyTypeInfoOfRecordType(dpiTestCase *testCase,
 }
 
 
+//-----------------------------------------------------------------------------
+// dpiTest_1311_verifyObjTypeIsCached()
+//   Call dpiConn_getObjectType() twice with the same name and verify that the
+// same object type is returned; release both references and verify that the
+// object type can be looked up again (no error).
+//-----------------------------------------------------------------------------
+int dpiTest_1311_verifyObjTypeIsCached(dpiTestCase *testCase,
+        dpiTestParams *params)
+{
+    const char *objStr = "UDT_OBJECT";
+    dpiObjectType *objType1, *objType2;
+    dpiObjectTypeInfo typeInfo;
+    dpiConn *conn;
+
+    if (dpiTestCase_getConnection(testCase, &conn) < 0)
+        return DPI_FAILURE;
+    if (dpiConn_getObjectType(conn, objStr, strlen(objStr), &objType1) < 0)
+        return dpiTestCase_setFailedFromError(testCase);
+    if (dpiConn_getObjectType(conn, objStr, strlen(objStr), &objType2) < 0)
+        return dpiTestCase_setFailedFromError(testCase);
+    if (objType1 != objType2)
+        return dpiTestCase_setFailed(testCase,
+                "object type not returned from cache");
+    if (dpiObjectType_release(objType1) < 0)
+        return dpiTestCase_setFailedFromError(testCase);
+    if (dpiObjectType_release(objType2) < 0)
+        return dpiTestCase_setFailedFromError(testCase);
+    if (dpiConn_getObjectType(conn, objStr, strlen(objStr), &objType1) < 0)
+        return dpiTestCase_setFailedFromError(testCase);
+    if (dpiObjectType_getInfo(objType1, &typeInfo) < 0)
+        return dpiTestCase_setFailedFromError(testCase);
+    if (dpiTest__verifyObjectTypeInfo(testCase, &typeInfo,
+            params->mainUserName, objStr, 0, 0, 0, NULL, NUM_ATTRS) < 0)
+        return DPI_FAILURE;
+    if (dpiObjectType_release(objType1) < 0)
+        return dpiTestCase_setFailedFromError(testCase);
+
+    return DPI_SUCCESS;
+}
+
+
 //-----------------------------------------------------------------------------
 // main()
 //-----------------------------------------------------------------------------
@@ -504,6 +545,8 @@ int main(int argc, char **argv)
             "dpiObjectType_getInfo() of indexed-by binary integer table");
     dpiTestSuite_addCase(dpiTest_1310_verifyTypeInfoOfRecordType,
             "dpiObjectType_getInfo() of PL/SQL record type");
+    dpiTestSuite_addCase(dpiTest_1311_verifyObjTypeIsCached,
+            "dpiConn_getObjectType() returns cached object type");
     return dpiTestSuite_run();
 }
 
@@ -22,6 +22,23 @@
                         "end loop; " \
                     "end;"
 
+// structure used for collecting the JSON passed to a write callback
+typedef struct {
+    char data[512];
+    uint32_t length;
+} dpiTestJsonOutput;
+
+//-----------------------------------------------------------------------------
+// dpiTest__abortJson()
+//   Callback used for writing JSON which aborts the serialization.
+//-----------------------------------------------------------------------------
+static int dpiTest__abortJson(void *context, const char *data,
+        uint32_t dataLength)
+{
+    return -1;
+}
+
+
 //-----------------------------------------------------------------------------
 // dpiTest__expectErrorNotACollection()
 //   Verify that an error is raised and that it states that the error is not a
@@ -38,6 +55,23 @@ static int dpiTest__expectErrorNotACollection(dpiTestCase *testCase,
 }
 
 
+//-----------------------------------------------------------------------------
+// dpiTest__writeJson()
+//   Callback used for writing JSON which collects the pieces it is passed.
+//-----------------------------------------------------------------------------
+static int dpiTest__writeJson(void *context, const char *data,
+        uint32_t dataLength)
+{
+    dpiTestJsonOutput *output = (dpiTestJsonOutput*) context;
+
+    if (output->length + dataLength > sizeof(output->data))
+        return -1;
+    memcpy(output->data + output->length, data, dataLength);
+    output->length += dataLength;
+    return 0;
+}
+
+
 //-----------------------------------------------------------------------------
 // dpiTest_1400_releaseObjTwice()
 //   Call dpiObjectType_createObject(); call dpiObject_release() twice (error
@@ -1199,6 +1233,311 @@ int dpiTest_1427_verifySetAttrValueWithAttrAsNull(dpiTestCase *testCase,
 }
 
 
+//-----------------------------------------------------------------------------
+// dpiTest_1428_verifyBorrowedLobReferences()
+//   Set a CLOB attribute of an object and retrieve it; call dpiLob_addRef()
+// and dpiLob_release() on the LOB borrowed from the object and verify that it
+// remains usable after another value is retrieved from the object; bind a
+// borrowed LOB to a variable with dpiVar_setFromLob() and release it, then
+// verify that the LOB held by the variable remains usable.
+//-----------------------------------------------------------------------------
+int dpiTest_1428_verifyBorrowedLobReferences(dpiTestCase *testCase,
+        dpiTestParams *params)
+{
+    const char *objName = "UDT_LOBOBJECT", *value = "borrowed LOB";
+    dpiObjectAttr *attributes[3];
+    dpiData data, *varData;
+    dpiObjectType *objType;
+    dpiLob *lob, *tempLob;
+    uint64_t size;
+    dpiObject *obj;
+    dpiConn *conn;
+    dpiVar *var;
+    uint32_t i;
+
+    // create an object with the CLOB attribute populated
+    if (dpiTestCase_getConnection(testCase, &conn) < 0)
+        return DPI_FAILURE;
+    if (dpiConn_getObjectType(conn, objName, strlen(objName), &objType) < 0)
+        return dpiTestCase_setFailedFromError(testCase);
+    if (dpiObjectType_getAttributes(objType, 3, attributes) < 0)
+        return dpiTestCase_setFailedFromError(testCase);
+    if (dpiObjectType_createObject(objType, &obj) < 0)
+        return dpiTestCase_setFailedFromError(testCase);
+    if (dpiConn_newTempLob(conn, DPI_ORACLE_TYPE_CLOB, &tempLob) < 0)
+        return dpiTestCase_setFailedFromError(testCase);
+    if (dpiLob_setFromBytes(tempLob, value, strlen(value)) < 0)
+        return dpiTestCase_setFailedFromError(testCase);
+    dpiData_setLOB(&data, tempLob);
+    if (dpiObject_setAttributeValue(obj, attributes[1], DPI_NATIVE_TYPE_LOB,
+            &data) < 0)
+        return dpiTestCase_setFailedFromError(testCase);
+
+    // retain the borrowed LOB and release the reference returned with it
+    if (dpiObject_getAttributeValue(obj, attributes[1], DPI_NATIVE_TYPE_LOB,
+            &data) < 0)
+        return dpiTestCase_setFailedFromError(testCase);
+    lob = data.value.asLOB;
+    if (dpiLob_addRef(lob) < 0)
+        return dpiTestCase_setFailedFromError(testCase);
+    if (dpiLob_release(lob) < 0)
+        return dpiTestCase_setFailedFromError(testCase);
+    if (dpiObject_getAttributeValue(obj, attributes[1], DPI_NATIVE_TYPE_LOB,
+            &data) < 0)
+        return dpiTestCase_setFailedFromError(testCase);
+    if (dpiLob_getSize(lob, &size) < 0)
+        return dpiTestCase_setFailedFromError(testCase);
+    if (dpiTestCase_expectUintEqual(testCase, size, strlen(value)) < 0)
+        return DPI_FAILURE;
+    if (dpiLob_release(lob) < 0)
+        return dpiTestCase_setFailedFromError(testCase);
+
+    // bind the borrowed LOB to a variable and release the reference returned
+    // with it
+    if (dpiConn_newVar(conn, DPI_ORACLE_TYPE_CLOB, DPI_NATIVE_TYPE_LOB, 1, 0,
+            0, 0, NULL, &var, &varData) < 0)
+        return dpiTestCase_setFailedFromError(testCase);
+    if (dpiObject_getAttributeValue(obj, attributes[1], DPI_NATIVE_TYPE_LOB,
+            &data) < 0)
+        return dpiTestCase_setFailedFromError(testCase);
+    if (dpiVar_setFromLob(var, 0, data.value.asLOB) < 0)
+        return dpiTestCase_setFailedFromError(testCase);
+    if (dpiLob_release(data.value.asLOB) < 0)
+        return dpiTestCase_setFailedFromError(testCase);
+    if (dpiLob_getSize(varData->value.asLOB, &size) < 0)
+        return dpiTestCase_setFailedFromError(testCase);
+    if (dpiTestCase_expectUintEqual(testCase, size, strlen(value)) < 0)
+        return DPI_FAILURE;
+
+    // cleanup
+    if (dpiVar_release(var) < 0)
+        return dpiTestCase_setFailedFromError(testCase);
+    if (dpiLob_release(tempLob) < 0)
+        return dpiTestCase_setFailedFromError(testCase);
+    if (dpiObject_release(obj) < 0)
+        return dpiTestCase_setFailedFromError(testCase);
+    if (dpiObjectType_release(objType) < 0)
+        return dpiTestCase_setFailedFromError(testCase);
+    for (i = 0; i < 3; i++) {
+        if (dpiObjectAttr_release(attributes[i]) < 0)
+            return dpiTestCase_setFailedFromError(testCase);
+    }
+
+    return DPI_SUCCESS;
+}
+
+
+//-----------------------------------------------------------------------------
+// dpiTest_1429_verifyObjectToJson()
+//   Create an object with one attribute null and call dpiObject_toJson();
+// populate the attributes with a number and a string that requires escaping
+// and call dpiObject_toJson() again, verifying that the JSON is appended to
+// the buffer; call dpiObject_writeJson() and verify that the callback is
+// passed the same JSON (no error).
+//-----------------------------------------------------------------------------
+int dpiTest_1429_verifyObjectToJson(dpiTestCase *testCase,
+        dpiTestParams *params)
+{
+    const char *expectedNull = "{\"SUBNUMBERVALUE\":null,"
+            "\"SUBSTRINGVALUE\":null}";
+    const char *expected = "{\"SUBNUMBERVALUE\":-12.5,"
+            "\"SUBSTRINGVALUE\":\"say \\\"hi\\\"\\\\\\n\\u0001\"}";
+    const char *objName = "UDT_SUBOBJECT", *value = "say \"hi\"\\\n\x01";
+    dpiObjectAttr *attributes[2];
+    dpiTestJsonOutput output;
+    dpiObjectType *objType;
+    dpiJsonBuffer buffer;
+    uint32_t nullLength;
+    dpiObject *obj;
+    dpiConn *conn;
+    dpiData data;
+    uint32_t i;
+
+    // create an object with null attributes and serialize it
+    if (dpiTestCase_getConnection(testCase, &conn) < 0)
+        return DPI_FAILURE;
+    if (dpiConn_getObjectType(conn, objName, strlen(objName), &objType) < 0)
+        return dpiTestCase_setFailedFromError(testCase);
+    if (dpiObjectType_getAttributes(objType, 2, attributes) < 0)
+        return dpiTestCase_setFailedFromError(testCase);
+    if (dpiObjectType_createObject(objType, &obj) < 0)
+        return dpiTestCase_setFailedFromError(testCase);
+    memset(&buffer, 0, sizeof(buffer));
+    if (dpiObject_toJson(obj, &buffer) < 0)
+        return dpiTestCase_setFailedFromError(testCase);
+    nullLength = (uint32_t) strlen(expectedNull);
+    if (dpiTestCase_expectStringEqual(testCase, buffer.ptr, buffer.length,
+            expectedNull, nullLength) < 0)
+        return DPI_FAILURE;
+
+    // populate the attributes and serialize the object again
+    dpiData_setDouble(&data, -12.5);
+    if (dpiObject_setAttributeValue(obj, attributes[0],
+            DPI_NATIVE_TYPE_DOUBLE, &data) < 0)
+        return dpiTestCase_setFailedFromError(testCase);
+    dpiData_setBytes(&data, (char*) value, strlen(value));
+    if (dpiObject_setAttributeValue(obj, attributes[1], DPI_NATIVE_TYPE_BYTES,
+            &data) < 0)
+        return dpiTestCase_setFailedFromError(testCase);
+    if (dpiObject_toJson(obj, &buffer) < 0)
+        return dpiTestCase_setFailedFromError(testCase);
+    if (dpiTestCase_expectUintEqual(testCase, buffer.length,
+            nullLength + strlen(expected)) < 0)
+        return DPI_FAILURE;
+    if (dpiTestCase_expectStringEqual(testCase, buffer.ptr + nullLength,
+            buffer.length - nullLength, expected, strlen(expected)) < 0)
+        return DPI_FAILURE;
+
+    // serialize the object to a callback
+    output.length = 0;
+    if (dpiObject_writeJson(obj, dpiTest__writeJson, &output) < 0)
+        return dpiTestCase_setFailedFromError(testCase);
+    if (dpiTestCase_expectStringEqual(testCase, output.data, output.length,
+            expected, strlen(expected)) < 0)
+        return DPI_FAILURE;
+
+    // cleanup
+    free(buffer.ptr);
+    if (dpiObject_release(obj) < 0)
+        return dpiTestCase_setFailedFromError(testCase);
+    if (dpiObjectType_release(objType) < 0)
+        return dpiTestCase_setFailedFromError(testCase);
+    for (i = 0; i < 2; i++) {
+        if (dpiObjectAttr_release(attributes[i]) < 0)
+            return dpiTestCase_setFailedFromError(testCase);
+    }
+
+    return DPI_SUCCESS;
+}
+
+
+//-----------------------------------------------------------------------------
+// dpiTest_1430_verifyWriteJsonAborted()
+//   Create an object and call dpiObject_writeJson() with a callback that
+// returns a negative value (error DPI-1055); call dpiObject_toJson() with a
+// NULL buffer (error DPI-1046).
+//-----------------------------------------------------------------------------
+int dpiTest_1430_verifyWriteJsonAborted(dpiTestCase *testCase,
+        dpiTestParams *params)
+{
+    const char *objName = "UDT_SUBOBJECT";
+    dpiObjectType *objType;
+    dpiObject *obj;
+    dpiConn *conn;
+
+    if (dpiTestCase_getConnection(testCase, &conn) < 0)
+        return DPI_FAILURE;
+    if (dpiConn_getObjectType(conn, objName, strlen(objName), &objType) < 0)
+        return dpiTestCase_setFailedFromError(testCase);
+    if (dpiObjectType_createObject(objType, &obj) < 0)
+        return dpiTestCase_setFailedFromError(testCase);
+    dpiObject_writeJson(obj, dpiTest__abortJson, NULL);
+    if (dpiTestCase_expectError(testCase,
+            "DPI-1055: JSON output was aborted by the write callback") < 0)
+        return DPI_FAILURE;
+    dpiObject_toJson(obj, NULL);
+    if (dpiTestCase_expectError(testCase,
+            "DPI-1046: parameter buffer cannot be a NULL pointer") < 0)
+        return DPI_FAILURE;
+    if (dpiObject_release(obj) < 0)
+        return dpiTestCase_setFailedFromError(testCase);
+    if (dpiObjectType_release(objType) < 0)
+        return dpiTestCase_setFailedFromError(testCase);
+
+    return DPI_SUCCESS;
+}
+
+
+//-----------------------------------------------------------------------------
+// dpiTest_1431_verifyBorrowedLobsPerAttribute()
+//   Set the CLOB and NCLOB attributes of an object to different values and
+// retrieve both of them; verify that distinct LOBs are returned and that the
+// first one still refers to its own attribute after the second one has been
+// retrieved; retrieve the first attribute again and verify that the same LOB
+// is returned.
+//-----------------------------------------------------------------------------
+int dpiTest_1431_verifyBorrowedLobsPerAttribute(dpiTestCase *testCase,
+        dpiTestParams *params)
+{
+    const char *values[2] = { "first borrowed LOB", "second LOB" };
+    const char *objName = "UDT_LOBOBJECT";
+    dpiOracleTypeNum lobTypes[2] = {
+        DPI_ORACLE_TYPE_CLOB, DPI_ORACLE_TYPE_NCLOB
+    };
+    dpiObjectAttr *attributes[3];
+    dpiObjectType *objType;
+    dpiLob *lobs[2], *tempLobs[2];
+    dpiObject *obj;
+    uint64_t size;
+    dpiConn *conn;
+    dpiData data;
+    uint32_t i;
+
+    // create an object with both LOB attributes populated
+    if (dpiTestCase_getConnection(testCase, &conn) < 0)
+        return DPI_FAILURE;
+    if (dpiConn_getObjectType(conn, objName, strlen(objName), &objType) < 0)
+        return dpiTestCase_setFailedFromError(testCase);
+    if (dpiObjectType_getAttributes(objType, 3, attributes) < 0)
+        return dpiTestCase_setFailedFromError(testCase);
+    if (dpiObjectType_createObject(objType, &obj) < 0)
+        return dpiTestCase_setFailedFromError(testCase);
+    for (i = 0; i < 2; i++) {
+        if (dpiConn_newTempLob(conn, lobTypes[i], &tempLobs[i]) < 0)
+            return dpiTestCase_setFailedFromError(testCase);
+        if (dpiLob_setFromBytes(tempLobs[i], values[i],
+                strlen(values[i])) < 0)
+            return dpiTestCase_setFailedFromError(testCase);
+        dpiData_setLOB(&data, tempLobs[i]);
+        if (dpiObject_setAttributeValue(obj, attributes[i + 1],
+                DPI_NATIVE_TYPE_LOB, &data) < 0)
+            return dpiTestCase_setFailedFromError(testCase);
+    }
+
+    // retrieve both LOB attributes and verify each refers to its own value
+    for (i = 0; i < 2; i++) {
+        if (dpiObject_getAttributeValue(obj, attributes[i + 1],
+                DPI_NATIVE_TYPE_LOB, &data) < 0)
+            return dpiTestCase_setFailedFromError(testCase);
+        lobs[i] = data.value.asLOB;
+    }
+    if (lobs[0] == lobs[1])
+        return dpiTestCase_setFailed(testCase,
+                "same LOB returned for different attributes");
+    for (i = 0; i < 2; i++) {
+        if (dpiLob_getSize(lobs[i], &size) < 0)
+            return dpiTestCase_setFailedFromError(testCase);
+        if (dpiTestCase_expectUintEqual(testCase, size,
+                strlen(values[i])) < 0)
+            return DPI_FAILURE;
+    }
+
+    // retrieve the first attribute again and verify the same LOB is returned
+    if (dpiObject_getAttributeValue(obj, attributes[1], DPI_NATIVE_TYPE_LOB,
+            &data) < 0)
+        return dpiTestCase_setFailedFromError(testCase);
+    if (data.value.asLOB != lobs[0])
+        return dpiTestCase_setFailed(testCase,
+                "different LOB returned for the same attribute");
+
+    // cleanup
+    for (i = 0; i < 2; i++) {
+        if (dpiLob_release(tempLobs[i]) < 0)
+            return dpiTestCase_setFailedFromError(testCase);
+    }
+    if (dpiObject_release(obj) < 0)
+        return dpiTestCase_setFailedFromError(testCase);
+    if (dpiObjectType_release(objType) < 0)
+        return dpiTestCase_setFailedFromError(testCase);
+    for (i = 0; i < 3; i++) {
+        if (dpiObjectAttr_release(attributes[i]) < 0)
+            return dpiTestCase_setFailedFromError(testCase);
+    }
+
+    return DPI_SUCCESS;
+}
+
+
 //-----------------------------------------------------------------------------
 // main()
 //-----------------------------------------------------------------------------
@@ -1261,6 +1600,14 @@ int main(int argc, char **argv)
             "dpiObject_setAttributeValue() with invalid native type");
     dpiTestSuite_addCase(dpiTest_1427_verifySetAttrValueWithAttrAsNull,
             "dpiObject_appendElement() with NULL attribute");
+    dpiTestSuite_addCase(dpiTest_1428_verifyBorrowedLobReferences,
+            "dpiLob_addRef() and dpiLob_release() on borrowed LOB");
+    dpiTestSuite_addCase(dpiTest_1429_verifyObjectToJson,
+            "dpiObject_toJson() and dpiObject_writeJson() with object");
+    dpiTestSuite_addCase(dpiTest_1430_verifyWriteJsonAborted,
+            "dpiObject_writeJson() with callback aborting output");
+    dpiTestSuite_addCase(dpiTest_1431_verifyBorrowedLobsPerAttribute,
+            "LOBs borrowed from different attributes of an object");
     return dpiTestSuite_run();
 }
 
@@ -16,9 +16,32 @@
 
 #include "TestLib.h"
 
+#ifdef _WIN32
+#include <windows.h>
+#else
+#include <pthread.h>
+#endif
+
 #define MINSESSIONS 2
 #define MAXSESSIONS 9
 #define SESSINCREMENT 2
+#define NUM_SHARED_QUERY_THREADS 8
+#define NUM_CLASS_THREADS 4
+
+// structure used for passing arguments to threads executing shared queries
+typedef struct {
+    dpiPool *pool;
+    const char *sql;
+    dpiSharedResult *result;
+    int status;
+} dpiTestSharedQuery;
+
+// structure used for passing arguments to threads executing statements
+typedef struct {
+    dpiConn *conn;
+    const char *sql;
+    int status;
+} dpiTestExecution;
 
 //-----------------------------------------------------------------------------
 // dpiTest__callFunctionsWithError() [INTERNAL]
@@ -28,6 +51,9 @@
 int dpiTest__callFunctionsWithError(dpiTestCase *testCase,
         dpiTestParams *params, dpiPool *pool, const char *expectedError)
 {
+    dpiPoolClassInfo classInfo;
+    dpiSharedResult *result;
+    dpiRetryInfo retryInfo;
     dpiEncodingInfo info;
     dpiPoolGetMode value;
     uint32_t count;
@@ -45,6 +71,10 @@ int dpiTest__callFunctionsWithError(dpiTestCase *testCase,
     if (dpiTestCase_expectError(testCase, expectedError) < 0)
         return DPI_FAILURE;
 
+    dpiPool_getClassInfo(pool, 0, &classInfo);
+    if (dpiTestCase_expectError(testCase, expectedError) < 0)
+        return DPI_FAILURE;
+
     dpiPool_getEncodingInfo(pool, &info);
     if (dpiTestCase_expectError(testCase, expectedError) < 0)
         return DPI_FAILURE;
@@ -61,10 +91,26 @@ int dpiTest__callFunctionsWithError(dpiTestCase *testCase,
     if (dpiTestCase_expectError(testCase, expectedError) < 0)
         return DPI_FAILURE;
 
+    dpiPool_getRetryInfo(pool, &retryInfo);
+    if (dpiTestCase_expectError(testCase, expectedError) < 0)
+        return DPI_FAILURE;
+
     dpiPool_getTimeout(pool, &count);
     if (dpiTestCase_expectError(testCase, expectedError) < 0)
         return DPI_FAILURE;
 
+    dpiPool_queryShared(pool, NULL, 0, 0, NULL, NULL, &result);
+    if (dpiTestCase_expectError(testCase, expectedError) < 0)
+        return DPI_FAILURE;
+
+    dpiPool_reconfigure(pool, MINSESSIONS, MAXSESSIONS, SESSINCREMENT);
+    if (dpiTestCase_expectError(testCase, expectedError) < 0)
+        return DPI_FAILURE;
+
+    dpiPool_setClassParams(pool, 0, NULL);
+    if (dpiTestCase_expectError(testCase, expectedError) < 0)
+        return DPI_FAILURE;
+
     dpiPool_setGetMode(pool, value);
     if (dpiTestCase_expectError(testCase, expectedError) < 0)
         return DPI_FAILURE;
@@ -73,6 +119,10 @@ int dpiTest__callFunctionsWithError(dpiTestCase *testCase,
     if (dpiTestCase_expectError(testCase, expectedError) < 0)
         return DPI_FAILURE;
 
+    dpiPool_setSizingParams(pool, NULL);
+    if (dpiTestCase_expectError(testCase, expectedError) < 0)
+        return DPI_FAILURE;
+
     dpiPool_setTimeout(pool, 5);
     if (dpiTestCase_expectError(testCase, expectedError) < 0)
         return DPI_FAILURE;
@@ -81,6 +131,48 @@ int dpiTest__callFunctionsWithError(dpiTestCase *testCase,
 }
 
 
+//-----------------------------------------------------------------------------
+// dpiTest__executeThread() [INTERNAL]
+//   Execute a statement in a separate thread.
+//-----------------------------------------------------------------------------
+#ifdef _WIN32
+static DWORD WINAPI dpiTest__executeThread(LPVOID arg)
+#else
+static void *dpiTest__executeThread(void *arg)
+#endif
+{
+    dpiTestExecution *execution = (dpiTestExecution*) arg;
+    uint32_t numQueryColumns;
+    dpiStmt *stmt;
+
+    execution->status = dpiConn_prepareStmt(execution->conn, 0,
+            execution->sql, strlen(execution->sql), NULL, 0, &stmt);
+    if (execution->status < 0)
+        return 0;
+    execution->status = dpiStmt_execute(stmt, 0, &numQueryColumns);
+    dpiStmt_release(stmt);
+    return 0;
+}
+
+
+//-----------------------------------------------------------------------------
+// dpiTest__querySharedThread() [INTERNAL]
+//   Execute a shared query in a separate thread.
+//-----------------------------------------------------------------------------
+#ifdef _WIN32
+static DWORD WINAPI dpiTest__querySharedThread(LPVOID arg)
+#else
+static void *dpiTest__querySharedThread(void *arg)
+#endif
+{
+    dpiTestSharedQuery *query = (dpiTestSharedQuery*) arg;
+
+    query->status = dpiPool_queryShared(query->pool, query->sql,
+            strlen(query->sql), 0, NULL, NULL, &query->result);
+    return 0;
+}
+
+
 //-----------------------------------------------------------------------------
 // dpiTest_500_withoutParams()
 //   Verify that dpiPool_create() succeeds when valid credentials are passed
@@ -633,6 +725,637 @@ int dpiTest_517_createNoCred(dpiTestCase *testCase, dpiTestParams *params)
 }
 
 
+//-----------------------------------------------------------------------------
+// dpiTest_518_reconfigure()
+//   Call dpiPool_reconfigure() with a larger minimum and maximum and confirm
+// that the pool opens sessions to reach the new minimum (no error).
+//-----------------------------------------------------------------------------
+int dpiTest_518_reconfigure(dpiTestCase *testCase, dpiTestParams *params)
+{
+    dpiPoolCreateParams createParams;
+    dpiContext *context;
+    uint32_t count;
+    dpiPool *pool;
+
+    dpiTestSuite_getContext(&context);
+    if (dpiContext_initPoolCreateParams(context, &createParams) < 0)
+        return dpiTestCase_setFailedFromError(testCase);
+    createParams.minSessions = MINSESSIONS;
+    createParams.maxSessions = MAXSESSIONS;
+    createParams.sessionIncrement = SESSINCREMENT;
+
+    if (dpiPool_create(context, params->mainUserName,
+            params->mainUserNameLength, params->mainPassword,
+            params->mainPasswordLength, params->connectString,
+            params->connectStringLength, NULL, &createParams,  &pool) < 0)
+        return dpiTestCase_setFailedFromError(testCase);
+    if (dpiPool_reconfigure(pool, MINSESSIONS + SESSINCREMENT,
+            MAXSESSIONS + SESSINCREMENT, SESSINCREMENT) < 0)
+        return dpiTestCase_setFailedFromError(testCase);
+    if (dpiPool_getOpenCount(pool, &count) < 0)
+        return dpiTestCase_setFailedFromError(testCase);
+    if (dpiPool_release(pool) < 0)
+        return dpiTestCase_setFailedFromError(testCase);
+
+    return dpiTestCase_expectUintEqual(testCase, count,
+            MINSESSIONS + SESSINCREMENT);
+}
+
+
+//-----------------------------------------------------------------------------
+// dpiTest_519_reconfigureMinExceedsMax()
+//   Call dpiPool_reconfigure() and dpiPool_setSizingParams() with a minimum
+// that exceeds the maximum (error DPI-1056).
+//-----------------------------------------------------------------------------
+int dpiTest_519_reconfigureMinExceedsMax(dpiTestCase *testCase,
+        dpiTestParams *params)
+{
+    const char *expectedError = "DPI-1056: pool minimum of 9 sessions "
+            "exceeds maximum of 2 sessions";
+    dpiPoolSizingParams sizingParams;
+    dpiContext *context;
+    dpiPool *pool;
+
+    dpiTestSuite_getContext(&context);
+    if (dpiPool_create(context, params->mainUserName,
+            params->mainUserNameLength, params->mainPassword,
+            params->mainPasswordLength, params->connectString,
+            params->connectStringLength, NULL, NULL, &pool) < 0)
+        return dpiTestCase_setFailedFromError(testCase);
+    dpiPool_reconfigure(pool, MAXSESSIONS, MINSESSIONS, SESSINCREMENT);
+    if (dpiTestCase_expectError(testCase, expectedError) < 0)
+        return DPI_FAILURE;
+    if (dpiContext_initPoolSizingParams(context, &sizingParams) < 0)
+        return dpiTestCase_setFailedFromError(testCase);
+    sizingParams.minSessions = MAXSESSIONS;
+    sizingParams.maxSessions = MINSESSIONS;
+    dpiPool_setSizingParams(pool, &sizingParams);
+    if (dpiTestCase_expectError(testCase, expectedError) < 0)
+        return DPI_FAILURE;
+    if (dpiPool_release(pool) < 0)
+        return dpiTestCase_setFailedFromError(testCase);
+
+    return DPI_SUCCESS;
+}
+
+
+//-----------------------------------------------------------------------------
+// dpiTest_520_classLimitExceeded()
+//   Set limits for an admission class, acquire as many connections from it
+// as its maximum permits and then attempt to acquire one more (error
+// DPI-1062); verify the statistics of the class and that connections not
+// tagged with the class are unaffected.
+//-----------------------------------------------------------------------------
+int dpiTest_520_classLimitExceeded(dpiTestCase *testCase,
+        dpiTestParams *params)
+{
+    const char *expectedError = "DPI-1062: pool class 3 rejected the "
+            "request as 2 sessions are busy and 0 requests are queued";
+    dpiConn *conn1, *conn2, *conn3, *conn4;
+    dpiConnCreateParams connParams;
+    dpiPoolClassParams classParams;
+    dpiPoolClassInfo classInfo;
+    dpiContext *context;
+    dpiPool *pool;
+
+    // create pool and set limits for the class
+    dpiTestSuite_getContext(&context);
+    if (dpiPool_create(context, params->mainUserName,
+            params->mainUserNameLength, params->mainPassword,
+            params->mainPasswordLength, params->connectString,
+            params->connectStringLength, NULL, NULL, &pool) < 0)
+        return dpiTestCase_setFailedFromError(testCase);
+    if (dpiContext_initPoolClassParams(context, &classParams) < 0)
+        return dpiTestCase_setFailedFromError(testCase);
+    classParams.maxSessions = 2;
+    if (dpiPool_setClassParams(pool, 3, &classParams) < 0)
+        return dpiTestCase_setFailedFromError(testCase);
+
+    // acquire connections up to the limit and one more
+    if (dpiContext_initConnCreateParams(context, &connParams) < 0)
+        return dpiTestCase_setFailedFromError(testCase);
+    connParams.poolClass = 3;
+    if (dpiPool_acquireConnection(pool, NULL, 0, NULL, 0, &connParams,
+            &conn1) < 0)
+        return dpiTestCase_setFailedFromError(testCase);
+    if (dpiPool_acquireConnection(pool, NULL, 0, NULL, 0, &connParams,
+            &conn2) < 0)
+        return dpiTestCase_setFailedFromError(testCase);
+    dpiPool_acquireConnection(pool, NULL, 0, NULL, 0, &connParams, &conn3);
+    if (dpiTestCase_expectError(testCase, expectedError) < 0)
+        return DPI_FAILURE;
+
+    // other classes are not limited
+    connParams.poolClass = 0;
+    if (dpiPool_acquireConnection(pool, NULL, 0, NULL, 0, &connParams,
+            &conn4) < 0)
+        return dpiTestCase_setFailedFromError(testCase);
+
+    // releasing a connection makes room for another one
+    if (dpiConn_release(conn1) < 0)
+        return dpiTestCase_setFailedFromError(testCase);
+    connParams.poolClass = 3;
+    if (dpiPool_acquireConnection(pool, NULL, 0, NULL, 0, &connParams,
+            &conn3) < 0)
+        return dpiTestCase_setFailedFromError(testCase);
+
+    // verify statistics
+    if (dpiPool_getClassInfo(pool, 3, &classInfo) < 0)
+        return dpiTestCase_setFailedFromError(testCase);
+    if (dpiTestCase_expectUintEqual(testCase, classInfo.limit, 2) < 0)
+        return DPI_FAILURE;
+    if (dpiTestCase_expectUintEqual(testCase, classInfo.busyCount, 2) < 0)
+        return DPI_FAILURE;
+    if (dpiTestCase_expectUintEqual(testCase, classInfo.numAdmitted, 3) < 0)
+        return DPI_FAILURE;
+    if (dpiTestCase_expectUintEqual(testCase, classInfo.numRejected, 1) < 0)
+        return DPI_FAILURE;
+
+    // cleanup
+    if (dpiConn_release(conn2) < 0)
+        return dpiTestCase_setFailedFromError(testCase);
+    if (dpiConn_release(conn3) < 0)
+        return dpiTestCase_setFailedFromError(testCase);
+    if (dpiConn_release(conn4) < 0)
+        return dpiTestCase_setFailedFromError(testCase);
+    if (dpiPool_getClassInfo(pool, 3, &classInfo) < 0)
+        return dpiTestCase_setFailedFromError(testCase);
+    if (dpiPool_release(pool) < 0)
+        return dpiTestCase_setFailedFromError(testCase);
+
+    return dpiTestCase_expectUintEqual(testCase, classInfo.busyCount, 0);
+}
+
+
+//-----------------------------------------------------------------------------
+// dpiTest_521_invalidClass()
+//   Call dpiPool_setClassParams() and dpiPool_acquireConnection() with a
+// class that is out of range (error DPI-1061).
+//-----------------------------------------------------------------------------
+int dpiTest_521_invalidClass(dpiTestCase *testCase, dpiTestParams *params)
+{
+    const char *expectedError = "DPI-1061: pool class 8 is not valid; it "
+            "must be less than 8";
+    dpiConnCreateParams connParams;
+    dpiPoolClassParams classParams;
+    dpiContext *context;
+    dpiPool *pool;
+    dpiConn *conn;
+
+    dpiTestSuite_getContext(&context);
+    if (dpiPool_create(context, params->mainUserName,
+            params->mainUserNameLength, params->mainPassword,
+            params->mainPasswordLength, params->connectString,
+            params->connectStringLength, NULL, NULL, &pool) < 0)
+        return dpiTestCase_setFailedFromError(testCase);
+    if (dpiContext_initPoolClassParams(context, &classParams) < 0)
+        return dpiTestCase_setFailedFromError(testCase);
+    dpiPool_setClassParams(pool, DPI_MAX_POOL_CLASSES, &classParams);
+    if (dpiTestCase_expectError(testCase, expectedError) < 0)
+        return DPI_FAILURE;
+    if (dpiContext_initConnCreateParams(context, &connParams) < 0)
+        return dpiTestCase_setFailedFromError(testCase);
+    connParams.poolClass = DPI_MAX_POOL_CLASSES;
+    dpiPool_acquireConnection(pool, NULL, 0, NULL, 0, &connParams, &conn);
+    if (dpiTestCase_expectError(testCase, expectedError) < 0)
+        return DPI_FAILURE;
+    if (dpiPool_release(pool) < 0)
+        return dpiTestCase_setFailedFromError(testCase);
+
+    return DPI_SUCCESS;
+}
+
+
+//-----------------------------------------------------------------------------
+// dpiTest_522_classLatencyBackoff()
+//   Set a latency target for an admission class that an execution exceeds
+// and verify that the limit of the class is reduced by the backoff
+// percentage but not below the class minimum.
+//-----------------------------------------------------------------------------
+int dpiTest_522_classLatencyBackoff(dpiTestCase *testCase,
+        dpiTestParams *params)
+{
+    const char *sleepSql = "begin dbms_lock.sleep(0.05); end;";
+    dpiConnCreateParams connParams;
+    dpiPoolClassParams classParams;
+    dpiPoolClassInfo classInfo;
+    uint32_t numQueryColumns;
+    dpiContext *context;
+    dpiStmt *stmt;
+    dpiPool *pool;
+    dpiConn *conn;
+
+    // create pool and set limits for the class
+    dpiTestSuite_getContext(&context);
+    if (dpiPool_create(context, params->mainUserName,
+            params->mainUserNameLength, params->mainPassword,
+            params->mainPasswordLength, params->connectString,
+            params->connectStringLength, NULL, NULL, &pool) < 0)
+        return dpiTestCase_setFailedFromError(testCase);
+    if (dpiContext_initPoolClassParams(context, &classParams) < 0)
+        return dpiTestCase_setFailedFromError(testCase);
+    classParams.minSessions = 3;
+    classParams.maxSessions = 8;
+    classParams.latencyTarget = 10;
+    classParams.backoffPercent = 50;
+    if (dpiPool_setClassParams(pool, 1, &classParams) < 0)
+        return dpiTestCase_setFailedFromError(testCase);
+
+    // execute a statement that exceeds the target twice
+    if (dpiContext_initConnCreateParams(context, &connParams) < 0)
+        return dpiTestCase_setFailedFromError(testCase);
+    connParams.poolClass = 1;
+    if (dpiPool_acquireConnection(pool, NULL, 0, NULL, 0, &connParams,
+            &conn) < 0)
+        return dpiTestCase_setFailedFromError(testCase);
+    if (dpiConn_prepareStmt(conn, 0, sleepSql, strlen(sleepSql), NULL, 0,
+            &stmt) < 0)
+        return dpiTestCase_setFailedFromError(testCase);
+    if (dpiStmt_execute(stmt, 0, &numQueryColumns) < 0)
+        return dpiTestCase_setFailedFromError(testCase);
+    if (dpiPool_getClassInfo(pool, 1, &classInfo) < 0)
+        return dpiTestCase_setFailedFromError(testCase);
+    if (dpiTestCase_expectUintEqual(testCase, classInfo.limit, 4) < 0)
+        return DPI_FAILURE;
+    if (dpiStmt_execute(stmt, 0, &numQueryColumns) < 0)
+        return dpiTestCase_setFailedFromError(testCase);
+    if (dpiPool_getClassInfo(pool, 1, &classInfo) < 0)
+        return dpiTestCase_setFailedFromError(testCase);
+
+    // cleanup
+    if (dpiStmt_release(stmt) < 0)
+        return dpiTestCase_setFailedFromError(testCase);
+    if (dpiConn_release(conn) < 0)
+        return dpiTestCase_setFailedFromError(testCase);
+    if (dpiPool_release(pool) < 0)
+        return dpiTestCase_setFailedFromError(testCase);
+
+    return dpiTestCase_expectUintEqual(testCase, classInfo.limit, 3);
+}
+
+
+//-----------------------------------------------------------------------------
+// dpiTest_523_queryShared()
+//   Call dpiPool_queryShared() with a bind value and verify the columns and
+// rows of the result; call it again and verify that a new result is returned
+// as results are not retained once the query has completed.
+//-----------------------------------------------------------------------------
+int dpiTest_523_queryShared(dpiTestCase *testCase, dpiTestParams *params)
+{
+    const char *sql = "select to_char(level) as value from dual "
+            "where :1 = 'X' connect by level <= 5";
+    dpiSharedResult *result1, *result2;
+    dpiNativeTypeNum nativeTypeNum;
+    uint32_t numColumns, numRows;
+    dpiData bindValue, *data;
+    dpiContext *context;
+    dpiQueryInfo info;
+    dpiPool *pool;
+
+    // create pool and execute query
+    dpiTestSuite_getContext(&context);
+    if (dpiPool_create(context, params->mainUserName,
+            params->mainUserNameLength, params->mainPassword,
+            params->mainPasswordLength, params->connectString,
+            params->connectStringLength, NULL, NULL, &pool) < 0)
+        return dpiTestCase_setFailedFromError(testCase);
+    nativeTypeNum = DPI_NATIVE_TYPE_BYTES;
+    bindValue.isNull = 0;
+    bindValue.value.asBytes.ptr = "X";
+    bindValue.value.asBytes.length = 1;
+    bindValue.value.asBytes.encoding = NULL;
+    if (dpiPool_queryShared(pool, sql, strlen(sql), 1, &nativeTypeNum,
+            &bindValue, &result1) < 0)
+        return dpiTestCase_setFailedFromError(testCase);
+
+    // verify columns and rows
+    if (dpiSharedResult_getNumColumns(result1, &numColumns) < 0)
+        return dpiTestCase_setFailedFromError(testCase);
+    if (dpiTestCase_expectUintEqual(testCase, numColumns, 1) < 0)
+        return DPI_FAILURE;
+    if (dpiSharedResult_getQueryInfo(result1, 1, &info) < 0)
+        return dpiTestCase_setFailedFromError(testCase);
+    if (dpiTestCase_expectStringEqual(testCase, info.name, info.nameLength,
+            "VALUE", 5) < 0)
+        return DPI_FAILURE;
+    if (dpiSharedResult_getNumRows(result1, &numRows) < 0)
+        return dpiTestCase_setFailedFromError(testCase);
+    if (dpiTestCase_expectUintEqual(testCase, numRows, 5) < 0)
+        return DPI_FAILURE;
+    if (dpiSharedResult_getValue(result1, 4, 1, &nativeTypeNum, &data) < 0)
+        return dpiTestCase_setFailedFromError(testCase);
+    if (dpiTestCase_expectUintEqual(testCase, nativeTypeNum,
+            DPI_NATIVE_TYPE_BYTES) < 0)
+        return DPI_FAILURE;
+    if (dpiTestCase_expectStringEqual(testCase, data->value.asBytes.ptr,
+            data->value.asBytes.length, "5", 1) < 0)
+        return DPI_FAILURE;
+
+    // execute the query again
+    nativeTypeNum = DPI_NATIVE_TYPE_BYTES;
+    if (dpiPool_queryShared(pool, sql, strlen(sql), 1, &nativeTypeNum,
+            &bindValue, &result2) < 0)
+        return dpiTestCase_setFailedFromError(testCase);
+    if (result1 == result2)
+        return dpiTestCase_setFailed(testCase,
+                "result of completed query was reused");
+
+    // cleanup
+    if (dpiSharedResult_release(result1) < 0)
+        return dpiTestCase_setFailedFromError(testCase);
+    if (dpiSharedResult_release(result2) < 0)
+        return dpiTestCase_setFailedFromError(testCase);
+    if (dpiPool_release(pool) < 0)
+        return dpiTestCase_setFailedFromError(testCase);
+
+    return DPI_SUCCESS;
+}
+
+
+//-----------------------------------------------------------------------------
+// dpiTest_524_querySharedConcurrently()
+//   Call dpiPool_queryShared() with the same query from several threads at
+// the same time and verify that all of them share the same result.
+//-----------------------------------------------------------------------------
+int dpiTest_524_querySharedConcurrently(dpiTestCase *testCase,
+        dpiTestParams *params)
+{
+    const char *sql = "select to_char(level + func_sleep(0.1)) as value "
+            "from dual connect by level <= 3";
+    dpiTestSharedQuery queries[NUM_SHARED_QUERY_THREADS];
+    dpiCommonCreateParams commonParams;
+    dpiContext *context;
+    uint32_t numRows;
+    dpiPool *pool;
+    int i;
+#ifdef _WIN32
+    HANDLE threads[NUM_SHARED_QUERY_THREADS];
+#else
+    pthread_t threads[NUM_SHARED_QUERY_THREADS];
+#endif
+
+    // create threaded pool
+    dpiTestSuite_getContext(&context);
+    if (dpiContext_initCommonCreateParams(context, &commonParams) < 0)
+        return dpiTestCase_setFailedFromError(testCase);
+    commonParams.createMode = DPI_MODE_CREATE_THREADED;
+    if (dpiPool_create(context, params->mainUserName,
+            params->mainUserNameLength, params->mainPassword,
+            params->mainPasswordLength, params->connectString,
+            params->connectStringLength, &commonParams, NULL, &pool) < 0)
+        return dpiTestCase_setFailedFromError(testCase);
+
+    // execute the query in all threads at the same time
+    for (i = 0; i < NUM_SHARED_QUERY_THREADS; i++) {
+        queries[i].pool = pool;
+        queries[i].sql = sql;
+        queries[i].result = NULL;
+#ifdef _WIN32
+        threads[i] = CreateThread(NULL, 0, dpiTest__querySharedThread,
+                &queries[i], 0, NULL);
+        if (!threads[i])
+#else
+        if (pthread_create(&threads[i], NULL, dpiTest__querySharedThread,
+                &queries[i]) != 0)
+#endif
+            return dpiTestCase_setFailed(testCase, "unable to create thread");
+    }
+    for (i = 0; i < NUM_SHARED_QUERY_THREADS; i++) {
+#ifdef _WIN32
+        WaitForSingleObject(threads[i], INFINITE);
+        CloseHandle(threads[i]);
+#else
+        pthread_join(threads[i], NULL);
+#endif
+    }
+
+    // verify that all threads share the same result
+    for (i = 0; i < NUM_SHARED_QUERY_THREADS; i++) {
+        if (queries[i].status < 0)
+            return dpiTestCase_setFailed(testCase, "shared query failed");
+        if (queries[i].result != queries[0].result)
+            return dpiTestCase_setFailed(testCase, "result not shared");
+    }
+    if (dpiSharedResult_getNumRows(queries[0].result, &numRows) < 0)
+        return dpiTestCase_setFailedFromError(testCase);
+    if (dpiTestCase_expectUintEqual(testCase, numRows, 3) < 0)
+        return DPI_FAILURE;
+
+    // cleanup; each thread holds its own reference to the result
+    for (i = 0; i < NUM_SHARED_QUERY_THREADS; i++) {
+        if (dpiSharedResult_release(queries[i].result) < 0)
+            return dpiTestCase_setFailedFromError(testCase);
+    }
+    if (dpiPool_release(pool) < 0)
+        return dpiTestCase_setFailedFromError(testCase);
+
+    return DPI_SUCCESS;
+}
+
+
+//-----------------------------------------------------------------------------
+// dpiTest_525_querySharedWithHandle()
+//   Call dpiPool_queryShared() with a LOB bound to it (error DPI-1064).
+//-----------------------------------------------------------------------------
+int dpiTest_525_querySharedWithHandle(dpiTestCase *testCase,
+        dpiTestParams *params)
+{
+    const char *expectedError =
+            "DPI-1064: values of native type 3008 cannot be shared";
+    const char *sql = "select to_char(level) from dual connect by level <= 1";
+    dpiNativeTypeNum nativeTypeNum;
+    dpiSharedResult *result;
+    dpiContext *context;
+    dpiData bindValue;
+    dpiPool *pool;
+
+    dpiTestSuite_getContext(&context);
+    if (dpiPool_create(context, params->mainUserName,
+            params->mainUserNameLength, params->mainPassword,
+            params->mainPasswordLength, params->connectString,
+            params->connectStringLength, NULL, NULL, &pool) < 0)
+        return dpiTestCase_setFailedFromError(testCase);
+    nativeTypeNum = DPI_NATIVE_TYPE_LOB;
+    bindValue.isNull = 0;
+    bindValue.value.asLOB = NULL;
+    dpiPool_queryShared(pool, sql, strlen(sql), 1, &nativeTypeNum, &bindValue,
+            &result);
+    if (dpiTestCase_expectError(testCase, expectedError) < 0)
+        return DPI_FAILURE;
+    if (dpiPool_release(pool) < 0)
+        return dpiTestCase_setFailedFromError(testCase);
+
+    return DPI_SUCCESS;
+}
+
+
+//-----------------------------------------------------------------------------
+// dpiTest_526_sizingParamsZero()
+//   Call dpiPool_setSizingParams() with a maximum number of sessions of zero
+// and with a sample interval of zero (error DPI-1074).
+//-----------------------------------------------------------------------------
+int dpiTest_526_sizingParamsZero(dpiTestCase *testCase, dpiTestParams *params)
+{
+    dpiPoolSizingParams sizingParams;
+    dpiContext *context;
+    dpiPool *pool;
+
+    dpiTestSuite_getContext(&context);
+    if (dpiPool_create(context, params->mainUserName,
+            params->mainUserNameLength, params->mainPassword,
+            params->mainPasswordLength, params->connectString,
+            params->connectStringLength, NULL, NULL, &pool) < 0)
+        return dpiTestCase_setFailedFromError(testCase);
+    if (dpiContext_initPoolSizingParams(context, &sizingParams) < 0)
+        return dpiTestCase_setFailedFromError(testCase);
+    sizingParams.minSessions = 0;
+    sizingParams.maxSessions = 0;
+    dpiPool_setSizingParams(pool, &sizingParams);
+    if (dpiTestCase_expectError(testCase,
+            "DPI-1074: parameter maxSessions cannot be zero") < 0)
+        return DPI_FAILURE;
+    sizingParams.maxSessions = MAXSESSIONS;
+    sizingParams.sampleInterval = 0;
+    dpiPool_setSizingParams(pool, &sizingParams);
+    if (dpiTestCase_expectError(testCase,
+            "DPI-1074: parameter sampleInterval cannot be zero") < 0)
+        return DPI_FAILURE;
+    if (dpiPool_release(pool) < 0)
+        return dpiTestCase_setFailedFromError(testCase);
+
+    return DPI_SUCCESS;
+}
+
+
+//-----------------------------------------------------------------------------
+// dpiTest_527_classParamsZero()
+//   Call dpiPool_setClassParams() with a maximum number of sessions of zero
+// (error DPI-1074).
+//-----------------------------------------------------------------------------
+int dpiTest_527_classParamsZero(dpiTestCase *testCase, dpiTestParams *params)
+{
+    dpiPoolClassParams classParams;
+    dpiContext *context;
+    dpiPool *pool;
+
+    dpiTestSuite_getContext(&context);
+    if (dpiPool_create(context, params->mainUserName,
+            params->mainUserNameLength, params->mainPassword,
+            params->mainPasswordLength, params->connectString,
+            params->connectStringLength, NULL, NULL, &pool) < 0)
+        return dpiTestCase_setFailedFromError(testCase);
+    if (dpiContext_initPoolClassParams(context, &classParams) < 0)
+        return dpiTestCase_setFailedFromError(testCase);
+    classParams.minSessions = 0;
+    classParams.maxSessions = 0;
+    dpiPool_setClassParams(pool, 1, &classParams);
+    if (dpiTestCase_expectError(testCase,
+            "DPI-1074: parameter maxSessions cannot be zero") < 0)
+        return DPI_FAILURE;
+    if (dpiPool_release(pool) < 0)
+        return dpiTestCase_setFailedFromError(testCase);
+
+    return DPI_SUCCESS;
+}
+
+
+//-----------------------------------------------------------------------------
+// dpiTest_528_classLatencyBackoffOncePerWindow()
+//   Set a latency target for an admission class; execute statements that
+// exceed the target in several threads at the same time and verify that the
+// limit of the class is reduced by the backoff percentage only once.
+//-----------------------------------------------------------------------------
+int dpiTest_528_classLatencyBackoffOncePerWindow(dpiTestCase *testCase,
+        dpiTestParams *params)
+{
+    const char *sleepSql = "begin dbms_lock.sleep(0.5); end;";
+    dpiTestExecution executions[NUM_CLASS_THREADS];
+    dpiCommonCreateParams commonParams;
+    dpiConnCreateParams connParams;
+    dpiPoolClassParams classParams;
+    dpiPoolClassInfo classInfo;
+    dpiContext *context;
+    dpiPool *pool;
+    int i;
+#ifdef _WIN32
+    HANDLE threads[NUM_CLASS_THREADS];
+#else
+    pthread_t threads[NUM_CLASS_THREADS];
+#endif
+
+    // create threaded pool and set limits for the class
+    dpiTestSuite_getContext(&context);
+    if (dpiContext_initCommonCreateParams(context, &commonParams) < 0)
+        return dpiTestCase_setFailedFromError(testCase);
+    commonParams.createMode = DPI_MODE_CREATE_THREADED;
+    if (dpiPool_create(context, params->mainUserName,
+            params->mainUserNameLength, params->mainPassword,
+            params->mainPasswordLength, params->connectString,
+            params->connectStringLength, &commonParams, NULL, &pool) < 0)
+        return dpiTestCase_setFailedFromError(testCase);
+    if (dpiContext_initPoolClassParams(context, &classParams) < 0)
+        return dpiTestCase_setFailedFromError(testCase);
+    classParams.minSessions = 1;
+    classParams.maxSessions = 8;
+    classParams.latencyTarget = 10;
+    classParams.backoffPercent = 50;
+    if (dpiPool_setClassParams(pool, 1, &classParams) < 0)
+        return dpiTestCase_setFailedFromError(testCase);
+
+    // acquire a connection for each thread
+    if (dpiContext_initConnCreateParams(context, &connParams) < 0)
+        return dpiTestCase_setFailedFromError(testCase);
+    connParams.poolClass = 1;
+    for (i = 0; i < NUM_CLASS_THREADS; i++) {
+        executions[i].sql = sleepSql;
+        if (dpiPool_acquireConnection(pool, NULL, 0, NULL, 0, &connParams,
+                &executions[i].conn) < 0)
+            return dpiTestCase_setFailedFromError(testCase);
+    }
+
+    // execute the statement in all threads at the same time
+    for (i = 0; i < NUM_CLASS_THREADS; i++) {
+#ifdef _WIN32
+        threads[i] = CreateThread(NULL, 0, dpiTest__executeThread,
+                &executions[i], 0, NULL);
+        if (!threads[i])
+#else
+        if (pthread_create(&threads[i], NULL, dpiTest__executeThread,
+                &executions[i]) != 0)
+#endif
+            return dpiTestCase_setFailed(testCase, "unable to create thread");
+    }
+    for (i = 0; i < NUM_CLASS_THREADS; i++) {
+#ifdef _WIN32
+        WaitForSingleObject(threads[i], INFINITE);
+        CloseHandle(threads[i]);
+#else
+        pthread_join(threads[i], NULL);
+#endif
+    }
+
+    // verify that the limit was only reduced once
+    for (i = 0; i < NUM_CLASS_THREADS; i++) {
+        if (executions[i].status < 0)
+            return dpiTestCase_setFailed(testCase, "execution failed");
+    }
+    if (dpiPool_getClassInfo(pool, 1, &classInfo) < 0)
+        return dpiTestCase_setFailedFromError(testCase);
+    if (dpiTestCase_expectUintEqual(testCase, classInfo.limit, 4) < 0)
+        return DPI_FAILURE;
+
+    // cleanup
+    for (i = 0; i < NUM_CLASS_THREADS; i++) {
+        if (dpiConn_release(executions[i].conn) < 0)
+            return dpiTestCase_setFailedFromError(testCase);
+    }
+    if (dpiPool_release(pool) < 0)
+        return dpiTestCase_setFailedFromError(testCase);
+
+    return DPI_SUCCESS;
+}
+
+
 //-----------------------------------------------------------------------------
 // main()
 //-----------------------------------------------------------------------------
@@ -675,6 +1398,28 @@ int main(int argc, char **argv)
             "dpiPool_create() with NULL pool");
     dpiTestSuite_addCase(dpiTest_517_createNoCred,
             "dpiPool_create() with no credentials");
+    dpiTestSuite_addCase(dpiTest_518_reconfigure,
+            "dpiPool_reconfigure() with larger min and max sessions");
+    dpiTestSuite_addCase(dpiTest_519_reconfigureMinExceedsMax,
+            "dpiPool_reconfigure() with min sessions exceeding max sessions");
+    dpiTestSuite_addCase(dpiTest_520_classLimitExceeded,
+            "acquire connections beyond the limit of a pool class");
+    dpiTestSuite_addCase(dpiTest_521_invalidClass,
+            "dpiPool_setClassParams() with an invalid pool class");
+    dpiTestSuite_addCase(dpiTest_522_classLatencyBackoff,
+            "pool class limit reduced when latency target is exceeded");
+    dpiTestSuite_addCase(dpiTest_523_queryShared,
+            "dpiPool_queryShared() returns all rows of the query");
+    dpiTestSuite_addCase(dpiTest_524_querySharedConcurrently,
+            "dpiPool_queryShared() shares result between concurrent callers");
+    dpiTestSuite_addCase(dpiTest_525_querySharedWithHandle,
+            "dpiPool_queryShared() with a LOB bind value");
+    dpiTestSuite_addCase(dpiTest_526_sizingParamsZero,
+            "dpiPool_setSizingParams() with parameters that are zero");
+    dpiTestSuite_addCase(dpiTest_527_classParamsZero,
+            "dpiPool_setClassParams() with maximum sessions of zero");
+    dpiTestSuite_addCase(dpiTest_528_classLatencyBackoffOncePerWindow,
+            "pool class limit reduced once for concurrent slow executions");
     return dpiTestSuite_run();
 }
 
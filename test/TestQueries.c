@@ -16,6 +16,51 @@
 
 #include "TestLib.h"
 
+// size of the data area of the ring buffer used for exporting rows; batches of
+// two integer rows require 72 bytes so only two of them fit at the same time
+// and the third batch written always wraps around to the start
+#define RING_DATA_SIZE                  200
+#define RING_BATCH_ROWS                 2
+
+//-----------------------------------------------------------------------------
+// dpiTest__consumeRingBatch() [INTERNAL]
+//   Retrieve the next batch from the ring buffer, verify that it contains the
+// next rows expected and release it.
+//-----------------------------------------------------------------------------
+int dpiTest__consumeRingBatch(dpiTestCase *testCase, dpiRing *ring,
+        int64_t *nextValue)
+{
+    dpiRingColumn *column;
+    dpiRingBatch *batch;
+    int64_t *values;
+    char *nulls;
+    uint32_t i;
+
+    batch = dpiRing_getBatch(ring);
+    if (!batch)
+        return dpiTestCase_setFailed(testCase, "no batch in ring buffer");
+    if (dpiTestCase_expectUintEqual(testCase, batch->numRows,
+            RING_BATCH_ROWS) < 0)
+        return DPI_FAILURE;
+    if (dpiTestCase_expectUintEqual(testCase, batch->numColumns, 1) < 0)
+        return DPI_FAILURE;
+    column = (dpiRingColumn*) (batch + 1);
+    if (dpiTestCase_expectUintEqual(testCase, column->nativeTypeNum,
+            DPI_NATIVE_TYPE_INT64) < 0)
+        return DPI_FAILURE;
+    nulls = (char*) batch + column->nullsOffset;
+    values = (int64_t*) ((char*) batch + column->valuesOffset);
+    for (i = 0; i < batch->numRows; i++, (*nextValue)++) {
+        if (dpiTestCase_expectUintEqual(testCase, nulls[i], 0) < 0)
+            return DPI_FAILURE;
+        if (dpiTestCase_expectIntEqual(testCase, values[i], *nextValue) < 0)
+            return DPI_FAILURE;
+    }
+    dpiRing_releaseBatch(ring, batch);
+    return DPI_SUCCESS;
+}
+
+
 //-----------------------------------------------------------------------------
 // dpiTest__execStatement() [INTERNAL]
 //   Prepare and execute statements and, if necessary, check number of rows.
@@ -39,6 +84,26 @@ int dpiTest__execStatement(dpiTestCase *testCase, dpiConn *conn,
 }
 
 
+//-----------------------------------------------------------------------------
+// dpiTest__exportToRing() [INTERNAL]
+//   Export rows from the statement to the ring buffer and verify the number of
+// rows exported and whether more rows are available.
+//-----------------------------------------------------------------------------
+int dpiTest__exportToRing(dpiTestCase *testCase, dpiStmt *stmt, dpiRing *ring,
+        uint32_t expectedNumRows, int expectedMoreRows)
+{
+    uint32_t numRows;
+    int moreRows;
+
+    if (dpiStmt_fetchToRing(stmt, ring, RING_BATCH_ROWS, &numRows,
+            &moreRows) < 0)
+        return dpiTestCase_setFailedFromError(testCase);
+    if (dpiTestCase_expectUintEqual(testCase, numRows, expectedNumRows) < 0)
+        return DPI_FAILURE;
+    return dpiTestCase_expectIntEqual(testCase, moreRows, expectedMoreRows);
+}
+
+
 //-----------------------------------------------------------------------------
 // dpiTest__insertIntoTestLongs() [INTERNAL]
 //   Inserts rows into table.
@@ -522,6 +587,502 @@ int dpiTest_710_fetchRowsCheckCount(dpiTestCase *testCase,
 }
 
 
+//-----------------------------------------------------------------------------
+// dpiTest_711_fetchLimit()
+//   Prepare and execute a query returning more rows than the fetch limit set
+// with dpiStmt_setFetchLimit(); confirm that only that many rows are returned
+// by dpiStmt_fetch() each time the query is executed (no error).
+//-----------------------------------------------------------------------------
+int dpiTest_711_fetchLimit(dpiTestCase *testCase, dpiTestParams *params)
+{
+    const char *sql = "select level from dual connect by level <= 10";
+    uint32_t numQueryColumns, bufferRowIndex, numRows, iter;
+    uint64_t fetchLimit = 3, rowCount;
+    dpiConn *conn;
+    dpiStmt *stmt;
+    int found;
+
+    if (dpiTestCase_getConnection(testCase, &conn) < 0)
+        return DPI_FAILURE;
+    if (dpiConn_prepareStmt(conn, 0, sql, strlen(sql), NULL, 0, &stmt) < 0)
+        return dpiTestCase_setFailedFromError(testCase);
+    if (dpiStmt_setFetchLimit(stmt, fetchLimit) < 0)
+        return dpiTestCase_setFailedFromError(testCase);
+    for (iter = 0; iter < 2; iter++) {
+        if (dpiStmt_execute(stmt, DPI_MODE_EXEC_DEFAULT,
+                &numQueryColumns) < 0)
+            return dpiTestCase_setFailedFromError(testCase);
+        numRows = 0;
+        while (1) {
+            if (dpiStmt_fetch(stmt, &found, &bufferRowIndex) < 0)
+                return dpiTestCase_setFailedFromError(testCase);
+            if (!found)
+                break;
+            numRows++;
+        }
+        if (dpiTestCase_expectUintEqual(testCase, numRows, fetchLimit) < 0)
+            return DPI_FAILURE;
+        if (dpiStmt_getRowCount(stmt, &rowCount) < 0)
+            return dpiTestCase_setFailedFromError(testCase);
+        if (dpiTestCase_expectUintEqual(testCase, rowCount, fetchLimit) < 0)
+            return DPI_FAILURE;
+    }
+    dpiStmt_release(stmt);
+
+    return DPI_SUCCESS;
+}
+
+
+//-----------------------------------------------------------------------------
+// dpiTest_712_trimMemory()
+//   Prepare and execute a query and fetch all of its rows; call
+// dpiStmt_trimMemory() and confirm that memory is reclaimed; then execute the
+// query again and confirm that all rows are fetched a second time (no error).
+//-----------------------------------------------------------------------------
+int dpiTest_712_trimMemory(dpiTestCase *testCase, dpiTestParams *params)
+{
+    const char *sql = "select level from dual connect by level <= 10";
+    uint32_t numQueryColumns, bufferRowIndex, numRows, iter;
+    uint64_t bytesReclaimed;
+    dpiConn *conn;
+    dpiStmt *stmt;
+    int found;
+
+    if (dpiTestCase_getConnection(testCase, &conn) < 0)
+        return DPI_FAILURE;
+    if (dpiConn_prepareStmt(conn, 0, sql, strlen(sql), NULL, 0, &stmt) < 0)
+        return dpiTestCase_setFailedFromError(testCase);
+    for (iter = 0; iter < 2; iter++) {
+        if (dpiStmt_execute(stmt, DPI_MODE_EXEC_DEFAULT,
+                &numQueryColumns) < 0)
+            return dpiTestCase_setFailedFromError(testCase);
+        numRows = 0;
+        while (1) {
+            if (dpiStmt_fetch(stmt, &found, &bufferRowIndex) < 0)
+                return dpiTestCase_setFailedFromError(testCase);
+            if (!found)
+                break;
+            numRows++;
+        }
+        if (dpiTestCase_expectUintEqual(testCase, numRows, 10) < 0)
+            return DPI_FAILURE;
+        if (dpiStmt_trimMemory(stmt, 0, &bytesReclaimed) < 0)
+            return dpiTestCase_setFailedFromError(testCase);
+        if (bytesReclaimed == 0)
+            return dpiTestCase_setFailed(testCase,
+                    "no memory reclaimed after all rows fetched");
+    }
+    dpiStmt_release(stmt);
+
+    return DPI_SUCCESS;
+}
+
+
+//-----------------------------------------------------------------------------
+// dpiTest_713_fetchFingerprint()
+//   Fetch the same rows in different orders and with different fetch array
+// sizes and compute fingerprints of them; verify that the order-independent
+// digests match and that the ordered digests do not (no error).
+//-----------------------------------------------------------------------------
+int dpiTest_713_fetchFingerprint(dpiTestCase *testCase,
+        dpiTestParams *params)
+{
+    const char *baseSql = "select level, 'Row ' || level, "
+            "date '2017-01-01' + level from dual connect by level <= 100";
+    uint64_t columnDigests[2][3];
+    dpiFingerprint fingerprints[2];
+    uint32_t numQueryColumns, i;
+    char sql[200];
+    dpiConn *conn;
+    dpiStmt *stmt;
+
+    if (dpiTestCase_getConnection(testCase, &conn) < 0)
+        return DPI_FAILURE;
+    memset(fingerprints, 0, sizeof(fingerprints));
+    memset(columnDigests, 0, sizeof(columnDigests));
+    for (i = 0; i < 2; i++) {
+        sprintf(sql, "%s order by 1%s", baseSql, (i == 0) ? "" : " desc");
+        fingerprints[i].numColumns = 3;
+        fingerprints[i].columnDigests = columnDigests[i];
+        if (dpiConn_prepareStmt(conn, 0, sql, strlen(sql), NULL, 0,
+                &stmt) < 0)
+            return dpiTestCase_setFailedFromError(testCase);
+        if (dpiStmt_setFetchArraySize(stmt, (i == 0) ? 7 : 100) < 0)
+            return dpiTestCase_setFailedFromError(testCase);
+        if (dpiStmt_execute(stmt, DPI_MODE_EXEC_DEFAULT,
+                &numQueryColumns) < 0)
+            return dpiTestCase_setFailedFromError(testCase);
+        if (dpiStmt_fetchFingerprint(stmt, &fingerprints[i]) < 0)
+            return dpiTestCase_setFailedFromError(testCase);
+        dpiStmt_release(stmt);
+        if (dpiTestCase_expectUintEqual(testCase, fingerprints[i].numRows,
+                100) < 0)
+            return DPI_FAILURE;
+    }
+    if (fingerprints[0].unorderedDigest != fingerprints[1].unorderedDigest)
+        return dpiTestCase_setFailed(testCase,
+                "unordered digests do not match");
+    if (memcmp(columnDigests[0], columnDigests[1],
+            sizeof(columnDigests[0])) != 0)
+        return dpiTestCase_setFailed(testCase, "column digests do not match");
+    if (fingerprints[0].orderedDigest == fingerprints[1].orderedDigest)
+        return dpiTestCase_setFailed(testCase,
+                "ordered digests match for rows in different orders");
+
+    return DPI_SUCCESS;
+}
+
+
+//-----------------------------------------------------------------------------
+// dpiTest_714_fetchAggregates()
+//   Fetch rows with a small fetch array size and compute the count, minimum,
+// maximum and estimated number of distinct values of a string column; verify
+// that strings are compared as bytes (no error).
+//-----------------------------------------------------------------------------
+int dpiTest_714_fetchAggregates(dpiTestCase *testCase,
+        dpiTestParams *params)
+{
+    const char *sql =
+            "select to_char(level) from dual connect by level <= 100";
+    dpiAggregateSpec specs[5] = {
+        { DPI_AGGREGATE_COUNT, 0 },
+        { DPI_AGGREGATE_COUNT, 1 },
+        { DPI_AGGREGATE_MIN, 1 },
+        { DPI_AGGREGATE_MAX, 1 },
+        { DPI_AGGREGATE_DISTINCT_ESTIMATE, 1 }
+    };
+    dpiNativeTypeNum nativeTypeNums[5];
+    dpiAggregateResult *result;
+    uint32_t numQueryColumns, numGroups, i;
+    dpiData *values[5];
+    dpiConn *conn;
+    dpiStmt *stmt;
+
+    if (dpiTestCase_getConnection(testCase, &conn) < 0)
+        return DPI_FAILURE;
+    if (dpiConn_prepareStmt(conn, 0, sql, strlen(sql), NULL, 0, &stmt) < 0)
+        return dpiTestCase_setFailedFromError(testCase);
+    if (dpiStmt_setFetchArraySize(stmt, 7) < 0)
+        return dpiTestCase_setFailedFromError(testCase);
+    if (dpiStmt_execute(stmt, DPI_MODE_EXEC_DEFAULT, &numQueryColumns) < 0)
+        return dpiTestCase_setFailedFromError(testCase);
+    if (dpiStmt_fetchAggregates(stmt, 5, specs, 0, &result) < 0)
+        return dpiTestCase_setFailedFromError(testCase);
+    dpiStmt_release(stmt);
+    if (dpiAggregateResult_getNumGroups(result, &numGroups) < 0)
+        return dpiTestCase_setFailedFromError(testCase);
+    if (dpiTestCase_expectUintEqual(testCase, numGroups, 1) < 0)
+        return DPI_FAILURE;
+    for (i = 0; i < 5; i++) {
+        if (dpiAggregateResult_getValue(result, 0, i, &nativeTypeNums[i],
+                &values[i]) < 0)
+            return dpiTestCase_setFailedFromError(testCase);
+    }
+    if (dpiTestCase_expectUintEqual(testCase, values[0]->value.asUint64,
+            100) < 0)
+        return DPI_FAILURE;
+    if (dpiTestCase_expectUintEqual(testCase, values[1]->value.asUint64,
+            100) < 0)
+        return DPI_FAILURE;
+    if (dpiTestCase_expectUintEqual(testCase, nativeTypeNums[2],
+            DPI_NATIVE_TYPE_BYTES) < 0)
+        return DPI_FAILURE;
+    if (dpiTestCase_expectStringEqual(testCase, values[2]->value.asBytes.ptr,
+            values[2]->value.asBytes.length, "1", 1) < 0)
+        return DPI_FAILURE;
+    if (dpiTestCase_expectStringEqual(testCase, values[3]->value.asBytes.ptr,
+            values[3]->value.asBytes.length, "99", 2) < 0)
+        return DPI_FAILURE;
+    if (values[4]->value.asUint64 < 95 || values[4]->value.asUint64 > 105)
+        return dpiTestCase_setFailed(testCase,
+                "estimate of distinct values is not close to 100");
+    dpiAggregateResult_release(result);
+
+    return DPI_SUCCESS;
+}
+
+
+//-----------------------------------------------------------------------------
+// dpiTest_715_fetchAggregatesGroupBy()
+//   Define a column as a native integer and compute its sum, minimum and
+// maximum, then compute the count and sum grouped by the same column; verify
+// that the integers are summed and compared as integers (no error).
+//-----------------------------------------------------------------------------
+int dpiTest_715_fetchAggregatesGroupBy(dpiTestCase *testCase,
+        dpiTestParams *params)
+{
+    const char *sql = "select level from dual connect by level <= 10";
+    dpiAggregateSpec specs[3] = {
+        { DPI_AGGREGATE_SUM, 1 },
+        { DPI_AGGREGATE_MIN, 1 },
+        { DPI_AGGREGATE_MAX, 1 }
+    };
+    dpiAggregateSpec groupSpecs[2] = {
+        { DPI_AGGREGATE_COUNT, 0 },
+        { DPI_AGGREGATE_SUM, 1 }
+    };
+    uint32_t numQueryColumns, numGroups, i, j;
+    dpiNativeTypeNum nativeTypeNum;
+    dpiAggregateResult *result;
+    int64_t expectedValues[3];
+    dpiData *key, *value;
+    dpiConn *conn;
+    dpiStmt *stmt;
+
+    if (dpiTestCase_getConnection(testCase, &conn) < 0)
+        return DPI_FAILURE;
+    for (i = 0; i < 2; i++) {
+        if (dpiConn_prepareStmt(conn, 0, sql, strlen(sql), NULL, 0,
+                &stmt) < 0)
+            return dpiTestCase_setFailedFromError(testCase);
+        if (dpiStmt_setFetchArraySize(stmt, 3) < 0)
+            return dpiTestCase_setFailedFromError(testCase);
+        if (dpiStmt_execute(stmt, DPI_MODE_EXEC_DEFAULT,
+                &numQueryColumns) < 0)
+            return dpiTestCase_setFailedFromError(testCase);
+        if (dpiStmt_defineValue(stmt, 1, DPI_ORACLE_TYPE_NATIVE_INT,
+                DPI_NATIVE_TYPE_INT64, 0, 0, NULL) < 0)
+            return dpiTestCase_setFailedFromError(testCase);
+        if (dpiStmt_fetchAggregates(stmt, (i == 0) ? 3 : 2,
+                (i == 0) ? specs : groupSpecs, (i == 0) ? 0 : 1,
+                &result) < 0)
+            return dpiTestCase_setFailedFromError(testCase);
+        dpiStmt_release(stmt);
+        if (dpiAggregateResult_getNumGroups(result, &numGroups) < 0)
+            return dpiTestCase_setFailedFromError(testCase);
+        if (dpiTestCase_expectUintEqual(testCase, numGroups,
+                (i == 0) ? 1 : 10) < 0)
+            return DPI_FAILURE;
+
+        // without grouping: the sum, minimum and maximum of all rows
+        if (i == 0) {
+            expectedValues[0] = 55;
+            expectedValues[1] = 1;
+            expectedValues[2] = 10;
+            for (j = 0; j < 3; j++) {
+                if (dpiAggregateResult_getValue(result, 0, j,
+                        &nativeTypeNum, &value) < 0)
+                    return dpiTestCase_setFailedFromError(testCase);
+                if (dpiTestCase_expectUintEqual(testCase, nativeTypeNum,
+                        DPI_NATIVE_TYPE_INT64) < 0)
+                    return DPI_FAILURE;
+                if (dpiTestCase_expectIntEqual(testCase,
+                        value->value.asInt64, expectedValues[j]) < 0)
+                    return DPI_FAILURE;
+            }
+            dpiAggregateResult_release(result);
+            continue;
+        }
+
+        // grouped by the column itself: each group has one row whose sum is
+        // the value of the group
+        for (j = 0; j < numGroups; j++) {
+            if (dpiAggregateResult_getGroupKey(result, j, &nativeTypeNum,
+                    &key) < 0)
+                return dpiTestCase_setFailedFromError(testCase);
+            if (dpiAggregateResult_getValue(result, j, 0, &nativeTypeNum,
+                    &value) < 0)
+                return dpiTestCase_setFailedFromError(testCase);
+            if (dpiTestCase_expectUintEqual(testCase, value->value.asUint64,
+                    1) < 0)
+                return DPI_FAILURE;
+            if (dpiAggregateResult_getValue(result, j, 1, &nativeTypeNum,
+                    &value) < 0)
+                return dpiTestCase_setFailedFromError(testCase);
+            if (dpiTestCase_expectIntEqual(testCase, value->value.asInt64,
+                    key->value.asInt64) < 0)
+                return DPI_FAILURE;
+        }
+        dpiAggregateResult_release(result);
+    }
+
+    return DPI_SUCCESS;
+}
+
+
+//-----------------------------------------------------------------------------
+// dpiTest_716_fetchAggregatesNotSupported()
+//   Call dpiStmt_fetchAggregates() with the sum of a string column (error
+// DPI-1066).
+//-----------------------------------------------------------------------------
+int dpiTest_716_fetchAggregatesNotSupported(dpiTestCase *testCase,
+        dpiTestParams *params)
+{
+    const char *sql = "select to_char(level) from dual connect by level <= 5";
+    dpiAggregateSpec spec = { DPI_AGGREGATE_SUM, 1 };
+    dpiAggregateResult *result;
+    uint32_t numQueryColumns;
+    dpiConn *conn;
+    dpiStmt *stmt;
+
+    if (dpiTestCase_getConnection(testCase, &conn) < 0)
+        return DPI_FAILURE;
+    if (dpiConn_prepareStmt(conn, 0, sql, strlen(sql), NULL, 0, &stmt) < 0)
+        return dpiTestCase_setFailedFromError(testCase);
+    if (dpiStmt_execute(stmt, DPI_MODE_EXEC_DEFAULT, &numQueryColumns) < 0)
+        return dpiTestCase_setFailedFromError(testCase);
+    dpiStmt_fetchAggregates(stmt, 1, &spec, 0, &result);
+    if (dpiTestCase_expectError(testCase, "DPI-1066: aggregate 2 is not "
+            "supported for the column at position 1") < 0)
+        return DPI_FAILURE;
+    dpiStmt_release(stmt);
+
+    return DPI_SUCCESS;
+}
+
+
+//-----------------------------------------------------------------------------
+// dpiTest_717_trimMemoryKeepsDefines()
+//   Prepare and execute a query; define its column with a variable of native
+// type int64 and release the variable; fetch all of the rows and call
+// dpiStmt_trimMemory(); execute the query again and confirm that the rows are
+// still fetched as int64 values (no error).
+//-----------------------------------------------------------------------------
+int dpiTest_717_trimMemoryKeepsDefines(dpiTestCase *testCase,
+        dpiTestParams *params)
+{
+    const char *sql = "select level from dual connect by level <= 10";
+    uint32_t numQueryColumns, bufferRowIndex, iter;
+    dpiNativeTypeNum nativeTypeNum;
+    uint64_t bytesReclaimed;
+    dpiData *data;
+    dpiConn *conn;
+    dpiStmt *stmt;
+    dpiVar *var;
+    int found;
+
+    if (dpiTestCase_getConnection(testCase, &conn) < 0)
+        return DPI_FAILURE;
+    if (dpiConn_prepareStmt(conn, 0, sql, strlen(sql), NULL, 0, &stmt) < 0)
+        return dpiTestCase_setFailedFromError(testCase);
+    for (iter = 0; iter < 2; iter++) {
+        if (dpiStmt_execute(stmt, DPI_MODE_EXEC_DEFAULT,
+                &numQueryColumns) < 0)
+            return dpiTestCase_setFailedFromError(testCase);
+        if (iter == 0) {
+            if (dpiConn_newVar(conn, DPI_ORACLE_TYPE_NATIVE_INT,
+                    DPI_NATIVE_TYPE_INT64, DPI_DEFAULT_FETCH_ARRAY_SIZE, 0, 0,
+                    0, NULL, &var, &data) < 0)
+                return dpiTestCase_setFailedFromError(testCase);
+            if (dpiStmt_define(stmt, 1, var) < 0)
+                return dpiTestCase_setFailedFromError(testCase);
+            if (dpiVar_release(var) < 0)
+                return dpiTestCase_setFailedFromError(testCase);
+        }
+        if (dpiStmt_fetch(stmt, &found, &bufferRowIndex) < 0)
+            return dpiTestCase_setFailedFromError(testCase);
+        if (dpiStmt_getQueryValue(stmt, 1, &nativeTypeNum, &data) < 0)
+            return dpiTestCase_setFailedFromError(testCase);
+        if (dpiTestCase_expectUintEqual(testCase, nativeTypeNum,
+                DPI_NATIVE_TYPE_INT64) < 0)
+            return DPI_FAILURE;
+        while (found) {
+            if (dpiStmt_fetch(stmt, &found, &bufferRowIndex) < 0)
+                return dpiTestCase_setFailedFromError(testCase);
+        }
+        if (dpiStmt_trimMemory(stmt, 0, &bytesReclaimed) < 0)
+            return dpiTestCase_setFailedFromError(testCase);
+    }
+    dpiStmt_release(stmt);
+
+    return DPI_SUCCESS;
+}
+
+
+//-----------------------------------------------------------------------------
+// dpiTest_718_fetchToRingConsumer()
+//   Initialize a ring buffer with room for two batches and verify that it is
+// empty; export batches of rows until it is full; consume batches and export
+// more rows so that batches wrap around the end of the ring buffer after
+// padding; verify that the consumer skips the padding, retrieves every row in
+// order and finds the ring buffer empty once all batches are released (no
+// error).
+//-----------------------------------------------------------------------------
+int dpiTest_718_fetchToRingConsumer(dpiTestCase *testCase,
+        dpiTestParams *params)
+{
+    const char *sql = "select level from dual connect by level <= 10";
+    uint64_t memory[(sizeof(dpiRing) + RING_DATA_SIZE) / 8];
+    dpiRing *ring = (dpiRing*) memory;
+    uint32_t numQueryColumns;
+    int64_t nextValue = 1;
+    dpiData *data;
+    dpiConn *conn;
+    dpiStmt *stmt;
+    dpiVar *var;
+
+    // the ring buffer is initially empty
+    if (dpiRing_init(ring, sizeof(memory)) < 0)
+        return dpiTestCase_setFailedFromError(testCase);
+    if (dpiRing_getBatch(ring))
+        return dpiTestCase_setFailed(testCase, "new ring buffer not empty");
+
+    // prepare and execute the query
+    if (dpiTestCase_getConnection(testCase, &conn) < 0)
+        return DPI_FAILURE;
+    if (dpiConn_prepareStmt(conn, 0, sql, strlen(sql), NULL, 0, &stmt) < 0)
+        return dpiTestCase_setFailedFromError(testCase);
+    if (dpiStmt_execute(stmt, DPI_MODE_EXEC_DEFAULT, &numQueryColumns) < 0)
+        return dpiTestCase_setFailedFromError(testCase);
+    if (dpiConn_newVar(conn, DPI_ORACLE_TYPE_NATIVE_INT, DPI_NATIVE_TYPE_INT64,
+            DPI_DEFAULT_FETCH_ARRAY_SIZE, 0, 0, 0, NULL, &var, &data) < 0)
+        return dpiTestCase_setFailedFromError(testCase);
+    if (dpiStmt_define(stmt, 1, var) < 0)
+        return dpiTestCase_setFailedFromError(testCase);
+
+    // export rows until the ring buffer is full
+    if (dpiTest__exportToRing(testCase, stmt, ring, RING_BATCH_ROWS, 1) < 0)
+        return DPI_FAILURE;
+    if (dpiTest__exportToRing(testCase, stmt, ring, RING_BATCH_ROWS, 1) < 0)
+        return DPI_FAILURE;
+    if (dpiTest__exportToRing(testCase, stmt, ring, 0, 1) < 0)
+        return DPI_FAILURE;
+
+    // releasing the first batch allows the third to be written at the start
+    // of the ring buffer, after which it is full again
+    if (dpiTest__consumeRingBatch(testCase, ring, &nextValue) < 0)
+        return DPI_FAILURE;
+    if (dpiTest__exportToRing(testCase, stmt, ring, RING_BATCH_ROWS, 1) < 0)
+        return DPI_FAILURE;
+    if (dpiTest__exportToRing(testCase, stmt, ring, 0, 1) < 0)
+        return DPI_FAILURE;
+
+    // consume the remaining batches, skipping the padding at the end
+    if (dpiTest__consumeRingBatch(testCase, ring, &nextValue) < 0)
+        return DPI_FAILURE;
+    if (dpiTest__consumeRingBatch(testCase, ring, &nextValue) < 0)
+        return DPI_FAILURE;
+    if (dpiRing_getBatch(ring))
+        return dpiTestCase_setFailed(testCase,
+                "drained ring buffer not empty");
+
+    // export the remaining rows, wrapping around a second time
+    if (dpiTest__exportToRing(testCase, stmt, ring, RING_BATCH_ROWS, 1) < 0)
+        return DPI_FAILURE;
+    if (dpiTest__exportToRing(testCase, stmt, ring, RING_BATCH_ROWS, 0) < 0)
+        return DPI_FAILURE;
+    if (dpiTest__exportToRing(testCase, stmt, ring, 0, 0) < 0)
+        return DPI_FAILURE;
+    if (dpiTest__consumeRingBatch(testCase, ring, &nextValue) < 0)
+        return DPI_FAILURE;
+    if (dpiTest__consumeRingBatch(testCase, ring, &nextValue) < 0)
+        return DPI_FAILURE;
+    if (dpiRing_getBatch(ring))
+        return dpiTestCase_setFailed(testCase,
+                "drained ring buffer not empty");
+    if (dpiTestCase_expectIntEqual(testCase, nextValue, 11) < 0)
+        return DPI_FAILURE;
+
+    // cleanup
+    if (dpiVar_release(var) < 0)
+        return dpiTestCase_setFailedFromError(testCase);
+    if (dpiStmt_release(stmt) < 0)
+        return dpiTestCase_setFailedFromError(testCase);
+
+    return DPI_SUCCESS;
+}
+
+
 //-----------------------------------------------------------------------------
 // main()
 //-----------------------------------------------------------------------------
@@ -550,6 +1111,22 @@ int main(int argc, char **argv)
             "dpiStmt_fetch() increments rowcount");
     dpiTestSuite_addCase(dpiTest_710_fetchRowsCheckCount,
             "dpiStmt_fetchRows() increments rowcount");
+    dpiTestSuite_addCase(dpiTest_711_fetchLimit,
+            "dpiStmt_setFetchLimit() limits rows fetched");
+    dpiTestSuite_addCase(dpiTest_712_trimMemory,
+            "dpiStmt_trimMemory() releases query variables after fetch");
+    dpiTestSuite_addCase(dpiTest_713_fetchFingerprint,
+            "dpiStmt_fetchFingerprint() digests with different row orders");
+    dpiTestSuite_addCase(dpiTest_714_fetchAggregates,
+            "dpiStmt_fetchAggregates() over a string column");
+    dpiTestSuite_addCase(dpiTest_715_fetchAggregatesGroupBy,
+            "dpiStmt_fetchAggregates() over an integer column with grouping");
+    dpiTestSuite_addCase(dpiTest_716_fetchAggregatesNotSupported,
+            "dpiStmt_fetchAggregates() with unsupported aggregate");
+    dpiTestSuite_addCase(dpiTest_717_trimMemoryKeepsDefines,
+            "dpiStmt_trimMemory() retains variables defined by the caller");
+    dpiTestSuite_addCase(dpiTest_718_fetchToRingConsumer,
+            "dpiRing_getBatch() with full, empty and wrapped ring buffer");
     return dpiTestSuite_run();
 }
 
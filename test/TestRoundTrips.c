@@ -0,0 +1,696 @@
+//-----------------------------------------------------------------------------
+// Copyright (c) 2017 Oracle and/or its affiliates.  All rights reserved.
+// This program is free software: you can modify it and/or redistribute it
+// under the terms of:
+//
+// (i)  the Universal Permissive License v 1.0 or at your option, any
+//      later version (http://oss.oracle.com/licenses/upl); and/or
+//
+// (ii) the Apache License v 2.0. (http://www.apache.org/licenses/LICENSE-2.0)
+//-----------------------------------------------------------------------------
+
+//-----------------------------------------------------------------------------
+// TestRoundTrips.c
+//   Test suite verifying the number of round trips made to the database for
+// common operations. Each operation has a budget which must not be changed
+// without good reason. These tests are intended to be run against the stub
+// OCI library found in StubOci.c (see README.md) but also pass when run
+// against a real database.
+//-----------------------------------------------------------------------------
+
+#include "TestLib.h"
+
+#define QUERY_NUM_ROWS                  250
+#define QUERY_ARRAY_SIZE                100
+#define LOB_TRANSFER_SIZE               2500000
+
+//-----------------------------------------------------------------------------
+// dpiTest__expectRoundTrips()
+//   Verify that the number of round trips made by the connection since the
+// last call matches the expected budget.
+//-----------------------------------------------------------------------------
+int dpiTest__expectRoundTrips(dpiTestCase *testCase, dpiConn *conn,
+        uint64_t *lastRoundTrips, uint64_t expectedRoundTrips)
+{
+    uint64_t roundTrips;
+
+    if (dpiConn_getRoundTrips(conn, &roundTrips) < 0)
+        return dpiTestCase_setFailedFromError(testCase);
+    if (dpiTestCase_expectUintEqual(testCase, roundTrips - *lastRoundTrips,
+            expectedRoundTrips) < 0)
+        return DPI_FAILURE;
+    *lastRoundTrips = roundTrips;
+    return DPI_SUCCESS;
+}
+
+
+//-----------------------------------------------------------------------------
+// dpiTest__createPool()
+//   Create a pool with the specified ping interval.
+//-----------------------------------------------------------------------------
+int dpiTest__createPool(dpiTestCase *testCase, dpiTestParams *params,
+        int pingInterval, dpiPool **pool)
+{
+    dpiPoolCreateParams createParams;
+    dpiContext *context;
+
+    dpiTestSuite_getContext(&context);
+    if (dpiContext_initPoolCreateParams(context, &createParams) < 0)
+        return dpiTestCase_setFailedFromError(testCase);
+    createParams.pingInterval = pingInterval;
+    if (dpiPool_create(context, params->mainUserName,
+            params->mainUserNameLength, params->mainPassword,
+            params->mainPasswordLength, params->connectString,
+            params->connectStringLength, NULL, &createParams, pool) < 0)
+        return dpiTestCase_setFailedFromError(testCase);
+    return DPI_SUCCESS;
+}
+
+
+//-----------------------------------------------------------------------------
+// dpiTest_2400_verifyStandaloneConnect()
+//   Create a standalone connection (no error) and verify that two round trips
+// were made, one to attach to the server and one to begin the session.
+//-----------------------------------------------------------------------------
+int dpiTest_2400_verifyStandaloneConnect(dpiTestCase *testCase,
+        dpiTestParams *params)
+{
+    uint64_t roundTrips = 0;
+    dpiConn *conn;
+
+    if (dpiTestCase_getConnection(testCase, &conn) < 0)
+        return DPI_FAILURE;
+    return dpiTest__expectRoundTrips(testCase, conn, &roundTrips, 2);
+}
+
+
+//-----------------------------------------------------------------------------
+// dpiTest_2401_verifyTransactionControl()
+//   Call dpiConn_commit(), dpiConn_rollback() and dpiConn_ping() (no error)
+// and verify that each makes exactly one round trip.
+//-----------------------------------------------------------------------------
+int dpiTest_2401_verifyTransactionControl(dpiTestCase *testCase,
+        dpiTestParams *params)
+{
+    uint64_t roundTrips = 0;
+    dpiConn *conn;
+
+    if (dpiTestCase_getConnection(testCase, &conn) < 0)
+        return DPI_FAILURE;
+    if (dpiTest__expectRoundTrips(testCase, conn, &roundTrips, 2) < 0)
+        return DPI_FAILURE;
+    if (dpiConn_commit(conn) < 0)
+        return dpiTestCase_setFailedFromError(testCase);
+    if (dpiTest__expectRoundTrips(testCase, conn, &roundTrips, 1) < 0)
+        return DPI_FAILURE;
+    if (dpiConn_rollback(conn) < 0)
+        return dpiTestCase_setFailedFromError(testCase);
+    if (dpiTest__expectRoundTrips(testCase, conn, &roundTrips, 1) < 0)
+        return DPI_FAILURE;
+    if (dpiConn_ping(conn) < 0)
+        return dpiTestCase_setFailedFromError(testCase);
+    return dpiTest__expectRoundTrips(testCase, conn, &roundTrips, 1);
+}
+
+
+//-----------------------------------------------------------------------------
+// dpiTest_2402_verifyServerVersionCached()
+//   Call dpiConn_getServerVersion() twice (no error) and verify that only the
+// first call makes a round trip.
+//-----------------------------------------------------------------------------
+int dpiTest_2402_verifyServerVersionCached(dpiTestCase *testCase,
+        dpiTestParams *params)
+{
+    uint32_t releaseStringLength;
+    dpiVersionInfo versionInfo;
+    const char *releaseString;
+    uint64_t roundTrips = 0;
+    dpiConn *conn;
+
+    if (dpiTestCase_getConnection(testCase, &conn) < 0)
+        return DPI_FAILURE;
+    if (dpiTest__expectRoundTrips(testCase, conn, &roundTrips, 2) < 0)
+        return DPI_FAILURE;
+    if (dpiConn_getServerVersion(conn, &releaseString, &releaseStringLength,
+            &versionInfo) < 0)
+        return dpiTestCase_setFailedFromError(testCase);
+    if (dpiTest__expectRoundTrips(testCase, conn, &roundTrips, 1) < 0)
+        return DPI_FAILURE;
+    if (dpiConn_getServerVersion(conn, &releaseString, &releaseStringLength,
+            &versionInfo) < 0)
+        return dpiTestCase_setFailedFromError(testCase);
+    return dpiTest__expectRoundTrips(testCase, conn, &roundTrips, 0);
+}
+
+
+//-----------------------------------------------------------------------------
+// dpiTest_2403_verifyQueryFetch()
+//   Prepare and execute a query returning 250 rows with an array size of 100
+// and fetch all of the rows (no error); verify that preparing the statement
+// makes no round trips, executing it makes one and that the first fetch is
+// satisfied by the rows prefetched during execution so that only two more
+// round trips are made to fetch the remaining rows.
+//-----------------------------------------------------------------------------
+int dpiTest_2403_verifyQueryFetch(dpiTestCase *testCase,
+        dpiTestParams *params)
+{
+    const char *sql = "select to_char(level) from dual "
+            "connect by level <= 250";
+    uint32_t numQueryColumns, bufferRowIndex, numRowsFetched = 0;
+    uint64_t roundTrips = 0;
+    dpiConn *conn;
+    dpiStmt *stmt;
+    int found;
+
+    if (dpiTestCase_getConnection(testCase, &conn) < 0)
+        return DPI_FAILURE;
+    if (dpiTest__expectRoundTrips(testCase, conn, &roundTrips, 2) < 0)
+        return DPI_FAILURE;
+    if (dpiConn_prepareStmt(conn, 0, sql, strlen(sql), NULL, 0, &stmt) < 0)
+        return dpiTestCase_setFailedFromError(testCase);
+    if (dpiStmt_setFetchArraySize(stmt, QUERY_ARRAY_SIZE) < 0)
+        return dpiTestCase_setFailedFromError(testCase);
+    if (dpiTest__expectRoundTrips(testCase, conn, &roundTrips, 0) < 0)
+        return DPI_FAILURE;
+    if (dpiStmt_execute(stmt, 0, &numQueryColumns) < 0)
+        return dpiTestCase_setFailedFromError(testCase);
+    if (dpiTest__expectRoundTrips(testCase, conn, &roundTrips, 1) < 0)
+        return DPI_FAILURE;
+    while (1) {
+        if (dpiStmt_fetch(stmt, &found, &bufferRowIndex) < 0)
+            return dpiTestCase_setFailedFromError(testCase);
+        if (!found)
+            break;
+        numRowsFetched++;
+    }
+    if (dpiTestCase_expectUintEqual(testCase, numRowsFetched,
+            QUERY_NUM_ROWS) < 0)
+        return DPI_FAILURE;
+    if (dpiTest__expectRoundTrips(testCase, conn, &roundTrips, 2) < 0)
+        return DPI_FAILURE;
+    if (dpiStmt_release(stmt) < 0)
+        return dpiTestCase_setFailedFromError(testCase);
+    return dpiTest__expectRoundTrips(testCase, conn, &roundTrips, 0);
+}
+
+
+//-----------------------------------------------------------------------------
+// dpiTest_2404_verifyStandaloneClose()
+//   Close a standalone connection (no error) and verify that three round trips
+// are made: one to roll back any outstanding transaction, one to end the
+// session and one to detach from the server.
+//-----------------------------------------------------------------------------
+int dpiTest_2404_verifyStandaloneClose(dpiTestCase *testCase,
+        dpiTestParams *params)
+{
+    uint64_t roundTrips = 0;
+    dpiConn *conn;
+
+    if (dpiTestCase_getConnection(testCase, &conn) < 0)
+        return DPI_FAILURE;
+    if (dpiTest__expectRoundTrips(testCase, conn, &roundTrips, 2) < 0)
+        return DPI_FAILURE;
+    if (dpiConn_close(conn, DPI_MODE_CONN_CLOSE_DEFAULT, NULL, 0) < 0)
+        return dpiTestCase_setFailedFromError(testCase);
+    return dpiTest__expectRoundTrips(testCase, conn, &roundTrips, 3);
+}
+
+
+//-----------------------------------------------------------------------------
+// dpiTest_2405_verifyPoolAcquire()
+//   Create a pool with a negative ping interval, acquire a connection from it
+// and release it again (no error); verify that acquiring the connection makes
+// one round trip and releasing it makes one round trip (to roll back any
+// outstanding transaction).
+//-----------------------------------------------------------------------------
+int dpiTest_2405_verifyPoolAcquire(dpiTestCase *testCase,
+        dpiTestParams *params)
+{
+    uint64_t roundTrips = 0;
+    dpiConn *conn;
+    dpiPool *pool;
+
+    if (dpiTest__createPool(testCase, params, -1, &pool) < 0)
+        return DPI_FAILURE;
+    if (dpiPool_acquireConnection(pool, NULL, 0, NULL, 0, NULL, &conn) < 0)
+        return dpiTestCase_setFailedFromError(testCase);
+    if (dpiTest__expectRoundTrips(testCase, conn, &roundTrips, 1) < 0)
+        return DPI_FAILURE;
+    if (dpiConn_close(conn, DPI_MODE_CONN_CLOSE_DEFAULT, NULL, 0) < 0)
+        return dpiTestCase_setFailedFromError(testCase);
+    if (dpiTest__expectRoundTrips(testCase, conn, &roundTrips, 1) < 0)
+        return DPI_FAILURE;
+    if (dpiConn_release(conn) < 0)
+        return dpiTestCase_setFailedFromError(testCase);
+    if (dpiPool_release(pool) < 0)
+        return dpiTestCase_setFailedFromError(testCase);
+    return DPI_SUCCESS;
+}
+
+
+//-----------------------------------------------------------------------------
+// dpiTest_2406_verifyPoolAcquireWithPing()
+//   Create a pool with a ping interval of zero, acquire a connection from it,
+// release it and acquire it again (no error); verify that when the Oracle
+// client is older than 12.2, the second acquire pings the session, making one
+// additional round trip.
+//-----------------------------------------------------------------------------
+int dpiTest_2406_verifyPoolAcquireWithPing(dpiTestCase *testCase,
+        dpiTestParams *params)
+{
+    dpiVersionInfo *versionInfo;
+    uint64_t roundTrips = 0;
+    uint64_t expected;
+    dpiConn *conn;
+    dpiPool *pool;
+
+    dpiTestSuite_getClientVersionInfo(&versionInfo);
+    expected = (versionInfo->versionNum > 12 ||
+            (versionInfo->versionNum == 12 && versionInfo->releaseNum >= 2)) ?
+            1 : 2;
+    if (dpiTest__createPool(testCase, params, 0, &pool) < 0)
+        return DPI_FAILURE;
+    if (dpiPool_acquireConnection(pool, NULL, 0, NULL, 0, NULL, &conn) < 0)
+        return dpiTestCase_setFailedFromError(testCase);
+    if (dpiTest__expectRoundTrips(testCase, conn, &roundTrips, 1) < 0)
+        return DPI_FAILURE;
+    if (dpiConn_release(conn) < 0)
+        return dpiTestCase_setFailedFromError(testCase);
+    roundTrips = 0;
+    if (dpiPool_acquireConnection(pool, NULL, 0, NULL, 0, NULL, &conn) < 0)
+        return dpiTestCase_setFailedFromError(testCase);
+    if (dpiTest__expectRoundTrips(testCase, conn, &roundTrips, expected) < 0)
+        return DPI_FAILURE;
+    if (dpiConn_release(conn) < 0)
+        return dpiTestCase_setFailedFromError(testCase);
+    if (dpiPool_release(pool) < 0)
+        return dpiTestCase_setFailedFromError(testCase);
+    return DPI_SUCCESS;
+}
+
+
+//-----------------------------------------------------------------------------
+// dpiTest_2407_verifyRetryOnNewSession()
+//   Execute a PL/SQL block with dpiStmt_executeWithRetry() which kills the
+// pooled session it is first executed on (no error); verify that the block is
+// replayed on a new session from the pool and the round trips made in doing
+// so, along with the retry statistics of the connection and pool. This test
+// requires the stub OCI library.
+//-----------------------------------------------------------------------------
+int dpiTest_2407_verifyRetryOnNewSession(dpiTestCase *testCase,
+        dpiTestParams *params)
+{
+    const char *sql = "begin kill_session(1); end;";
+    dpiRetryParams retryParams;
+    uint64_t roundTrips = 0;
+    dpiRetryInfo retryInfo;
+    dpiContext *context;
+    dpiStmt *stmt;
+    dpiConn *conn;
+    dpiPool *pool;
+
+    dpiTestSuite_getContext(&context);
+    if (dpiContext_initRetryParams(context, &retryParams) < 0)
+        return dpiTestCase_setFailedFromError(testCase);
+    retryParams.initialDelay = 1;
+    if (dpiTest__createPool(testCase, params, -1, &pool) < 0)
+        return DPI_FAILURE;
+    if (dpiPool_acquireConnection(pool, NULL, 0, NULL, 0, NULL, &conn) < 0)
+        return dpiTestCase_setFailedFromError(testCase);
+    if (dpiConn_prepareStmt(conn, 0, sql, strlen(sql), NULL, 0, &stmt) < 0)
+        return dpiTestCase_setFailedFromError(testCase);
+    if (dpiConn_getRoundTrips(conn, &roundTrips) < 0)
+        return dpiTestCase_setFailedFromError(testCase);
+    if (dpiStmt_executeWithRetry(stmt, 0, &retryParams, NULL) < 0)
+        return dpiTestCase_setFailedFromError(testCase);
+    if (dpiTest__expectRoundTrips(testCase, conn, &roundTrips, 4) < 0)
+        return DPI_FAILURE;
+    if (dpiConn_getRetryInfo(conn, &retryInfo) < 0)
+        return dpiTestCase_setFailedFromError(testCase);
+    if (dpiTestCase_expectUintEqual(testCase, retryInfo.numRetries, 1) < 0)
+        return DPI_FAILURE;
+    if (dpiTestCase_expectUintEqual(testCase,
+            retryInfo.numSessionsReplaced, 1) < 0)
+        return DPI_FAILURE;
+    if (dpiTestCase_expectUintEqual(testCase, retryInfo.numSucceeded, 1) < 0)
+        return DPI_FAILURE;
+    if (dpiStmt_release(stmt) < 0)
+        return dpiTestCase_setFailedFromError(testCase);
+    if (dpiConn_release(conn) < 0)
+        return dpiTestCase_setFailedFromError(testCase);
+    if (dpiPool_getRetryInfo(pool, &retryInfo) < 0)
+        return dpiTestCase_setFailedFromError(testCase);
+    if (dpiPool_release(pool) < 0)
+        return dpiTestCase_setFailedFromError(testCase);
+    return dpiTestCase_expectUintEqual(testCase, retryInfo.numRetries, 1);
+}
+
+
+//-----------------------------------------------------------------------------
+// dpiTest_2408_verifyNoRetryOnStandalone()
+//   Execute a PL/SQL block with dpiStmt_executeWithRetry() which kills the
+// standalone session it is executed on (error ORA-00028); verify that the
+// block is not replayed as the session cannot be replaced. This test requires
+// the stub OCI library.
+//-----------------------------------------------------------------------------
+int dpiTest_2408_verifyNoRetryOnStandalone(dpiTestCase *testCase,
+        dpiTestParams *params)
+{
+    const char *expectedError = "ORA-00028: your session has been killed";
+    const char *sql = "begin kill_session(1); end;";
+    dpiRetryParams retryParams;
+    uint64_t roundTrips = 0;
+    dpiRetryInfo retryInfo;
+    dpiContext *context;
+    dpiStmt *stmt;
+    dpiConn *conn;
+
+    dpiTestSuite_getContext(&context);
+    if (dpiContext_initRetryParams(context, &retryParams) < 0)
+        return dpiTestCase_setFailedFromError(testCase);
+    if (dpiTestCase_getConnection(testCase, &conn) < 0)
+        return DPI_FAILURE;
+    if (dpiConn_prepareStmt(conn, 0, sql, strlen(sql), NULL, 0, &stmt) < 0)
+        return dpiTestCase_setFailedFromError(testCase);
+    if (dpiConn_getRoundTrips(conn, &roundTrips) < 0)
+        return dpiTestCase_setFailedFromError(testCase);
+    dpiStmt_executeWithRetry(stmt, 0, &retryParams, NULL);
+    if (dpiTestCase_expectError(testCase, expectedError) < 0)
+        return DPI_FAILURE;
+    if (dpiTest__expectRoundTrips(testCase, conn, &roundTrips, 1) < 0)
+        return DPI_FAILURE;
+    if (dpiConn_getRetryInfo(conn, &retryInfo) < 0)
+        return dpiTestCase_setFailedFromError(testCase);
+    if (dpiTestCase_expectUintEqual(testCase, retryInfo.numRetries, 0) < 0)
+        return DPI_FAILURE;
+    if (dpiStmt_release(stmt) < 0)
+        return dpiTestCase_setFailedFromError(testCase);
+    return DPI_SUCCESS;
+}
+
+
+//-----------------------------------------------------------------------------
+// dpiTest_2409_verifyLobFileTransfer()
+//   Call dpiLob_writeFromFd() with a file spanning three transfer blocks and
+// verify that four round trips are made: one to get the chunk size and one to
+// write each block. Then call dpiLob_readToFd() and verify that five round
+// trips are made: one each to get the chunk size and the LOB length and one to
+// read each block.
+//-----------------------------------------------------------------------------
+int dpiTest_2409_verifyLobFileTransfer(dpiTestCase *testCase,
+        dpiTestParams *params)
+{
+    uint64_t roundTrips = 0, numBytes;
+    FILE *sourceFile, *targetFile;
+    dpiConn *conn;
+    dpiLob *lob;
+    char *data;
+
+    if (dpiTestCase_getConnection(testCase, &conn) < 0)
+        return DPI_FAILURE;
+    data = calloc(1, LOB_TRANSFER_SIZE);
+    sourceFile = tmpfile();
+    targetFile = tmpfile();
+    if (!data || !sourceFile || !targetFile)
+        return dpiTestCase_setFailed(testCase, "Unable to create files.");
+    if (fwrite(data, 1, LOB_TRANSFER_SIZE, sourceFile) != LOB_TRANSFER_SIZE ||
+            fflush(sourceFile) != 0)
+        return dpiTestCase_setFailed(testCase, "Unable to write file.");
+    rewind(sourceFile);
+    free(data);
+    if (dpiTest__expectRoundTrips(testCase, conn, &roundTrips, 2) < 0)
+        return DPI_FAILURE;
+    if (dpiConn_newTempLob(conn, DPI_ORACLE_TYPE_BLOB, &lob) < 0)
+        return dpiTestCase_setFailedFromError(testCase);
+    if (dpiTest__expectRoundTrips(testCase, conn, &roundTrips, 1) < 0)
+        return DPI_FAILURE;
+    if (dpiLob_writeFromFd(lob, 1, fileno(sourceFile),
+            DPI_MODE_LOB_TRANSFER_DEFAULT, &numBytes) < 0)
+        return dpiTestCase_setFailedFromError(testCase);
+    if (dpiTest__expectRoundTrips(testCase, conn, &roundTrips, 4) < 0)
+        return DPI_FAILURE;
+    if (dpiLob_readToFd(lob, 1, fileno(targetFile),
+            DPI_MODE_LOB_TRANSFER_DEFAULT, &numBytes) < 0)
+        return dpiTestCase_setFailedFromError(testCase);
+    if (dpiTest__expectRoundTrips(testCase, conn, &roundTrips, 5) < 0)
+        return DPI_FAILURE;
+    if (dpiTestCase_expectUintEqual(testCase, numBytes,
+            LOB_TRANSFER_SIZE) < 0)
+        return DPI_FAILURE;
+    if (dpiLob_release(lob) < 0)
+        return dpiTestCase_setFailedFromError(testCase);
+    fclose(sourceFile);
+    fclose(targetFile);
+    return DPI_SUCCESS;
+}
+
+
+//-----------------------------------------------------------------------------
+// dpiTest_2410_verifyBatchExecute()
+//   Add three DML statements to a batch and call dpiBatch_execute() twice;
+// verify that each execution makes one round trip.
+//-----------------------------------------------------------------------------
+int dpiTest_2410_verifyBatchExecute(dpiTestCase *testCase,
+        dpiTestParams *params)
+{
+    const char *sqls[3] = {
+        "insert into TestTempTable (IntCol) values (:1)",
+        "update TestTempTable set StringCol = 'Done' where IntCol = :1",
+        "delete from TestTempTable where IntCol = :1"
+    };
+    uint64_t roundTrips = 0;
+    dpiData *intColValue;
+    dpiVar *intColVar;
+    dpiBatch *batch;
+    dpiStmt *stmt;
+    dpiConn *conn;
+    uint32_t i;
+
+    if (dpiTestCase_getConnection(testCase, &conn) < 0)
+        return DPI_FAILURE;
+    if (dpiTest__expectRoundTrips(testCase, conn, &roundTrips, 2) < 0)
+        return DPI_FAILURE;
+    if (dpiConn_newVar(conn, DPI_ORACLE_TYPE_NATIVE_INT, DPI_NATIVE_TYPE_INT64,
+            1, 0, 0, 0, NULL, &intColVar, &intColValue) < 0)
+        return dpiTestCase_setFailedFromError(testCase);
+    dpiData_setInt64(intColValue, 1);
+    if (dpiConn_newBatch(conn, &batch) < 0)
+        return dpiTestCase_setFailedFromError(testCase);
+    for (i = 0; i < 3; i++) {
+        if (dpiConn_prepareStmt(conn, 0, sqls[i], strlen(sqls[i]), NULL, 0,
+                &stmt) < 0)
+            return dpiTestCase_setFailedFromError(testCase);
+        if (dpiStmt_bindByPos(stmt, 1, intColVar) < 0)
+            return dpiTestCase_setFailedFromError(testCase);
+        if (dpiBatch_addStmt(batch, stmt) < 0)
+            return dpiTestCase_setFailedFromError(testCase);
+        if (dpiStmt_release(stmt) < 0)
+            return dpiTestCase_setFailedFromError(testCase);
+    }
+    if (dpiTest__expectRoundTrips(testCase, conn, &roundTrips, 0) < 0)
+        return DPI_FAILURE;
+    for (i = 0; i < 2; i++) {
+        if (dpiBatch_execute(batch, DPI_MODE_EXEC_DEFAULT) < 0)
+            return dpiTestCase_setFailedFromError(testCase);
+        if (dpiTest__expectRoundTrips(testCase, conn, &roundTrips, 1) < 0)
+            return DPI_FAILURE;
+    }
+    if (dpiBatch_release(batch) < 0)
+        return dpiTestCase_setFailedFromError(testCase);
+    if (dpiVar_release(intColVar) < 0)
+        return dpiTestCase_setFailedFromError(testCase);
+
+    return DPI_SUCCESS;
+}
+
+
+//-----------------------------------------------------------------------------
+// dpiTest_2411_verifyNoRetryInTransaction()
+//   Execute a DML statement without committing it and then execute a PL/SQL
+// block with dpiStmt_executeWithRetry() which kills the pooled session it is
+// executed on (error ORA-00028); verify that the block is not replayed on a
+// new session as the transaction in progress would be lost. This test
+// requires the stub OCI library.
+//-----------------------------------------------------------------------------
+int dpiTest_2411_verifyNoRetryInTransaction(dpiTestCase *testCase,
+        dpiTestParams *params)
+{
+    const char *expectedError = "ORA-00028: your session has been killed";
+    const char *dmlSql = "insert into TestTempTable (IntCol) values (1)";
+    const char *sql = "begin kill_session(1); end;";
+    dpiRetryParams retryParams;
+    uint64_t roundTrips = 0;
+    dpiRetryInfo retryInfo;
+    dpiContext *context;
+    dpiStmt *stmt;
+    dpiConn *conn;
+    dpiPool *pool;
+
+    dpiTestSuite_getContext(&context);
+    if (dpiContext_initRetryParams(context, &retryParams) < 0)
+        return dpiTestCase_setFailedFromError(testCase);
+    retryParams.initialDelay = 1;
+    if (dpiTest__createPool(testCase, params, -1, &pool) < 0)
+        return DPI_FAILURE;
+    if (dpiPool_acquireConnection(pool, NULL, 0, NULL, 0, NULL, &conn) < 0)
+        return dpiTestCase_setFailedFromError(testCase);
+    if (dpiConn_prepareStmt(conn, 0, dmlSql, strlen(dmlSql), NULL, 0,
+            &stmt) < 0)
+        return dpiTestCase_setFailedFromError(testCase);
+    if (dpiStmt_execute(stmt, DPI_MODE_EXEC_DEFAULT, NULL) < 0)
+        return dpiTestCase_setFailedFromError(testCase);
+    if (dpiStmt_release(stmt) < 0)
+        return dpiTestCase_setFailedFromError(testCase);
+    if (dpiConn_prepareStmt(conn, 0, sql, strlen(sql), NULL, 0, &stmt) < 0)
+        return dpiTestCase_setFailedFromError(testCase);
+    if (dpiConn_getRoundTrips(conn, &roundTrips) < 0)
+        return dpiTestCase_setFailedFromError(testCase);
+    dpiStmt_executeWithRetry(stmt, 0, &retryParams, NULL);
+    if (dpiTestCase_expectError(testCase, expectedError) < 0)
+        return DPI_FAILURE;
+    if (dpiTest__expectRoundTrips(testCase, conn, &roundTrips, 1) < 0)
+        return DPI_FAILURE;
+    if (dpiConn_getRetryInfo(conn, &retryInfo) < 0)
+        return dpiTestCase_setFailedFromError(testCase);
+    if (dpiTestCase_expectUintEqual(testCase, retryInfo.numRetries, 0) < 0)
+        return DPI_FAILURE;
+    if (dpiTestCase_expectUintEqual(testCase,
+            retryInfo.numSessionsReplaced, 0) < 0)
+        return DPI_FAILURE;
+    if (dpiStmt_release(stmt) < 0)
+        return dpiTestCase_setFailedFromError(testCase);
+    if (dpiConn_release(conn) < 0)
+        return dpiTestCase_setFailedFromError(testCase);
+    if (dpiPool_release(pool) < 0)
+        return dpiTestCase_setFailedFromError(testCase);
+    return DPI_SUCCESS;
+}
+
+
+//-----------------------------------------------------------------------------
+// dpiTest_2412_verifyFetchBeyondPrefetch()
+//   Prepare and execute a query returning 250 rows with an array size of 100
+// and a fetch limit of 50, then remove the fetch limit and fetch all of the
+// rows (no error); verify that since the first fetch requests more rows than
+// were prefetched during execution, each of the three fetches makes a round
+// trip.
+//-----------------------------------------------------------------------------
+int dpiTest_2412_verifyFetchBeyondPrefetch(dpiTestCase *testCase,
+        dpiTestParams *params)
+{
+    const char *sql = "select to_char(level) from dual "
+            "connect by level <= 250";
+    uint32_t numQueryColumns, bufferRowIndex, numRowsFetched = 0;
+    uint64_t roundTrips = 0;
+    dpiConn *conn;
+    dpiStmt *stmt;
+    int found;
+
+    if (dpiTestCase_getConnection(testCase, &conn) < 0)
+        return DPI_FAILURE;
+    if (dpiTest__expectRoundTrips(testCase, conn, &roundTrips, 2) < 0)
+        return DPI_FAILURE;
+    if (dpiConn_prepareStmt(conn, 0, sql, strlen(sql), NULL, 0, &stmt) < 0)
+        return dpiTestCase_setFailedFromError(testCase);
+    if (dpiStmt_setFetchArraySize(stmt, QUERY_ARRAY_SIZE) < 0)
+        return dpiTestCase_setFailedFromError(testCase);
+    if (dpiStmt_setFetchLimit(stmt, QUERY_ARRAY_SIZE / 2) < 0)
+        return dpiTestCase_setFailedFromError(testCase);
+    if (dpiStmt_execute(stmt, 0, &numQueryColumns) < 0)
+        return dpiTestCase_setFailedFromError(testCase);
+    if (dpiTest__expectRoundTrips(testCase, conn, &roundTrips, 1) < 0)
+        return DPI_FAILURE;
+    if (dpiStmt_setFetchLimit(stmt, 0) < 0)
+        return dpiTestCase_setFailedFromError(testCase);
+    while (1) {
+        if (dpiStmt_fetch(stmt, &found, &bufferRowIndex) < 0)
+            return dpiTestCase_setFailedFromError(testCase);
+        if (!found)
+            break;
+        numRowsFetched++;
+    }
+    if (dpiTestCase_expectUintEqual(testCase, numRowsFetched,
+            QUERY_NUM_ROWS) < 0)
+        return DPI_FAILURE;
+    if (dpiTest__expectRoundTrips(testCase, conn, &roundTrips, 3) < 0)
+        return DPI_FAILURE;
+    if (dpiStmt_release(stmt) < 0)
+        return dpiTestCase_setFailedFromError(testCase);
+    return dpiTest__expectRoundTrips(testCase, conn, &roundTrips, 0);
+}
+
+
+//-----------------------------------------------------------------------------
+// dpiTest_2413_verifyObjectTypeCached()
+//   Look up an object type and release it (no error) and verify that the
+// lookup makes four round trips (one to get the server version, one to look
+// up the type and two to describe it); look it up again and verify that the
+// same object type is returned without any round trips being made, even
+// though it was not referenced in the meantime.
+//-----------------------------------------------------------------------------
+int dpiTest_2413_verifyObjectTypeCached(dpiTestCase *testCase,
+        dpiTestParams *params)
+{
+    const char *name = "UDT_STUB";
+    dpiObjectType *objType1, *objType2;
+    uint64_t roundTrips = 0;
+    dpiConn *conn;
+
+    if (dpiTestCase_getConnection(testCase, &conn) < 0)
+        return DPI_FAILURE;
+    if (dpiTest__expectRoundTrips(testCase, conn, &roundTrips, 2) < 0)
+        return DPI_FAILURE;
+    if (dpiConn_getObjectType(conn, name, strlen(name), &objType1) < 0)
+        return dpiTestCase_setFailedFromError(testCase);
+    if (dpiObjectType_release(objType1) < 0)
+        return dpiTestCase_setFailedFromError(testCase);
+    if (dpiTest__expectRoundTrips(testCase, conn, &roundTrips, 4) < 0)
+        return DPI_FAILURE;
+    if (dpiConn_getObjectType(conn, name, strlen(name), &objType2) < 0)
+        return dpiTestCase_setFailedFromError(testCase);
+    if (objType2 != objType1)
+        return dpiTestCase_setFailed(testCase,
+                "object type not reused from cache");
+    if (dpiObjectType_release(objType2) < 0)
+        return dpiTestCase_setFailedFromError(testCase);
+    return dpiTest__expectRoundTrips(testCase, conn, &roundTrips, 0);
+}
+
+
+//-----------------------------------------------------------------------------
+// main()
+//-----------------------------------------------------------------------------
+int main(int argc, char **argv)
+{
+    dpiTestSuite_initialize(2400);
+    dpiTestSuite_addCase(dpiTest_2400_verifyStandaloneConnect,
+            "dpiConn_create() makes two round trips");
+    dpiTestSuite_addCase(dpiTest_2401_verifyTransactionControl,
+            "commit, rollback and ping each make one round trip");
+    dpiTestSuite_addCase(dpiTest_2402_verifyServerVersionCached,
+            "dpiConn_getServerVersion() makes one round trip when repeated");
+    dpiTestSuite_addCase(dpiTest_2403_verifyQueryFetch,
+            "query of 250 rows with array size 100 makes three round trips");
+    dpiTestSuite_addCase(dpiTest_2404_verifyStandaloneClose,
+            "dpiConn_close() on standalone connection makes three round trips");
+    dpiTestSuite_addCase(dpiTest_2405_verifyPoolAcquire,
+            "dpiPool_acquireConnection() makes one round trip");
+    dpiTestSuite_addCase(dpiTest_2406_verifyPoolAcquireWithPing,
+            "dpiPool_acquireConnection() pings when ping interval is exceeded");
+    dpiTestSuite_addCase(dpiTest_2407_verifyRetryOnNewSession,
+            "replay on a new pooled session makes four round trips");
+    dpiTestSuite_addCase(dpiTest_2408_verifyNoRetryOnStandalone,
+            "execution on a killed standalone session is not replayed");
+    dpiTestSuite_addCase(dpiTest_2409_verifyLobFileTransfer,
+            "LOB file transfers make one round trip per block");
+    dpiTestSuite_addCase(dpiTest_2410_verifyBatchExecute,
+            "dpiBatch_execute() makes one round trip");
+    dpiTestSuite_addCase(dpiTest_2411_verifyNoRetryInTransaction,
+            "execution on a killed session in a transaction is not replayed");
+    dpiTestSuite_addCase(dpiTest_2412_verifyFetchBeyondPrefetch,
+            "first fetch of more rows than were prefetched is counted");
+    dpiTestSuite_addCase(dpiTest_2413_verifyObjectTypeCached,
+            "dpiConn_getObjectType() reuses an unreferenced object type");
+    return dpiTestSuite_run();
+}
+
@@ -16,6 +16,55 @@
 
 #include "TestLib.h"
 
+//-----------------------------------------------------------------------------
+// dpiTest__createAutoBindConn() [INTERNAL]
+//   Create a standalone connection using the prepare mode
+// DPI_MODE_PREPARE_AUTO_BIND.
+//-----------------------------------------------------------------------------
+static int dpiTest__createAutoBindConn(dpiTestCase *testCase,
+        dpiTestParams *params, dpiConn **conn)
+{
+    dpiCommonCreateParams commonParams;
+    dpiContext *context;
+
+    dpiTestSuite_getContext(&context);
+    if (dpiContext_initCommonCreateParams(context, &commonParams) < 0)
+        return dpiTestCase_setFailedFromError(testCase);
+    commonParams.prepareMode = DPI_MODE_PREPARE_AUTO_BIND;
+    if (dpiConn_create(context, params->mainUserName,
+            params->mainUserNameLength, params->mainPassword,
+            params->mainPasswordLength, params->connectString,
+            params->connectStringLength, &commonParams, NULL, conn) < 0)
+        return dpiTestCase_setFailedFromError(testCase);
+    return DPI_SUCCESS;
+}
+
+
+//-----------------------------------------------------------------------------
+// dpiTest__expectSql() [INTERNAL]
+//   Prepare the statement and verify that the SQL that was prepared matches
+// the expected SQL.
+//-----------------------------------------------------------------------------
+static int dpiTest__expectSql(dpiTestCase *testCase, dpiConn *conn,
+        const char *sql, const char *expectedSql)
+{
+    uint32_t preparedSqlLength;
+    const char *preparedSql;
+    dpiStmt *stmt;
+
+    if (dpiConn_prepareStmt(conn, 0, sql, strlen(sql), NULL, 0, &stmt) < 0)
+        return dpiTestCase_setFailedFromError(testCase);
+    if (dpiStmt_getSql(stmt, &preparedSql, &preparedSqlLength) < 0)
+        return dpiTestCase_setFailedFromError(testCase);
+    if (dpiTestCase_expectStringEqual(testCase, preparedSql,
+            preparedSqlLength, expectedSql, strlen(expectedSql)) < 0)
+        return DPI_FAILURE;
+    if (dpiStmt_release(stmt) < 0)
+        return dpiTestCase_setFailedFromError(testCase);
+    return DPI_SUCCESS;
+}
+
+
 //-----------------------------------------------------------------------------
 // dpiTest_1100_releaseTwice()
 //   Prepare any statement; call dpiStmt_release() twice (error DPI-1002).
@@ -989,6 +1038,305 @@ int dpiTest_1123_bindNamesNoDuplicatesPlsql(dpiTestCase *testCase,
 }
 
 
+//-----------------------------------------------------------------------------
+// dpiTest_1124_executeWithTimeoutExceeded()
+//   Create a connection in threaded mode; call dpiStmt_executeWithTimeout()
+// with a PL/SQL block that sleeps for longer than the timeout (error
+// DPI-1060); verify the connection can still be used afterwards.
+//-----------------------------------------------------------------------------
+int dpiTest_1124_executeWithTimeoutExceeded(dpiTestCase *testCase,
+        dpiTestParams *params)
+{
+    const char *sleepSql = "begin dbms_lock.sleep(5); end;";
+    const char *sql = "begin null; end;";
+    dpiCommonCreateParams commonParams;
+    dpiErrorInfo errorInfo;
+    dpiContext *context;
+    dpiConn *conn;
+    dpiStmt *stmt;
+
+    dpiTestSuite_getContext(&context);
+    if (dpiContext_initCommonCreateParams(context, &commonParams) < 0)
+        return dpiTestCase_setFailedFromError(testCase);
+    commonParams.createMode = DPI_MODE_CREATE_THREADED;
+    if (dpiConn_create(context, params->mainUserName,
+            params->mainUserNameLength, params->mainPassword,
+            params->mainPasswordLength, params->connectString,
+            params->connectStringLength, &commonParams, NULL, &conn) < 0)
+        return dpiTestCase_setFailedFromError(testCase);
+    if (dpiConn_prepareStmt(conn, 0, sleepSql, strlen(sleepSql), NULL, 0,
+            &stmt) < 0)
+        return dpiTestCase_setFailedFromError(testCase);
+    if (dpiStmt_executeWithTimeout(stmt, DPI_MODE_EXEC_DEFAULT, 100,
+            NULL) == DPI_SUCCESS)
+        return dpiTestCase_setFailed(testCase, "Expected error DPI-1060.");
+    dpiTestSuite_getErrorInfo(&errorInfo);
+    if (strncmp(errorInfo.message, "DPI-1060:", 9) != 0)
+        return dpiTestCase_setFailedFromErrorInfo(testCase, &errorInfo);
+    if (dpiStmt_release(stmt) < 0)
+        return dpiTestCase_setFailedFromError(testCase);
+    if (dpiConn_prepareStmt(conn, 0, sql, strlen(sql), NULL, 0, &stmt) < 0)
+        return dpiTestCase_setFailedFromError(testCase);
+    if (dpiStmt_execute(stmt, DPI_MODE_EXEC_DEFAULT, NULL) < 0)
+        return dpiTestCase_setFailedFromError(testCase);
+    if (dpiStmt_release(stmt) < 0)
+        return dpiTestCase_setFailedFromError(testCase);
+    if (dpiConn_release(conn) < 0)
+        return dpiTestCase_setFailedFromError(testCase);
+    return DPI_SUCCESS;
+}
+
+
+//-----------------------------------------------------------------------------
+// dpiTest_1125_executeAndFetchWithinTimeout()
+//   Create a connection in threaded mode; call dpiStmt_executeWithTimeout()
+// with a PL/SQL block that completes within the timeout and then execute a
+// query and call dpiStmt_fetchRowsWithTimeout() (no error).
+//-----------------------------------------------------------------------------
+int dpiTest_1125_executeAndFetchWithinTimeout(dpiTestCase *testCase,
+        dpiTestParams *params)
+{
+    const char *sql = "select level from dual connect by level <= 10";
+    const char *sleepSql = "begin dbms_lock.sleep(0.1); end;";
+    uint32_t bufferRowIndex, numRowsFetched;
+    dpiCommonCreateParams commonParams;
+    dpiContext *context;
+    dpiConn *conn;
+    dpiStmt *stmt;
+    int moreRows;
+
+    dpiTestSuite_getContext(&context);
+    if (dpiContext_initCommonCreateParams(context, &commonParams) < 0)
+        return dpiTestCase_setFailedFromError(testCase);
+    commonParams.createMode = DPI_MODE_CREATE_THREADED;
+    if (dpiConn_create(context, params->mainUserName,
+            params->mainUserNameLength, params->mainPassword,
+            params->mainPasswordLength, params->connectString,
+            params->connectStringLength, &commonParams, NULL, &conn) < 0)
+        return dpiTestCase_setFailedFromError(testCase);
+    if (dpiConn_prepareStmt(conn, 0, sleepSql, strlen(sleepSql), NULL, 0,
+            &stmt) < 0)
+        return dpiTestCase_setFailedFromError(testCase);
+    if (dpiStmt_executeWithTimeout(stmt, DPI_MODE_EXEC_DEFAULT, 5000,
+            NULL) < 0)
+        return dpiTestCase_setFailedFromError(testCase);
+    if (dpiStmt_release(stmt) < 0)
+        return dpiTestCase_setFailedFromError(testCase);
+    if (dpiConn_prepareStmt(conn, 0, sql, strlen(sql), NULL, 0, &stmt) < 0)
+        return dpiTestCase_setFailedFromError(testCase);
+    if (dpiStmt_executeWithTimeout(stmt, DPI_MODE_EXEC_DEFAULT, 5000,
+            NULL) < 0)
+        return dpiTestCase_setFailedFromError(testCase);
+    if (dpiStmt_fetchRowsWithTimeout(stmt, 100, 5000, &bufferRowIndex,
+            &numRowsFetched, &moreRows) < 0)
+        return dpiTestCase_setFailedFromError(testCase);
+    if (dpiTestCase_expectUintEqual(testCase, numRowsFetched, 10) < 0)
+        return DPI_FAILURE;
+    if (dpiTestCase_expectIntEqual(testCase, moreRows, 0) < 0)
+        return DPI_FAILURE;
+    if (dpiStmt_release(stmt) < 0)
+        return dpiTestCase_setFailedFromError(testCase);
+    if (dpiConn_release(conn) < 0)
+        return dpiTestCase_setFailedFromError(testCase);
+    return DPI_SUCCESS;
+}
+
+
+//-----------------------------------------------------------------------------
+// dpiTest_1126_executeWithTimeoutNotThreaded()
+//   Call dpiStmt_executeWithTimeout() with a timeout on a connection that was
+// not created in threaded mode (error DPI-1013).
+//-----------------------------------------------------------------------------
+int dpiTest_1126_executeWithTimeoutNotThreaded(dpiTestCase *testCase,
+        dpiTestParams *params)
+{
+    const char *sql = "begin null; end;";
+    dpiConn *conn;
+    dpiStmt *stmt;
+
+    if (dpiTestCase_getConnection(testCase, &conn) < 0)
+        return DPI_FAILURE;
+    if (dpiConn_prepareStmt(conn, 0, sql, strlen(sql), NULL, 0, &stmt) < 0)
+        return dpiTestCase_setFailedFromError(testCase);
+    dpiStmt_executeWithTimeout(stmt, DPI_MODE_EXEC_DEFAULT, 100, NULL);
+    if (dpiTestCase_expectError(testCase, "DPI-1013: not supported") < 0)
+        return DPI_FAILURE;
+    if (dpiStmt_release(stmt) < 0)
+        return dpiTestCase_setFailedFromError(testCase);
+    return DPI_SUCCESS;
+}
+
+
+//-----------------------------------------------------------------------------
+// dpiTest_1127_autoBindCorpus()
+//   Create a connection using the prepare mode DPI_MODE_PREPARE_AUTO_BIND;
+// prepare each statement in a corpus covering the quoting rules, comments,
+// hints, literals which must remain constant and statements which must not be
+// changed and verify the SQL that was prepared (no error).
+//-----------------------------------------------------------------------------
+int dpiTest_1127_autoBindCorpus(dpiTestCase *testCase, dpiTestParams *params)
+{
+    const char *corpus[][2] = {
+        { "select * from TestNumbers where IntCol = 5",
+          "select * from TestNumbers where IntCol = :DPI_B1" },
+        { "SELECT  *\n  FROM TestNumbers\n WHERE IntCol=5  ",
+          "SELECT * FROM TestNumbers WHERE IntCol=:DPI_B1" },
+        { "select * from TestStrings where StringCol = 'It''s'",
+          "select * from TestStrings where StringCol = :DPI_B1" },
+        { "select * from TestStrings where StringCol in "
+                "(q'[it's]', Q'{a}b}', q'!x!')",
+          "select * from TestStrings where StringCol in "
+                "(:DPI_B1, :DPI_B2, :DPI_B3)" },
+        { "select /*+ index(t) */ * from TestNumbers t -- comment\n"
+                "where /* note */ IntCol = 7",
+          "select /*+ index(t) */ * from TestNumbers t where IntCol = "
+                ":DPI_B1" },
+        { "select --+ full(t)\n* from TestNumbers t where IntCol = 7",
+          "select --+ full(t)\n* from TestNumbers t where IntCol = :DPI_B1" },
+        { "update TestNumbers set NumberCol = -1.5e-3, FloatCol = .25 "
+                "where IntCol = 10",
+          "update TestNumbers set NumberCol = -:DPI_B1, FloatCol = :DPI_B2 "
+                "where IntCol = :DPI_B3" },
+        { "select * from TestNumbers where FloatCol > 1.5f",
+          "select * from TestNumbers where FloatCol > 1.5f" },
+        { "select IntCol, 'x', substr(StringCol, 1, 3) from TestStrings "
+                "where IntCol > 2 group by IntCol, substr(StringCol, 1, 3) "
+                "order by 1",
+          "select IntCol, 'x', substr(StringCol, 1, 3) from TestStrings "
+                "where IntCol > :DPI_B1 group by IntCol, "
+                "substr(StringCol, 1, 3) order by 1" },
+        { "select * from TestDates where DateCol > date '2017-01-01' and "
+                "DateCol < timestamp '2017-06-01 00:00:00' + interval '1' day",
+          "select * from TestDates where DateCol > date '2017-01-01' and "
+                "DateCol < timestamp '2017-06-01 00:00:00' + interval '1' "
+                "day" },
+        { "select * from TestStrings where cast(StringCol as varchar2(20)) "
+                "= 'a'",
+          "select * from TestStrings where cast(StringCol as varchar2(20)) "
+                "= :DPI_B1" },
+        { "select * from TestStrings where StringCol = n'abc'",
+          "select * from TestStrings where StringCol = n'abc'" },
+        { "select \"Col'1\" from TestNumbers where IntCol = 3",
+          "select \"Col'1\" from TestNumbers where IntCol = :DPI_B1" },
+        { "select * from TestStrings where StringCol='a'and IntCol=1",
+          "select * from TestStrings where StringCol=:DPI_B1 and "
+                "IntCol=:DPI_B2" },
+        { "insert into TestStrings (IntCol, StringCol) values "
+                "(1, 'O''Neil')",
+          "insert into TestStrings (IntCol, StringCol) values "
+                "(:DPI_B1, :DPI_B2)" },
+        { "select * from Test2 t2 where t2.Col1 = 1",
+          "select * from Test2 t2 where t2.Col1 = :DPI_B1" },
+        { "select IntCol from TestNumbers where IntCol in "
+                "(select 5 from dual where 1 = 1)",
+          "select IntCol from TestNumbers where IntCol in "
+                "(select 5 from dual where :DPI_B1 = :DPI_B2)" },
+        { "select * from TestNumbers where IntCol = 1 for update wait 5",
+          "select * from TestNumbers where IntCol = :DPI_B1 for update "
+                "wait 5" },
+        { "select * from (select IntCol, StringCol from TestStrings) pivot "
+                "(count(*) for IntCol in (1 as One, 2 as Two)) where "
+                "StringCol = 'a'",
+          "select * from (select IntCol, StringCol from TestStrings) pivot "
+                "(count(*) for IntCol in (1 as One, 2 as Two)) where "
+                "StringCol = :DPI_B1" },
+        { "select * from (select 1 a, 2 b from dual) unpivot "
+                "(Val for Col in (a as 'A', b as 'B')) where Val > 1",
+          "select * from (select 1 a, 2 b from dual) unpivot "
+                "(Val for Col in (a as 'A', b as 'B')) where Val > :DPI_B1" },
+        { "select * from TestJson where json_value(JsonCol, '$.a') = 'b'",
+          "select * from TestJson where json_value(JsonCol, '$.a') = "
+                ":DPI_B1" },
+        { "update TestStrings set StringCol = '' where IntCol = 1",
+          "update TestStrings set StringCol = :DPI_B1 where IntCol = "
+                ":DPI_B2" },
+        { "select *  from TestNumbers where IntCol = :1 and NumberCol > 5",
+          "select *  from TestNumbers where IntCol = :1 and NumberCol > 5" },
+        { "begin  null; end;", "begin  null; end;" },
+        { "create table  TestTemp (c number(5) default 0)",
+          "create table  TestTemp (c number(5) default 0)" },
+        { "with function f return number is begin return 1; end; "
+                "select  f from dual",
+          "with function f return number is begin return 1; end; "
+                "select  f from dual" },
+        { "select 'abc from  dual", "select 'abc from  dual" }
+    };
+    dpiConn *conn;
+    uint32_t i;
+
+    if (dpiTest__createAutoBindConn(testCase, params, &conn) < 0)
+        return DPI_FAILURE;
+    for (i = 0; i < sizeof(corpus) / sizeof(corpus[0]); i++) {
+        if (dpiTest__expectSql(testCase, conn, corpus[i][0],
+                corpus[i][1]) < 0)
+            return DPI_FAILURE;
+    }
+    if (dpiConn_release(conn) < 0)
+        return dpiTestCase_setFailedFromError(testCase);
+    return DPI_SUCCESS;
+}
+
+
+//-----------------------------------------------------------------------------
+// dpiTest_1128_autoBindNotEnabled()
+//   Prepare a statement containing literals on a connection created with the
+// default prepare mode and verify the SQL is prepared unchanged (no error).
+//-----------------------------------------------------------------------------
+int dpiTest_1128_autoBindNotEnabled(dpiTestCase *testCase,
+        dpiTestParams *params)
+{
+    const char *sql = "select *  from TestNumbers where IntCol = 5";
+    dpiConn *conn;
+
+    if (dpiTestCase_getConnection(testCase, &conn) < 0)
+        return DPI_FAILURE;
+    return dpiTest__expectSql(testCase, conn, sql, sql);
+}
+
+
+//-----------------------------------------------------------------------------
+// dpiTest_1129_autoBindExecuteQuery()
+//   Create a connection using the prepare mode DPI_MODE_PREPARE_AUTO_BIND;
+// execute a query with string literals using both quoting mechanisms and a
+// numeric literal and fetch the first row (no error).
+//-----------------------------------------------------------------------------
+int dpiTest_1129_autoBindExecuteQuery(dpiTestCase *testCase,
+        dpiTestParams *params)
+{
+    const char *sql = "select level from dual where 'ab''c' = q'[ab'c]' "
+            "and 2.5 > 1 connect by level <= 3";
+    dpiNativeTypeNum nativeTypeNum;
+    uint32_t bufferRowIndex;
+    dpiData *data;
+    dpiConn *conn;
+    dpiStmt *stmt;
+    int found;
+
+    if (dpiTest__createAutoBindConn(testCase, params, &conn) < 0)
+        return DPI_FAILURE;
+    if (dpiConn_prepareStmt(conn, 0, sql, strlen(sql), NULL, 0, &stmt) < 0)
+        return dpiTestCase_setFailedFromError(testCase);
+    if (dpiStmt_execute(stmt, DPI_MODE_EXEC_DEFAULT, NULL) < 0)
+        return dpiTestCase_setFailedFromError(testCase);
+    if (dpiStmt_defineValue(stmt, 1, DPI_ORACLE_TYPE_NATIVE_INT,
+            DPI_NATIVE_TYPE_INT64, 0, 0, NULL) < 0)
+        return dpiTestCase_setFailedFromError(testCase);
+    if (dpiStmt_fetch(stmt, &found, &bufferRowIndex) < 0)
+        return dpiTestCase_setFailedFromError(testCase);
+    if (dpiTestCase_expectIntEqual(testCase, found, 1) < 0)
+        return DPI_FAILURE;
+    if (dpiStmt_getQueryValue(stmt, 1, &nativeTypeNum, &data) < 0)
+        return dpiTestCase_setFailedFromError(testCase);
+    if (dpiTestCase_expectIntEqual(testCase, data->value.asInt64, 1) < 0)
+        return DPI_FAILURE;
+    if (dpiStmt_release(stmt) < 0)
+        return dpiTestCase_setFailedFromError(testCase);
+    if (dpiConn_release(conn) < 0)
+        return dpiTestCase_setFailedFromError(testCase);
+    return DPI_SUCCESS;
+}
+
+
 //-----------------------------------------------------------------------------
 // main()
 //-----------------------------------------------------------------------------
@@ -1043,6 +1391,18 @@ int main(int argc, char **argv)
             "dpiStmt_getBindCount() with duplicate binds (PL/SQL)");
     dpiTestSuite_addCase(dpiTest_1123_bindNamesNoDuplicatesPlsql,
             "dpiStmt_getBindNames() strips duplicates (PL/SQL)");
+    dpiTestSuite_addCase(dpiTest_1124_executeWithTimeoutExceeded,
+            "dpiStmt_executeWithTimeout() with timeout exceeded");
+    dpiTestSuite_addCase(dpiTest_1125_executeAndFetchWithinTimeout,
+            "dpiStmt_executeWithTimeout() and fetchRowsWithTimeout()");
+    dpiTestSuite_addCase(dpiTest_1126_executeWithTimeoutNotThreaded,
+            "dpiStmt_executeWithTimeout() without threaded mode");
+    dpiTestSuite_addCase(dpiTest_1127_autoBindCorpus,
+            "dpiConn_prepareStmt() with auto bind on a corpus of statements");
+    dpiTestSuite_addCase(dpiTest_1128_autoBindNotEnabled,
+            "dpiConn_prepareStmt() without auto bind");
+    dpiTestSuite_addCase(dpiTest_1129_autoBindExecuteQuery,
+            "execute query prepared with auto bind");
     return dpiTestSuite_run();
 }
 
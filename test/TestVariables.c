@@ -689,6 +689,282 @@ int dpiTest_1022_setNumElementsInArrayTooLarge(dpiTestCase *testCase,
 }
 
 
+//-----------------------------------------------------------------------------
+// dpiTest_1023_setOutputEncodingTranscodesValues()
+//   Prepare and execute a query returning a string; define a variable and call
+// dpiVar_setOutputEncoding() with the encoding UTF-16; fetch the row and
+// verify that the value is returned in UTF-16 (no error).
+//-----------------------------------------------------------------------------
+int dpiTest_1023_setOutputEncodingTranscodesValues(dpiTestCase *testCase,
+        dpiTestParams *params)
+{
+    const char *sql = "select 'ODPI-C' from dual";
+    uint32_t numQueryColumns, bufferRowIndex, i;
+    uint16_t expectedValue[6];
+    const char *encoding;
+    dpiData *data;
+    dpiConn *conn;
+    dpiStmt *stmt;
+    dpiVar *var;
+    int found;
+
+    if (dpiTestCase_getConnection(testCase, &conn) < 0)
+        return DPI_FAILURE;
+    if (dpiConn_newVar(conn, DPI_ORACLE_TYPE_VARCHAR, DPI_NATIVE_TYPE_BYTES,
+            MAX_ARRAY_SIZE, 100, 0, 0, NULL, &var, &data) < 0)
+        return dpiTestCase_setFailedFromError(testCase);
+    if (dpiVar_setOutputEncoding(var, "UTF-16") < 0)
+        return dpiTestCase_setFailedFromError(testCase);
+    if (dpiConn_prepareStmt(conn, 0, sql, strlen(sql), NULL, 0, &stmt) < 0)
+        return dpiTestCase_setFailedFromError(testCase);
+    if (dpiStmt_execute(stmt, DPI_MODE_EXEC_DEFAULT, &numQueryColumns) < 0)
+        return dpiTestCase_setFailedFromError(testCase);
+    if (dpiStmt_setFetchArraySize(stmt, MAX_ARRAY_SIZE) < 0)
+        return dpiTestCase_setFailedFromError(testCase);
+    if (dpiStmt_define(stmt, 1, var) < 0)
+        return dpiTestCase_setFailedFromError(testCase);
+    if (dpiStmt_fetch(stmt, &found, &bufferRowIndex) < 0)
+        return dpiTestCase_setFailedFromError(testCase);
+    if (dpiTestCase_expectIntEqual(testCase, found, 1) < 0)
+        return DPI_FAILURE;
+    for (i = 0; i < 6; i++)
+        expectedValue[i] = (uint16_t) "ODPI-C"[i];
+    encoding = data[bufferRowIndex].value.asBytes.encoding;
+    if (dpiTestCase_expectStringEqual(testCase, encoding, strlen(encoding),
+            "UTF-16", 6) < 0)
+        return DPI_FAILURE;
+    if (dpiTestCase_expectUintEqual(testCase,
+            data[bufferRowIndex].value.asBytes.length,
+            sizeof(expectedValue)) < 0)
+        return DPI_FAILURE;
+    if (memcmp(data[bufferRowIndex].value.asBytes.ptr, expectedValue,
+            sizeof(expectedValue)) != 0)
+        return dpiTestCase_setFailed(testCase, "value not transcoded");
+    dpiVar_release(var);
+    dpiStmt_release(stmt);
+
+    return DPI_SUCCESS;
+}
+
+
+//-----------------------------------------------------------------------------
+// dpiTest_1024_setOutputEncodingNotSupported()
+//   Create a variable of type DPI_ORACLE_TYPE_RAW; call
+// dpiVar_setOutputEncoding() (error DPI-1013); create a variable of type
+// DPI_ORACLE_TYPE_VARCHAR and call dpiVar_setOutputEncoding() with an
+// encoding other than UTF-8 or UTF-16 (error DPI-1026).
+//-----------------------------------------------------------------------------
+int dpiTest_1024_setOutputEncodingNotSupported(dpiTestCase *testCase,
+        dpiTestParams *params)
+{
+    dpiData *data;
+    dpiConn *conn;
+    dpiVar *var;
+
+    if (dpiTestCase_getConnection(testCase, &conn) < 0)
+        return DPI_FAILURE;
+    if (dpiConn_newVar(conn, DPI_ORACLE_TYPE_RAW, DPI_NATIVE_TYPE_BYTES,
+            MAX_ARRAY_SIZE, 100, 0, 0, NULL, &var, &data) < 0)
+        return dpiTestCase_setFailedFromError(testCase);
+    dpiVar_setOutputEncoding(var, "UTF-16");
+    if (dpiTestCase_expectError(testCase, "DPI-1013: not supported") < 0)
+        return DPI_FAILURE;
+    dpiVar_release(var);
+    if (dpiConn_newVar(conn, DPI_ORACLE_TYPE_VARCHAR, DPI_NATIVE_TYPE_BYTES,
+            MAX_ARRAY_SIZE, 100, 0, 0, NULL, &var, &data) < 0)
+        return dpiTestCase_setFailedFromError(testCase);
+    dpiVar_setOutputEncoding(var, "ISO-8859-1");
+    if (dpiTestCase_expectError(testCase,
+            "DPI-1026: invalid character set ISO-8859-1") < 0)
+        return DPI_FAILURE;
+    dpiVar_release(var);
+
+    return DPI_SUCCESS;
+}
+
+
+//-----------------------------------------------------------------------------
+// dpiTest_1025_copyRangeCopiesValues()
+//   Create pairs of integer and string variables; populate the source
+// variables and call dpiVar_copyRange() for all elements and for an
+// overlapping range within the same variable; verify the values were copied
+// (no error).
+//-----------------------------------------------------------------------------
+int dpiTest_1025_copyRangeCopiesValues(dpiTestCase *testCase,
+        dpiTestParams *params)
+{
+    const char *strings[MAX_ARRAY_SIZE] = { "First", "Second", "Third" };
+    dpiData *intData1, *intData2, *strData1, *strData2;
+    dpiVar *intVar1, *intVar2, *strVar1, *strVar2;
+    dpiConn *conn;
+    uint32_t i;
+
+    if (dpiTestCase_getConnection(testCase, &conn) < 0)
+        return DPI_FAILURE;
+    if (dpiConn_newVar(conn, DPI_ORACLE_TYPE_NUMBER, DPI_NATIVE_TYPE_INT64,
+            MAX_ARRAY_SIZE, 0, 0, 0, NULL, &intVar1, &intData1) < 0)
+        return dpiTestCase_setFailedFromError(testCase);
+    if (dpiConn_newVar(conn, DPI_ORACLE_TYPE_NUMBER, DPI_NATIVE_TYPE_INT64,
+            MAX_ARRAY_SIZE, 0, 0, 0, NULL, &intVar2, &intData2) < 0)
+        return dpiTestCase_setFailedFromError(testCase);
+    if (dpiConn_newVar(conn, DPI_ORACLE_TYPE_VARCHAR, DPI_NATIVE_TYPE_BYTES,
+            MAX_ARRAY_SIZE, 10, 1, 0, NULL, &strVar1, &strData1) < 0)
+        return dpiTestCase_setFailedFromError(testCase);
+    if (dpiConn_newVar(conn, DPI_ORACLE_TYPE_VARCHAR, DPI_NATIVE_TYPE_BYTES,
+            MAX_ARRAY_SIZE, 10, 1, 0, NULL, &strVar2, &strData2) < 0)
+        return dpiTestCase_setFailedFromError(testCase);
+    for (i = 0; i < MAX_ARRAY_SIZE; i++) {
+        intData2[i].isNull = (i == 1);
+        intData2[i].value.asInt64 = i * 10;
+        if (dpiVar_setFromBytes(strVar2, i, strings[i],
+                strlen(strings[i])) < 0)
+            return dpiTestCase_setFailedFromError(testCase);
+    }
+    if (dpiVar_copyRange(intVar1, 0, intVar2, 0, MAX_ARRAY_SIZE) < 0)
+        return dpiTestCase_setFailedFromError(testCase);
+    if (dpiVar_copyRange(strVar1, 0, strVar2, 0, MAX_ARRAY_SIZE) < 0)
+        return dpiTestCase_setFailedFromError(testCase);
+    for (i = 0; i < MAX_ARRAY_SIZE; i++) {
+        if (dpiTestCase_expectUintEqual(testCase, intData1[i].isNull,
+                (i == 1)) < 0)
+            return DPI_FAILURE;
+        if (i != 1 && dpiTestCase_expectIntEqual(testCase,
+                intData1[i].value.asInt64, i * 10) < 0)
+            return DPI_FAILURE;
+        if (dpiTestCase_expectStringEqual(testCase,
+                strData1[i].value.asBytes.ptr,
+                strData1[i].value.asBytes.length, strings[i],
+                strlen(strings[i])) < 0)
+            return DPI_FAILURE;
+    }
+    if (dpiVar_copyRange(strVar1, 1, strVar1, 0, MAX_ARRAY_SIZE - 1) < 0)
+        return dpiTestCase_setFailedFromError(testCase);
+    for (i = 1; i < MAX_ARRAY_SIZE; i++) {
+        if (dpiTestCase_expectStringEqual(testCase,
+                strData1[i].value.asBytes.ptr,
+                strData1[i].value.asBytes.length, strings[i - 1],
+                strlen(strings[i - 1])) < 0)
+            return DPI_FAILURE;
+    }
+    dpiVar_release(intVar1);
+    dpiVar_release(intVar2);
+    dpiVar_release(strVar1);
+    dpiVar_release(strVar2);
+
+    return DPI_SUCCESS;
+}
+
+
+//-----------------------------------------------------------------------------
+// dpiTest_1026_copyRangeWithInvalidRange()
+//   Create two variables with the same native type; call dpiVar_copyRange()
+// with a range that exceeds the maxArraySize of the target variable (error
+// DPI-1009); call dpiVar_copyRange() with a string that is too large for the
+// target variable (error DPI-1019) and verify that no values were copied;
+// call dpiVar_copyRange() with a string that is too large to be converted to
+// a number (error DPI-1019 reporting the size of the conversion buffer).
+//-----------------------------------------------------------------------------
+int dpiTest_1026_copyRangeWithInvalidRange(dpiTestCase *testCase,
+        dpiTestParams *params)
+{
+    const char *longString = "A longer string";
+    dpiData *data1, *data2, *data3, *data4;
+    dpiVar *var1, *var2, *var3, *var4;
+    char numberString[200];
+    dpiConn *conn;
+
+    if (dpiTestCase_getConnection(testCase, &conn) < 0)
+        return DPI_FAILURE;
+    if (dpiConn_newVar(conn, DPI_ORACLE_TYPE_VARCHAR, DPI_NATIVE_TYPE_BYTES,
+            MAX_ARRAY_SIZE, 5, 1, 0, NULL, &var1, &data1) < 0)
+        return dpiTestCase_setFailedFromError(testCase);
+    if (dpiConn_newVar(conn, DPI_ORACLE_TYPE_VARCHAR, DPI_NATIVE_TYPE_BYTES,
+            MAX_ARRAY_SIZE, 20, 1, 0, NULL, &var2, &data2) < 0)
+        return dpiTestCase_setFailedFromError(testCase);
+    dpiVar_copyRange(var1, 1, var2, 0, MAX_ARRAY_SIZE);
+    if (dpiTestCase_expectError(testCase,
+            "DPI-1009: zero-based position 3 is not valid with max array "
+            "size of 3") < 0)
+        return DPI_FAILURE;
+    if (dpiVar_setFromBytes(var2, 0, "Abc", 3) < 0)
+        return dpiTestCase_setFailedFromError(testCase);
+    if (dpiVar_setFromBytes(var2, 1, longString, strlen(longString)) < 0)
+        return dpiTestCase_setFailedFromError(testCase);
+    dpiVar_copyRange(var1, 0, var2, 0, 2);
+    if (dpiTestCase_expectError(testCase,
+            "DPI-1019: buffer size of 5 is too small") < 0)
+        return DPI_FAILURE;
+    if (dpiTestCase_expectUintEqual(testCase, data1[0].isNull, 1) < 0)
+        return DPI_FAILURE;
+    if (dpiConn_newVar(conn, DPI_ORACLE_TYPE_NUMBER, DPI_NATIVE_TYPE_BYTES,
+            MAX_ARRAY_SIZE, 0, 0, 0, NULL, &var3, &data3) < 0)
+        return dpiTestCase_setFailedFromError(testCase);
+    if (dpiConn_newVar(conn, DPI_ORACLE_TYPE_VARCHAR, DPI_NATIVE_TYPE_BYTES,
+            MAX_ARRAY_SIZE, sizeof(numberString), 1, 0, NULL, &var4,
+            &data4) < 0)
+        return dpiTestCase_setFailedFromError(testCase);
+    memset(numberString, '1', sizeof(numberString));
+    if (dpiVar_setFromBytes(var4, 0, numberString, sizeof(numberString)) < 0)
+        return dpiTestCase_setFailedFromError(testCase);
+    dpiVar_copyRange(var3, 0, var4, 0, 1);
+    if (dpiTestCase_expectError(testCase,
+            "DPI-1019: buffer size of 172 is too small") < 0)
+        return DPI_FAILURE;
+    dpiVar_release(var1);
+    dpiVar_release(var2);
+    dpiVar_release(var3);
+    dpiVar_release(var4);
+
+    return DPI_SUCCESS;
+}
+
+
+//-----------------------------------------------------------------------------
+// dpiTest_1027_getBufferNodeNumaLocal()
+//   Create a connection with the buffer mode DPI_MODE_BUFFER_NUMA_LOCAL;
+// create a variable with a buffer larger than a page and one with a buffer
+// smaller than a page; call dpiVar_getBufferNode() for each of them and
+// verify that the node is either a valid node number or -1 when it cannot be
+// determined (no error).
+//-----------------------------------------------------------------------------
+int dpiTest_1027_getBufferNodeNumaLocal(dpiTestCase *testCase,
+        dpiTestParams *params)
+{
+    dpiCommonCreateParams commonParams;
+    dpiVar *largeVar, *smallVar;
+    dpiData *largeData, *smallData;
+    int32_t largeNode, smallNode;
+    dpiContext *context;
+    dpiConn *conn;
+
+    dpiTestSuite_getContext(&context);
+    if (dpiContext_initCommonCreateParams(context, &commonParams) < 0)
+        return dpiTestCase_setFailedFromError(testCase);
+    commonParams.bufferMode = DPI_MODE_BUFFER_NUMA_LOCAL;
+    if (dpiConn_create(context, params->mainUserName,
+            params->mainUserNameLength, params->mainPassword,
+            params->mainPasswordLength, params->connectString,
+            params->connectStringLength, &commonParams, NULL, &conn) < 0)
+        return dpiTestCase_setFailedFromError(testCase);
+    if (dpiConn_newVar(conn, DPI_ORACLE_TYPE_NATIVE_INT, DPI_NATIVE_TYPE_INT64,
+            4096, 0, 0, 0, NULL, &largeVar, &largeData) < 0)
+        return dpiTestCase_setFailedFromError(testCase);
+    if (dpiConn_newVar(conn, DPI_ORACLE_TYPE_NATIVE_INT, DPI_NATIVE_TYPE_INT64,
+            MAX_ARRAY_SIZE, 0, 0, 0, NULL, &smallVar, &smallData) < 0)
+        return dpiTestCase_setFailedFromError(testCase);
+    if (dpiVar_getBufferNode(largeVar, &largeNode) < 0)
+        return dpiTestCase_setFailedFromError(testCase);
+    if (dpiVar_getBufferNode(smallVar, &smallNode) < 0)
+        return dpiTestCase_setFailedFromError(testCase);
+    if (largeNode < -1 || smallNode < -1)
+        return dpiTestCase_setFailed(testCase, "Invalid NUMA node returned!");
+    dpiVar_release(largeVar);
+    dpiVar_release(smallVar);
+    dpiConn_release(conn);
+    return DPI_SUCCESS;
+}
+
+
 //-----------------------------------------------------------------------------
 // main()
 //-----------------------------------------------------------------------------
@@ -742,6 +1018,17 @@ int main(int argc, char **argv)
             "dpiVar_copyData() with different variable types");
     dpiTestSuite_addCase(dpiTest_1022_setNumElementsInArrayTooLarge,
             "dpiVar_setNumElementsInArray() with value too large");
+    dpiTestSuite_addCase(dpiTest_1023_setOutputEncodingTranscodesValues,
+            "dpiVar_setOutputEncoding() transcodes fetched values");
+    dpiTestSuite_addCase(dpiTest_1024_setOutputEncodingNotSupported,
+            "dpiVar_setOutputEncoding() with unsupported variable or "
+            "encoding");
+    dpiTestSuite_addCase(dpiTest_1025_copyRangeCopiesValues,
+            "dpiVar_copyRange() copies values");
+    dpiTestSuite_addCase(dpiTest_1026_copyRangeWithInvalidRange,
+            "dpiVar_copyRange() with invalid range or value too large");
+    dpiTestSuite_addCase(dpiTest_1027_getBufferNodeNumaLocal,
+            "dpiVar_getBufferNode() with NUMA local buffers");
     return dpiTestSuite_run();
 }
 
@@ -53,6 +53,8 @@ grant read on directory &dir_name to &main_user;
 
 grant select on v_$session to &main_user;
 
+grant execute on dbms_lock to &main_user;
+
 -- create types
 create type &main_user..udt_SubObject as object (
     SubNumberValue                      number,
@@ -101,6 +103,13 @@ create type &main_user..udt_ObjectDataTypesArray as
 create type &main_user..udt_NestedArray is table of &main_user..udt_SubObject;
 /
 
+create type &main_user..udt_LobObject as object (
+    IntValue                            number(9),
+    ClobValue                           clob,
+    NClobValue                          nclob
+);
+/
+
 -- create tables
 create table &main_user..TestNumbers (
     IntCol                              number(9) not null,
@@ -409,6 +418,16 @@ begin
 end;
 /
 
+-- create function for testing shared queries
+create function &main_user..func_Sleep (
+    a_Seconds                           number
+) return number as
+begin
+    dbms_lock.sleep(a_Seconds);
+    return 0;
+end;
+/
+
 -- create packages
 create or replace package &main_user..pkg_TestStringArrays as
 